@@ -177,6 +177,7 @@ namespace Ogre
 
         virtual void calculateHashForPreCreate( Renderable *renderable, PiecesMap *inOutPieces );
         virtual void calculateHashForPreCaster( Renderable *renderable, PiecesMap *inOutPieces );
+        virtual bool canMemoiseRenderableHash( const Renderable *renderable ) const;
 
         static bool requiredPropertyByAlphaTest( IdString propertyName );
 
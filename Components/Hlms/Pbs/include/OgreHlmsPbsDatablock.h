@@ -253,6 +253,12 @@ namespace Ogre
         uint8   mTexToBakedTextureIdx[NUM_PBSM_TEXTURE_TYPES];
 
         HlmsSamplerblock const  *mSamplerblocks[NUM_PBSM_TEXTURE_TYPES];
+        /// HlmsSamplerblock::mMinLod as set by the user. mSamplerblocks use the
+        /// highest of this and mStreamingMinLod.
+        float   mUserMinLod[NUM_PBSM_TEXTURE_TYPES];
+        /// Most detailed mip that is resident, for streamed textures (see _replaceTexture).
+        /// 0 for the rest.
+        float   mStreamingMinLod[NUM_PBSM_TEXTURE_TYPES];
 
         CubemapProbe *mCubemapProbe;
 
@@ -268,6 +274,10 @@ namespace Ogre
         /// Sets the appropiate mTexIndices[textureType], and returns the texture pointer
         TexturePtr setTexture( const String &name, PbsTextureTypes textureType );
 
+        /// Stores params.mMinLod as the user's min LOD (unless it's the one currently in
+        /// use) and raises it to the streaming min LOD of the given texture unit.
+        void applyStreamingMinLod( PbsTextureTypes texType, HlmsSamplerblock &params );
+
         void decompileBakedTextures( PbsBakedTexture outTextures[NUM_PBSM_TEXTURE_TYPES] );
         void bakeTextures( const PbsBakedTexture textures[NUM_PBSM_TEXTURE_TYPES] );
 
@@ -495,6 +505,11 @@ namespace Ogre
         /** Sets a new sampler block to be associated with the texture
             (i.e. filtering mode, addressing modes, etc). If the samplerblock changes,
             this function will always trigger a HlmsDatablock::flushRenderables
+        @remarks
+            While a streamed texture doesn't have all its mips resident, the samplerblock
+            in use gets a higher mMinLod than params. The min LOD in params is kept and
+            used again once the mips are resident. Passing back the min LOD returned by
+            getSamplerblock leaves it unchanged.
         @param texType
             Type of texture.
         @param params
@@ -504,6 +519,11 @@ namespace Ogre
 
         const HlmsSamplerblock* getSamplerblock( PbsTextureTypes texType ) const;
 
+        /// @copydoc HlmsDatablock::_replaceTexture
+        virtual void _replaceTexture( const TexturePtr &oldTexture, uint16 oldArrayIndex,
+                                      const TexturePtr &newTexture, uint16 newArrayIndex,
+                                      float minLod );
+
         /** Sets which UV set to use for the given texture.
             Calling this function triggers a HlmsDatablock::flushRenderables.
         @param sourceType
@@ -725,6 +725,16 @@ namespace Ogre
             setProperty( PbsProperty::MaterialsPerBuffer, static_cast<int>( mSlotsPerPool ) );
     }
     //-----------------------------------------------------------------------------------
+    bool HlmsPbs::canMemoiseRenderableHash( const Renderable *renderable ) const
+    {
+#ifdef OGRE_BUILD_COMPONENT_PLANAR_REFLECTIONS
+        //calculateHashForPreCreate depends on (and notifies) mPlanarReflections per renderable
+        if( mPlanarReflections )
+            return false;
+#endif
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
     void HlmsPbs::calculateHashForPreCaster( Renderable *renderable, PiecesMap *inOutPieces )
     {
         HlmsPbsDatablock *datablock = static_cast<HlmsPbsDatablock*>( renderable->getDatablock() );
@@ -2272,6 +2282,7 @@ namespace Ogre
     void HlmsPbs::setPlanarReflections( PlanarReflections *planarReflections )
     {
         mPlanarReflections = planarReflections;
+        clearRenderableHashMemo();
     }
     //-----------------------------------------------------------------------------------
     PlanarReflections* HlmsPbs::getPlanarReflections(void) const
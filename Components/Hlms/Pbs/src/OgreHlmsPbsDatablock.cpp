@@ -37,6 +37,8 @@ THE SOFTWARE.
 #include "OgreLogManager.h"
 #include "Cubemaps/OgreCubemapProbe.h"
 
+#include <float.h>
+
 #include "OgreHlmsPbsDatablock.cpp.inc"
 
 namespace Ogre
@@ -96,9 +98,13 @@ namespace Ogre
         mEmissive[0] = mEmissive[1] = mEmissive[2] = 0.0f;
         memset( mTexIndices, 0, sizeof( mTexIndices ) );
         memset( mSamplerblocks, 0, sizeof( mSamplerblocks ) );
+        memset( mStreamingMinLod, 0, sizeof( mStreamingMinLod ) );
 
         for( size_t i=0; i<NUM_PBSM_TEXTURE_TYPES; ++i )
+        {
             mTexToBakedTextureIdx[i] = NUM_PBSM_TEXTURE_TYPES;
+            mUserMinLod[i] = -FLT_MAX;
+        }
 
         String paramVal;
 
@@ -708,6 +714,8 @@ namespace Ogre
             }
 
             mSamplerblocks[i] = textures[i].samplerBlock;
+            mUserMinLod[i] = mSamplerblocks[i] ? mSamplerblocks[i]->mMinLod : -FLT_MAX;
+            mStreamingMinLod[i] = 0;
         }
 
         bakeTextures( textures );
@@ -726,12 +734,29 @@ namespace Ogre
         //Decompile the baked textures to know which texture is assigned to each type.
         decompileBakedTextures( textures );
 
+        HlmsSamplerblock samplerblock;
+        if( textures[texType].texture != newTexture && mStreamingMinLod[texType] != 0 )
+        {
+            //The min LOD was raised for the streamed texture being replaced.
+            mStreamingMinLod[texType] = 0;
+            if( !refParams && mSamplerblocks[texType] )
+            {
+                samplerblock = *mSamplerblocks[texType];
+                samplerblock.mMinLod = mUserMinLod[texType];
+                refParams = &samplerblock;
+            }
+        }
+
         //Set the new samplerblock
         if( refParams )
         {
+            if( refParams != &samplerblock )
+                samplerblock = *refParams;
+            applyStreamingMinLod( texType, samplerblock );
+
             HlmsManager *hlmsManager = mCreator->getHlmsManager();
             const HlmsSamplerblock *oldSamplerblock = mSamplerblocks[texType];
-            mSamplerblocks[texType] = hlmsManager->getSamplerblock( *refParams );
+            mSamplerblocks[texType] = hlmsManager->getSamplerblock( samplerblock );
 
             if( oldSamplerblock )
                 hlmsManager->destroySamplerblock( oldSamplerblock );
@@ -750,6 +775,7 @@ namespace Ogre
 
             HlmsManager *hlmsManager = mCreator->getHlmsManager();
             mSamplerblocks[texType] = hlmsManager->getSamplerblock( samplerBlockRef );
+            mUserMinLod[texType] = samplerBlockRef.mMinLod;
         }
 
         PbsBakedTexture oldTex = textures[texType];
@@ -787,9 +813,12 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void HlmsPbsDatablock::setSamplerblock( PbsTextureTypes texType, const HlmsSamplerblock &params )
     {
+        HlmsSamplerblock samplerblock( params );
+        applyStreamingMinLod( texType, samplerblock );
+
         const HlmsSamplerblock *oldSamplerblock = mSamplerblocks[texType];
         HlmsManager *hlmsManager = mCreator->getHlmsManager();
-        mSamplerblocks[texType] = hlmsManager->getSamplerblock( params );
+        mSamplerblocks[texType] = hlmsManager->getSamplerblock( samplerblock );
 
         if( oldSamplerblock )
             hlmsManager->destroySamplerblock( oldSamplerblock );
@@ -807,6 +836,37 @@ namespace Ogre
         return mSamplerblocks[texType];
     }
     //-----------------------------------------------------------------------------------
+    void HlmsPbsDatablock::applyStreamingMinLod( PbsTextureTypes texType, HlmsSamplerblock &params )
+    {
+        if( !mSamplerblocks[texType] || params.mMinLod != mSamplerblocks[texType]->mMinLod )
+            mUserMinLod[texType] = params.mMinLod;
+
+        params.mMinLod = std::max( mUserMinLod[texType], mStreamingMinLod[texType] );
+    }
+    //-----------------------------------------------------------------------------------
+    void HlmsPbsDatablock::_replaceTexture( const TexturePtr &oldTexture, uint16 oldArrayIndex,
+                                            const TexturePtr &newTexture, uint16 newArrayIndex,
+                                            float minLod )
+    {
+        for( size_t i=0; i<NUM_PBSM_TEXTURE_TYPES; ++i )
+        {
+            if( mTexIndices[i] == oldArrayIndex && getTexture( i ) == oldTexture )
+            {
+                const PbsTextureTypes texType = static_cast<PbsTextureTypes>( i );
+
+                //Set after the texture; setTexture forgets the min LOD of the texture it replaces.
+                setTexture( texType, newArrayIndex, newTexture, 0 );
+                mStreamingMinLod[i] = minLod;
+
+                HlmsSamplerblock samplerblock;
+                if( mSamplerblocks[i] )
+                    samplerblock = *mSamplerblocks[i];
+                samplerblock.mMinLod = mUserMinLod[i];
+                setSamplerblock( texType, samplerblock );
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
     void HlmsPbsDatablock::setTextureUvSource( PbsTextureTypes sourceType, uint8 uvSet )
     {
         if( uvSet >= 8 )
@@ -89,6 +89,7 @@ namespace Ogre
 
         virtual void calculateHashForPreCreate( Renderable *renderable, PiecesMap *inOutPieces );
         virtual void calculateHashForPreCaster( Renderable *renderable, PiecesMap *inOutPieces );
+        virtual bool canMemoiseRenderableHash( const Renderable *renderable ) const;
 
         virtual void destroyAllBuffers(void);
 
@@ -93,6 +93,12 @@ namespace Ogre
         uint8   mTextureSwizzles[NUM_UNLIT_TEXTURE_TYPES];
 
         HlmsSamplerblock const  *mSamplerblocks[NUM_UNLIT_TEXTURE_TYPES];
+        /// HlmsSamplerblock::mMinLod as set by the user. mSamplerblocks use the
+        /// highest of this and mStreamingMinLod.
+        float   mUserMinLod[NUM_UNLIT_TEXTURE_TYPES];
+        /// Most detailed mip that is resident, for streamed textures (see _replaceTexture).
+        /// 0 for the rest.
+        float   mStreamingMinLod[NUM_UNLIT_TEXTURE_TYPES];
 
         virtual void cloneImpl( HlmsDatablock *datablock ) const;
 
@@ -103,6 +109,10 @@ namespace Ogre
         /// Sets the appropiate mTexIndices[texUnit], and returns the texture pointer
         TexturePtr setTexture( const String &name, uint8 texUnit );
 
+        /// Stores params.mMinLod as the user's min LOD (unless it's the one currently in
+        /// use) and raises it to the streaming min LOD of the given texture unit.
+        void applyStreamingMinLod( uint8 texType, HlmsSamplerblock &params );
+
         void decompileBakedTextures( UnlitBakedTexture outTextures[NUM_UNLIT_TEXTURE_TYPES] );
         void bakeTextures( const UnlitBakedTexture textures[NUM_UNLIT_TEXTURE_TYPES] );
 
@@ -226,6 +236,11 @@ namespace Ogre
         /** Sets a new sampler block to be associated with the texture
             (i.e. filtering mode, addressing modes, etc). If the samplerblock changes,
             this function will always trigger a HlmsDatablock::flushRenderables
+        @remarks
+            While a streamed texture doesn't have all its mips resident, the samplerblock
+            in use gets a higher mMinLod than params. The min LOD in params is kept and
+            used again once the mips are resident. Passing back the min LOD returned by
+            getSamplerblock leaves it unchanged.
         @param texType
             Texture unit. Must be in range [0; NUM_UNLIT_TEXTURE_TYPES)
         @param params
@@ -235,6 +250,11 @@ namespace Ogre
 
         const HlmsSamplerblock* getSamplerblock( uint8 texType ) const;
 
+        /// @copydoc HlmsDatablock::_replaceTexture
+        virtual void _replaceTexture( const TexturePtr &oldTexture, uint16 oldArrayIndex,
+                                      const TexturePtr &newTexture, uint16 newArrayIndex,
+                                      float minLod );
+
         /** Sets which UV set to use for the given texture.
             Calling this function triggers a HlmsDatablock::flushRenderables.
         @param sourceType
@@ -47,6 +47,9 @@ namespace Ogre
         static const IdString TextureMatrix;
         static const IdString ExponentialShadowMaps;
         static const IdString HasPlanarReflections;
+        /// The Vao has no vertex buffers; position, colour and uv0 are fetched
+        /// from a GpuBillboardSet's records using the vertex ID.
+        static const IdString VertexPulling;
 
         static const IdString TexMatrixCount;
         static const IdString TexMatrixCount0;
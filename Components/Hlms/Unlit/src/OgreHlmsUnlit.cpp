@@ -48,6 +48,7 @@ THE SOFTWARE.
 #include "Vao/OgreConstBufferPacked.h"
 #include "Vao/OgreTexBufferPacked.h"
 #include "Vao/OgreStagingBuffer.h"
+#include "Vao/OgreVertexArrayObject.h"
 
 #include "OgreHlmsManager.h"
 #include "OgreLogManager.h"
@@ -56,6 +57,7 @@ THE SOFTWARE.
 #include "CommandBuffer/OgreCbTexture.h"
 #include "CommandBuffer/OgreCbShaderBuffer.h"
 #include "OgreUnlitProperty.h"
+#include "OgreGpuBillboardSet.h"
 namespace Ogre
 {
 
@@ -182,6 +184,8 @@ namespace Ogre
         vsParams->setNamedConstant( "worldMatBuf", 0 );
         if( getProperty( UnlitProperty::TextureMatrix ) )
             vsParams->setNamedConstant( "animationMatrixBuf", 1 );
+        if( getProperty( UnlitProperty::VertexPulling ) )
+            vsParams->setNamedConstant( "billboardBuf", 1 );
 
         mListener->shaderCacheEntryCreated( mShaderProfile, retVal, passCache,
                                             mSetProperties, queuedRenderable );
@@ -226,6 +230,15 @@ namespace Ogre
         bool isAnimated;
     };
     typedef vector<UvOutput>::type UvOutputVec;
+    /// GpuBillboardSet has no vertex buffers; the vertex shader pulls the data from its
+    /// records instead. Other renderables without vertex buffers aren't billboards, so the
+    /// set is identified by the custom parameter it sets on itself.
+    static inline bool usesVertexPulling( const Renderable *renderable )
+    {
+        const VertexArrayObjectArray &vaos = renderable->getVaos( VpNormal );
+        return !vaos.empty() && vaos[0]->getVertexBuffers().empty() &&
+                renderable->hasCustomParameter( GpuBillboardSet::CustomParameterIdx );
+    }
     void HlmsUnlit::calculateHashForPreCreate( Renderable *renderable, PiecesMap *inOutPieces )
     {
         assert( dynamic_cast<HlmsUnlitDatablock*>( renderable->getDatablock() ) );
@@ -238,6 +251,18 @@ namespace Ogre
         setProperty( HlmsBaseProp::Tangent,     0 );
         setProperty( HlmsBaseProp::BonesPerVertex, 0 );
 
+        const bool vertexPulling = usesVertexPulling( renderable );
+        if( vertexPulling )
+        {
+            assert( dynamic_cast<GpuBillboardSet*>( renderable ) &&
+                    "Only GpuBillboardSet may set GpuBillboardSet::CustomParameterIdx" );
+            //The vertex shader fetches these from the billboard records.
+            setProperty( UnlitProperty::VertexPulling, 1 );
+            setProperty( HlmsBaseProp::Colour,      1 );
+            setProperty( HlmsBaseProp::UvCount,     1 );
+            setProperty( HlmsBaseProp::UvCount0,    2 );
+        }
+
         int texUnit = 2; //Vertex shader consumes 2 slots with its two tbuffers.
         int numTextures = 0;
         int numArrayTextures = 0;
@@ -324,7 +349,8 @@ namespace Ogre
             {
                 const IdString &uvSourceSwizzleN = *UnlitProperty::DiffuseMapPtrs[i].uvSourceSwizzle;
 
-                if( datablock->mEnabledAnimationMatrices[i] )
+                //The billboard records take the animation matrices' slot.
+                if( datablock->mEnabledAnimationMatrices[i] && !vertexPulling )
                 {
                     //Animated outputs need their own entry
                     UvOutput uvOutput;
@@ -428,6 +454,14 @@ namespace Ogre
             setProperty( UnlitProperty::MaterialsPerBuffer, static_cast<int>( mSlotsPerPool ) );
     }
     //-----------------------------------------------------------------------------------
+    bool HlmsUnlit::canMemoiseRenderableHash( const Renderable *renderable ) const
+    {
+        //calculateHashForPreCreate looks at this custom parameter (see usesVertexPulling),
+        //which isn't part of the RenderableHashKey. A GpuBillboardSet would otherwise share
+        //the hash of any other bufferless renderable with the same datablock.
+        return !renderable->hasCustomParameter( GpuBillboardSet::CustomParameterIdx );
+    }
+    //-----------------------------------------------------------------------------------
     void HlmsUnlit::calculateHashForPreCaster( Renderable *renderable, PiecesMap *inOutPieces )
     {
         //HlmsUnlitDatablock *datablock = static_cast<HlmsUnlitDatablock*>(
@@ -444,7 +478,8 @@ namespace Ogre
                      itor->keyName != HlmsBaseProp::BonesPerVertex &&
                      itor->keyName != HlmsBaseProp::DualParaboloidMapping &&
                      itor->keyName != HlmsBaseProp::AlphaTest &&
-                     itor->keyName != HlmsBaseProp::AlphaBlend )
+                     itor->keyName != HlmsBaseProp::AlphaBlend &&
+                     itor->keyName != UnlitProperty::VertexPulling )
             {
                 itor = mSetProperties.erase( itor );
                 end  = mSetProperties.end();
@@ -777,6 +812,22 @@ namespace Ogre
             mLastBoundPool = newPool;
         }
 
+        if( !isV1 && usesVertexPulling( queuedRenderable.renderable ) )
+        {
+            //layout(binding = 1) uniform samplerBuffer billboardBuf
+            //Takes the slot of the animation matrices (GpuBillboardSet doesn't support them),
+            //so force the next renderable to bind its pool's extraBuffer again.
+            assert( dynamic_cast<GpuBillboardSet*>( queuedRenderable.renderable ) );
+            const GpuBillboardSet *billboardSet = static_cast<const GpuBillboardSet*>(
+                                                        queuedRenderable.renderable );
+            TexBufferPacked *recordBuffer = billboardSet->getRecordBuffer();
+            *commandBuffer->addCommand<CbShaderBuffer>() = CbShaderBuffer( VertexShader, 1,
+                                                                           recordBuffer, 0,
+                                                                           recordBuffer->
+                                                                           getTotalSizeBytes() );
+            mLastBoundPool = 0;
+        }
+
         uint32 * RESTRICT_ALIAS currentMappedConstBuffer    = mCurrentMappedConstBuffer;
         float * RESTRICT_ALIAS currentMappedTexBuffer       = mCurrentMappedTexBuffer;
 
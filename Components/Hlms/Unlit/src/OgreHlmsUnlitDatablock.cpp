@@ -35,6 +35,8 @@ THE SOFTWARE.
 #include "OgreTexture.h"
 #include "OgreLogManager.h"
 
+#include <float.h>
+
 #include "OgreHlmsUnlitDatablock.cpp.inc"
 
 namespace Ogre
@@ -96,12 +98,16 @@ namespace Ogre
 
         memset( mTexIndices, 0, sizeof( mTexIndices ) );
         memset( mSamplerblocks, 0, sizeof( mSamplerblocks ) );
+        memset( mStreamingMinLod, 0, sizeof( mStreamingMinLod ) );
 
         memset( mEnabledAnimationMatrices, 0, sizeof( mEnabledAnimationMatrices ) );
         memset( mEnablePlanarReflection, 0, sizeof( mEnablePlanarReflection ) );
 
         for( size_t i=0; i<NUM_UNLIT_TEXTURE_TYPES; ++i )
+        {
             mTexToBakedTextureIdx[i] = NUM_UNLIT_TEXTURE_TYPES;
+            mUserMinLod[i] = -FLT_MAX;
+        }
 
         String paramVal;
 
@@ -384,12 +390,29 @@ namespace Ogre
         //Decompile the baked textures to know which texture is assigned to each type.
         decompileBakedTextures( textures );
 
+        HlmsSamplerblock samplerblock;
+        if( textures[texType].texture != newTexture && mStreamingMinLod[texType] != 0 )
+        {
+            //The min LOD was raised for the streamed texture being replaced.
+            mStreamingMinLod[texType] = 0;
+            if( !refParams && mSamplerblocks[texType] )
+            {
+                samplerblock = *mSamplerblocks[texType];
+                samplerblock.mMinLod = mUserMinLod[texType];
+                refParams = &samplerblock;
+            }
+        }
+
         //Set the new samplerblock
         if( refParams )
         {
+            if( refParams != &samplerblock )
+                samplerblock = *refParams;
+            applyStreamingMinLod( texType, samplerblock );
+
             HlmsManager *hlmsManager = mCreator->getHlmsManager();
             const HlmsSamplerblock *oldSamplerblock = mSamplerblocks[texType];
-            mSamplerblocks[texType] = hlmsManager->getSamplerblock( *refParams );
+            mSamplerblocks[texType] = hlmsManager->getSamplerblock( samplerblock );
 
             if( oldSamplerblock )
                 hlmsManager->destroySamplerblock( oldSamplerblock );
@@ -400,6 +423,7 @@ namespace Ogre
             HlmsSamplerblock samplerBlockRef;
             HlmsManager *hlmsManager = mCreator->getHlmsManager();
             mSamplerblocks[texType] = hlmsManager->getSamplerblock( samplerBlockRef );
+            mUserMinLod[texType] = samplerBlockRef.mMinLod;
         }
 
         UnlitBakedTexture oldTex = textures[texType];
@@ -441,9 +465,12 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void HlmsUnlitDatablock::setSamplerblock( uint8 texType, const HlmsSamplerblock &params )
     {
+        HlmsSamplerblock samplerblock( params );
+        applyStreamingMinLod( texType, samplerblock );
+
         const HlmsSamplerblock *oldSamplerblock = mSamplerblocks[texType];
         HlmsManager *hlmsManager = mCreator->getHlmsManager();
-        mSamplerblocks[texType] = hlmsManager->getSamplerblock( params );
+        mSamplerblocks[texType] = hlmsManager->getSamplerblock( samplerblock );
 
         if( oldSamplerblock )
             hlmsManager->destroySamplerblock( oldSamplerblock );
@@ -462,6 +489,35 @@ namespace Ogre
         return mSamplerblocks[texType];
     }
     //-----------------------------------------------------------------------------------
+    void HlmsUnlitDatablock::applyStreamingMinLod( uint8 texType, HlmsSamplerblock &params )
+    {
+        if( !mSamplerblocks[texType] || params.mMinLod != mSamplerblocks[texType]->mMinLod )
+            mUserMinLod[texType] = params.mMinLod;
+
+        params.mMinLod = std::max( mUserMinLod[texType], mStreamingMinLod[texType] );
+    }
+    //-----------------------------------------------------------------------------------
+    void HlmsUnlitDatablock::_replaceTexture( const TexturePtr &oldTexture, uint16 oldArrayIndex,
+                                              const TexturePtr &newTexture, uint16 newArrayIndex,
+                                              float minLod )
+    {
+        for( uint8 i=0; i<NUM_UNLIT_TEXTURE_TYPES; ++i )
+        {
+            if( mTexIndices[i] == oldArrayIndex && getTexture( i ) == oldTexture )
+            {
+                //Set after the texture; setTexture forgets the min LOD of the texture it replaces.
+                setTexture( i, newArrayIndex, newTexture, 0 );
+                mStreamingMinLod[i] = minLod;
+
+                HlmsSamplerblock samplerblock;
+                if( mSamplerblocks[i] )
+                    samplerblock = *mSamplerblocks[i];
+                samplerblock.mMinLod = mUserMinLod[i];
+                setSamplerblock( i, samplerblock );
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
     void HlmsUnlitDatablock::setTextureUvSource( uint8 sourceType, uint8 uvSet )
     {
         if( uvSet >= 8 )
@@ -41,6 +41,7 @@ namespace Ogre
     const IdString UnlitProperty::TextureMatrix     = IdString( "texture_matrix" );
     const IdString UnlitProperty::ExponentialShadowMaps = IdString( "exponential_shadow_maps" );
     const IdString UnlitProperty::HasPlanarReflections  = IdString( "has_planar_reflections" );
+    const IdString UnlitProperty::VertexPulling         = IdString( "unlit_vertex_pulling" );
 
     const IdString UnlitProperty::TexMatrixCount        = IdString( "hlms_texture_matrix_count" );
     const IdString UnlitProperty::TexMatrixCount0       = IdString( "hlms_texture_matrix_count0" );
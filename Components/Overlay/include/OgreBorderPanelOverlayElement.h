@@ -273,6 +273,8 @@ namespace v1 {
 
         /// Render operation for the border area
         v1::RenderOperation mRenderOp2;
+        /// Border area geometry used when batching is enabled
+        OverlayBatchVertexVec mBorderBatchVertices;
 
         static String msTypeName;
 
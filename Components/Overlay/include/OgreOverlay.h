@@ -90,6 +90,8 @@ namespace v1 {
         mutable Matrix4 mTransform;
         mutable bool mTransformOutOfDate;
         bool mInitialised;
+        /// See _setBatched
+        bool mBatched;
         String mOrigin;
         /** Internal lazy update method. */
         void updateTransform(void) const;
@@ -239,6 +241,18 @@ namespace v1 {
         /** Internal method to put the overlay contents onto the render queue. */
         virtual void _updateRenderQueue( RenderQueue *queue, Camera *camera, const Camera *lodCamera, Viewport* vp );
 
+        /** Whether all the visible elements can be rendered by the OverlayBatchRenderer.
+            See OverlayElement::_isBatchable.
+        */
+        bool _isBatchable(void) const;
+
+        /** Called by OverlayManager every frame, before _updateRenderQueue, to tell
+            whether the elements must be rendered by the OverlayBatchRenderer (v2)
+            or queued on their own (v1).
+        */
+        void _setBatched( bool batched )                    { mBatched = batched; }
+        bool _isBatched(void) const                         { return mBatched; }
+
         /** This returns a OverlayElement at position x,y. */
         virtual OverlayElement* findElementAt(Real x, Real y);
 
@@ -0,0 +1,198 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+
+#ifndef __OverlayBatchRenderer_H__
+#define __OverlayBatchRenderer_H__
+
+#include "OgreOverlayPrerequisites.h"
+#include "OgreRenderable.h"
+#include "OgreColourValue.h"
+#include "Vao/OgreVertexBufferPacked.h"
+
+namespace Ogre {
+namespace v1 {
+
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Overlays
+    *  @{
+    */
+
+    /// Vertex format used by all batched overlay geometry. Triangle lists, positions in clip space.
+    struct OverlayBatchVertex
+    {
+        float   x, y, z;
+        float   u, v;
+        uint32  colour;
+    };
+
+    typedef vector<OverlayBatchVertex>::type OverlayBatchVertexVec;
+
+    /** A single draw of batched overlay geometry: a run of consecutive visible elements
+        of an Overlay that share the same datablock. Owned by OverlayBatchRenderer.
+    @remarks
+        v2 only. It has no v1 render operation; OverlayBatchRenderer always queues it
+        in a FAST RenderQueue group, which only uses the Vaos.
+    */
+    class _OgreOverlayExport OverlayBatch : public Renderable, public OverlayAlloc
+    {
+        friend class OverlayBatchRenderer;
+
+        typedef vector<const OverlayBatchVertexVec*>::type VertexVecPtrVec;
+
+        Overlay             *mOverlay;
+        HlmsDatablock       *mBatchDatablock;
+        VertexArrayObject   *mVao;
+        /// Geometry gathered this frame. Pointers to the elements' cached vertices.
+        VertexVecPtrVec     mGeometry;
+        uint32              mNumVertices;
+
+    public:
+        OverlayBatch( Overlay *overlay, HlmsDatablock *datablock );
+        virtual ~OverlayBatch();
+
+        Overlay* getOverlay(void) const                         { return mOverlay; }
+
+        /** Recreates the Vao if vertexBuffer is not the one we were using, applies
+            the datablock if it changed, and sets the range of vertices to draw.
+        */
+        void _setVertexRange( VertexBufferPacked *vertexBuffer, uint32 vertexStart,
+                              VaoManager *vaoManager );
+
+        void _destroyVao( VaoManager *vaoManager );
+
+        /// Not supported; batches are never put in v1 RenderQueue groups. Throws.
+        virtual void getRenderOperation( v1::RenderOperation& op, bool casterPass );
+        /// @copydoc Renderable::getWorldTransforms
+        virtual void getWorldTransforms( Matrix4* xform ) const;
+        /// @copydoc Renderable::getLights
+        virtual const LightList& getLights(void) const;
+        virtual bool getPolygonModeOverrideable(void) const     { return false; }
+    };
+
+    /** Renders overlays with one draw call per run of elements sharing a datablock,
+        instead of one per element.
+    @remarks
+        Elements keep a CPU copy of their geometry in OverlayBatchVertex format, which
+        only gets re-tessellated when the element changes (i.e. the same conditions that
+        would trigger an upload to their v1 hardware buffers). Every frame the cached
+        vertices of all visible elements are copied into a single persistent mapped
+        v2 vertex buffer, and each batch renders a range of it.
+    @par
+        Only consecutive elements of the same Overlay get merged: whenever the datablock
+        changes a new batch starts, so elements are still drawn in hierarchy order.
+        Batches are queued in z-order, and OverlayManager switches the RenderQueue groups
+        of the batched overlays to FAST with sorting disabled, so that this order is kept.
+    @par
+        Enable it via OverlayManager::setBatchingEnabled. Overlays sharing a RenderQueue
+        group with an element type that doesn't fill mBatchVertices keep being rendered
+        the regular way.
+    */
+    class _OgreOverlayExport OverlayBatchRenderer : public OverlayAlloc
+    {
+        typedef vector<OverlayBatch*>::type OverlayBatchVec;
+
+        /// Batches of an Overlay. They're reused every frame in the order the runs appear.
+        struct OverlayBatches
+        {
+            OverlayBatchVec batches;
+            /// Number of batches that received geometry since the last _queueBatches
+            size_t          numUsed;
+
+            OverlayBatches() : numUsed( 0 ) {}
+        };
+
+        typedef map<const Overlay*, OverlayBatches>::type OverlayBatchesMap;
+
+        struct OrderByZOrder
+        {
+            bool operator () ( const OverlayBatch *left, const OverlayBatch *right ) const;
+        };
+
+        VaoManager          *mVaoManager;
+        VertexElement2Vec   mVertexElements;
+
+        OverlayBatchesMap   mBatches;
+        /// Batches that received geometry since the last call to _queueBatches
+        OverlayBatchVec     mActiveBatches;
+        /// Batch that received the last geometry. Following elements
+        /// with the same Overlay & datablock get appended to it.
+        OverlayBatch        *mLastBatch;
+
+        /// Dynamic buffers can only be mapped once per frame, so if we get asked
+        /// to render more than once in the same frame (e.g. several viewports)
+        /// we need a different buffer. Same scheme as RenderQueue's indirect buffers.
+        VertexBufferPackedVec   mFreeVertexBuffers;
+        VertexBufferPackedVec   mUsedVertexBuffers;
+        uint32                  mLastFrame;
+
+        VertexBufferPacked* getVertexBuffer( size_t numVertices );
+
+    public:
+        OverlayBatchRenderer( VaoManager *vaoManager );
+        ~OverlayBatchRenderer();
+
+        /** Adds the geometry of an element. It's appended to the previous element's batch
+            if both have the same overlay & datablock; otherwise it starts a new batch.
+        @param vertices
+            Must remain alive and unchanged until _queueBatches gets called.
+        */
+        void addGeometry( Overlay *overlay, HlmsDatablock *datablock,
+                          const OverlayBatchVertexVec &vertices );
+
+        /// Fills the vertex buffer with all the geometry added so far and queues the batches.
+        void _queueBatches( RenderQueue *queue );
+
+        /// Destroys all the batches belonging to the given overlay.
+        void _notifyOverlayDestroyed( const Overlay *overlay );
+
+        /// Converts to the byte order used by OverlayBatchVertex::colour
+        static uint32 convertColour( const ColourValue &colour );
+
+        /// Resizes vertices to hold numQuads quads. New vertices are white.
+        static void resizeQuads( OverlayBatchVertexVec &vertices, size_t numQuads );
+        /** Writes the positions of a quad as two triangles (6 vertices).
+            Top is expected to be greater than bottom.
+        */
+        static void setQuadPositions( OverlayBatchVertex *quad, Real left, Real top,
+                                      Real right, Real bottom, Real z );
+        /// Writes the texture coordinates of a quad written with setQuadPositions
+        static void setQuadUVs( OverlayBatchVertex *quad, Real u1, Real v1, Real u2, Real v2 );
+        /// Writes the same colour to all vertices of a quad
+        static void setQuadColour( OverlayBatchVertex *quad, uint32 colour );
+    };
+
+    /** @} */
+    /** @} */
+
+}
+}
+
+#endif
@@ -115,6 +115,9 @@ namespace v1 {
         /** Overridden from OverlayElement. */
         virtual void _updateRenderQueue(RenderQueue* queue, Camera *camera, const Camera *lodCamera);
 
+        /** Overridden from OverlayElement. */
+        virtual bool _isBatchable(void) const;
+
         /** Overridden from OverlayElement. */
         inline bool isContainer() const
         { return true; }
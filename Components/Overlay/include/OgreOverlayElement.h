@@ -35,6 +35,7 @@ THE SOFTWARE.
 #include "OgreStringInterface.h"
 #include "OgreOverlayElementCommands.h"
 #include "OgreColourValue.h"
+#include "OgreOverlayBatchRenderer.h"
 
 namespace Ogre {
 namespace v1 {
@@ -171,6 +172,14 @@ namespace v1 {
         /// Used to see if this element is created from a Template
         OverlayElement* mSourceTemplate ;
 
+        /// Cached geometry used instead of the v1 buffers when batching is enabled.
+        /// See OverlayBatchRenderer.
+        OverlayBatchVertexVec mBatchVertices;
+
+        /// True if our Overlay is being rendered by the OverlayBatchRenderer. Geometry
+        /// goes to mBatchVertices instead of the v1 buffers while it is. See Overlay::_isBatched.
+        bool mBatched;
+
         /** Internal method which is triggered when the positions of the element get updated,
         meaning the element should be rebuilding it's mesh positions. Abstract since
         subclasses must implement this.
@@ -293,6 +302,10 @@ namespace v1 {
         /** Tell the object to recalculate */
         virtual void _positionsOutOfDate(void);
 
+        /** Tell the object to regenerate all of its geometry,
+            e.g. because overlay batching was toggled. */
+        virtual void _geometryOutOfDate(void);
+
         /** Internal method to update the element based on transforms applied. */
         virtual void _update(void);
 
@@ -325,6 +338,16 @@ namespace v1 {
         /** Internal method to put the contents onto the render queue. */
         virtual void _updateRenderQueue(RenderQueue* queue, Camera *camera, const Camera *lodCamera);
 
+        /** Whether this type of element fills mBatchVertices, i.e. can be rendered by
+            the OverlayBatchRenderer. False unless overridden.
+        */
+        virtual bool _supportsBatching(void) const          { return false; }
+
+        /** Whether this element, and all the visible children of a container, can be
+            rendered by the OverlayBatchRenderer. Hidden elements don't prevent batching.
+        */
+        virtual bool _isBatchable(void) const;
+
         /** Gets the type name of the element. All concrete subclasses must implement this. */
         virtual const String& getTypeName(void) const = 0;
 
@@ -33,6 +33,7 @@ THE SOFTWARE.
 #include "OgreStringVector.h"
 #include "OgreScriptLoader.h"
 #include "OgreFrustum.h"
+#include "OgreRenderQueue.h"
 #include "Math/Array/OgreObjectMemoryManager.h"
 
 namespace Ogre {
@@ -89,6 +90,21 @@ namespace v1 {
         NodeMemoryManager       *mNodeMemoryManager;
         ObjectMemoryManager     mOverlayMemoryManager;
 
+        /// Null when batching is disabled
+        OverlayBatchRenderer    *mBatchRenderer;
+
+        struct SavedRenderQueueMode
+        {
+            RenderQueue::Modes      mode;
+            RenderQueue::RqSortMode sortMode;
+        };
+        typedef std::pair<RenderQueue*, uint8> RenderQueueGroupKey;
+        typedef map<RenderQueueGroupKey, SavedRenderQueueMode>::type SavedRenderQueueModeMap;
+
+        /// Modes the RenderQueue groups had before we switched them to FAST for the batches.
+        /// They get restored once no overlay of the group is batched anymore.
+        SavedRenderQueueModeMap mSavedRenderQueueModes;
+
 
         ElementMap& getElementMap(bool isTemplate);
 
@@ -133,6 +149,27 @@ namespace v1 {
         /** Internal method for queueing the visible overlays for rendering. */
         void _queueOverlaysForRendering( RenderQueue* pQueue, Viewport *vp );
 
+        /** Enables rendering consecutive elements of an Overlay that share the same
+            material with a single draw call, out of a v2 vertex buffer.
+            See OverlayBatchRenderer.
+        @remarks
+            Requires a RenderSystem with a VaoManager. Batches are v2 renderables, and a
+            RenderQueue group can't mix them with v1 ones. Thus the overlays of a group are
+            only batched if all their visible elements support it (see
+            OverlayElement::_supportsBatching); otherwise the whole group is rendered the
+            regular way, one v1 renderable per element.
+        @par
+            Groups that get batched are switched to RenderQueue::FAST mode with sorting
+            disabled, so don't put anything else in them. Their previous mode and sort
+            mode are restored once they stop being batched.
+            Disabled by default.
+        */
+        void setBatchingEnabled( bool bEnabled );
+        bool getBatchingEnabled(void) const                 { return mBatchRenderer != 0; }
+
+        /// Returns null if batching is disabled
+        OverlayBatchRenderer* _getBatchRenderer(void) const { return mBatchRenderer; }
+
         /** Gets the height of the destination viewport in pixels. */
         int getViewportHeight(void) const;
         
@@ -103,6 +103,8 @@ namespace v1 {
         void setMaterialName(const String& matName);
         /** Overridden from OverlayContainer */
         void _updateRenderQueue(RenderQueue* queue, Camera *camera, const Camera *lodCamera);
+        /** Overridden from OverlayElement */
+        virtual bool _supportsBatching(void) const          { return true; }
 
 
         /** Command object for specifying tiling (see ParamCommand).*/
@@ -123,6 +123,12 @@ namespace v1
         /** Overridden from OverlayElement */
         void _update(void);
 
+        /** Overridden from OverlayElement */
+        void _geometryOutOfDate(void);
+
+        /** Overridden from OverlayElement */
+        virtual bool _supportsBatching(void) const          { return true; }
+
         //-----------------------------------------------------------------------------------------
         /** Command object for setting the caption.
                 @see ParamCommand
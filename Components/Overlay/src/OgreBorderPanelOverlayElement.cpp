@@ -342,6 +342,18 @@ namespace v1 {
             |/    |
             1-----3
         */
+        if (mBatched)
+        {
+            OverlayBatchRenderer::resizeQuads(mBorderBatchVertices, 8);
+            for (uint i = 0; i < 8; ++i)
+            {
+                OverlayBatchRenderer::setQuadUVs(&mBorderBatchVertices[i * 6],
+                                                 mBorderUV[i].u1, mBorderUV[i].v1,
+                                                 mBorderUV[i].u2, mBorderUV[i].v2);
+            }
+            return;
+        }
+
         // No choice but to lock / unlock each time here, but lock only small sections
         
         HardwareVertexBufferSharedPtr vbuf = 
@@ -535,14 +547,32 @@ namespace v1 {
         bottom[5] = bottom[6] = bottom[7] = top[0] -  (mHeight * 2);
         top[5] = top[6] = top[7] = bottom[3] = bottom[4] = bottom[5] + (mBottomBorderSize * 2);
 
+        // Use the furthest away depth value, since materials should have depth-check off
+        // This initialised the depth buffer for any 3D objects in front
+        Real zValue = Root::getSingleton().getRenderSystem()->getMaximumDepthInputValue();
+
+        if (mBatched)
+        {
+            OverlayBatchRenderer::resizeQuads(mBorderBatchVertices, 8);
+            for (ushort cell = 0; cell < 8; ++cell)
+            {
+                OverlayBatchRenderer::setQuadPositions(&mBorderBatchVertices[cell * 6],
+                                                       left[cell], top[cell],
+                                                       right[cell], bottom[cell], zValue);
+            }
+
+            // Center uses cell 1 and 3 to determine positions
+            OverlayBatchRenderer::resizeQuads(mBatchVertices, 1);
+            OverlayBatchRenderer::setQuadPositions(&mBatchVertices[0], left[1], top[3],
+                                                   right[1], bottom[3], zValue);
+            return;
+        }
+
         // Lock the whole position buffer in discard mode
         HardwareVertexBufferSharedPtr vbuf = 
             mRenderOp2.vertexData->vertexBufferBinding->getBuffer(POSITION_BINDING);
         float* pPos = static_cast<float*>(
             vbuf->lock(HardwareBuffer::HBL_DISCARD, Root::getSingleton().getFreqUpdatedBuffersUploadOption()) );
-        // Use the furthest away depth value, since materials should have depth-check off
-        // This initialised the depth buffer for any 3D objects in front
-        Real zValue = Root::getSingleton().getRenderSystem()->getMaximumDepthInputValue();
         for (ushort cell = 0; cell < 8; ++cell)
         {
             /*
@@ -604,8 +634,16 @@ namespace v1 {
         if (mVisible)
         {
             // Add outer
-            queue->addRenderableV1( mOverlay->getRenderQueueGroup(), false,
-                                    mBorderRenderable, mOverlay );
+            if( mBatched )
+            {
+                OverlayManager::getSingleton()._getBatchRenderer()->addGeometry(
+                            mOverlay, mBorderRenderable->getDatablock(), mBorderBatchVertices );
+            }
+            else
+            {
+                queue->addRenderableV1( mOverlay->getRenderQueueGroup(), false,
+                                        mBorderRenderable, mOverlay );
+            }
 
             // do inner last so the border artifacts don't overwrite the children
             // Add inner
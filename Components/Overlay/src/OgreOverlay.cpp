@@ -47,7 +47,8 @@ namespace v1 {
         mScaleX(1.0f), mScaleY(1.0f),
         mLastViewportWidth(0), mLastViewportHeight(0),
         mTransformOutOfDate(true),
-        mInitialised(false)
+        mInitialised(false),
+        mBatched(false)
 
     {
         this->setName( name );
@@ -255,6 +256,21 @@ namespace v1 {
         }
     }
     //---------------------------------------------------------------------
+    bool Overlay::_isBatchable(void) const
+    {
+        bool retVal = true;
+
+        OverlayContainerList::const_iterator itor = m2DElements.begin();
+        OverlayContainerList::const_iterator end  = m2DElements.end();
+        while( itor != end && retVal )
+        {
+            retVal = (*itor)->_isBatchable();
+            ++itor;
+        }
+
+        return retVal;
+    }
+    //---------------------------------------------------------------------
     void Overlay::updateTransform(void) const
     {
         // Ordering:
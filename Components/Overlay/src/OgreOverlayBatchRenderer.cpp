@@ -0,0 +1,399 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+
+#include "OgreStableHeaders.h"
+
+#include "OgreOverlayBatchRenderer.h"
+#include "OgreOverlay.h"
+#include "OgreRenderQueue.h"
+#include "OgreHlmsDatablock.h"
+#include "OgreBitwise.h"
+#include "OgreException.h"
+#include "Vao/OgreVaoManager.h"
+#include "Vao/OgreVertexArrayObject.h"
+
+namespace Ogre {
+namespace v1 {
+    /// Smallest vertex buffer we'll create, in vertices.
+    static const uint32 c_minBatchVertices = 1024u;
+    //---------------------------------------------------------------------
+    OverlayBatch::OverlayBatch( Overlay *overlay, HlmsDatablock *datablock ) :
+        mOverlay( overlay ),
+        mBatchDatablock( datablock ),
+        mVao( 0 ),
+        mNumVertices( 0 )
+    {
+        mUseIdentityProjection = true;
+        mUseIdentityView = true;
+    }
+    //---------------------------------------------------------------------
+    OverlayBatch::~OverlayBatch()
+    {
+        assert( !mVao && "Call _destroyVao first!" );
+    }
+    //---------------------------------------------------------------------
+    void OverlayBatch::_setVertexRange( VertexBufferPacked *vertexBuffer, uint32 vertexStart,
+                                        VaoManager *vaoManager )
+    {
+        if( !mVao || mVao->getVertexBuffers()[0] != vertexBuffer )
+        {
+            _destroyVao( vaoManager );
+
+            VertexBufferPackedVec vertexBuffers;
+            vertexBuffers.push_back( vertexBuffer );
+            mVao = vaoManager->createVertexArrayObject( vertexBuffers, 0, OT_TRIANGLE_LIST );
+
+            mVaoPerLod[VpNormal].push_back( mVao );
+            mVaoPerLod[VpShadow].push_back( mVao );
+        }
+
+        //Batches get reused for other runs, which may have another datablock.
+        //The hash only needs recalculating when it changes.
+        if( mHlmsDatablock != mBatchDatablock )
+            setDatablock( mBatchDatablock );
+
+        mVao->setPrimitiveRange( vertexStart, mNumVertices );
+    }
+    //---------------------------------------------------------------------
+    void OverlayBatch::_destroyVao( VaoManager *vaoManager )
+    {
+        if( mVao )
+        {
+            vaoManager->destroyVertexArrayObject( mVao );
+            mVao = 0;
+            mVaoPerLod[VpNormal].clear();
+            mVaoPerLod[VpShadow].clear();
+        }
+    }
+    //---------------------------------------------------------------------
+    void OverlayBatch::getRenderOperation( v1::RenderOperation& op, bool casterPass )
+    {
+        OGRE_EXCEPT( Exception::ERR_NOT_IMPLEMENTED,
+                     "OverlayBatch is v2 only and has no v1 render operation. "
+                     "It can't be put in a v1 RenderQueue group.",
+                     "OverlayBatch::getRenderOperation" );
+    }
+    //---------------------------------------------------------------------
+    void OverlayBatch::getWorldTransforms( Matrix4* xform ) const
+    {
+        mOverlay->_getWorldTransforms( xform );
+    }
+    //---------------------------------------------------------------------
+    const LightList& OverlayBatch::getLights(void) const
+    {
+        // Overlays are not lit
+        static LightList ll;
+        return ll;
+    }
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    bool OverlayBatchRenderer::OrderByZOrder::operator () ( const OverlayBatch *left,
+                                                          const OverlayBatch *right ) const
+    {
+        return left->getOverlay()->getZOrder() < right->getOverlay()->getZOrder();
+    }
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    OverlayBatchRenderer::OverlayBatchRenderer( VaoManager *vaoManager ) :
+        mVaoManager( vaoManager ),
+        mLastBatch( 0 ),
+        mLastFrame( 0 )
+    {
+        mVertexElements.push_back( VertexElement2( VET_FLOAT3, VES_POSITION ) );
+        mVertexElements.push_back( VertexElement2( VET_FLOAT2, VES_TEXTURE_COORDINATES ) );
+        mVertexElements.push_back( VertexElement2( VET_UBYTE4_NORM, VES_DIFFUSE ) );
+
+        mLastFrame = mVaoManager->getFrameCount();
+    }
+    //---------------------------------------------------------------------
+    OverlayBatchRenderer::~OverlayBatchRenderer()
+    {
+        OverlayBatchesMap::const_iterator itor = mBatches.begin();
+        OverlayBatchesMap::const_iterator end  = mBatches.end();
+
+        while( itor != end )
+        {
+            OverlayBatchVec::const_iterator itBatch = itor->second.batches.begin();
+            OverlayBatchVec::const_iterator enBatch = itor->second.batches.end();
+
+            while( itBatch != enBatch )
+            {
+                (*itBatch)->_destroyVao( mVaoManager );
+                OGRE_DELETE *itBatch;
+                ++itBatch;
+            }
+
+            ++itor;
+        }
+
+        mBatches.clear();
+
+        mFreeVertexBuffers.insert( mFreeVertexBuffers.end(), mUsedVertexBuffers.begin(),
+                                   mUsedVertexBuffers.end() );
+        mUsedVertexBuffers.clear();
+
+        VertexBufferPackedVec::const_iterator itBuf = mFreeVertexBuffers.begin();
+        VertexBufferPackedVec::const_iterator enBuf = mFreeVertexBuffers.end();
+
+        while( itBuf != enBuf )
+        {
+            if( (*itBuf)->getMappingState() != MS_UNMAPPED )
+                (*itBuf)->unmap( UO_UNMAP_ALL );
+            mVaoManager->destroyVertexBuffer( *itBuf );
+            ++itBuf;
+        }
+
+        mFreeVertexBuffers.clear();
+    }
+    //---------------------------------------------------------------------
+    VertexBufferPacked* OverlayBatchRenderer::getVertexBuffer( size_t numVertices )
+    {
+        VertexBufferPackedVec::iterator itor = mFreeVertexBuffers.begin();
+        VertexBufferPackedVec::iterator end  = mFreeVertexBuffers.end();
+
+        size_t smallestBufferSize                           = std::numeric_limits<size_t>::max();
+        VertexBufferPackedVec::iterator smallestBuffer      = end;
+
+        //Find the smallest buffer in the pool that can fit the request.
+        while( itor != end )
+        {
+            size_t bufferSize = (*itor)->getNumElements();
+            if( numVertices <= bufferSize && smallestBufferSize > bufferSize )
+            {
+                smallestBuffer      = itor;
+                smallestBufferSize  = bufferSize;
+            }
+
+            ++itor;
+        }
+
+        if( smallestBuffer == end )
+        {
+            //None found? Create a new one. Round up to avoid recreating
+            //it every time a few more elements become visible.
+            const uint32 bufferSize = std::max( Bitwise::firstPO2From(
+                                                    static_cast<uint32>( numVertices ) ),
+                                                c_minBatchVertices );
+            mFreeVertexBuffers.push_back( mVaoManager->createVertexBuffer( mVertexElements,
+                                                                           bufferSize,
+                                                                           BT_DYNAMIC_PERSISTENT,
+                                                                           0, false ) );
+            smallestBuffer = mFreeVertexBuffers.end() - 1;
+        }
+
+        VertexBufferPacked *retVal = *smallestBuffer;
+
+        mUsedVertexBuffers.push_back( *smallestBuffer );
+        efficientVectorRemove( mFreeVertexBuffers, smallestBuffer );
+
+        return retVal;
+    }
+    //---------------------------------------------------------------------
+    void OverlayBatchRenderer::addGeometry( Overlay *overlay, HlmsDatablock *datablock,
+                                            const OverlayBatchVertexVec &vertices )
+    {
+        if( vertices.empty() || !datablock )
+            return;
+
+        if( !mLastBatch || mLastBatch->mOverlay != overlay ||
+            mLastBatch->mBatchDatablock != datablock )
+        {
+            //Start a new run. Only consecutive elements can be merged,
+            //otherwise we would change the order they're drawn in.
+            OverlayBatches &overlayBatches = mBatches[overlay];
+            if( overlayBatches.numUsed == overlayBatches.batches.size() )
+                overlayBatches.batches.push_back( OGRE_NEW OverlayBatch( overlay, datablock ) );
+
+            mLastBatch = overlayBatches.batches[overlayBatches.numUsed++];
+            mLastBatch->mBatchDatablock = datablock;
+            mActiveBatches.push_back( mLastBatch );
+        }
+
+        mLastBatch->mGeometry.push_back( &vertices );
+        mLastBatch->mNumVertices += static_cast<uint32>( vertices.size() );
+    }
+    //---------------------------------------------------------------------
+    void OverlayBatchRenderer::_queueBatches( RenderQueue *queue )
+    {
+        const uint32 currentFrame = mVaoManager->getFrameCount();
+        if( mLastFrame != currentFrame )
+        {
+            //The GPU is done with this frame's copy of the dynamic buffers. Recycle them.
+            mFreeVertexBuffers.insert( mFreeVertexBuffers.end(), mUsedVertexBuffers.begin(),
+                                       mUsedVertexBuffers.end() );
+            mUsedVertexBuffers.clear();
+            mLastFrame = currentFrame;
+        }
+
+        //Overlays are drawn in z-order. The batches of each overlay keep their order.
+        std::stable_sort( mActiveBatches.begin(), mActiveBatches.end(), OrderByZOrder() );
+
+        size_t totalVertices = 0;
+        OverlayBatchVec::const_iterator itor = mActiveBatches.begin();
+        OverlayBatchVec::const_iterator end  = mActiveBatches.end();
+        while( itor != end )
+        {
+            totalVertices += (*itor)->mNumVertices;
+            ++itor;
+        }
+
+        if( totalVertices )
+        {
+            VertexBufferPacked *vertexBuffer = getVertexBuffer( totalVertices );
+
+            OverlayBatchVertex * RESTRICT_ALIAS vertexData =
+                    reinterpret_cast<OverlayBatchVertex * RESTRICT_ALIAS>(
+                        vertexBuffer->map( 0, totalVertices ) );
+
+            uint32 vertexStart = 0;
+
+            itor = mActiveBatches.begin();
+            while( itor != end )
+            {
+                OverlayBatch *batch = *itor;
+                Overlay *overlay = batch->mOverlay;
+
+                OverlayBatch::VertexVecPtrVec::const_iterator itGeom = batch->mGeometry.begin();
+                OverlayBatch::VertexVecPtrVec::const_iterator enGeom = batch->mGeometry.end();
+                while( itGeom != enGeom )
+                {
+                    const OverlayBatchVertexVec &vertices = **itGeom;
+                    memcpy( vertexData, &vertices[0], vertices.size() * sizeof(OverlayBatchVertex) );
+                    vertexData += vertices.size();
+                    ++itGeom;
+                }
+
+                batch->_setVertexRange( vertexBuffer, vertexStart, mVaoManager );
+                vertexStart += batch->mNumVertices;
+
+                //OverlayManager already switched the group to FAST without sorting.
+                queue->addRenderableV2( 0, overlay->getRenderQueueGroup(), false, batch, overlay );
+
+                batch->mGeometry.clear();
+                batch->mNumVertices = 0;
+
+                ++itor;
+            }
+
+            vertexBuffer->unmap( UO_KEEP_PERSISTENT );
+        }
+
+        mActiveBatches.clear();
+        mLastBatch = 0;
+
+        OverlayBatchesMap::iterator itBatches = mBatches.begin();
+        OverlayBatchesMap::iterator enBatches = mBatches.end();
+        while( itBatches != enBatches )
+        {
+            itBatches->second.numUsed = 0;
+            ++itBatches;
+        }
+    }
+    //---------------------------------------------------------------------
+    void OverlayBatchRenderer::_notifyOverlayDestroyed( const Overlay *overlay )
+    {
+        assert( mActiveBatches.empty() );
+
+        OverlayBatchesMap::iterator itor = mBatches.find( overlay );
+        if( itor != mBatches.end() )
+        {
+            OverlayBatchVec::const_iterator itBatch = itor->second.batches.begin();
+            OverlayBatchVec::const_iterator enBatch = itor->second.batches.end();
+
+            while( itBatch != enBatch )
+            {
+                (*itBatch)->_destroyVao( mVaoManager );
+                OGRE_DELETE *itBatch;
+                ++itBatch;
+            }
+
+            mBatches.erase( itor );
+        }
+
+        mLastBatch = 0;
+    }
+    //---------------------------------------------------------------------
+    uint32 OverlayBatchRenderer::convertColour( const ColourValue &colour )
+    {
+        //VET_UBYTE4_NORM is always RGBA in memory
+#if OGRE_ENDIAN == OGRE_ENDIAN_BIG
+        return colour.getAsRGBA();
+#else
+        return colour.getAsABGR();
+#endif
+    }
+    //---------------------------------------------------------------------
+    void OverlayBatchRenderer::resizeQuads( OverlayBatchVertexVec &vertices, size_t numQuads )
+    {
+        if( vertices.size() != numQuads * 6u )
+        {
+            OverlayBatchVertex white;
+            memset( &white, 0, sizeof(OverlayBatchVertex) );
+            white.colour = convertColour( ColourValue::White );
+            vertices.resize( numQuads * 6u, white );
+        }
+    }
+    //---------------------------------------------------------------------
+    void OverlayBatchRenderer::setQuadPositions( OverlayBatchVertex *quad, Real left, Real top,
+                                                 Real right, Real bottom, Real z )
+    {
+        /*
+            0-----2
+            |    /|
+            |  /  |
+            |/    |
+            1-----3
+            Triangles are 0 1 2 and 2 1 3
+        */
+        quad[0].x = left;   quad[0].y = top;    quad[0].z = z;
+        quad[1].x = left;   quad[1].y = bottom; quad[1].z = z;
+        quad[2].x = right;  quad[2].y = top;    quad[2].z = z;
+        quad[3].x = right;  quad[3].y = top;    quad[3].z = z;
+        quad[4].x = left;   quad[4].y = bottom; quad[4].z = z;
+        quad[5].x = right;  quad[5].y = bottom; quad[5].z = z;
+    }
+    //---------------------------------------------------------------------
+    void OverlayBatchRenderer::setQuadUVs( OverlayBatchVertex *quad, Real u1, Real v1,
+                                           Real u2, Real v2 )
+    {
+        quad[0].u = u1; quad[0].v = v1;
+        quad[1].u = u1; quad[1].v = v2;
+        quad[2].u = u2; quad[2].v = v1;
+        quad[3].u = u2; quad[3].v = v1;
+        quad[4].u = u1; quad[4].v = v2;
+        quad[5].u = u2; quad[5].v = v2;
+    }
+    //---------------------------------------------------------------------
+    void OverlayBatchRenderer::setQuadColour( OverlayBatchVertex *quad, uint32 colour )
+    {
+        for( size_t i=0; i<6u; ++i )
+            quad[i].colour = colour;
+    }
+}
+}
@@ -273,6 +273,25 @@ namespace v1 {
     }
 
 
+    //---------------------------------------------------------------------
+    bool OverlayContainer::_isBatchable(void) const
+    {
+        if( !mVisible )
+            return true;
+
+        bool retVal = _supportsBatching();
+
+        ChildMap::const_iterator itor = mChildren.begin();
+        ChildMap::const_iterator end  = mChildren.end();
+        while( itor != end && retVal )
+        {
+            retVal = itor->second->_isBatchable();
+            ++itor;
+        }
+
+        return retVal;
+    }
+
     OverlayElement* OverlayContainer::findElementAt(Real x, Real y)         // relative to parent
     {
 
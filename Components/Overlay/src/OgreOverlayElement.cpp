@@ -81,6 +81,7 @@ namespace v1 {
       , mEnabled(true)
       , mInitialised(false)
       , mSourceTemplate(0)
+      , mBatched(false)
     {
         // default overlays to preserve their own detail level
         mPolygonModeOverrideable = false;
@@ -354,8 +355,22 @@ namespace v1 {
         mGeomPositionsOutOfDate = true;
     }
     //---------------------------------------------------------------------
+    void OverlayElement::_geometryOutOfDate(void)
+    {
+        mGeomPositionsOutOfDate = true;
+        mGeomUVsOutOfDate = true;
+    }
+    //---------------------------------------------------------------------
     void OverlayElement::_update(void)
     {
+        // Elements only keep the geometry of the mode they're rendered in
+        const bool batched = mOverlay && mOverlay->_isBatched();
+        if( mBatched != batched )
+        {
+            mBatched = batched;
+            _geometryOutOfDate();
+        }
+
         Real vpWidth, vpHeight;
         OverlayManager& oMgr = OverlayManager::getSingleton();
         vpWidth = (Real) (oMgr.getViewportWidth());
@@ -620,9 +635,22 @@ namespace v1 {
     {
         if (mVisible)
         {
-            queue->addRenderableV1( mOverlay->getRenderQueueGroup(), false, this, mOverlay );
+            if( mBatched )
+            {
+                OverlayManager::getSingleton()._getBatchRenderer()->addGeometry(
+                            mOverlay, mHlmsDatablock, mBatchVertices );
+            }
+            else
+            {
+                queue->addRenderableV1( mOverlay->getRenderQueueGroup(), false, this, mOverlay );
+            }
         }
     }
+    //---------------------------------------------------------------------
+    bool OverlayElement::_isBatchable(void) const
+    {
+        return !mVisible || _supportsBatching();
+    }
     //-----------------------------------------------------------------------
     void OverlayElement::addBaseParameters(void)    
     {
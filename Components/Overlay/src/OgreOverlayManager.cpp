@@ -34,6 +34,9 @@ THE SOFTWARE.
 #include "OgreOverlay.h"
 #include "OgreResourceGroupManager.h"
 #include "OgreOverlayElementFactory.h"
+#include "OgreOverlayBatchRenderer.h"
+#include "OgreRoot.h"
+#include "OgreRenderSystem.h"
 #include "OgreRenderQueue.h"
 #include "OgreStringConverter.h"
 #include "Math/Array/OgreNodeMemoryManager.h"
@@ -59,7 +62,8 @@ namespace v1
         mLastViewportHeight(0), 
         mLastViewportOrientationMode(OR_DEGREE_0),
         mDummyNode(0),
-        mNodeMemoryManager(0)
+        mNodeMemoryManager(0),
+        mBatchRenderer(0)
     {
         // Scripting is supported by this manager
         mScriptPatterns.push_back("*.overlay");
@@ -76,6 +80,9 @@ namespace v1
         destroyAllOverlayElements(true);
         destroyAll();
 
+        OGRE_DELETE mBatchRenderer;
+        mBatchRenderer = 0;
+
         for(FactoryMap::iterator i = mFactories.begin(); i != mFactories.end(); ++i)
         {
             OGRE_DELETE i->second;
@@ -151,6 +158,8 @@ namespace v1
         }
         else
         {
+            if( mBatchRenderer )
+                mBatchRenderer->_notifyOverlayDestroyed( i->second );
             mDummyNode->detachObject( i->second );
             OGRE_DELETE i->second;
             mOverlayMap.erase(i);
@@ -164,6 +173,8 @@ namespace v1
         {
             if (i->second == overlay)
             {
+                if( mBatchRenderer )
+                    mBatchRenderer->_notifyOverlayDestroyed( i->second );
                 mDummyNode->detachObject( i->second );
                 OGRE_DELETE i->second;
                 mOverlayMap.erase(i);
@@ -182,6 +193,8 @@ namespace v1
         for (OverlayMap::iterator i = mOverlayMap.begin();
             i != mOverlayMap.end(); ++i)
         {
+            if( mBatchRenderer )
+                mBatchRenderer->_notifyOverlayDestroyed( i->second );
             OGRE_DELETE i->second;
         }
         mOverlayMap.clear();
@@ -300,6 +313,49 @@ namespace v1
 
         OverlayMap::iterator i, iend;
         iend = mOverlayMap.end();
+
+        // Batches are v2 renderables and can't share a RenderQueue group with v1 ones.
+        // A group is only batched if all the visible overlays in it can be batched.
+        bool batchedGroups[256];
+        memset( batchedGroups, 0, sizeof( batchedGroups ) );
+
+        if( mBatchRenderer )
+        {
+            bool unbatchableGroups[256];
+            memset( unbatchableGroups, 0, sizeof( unbatchableGroups ) );
+
+            for (i = mOverlayMap.begin(); i != iend; ++i)
+            {
+                const Overlay *o = i->second;
+                if( o->getVisible() )
+                {
+                    const uint8 rqId = o->getRenderQueueGroup();
+                    batchedGroups[rqId] = true;
+                    unbatchableGroups[rqId] |= !o->_isBatchable();
+                }
+            }
+
+            for( size_t j=0; j<256u; ++j )
+                batchedGroups[j] &= !unbatchableGroups[j];
+        }
+
+        // Give back their mode to the groups that are no longer batched
+        SavedRenderQueueModeMap::iterator itSaved = mSavedRenderQueueModes.begin();
+        while( itSaved != mSavedRenderQueueModes.end() )
+        {
+            const RenderQueueGroupKey &key = itSaved->first;
+            if( key.first == pQueue && !batchedGroups[key.second] )
+            {
+                pQueue->setRenderQueueMode( key.second, itSaved->second.mode );
+                pQueue->setSortRenderQueue( key.second, itSaved->second.sortMode );
+                mSavedRenderQueueModes.erase( itSaved++ );
+            }
+            else
+            {
+                ++itSaved;
+            }
+        }
+
         for (i = mOverlayMap.begin(); i != iend; ++i)
         {
             Overlay* o = i->second;
@@ -310,8 +366,45 @@ namespace v1
                 o->scroll(0.f, 0.f);
             }
 #endif
+
+            const uint8 rqId = o->getRenderQueueGroup();
+            o->_setBatched( batchedGroups[rqId] );
+
+            if( batchedGroups[rqId] )
+            {
+                SavedRenderQueueMode savedMode;
+                savedMode.mode      = pQueue->getRenderQueueMode( rqId );
+                savedMode.sortMode  = pQueue->getSortRenderQueue( rqId );
+                mSavedRenderQueueModes.insert( std::make_pair( RenderQueueGroupKey( pQueue, rqId ),
+                                                               savedMode ) );
+
+                // The queue must keep the order the batches are added in.
+                pQueue->setRenderQueueMode( rqId, RenderQueue::FAST );
+                pQueue->setSortRenderQueue( rqId, RenderQueue::DisableSort );
+            }
+
             o->_updateRenderQueue( pQueue, (Camera*)(0), (Camera*)(0), vp );
         }
+
+        if( mBatchRenderer )
+            mBatchRenderer->_queueBatches( pQueue );
+    }
+    //---------------------------------------------------------------------
+    void OverlayManager::setBatchingEnabled( bool bEnabled )
+    {
+        if( bEnabled == (mBatchRenderer != 0) )
+            return;
+
+        if( bEnabled )
+        {
+            VaoManager *vaoManager = Root::getSingleton().getRenderSystem()->getVaoManager();
+            mBatchRenderer = OGRE_NEW OverlayBatchRenderer( vaoManager );
+        }
+        else
+        {
+            OGRE_DELETE mBatchRenderer;
+            mBatchRenderer = 0;
+        }
     }
     //---------------------------------------------------------------------
     void OverlayManager::parseNewElement( DataStreamPtr& stream, String& elemType, String& elemName, 
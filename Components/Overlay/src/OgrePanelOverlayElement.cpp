@@ -228,14 +228,22 @@ namespace v1 {
         top = -((_getDerivedTop() * 2) - 1);
         bottom =  top -  (mHeight * 2);
 
+        // Use the furthest away depth value, since materials should have depth-check off
+        // This initialised the depth buffer for any 3D objects in front
+        Real zValue = Root::getSingleton().getRenderSystem()->getMaximumDepthInputValue();
+
+        if (mBatched)
+        {
+            OverlayBatchRenderer::resizeQuads(mBatchVertices, 1);
+            OverlayBatchRenderer::setQuadPositions(&mBatchVertices[0], left, top, right, bottom, zValue);
+            return;
+        }
+
         HardwareVertexBufferSharedPtr vbuf =
             mRenderOp.vertexData->vertexBufferBinding->getBuffer(POSITION_BINDING);
         float* pPos = static_cast<float*>(
             vbuf->lock(HardwareBuffer::HBL_DISCARD, Root::getSingleton().getFreqUpdatedBuffersUploadOption()) );
 
-        // Use the furthest away depth value, since materials should have depth-check off
-        // This initialised the depth buffer for any 3D objects in front
-        Real zValue = Root::getSingleton().getRenderSystem()->getMaximumDepthInputValue();
         *pPos++ = left;
         *pPos++ = top;
         *pPos++ = zValue;
@@ -273,6 +281,15 @@ namespace v1 {
             uint8 numLayers = guiDatablock->getNumUvSets();
 #endif
 
+            if (mBatched)
+            {
+                // Batched geometry only has one UV set
+                OverlayBatchRenderer::resizeQuads(mBatchVertices, 1);
+                OverlayBatchRenderer::setQuadUVs(&mBatchVertices[0], mU1, mV1,
+                                                 mU2 * mTileX[0], mV2 * mTileY[0]);
+                return;
+            }
+
             VertexDeclaration* decl = mRenderOp.vertexData->vertexDeclaration;
             // Check the number of texcoords we have in our buffer now
             if (mNumTexCoordsInBuffer > numLayers)
@@ -161,15 +161,30 @@ namespace v1 {
             return;
         }
 
+        const bool batched = mBatched;
+
         size_t charlen = mCaption.size();
-        checkMemoryAllocation( charlen );
+        HardwareVertexBufferSharedPtr vbuf;
+
+        if( batched )
+        {
+            // Batched vertices are (x, y, z, u, v, colour). Colours get filled by updateColours
+            mBatchVertices.resize( charlen * 6 );
+            pVert = mBatchVertices.empty() ? 0 : &mBatchVertices[0].x;
+        }
+        else
+        {
+            checkMemoryAllocation( charlen );
+
+            // Get position / texcoord buffer
+            vbuf = mRenderOp.vertexData->vertexBufferBinding->getBuffer(POS_TEX_BINDING);
+            pVert = static_cast<float*>(
+                vbuf->lock(HardwareBuffer::HBL_DISCARD, Root::getSingleton().getFreqUpdatedBuffersUploadOption()) );
+        }
 
         mRenderOp.vertexData->vertexCount = charlen * 6;
-        // Get position / texcoord buffer
-        const HardwareVertexBufferSharedPtr& vbuf = 
-            mRenderOp.vertexData->vertexBufferBinding->getBuffer(POS_TEX_BINDING);
-        pVert = static_cast<float*>(
-            vbuf->lock(HardwareBuffer::HBL_DISCARD, Root::getSingleton().getFreqUpdatedBuffersUploadOption()) );
+        // Floats to skip after writing each vertex's (x, y, z, u, v)
+        const size_t vertexPadding = batched ? sizeof(OverlayBatchVertex) / sizeof(float) - 5u : 0u;
 
         float largestWidth = 0;
         float left = _getDerivedLeft() * 2.0f - 1.0f;
@@ -265,6 +280,7 @@ namespace v1 {
             *pVert++ = -1.0;
             *pVert++ = uvRect.left;
             *pVert++ = uvRect.top;
+            pVert += vertexPadding;
 
             top -= mCharHeight * 2.0f;
 
@@ -274,6 +290,7 @@ namespace v1 {
             *pVert++ = -1.0;
             *pVert++ = uvRect.left;
             *pVert++ = uvRect.bottom;
+            pVert += vertexPadding;
 
             top += mCharHeight * 2.0f;
             left += horiz_height * mCharHeight * 2.0f;
@@ -284,6 +301,7 @@ namespace v1 {
             *pVert++ = -1.0;
             *pVert++ = uvRect.right;
             *pVert++ = uvRect.top;
+            pVert += vertexPadding;
             //-------------------------------------------------------------------------------------
 
             //-------------------------------------------------------------------------------------
@@ -295,6 +313,7 @@ namespace v1 {
             *pVert++ = -1.0;
             *pVert++ = uvRect.right;
             *pVert++ = uvRect.top;
+            pVert += vertexPadding;
 
             top -= mCharHeight * 2.0f;
             left -= horiz_height  * mCharHeight * 2.0f;
@@ -305,6 +324,7 @@ namespace v1 {
             *pVert++ = -1.0;
             *pVert++ = uvRect.left;
             *pVert++ = uvRect.bottom;
+            pVert += vertexPadding;
 
             left += horiz_height  * mCharHeight * 2.0f;
 
@@ -314,6 +334,7 @@ namespace v1 {
             *pVert++ = -1.0;
             *pVert++ = uvRect.right;
             *pVert++ = uvRect.bottom;
+            pVert += vertexPadding;
             //-------------------------------------------------------------------------------------
 
             // Go back up with top
@@ -326,8 +347,17 @@ namespace v1 {
 
             }
         }
-        // Unlock vertex buffer
-        vbuf->unlock();
+        if( batched )
+        {
+            // Drop the slots reserved for spaces & newlines
+            mBatchVertices.resize( mRenderOp.vertexData->vertexCount );
+            mColoursChanged = true;
+        }
+        else
+        {
+            // Unlock vertex buffer
+            vbuf->unlock();
+        }
 
         if (mMetricsMode == GMM_PIXELS)
         {
@@ -530,6 +560,25 @@ namespace v1 {
     //---------------------------------------------------------------------
     void TextAreaOverlayElement::updateColours(void)
     {
+        if( mBatched )
+        {
+            const uint32 topColour      = OverlayBatchRenderer::convertColour( mColourTop );
+            const uint32 bottomColour   = OverlayBatchRenderer::convertColour( mColourBottom );
+
+            for (size_t i = 0; i < mBatchVertices.size(); i += 6)
+            {
+                // First tri (top, bottom, top)
+                mBatchVertices[i+0].colour = topColour;
+                mBatchVertices[i+1].colour = bottomColour;
+                mBatchVertices[i+2].colour = topColour;
+                // Second tri (top, bottom, bottom)
+                mBatchVertices[i+3].colour = topColour;
+                mBatchVertices[i+4].colour = bottomColour;
+                mBatchVertices[i+5].colour = bottomColour;
+            }
+            return;
+        }
+
         // Convert to system-specific
         RGBA topColour, bottomColour;
         Root::getSingleton().convertColourValue(mColourTop, &topColour);
@@ -585,6 +634,12 @@ namespace v1 {
         }
     }
     //-----------------------------------------------------------------------
+    void TextAreaOverlayElement::_geometryOutOfDate(void)
+    {
+        OverlayElement::_geometryOutOfDate();
+        mColoursChanged = true;
+    }
+    //-----------------------------------------------------------------------
     void TextAreaOverlayElement::_update(void)
     {
         Real vpWidth, vpHeight;
@@ -91,6 +91,36 @@ namespace Ogre
             VERSION_1,
             LATEST_VERSION = VERSION_1
         };
+
+        /** Table of contents entry of a sectioned scene.
+            @See SceneFormatExporter::exportSceneSectionedToFile
+        @remarks
+            A sectioned scene ("scene.oscn") is a binary container: a header, the table
+            of contents and then one JSON document per section (same schema as
+            scene.json). Scene nodes keep their global index as "id" so sections
+            can reference nodes from section 0.
+        */
+        struct Section
+        {
+            /// World space bounds of the nodes & objects in this section.
+            /// Section 0 holds the scene settings and anything that couldn't be
+            /// assigned to a single section; and is always imported first.
+            Aabb    aabb;
+            /// Location and size in bytes of the JSON document, from the start of the file.
+            uint64  offset;
+            uint64  sizeBytes;
+            uint32  numSceneNodes;
+            uint32  numItems;
+            uint32  numEntities;
+            uint32  numLights;
+
+            Section() :
+                aabb( Aabb::BOX_NULL ), offset( 0 ), sizeBytes( 0 ), numSceneNodes( 0 ),
+                numItems( 0 ), numEntities( 0 ), numLights( 0 ) {}
+        };
+
+        typedef vector<Section>::type SectionVec;
+
     protected:
         Root                    *mRoot;
         SceneManager            *mSceneManager;
@@ -98,6 +128,18 @@ namespace Ogre
 
         static const char* c_lightTypes[Light::NUM_LIGHT_TYPES+1u];
 
+        /// 'OGSS' in a little endian file; byteswapped if the endianness doesn't match.
+        static const uint32 c_sectionedMagic;
+        static const uint32 c_sectionedVersion;
+        /// Header is magic, version, number of sections & reserved (uint32 each).
+        static const size_t c_sectionedHeaderSize;
+        static const size_t c_sectionedTocEntrySize;
+
+        /// Writes the header and table of contents. The offsets must already be set.
+        static void writeSectionTable( const SectionVec &sections, vector<uint8>::type &outData );
+        /// Reads & validates what writeSectionTable wrote. Throws on malformed input.
+        static void readSectionTable( DataStreamPtr &stream, SectionVec &outSections );
+
     public:
         SceneFormatBase( Root *root, SceneManager *sceneManager );
         ~SceneFormatBase();
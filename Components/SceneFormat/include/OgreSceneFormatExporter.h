@@ -111,6 +111,8 @@ namespace Ogre
         */
         void _exportScene( String &outJson, uint32 exportFlags=~0u );
 
+        void exportMaterialsAndTextures( const String &folderPath, uint32 exportFlags );
+
     public:
         SceneFormatExporter( Root *root, SceneManager *sceneManager,
                              InstantRadiosity *instantRadiosity );
@@ -149,6 +151,26 @@ namespace Ogre
 
         void exportSceneToFile( const String &folderPath,
                                 uint32 exportFlags=~SceneFlags::TexturesOriginal );
+
+        /** Exports the scene to folderPath/scene.oscn, a binary container with a table of
+            contents that splits the scene into spatial sections (a regular grid of
+            sectionSize units, based on the derived position of each SceneNode).
+            Each section can then be imported independently and incrementally.
+            @See SceneFormatImporter::openSectionedScene
+        @remarks
+            Section 0 always contains the root nodes, the scene settings and every
+            node that is parent to nodes from other sections (plus objects attached
+            to them). It is always imported first.
+            Meshes, materials and textures are exported like exportSceneToFile does.
+        @param folderPath
+            Folder where to save the scene and its resources.
+        @param sectionSize
+            Size in units of each cell of the grid. Must be greater than 0.
+        @param exportFlags
+            Combination of SceneFlags::SceneFlags, to know what to export and what to exclude.
+        */
+        void exportSceneSectionedToFile( const String &folderPath, Real sectionSize,
+                                         uint32 exportFlags=~SceneFlags::TexturesOriginal );
     };
 
     /** @} */
@@ -61,6 +61,17 @@ namespace Ogre
     */
     class _OgreSceneFormatExport SceneFormatImporter : public SceneFormatBase
     {
+    public:
+        enum SectionState
+        {
+            SectionUnloaded,
+            /// Waiting in the queue for updateStreaming to process it
+            SectionQueued,
+            /// Partially imported. updateStreaming will continue where it left
+            SectionLoading,
+            SectionLoaded
+        };
+
     protected:
         String mFilename;
         InstantRadiosity *mInstantRadiosity;
@@ -79,6 +90,23 @@ namespace Ogre
         SceneNode *mRootNodes[NUM_SCENE_MEMORY_MANAGER_TYPES];
         SceneNode *mParentlessRootNodes[NUM_SCENE_MEMORY_MANAGER_TYPES];
 
+        typedef vector<SectionState>::type SectionStateVec;
+
+        String              mSectionedFolder;
+        DataStreamPtr       mSectionedStream;
+        uint32              mSectionedImportFlags;
+        SectionVec          mSections;
+        SectionStateVec     mSectionStates;
+        deque<uint32>::type mSectionQueue;
+
+        /// Section being imported by updateStreaming. -1 if none.
+        uint32                  mCurrentSection;
+        /// 0 = scene nodes, 1 = items, 2 = entities, 3 = lights
+        uint32                  mCurrentSectionPhase;
+        uint32                  mCurrentSectionEntry;
+        vector<char>::type      mCurrentSectionData;
+        rapidjson::Document     *mCurrentSectionDoc;
+
         void destroyInstantRadiosity(void);
         void destroyParallaxCorrectedCubemap(void);
 
@@ -115,9 +143,28 @@ namespace Ogre
         void importPcc( const rapidjson::Value &pccValue );
         void importSceneSettings( const rapidjson::Value &json, uint32 importFlags );
 
+        void bindRootNodes( SceneNode *outOldRootNodes[NUM_SCENE_MEMORY_MANAGER_TYPES] );
+        void restoreRootNodes( SceneNode * const oldRootNodes[NUM_SCENE_MEMORY_MANAGER_TYPES] );
+
+        void importHeader( const rapidjson::Value &d );
+        void importObjects( const rapidjson::Value &d, uint32 importFlags );
+        /// Removes the VPLs (if requested) and builds InstantRadiosity.
+        void finishImport( uint32 importFlags );
+
         void importScene( const String &filename, const rapidjson::Document &d,
                           uint32 importFlags=~SceneFlags::LightsVpl );
 
+        /// Reads and parses the given section into mCurrentSectionDoc,
+        /// and reserves memory for all the nodes & objects it will create.
+        void parseSection( uint32 sectionIdx );
+        void reserveSectionMemory( const rapidjson::Value &d );
+        void importSectionSceneNode( const rapidjson::Value &sceneNodeValue );
+        /** Continues importing mCurrentSectionDoc where it was left.
+        @return
+            True if the section was fully imported. False if we ran out of time.
+        */
+        bool importSectionObjects( Timer &timer, uint64 maxMicroseconds );
+
     public:
         /**
         @param root
@@ -203,6 +250,56 @@ namespace Ogre
 
         void importSceneFromFile( const String &filename, uint32 importFlags=~SceneFlags::LightsVpl );
 
+        /** Imports a whole scene exported with SceneFormatExporter::exportSceneSectionedToFile.
+            It's the same as calling openSectionedScene, queueing all sections,
+            calling updateStreaming until it returns true, then closeSectionedScene.
+        */
+        void importSceneSectionedFromFile( const String &folderPath,
+                                           uint32 importFlags=~SceneFlags::LightsVpl );
+
+        /** Opens a scene exported with SceneFormatExporter::exportSceneSectionedToFile
+            for incremental import. Reads the table of contents and imports section 0
+            (root nodes, scene settings and shared parent nodes) synchronously.
+            Other sections are imported via queueSection & updateStreaming.
+        @remarks
+            The folder is registered in the "SceneFormatImporter" resource group until
+            closeSectionedScene is called. Only one sectioned scene can be open at a time.
+        @param folderPath
+            Folder containing scene.oscn
+        @param importFlags
+            See importScene.
+        */
+        void openSectionedScene( const String &folderPath,
+                                 uint32 importFlags=~SceneFlags::LightsVpl );
+
+        /** Finishes importing the sectioned scene (i.e. builds InstantRadiosity with
+            everything that has been loaded) and releases the file.
+            Sections that were queued but not yet imported are discarded.
+        */
+        void closeSectionedScene(void);
+
+        size_t getNumSections(void) const                   { return mSections.size(); }
+        const Section& getSection( size_t idx ) const       { return mSections[idx]; }
+        SectionState getSectionState( size_t idx ) const    { return mSectionStates[idx]; }
+
+        /// Queues the section for import. Does nothing if already queued or loaded.
+        void queueSection( uint32 sectionIdx );
+        /// Queues all the sections whose bounds intersect the given area.
+        void queueSectionsInArea( const Aabb &area );
+
+        /** Imports queued sections until the queue is empty or maxMicroseconds elapsed.
+            Call it once per frame to stream in a scene without stalling.
+        @remarks
+            At least one node or object is created per call. Memory for all the nodes &
+            objects of a section is reserved up front, so a section reallocates the
+            SceneManager's memory pools at most once per depth level / render queue.
+        @param maxMicroseconds
+            Time budget for this call.
+        @return
+            True if there is nothing left to import.
+        */
+        bool updateStreaming( uint64 maxMicroseconds );
+
         /** Retrieve the InstantRadiosity pointer that may have been created while importing a scene
         @param releaseOwnership
             If true, we will return the InstantRadiosity & IrradianceVolume pointers and
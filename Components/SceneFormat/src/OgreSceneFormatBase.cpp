@@ -34,6 +34,8 @@ THE SOFTWARE.
 #include "OgreItem.h"
 #include "OgreEntity.h"
 #include "OgreLight.h"
+#include "OgreDataStream.h"
+#include "OgreBitwise.h"
 
 #include "OgreHlmsPbs.h"
 #include "Cubemaps/OgreParallaxCorrectedCubemap.h"
@@ -50,8 +52,35 @@ namespace Ogre
         "NUM_LIGHT_TYPES"
     };
 
+    const uint32 SceneFormatBase::c_sectionedMagic = 0x5353474F; //'OGSS'
+    const uint32 SceneFormatBase::c_sectionedVersion = 1u;
+    const size_t SceneFormatBase::c_sectionedHeaderSize = sizeof(uint32) * 4u;
+    const size_t SceneFormatBase::c_sectionedTocEntrySize = sizeof(float) * 6u + sizeof(uint64) * 2u +
+                                                            sizeof(uint32) * 4u;
+
     static DefaultSceneFormatListener sDefaultSceneFormatListener;
 
+    namespace
+    {
+        template <typename T>
+        void writeValue( uint8 * RESTRICT_ALIAS &dst, T value )
+        {
+            memcpy( dst, &value, sizeof(T) );
+            dst += sizeof(T);
+        }
+        //-------------------------------------------------------------------------------
+        template <typename T>
+        T readValue( const uint8 * RESTRICT_ALIAS &src, bool flipEndian )
+        {
+            T retVal;
+            memcpy( &retVal, src, sizeof(T) );
+            if( flipEndian )
+                Bitwise::bswapBuffer( &retVal, sizeof(T) );
+            src += sizeof(T);
+            return retVal;
+        }
+    }
+
     SceneFormatBase::SceneFormatBase( Root *root, SceneManager *sceneManager ) :
         mRoot( root ),
         mSceneManager( sceneManager ),
@@ -63,6 +92,111 @@ namespace Ogre
     {
     }
     //-----------------------------------------------------------------------------------
+    void SceneFormatBase::writeSectionTable( const SectionVec &sections,
+                                             vector<uint8>::type &outData )
+    {
+        outData.resize( c_sectionedHeaderSize + sections.size() * c_sectionedTocEntrySize );
+        uint8 *dst = &outData[0];
+
+        writeValue<uint32>( dst, c_sectionedMagic );
+        writeValue<uint32>( dst, c_sectionedVersion );
+        writeValue<uint32>( dst, static_cast<uint32>( sections.size() ) );
+        writeValue<uint32>( dst, 0 );
+
+        SectionVec::const_iterator itor = sections.begin();
+        SectionVec::const_iterator end  = sections.end();
+
+        while( itor != end )
+        {
+            for( size_t i=0; i<3u; ++i )
+                writeValue<float>( dst, static_cast<float>( itor->aabb.mCenter[i] ) );
+            for( size_t i=0; i<3u; ++i )
+                writeValue<float>( dst, static_cast<float>( itor->aabb.mHalfSize[i] ) );
+            writeValue<uint64>( dst, itor->offset );
+            writeValue<uint64>( dst, itor->sizeBytes );
+            writeValue<uint32>( dst, itor->numSceneNodes );
+            writeValue<uint32>( dst, itor->numItems );
+            writeValue<uint32>( dst, itor->numEntities );
+            writeValue<uint32>( dst, itor->numLights );
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void SceneFormatBase::readSectionTable( DataStreamPtr &stream, SectionVec &outSections )
+    {
+        outSections.clear();
+
+        uint8 header[c_sectionedHeaderSize];
+        if( stream->read( header, c_sectionedHeaderSize ) != c_sectionedHeaderSize )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "File " + stream->getName() + " is too small to be a sectioned scene",
+                         "SceneFormatBase::readSectionTable" );
+        }
+
+        const uint8 *src = header;
+        const uint32 magic = readValue<uint32>( src, false );
+        const bool flipEndian = magic != c_sectionedMagic;
+        if( flipEndian && Bitwise::bswap32( magic ) != c_sectionedMagic )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "File " + stream->getName() + " is not a sectioned scene",
+                         "SceneFormatBase::readSectionTable" );
+        }
+
+        const uint32 version = readValue<uint32>( src, flipEndian );
+        const uint32 numSections = readValue<uint32>( src, flipEndian );
+
+        if( version > c_sectionedVersion )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Sectioned scene " + stream->getName() + " is a newer version (" +
+                         StringConverter::toString( version ) + ") than what we support (" +
+                         StringConverter::toString( c_sectionedVersion ) + ")",
+                         "SceneFormatBase::readSectionTable" );
+        }
+
+        const size_t streamSize = stream->size();
+        if( numSections == 0 ||
+            numSections > (streamSize - c_sectionedHeaderSize) / c_sectionedTocEntrySize )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Sectioned scene " + stream->getName() + " has a corrupt table of contents",
+                         "SceneFormatBase::readSectionTable" );
+        }
+
+        vector<uint8>::type tocData( numSections * c_sectionedTocEntrySize );
+        stream->read( &tocData[0], tocData.size() );
+        src = &tocData[0];
+
+        outSections.resize( numSections );
+        SectionVec::iterator itor = outSections.begin();
+        SectionVec::iterator end  = outSections.end();
+
+        while( itor != end )
+        {
+            for( size_t i=0; i<3u; ++i )
+                itor->aabb.mCenter[i] = readValue<float>( src, flipEndian );
+            for( size_t i=0; i<3u; ++i )
+                itor->aabb.mHalfSize[i] = readValue<float>( src, flipEndian );
+            itor->offset        = readValue<uint64>( src, flipEndian );
+            itor->sizeBytes     = readValue<uint64>( src, flipEndian );
+            itor->numSceneNodes = readValue<uint32>( src, flipEndian );
+            itor->numItems      = readValue<uint32>( src, flipEndian );
+            itor->numEntities   = readValue<uint32>( src, flipEndian );
+            itor->numLights     = readValue<uint32>( src, flipEndian );
+
+            if( itor->offset > streamSize || itor->sizeBytes > streamSize - itor->offset )
+            {
+                OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                             "Sectioned scene " + stream->getName() + " has a section out of bounds",
+                             "SceneFormatBase::readSectionTable" );
+            }
+
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
     HlmsPbs* SceneFormatBase::getPbs(void) const
     {
         HlmsManager *hlmsManager = mRoot->getHlmsManager();
@@ -62,6 +62,25 @@ THE SOFTWARE.
 
 namespace Ogre
 {
+    namespace
+    {
+        struct SectionCellKey
+        {
+            int32 x;
+            int32 y;
+            int32 z;
+
+            bool operator < ( const SectionCellKey &other ) const
+            {
+                if( this->x != other.x )
+                    return this->x < other.x;
+                if( this->y != other.y )
+                    return this->y < other.y;
+                return this->z < other.z;
+            }
+        };
+    }
+
     SceneFormatExporter::SceneFormatExporter( Root *root, SceneManager *sceneManager,
                                               InstantRadiosity *instantRadiosity ) :
         SceneFormatBase( root, sceneManager ),
@@ -1019,6 +1038,12 @@ namespace Ogre
             file.close();
         }
 
+        exportMaterialsAndTextures( folderPath, exportFlags );
+    }
+    //-----------------------------------------------------------------------------------
+    void SceneFormatExporter::exportMaterialsAndTextures( const String &folderPath,
+                                                          uint32 exportFlags )
+    {
         if( exportFlags & SceneFlags::Materials )
         {
             HlmsManager *hlmsManager = mRoot->getHlmsManager();
@@ -1055,4 +1080,301 @@ namespace Ogre
             }
         }
     }
+    //-----------------------------------------------------------------------------------
+    void SceneFormatExporter::exportSceneSectionedToFile( const String &folderPath,
+                                                          Real sectionSize, uint32 exportFlags )
+    {
+        if( sectionSize <= Real( 0.0f ) )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS, "sectionSize must be greater than 0",
+                         "SceneFormatExporter::exportSceneSectionedToFile" );
+        }
+
+        mCurrentExportFolder = folderPath;
+        FileSystemLayer::createDirectory( mCurrentExportFolder );
+
+        mNodeToIdxMap.clear();
+        mExportedMeshes.clear();
+        mExportedMeshesV1.clear();
+
+        mListener->setSceneFlags( exportFlags, this );
+
+        char tmpBuffer[4096];
+        LwString jsonStr( LwString::FromEmptyPointer( tmpBuffer, sizeof(tmpBuffer) ) );
+
+        //Gather the nodes in the same order as _exportScene, so that the
+        //indices are the same as if the scene had been exported as JSON.
+        vector<SceneNode*>::type sceneNodes;
+        if( exportFlags & SceneFlags::SceneNodes )
+        {
+            for( size_t i=0; i<NUM_SCENE_MEMORY_MANAGER_TYPES; ++i )
+            {
+                SceneNode *rootSceneNode =
+                        mSceneManager->getRootSceneNode( static_cast<SceneMemoryMgrTypes>(i) );
+
+                mNodeToIdxMap[rootSceneNode] = static_cast<uint32>( sceneNodes.size() );
+                sceneNodes.push_back( rootSceneNode );
+
+                std::queue<SceneNode*> nodeQueue;
+                nodeQueue.push(rootSceneNode);
+
+                while( !nodeQueue.empty() )
+                {
+                    SceneNode* frontNode = nodeQueue.front();
+                    nodeQueue.pop();
+                    Node::NodeVecIterator nodeItor = frontNode->getChildIterator();
+                    while( nodeItor.hasMoreElements() )
+                    {
+                        Node *node = nodeItor.getNext();
+                        SceneNode *sceneNode = dynamic_cast<SceneNode*>( node );
+
+                        if( sceneNode && mListener->exportSceneNode( sceneNode ) )
+                        {
+                            mNodeToIdxMap[sceneNode] = static_cast<uint32>( sceneNodes.size() );
+                            sceneNodes.push_back( sceneNode );
+                            nodeQueue.push( sceneNode );
+                        }
+                    }
+                }
+            }
+        }
+
+        //Assign each node to the grid cell its derived position falls in.
+        //Root nodes (the only ones without parent) always go to section 0. They're
+        //not all at the front: each one is followed by its children.
+        typedef map<SectionCellKey, uint32>::type CellToSectionMap;
+        CellToSectionMap cellToSection;
+        vector<uint32>::type nodeSections( sceneNodes.size(), 0u );
+        uint32 numSections = 1u;
+
+        const Real invSectionSize = Real( 1.0f ) / sectionSize;
+
+        for( size_t i=0; i<sceneNodes.size(); ++i )
+        {
+            if( !sceneNodes[i]->getParent() )
+                continue;
+
+            const Vector3 cellPos = sceneNodes[i]->_getDerivedPositionUpdated() * invSectionSize;
+            SectionCellKey cellKey;
+            cellKey.x = static_cast<int32>( Math::Floor( cellPos.x ) );
+            cellKey.y = static_cast<int32>( Math::Floor( cellPos.y ) );
+            cellKey.z = static_cast<int32>( Math::Floor( cellPos.z ) );
+
+            std::pair<CellToSectionMap::iterator, bool> inserted =
+                    cellToSection.insert( CellToSectionMap::value_type( cellKey, numSections ) );
+            if( inserted.second )
+                ++numSections;
+            nodeSections[i] = inserted.first->second;
+        }
+
+        //A node's parent must be either in the same section or in section 0 (which is
+        //always loaded first); otherwise move the parent to section 0. Parents always
+        //come before their children, so walking backwards propagates it in one pass.
+        for( size_t i=sceneNodes.size(); i--; )
+        {
+            Node *parentNode = sceneNodes[i]->getParent();
+            if( parentNode )
+            {
+                NodeToIdxMap::const_iterator itor = mNodeToIdxMap.find( parentNode );
+                if( itor != mNodeToIdxMap.end() )
+                {
+                    uint32 &parentSection = nodeSections[itor->second];
+                    if( parentSection != nodeSections[i] )
+                        parentSection = 0;
+                }
+            }
+        }
+
+        //Some sections may have become empty. Compact the indices.
+        {
+            vector<uint32>::type sectionRemap( numSections, std::numeric_limits<uint32>::max() );
+            sectionRemap[0] = 0;
+            numSections = 1u;
+
+            vector<uint32>::type::iterator itor = nodeSections.begin();
+            vector<uint32>::type::iterator end  = nodeSections.end();
+
+            while( itor != end )
+            {
+                if( sectionRemap[*itor] == std::numeric_limits<uint32>::max() )
+                    sectionRemap[*itor] = numSections++;
+                *itor = sectionRemap[*itor];
+                ++itor;
+            }
+        }
+
+        SectionVec sections( numSections );
+        vector<String>::type sceneNodesJson( numSections );
+        vector<String>::type itemsJson( numSections );
+        vector<String>::type lightsJson( numSections );
+        vector<String>::type entitiesJson( numSections );
+
+        for( size_t i=0; i<sceneNodes.size(); ++i )
+        {
+            const uint32 sectionIdx = nodeSections[i];
+            String &outJson = sceneNodesJson[sectionIdx];
+            outJson += outJson.empty() ? "\n\t\t{" : ",\n\t\t{";
+            jsonStr.a( "\n\t\t\t\"id\" : ", (uint32)i, "," );
+            flushLwString( jsonStr, outJson );
+            exportSceneNode( jsonStr, outJson, sceneNodes[i] );
+            outJson += "\n\t\t}";
+
+            if( sceneNodes[i]->getParent() )
+                sections[sectionIdx].aabb.merge( sceneNodes[i]->_getDerivedPosition() );
+            ++sections[sectionIdx].numSceneNodes;
+        }
+
+        if( exportFlags & SceneFlags::Items )
+        {
+            SceneManager::MovableObjectIterator movableObjects =
+                    mSceneManager->getMovableObjectIterator( ItemFactory::FACTORY_TYPE_NAME );
+
+            while( movableObjects.hasMoreElements() )
+            {
+                MovableObject *mo = movableObjects.getNext();
+                Item *item = static_cast<Item*>( mo );
+                if( mListener->exportItem( item ) )
+                {
+                    uint32 sectionIdx = 0;
+                    NodeToIdxMap::const_iterator itor = mNodeToIdxMap.find( item->getParentNode() );
+                    if( itor != mNodeToIdxMap.end() )
+                        sectionIdx = nodeSections[itor->second];
+
+                    String &outJson = itemsJson[sectionIdx];
+                    outJson += outJson.empty() ? "\n\t\t{" : ",\n\t\t{";
+                    exportItem( jsonStr, outJson, item, exportFlags & SceneFlags::Meshes );
+                    outJson += "\n\t\t}";
+
+                    if( item->isAttached() )
+                        sections[sectionIdx].aabb.merge( item->getWorldAabbUpdated() );
+                    ++sections[sectionIdx].numItems;
+                }
+            }
+        }
+
+        if( exportFlags & SceneFlags::Lights )
+        {
+            SceneManager::MovableObjectIterator movableObjects =
+                    mSceneManager->getMovableObjectIterator( LightFactory::FACTORY_TYPE_NAME );
+
+            while( movableObjects.hasMoreElements() )
+            {
+                MovableObject *mo = movableObjects.getNext();
+                Light *light = static_cast<Light*>( mo );
+                if( mListener->exportLight( light ) )
+                {
+                    uint32 sectionIdx = 0;
+                    NodeToIdxMap::const_iterator itor = mNodeToIdxMap.find( light->getParentNode() );
+                    if( itor != mNodeToIdxMap.end() )
+                        sectionIdx = nodeSections[itor->second];
+
+                    String &outJson = lightsJson[sectionIdx];
+                    outJson += outJson.empty() ? "\n\t\t{" : ",\n\t\t{";
+                    exportLight( jsonStr, outJson, light );
+                    outJson += "\n\t\t}";
+
+                    ++sections[sectionIdx].numLights;
+                }
+            }
+        }
+
+        if( exportFlags & SceneFlags::Entities )
+        {
+            SceneManager::MovableObjectIterator movableObjects =
+                    mSceneManager->getMovableObjectIterator( v1::EntityFactory::FACTORY_TYPE_NAME );
+
+            while( movableObjects.hasMoreElements() )
+            {
+                MovableObject *mo = movableObjects.getNext();
+                v1::Entity *entity = static_cast<v1::Entity*>( mo );
+                if( mListener->exportEntity( entity ) )
+                {
+                    uint32 sectionIdx = 0;
+                    NodeToIdxMap::const_iterator itor = mNodeToIdxMap.find( entity->getParentNode() );
+                    if( itor != mNodeToIdxMap.end() )
+                        sectionIdx = nodeSections[itor->second];
+
+                    String &outJson = entitiesJson[sectionIdx];
+                    outJson += outJson.empty() ? "\n\t\t{" : ",\n\t\t{";
+                    exportEntity( jsonStr, outJson, entity, exportFlags & SceneFlags::MeshesV1 );
+                    outJson += "\n\t\t}";
+
+                    if( entity->isAttached() )
+                        sections[sectionIdx].aabb.merge( entity->getWorldAabbUpdated() );
+                    ++sections[sectionIdx].numEntities;
+                }
+            }
+        }
+
+        //Build the payload of each section. Payloads use the same schema as scene.json
+        vector<String>::type payloads( numSections );
+        for( uint32 i=0; i<numSections; ++i )
+        {
+            String &outJson = payloads[i];
+
+            //Old importers cannot import our scenes if they use float literals
+            if( mUseBinaryFloatingPoint )
+                jsonStr.a( "{\n\t\"version\" : ", (int)VERSION_0, "" );
+            else
+                jsonStr.a( "{\n\t\"version\" : ", (int)VERSION_1, "" );
+            jsonStr.a( ",\n\t\"use_binary_floating_point\" : ",
+                       toQuotedStr( mUseBinaryFloatingPoint ) );
+            jsonStr.a( ",\n\t\"section\" : ", i );
+
+            if( i == 0 )
+            {
+                jsonStr.a( ",\n\t\"MovableObject_msDefaultVisibilityFlags\" : ",
+                           MovableObject::getDefaultVisibilityFlags() );
+
+                if( exportFlags & SceneFlags::TexturesOitd )
+                    jsonStr.a( ",\n\t\"saved_oitd_textures\" : true" );
+                if( exportFlags & SceneFlags::TexturesOriginal )
+                    jsonStr.a( ",\n\t\"saved_original_textures\" : true" );
+            }
+
+            flushLwString( jsonStr, outJson );
+
+            if( !sceneNodesJson[i].empty() )
+                outJson += ",\n\t\"scene_nodes\" :\n\t[" + sceneNodesJson[i] + "\n\t]";
+            if( !itemsJson[i].empty() )
+                outJson += ",\n\t\"items\" :\n\t[\n" + itemsJson[i] + "\n\t]";
+            if( !lightsJson[i].empty() )
+                outJson += ",\n\t\"lights\" :\n\t[\n" + lightsJson[i] + "\n\t]";
+            if( !entitiesJson[i].empty() )
+                outJson += ",\n\t\"entities\" :\n\t[\n" + entitiesJson[i] + "\n\t]";
+
+            if( i == 0 && (exportFlags & SceneFlags::SceneSettings) )
+                exportSceneSettings( jsonStr, outJson, exportFlags );
+
+            outJson += "\n}\n";
+        }
+
+        mNodeToIdxMap.clear();
+
+        uint64 currentOffset = c_sectionedHeaderSize + numSections * c_sectionedTocEntrySize;
+        for( uint32 i=0; i<numSections; ++i )
+        {
+            sections[i].offset = currentOffset;
+            sections[i].sizeBytes = payloads[i].size();
+            currentOffset += payloads[i].size();
+        }
+
+        {
+            vector<uint8>::type sectionTable;
+            writeSectionTable( sections, sectionTable );
+
+            const String scenePath = folderPath + "/scene.oscn";
+            std::ofstream file( scenePath.c_str(), std::ios::binary | std::ios::out );
+            if( file.is_open() )
+            {
+                file.write( reinterpret_cast<const char*>( &sectionTable[0] ),
+                            sectionTable.size() );
+                for( uint32 i=0; i<numSections; ++i )
+                    file.write( payloads[i].c_str(), payloads[i].size() );
+            }
+            file.close();
+        }
+
+        exportMaterialsAndTextures( folderPath, exportFlags );
+    }
 }
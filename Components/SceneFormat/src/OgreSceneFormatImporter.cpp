@@ -53,6 +53,8 @@ THE SOFTWARE.
 #include "OgreFileSystemLayer.h"
 
 #include "OgreLogManager.h"
+#include "OgreTimer.h"
+#include "OgreDataStream.h"
 
 
 #include "rapidjson/document.h"
@@ -68,7 +70,12 @@ namespace Ogre
         mParallaxCorrectedCubemap( 0 ),
         mSceneComponentTransform( Matrix4::IDENTITY ),
         mDefaultPccWorkspaceName( defaultPccWorkspaceName ),
-        mUseBinaryFloatingPoint( true )
+        mUseBinaryFloatingPoint( true ),
+        mSectionedImportFlags( 0 ),
+        mCurrentSection( std::numeric_limits<uint32>::max() ),
+        mCurrentSectionPhase( 0 ),
+        mCurrentSectionEntry( 0 ),
+        mCurrentSectionDoc( 0 )
     {
         memset( mRootNodes, 0, sizeof(mRootNodes) );
         memset( mParentlessRootNodes, 0, sizeof(mParentlessRootNodes) );
@@ -76,6 +83,9 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     SceneFormatImporter::~SceneFormatImporter()
     {
+        delete mCurrentSectionDoc;
+        mCurrentSectionDoc = 0;
+
         destroyInstantRadiosity();
         destroyParallaxCorrectedCubemap();
     }
@@ -1205,23 +1215,28 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
-    void SceneFormatImporter::importScene( const String &filename, const rapidjson::Document &d,
-                                           uint32 importFlags )
+    void SceneFormatImporter::bindRootNodes(
+            SceneNode *outOldRootNodes[NUM_SCENE_MEMORY_MANAGER_TYPES] )
     {
-        mUseBinaryFloatingPoint = true; //The default when setting is not present
-
-        mFilename = filename;
-        destroyInstantRadiosity();
-        destroyParallaxCorrectedCubemap();
-
-        //Set null pointers to valid root scene nodes. We'll restore the nullptrs at the end.
-        SceneNode *oldRootNodes[NUM_SCENE_MEMORY_MANAGER_TYPES];
+        //Set null pointers to valid root scene nodes. restoreRootNodes restores the nullptrs.
         for( size_t i=0; i<NUM_SCENE_MEMORY_MANAGER_TYPES; ++i )
         {
-            oldRootNodes[i] = mRootNodes[i];
+            outOldRootNodes[i] = mRootNodes[i];
             if( !mRootNodes[i] )
                 mRootNodes[i] = mSceneManager->getRootSceneNode( static_cast<SceneMemoryMgrTypes>(i) );
         }
+    }
+    //-----------------------------------------------------------------------------------
+    void SceneFormatImporter::restoreRootNodes(
+            SceneNode * const oldRootNodes[NUM_SCENE_MEMORY_MANAGER_TYPES] )
+    {
+        for( size_t i=0; i<NUM_SCENE_MEMORY_MANAGER_TYPES; ++i )
+            mRootNodes[i] = oldRootNodes[i];
+    }
+    //-----------------------------------------------------------------------------------
+    void SceneFormatImporter::importHeader( const rapidjson::Value &d )
+    {
+        mUseBinaryFloatingPoint = true; //The default when setting is not present
 
         rapidjson::Value::ConstMemberIterator itor;
 
@@ -1230,7 +1245,7 @@ namespace Ogre
         {
             OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
                          "SceneFormatImporter::importScene",
-                         "JSON file " + filename + " does not contain version key. "
+                         "JSON file " + mFilename + " does not contain version key. "
                          "Probably this is not a valid Ogre scene" );
         }
         else
@@ -1242,7 +1257,7 @@ namespace Ogre
                 {
                     LogManager::getSingleton().logMessage(
                                 "WARNING: SceneFormatImporter::importScene "
-                                "JSON file " + filename + " is a newer version(" +
+                                "JSON file " + mFilename + " is a newer version(" +
                                 StringConverter::toString( version ) +") than what we support (" +
                                 StringConverter::toString( LATEST_VERSION ) + "). "
                                 "Imported scene may not be complete or have graphical corruption. "
@@ -1254,6 +1269,11 @@ namespace Ogre
         itor = d.FindMember( "use_binary_floating_point" );
         if( itor != d.MemberEnd() && itor->value.IsBool() )
             mUseBinaryFloatingPoint = itor->value.GetBool();
+    }
+    //-----------------------------------------------------------------------------------
+    void SceneFormatImporter::importObjects( const rapidjson::Value &d, uint32 importFlags )
+    {
+        rapidjson::Value::ConstMemberIterator itor;
 
         if( importFlags & SceneFlags::SceneNodes )
         {
@@ -1282,11 +1302,10 @@ namespace Ogre
             if( itor != d.MemberEnd() && itor->value.IsArray() )
                 importLights( itor->value );
         }
-
-        itor = d.FindMember( "scene" );
-        if( itor != d.MemberEnd() && itor->value.IsObject() )
-            importSceneSettings( itor->value, importFlags );
-
+    }
+    //-----------------------------------------------------------------------------------
+    void SceneFormatImporter::finishImport( uint32 importFlags )
+    {
         if( !(importFlags & SceneFlags::LightsVpl) )
         {
             LightArray::const_iterator itLight = mVplLights.begin();
@@ -1322,9 +1341,28 @@ namespace Ogre
                             mIrradianceVolume->getFadeAttenuationOverDistace() );
             }
         }
+    }
+    //-----------------------------------------------------------------------------------
+    void SceneFormatImporter::importScene( const String &filename, const rapidjson::Document &d,
+                                           uint32 importFlags )
+    {
+        mFilename = filename;
+        destroyInstantRadiosity();
+        destroyParallaxCorrectedCubemap();
 
-        for( size_t i=0; i<NUM_SCENE_MEMORY_MANAGER_TYPES; ++i )
-            mRootNodes[i] = oldRootNodes[i];
+        SceneNode *oldRootNodes[NUM_SCENE_MEMORY_MANAGER_TYPES];
+        bindRootNodes( oldRootNodes );
+
+        importHeader( d );
+        importObjects( d, importFlags );
+
+        rapidjson::Value::ConstMemberIterator itor = d.FindMember( "scene" );
+        if( itor != d.MemberEnd() && itor->value.IsObject() )
+            importSceneSettings( itor->value, importFlags );
+
+        finishImport( importFlags );
+
+        restoreRootNodes( oldRootNodes );
     }
 
     //-----------------------------------------------------------------------------------
@@ -1419,6 +1457,433 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    void SceneFormatImporter::importSceneSectionedFromFile( const String &folderPath,
+                                                            uint32 importFlags )
+    {
+        openSectionedScene( folderPath, importFlags );
+
+        for( uint32 i=1u; i<mSections.size(); ++i )
+            queueSection( i );
+
+        while( !updateStreaming( std::numeric_limits<uint64>::max() ) )
+        {
+        }
+
+        closeSectionedScene();
+    }
+    //-----------------------------------------------------------------------------------
+    void SceneFormatImporter::openSectionedScene( const String &folderPath, uint32 importFlags )
+    {
+        if( !mSectionedStream.isNull() )
+            closeSectionedScene();
+
+        //Validate the table of contents before touching the resource groups
+        const String scenePath = folderPath + "/scene.oscn";
+        std::ifstream *ifs = OGRE_NEW_T( std::ifstream, MEMCATEGORY_GENERAL )(
+                                 scenePath.c_str(), std::ios::binary | std::ios::in );
+        if( !ifs->is_open() )
+        {
+            OGRE_DELETE_T( ifs, basic_ifstream, MEMCATEGORY_GENERAL );
+            OGRE_EXCEPT( Exception::ERR_FILE_NOT_FOUND, "Cannot open " + scenePath,
+                         "SceneFormatImporter::openSectionedScene" );
+        }
+        DataStreamPtr stream( OGRE_NEW FileStreamDataStream( scenePath, ifs, true ) );
+        SectionVec sections;
+        readSectionTable( stream, sections );
+
+        ResourceGroupManager &resourceGroupManager = ResourceGroupManager::getSingleton();
+        resourceGroupManager.addResourceLocation( folderPath, "FileSystem", "SceneFormatImporter" );
+        resourceGroupManager.addResourceLocation( folderPath + "/v2/",
+                                                  "FileSystem", "SceneFormatImporter" );
+        resourceGroupManager.addResourceLocation( folderPath + "/v1/",
+                                                  "FileSystem", "SceneFormatImporter" );
+        resourceGroupManager.addResourceLocation( folderPath + "/textures/",
+                                                  "FileSystem", "SceneFormatImporter" );
+
+        mSectionedFolder = folderPath;
+        mSectionedImportFlags = importFlags;
+        mSectionedStream = stream;
+        mFilename = scenePath;
+
+        mSections.swap( sections );
+        mSectionStates.clear();
+        mSectionStates.resize( mSections.size(), SectionUnloaded );
+        mSectionQueue.clear();
+
+        mCreatedSceneNodes.clear();
+        destroyInstantRadiosity();
+        destroyParallaxCorrectedCubemap();
+
+        //Section 0 has the root nodes, the shared parents and the scene settings.
+        parseSection( 0 );
+
+        const rapidjson::Document &d = *mCurrentSectionDoc;
+        rapidjson::Value::ConstMemberIterator itor;
+
+        bool useOitd = false;
+        itor = d.FindMember( "saved_oitd_textures" );
+        if( itor != d.MemberEnd() && itor->value.IsBool() )
+            useOitd = itor->value.GetBool();
+
+        HlmsManager *hlmsManager = mRoot->getHlmsManager();
+        if( useOitd )
+            hlmsManager->mAdditionalTextureExtensionsPerGroup["SceneFormatImporter"] = ".oitd";
+        resourceGroupManager.initialiseResourceGroup( "SceneFormatImporter", true );
+        if( useOitd )
+            hlmsManager->mAdditionalTextureExtensionsPerGroup.erase( "SceneFormatImporter" );
+
+        SceneNode *oldRootNodes[NUM_SCENE_MEMORY_MANAGER_TYPES];
+        bindRootNodes( oldRootNodes );
+
+        Timer timer;
+        importSectionObjects( timer, std::numeric_limits<uint64>::max() );
+
+        itor = d.FindMember( "scene" );
+        if( itor != d.MemberEnd() && itor->value.IsObject() )
+            importSceneSettings( itor->value, importFlags );
+
+        restoreRootNodes( oldRootNodes );
+
+        mSectionStates[0] = SectionLoaded;
+        mCurrentSection = std::numeric_limits<uint32>::max();
+    }
+    //-----------------------------------------------------------------------------------
+    void SceneFormatImporter::closeSectionedScene(void)
+    {
+        if( mSectionedStream.isNull() )
+            return;
+
+        finishImport( mSectionedImportFlags );
+
+        delete mCurrentSectionDoc;
+        mCurrentSectionDoc = 0;
+        mCurrentSectionData.clear();
+        mCurrentSection = std::numeric_limits<uint32>::max();
+
+        mSectionQueue.clear();
+        mSectionStates.clear();
+        mSections.clear();
+
+        mSectionedStream->close();
+        mSectionedStream.setNull();
+
+        ResourceGroupManager &resourceGroupManager = ResourceGroupManager::getSingleton();
+        resourceGroupManager.removeResourceLocation( mSectionedFolder + "/textures/",
+                                                     "SceneFormatImporter" );
+        resourceGroupManager.removeResourceLocation( mSectionedFolder + "/v2/",
+                                                     "SceneFormatImporter" );
+        resourceGroupManager.removeResourceLocation( mSectionedFolder + "/v1/",
+                                                     "SceneFormatImporter" );
+        resourceGroupManager.removeResourceLocation( mSectionedFolder, "SceneFormatImporter" );
+        mSectionedFolder.clear();
+    }
+    //-----------------------------------------------------------------------------------
+    void SceneFormatImporter::queueSection( uint32 sectionIdx )
+    {
+        assert( sectionIdx < mSectionStates.size() );
+
+        if( mSectionStates[sectionIdx] == SectionUnloaded )
+        {
+            mSectionStates[sectionIdx] = SectionQueued;
+            mSectionQueue.push_back( sectionIdx );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void SceneFormatImporter::queueSectionsInArea( const Aabb &area )
+    {
+        const size_t numSections = mSections.size();
+        for( size_t i=0; i<numSections; ++i )
+        {
+            if( mSections[i].aabb.intersects( area ) )
+                queueSection( static_cast<uint32>( i ) );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    bool SceneFormatImporter::updateStreaming( uint64 maxMicroseconds )
+    {
+        Timer timer;
+
+        SceneNode *oldRootNodes[NUM_SCENE_MEMORY_MANAGER_TYPES];
+        bindRootNodes( oldRootNodes );
+
+        bool hasTimeLeft = true;
+
+        while( hasTimeLeft &&
+               (mCurrentSection != std::numeric_limits<uint32>::max() || !mSectionQueue.empty()) )
+        {
+            if( mCurrentSection == std::numeric_limits<uint32>::max() )
+            {
+                const uint32 sectionIdx = mSectionQueue.front();
+                mSectionQueue.pop_front();
+                parseSection( sectionIdx );
+                mSectionStates[sectionIdx] = SectionLoading;
+            }
+
+            if( importSectionObjects( timer, maxMicroseconds ) )
+            {
+                mSectionStates[mCurrentSection] = SectionLoaded;
+                mCurrentSection = std::numeric_limits<uint32>::max();
+            }
+
+            hasTimeLeft = timer.getMicroseconds() < maxMicroseconds;
+        }
+
+        restoreRootNodes( oldRootNodes );
+
+        return mCurrentSection == std::numeric_limits<uint32>::max() && mSectionQueue.empty();
+    }
+    //-----------------------------------------------------------------------------------
+    void SceneFormatImporter::parseSection( uint32 sectionIdx )
+    {
+        const Section &section = mSections[sectionIdx];
+
+        mCurrentSectionData.resize( static_cast<size_t>( section.sizeBytes ) + 1u );
+        mSectionedStream->seek( static_cast<size_t>( section.offset ) );
+        const size_t bytesRead = mSectionedStream->read( &mCurrentSectionData[0],
+                                                         static_cast<size_t>( section.sizeBytes ) );
+        //Add null terminator just in case (to prevent bad input)
+        mCurrentSectionData[bytesRead] = '\0';
+
+        if( !mCurrentSectionDoc )
+            mCurrentSectionDoc = new rapidjson::Document();
+
+        rapidjson::Document &d = *mCurrentSectionDoc;
+        d.Parse( &mCurrentSectionData[0] );
+
+        if( d.HasParseError() )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Invalid JSON string in section " + StringConverter::toString( sectionIdx ) +
+                         " of file " + mFilename + " at line " +
+                         StringConverter::toString( d.GetErrorOffset() ) + " Reason: " +
+                         rapidjson::GetParseError_En( d.GetParseError() ),
+                         "SceneFormatImporter::parseSection" );
+        }
+
+        importHeader( d );
+        reserveSectionMemory( d );
+
+        mCurrentSection = sectionIdx;
+        mCurrentSectionPhase = 0;
+        mCurrentSectionEntry = 0;
+    }
+    //-----------------------------------------------------------------------------------
+    void SceneFormatImporter::reserveSectionMemory( const rapidjson::Value &d )
+    {
+        rapidjson::Value::ConstMemberIterator itor;
+
+        if( mSectionedImportFlags & SceneFlags::SceneNodes )
+        {
+            itor = d.FindMember( "scene_nodes" );
+            if( itor != d.MemberEnd() && itor->value.IsArray() )
+            {
+                typedef map<uint32, uint16>::type IndexToDepthMap;
+                IndexToDepthMap sectionNodeDepths;
+                vector<size_t>::type numNodesPerDepth[NUM_SCENE_MEMORY_MANAGER_TYPES];
+
+                rapidjson::Value::ConstValueIterator itNode = itor->value.Begin();
+                rapidjson::Value::ConstValueIterator enNode = itor->value.End();
+
+                while( itNode != enNode )
+                {
+                    rapidjson::Value::ConstMemberIterator itId = itNode->FindMember( "id" );
+                    rapidjson::Value::ConstMemberIterator itTmp = itNode->FindMember( "node" );
+                    if( itId != itNode->MemberEnd() && itId->value.IsUint() &&
+                        itTmp != itNode->MemberEnd() && itTmp->value.IsObject() )
+                    {
+                        const rapidjson::Value &nodeValue = itTmp->value;
+
+                        bool isStatic = false;
+                        itTmp = nodeValue.FindMember( "is_static" );
+                        if( itTmp != nodeValue.MemberEnd() && itTmp->value.IsBool() )
+                            isStatic = itTmp->value.GetBool();
+
+                        //Nodes without parent are root nodes or loose nodes (depth 0)
+                        int32 depth = 0;
+                        itTmp = nodeValue.FindMember( "parent_id" );
+                        if( itTmp != nodeValue.MemberEnd() && itTmp->value.IsUint() )
+                        {
+                            depth = -1;
+                            const uint32 parentIdx = itTmp->value.GetUint();
+                            IndexToSceneNodeMap::const_iterator itParent =
+                                    mCreatedSceneNodes.find( parentIdx );
+                            if( itParent != mCreatedSceneNodes.end() )
+                            {
+                                depth = itParent->second->getDepthLevel() + 1;
+                            }
+                            else
+                            {
+                                IndexToDepthMap::const_iterator itDepth =
+                                        sectionNodeDepths.find( parentIdx );
+                                if( itDepth != sectionNodeDepths.end() )
+                                    depth = itDepth->second + 1;
+                            }
+                        }
+
+                        if( depth >= 0 )
+                            sectionNodeDepths[itId->value.GetUint()] = static_cast<uint16>( depth );
+
+                        //Root nodes already exist and loose nodes are rare; don't reserve those.
+                        if( depth > 0 )
+                        {
+                            vector<size_t>::type &numNodes =
+                                    numNodesPerDepth[isStatic ? SCENE_STATIC : SCENE_DYNAMIC];
+                            if( numNodes.size() <= static_cast<size_t>( depth ) )
+                                numNodes.resize( depth + 1u, 0 );
+                            ++numNodes[depth];
+                        }
+                    }
+
+                    ++itNode;
+                }
+
+                for( size_t i=0; i<NUM_SCENE_MEMORY_MANAGER_TYPES; ++i )
+                {
+                    NodeMemoryManager &nodeMemoryManager =
+                            mSceneManager->_getNodeMemoryManager( static_cast<SceneMemoryMgrTypes>(i) );
+                    for( size_t depth=0; depth<numNodesPerDepth[i].size(); ++depth )
+                    {
+                        if( numNodesPerDepth[i][depth] )
+                            nodeMemoryManager.reserve( depth, numNodesPerDepth[i][depth] );
+                    }
+                }
+            }
+        }
+
+        const char *objectArrayNames[3] = { "items", "entities", "lights" };
+        const uint32 objectArrayFlags[3] =
+        {
+            SceneFlags::Items, SceneFlags::Entities, SceneFlags::Lights
+        };
+
+        for( size_t i=0; i<3u; ++i )
+        {
+            if( !(mSectionedImportFlags & objectArrayFlags[i]) )
+                continue;
+
+            itor = d.FindMember( objectArrayNames[i] );
+            if( itor == d.MemberEnd() || !itor->value.IsArray() )
+                continue;
+
+            size_t numObjectsPerRq[NUM_SCENE_MEMORY_MANAGER_TYPES][256];
+            memset( numObjectsPerRq, 0, sizeof(numObjectsPerRq) );
+
+            rapidjson::Value::ConstValueIterator itObj = itor->value.Begin();
+            rapidjson::Value::ConstValueIterator enObj = itor->value.End();
+
+            while( itObj != enObj )
+            {
+                rapidjson::Value::ConstMemberIterator itTmp = itObj->FindMember( "movable_object" );
+                if( itTmp != itObj->MemberEnd() && itTmp->value.IsObject() )
+                {
+                    const rapidjson::Value &movableObjectValue = itTmp->value;
+
+                    bool isStatic = false;
+                    itTmp = movableObjectValue.FindMember( "is_static" );
+                    if( itTmp != movableObjectValue.MemberEnd() && itTmp->value.IsBool() )
+                        isStatic = itTmp->value.GetBool();
+
+                    itTmp = movableObjectValue.FindMember( "render_queue" );
+                    if( itTmp != movableObjectValue.MemberEnd() && itTmp->value.IsUint() &&
+                        itTmp->value.GetUint() < 256u )
+                    {
+                        const size_t sceneType = isStatic ? SCENE_STATIC : SCENE_DYNAMIC;
+                        ++numObjectsPerRq[sceneType][itTmp->value.GetUint()];
+                    }
+                }
+
+                ++itObj;
+            }
+
+            for( size_t sceneType=0; sceneType<NUM_SCENE_MEMORY_MANAGER_TYPES; ++sceneType )
+            {
+                ObjectMemoryManager &objMemoryManager = i == 2u ?
+                            mSceneManager->_getLightMemoryManager() :
+                            mSceneManager->_getEntityMemoryManager(
+                                static_cast<SceneMemoryMgrTypes>( sceneType ) );
+
+                for( size_t rq=0; rq<256u; ++rq )
+                {
+                    if( numObjectsPerRq[sceneType][rq] )
+                        objMemoryManager.reserve( rq, numObjectsPerRq[sceneType][rq] );
+                }
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void SceneFormatImporter::importSectionSceneNode( const rapidjson::Value &sceneNodeValue )
+    {
+        rapidjson::Value::ConstMemberIterator itId = sceneNodeValue.FindMember( "id" );
+        if( itId == sceneNodeValue.MemberEnd() || !itId->value.IsUint() )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Sectioned scene node without 'id'. This file is malformed: " + mFilename,
+                         "SceneFormatImporter::importSectionSceneNode" );
+        }
+
+        const uint32 nodeIdx = itId->value.GetUint();
+        if( mCreatedSceneNodes.find( nodeIdx ) == mCreatedSceneNodes.end() )
+        {
+            //Parents are either in section 0 or come earlier in the same section, so they
+            //must've been created already. Otherwise importSceneNode will raise an exception.
+            const rapidjson::Value emptyArray( rapidjson::kArrayType );
+            importSceneNode( sceneNodeValue, nodeIdx, emptyArray );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    bool SceneFormatImporter::importSectionObjects( Timer &timer, uint64 maxMicroseconds )
+    {
+        const char *arrayNames[4] = { "scene_nodes", "items", "entities", "lights" };
+        const uint32 arrayFlags[4] =
+        {
+            SceneFlags::SceneNodes, SceneFlags::Items, SceneFlags::Entities, SceneFlags::Lights
+        };
+
+        const rapidjson::Document &d = *mCurrentSectionDoc;
+
+        while( mCurrentSectionPhase < 4u )
+        {
+            rapidjson::Value::ConstMemberIterator itor = d.FindMember(
+                                                             arrayNames[mCurrentSectionPhase] );
+
+            if( (mSectionedImportFlags & arrayFlags[mCurrentSectionPhase]) &&
+                itor != d.MemberEnd() && itor->value.IsArray() )
+            {
+                const rapidjson::Value &jsonArray = itor->value;
+                while( mCurrentSectionEntry < jsonArray.Size() )
+                {
+                    const rapidjson::Value &entry = jsonArray[mCurrentSectionEntry++];
+                    if( entry.IsObject() )
+                    {
+                        switch( mCurrentSectionPhase )
+                        {
+                        case 0:
+                            importSectionSceneNode( entry );
+                            break;
+                        case 1:
+                            importItem( entry );
+                            break;
+                        case 2:
+                            importEntity( entry );
+                            break;
+                        case 3:
+                            importLight( entry );
+                            break;
+                        }
+                    }
+
+                    if( timer.getMicroseconds() >= maxMicroseconds )
+                        return false;
+                }
+            }
+
+            ++mCurrentSectionPhase;
+            mCurrentSectionEntry = 0;
+        }
+
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
     void SceneFormatImporter::getInstantRadiosity( bool releaseOwnership,
                                                    InstantRadiosity **outInstantRadiosity,
                                                    IrradianceVolume **outIrradianceVolume )
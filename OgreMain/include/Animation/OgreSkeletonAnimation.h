@@ -169,7 +169,12 @@ namespace Ogre
         void setEnabled( bool bEnable );
         bool getEnabled(void) const                                 { return mEnabled; }
 
-        void _applyAnimation( const TransformArray &boneTransforms );
+        /** Applies this animation to the bones.
+        @param numDepthLevels
+            Only tracks of bones in the first numDepthLevels levels of the hierarchy
+            are applied. @see SkeletonDef::AnimationLod
+        */
+        void _applyAnimation( const TransformArray &boneTransforms, size_t numDepthLevels );
 
         void _swapBoneWeightsUniquePtr( RawSimdUniquePtr<ArrayReal, MEMCATEGORY_ANIMATION>
                                         &inOutBoneWeights );
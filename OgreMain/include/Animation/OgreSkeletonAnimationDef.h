@@ -31,6 +31,7 @@ THE SOFTWARE.
 
 #include "OgreSkeletonTrack.h"
 #include "OgreIdString.h"
+#include "OgreRawPtr.h"
 
 namespace Ogre
 {
@@ -59,6 +60,9 @@ namespace Ogre
 
         KfTransformArrayMemoryManager *mKfTransformMemoryManager;
 
+        /// Keyframe data of all tracks after compress. @see SkeletonTrack::_compress
+        RawSimdUniquePtr<uint8, MEMCATEGORY_ANIMATION> mCompressedData;
+
         typedef vector<Real>::type TimestampVec;
         typedef map<size_t, TimestampVec>::type TimestampsPerBlock;
 
@@ -94,6 +98,25 @@ namespace Ogre
 
         void build( const v1::Skeleton *skeleton, const v1::Animation *animation, Real frameRate );
 
+        /** Compresses all tracks: keyframes that can be reconstructed from their neighbours
+            are removed, channels that never change are stored once, positions & scales are
+            quantized to 16 bits within their range, and orientations are stored as their
+            smallest three components (16 bits each).
+        @remarks
+            Must be called after build and before any SkeletonInstance uses this animation.
+            Decompression happens on the fly in SkeletonTrack::applyKeyFrameRigAt, trading
+            some CPU time for roughly 3x-10x less memory.
+            Calling it twice does nothing.
+        @return
+            The memory saved. The measured error and decode-time trade-offs are only
+            filled when KfCompressionSettings::measure is set.
+        */
+        KfCompressionReport compress( const KfCompressionSettings &settings );
+
+        bool isCompressed(void) const               { return mCompressedData.get() != 0; }
+
+        const SkeletonTrackVec& getTracks(void) const   { return mTracks; }
+
         /// Dumps all the tracks in CSV format to the output string argument.
         /// Mostly for debugging purposes. (also easy example to show how to
         /// enumerate all the tracks and get the bones back from its block index)
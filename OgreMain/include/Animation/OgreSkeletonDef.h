@@ -81,6 +81,25 @@ namespace Ogre
         typedef map<uint32, uint32>::type IndexToIndexMap;
         typedef vector<uint32>::type BoneToSlotVec;
 
+        /// Animation quality used by instances whose LOD value reaches lodValue.
+        /// @see setAnimationLodLevels
+        struct AnimationLod
+        {
+            /// LOD value from which this level applies. In LodStrategy space once
+            /// set via setAnimationLodLevels (user space when passed to it).
+            Real    lodValue;
+            /// Animations are evaluated once every updateInterval frames. 1 = every frame.
+            uint16  updateInterval;
+            /// Number of bone depth levels that still get animated. Deeper bones keep
+            /// their last evaluated pose. Use a large value to animate all bones.
+            uint16  numDepthLevels;
+
+            AnimationLod( Real _lodValue, uint16 _updateInterval, uint16 _numDepthLevels ) :
+                lodValue( _lodValue ), updateInterval( _updateInterval ),
+                numDepthLevels( _numDepthLevels ) {}
+        };
+        typedef vector<AnimationLod>::type AnimationLodVec;
+
     protected:
         typedef map<IdString, size_t>::type BoneNameMap;
 
@@ -127,6 +146,9 @@ namespace Ogre
 
         vector<list<size_t>::type>::type mBonesPerDepth;
 
+        /// Sorted by lodValue, in LodStrategy space.
+        AnimationLodVec         mAnimationLods;
+
         String                  mName;
 
     public:
@@ -148,6 +170,40 @@ namespace Ogre
                                 getReverseBindPose(void) const          { return mReverseBindPose; }
         void getBonesPerDepth( vector<size_t>::type &out ) const;
 
+        /** Compresses the keyframes of all animations and logs the memory, error and
+            decode-time trade-offs. @see SkeletonAnimationDef::compress
+        @remarks
+            Must be called before creating SkeletonInstances. SkeletonManager
+            calls it automatically when SkeletonManager::setAnimationCompression is on.
+        */
+        KfCompressionReport compressAnimations( const KfCompressionSettings &settings );
+
+        /** Sets the animation LOD levels of all SkeletonInstances based on this definition.
+            Distant instances can evaluate their animations less often (staggered across
+            instances so the cost is spread over frames), and only for the upper levels
+            of the bone hierarchy. Skipped frames reuse the last evaluated pose, while
+            the derived bone transforms still follow the SceneNode every frame.
+        @remarks
+            The LOD value is the one calculated by the default LodStrategy for the
+            MovableObject that owns the instance in the previous frame, by the first LOD
+            update of that frame or the one of the camera set with
+            SceneManager::setAnimationLodCamera. Instances below the first level, or not
+            attached to an Item, are animated at full quality.
+        @par
+            The values are transformed with the default LodStrategy that is active at
+            the time of this call, like MeshLodUsage values are.
+        @param lodLevels
+            Levels with lodValue in user space (i.e. distance for distance-based
+            strategies). Doesn't need to be sorted. Pass an empty array to disable.
+        */
+        void setAnimationLodLevels( const AnimationLodVec &lodLevels );
+        /// Returns the animation LOD levels, with lodValue in LodStrategy space.
+        const AnimationLodVec& getAnimationLodLevels(void) const        { return mAnimationLods; }
+
+        /// Returns the animation LOD level that applies to the given LOD value.
+        /// Null if the instance must be animated at full quality.
+        const AnimationLod* getAnimationLod( Real lodValue ) const;
+
         /** Returns the total number of bone blocks to reach the given level. i.e On SSE2,
             If the skeleton has 1 root node, 3 children, and 5 children of children;
             then the total number of blocks is 1 + 1 + 2 = 4
@@ -105,16 +105,55 @@ namespace Ogre
                 
         SceneNodeBonePairVec    mCustomParentSceneNodes;
 
+        /// Object whose LOD value drives the animation LOD. May be null.
+        /// @see SkeletonDef::setAnimationLodLevels
+        MovableObject const     *mLodSource;
+        /// LOD value of mLodSource, as seen by SceneManager::getAnimationLodCamera.
+        Real                    mLodValue;
+        /// Offsets the frame count so that instances with the same update
+        /// interval don't all get evaluated in the same frame.
+        uint16                  mAnimationLodPhase;
+
         uint16 mRefCount;
 
+        /// Resets the first numDepthLevels depth levels to the binding pose.
+        void resetToPose( size_t numDepthLevels );
+        /// Evaluates the active animations on the first numDepthLevels depth levels.
+        void applyAnimations( size_t numDepthLevels );
+
     public:
         SkeletonInstance( const SkeletonDef *skeletonDef, BoneMemoryManager *boneMemoryManager );
         ~SkeletonInstance();
 
         const SkeletonDef* getDefinition(void) const                { return mDefinition; }
 
+        /// Evaluates all active animations at full quality.
         void update(void);
 
+        /** Evaluates the active animations honouring the SkeletonDef's animation LOD
+            levels. Called by SceneManager instead of update.
+        @param frameCount
+            Monotonically increasing frame counter.
+        @return
+            True if the animations were evaluated, false if the last pose was reused.
+        */
+        bool _updateWithLod( uint32 frameCount );
+
+        /** Sets the object whose LOD value selects the animation LOD level.
+            Items do this automatically. Null to always animate at full quality.
+        */
+        void _setLodSource( const MovableObject *lodSource )            { mLodSource = lodSource; }
+        const MovableObject* _getLodSource(void) const                  { return mLodSource; }
+
+        /** Sets the LOD value of the LOD source used to select the animation LOD level.
+            Called by SceneManager::updateAllLods. @see SceneManager::setAnimationLodCamera
+        */
+        void _setLodValue( Real lodValue )                              { mLodValue = lodValue; }
+        Real _getLodValue(void) const                                   { return mLodValue; }
+
+        /// Sets the frame offset used to stagger the updates. @see _updateWithLod
+        void _setAnimationLodPhase( uint16 phase )                      { mAnimationLodPhase = phase; }
+
         /// Resets the transform of all bones to the binding pose. Manual bones are not reset
         void resetToPose(void);
 
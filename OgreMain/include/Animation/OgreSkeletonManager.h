@@ -32,6 +32,7 @@ THE SOFTWARE.
 
 #include "OgreResourceManager.h"
 #include "OgreSingleton.h"
+#include "Animation/OgreSkeletonTrack.h"
 
 namespace Ogre {
 
@@ -52,6 +53,9 @@ namespace Ogre {
         typedef map<IdString, SkeletonDefPtr>::type SkeletonDefMap;
         SkeletonDefMap mSkeletonDefs;
 
+        bool                    mCompressAnimations;
+        KfCompressionSettings   mCompressionSettings;
+
     public:
         /// Constructor
         SkeletonManager();
@@ -76,6 +80,17 @@ namespace Ogre {
         */
         void remove( const IdString &name );
 
+        /** When enabled, the animations of every SkeletonDef created from now on by this
+            manager get compressed. @see SkeletonDef::compressAnimations
+        @remarks
+            Already created skeletons are not affected.
+        */
+        void setAnimationCompression( bool bCompress,
+                                      const KfCompressionSettings &settings = KfCompressionSettings() );
+        bool getAnimationCompression(void) const            { return mCompressAnimations; }
+        const KfCompressionSettings& getAnimationCompressionSettings(void) const
+                                                            { return mCompressionSettings; }
+
         /** Override standard Singleton retrieval.
         @remarks
         Why do we do this? Well, it's because the Singleton
@@ -50,6 +50,73 @@ namespace Ogre
 
     typedef FastArray<BoneTransform> TransformArray;
 
+    /// Settings for SkeletonAnimationDef::compress
+    struct _OgreExport KfCompressionSettings
+    {
+        /** Maximum error allowed when removing keyframes, and below which a channel
+            is considered constant (and thus stored only once).
+            Positions & scales are measured per component, in units. Orientations are
+            measured per (normalized) quaternion component.
+        */
+        Real    positionTolerance;
+        Real    orientationTolerance;
+        Real    scaleTolerance;
+        /// When false, only constant channel elision and quantization are performed.
+        bool    removeKeyFrames;
+        /** When true, the error and the sampling times in KfCompressionReport are measured.
+            This samples every original keyframe several times, thus it's off by default.
+        */
+        bool    measure;
+
+        KfCompressionSettings() :
+            positionTolerance( 1e-4f ),
+            orientationTolerance( 1e-4f ),
+            scaleTolerance( 1e-4f ),
+            removeKeyFrames( true ),
+            measure( false )
+        {
+        }
+    };
+
+    /// Memory and decode-time trade-offs of SkeletonAnimationDef::compress
+    struct _OgreExport KfCompressionReport
+    {
+        size_t  uncompressedBytes;
+        size_t  compressedBytes;
+        size_t  numKeyFramesBefore;
+        size_t  numKeyFramesAfter;
+        /// Each track has 3 channels: position, orientation and scale.
+        size_t  numChannels;
+        size_t  numConstantChannels;
+        /// Measured error at the original keyframes, after compression.
+        /// Only when KfCompressionSettings::measure is set; 0 otherwise.
+        Real    maxPositionError;
+        Real    maxOrientationError;
+        Real    maxScaleError;
+        /// Time (in microseconds) taken to sample every original keyframe
+        /// a few times, before and after compression.
+        /// Only when KfCompressionSettings::measure is set; 0 otherwise.
+        uint64  uncompressedSampleTimeUs;
+        uint64  compressedSampleTimeUs;
+
+        KfCompressionReport();
+
+        KfCompressionReport& operator += ( const KfCompressionReport &other );
+    };
+
+    /// Per-track dequantization data of a compressed SkeletonTrack.
+    struct KfCompressedHeader
+    {
+        /// Values of the channels that don't change during the whole animation
+        KfTransform     constantTransform;
+        /// position = positionMin + quantized * positionStep
+        ArrayVector3    positionMin;
+        ArrayVector3    positionStep;
+        /// scale = scaleMin + quantized * scaleStep
+        ArrayVector3    scaleMin;
+        ArrayVector3    scaleStep;
+    };
+
     class _OgreExport SkeletonTrack : public AnimationAlloc
     {
     protected:
@@ -78,6 +145,40 @@ namespace Ogre
 
         KfTransformArrayMemoryManager *mLocalMemoryManager;
 
+        enum KfChannels
+        {
+            KfChannelPosition       = 1u << 0u,
+            KfChannelOrientation    = 1u << 1u,
+            KfChannelScale          = 1u << 2u
+        };
+
+        /** When not null, the keyframes are compressed and KeyFrameRig::mBoneTransform
+            is null. The memory is owned by SkeletonAnimationDef.
+            Each keyframe takes mCompressedStride bytes, laid out as follows (each
+            animated channel is present only if its bit is set in mAnimatedChannels):
+                uint16 position[3][ARRAY_PACKED_REALS]      range-quantized
+                uint16 scale[3][ARRAY_PACKED_REALS]         range-quantized
+                int16  orientation[3][ARRAY_PACKED_REALS]   the smallest three components
+                uint8  largest[ARRAY_PACKED_REALS]          index of the dropped component
+        */
+        KfCompressedHeader const    *mCompressedHeader;
+        uint8 const                 *mCompressedKeyFrames;
+        uint32                      mCompressedStride;
+        /// Bitmask of KfChannels. Channels not in the mask are constant.
+        uint8                       mAnimatedChannels;
+
+        uint8 getAnimatedChannels( const KfCompressionSettings &settings ) const;
+        static uint32 getCompressedStride( uint8 animatedChannels );
+
+        inline void decodeKeyFrame( size_t keyFrameIdx, KfTransform &outTransform ) const;
+
+        /// Retrieves the (possibly decompressed) transforms of prevFrame & nextFrame
+        inline void getKeyFrameTransforms( KeyFrameRigVec::const_iterator prevFrame,
+                                           KeyFrameRigVec::const_iterator nextFrame,
+                                           KfTransform &tmpPrev, KfTransform &tmpNext,
+                                           KfTransform const * RESTRICT_ALIAS &outPrev,
+                                           KfTransform const * RESTRICT_ALIAS &outNext ) const;
+
     public:
         SkeletonTrack( uint32 boneBlockIdx, KfTransformArrayMemoryManager *kfTransformMemoryManager );
         ~SkeletonTrack();
@@ -126,6 +227,36 @@ namespace Ogre
             mUsedSlots <= (ARRAY_PACKED_REALS >> 1). Otherwise it does nothing.
         */
         void _bakeUnusedSlots(void);
+
+        bool isCompressed(void) const                           { return mCompressedHeader != 0; }
+
+        /// Retrieves the transform of the given keyframe (decompressing it if necessary)
+        void _getKeyFrameTransform( size_t keyFrameIdx, KfTransform &outTransform ) const;
+
+        /// Evaluates the track at the given frame, without blending. Slow. Used for
+        /// error measurement and debugging. @see applyKeyFrameRigAt
+        void _getInterpolatedTransform( Real frame, KfTransform &outTransform ) const;
+
+        /** Removes the keyframes that can be reconstructed by interpolating their
+            neighbours within the given tolerances. Only for uncompressed tracks.
+            The KfTransforms of the removed keyframes are not freed.
+        @return
+            Number of removed keyframes.
+        */
+        size_t _removeRedundantKeyFrames( const KfCompressionSettings &settings );
+
+        /// Returns the number of bytes _compress will need. Multiple of OGRE_SIMD_ALIGNMENT.
+        size_t _calculateCompressedSize( const KfCompressionSettings &settings ) const;
+
+        /** Compresses the keyframes into the given memory. After this call, the
+            KfTransforms of the keyframes are no longer referenced.
+        @param dst
+            Must be aligned to OGRE_SIMD_ALIGNMENT, hold _calculateCompressedSize bytes,
+            and outlive this track.
+        @return
+            Number of channels found to be constant (0 to 3).
+        */
+        size_t _compress( const KfCompressionSettings &settings, uint8 *dst );
     };
 
     typedef vector<SkeletonTrack>::type SkeletonTrackVec;
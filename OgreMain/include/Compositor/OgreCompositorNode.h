@@ -36,6 +36,7 @@ THE SOFTWARE.
 #include "OgreResourceTransition.h"
 #include "OgreIdString.h"
 #include "OgreId.h"
+#include "OgreMovableObject.h"
 
 namespace Ogre
 {
@@ -102,6 +103,9 @@ namespace Ogre
         size_t                  mNumConnectedInputs;
         CompositorChannelVec    mInTextures;
         CompositorChannelVec    mLocalTextures;
+        /// Indices to mLocalTextures which actually belong to another node, hence we
+        /// don't destroy them. @See CompositorWorkspace::setTransientTextureAliasing
+        vector<size_t>::type    mAliasedLocalTextures;
 
         /// Contains pointers that are ither in mInTextures or mLocalTextures
         CompositorChannelVec    mOutTextures;
@@ -111,6 +115,9 @@ namespace Ogre
 
         CompositorPassVec   mPasses;
 
+        /// Frusta from our scene passes culled at once. @See SceneManager::setMultiFrustumCulling
+        FastArray<MovableObject::MultiFrustum*> mMultiFrusta;
+
         /// Nodes we're connected to. If we destroy our local textures, we need to inform them
         CompositorNodeVec   mConnectedNodes;
 
@@ -145,6 +152,10 @@ namespace Ogre
         */
         virtual void postInitializePass( CompositorPass *pass ) {}
 
+        /// Culls all our scene passes that are about to be executed in a single sweep.
+        void cullPassesMultiFrustum( const Camera *lodCamera, SceneManager *sceneManager,
+                                     const CompositorShadowNode *shadowNode, uint8 executionMask );
+
     public:
         /** The Id must be unique across all engine so we can create unique named textures.
             The name is only unique across the workspace
@@ -321,6 +332,24 @@ namespace Ogre
         */
         void _notifyCleared(void);
 
+        /** Internal Use. Makes one of our local textures use the RenderTarget owned by
+            another node, and destroys the one we had. The textures must have compatible
+            definitions. Must be called before creating the passes.
+            @See CompositorWorkspace::setTransientTextureAliasing
+        @param localTextureIdx
+            Index to getLocalTextures()
+        @param sharedChannel
+            The local texture from another node we'll be sharing.
+        */
+        void _aliasLocalTexture( size_t localTextureIdx, const CompositorChannel &sharedChannel );
+
+        /** Internal Use. Creates again our own textures for all the local textures set
+            with _aliasLocalTexture. Must be called after _notifyCleared.
+        */
+        void _restoreAliasedLocalTextures( const RenderTarget *finalTarget );
+
+        bool isLocalTextureAliased( size_t localTextureIdx ) const;
+
         /** Called by CompositorManager2 when (i.e.) the RenderWindow was resized, thus our
             RTs that depend on their resolution need to be recreated.
         @remarks
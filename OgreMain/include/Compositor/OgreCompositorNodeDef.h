@@ -156,6 +156,8 @@ namespace Ogre
 
         /// Retrieves an existing pass by it's given index.
         CompositorTargetDef* getTargetPass( size_t passIndex )  { return &mTargetPasses[passIndex]; }
+        const CompositorTargetDef* getTargetPass( size_t passIndex ) const
+                                                                { return &mTargetPasses[passIndex]; }
 
         /// Gets the number of passes in this node.
         size_t getNumTargetPasses(void) const                   { return mTargetPasses.size(); }
@@ -34,6 +34,7 @@ THE SOFTWARE.
 #include "Compositor/OgreCompositorNode.h"
 #include "Compositor/OgreCompositorShadowNodeDef.h"
 #include "OgreShadowCameraSetup.h"
+#include "OgreShadowCasterVolume.h"
 #include "OgreLight.h"
 
 namespace Ogre
@@ -111,6 +112,8 @@ namespace Ogre
             Real                    minDistance;
             Real                    maxDistance;
             Vector2                 scenePassesViewportSize[Light::NUM_LIGHT_TYPES];
+            /// @See SceneManager::setShadowCasterVolumeCulling
+            ShadowCasterVolume      casterVolume;
         };
 
         typedef vector<ShadowMapCamera>::type ShadowMapCameraVec;
@@ -177,6 +180,13 @@ namespace Ogre
                                                    size_t * RESTRICT_ALIAS inOutStartIdx,
                                                    size_t * RESTRICT_ALIAS outEntryToUse ) const;
 
+        /** Builds the volume of the casters that can cast a shadow onto what the camera
+            sees, and assigns it to the shadow map's camera. @See ShadowCasterVolume
+        */
+        void updateShadowCasterVolume( ShadowMapCamera &shadowMapCamera,
+                                       const ShadowTextureDefinition &shadowTexDef,
+                                       const Camera *camera, const Light *light );
+
         void clearShadowCastingLights( const LightListInfo &globalLightList );
         void restoreStaticShadowCastingLights( const LightListInfo &globalLightList );
 
@@ -0,0 +1,132 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2017 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef __CompositorTextureAliasing_H__
+#define __CompositorTextureAliasing_H__
+
+#include "OgreHeaderPrefix.h"
+#include "Compositor/OgreTextureDefinition.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Effects
+    *  @{
+    */
+
+    /** Decides which transient textures can share the same allocation.
+    @remarks
+        Most local textures of a node (blur ping-pong buffers, intermediate HDR
+        targets, etc) only hold meaningful contents between the pass that first
+        writes to them and the last pass that reads from them. Once the whole
+        workspace has been laid out, two such textures whose lifetimes don't
+        overlap and that would be created with exactly the same parameters can
+        use the same RenderTarget.
+    @par
+        This class only contains the analysis, which is kept independent of the
+        render system so that it can be tested on its own.
+        See CompositorWorkspace::setTransientTextureAliasing for the part that
+        gathers the lifetimes from the passes and shares the textures.
+    */
+    class _OgreExport CompositorTextureAliasing
+    {
+    public:
+        struct Lifetime
+        {
+            /// Index of the first and last pass (in the workspace's execution order)
+            /// that access the texture. firstUse > lastUse means it's never accessed.
+            uint32  firstUse;
+            uint32  lastUse;
+            /// Textures can only share their allocation if this value is the same.
+            uint32  compatibilityClass;
+            size_t  sizeBytes;
+            /// False if the texture must keep its own allocation (i.e. its
+            /// contents must survive across frames)
+            bool    canAlias;
+
+            Lifetime() :
+                firstUse( std::numeric_limits<uint32>::max() ), lastUse( 0 ),
+                compatibilityClass( 0 ), sizeBytes( 0 ), canAlias( true ) {}
+
+            bool isUsed(void) const                 { return firstUse <= lastUse; }
+            void addUse( uint32 passIdx );
+        };
+        typedef vector<Lifetime>::type LifetimeVec;
+
+        struct Stats
+        {
+            size_t  numTextures;
+            /// Number of textures that use the allocation of another texture.
+            size_t  numAliased;
+            /// Memory used if every texture had its own allocation.
+            size_t  naiveBytes;
+            /// Memory used after aliasing.
+            size_t  allocatedBytes;
+            /// Largest amount of memory alive at the same time while executing the passes.
+            /// It is the lower bound allocatedBytes could reach with a perfect packing.
+            size_t  peakLiveBytes;
+
+            Stats() :
+                numTextures( 0 ), numAliased( 0 ), naiveBytes( 0 ),
+                allocatedBytes( 0 ), peakLiveBytes( 0 ) {}
+        };
+
+        /** Assigns lifetimes to allocations. Lifetimes are processed by order of first
+            use, and each reuses the allocation of a compatible texture whose last use
+            happened in an earlier pass (if any).
+        @param lifetimes
+            One entry per texture.
+        @param outAllocation [out]
+            For each texture, the index of the texture whose allocation it must use.
+            outAllocation[i] == i when the texture keeps its own.
+        @param outStats [out]
+            Memory statistics.
+        */
+        static void assignAllocations( const LifetimeVec &lifetimes,
+                                       vector<size_t>::type &outAllocation, Stats &outStats );
+
+        /// Returns true if both definitions would create the same texture (ignoring the name)
+        static bool areCompatible( const TextureDefinitionBase::TextureDefinition &a,
+                                   const TextureDefinitionBase::TextureDefinition &b );
+
+        /// Returns true if textures created by the definition are candidates to be shared.
+        static bool isAliasable( const TextureDefinitionBase::TextureDefinition &textureDef );
+
+        /// Estimates the memory used by all the textures in the channel (mipmaps and MSAA included)
+        static size_t getMemoryUsage( const CompositorChannel &channel );
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -32,6 +32,7 @@ THE SOFTWARE.
 #include "OgreHeaderPrefix.h"
 #include "Compositor/OgreCompositorWorkspaceDef.h"
 #include "Compositor/OgreCompositorChannel.h"
+#include "Compositor/OgreCompositorTextureAliasing.h"
 #include "OgreVector4.h"
 #include "OgreCamera.h"
 #include "OgreResourceTransition.h"
@@ -117,6 +118,9 @@ namespace Ogre
         ResourceLayoutMap       mResourcesLayout;
         ResourceAccessMap       mUavsAccess;
 
+        bool                                mTransientTextureAliasing;
+        CompositorTextureAliasing::Stats    mTransientTextureStats;
+
         /// Creates all the node instances from our definition
         void createAllNodes(void);
 
@@ -145,6 +149,16 @@ namespace Ogre
 
         void analyzeHazardsAndPlaceBarriers(void);
 
+        /** Walks the passes of all nodes in execution order to find out when each
+            local texture is first written & last read, then makes the nodes share
+            the textures whose lifetimes don't overlap.
+            @See setTransientTextureAliasing
+        @remarks
+            Call this function after connecting the nodes but before creating the passes.
+            mNodeSequence must already be in the order of execution.
+        */
+        void aliasTransientTextures(void);
+
         CompositorNode* getLastEnabledNode(void);
 
     public:
@@ -217,6 +231,37 @@ namespace Ogre
         */
         void reconnectAllNodes(void);
 
+        /** Lets local textures from different nodes share the same RenderTarget when
+            their contents are not needed at the same time. For example a bloom node's
+            intermediate blur targets can reuse the memory of an earlier node's HDR
+            target once nothing reads it anymore.
+        @remarks
+            A texture is only considered transient if the first pass that touches it
+            every frame is a clear (of the colour buffer) or a quad pass covering the whole
+            viewport and scissor, with colour writes on, stencil testing off and a material
+            that writes all channels without blending. Quads whose shader discards pixels
+            aren't detected; clear the texture first in that case. Textures read before being written, textures touched by passes that
+            don't run every frame (@see CompositorPassDef::mNumInitialPasses) or by custom
+            passes, and 3D, cubemap, array & depth textures always keep their own memory.
+            Textures can only be shared if their definitions are equal (except the name).
+        @par
+            Textures accessed outside of the compositor (i.e. via getLocalTextures, or from a
+            CompositorWorkspaceListener) may contain other node's contents. Don't enable this
+            option if you do that.
+        @par
+            Changing this setting reconnects all nodes. While enabled, resizing the final
+            target recreates all nodes.
+        @param bEnabled
+            True to share textures. Default is false.
+        */
+        void setTransientTextureAliasing( bool bEnabled );
+        bool getTransientTextureAliasing(void) const        { return mTransientTextureAliasing; }
+
+        /// Memory used by the local textures of our nodes, with and without aliasing.
+        /// @See setTransientTextureAliasing. Only filled while aliasing is enabled.
+        const CompositorTextureAliasing::Stats& getTransientTextureStats(void) const
+                                                            { return mTransientTextureStats; }
+
         /** Resets the number of passes left for every pass (@see CompositorPassDef::mNumInitialPasses)
             Useful when you have a few starting 'initialization' passes and you want to reset them.
         */
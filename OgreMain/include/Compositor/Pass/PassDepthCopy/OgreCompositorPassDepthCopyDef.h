@@ -81,6 +81,9 @@ namespace Ogre
             @See QuadTextureSource for params
         */
         void setDepthTextureCopy( const String &srcTextureName, const String &dstTextureName );
+
+        IdString getSrcDepthTextureName(void) const     { return mSrcDepthTextureName; }
+        IdString getDstDepthTextureName(void) const     { return mDstDepthTextureName; }
     };
 
     /** @} */
@@ -33,6 +33,7 @@ THE SOFTWARE.
 
 #include "Compositor/Pass/OgreCompositorPass.h"
 #include "Compositor/Pass/PassScene/OgreCompositorPassSceneDef.h"
+#include "OgreMovableObject.h"
 
 namespace Ogre
 {
@@ -71,6 +72,9 @@ namespace Ogre
         TextureVec const        *mPrePassDepthTexture;
         TextureVec const        *mSsrTexture;
 
+        /// @See _prepareMultiFrustumCull
+        MovableObject::MultiFrustum mMultiFrustum;
+
     public:
         /** Constructor
         @param definition
@@ -102,6 +106,14 @@ namespace Ogre
 
         virtual void notifyCleared(void);
 
+        /** Copies the frustum this pass will cull against (as it will be when
+            execute gets called) so it can be culled in advance, together with other
+            passes. @See SceneManager::_cullPhase01Multi
+        @return
+            Null if this pass can't be culled in advance (e.g. it reuses culling data).
+        */
+        MovableObject::MultiFrustum* _prepareMultiFrustumCull( const Camera *lodCamera );
+
         const CompositorPassSceneDef* getDefinition() const     { return mDefinition; }
     };
 
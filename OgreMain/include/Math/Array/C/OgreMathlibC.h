@@ -305,7 +305,7 @@ namespace Ogre
         @return
             r[0] = min( a[0], a[1], a[2], a[3] )
         */
-        static inline Real ColapseMin( ArrayReal a )
+        static inline Real CollapseMin( ArrayReal a )
         {
             return a;
         }
@@ -314,7 +314,7 @@ namespace Ogre
         @return
             r[0] = max( a[0], a[1], a[2], a[3] )
         */
-        static inline Real ColapseMax( ArrayReal a )
+        static inline Real CollapseMax( ArrayReal a )
         {
             return a;
         }
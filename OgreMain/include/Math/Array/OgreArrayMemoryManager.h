@@ -159,6 +159,15 @@ namespace Ogre
         /// belongs
         uint16              mLevel;
 
+        /// Second copy of the pools that are double buffered. @See setDoubleBuffered.
+        /// Empty when double buffering is off. Entries are null for pools that
+        /// don't need a back buffer.
+        MemoryPoolVec       mBackPools;
+        /// Value of mMaxMemory when mBackPools were last allocated
+        size_t              mBackPoolsMaxMemory;
+        /// Set when slots were created, destroyed or shifted after mBackPools were synced
+        bool                mBackPoolsDirty;
+
     public:
         static const size_t MAX_MEMORY_SLOTS;
 
@@ -235,6 +244,54 @@ namespace Ogre
         /// Gets all memory reserved for this manager
         size_t getAllMemory() const;
 
+        /** Grows the pools (if needed) so that numSlots more slots can be created
+            without further reallocations.
+        @remarks
+            Each time the pools run out of memory they grow by 50%, and every existing
+            slot needs to be rebased. Creating objects in large batches (i.e. when
+            streaming a scene) can reserve the memory upfront to grow only once.
+        @return
+            True if the pools were reallocated.
+        */
+        bool reserve( size_t numSlots );
+
+        /** Keeps a second copy (the "back buffer") of the pools for which
+            needsBackBuffer or isBackBufferInput return true.
+        @remarks
+            Used by SceneManager::setPipelinedUpdate so that a background thread can write
+            the next frame's results while the current frame is still being rendered
+            from the regular (front) pools. The inputs it reads are snapshotted, so the
+            front ones can be modified in the meantime.
+            Slots are always created, destroyed and defragmented in the front pools;
+            call _syncBackBuffers before writing to the back buffer.
+        */
+        void setDoubleBuffered( bool doubleBuffered );
+        bool getDoubleBuffered(void) const                  { return !mBackPools.empty(); }
+
+        /** Snapshots the input pools into the back buffer. If any slot changed since the
+            last sync, all the back buffered pools get copied instead.
+        */
+        void _syncBackBuffers(void);
+
+        /// Copies the used slots of the output pools from the back buffer into the front ones.
+        void _publishBackBuffers(void);
+
+        /** Converts a pointer to memory in mMemoryPools[memoryType] into the same
+            location in the back buffer.
+        @return
+            The pointer in the back buffer. The input pointer when the pool isn't double buffered.
+        */
+        template <typename T>
+        T* _getBackBufferPtr( T *frontPtr, size_t memoryType ) const
+        {
+            if( mBackPools.empty() || !mBackPools[memoryType] )
+                return frontPtr;
+
+            return reinterpret_cast<T*>( mBackPools[memoryType] +
+                                         ( reinterpret_cast<const char*>( frontPtr ) -
+                                           mMemoryPools[memoryType] ) );
+        }
+
     protected:
         /** Requests memory for a new slot (could be used for SceneNode, Entities, etc.)
             @remarks
@@ -256,6 +313,9 @@ namespace Ogre
         */
         void destroySlot( const char *ptrToFirstElement, uint8 index );
 
+        /// Reallocates the pools to hold newMemory slots and rebases all ptrs.
+        void growPools( size_t newMemory );
+
         /** Called when mMemoryPools changes, to give a chance derived class to initialize
             new memory to default values
         @remarks
@@ -265,6 +325,14 @@ namespace Ogre
             The previous value of mMaxMemory before changing mMemoryPools
         */
         virtual void initializeEmptySlots( size_t prevNumSlots ) {}
+
+        /// Returns true if the given memory type is written to the back buffer and
+        /// copied back by _publishBackBuffers. @See setDoubleBuffered
+        virtual bool needsBackBuffer( size_t memoryType ) const { return false; }
+
+        /// Returns true if the given memory type is read from the back buffer while the
+        /// front one may be modified. Snapshotted on every _syncBackBuffers.
+        virtual bool isBackBufferInput( size_t memoryType ) const { return false; }
     };
 
 
@@ -285,6 +353,11 @@ namespace Ogre
         /// We overload to set all mParents to point to mDummyNode
         virtual void initializeEmptySlots( size_t prevNumSlots );
 
+        /// Only the derived transform is written to the back buffer
+        virtual bool needsBackBuffer( size_t memoryType ) const;
+        /// Position, orientation, scale & inheritance are snapshotted
+        virtual bool isBackBufferInput( size_t memoryType ) const;
+
     public:
         enum MemoryTypes
         {
@@ -339,6 +412,10 @@ namespace Ogre
             Number of Nodes in this depth level
         */
         size_t getFirstNode( Transform &outTransform );
+
+        /// Makes the local and derived position, orientation, scale, the transform and the
+        /// inheritance flags of the given Transform point to the back buffer. @See setDoubleBuffered
+        void _toBackBuffer( Transform &inOutTransform ) const;
     };
 
 
@@ -359,6 +436,11 @@ namespace Ogre
         /// We overload to set all mParents to point to mDummyNode
         virtual void initializeEmptySlots( size_t prevNumSlots );
 
+        /// Only the world bounds are written to the back buffer
+        virtual bool needsBackBuffer( size_t memoryType ) const;
+        /// The local bounds are snapshotted
+        virtual bool isBackBufferInput( size_t memoryType ) const;
+
     public:
         enum MemoryTypes
         {
@@ -393,6 +475,10 @@ namespace Ogre
 
         /// @copydoc NodeArrayMemoryManager::getFirstNode
         size_t getFirstNode( ObjectData &outData );
+
+        /// Makes the local & world Aabb and radius of the given ObjectData point to
+        /// the back buffer. @See setDoubleBuffered
+        void _toBackBuffer( ObjectData &inOutData ) const;
     };
 
     extern void cleanerFlat( char *dstPtr, size_t indexDst, char *srcPtr, size_t indexSrc,
@@ -68,6 +68,14 @@ namespace Ogre
         SceneMemoryMgrTypes                     mMemoryManagerType;
         NodeMemoryManager                       *mTwinMemoryManager;
 
+        /// @See setDoubleBuffered
+        bool                                    mDoubleBuffered;
+        SceneManager                            *mSceneManager;
+
+        /// Structural changes must not overlap with the pipelined update, which reads
+        /// the slots. Waits for the SceneManager's pending update, if any.
+        void finishPendingSceneGraphUpdate(void);
+
         /** Makes mMemoryManagers big enough to be able to fulfill mMemoryManagers[newDepth]
         @param newDepth
             Hierarchy level depth we wish to grow to.
@@ -205,6 +213,40 @@ namespace Ogre
         */
         size_t getFirstNode( Transform &outTransform, size_t depth );
 
+        /** Makes room for numNodes more nodes at the given depth, so creating them
+            reallocates (and rebases) the memory at most once.
+            @See ArrayMemoryManager::reserve
+        */
+        void reserve( size_t depth, size_t numNodes );
+
+        /** Keeps a second copy of the transforms of all depth levels, so the derived ones
+            can be written by a background thread while the current ones are still being read.
+            @See ArrayMemoryManager::setDoubleBuffered and SceneManager::setPipelinedUpdate
+        @param sceneManager
+            Owner of the pipelined update. Creating, destroying, attaching, detaching or
+            moving nodes first waits for its pending update (if any).
+        */
+        void setDoubleBuffered( bool doubleBuffered, SceneManager *sceneManager );
+        bool getDoubleBuffered(void) const                          { return mDoubleBuffered; }
+
+        /// @See ArrayMemoryManager::_syncBackBuffers
+        void _syncBackBuffers(void);
+
+        /** Copies the derived transforms from the back buffer into the current ones
+        @param firstDepth
+            Depth levels above this one were not written to and are left untouched.
+        */
+        void _publishBackBuffers( size_t firstDepth );
+
+        /** Makes the local & derived transform pointers of a Transform that belongs
+            to us point to the back buffer.
+        @param inOutTransform
+            Transform with pointers to the first Node or to a given Node.
+        @param depth
+            Hierarchy level depth the Transform belongs to.
+        */
+        void _toBackBuffer( Transform &inOutTransform, size_t depth ) const;
+
         //Derived from ArrayMemoryManager::RebaseListener
         virtual void buildDiffList( uint16 level, const MemoryPoolVec &basePtrs,
                                     ArrayMemoryManager::PtrdiffVec &outDiffsList );
@@ -62,6 +62,9 @@ namespace Ogre
         /// Tracks total number of objects in all render queues.
         size_t                                  mTotalObjects;
 
+        /// Incremented every time objects get created, destroyed or moved to a different slot.
+        uint32                                  mLayoutVersion;
+
         /// Dummy node where to point ObjectData::mParents[i] when they're unused slots.
         SceneNode                               *mDummyNode;
         Transform                               mDummyTransformPtrs;
@@ -74,6 +77,14 @@ namespace Ogre
         SceneMemoryMgrTypes                     mMemoryManagerType;
         ObjectMemoryManager                     *mTwinMemoryManager;
 
+        /// @See setDoubleBuffered
+        bool                                    mDoubleBuffered;
+        SceneManager                            *mSceneManager;
+
+        /// Structural changes must not overlap with the pipelined update, which reads
+        /// the slots. Waits for the SceneManager's pending update, if any.
+        void finishPendingSceneGraphUpdate(void);
+
         /** Makes mMemoryManagers big enough to be able to fulfill mMemoryManagers[newDepth]
         @param newDepth
             Hierarchy level depth we wish to grow to.
@@ -159,6 +170,12 @@ namespace Ogre
         */
         size_t getTotalNumObjects() const                   { return mTotalObjects; }
 
+        /** Changes whenever the slot an object lives in may have changed (i.e. objects
+            were created, destroyed, changed RenderQueue or the memory was defragmented).
+            Useful for caching data indexed by slot, @see StaticObjectBvh
+        */
+        uint32 _getLayoutVersion() const                    { return mLayoutVersion; }
+
         /// This is the opposite of getTotalNumObjects. This function returns the sum
         /// of the return values of getFirstObjectData
         size_t calculateTotalNumObjectDataIncludingFragmentedSlots() const;
@@ -176,6 +193,37 @@ namespace Ogre
         */
         size_t getFirstObjectData( ObjectData &outObjectData, size_t renderQueue );
 
+        /** Makes room for numObjects more objects in the given render queue, so creating
+            them reallocates (and rebases) the memory at most once.
+            @See ArrayMemoryManager::reserve
+        */
+        void reserve( size_t renderQueue, size_t numObjects );
+
+        /** Keeps a second copy of the bounds of all render queues, so the world ones can
+            be written by a background thread while the current ones are still being read.
+            @See ArrayMemoryManager::setDoubleBuffered and SceneManager::setPipelinedUpdate
+        @param sceneManager
+            Owner of the pipelined update. Creating, destroying or moving objects first
+            waits for its pending update (if any).
+        */
+        void setDoubleBuffered( bool doubleBuffered, SceneManager *sceneManager );
+        bool getDoubleBuffered(void) const                  { return mDoubleBuffered; }
+
+        /// @See ArrayMemoryManager::_syncBackBuffers
+        void _syncBackBuffers(void);
+
+        /// Copies the world bounds from the back buffer into the current ones.
+        void _publishBackBuffers(void);
+
+        /** Makes the local & world bounds pointers of an ObjectData that belongs
+            to us point to the back buffer.
+        @param inOutObjectData
+            ObjectData with pointers to the first MovableObject or to a given one.
+        @param renderQueue
+            Render queue the ObjectData belongs to.
+        */
+        void _toBackBuffer( ObjectData &inOutObjectData, size_t renderQueue ) const;
+
         //Derived from ArrayMemoryManager::RebaseListener
         virtual void buildDiffList( uint16 level, const MemoryPoolVec &basePtrs,
                                     ArrayMemoryManager::PtrdiffVec &outDiffsList );
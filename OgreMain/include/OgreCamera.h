@@ -168,6 +168,8 @@ namespace Ogre {
         bool mUseRenderingDistance;
         /// Camera to use for LOD calculation
         const Camera* mLodCamera;
+        /// @see _setShadowCasterVolume
+        ShadowCasterVolume const *mShadowCasterVolume;
         
         /// Whether or not the minimum display size of objects should take effect for this camera
         bool mUseMinPixelSize;
@@ -494,6 +496,15 @@ namespace Ogre {
         */
         virtual const Camera* getLodCamera() const;
 
+        /** Objects that are outside this volume are culled in addition to those outside the
+            frustum. Used by CompositorShadowNode on shadow map cameras to reject casters
+            whose shadows can't be seen. @See SceneManager::setShadowCasterVolumeCulling
+        @param volume
+            Must stay alive while set. Null to disable (default).
+        */
+        void _setShadowCasterVolume( const ShadowCasterVolume *volume )
+                                                            { mShadowCasterVolume = volume; }
+        const ShadowCasterVolume* getShadowCasterVolume(void) const { return mShadowCasterVolume; }
 
         /** Gets a world space ray as cast from the camera through a viewport position.
         @param screenx, screeny The x and y position at which the ray should intersect the viewport,
@@ -78,7 +78,8 @@ namespace Ogre {
         virtual Real getSquaredDepth(const MovableObject *movableObject, const Ogre::Camera *camera) const = 0;
 
         virtual void lodUpdateImpl( const size_t numNodes, ObjectData t,
-                                    const Camera *camera, Real bias ) const;
+                                    const Camera *camera, Real bias, Real hysteresis,
+                                    LodTransitions &outTransitions ) const;
 
         /** Sets the reference view upon which the distances were based.
         @note
@@ -0,0 +1,279 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2017 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _OgreFrameArena_H_
+#define _OgreFrameArena_H_
+
+#include "OgrePrerequisites.h"
+#include "OgreCommon.h"
+#include "OgreFastArray.h"
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Memory
+    *  @{
+    */
+
+    /** Linear (bump pointer) allocator for scratch memory that only lives within a frame.
+        Each SceneManager worker thread owns one (see SceneManager::_getFrameArena) and
+        SceneManager::_frameEnded resets them.
+    @remarks
+        Allocating is just advancing an offset into one big block; there is no per
+        allocation free. Scratch users that are done with their memory before returning
+        can give it back with getMarker / rewind, so the arena doesn't keep growing
+        during the frame.
+    @par
+        When a frame needs more than the block has, the extra requests are served from
+        overflow blocks taken from the general heap. On the next reset those are released
+        and the main block is grown to the peak usage seen, so once the working set is
+        known (i.e. in steady state) the arena doesn't touch the general heap at all.
+        getNumHeapAllocations tells how many times it did.
+    @par
+        Not thread safe. Memory returned by allocate is aligned to OGRE_SIMD_ALIGNMENT,
+        and types placed in it must not need their destructor to run.
+    */
+    class _OgreExport FrameArena : public SceneMgtAlloc
+    {
+        uint8   *mBlock;
+        size_t  mCapacity;
+        size_t  mOffset;
+
+        /// Blocks used when mBlock ran out this frame. Released by reset.
+        FastArray<uint8*> mOverflowBlocks;
+        /// Free bytes left in mOverflowBlocks.back()
+        size_t  mOverflowOffset;
+        size_t  mOverflowCapacity;
+        /// Bytes served from overflow blocks this frame
+        size_t  mOverflowBytes;
+
+        /// Highest mOffset + mOverflowBytes seen since the last reset.
+        size_t  mPeakBytes;
+        /// Highest mPeakBytes of any frame, ever.
+        size_t  mHighWaterMark;
+
+        size_t  mNumHeapAllocations;
+
+        void* allocateOverflow( size_t bytes );
+
+    public:
+        /// Marker returned by getMarker. @See rewind
+        typedef size_t Marker;
+
+        FrameArena( size_t initialCapacity = 64u * 1024u );
+        ~FrameArena();
+
+        /** Returns bytes of scratch memory, valid until the next reset (or a rewind
+            to a marker taken before this call).
+        @remarks
+            Never returns null. Zero-byte requests return a valid (non dereferenceable)
+            pointer.
+        */
+        void* allocate( size_t bytes )
+        {
+            const size_t alignedBytes = alignToNextMultiple( bytes, OGRE_SIMD_ALIGNMENT );
+            if( mOffset + alignedBytes <= mCapacity && mOverflowBlocks.empty() )
+            {
+                void *retVal = mBlock + mOffset;
+                mOffset += alignedBytes;
+                mPeakBytes = std::max( mPeakBytes, mOffset );
+                return retVal;
+            }
+
+            return allocateOverflow( alignedBytes );
+        }
+
+        /// Allocates an uninitialised array of numElements. T must be a POD type.
+        template <typename T> T* allocate( size_t numElements )
+        {
+            return reinterpret_cast<T*>( allocate( numElements * sizeof(T) ) );
+        }
+
+        /// Returns the current position, to give back everything allocated after it
+        /// via rewind.
+        Marker getMarker(void) const                    { return mOffset; }
+
+        /** Releases everything allocated since getMarker returned the given marker.
+            Markers must be rewound in LIFO order.
+        @remarks
+            If the arena had to overflow in the meantime, the memory is kept until
+            reset instead (the overflow blocks can't be partially released), but it
+            is still safe to call.
+        */
+        void rewind( Marker marker )
+        {
+            assert( marker <= mOffset );
+            if( mOverflowBlocks.empty() )
+                mOffset = marker;
+        }
+
+        /** Invalidates every allocation. If this frame overflowed, the overflow blocks
+            are released and the main block is reallocated to fit the peak usage.
+        */
+        void reset(void);
+
+        /// Number of times the arena had to allocate from the general heap, since creation.
+        size_t getNumHeapAllocations(void) const        { return mNumHeapAllocations; }
+        /// Size of the main block, in bytes.
+        size_t getCapacity(void) const                  { return mCapacity; }
+        /// Bytes currently allocated (including overflow), since the last reset.
+        size_t getUsedBytes(void) const                 { return mOffset + mOverflowBytes; }
+        /// Most bytes the arena ever had allocated at once.
+        size_t getHighWaterMark(void) const             { return std::max( mHighWaterMark, mPeakBytes ); }
+    };
+
+    /** STL allocator that takes its memory from a FrameArena, for containers that only
+        live during the frame. deallocate does nothing: the memory goes back to the arena
+        on its next reset.
+    @remarks
+        The container must be destroyed (or at least not used) after the arena is reset.
+    */
+    template <typename T>
+    class FrameArenaStlAllocator
+    {
+    public:
+        typedef T                   value_type;
+        typedef value_type*         pointer;
+        typedef const value_type*   const_pointer;
+        typedef value_type&         reference;
+        typedef const value_type&   const_reference;
+        typedef std::size_t         size_type;
+        typedef std::ptrdiff_t      difference_type;
+
+        template <typename U>
+        struct rebind
+        {
+            typedef FrameArenaStlAllocator<U> other;
+        };
+
+        FrameArena *mArena;
+
+        explicit FrameArenaStlAllocator( FrameArena *arena ) : mArena( arena ) {}
+
+        template <typename U>
+        FrameArenaStlAllocator( const FrameArenaStlAllocator<U> &other ) : mArena( other.mArena ) {}
+
+        pointer allocate( size_type count, const void *hint = 0 )
+        {
+            return mArena->allocate<T>( count );
+        }
+
+        void deallocate( pointer ptr, size_type count ) {}
+
+        pointer address( reference x ) const                { return &x; }
+        const_pointer address( const_reference x ) const    { return &x; }
+
+        size_type max_size() const throw()                  { return size_type( -1 ) / sizeof(T); }
+
+        void construct( pointer p, const T &val )           { new(static_cast<void*>(p)) T( val ); }
+        void destroy( pointer p )                           { p->~T(); }
+    };
+
+    template <typename T, typename U>
+    inline bool operator == ( const FrameArenaStlAllocator<T> &a, const FrameArenaStlAllocator<U> &b )
+    {
+        return a.mArena == b.mArena;
+    }
+    template <typename T, typename U>
+    inline bool operator != ( const FrameArenaStlAllocator<T> &a, const FrameArenaStlAllocator<U> &b )
+    {
+        return a.mArena != b.mArena;
+    }
+
+    /** Same as std::stable_sort, but takes the merge buffer from the given arena instead
+        of the general heap (std::stable_sort allocates one on every call). The value type
+        must be a POD type. Ranges of up to 16 elements use an insertion sort and don't
+        touch the arena.
+    */
+    template <typename RandomIt>
+    void stableSortWithArena( RandomIt first, RandomIt last, FrameArena &frameArena )
+    {
+        typedef typename std::iterator_traits<RandomIt>::value_type value_type;
+
+        const size_t c_insertionSortSize = 16u;
+        const size_t numElements = static_cast<size_t>( last - first );
+
+        if( numElements < 2u )
+            return;
+
+        value_type *data = &(*first);
+
+        //Insertion sort runs of c_insertionSortSize. Stable since it only moves
+        //elements past others that are strictly greater.
+        for( size_t runStart=0; runStart<numElements; runStart += c_insertionSortSize )
+        {
+            const size_t runEnd = std::min( runStart + c_insertionSortSize, numElements );
+            for( size_t i=runStart + 1u; i<runEnd; ++i )
+            {
+                const value_type tmp = data[i];
+                size_t j = i;
+                while( j > runStart && tmp < data[j - 1u] )
+                {
+                    data[j] = data[j - 1u];
+                    --j;
+                }
+                data[j] = tmp;
+            }
+        }
+
+        if( numElements <= c_insertionSortSize )
+            return;
+
+        //Bottom-up merges, ping-ponging between the range and the scratch buffer.
+        //std::merge is stable (takes from the left run on ties).
+        const FrameArena::Marker marker = frameArena.getMarker();
+        value_type *src = data;
+        value_type *dst = frameArena.allocate<value_type>( numElements );
+
+        for( size_t width=c_insertionSortSize; width<numElements; width *= 2u )
+        {
+            for( size_t lo=0; lo<numElements; lo += width * 2u )
+            {
+                const size_t mid = std::min( lo + width, numElements );
+                const size_t hi  = std::min( lo + width * 2u, numElements );
+                std::merge( src + lo, src + mid, src + mid, src + hi, dst + lo );
+            }
+            std::swap( src, dst );
+        }
+
+        if( src != data )
+            std::copy( src, src + numElements, data );
+
+        frameArena.rewind( marker );
+    }
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -0,0 +1,228 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2017 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _OgreGpuBillboardSet_H_
+#define _OgreGpuBillboardSet_H_
+
+#include "OgreMovableObject.h"
+#include "OgreRenderable.h"
+#include "OgreFastArray.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Effects
+    *  @{
+    */
+
+    /** v2 replacement for v1::BillboardSet where the quads are built by the vertex shader.
+    @remarks
+        Each billboard is a single 32-byte Record (position, rotation, half size, colour,
+        UV rect index) uploaded into a TexBufferPacked. Nothing is expanded on the CPU:
+        the Vao has no vertex buffers at all and draws 6 vertices per billboard; HlmsUnlit
+        recognizes the set by CustomParameterIdx, sets the "unlit_vertex_pulling" property and the vertex
+        shader fetches the record and builds the corner from the vertex ID.
+    @par
+        The tex buffer has this layout (in float4 texels):
+            0:              camera right in local space, record start (as uint bits)
+            1:              camera up in local space
+            2 .. 2+N:       UV rects (u0, v0, u1, v1)
+            2+N ..:         two texels per Record, back to front when sorting is on.
+    @par
+        Call updateGpuData every frame the camera or the billboards change, before
+        rendering. Sorting (back to front along the camera direction) stays on the CPU;
+        computeDepthKeys and sortBackToFront are static so they can run without a
+        RenderSystem.
+    @par
+        Only HlmsUnlit datablocks can be used. Texture animation matrices are ignored
+        (the records take their slot) and the UV source of every texture must be 0.
+        Billboards don't cast shadows.
+    */
+    class _OgreExport GpuBillboardSet : public MovableObject, public Renderable
+    {
+    public:
+        /// Must match the layout read by the vertex shader (two float4 per billboard).
+        struct Record
+        {
+            float   position[3];
+            /// In radians, counter clockwise around the view direction.
+            float   rotation;
+            float   halfSize[2];
+            /// ColourValue::getAsABGR, i.e. RGBA8 with red in the lowest byte.
+            uint32  colour;
+            uint32  uvRectIdx;
+        };
+
+        typedef FastArray<Record> RecordArray;
+
+    protected:
+        RecordArray         mRecords;
+        FastArray<Vector4>  mUvRects;
+
+        /// Key in the upper 32 bits, index into mRecords in the lower 32 bits.
+        FastArray<uint64>   mSortKeys;
+        FastArray<uint64>   mSortScratch;
+        bool                mSortingEnabled;
+
+        VaoManager          *mVaoManager;
+        TexBufferPacked     *mRecordBuffer;
+        /// Capacity of mRecordBuffer, in float4 texels.
+        size_t              mRecordBufferTexels;
+
+        void createRecordBuffer( size_t numTexels );
+        void destroyRecordBuffer(void);
+        void updateLocalAabb(void);
+
+    public:
+        GpuBillboardSet( IdType id, ObjectMemoryManager *objectMemoryManager,
+                         SceneManager *manager );
+        virtual ~GpuBillboardSet();
+
+        /// Removes all billboards. Capacity is kept.
+        void clear(void);
+        void reserve( size_t numBillboards );
+
+        /** Adds a billboard.
+        @param position
+            Centre of the billboard, in local space.
+        @param size
+            Full width and height in world units.
+        @param uvRectIdx
+            Index into the rects set with setUvRects / setTextureStacksAndSlices.
+        @return
+            Index of the new billboard.
+        */
+        size_t addBillboard( const Vector3 &position, const Vector2 &size,
+                             const ColourValue &colour = ColourValue::White,
+                             Radian rotation = Radian( 0 ), uint32 uvRectIdx = 0 );
+
+        size_t getNumBillboards(void) const                 { return mRecords.size(); }
+        /// Direct access for updating billboards in place. Call updateGpuData afterwards.
+        RecordArray& getRecords(void)                       { return mRecords; }
+        const RecordArray& getRecords(void) const           { return mRecords; }
+
+        /** Replaces the billboards with the visible particles of a ParticleSystem.
+        @remarks
+            Particles are copied as they are, so for world space particle systems
+            this GpuBillboardSet should be attached to a node with identity transform.
+            Particles without their own dimensions use the system's default ones.
+        */
+        void setFromParticles( ParticleSystem *particleSystem );
+
+        /// Sets the UV rects, as (u0, v0, u1, v1). Defaults to one rect covering the texture.
+        void setUvRects( const Vector4 *uvRects, size_t numUvRects );
+        /// Same as v1::BillboardSet::setTextureStacksAndSlices. Row major, top left first.
+        void setTextureStacksAndSlices( uint8 stacks, uint8 slices );
+        const FastArray<Vector4>& getUvRects(void) const    { return mUvRects; }
+
+        /// When false, billboards are drawn in the order they were added.
+        void setSortingEnabled( bool bEnabled )             { mSortingEnabled = bEnabled; }
+        bool getSortingEnabled(void) const                  { return mSortingEnabled; }
+
+        /** Sorts (if enabled) and uploads the billboards as seen from the given camera.
+            Also updates the local Aabb and the number of vertices to draw.
+        @remarks
+            The camera's derived orientation is used, so it must be up to date.
+            Only one upload per frame is allowed; when the same set is rendered by more
+            than one camera, all of them see the quads oriented for this one.
+        */
+        void updateGpuData( const Camera *camera );
+
+        TexBufferPacked* getRecordBuffer(void) const        { return mRecordBuffer; }
+
+        /// Index of the custom parameter (see Renderable::setCustomParameter) that every
+        /// GpuBillboardSet sets on itself. Hlms implementations check it to tell the set
+        /// apart from other renderables whose Vao has no vertex buffers.
+        static const size_t CustomParameterIdx;
+
+        /** Fills a Record. Used by addBillboard; exposed for benchmarking the packing.
+        @param halfSize
+            Half of the width and height.
+        */
+        static void packRecord( Record &outRecord, const Vector3 &position,
+                                const Vector2 &halfSize, const ColourValue &colour,
+                                Radian rotation, uint32 uvRectIdx );
+
+        /** Computes one sort key per record so that ascending order is back to front.
+        @remarks
+            Uses SSE2 (four records at a time) when available.
+        @param viewDir
+            Direction the camera looks at, in the same space as the records' positions.
+            Doesn't need to be normalised.
+        @param outKeys
+            Array of numRecords. The upper 32 bits hold the key, the lower ones the
+            index of the record.
+        */
+        static void computeDepthKeys( const Record *records, size_t numRecords,
+                                      const Vector3 &viewDir, uint64 *outKeys );
+
+        /** Sorts the keys from computeDepthKeys in ascending order (i.e. back to front).
+            Stable LSD radix sort on the upper 32 bits.
+        @param scratch
+            Array of numKeys. Its contents are undefined on return.
+        */
+        static void sortBackToFront( uint64 *inOutKeys, uint64 *scratch, size_t numKeys );
+
+        //Overrides from MovableObject
+        virtual const String& getMovableType(void) const;
+
+        //Overrides from Renderable
+        virtual const LightList& getLights(void) const;
+        virtual void getRenderOperation( v1::RenderOperation& op, bool casterPass );
+        virtual void getWorldTransforms( Matrix4* xform ) const;
+        virtual bool getCastsShadows(void) const;
+    };
+
+    /** Factory object for creating GpuBillboardSet instances */
+    class _OgreExport GpuBillboardSetFactory : public MovableObjectFactory
+    {
+    protected:
+        virtual MovableObject* createInstanceImpl( IdType id, ObjectMemoryManager *objectMemoryManager,
+                                                   SceneManager *manager,
+                                                   const NameValuePairList* params = 0 );
+    public:
+        GpuBillboardSetFactory() {}
+        virtual ~GpuBillboardSetFactory() {}
+
+        static String FACTORY_TYPE_NAME;
+
+        const String& getType(void) const;
+        void destroyInstance( MovableObject* obj);
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
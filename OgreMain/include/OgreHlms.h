@@ -102,6 +102,53 @@ namespace Ogre
 
                 return setProperties == _r.setProperties && piecesEqual;
             }
+
+            /// Same as operator == but avoids constructing a RenderableCache to compare against.
+            bool equals( const HlmsPropertyVec &properties, const PiecesMap *_pieces ) const
+            {
+                if( setProperties != properties )
+                    return false;
+
+                for( size_t i=0; i<NumShaderTypes; ++i )
+                {
+                    if( _pieces ? pieces[i] != _pieces[i] : !pieces[i].empty() )
+                        return false;
+                }
+
+                return true;
+            }
+        };
+
+        /// Everything Hlms::calculateHashFor looks at from the Renderable, except
+        /// for what derived implementations may look at in calculateHashForPreCreate.
+        /// @see canMemoiseRenderableHash
+        struct RenderableHashKey
+        {
+            HlmsDatablock const     *datablock;
+            uint32                  flags;
+            /// Packed semantic, type & index of every vertex element (and the
+            /// operation type for v1 objects)
+            vector<uint32>::type    vertexLayout;
+            uint32                  hash;
+
+            bool operator == ( const RenderableHashKey &_r ) const
+            {
+                return datablock == _r.datablock && flags == _r.flags &&
+                        vertexLayout == _r.vertexLayout;
+            }
+        };
+
+        struct RenderableHashKeyHasher
+        {
+            size_t operator () ( const RenderableHashKey &key ) const   { return key.hash; }
+        };
+
+        struct RenderableHashMemo
+        {
+            /// @see HlmsDatablock::_getHashVersion
+            uint32  datablockVersion;
+            uint32  hash;
+            uint32  casterHash;
         };
 
         struct PassCache
@@ -118,10 +165,21 @@ namespace Ogre
         typedef vector<PassCache>::type PassCacheVec;
         typedef vector<RenderableCache>::type RenderableCacheVec;
 
+        typedef unordered_multimap<uint32, uint32>::type RenderableCacheIndexMap;
+        typedef unordered_map<RenderableHashKey, RenderableHashMemo,
+                              RenderableHashKeyHasher>::type RenderableHashMemoMap;
+
         PassCacheVec        mPassCache;
         RenderableCacheVec  mRenderableCache;
+        /// Content hash -> index to mRenderableCache. Lets addRenderableCache
+        /// find existing entries without comparing against all of them.
+        RenderableCacheIndexMap mRenderableCacheIndex;
         HlmsCacheVec        mShaderCache;
 
+        /// @see canMemoiseRenderableHash
+        RenderableHashMemoMap   mRenderableHashMemo;
+        RenderableHashKey       mTmpRenderableHashKey;
+
         HlmsPropertyVec mSetProperties;
         PiecesMap       mPieces;
 
@@ -327,6 +385,24 @@ namespace Ogre
         virtual void calculateHashForPreCreate( Renderable *renderable, PiecesMap *inOutPieces ) {}
         virtual void calculateHashForPreCaster( Renderable *renderable, PiecesMap *inOutPieces ) {}
 
+        /** Whether the result of calculateHashFor for this renderable can be reused for other
+            renderables with the same datablock, vertex layout, skeleton and identity flags,
+            which makes spawning lots of objects much cheaper.
+        @remarks
+            Implementations must only return true if their calculateHashForPreCreate and
+            calculateHashForPreCaster overloads don't look at anything else from the renderable
+            (e.g. custom parameters), and if they have no side effects.
+            Hlms-wide settings that influence those functions must call clearRenderableHashMemo
+            when they change.
+            The default returns false so that derived implementations stay correct.
+        */
+        virtual bool canMemoiseRenderableHash( const Renderable *renderable ) const { return false; }
+
+        /// Fills mTmpRenderableHashKey. @see canMemoiseRenderableHash
+        void fillRenderableHashKey( Renderable *renderable );
+
+        void calculateHashForImpl( Renderable *renderable, uint32 &outHash, uint32 &outCasterHash );
+
         HlmsCache preparePassHashBase( const Ogre::CompositorShadowNode *shadowNode,
                                        bool casterPass, bool dualParaboloid,
                                        SceneManager *sceneManager );
@@ -555,6 +631,9 @@ namespace Ogre
         */
         virtual void calculateHashFor( Renderable *renderable, uint32 &outHash, uint32 &outCasterHash );
 
+        /// Forgets all memoised calculateHashFor results. @see canMemoiseRenderableHash
+        void clearRenderableHashMemo(void);
+
         /** Called every frame by the Render Queue to cache the properties needed by this
             pass. i.e. Number of PSSM splits, number of shadow casting lights, etc
         @param shadowNode
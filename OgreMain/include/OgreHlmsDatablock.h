@@ -246,6 +246,8 @@ namespace Ogre
         vector<Renderable*>::type mLinkedRenderables;
         Hlms    *mCreator;
         IdString mName;
+        /// Incremented every time flushRenderables is called.
+        uint32   mHashVersion;
 
         /** Updates the mHlmsHash & mHlmsCasterHash for all linked renderables, which may have
             if a sensitive setting has changed that would need a different shader to be created
@@ -387,6 +389,9 @@ namespace Ogre
 
         const vector<Renderable*>::type& getLinkedRenderables(void) const { return mLinkedRenderables; }
 
+        /// Changes every time a setting that affects the renderables' hashes changes.
+        uint32 _getHashVersion(void) const                  { return mHashVersion; }
+
         virtual bool hasCustomShadowMacroblock(void) const;
 
         /**
@@ -412,6 +417,18 @@ namespace Ogre
                                    bool saveOitd, bool saveOriginal,
                                    HlmsTextureExportListener *listener );
 
+        /** Makes every texture unit bound to the given slice of oldTexture use the given
+            slice of newTexture instead, and sets the min LOD of their samplerblocks.
+            Used by HlmsTextureManager when a streamed texture moves or its residency changes.
+            Implementations that don't use HlmsTextureManager can ignore it.
+        @param minLod
+            Most detailed mip that can be sampled. The samplerblocks use the highest of
+            this and the HlmsSamplerblock::mMinLod set by the user, which is kept.
+        */
+        virtual void _replaceTexture( const TexturePtr &oldTexture, uint16 oldArrayIndex,
+                                      const TexturePtr &newTexture, uint16 newArrayIndex,
+                                      float minLod ) {}
+
         static const char* getCmpString( CompareFunction compareFunction );
 
     protected:
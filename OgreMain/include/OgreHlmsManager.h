@@ -64,6 +64,7 @@ namespace Ogre
     {
     public:
         typedef vector<uint16>::type BlockIdxVec;
+        typedef unordered_multimap<uint32, uint16>::type BlockHashMap;
     protected:
         Hlms    *mRegisteredHlms[HLMS_MAX];
         bool    mDeleteRegisteredOnExit[HLMS_MAX];
@@ -75,6 +76,10 @@ namespace Ogre
         BlockIdxVec         mActiveBlocks[NUM_BASIC_BLOCKS];
         BlockIdxVec         mFreeBlockIds[NUM_BASIC_BLOCKS];
         BasicBlock          *mBlocks[NUM_BASIC_BLOCKS][OGRE_HLMS_MAX_BASIC_BLOCKS];
+        /// Content hash -> index of the active blocks, so that getMacroblock & co.
+        /// don't have to compare against every active block.
+        BlockHashMap        mActiveBlocksByHash[NUM_BASIC_BLOCKS];
+        uint32              mBlockHashes[NUM_BASIC_BLOCKS][OGRE_HLMS_MAX_BASIC_BLOCKS];
 
         struct InputLayouts
         {
@@ -111,7 +116,7 @@ namespace Ogre
 #endif
 
         void renderSystemDestroyAllBlocks(void);
-        uint16 getFreeBasicBlock( uint8 type );
+        uint16 getFreeBasicBlock( uint8 type, uint32 contentHash );
         void destroyBasicBlock( BasicBlock *block );
 
     public:
@@ -31,6 +31,7 @@ THE SOFTWARE.
 #include "OgreTexture.h"
 #include "OgreIdString.h"
 #include "OgreStringVector.h"
+#include "OgreWorkQueue.h"
 #include "OgreHeaderPrefix.h"
 
 namespace Ogre
@@ -67,8 +68,11 @@ namespace Ogre
         in that order (depends on HW support).
         Detail maps default to not using UV atlas when texture arrays aren't
         supported (because detail maps are often meant to be tileable), etc
+    @par
+        Optionally textures can be streamed, see setStreamingEnabled.
     */
-    class _OgreExport HlmsTextureManager : public PassAlloc
+    class _OgreExport HlmsTextureManager : public PassAlloc, public WorkQueue::RequestHandler,
+                                           public WorkQueue::ResponseHandler
     {
     public:
         enum PackingMethod
@@ -216,15 +220,202 @@ namespace Ogre
         static void copy3DTexture( const Image &srcImage, TexturePtr dst,
                                    uint16 sliceStart, uint16 sliceEnd, uint8 srcBaseMip );
 
+        /// Picks the format the texture will have in GPU, based on the format of the source
+        /// and the default parameters of the map type.
+        PixelFormat selectPixelFormat( PixelFormat imageFormat, TextureMapType mapType,
+                                       const String &texName ) const;
+
         TextureArrayVec::iterator findSuitableArray( TextureMapType mapType, uint32 width, uint32 height,
                                                      uint32 depth, uint32 faces, PixelFormat format,
                                                      uint8 numMipmaps );
 
+        /// Returns an array with a free entry for a texture with the given parameters,
+        /// creating a new one if none of the existing arrays is suitable.
+        TextureArrayVec::iterator findOrCreateArray( TextureMapType mapType, TextureType texType,
+                                                     uint32 width, uint32 height, uint32 depth,
+                                                     uint32 faces, PixelFormat format,
+                                                     uint8 numMipmaps, ushort maxResolution );
+
         /// Looks for the first image it can successfully load from the pack, and extracts its parameters.
         /// Returns false if failed to retrieve parameters.
         bool getTexturePackParameters( const HlmsTexturePack &pack, uint32 &outWidth, uint32 &outHeight,
                                        uint32 &outDepth, PixelFormat &outPixelFormat ) const;
 
+        struct StreamedTexture
+        {
+            String          aliasName;
+            String          resourceName;
+            TextureMapType  mapType;
+            WorkQueue::RequestID requestId;
+
+            /// Tiny texture handed out while the image is being decoded. Each streamed
+            /// texture has its own so the datablocks using it can be told apart.
+            TexturePtr      placeholder;
+
+            /// Decoded source, with all of its mipmaps. Null while it's still being decoded.
+            Image           *image;
+            PixelFormat     pixelFormat;
+            /// First mip of the image that fits within the maximum resolution.
+            /// It's mip 0 of the array the texture lives in.
+            uint8           baseMip;
+            /// This mip and all the smaller ones are always resident.
+            uint8           lowestMip;
+            /// Most detailed mip the datablocks are allowed to sample.
+            uint8           residentMip;
+            /// Most detailed mip whose data is in the array. Evicted mips keep their
+            /// data, thus they can become resident again without uploading them.
+            uint8           uploadedMip;
+            /// Most detailed mip the budget allows us to have.
+            uint8           targetMip;
+
+            /// The location was handed out by createOrRetrieveTexture after the texture
+            /// was decoded; whoever got it doesn't know about residentMip yet.
+            bool            needsDatablockUpdate;
+
+            /// See setStreamingDemand
+            Real            demand;
+
+            StreamedTexture() :
+                mapType( NUM_TEXTURE_TYPES ), requestId( 0 ), image( 0 ), pixelFormat( PF_UNKNOWN ),
+                baseMip( 0 ), lowestMip( 0 ), residentMip( 0 ), uploadedMip( 0 ), targetMip( 0 ),
+                needsDatablockUpdate( false ),
+                demand( std::numeric_limits<Real>::max() ) {}
+
+            static bool OrderByHighestDemand( const StreamedTexture *_l, const StreamedTexture *_r )
+            {
+                return _l->demand > _r->demand;
+            }
+        };
+
+        typedef map<IdString, StreamedTexture>::type StreamedTextureMap;
+        typedef vector<StreamedTexture*>::type StreamedTextureVec;
+
+        /// Data sent to the WorkQueue
+        struct StreamingRequest
+        {
+            IdString    aliasName;
+            String      resourceName;
+            bool        mipmaps;
+            bool        hwGammaCorrection;
+            _OgreExport friend std::ostream& operator<<( std::ostream &o, const StreamingRequest &r )
+            { return o; }
+        };
+
+        /// Data returned by the WorkQueue. Ownership of image is transferred to the main thread.
+        struct StreamingResponse
+        {
+            IdString    aliasName;
+            Image       *image;
+            _OgreExport friend std::ostream& operator<<( std::ostream &o, const StreamingResponse &r )
+            { return o; }
+        };
+
+    public:
+        struct TextureLocation
+        {
+            TexturePtr  texture;
+            uint16      xIdx;
+            uint16      yIdx;
+            uint16      divisor;
+        };
+
+        /** Gets notified about streamed textures. All calls are made from the main thread.
+            See setStreamingEnabled.
+        */
+        class _OgreExport Listener
+        {
+        public:
+            virtual ~Listener() {}
+
+            /** Called when a streamed texture becomes available (with only its lowest mips
+                resident) and every time its residency changes afterwards.
+            @remarks
+                The datablocks using the texture have already been updated by then (see
+                HlmsDatablock::_replaceTexture); the location only changes once, when the
+                texture stops using its placeholder. Afterwards only residentMip changes.
+                Streamed textures must not be destroyed from within this call.
+            @param residentMip
+                Most detailed mip that is resident. 0 is the full resolution.
+            @param numMipmaps
+                Number of mipmaps of the source image (not counting the top level).
+            */
+            virtual void textureLocationChanged( IdString aliasName, const TextureLocation &location,
+                                                 uint8 residentMip, uint8 numMipmaps ) {}
+
+            /// Called when a streamed texture failed to load. Whoever was given the
+            /// placeholder when requesting it will keep using the placeholder.
+            virtual void textureStreamingFailed( IdString aliasName, const String &description ) {}
+        };
+
+        struct StreamingStats
+        {
+            size_t  numStreamedTextures;
+            /// Textures waiting to be decoded (or being decoded) by the WorkQueue.
+            size_t  numPendingDecodes;
+            /// Textures whose resident mip isn't the one the budget allows yet.
+            size_t  numPendingUploads;
+            /// Textures whose most detailed mip is resident.
+            size_t  numFullyResident;
+            /// Size of the resident mips of the streamed textures. The slots they take
+            /// in their arrays are always reserved at full size.
+            size_t  residentBytes;
+            size_t  bytesUploadedLastFrame;
+            /// Number of times a texture was downgraded to a less detailed mip since
+            /// streaming was enabled.
+            size_t  numEvictions;
+
+            StreamingStats() :
+                numStreamedTextures( 0 ), numPendingDecodes( 0 ), numPendingUploads( 0 ),
+                numFullyResident( 0 ), residentBytes( 0 ), bytesUploadedLastFrame( 0 ),
+                numEvictions( 0 ) {}
+        };
+
+    protected:
+        bool                mStreamingEnabled;
+        bool                mStreamingHandlersRegistered;
+        uint16              mWorkQueueChannel;
+        size_t              mStreamingBudget;
+        size_t              mUploadBytesPerFrame;
+        uint32              mMinResidentResolution;
+        Listener            *mListener;
+
+        StreamedTextureMap  mStreamedTextures;
+        /// Sorted by demand, from highest to lowest. Rebuilt every frame.
+        StreamedTextureVec  mStreamedByDemand;
+
+        size_t              mBytesUploadedThisFrame;
+        size_t              mBytesUploadedLastFrame;
+        size_t              mNumEvictions;
+
+        /// Uploads a single mip into a slice of an array. Returns the number of bytes uploaded.
+        static size_t copyMipToTexture( const Image &srcImage, uint8 srcMip, TexturePtr dst,
+                                        uint8 dstMip, uint16 dstSlice, bool isNormalMap );
+        /// Size in GPU of the mip chain starting at firstMip.
+        static size_t getMipChainSize( const Image &image, PixelFormat format, uint8 firstMip );
+        static void removeTexture( TexturePtr &texture );
+
+        TexturePtr createBlankTexture( const String &name, TextureType textureType ) const;
+
+        TextureLocation getTextureLocation( const TextureEntry &entry ) const;
+
+        const StreamedTexture& queueStreamedTexture( const String &aliasName, const String &texName,
+                                                     TextureMapType mapType );
+        void streamedTextureDecoded( StreamedTextureMap::iterator itor, Image *image );
+        TextureLocation getStreamedLocation( const StreamedTexture &streamed ) const;
+
+        /// Points the datablocks using oldLocation to newLocation, restricting them
+        /// to sample from minLod onwards. See HlmsDatablock::_replaceTexture.
+        void updateDatablocks( const TextureLocation &oldLocation,
+                               const TextureLocation &newLocation, float minLod );
+        /// Updates the datablocks using the texture with its residency, and tells the listener.
+        void notifyResidencyChanged( StreamedTexture &streamed );
+
+        /// Distributes the budget between the streamed textures based on their demand.
+        void updateStreamingTargets(void);
+        /// Evicts the mips beyond the targets, and uploads as many pending
+        /// mips as mUploadBytesPerFrame allows.
+        void uploadPendingMips(void);
+
     public:
         HlmsTextureManager();
         virtual ~HlmsTextureManager();
@@ -237,14 +428,6 @@ namespace Ogre
         */
         void _changeRenderSystem( RenderSystem *newRs );
 
-        struct TextureLocation
-        {
-            TexturePtr  texture;
-            uint16      xIdx;
-            uint16      yIdx;
-            uint16      divisor;
-        };
-
         /** Create a texture based on its name. If a texture with such name has already been
             created, retrieves the existing one.
         @param texName
@@ -281,6 +464,80 @@ namespace Ogre
                                                  TextureMapType mapType,
                                                  Image *imgSource = 0 );
 
+        /** Enables streaming. While enabled, textures created by createOrRetrieveTexture
+            from a file (i.e. imgSource is null) are decoded in the WorkQueue's background
+            threads, and createOrRetrieveTexture returns a placeholder right away (a blank
+            texture unique to each streamed texture).
+        @par
+            Once decoded, the texture gets a slot in a texture array, like any other
+            texture, but only its lowest mips get uploaded (see
+            setStreamingMinResidentResolution). The datablocks using the placeholder
+            are moved to the slot. The rest of the mips get uploaded one at a time over
+            the following frames (see setStreamingUploadBytesPerFrame), and mips that
+            don't fit in the budget are evicted, starting with the textures with the
+            lowest demand (see setStreamingBudget and setStreamingDemand).
+        @remarks
+            Mips of a slice can't be freed without affecting the rest of the array,
+            thus slots are reserved at full size and the mips that aren't resident are
+            hidden from the datablocks by raising the min LOD of their samplerblocks.
+            The budget bounds how much detail is resident and how much gets uploaded,
+            not the memory reserved. Datablocks get updated through
+            HlmsDatablock::_replaceTexture, which raises the min LOD of the
+            samplerblocks of the affected textures.
+        @par
+            Only textures using TextureArrays are streamed. Cubemaps and 3D textures
+            are decoded in the background but then loaded the regular way.
+        @par
+            Disabling streaming doesn't affect the textures already being streamed.
+        */
+        void setStreamingEnabled( bool bEnabled );
+        bool getStreamingEnabled(void) const                    { return mStreamingEnabled; }
+
+        /// Bytes of mips that streamed textures may have resident above their lowest mips.
+        /// The lowest mips are always resident, regardless of the budget.
+        void setStreamingBudget( size_t bytes )                 { mStreamingBudget = bytes; }
+        size_t getStreamingBudget(void) const                   { return mStreamingBudget; }
+
+        /// Number of bytes to upload per frame. Mips keep being uploaded while this value
+        /// hasn't been reached, thus it may be exceeded by up to one mip.
+        void setStreamingUploadBytesPerFrame( size_t bytes )    { mUploadBytesPerFrame = bytes; }
+        size_t getStreamingUploadBytesPerFrame(void) const      { return mUploadBytesPerFrame; }
+
+        /// Mips whose width and height are less or equal than this value are uploaded
+        /// as soon as the texture is decoded, and are never evicted.
+        /// Only affects the textures that finish decoding after this call.
+        void setStreamingMinResidentResolution( uint32 resolution ) { mMinResidentResolution = resolution; }
+        uint32 getStreamingMinResidentResolution(void) const    { return mMinResidentResolution; }
+
+        void setStreamingListener( Listener *listener )         { mListener = listener; }
+        Listener* getStreamingListener(void) const              { return mListener; }
+
+        /** Tells how big, in pixels, a streamed texture is going to be seen on screen.
+            The most detailed mip that will be requested is the smallest one that is
+            still equal or bigger than this size; when there isn't enough budget,
+            textures with the highest demand are served first.
+        @remarks
+            By default the demand is infinite, i.e. the full resolution is requested.
+            A demand of 0 means the texture isn't visible and only needs its lowest mips.
+            Does nothing if the texture isn't being streamed.
+        @param screenSize
+            Typically the projected size of the objects using this texture, multiplied
+            by how many times the texture repeats over them.
+        */
+        void setStreamingDemand( IdString aliasName, Real screenSize );
+
+        StreamingStats getStreamingStats(void) const;
+
+        /// Updates the residency of streamed textures and uploads pending mips.
+        /// Called by Root once per frame.
+        void _update(void);
+
+        /// @copydoc WorkQueue::RequestHandler::handleRequest
+        virtual WorkQueue::Response* handleRequest( const WorkQueue::Request *req,
+                                                    const WorkQueue *srcQ );
+        /// @copydoc WorkQueue::ResponseHandler::handleResponse
+        virtual void handleResponse( const WorkQueue::Response *res, const WorkQueue *srcQ );
+
         /// Destroys a texture. If the array has multiple entries, the entry for this texture is
         /// sent back to a waiting list for a future new entry. Trying to read from this texture
         /// after this call may result in garbage.
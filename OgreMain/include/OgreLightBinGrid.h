@@ -0,0 +1,248 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2017 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef _OgreLightBinGrid_H_
+#define _OgreLightBinGrid_H_
+
+#include "OgrePrerequisites.h"
+#include "OgreMovableObject.h"
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Scene
+    *  @{
+    */
+
+    /** Uniform world-space grid that bins the lights, so that building the per-object
+        light lists and culling the lights against a camera don't have to test every
+        light against every object / camera.
+    @remarks
+        Enable it via SceneManager::setLightBinning. It's rebuilt every frame from
+        SceneManager::buildLightList and holds two sets of bins:
+            1. Indices to SceneManager's global light list (lights visible by any
+               camera), binned by their bounding sphere. Queried by
+               MovableObject::buildLightListBinned for each object.
+            2. Packs (groups of ARRAY_PACKED_REALS lights) of the light memory manager,
+               binned by their world AABB. Queried by SceneManager::cullLights, which
+               then runs the usual SIMD test (MovableObject::cullFrustumPacks) only on
+               the packs whose cells intersect the camera.
+    @par
+        Directional lights and lights with infinite bounds aren't binned; they're
+        considered by every query.
+    @par
+        The contents of each cell are hashed and compared against the previous frame.
+        An object keeps the light list it had if its bounds and light mask didn't change
+        and all the cells it touches are clean. See getStats.
+    @par
+        The grid fits the bounds of all the lights, snapped to the cell size so that it
+        stays put while lights move inside it. When there would be more than
+        maxCellsPerAxis cells along an axis, the cells get bigger along that axis.
+    */
+    class _OgreExport LightBinGrid : public SceneMgtAlloc
+    {
+    public:
+        struct Stats
+        {
+            /// Objects that kept their light list from the previous frame.
+            size_t  numReusedLists;
+            /// Objects whose light list had to be built again.
+            size_t  numRebuiltLists;
+            /// Cells whose contents changed since the last frame.
+            size_t  numDirtyCells;
+            /// Cells with at least one light in them.
+            size_t  numUsedCells;
+
+            Stats() : numReusedLists( 0 ), numRebuiltLists( 0 ),
+                      numDirtyCells( 0 ), numUsedCells( 0 ) {}
+        };
+
+    protected:
+        /// Light packs of one render queue (i.e. light type), in CSR layout.
+        struct PackBins
+        {
+            /// Number of objects in this render queue when the bins were built.
+            size_t                  numObjects;
+            /// Range of cell i is [cellStart[i]; cellStart[i+1])
+            vector<uint32>::type    cellStart;
+            vector<uint32>::type    packs;
+            /// Packs containing lights with infinite bounds.
+            vector<uint32>::type    unboundedPacks;
+            /// Output of _prepareCullLights.
+            vector<uint32>::type    visiblePacks;
+            /// Last cull stamp in which the pack was added to visiblePacks.
+            vector<uint32>::type    packStamp;
+        };
+        typedef vector<PackBins>::type PackBinsVec;
+
+        /// Per thread. Padded to avoid false sharing.
+        struct ThreadScratch
+        {
+            /// Last stamp in which each global light was added to candidates.
+            vector<uint32>::type    lightStamp;
+            uint32                  stamp;
+            vector<uint32>::type    candidates;
+            size_t                  numReusedLists;
+            size_t                  numRebuiltLists;
+            uint8                   padding[64];
+
+            ThreadScratch() : stamp( 0 ), numReusedLists( 0 ), numRebuiltLists( 0 ) {}
+        };
+        typedef vector<ThreadScratch>::type ThreadScratchVec;
+
+        Real                mCellSize;
+        uint32              mMaxCellsPerAxis;
+        size_t              mNumThreads;
+
+        Vector3             mOrigin;
+        Vector3             mCellDimensions;
+        uint32              mNumCells[3];
+        /// Unique ID of the last _update. MovableObject stores it along with its
+        /// light list; only lists that were valid last frame can be reused.
+        uint32              mFrameId;
+        uint32              mPrevFrameId;
+
+        /// Global light indices in each cell, in CSR layout.
+        vector<uint32>::type    mLightCellStart;
+        vector<uint32>::type    mLightCellEntries;
+        /// Directional lights & lights with infinite bounds
+        vector<uint32>::type    mUnboundedLights;
+
+        vector<uint32>::type    mCellHash;
+        vector<uint8>::type     mCellDirty;
+        uint32                  mUnboundedHash;
+        bool                    mUnboundedDirty;
+        /// False when the previous hashes don't belong to the current layout
+        /// (i.e. the grid moved or got resized).
+        bool                    mHashesValid;
+        /// Hash of each global light. Temporary.
+        vector<uint32>::type    mLightHash;
+
+        PackBinsVec             mPackBins;
+        /// Cells with at least one pack, of any render queue.
+        vector<uint32>::type    mPackCells;
+        /// Temporary, to avoid adding the same pack twice to a cell.
+        vector<uint32>::type    mCellLastPack;
+        Camera const            *mPreparedCamera;
+        size_t                  mPreparedFirstRq;
+        size_t                  mPreparedLastRq;
+        uint32                  mCullStamp;
+
+        ThreadScratchVec        mThreadScratch;
+        Stats                   mStats;
+
+        /// Returns true if the grid had to be moved or resized.
+        bool updateLayout( const Vector3 &vMin, const Vector3 &vMax );
+
+        /** Converts a world-space box into the range of cells it overlaps (inclusive).
+            Returns false if the box doesn't touch the grid at all.
+        */
+        bool getCellRange( const Vector3 &vMin, const Vector3 &vMax,
+                           uint32 outMin[3], uint32 outMax[3] ) const;
+
+        inline uint32 getCellIdx( uint32 x, uint32 y, uint32 z ) const
+        {
+            return (z * mNumCells[1] + y) * mNumCells[0] + x;
+        }
+
+        void binGlobalLights( const LightListInfo &globalLightList );
+        void binLightPacks( ObjectMemoryManager *lightMemoryManager );
+
+    public:
+        /**
+        @param cellSize
+            Size of the cells, in world units. Ideally close to the radius of the lights.
+        @param maxCellsPerAxis
+            Caps the memory used by the grid when the lights are spread over a large area.
+        @param numThreads
+            Number of worker threads of the SceneManager.
+        */
+        LightBinGrid( Real cellSize, uint32 maxCellsPerAxis, size_t numThreads );
+        virtual ~LightBinGrid();
+
+        /// Rebuilds the bins. Called by SceneManager::buildLightList once the global light
+        /// list is ready.
+        void _update( const LightListInfo &globalLightList, ObjectMemoryManager *lightMemoryManager );
+
+        /// Returns true if a light list built at the given frame for the given bounds is still
+        /// valid (none of the lights that could affect it changed since).
+        bool isClean( uint32 builtFrameId, const Vector3 &vMin, const Vector3 &vMax ) const;
+
+        /** Returns the indices to the global light list of all the lights whose cells
+            overlap the given box, sorted and without duplicates. Called from worker threads.
+        @remarks
+            The returned array belongs to the thread and is overwritten by the next call.
+        */
+        const vector<uint32>::type& gatherLights( const Vector3 &vMin, const Vector3 &vMax,
+                                                  size_t threadIdx );
+
+        /// Called from worker threads by MovableObject::buildLightListBinned.
+        void _notifyLightListBuilt( size_t threadIdx, bool reused );
+        /// Adds up the counters of all threads. Called once the light lists are built.
+        void _mergeStats(void);
+
+        /** Collects the light packs whose cells intersect the camera, for the render queues
+            in range [firstRq; lastRq). Called by SceneManager::cullLights.
+        */
+        void _prepareCullLights( const Camera *camera, ObjectMemoryManager *lightMemoryManager,
+                                 size_t firstRq, size_t lastRq );
+        /// Called once SceneManager::cullLights is done.
+        void _finishCullLights(void)                        { mPreparedCamera = 0; }
+
+        /// Returns true if _prepareCullLights was called for the given camera & render queue,
+        /// and the bins are still valid for it (no lights were created since _update).
+        bool hasVisiblePacks( const Camera *camera, size_t renderQueue,
+                              ObjectMemoryManager *lightMemoryManager ) const;
+
+        /** Same as MovableObject::cullFrustum, but only tests the packs collected by
+            _prepareCullLights. Called from worker threads; each thread takes its
+            share of the packs.
+        */
+        void cullLights( size_t renderQueue, const Camera *camera, uint32 sceneVisibilityFlags,
+                         ObjectMemoryManager *lightMemoryManager,
+                         MovableObject::MovableObjectArray &outCulledObjects,
+                         const Camera *lodCamera, size_t threadIdx ) const;
+
+        uint32 getFrameId(void) const                       { return mFrameId; }
+        Real getCellSize(void) const                        { return mCellSize; }
+        uint32 getMaxCellsPerAxis(void) const               { return mMaxCellsPerAxis; }
+        size_t getNumCells(void) const;
+
+        /// Stats of the last call to SceneManager::buildLightList.
+        const Stats& getStats(void) const                   { return mStats; }
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
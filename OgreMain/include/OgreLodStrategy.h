@@ -72,11 +72,43 @@ namespace Ogre {
         /** Transform LOD bias so it only needs to be multiplied by the LOD value. */
         virtual Real transformBias(Real factor) const = 0;
 
+        /// Number of LOD switches counted by lodSet. @See SceneManager::getLodStats
+        struct LodTransitions
+        {
+            /// Objects whose mesh LOD changed
+            size_t  mesh;
+            /// Renderables whose material LOD changed
+            size_t  material;
+
+            LodTransitions() : mesh( 0 ), material( 0 ) {}
+        };
+
+        /** Computes the LOD values of a pack of objects relative to the camera and
+            sets their mesh & material LOD through lodSet.
+        @param hysteresis
+            @See SceneManager::setLodHysteresis
+        @param outTransitions [out]
+            Incremented with the number of LOD changes.
+        */
         virtual void lodUpdateImpl( const size_t numNodes, ObjectData t,
-                                    const Camera *camera, Real bias ) const = 0;
+                                    const Camera *camera, Real bias, Real hysteresis,
+                                    LodTransitions &outTransitions ) const = 0;
 
         //Include OgreLodStrategyPrivate.inl in the CPP files that use this function.
-        inline static void lodSet( ObjectData &t, Real lodValues[ARRAY_PACKED_REALS] );
+        inline static void lodSet( ObjectData &t, Real lodValues[ARRAY_PACKED_REALS],
+                                   Real hysteresis, LodTransitions &outTransitions );
+
+        /** Returns the LOD index for the given value, starting from the current one.
+        @remarks
+            Objects that remain within the range of their current LOD don't search.
+            When hysteresis > 0, the value must be past the threshold by
+            hysteresis * abs( threshold ) before switching; so that objects moving
+            back and forth around a threshold don't switch every frame.
+        @param lodValues
+            Sorted list of LOD values (i.e. MovableObject::mLodMesh).
+        */
+        inline static uint8 getLodIndex( const FastArray<Real> &lodValues, Real lodValue,
+                                         uint8 currentLod, Real hysteresis );
 
         /** Transform user supplied value to internal value.
         @remarks
@@ -111,6 +143,44 @@ namespace Ogre {
     /** @} */
     /** @} */
 
+    inline uint8 LodStrategy::getLodIndex( const FastArray<Real> &lodValues, Real lodValue,
+                                           uint8 currentLod, Real hysteresis )
+    {
+        const size_t numLods = lodValues.size();
+        if( numLods <= 1u )
+            return 0;
+
+        //LOD 'n' covers ( lodValues[n]; lodValues[n+1] ], LOD 0 also covers everything below.
+        if( currentLod < numLods &&
+            (currentLod == 0 || lodValues[currentLod] < lodValue) &&
+            (currentLod + 1u == numLods || lodValue <= lodValues[currentLod + 1u]) )
+        {
+            return currentLod;
+        }
+
+        FastArray<Real>::const_iterator it = std::lower_bound( lodValues.begin(), lodValues.end(),
+                                                               lodValue );
+        size_t newLod = static_cast<size_t>( std::max<int>( it - lodValues.begin() - 1, 0 ) );
+
+        if( hysteresis > 0 && currentLod < numLods )
+        {
+            //Only move past the thresholds we've gone beyond by more than the band.
+            while( newLod > currentLod &&
+                   lodValue <= lodValues[newLod] + hysteresis * Math::Abs( lodValues[newLod] ) )
+            {
+                --newLod;
+            }
+            while( newLod < currentLod &&
+                   lodValue > lodValues[newLod + 1u] -
+                              hysteresis * Math::Abs( lodValues[newLod + 1u] ) )
+            {
+                ++newLod;
+            }
+        }
+
+        return static_cast<uint8>( newLod );
+    }
+
 } // namespace
 
 #include "OgreHeaderSuffix.h"
@@ -28,19 +28,28 @@ THE SOFTWARE.
 
 namespace Ogre
 {
-    inline void LodStrategy::lodSet( ObjectData &objData, Real lodValues[ARRAY_PACKED_REALS] )
+    inline void LodStrategy::lodSet( ObjectData &objData, Real lodValues[ARRAY_PACKED_REALS],
+                                     Real hysteresis, LodTransitions &outTransitions )
     {
         for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
         {
             MovableObject *owner = objData.mOwner[j];
 
+            //Objects seen for the first time go straight to their LOD.
+            const Real objHysteresis = owner->mCurrentLodValue ==
+                                                -std::numeric_limits<Real>::max() ? 0 : hysteresis;
+            owner->mCurrentLodValue = lodValues[j];
+
             //This may look like a lot of ugly indirections, but mLodMerged is a pointer that allows
             //sharing with many MovableObjects (it should perfectly fit even in small caches).
             {
-                FastArray<Real>::const_iterator it = std::lower_bound( owner->mLodMesh->begin(),
-                                                                        owner->mLodMesh->end(),
-                                                                        lodValues[j] );
-                owner->mCurrentMeshLod = std::max<int>( it - owner->mLodMesh->begin() - 1, 0 );
+                const uint8 meshLod = getLodIndex( *owner->mLodMesh, lodValues[j],
+                                                   owner->mCurrentMeshLod, objHysteresis );
+                if( meshLod != owner->mCurrentMeshLod )
+                {
+                    owner->mCurrentMeshLod = meshLod;
+                    ++outTransitions.mesh;
+                }
             }
 
             RenderableArray::iterator itor = owner->mRenderables.begin();
@@ -48,10 +57,15 @@ namespace Ogre
 
             while( itor != end )
             {
-                const FastArray<Real> *lodVec = (*itor)->mLodMaterial;
-                FastArray<Real>::const_iterator it = std::lower_bound( lodVec->begin(), lodVec->end(),
-                                                                       lodValues[j] );
-                (*itor)->mCurrentMaterialLod = (uint8)std::max<int>( it - lodVec->begin() - 1, 0 );
+                Renderable *renderable = *itor;
+                const uint8 materialLod = getLodIndex( *renderable->mLodMaterial, lodValues[j],
+                                                       renderable->mCurrentMaterialLod,
+                                                       objHysteresis );
+                if( materialLod != renderable->mCurrentMaterialLod )
+                {
+                    renderable->mCurrentMaterialLod = materialLod;
+                    ++outTransitions.material;
+                }
                 ++itor;
             }
         }
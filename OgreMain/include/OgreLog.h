@@ -32,6 +32,8 @@ THE SOFTWARE.
 #include "OgrePrerequisites.h"
 #include "OgreCommon.h"
 #include "Threading/OgreThreadHeaders.h"
+#include "Threading/OgreLightweightMutex.h"
+#include "Threading/OgreThreads.h"
 #include "OgreHeaderPrefix.h"
 
 #if OGRE_PLATFORM == OGRE_PLATFORM_NACL
@@ -112,6 +114,48 @@ namespace Ogre {
 
         typedef vector<LogListener*>::type mtLogListener;
         mtLogListener mListeners;
+
+        /// A slot of the asynchronous queue. See setAsyncEnabled.
+        struct AsyncCell
+        {
+            /// Position in the ring this slot is ready for (Vyukov's bounded MPMC scheme).
+            volatile uint32 sequence;
+            LogMessageLevel lml;
+            bool            maskDebug;
+            time_t          timeStamp;
+            String          message;
+
+            AsyncCell() : sequence( 0 ), lml( LML_NORMAL ), maskDebug( false ), timeStamp( 0 ) {}
+        };
+
+        /// Ring of mAsyncCapacityMask + 1 slots. Null when async logging is disabled.
+        AsyncCell           *mAsyncCells;
+        uint32              mAsyncCapacityMask;
+        /// Next position to be claimed by a producer. Modified atomically.
+        volatile uint32     mAsyncEnqueuePos;
+        /// Next position to be written out. Protected by mAsyncWriterMutex.
+        uint32              mAsyncDequeuePos;
+        /// Messages discarded because the ring was full. Modified atomically.
+        volatile uint32     mAsyncNumDropped;
+        /// Value of mAsyncNumDropped the last time the writer reported it.
+        uint32              mAsyncNumDroppedReported;
+        volatile uint32     mAsyncStopWriter;
+        /// Held while draining the ring, so only one thread writes to the file at a time.
+        LightweightMutex    mAsyncWriterMutex;
+        ThreadHandlePtr     mAsyncWriterThread;
+
+        /// Notifies listeners and writes the message to the debugger & the file.
+        /// When flushEachLine is false the caller is expected to flush the streams.
+        void writeMessage( const String &message, LogMessageLevel lml, bool maskDebug,
+                           time_t timeStamp, bool flushEachLine );
+
+        /// Lock-free. Claims a slot in the ring, or bumps the drop counter if it's full.
+        void enqueueAsyncMessage( const String &message, LogMessageLevel lml, bool maskDebug );
+
+        /// Writes out every message that is ready, then flushes the file once.
+        /// mAsyncWriterMutex must be held. Returns the number of messages written.
+        size_t drainAsyncQueue(void);
+
     public:
 
         class Stream;
@@ -180,6 +224,47 @@ namespace Ogre {
         */
         void removeListener(LogListener* listener);
 
+        /** Switches this log to asynchronous mode, where logMessage only copies the
+            message into a lock-free queue and a background thread formats it and
+            writes it out, flushing the file once per batch instead of once per line.
+        @remarks
+            The queue is bounded: when it is full the message is discarded and
+            counted (see getNumDroppedMessages); the writer reports the count in
+            the log. LML_CRITICAL messages also try to flush the queue before
+            logMessage returns, so that whatever precedes an exception makes it
+            to disk.
+        @par
+            In asynchronous mode LogListeners are called from the writer thread
+            (or from whichever thread calls flush), not from the thread that
+            logged the message. They must not call flush themselves.
+        @par
+            This function is not thread safe: no other thread may be logging to
+            this Log while it's being called. Disabling it stops the writer thread
+            and writes out whatever was still queued.
+        @param asyncEnabled
+            True to enable the background writer, false to go back to writing
+            synchronously.
+        @param queueCapacity
+            Maximum number of messages waiting to be written. Rounded up to a
+            power of 2. Ignored when disabling.
+        */
+        void setAsyncEnabled( bool asyncEnabled, size_t queueCapacity = 4096u );
+
+        /// Returns true if setAsyncEnabled( true ) is in effect.
+        bool isAsyncEnabled(void) const                 { return mAsyncCells != 0; }
+
+        /** Writes out all queued messages from the calling thread and flushes the
+            file, blocking until done. Meant for crash handlers & shutdown paths.
+            Does nothing beyond flushing the file when async logging is disabled.
+        */
+        void flush(void);
+
+        /// Returns how many messages have been discarded because the async queue was full.
+        uint32 getNumDroppedMessages(void) const;
+
+        /// Body of the background writer thread. Do not call directly.
+        unsigned long _asyncWriterThread(void);
+
         /** Stream object which targets a log.
         @remarks
             A stream logger object makes it simpler to send various things to 
@@ -132,6 +132,12 @@ namespace Ogre
         /** Sets the level of detail of the default log.
         */
         void setLogDetail(LoggingLevel ll);
+
+        /** Writes out every queued message of every log. Call it from crash handlers
+            when logs may be in asynchronous mode.
+        @See Log::flush
+        */
+        void flush(void);
         /** Override standard Singleton retrieval.
         @remarks
         Why do we do this? Well, it's because the Singleton
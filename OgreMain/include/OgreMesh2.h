@@ -50,6 +50,7 @@ namespace Ogre {
     */
 
     class LodStrategy;
+    struct PreparedMeshData;
 
     /** Resource holding data about 3D mesh.
     @remarks
@@ -101,7 +102,8 @@ namespace Ogre {
         */
         SubMeshVec mSubMeshes;
 
-        DataStreamPtr mFreshFromDisk;
+        /// Parsed by prepareImpl, waiting for loadImpl to create the GPU buffers.
+        PreparedMeshData *mPreparedData;
 
         /// Local bounding box volume.
         Aabb    mAabb;
@@ -129,10 +131,13 @@ namespace Ogre {
         typedef unordered_map<String, ushort>::type SubMeshNameMap;
         SubMeshNameMap mSubMeshNameMap;
 
-        /** Loads the mesh from disk.  This call only performs IO, it
-            does not parse the bytestream or check for any errors therein.
-            It also does not set up submeshes, etc.  You have to call load()
-            to do that.
+        /** Loads the mesh from disk and parses it, setting up the submeshes, LODs,
+            bounds, etc. The vertex & index data is kept in system memory (optionally
+            rearranged, @see MeshManager::setArrangeEfficientOnPrepare) until load()
+            creates the GPU buffers.
+        @remarks
+            Doesn't touch the VaoManager, thus it can run in a background thread.
+            @See MeshManager::loadAsync
          */
         void prepareImpl(void);
         /** Destroys data cached by prepareImpl.
@@ -399,6 +404,12 @@ namespace Ogre {
 
         const LodValueArray* _getLodValueArray(void) const                      { return &mLodValues; }
 
+        /** Sets the LOD values of manually created meshes. One per LOD in SubMesh::mVao,
+            sorted ascending and already transformed by the LOD strategy
+            (@see LodStrategy::transformUserValue). The first one is the base value.
+        */
+        void _setLodValues( const LodValueArray &lodValues )                    { mLodValues = lodValues; }
+
         /** Imports a v1 mesh to this mesh, with optional optimization conversions.
             This mesh must be in unloaded state.
         @remarks
@@ -428,13 +439,20 @@ namespace Ogre {
             vertex shader for decoding the QTangent.
             Highly recommended on both desktop and mobile if you need tangents (i.e.
             normal mapping).
+        @param sceneManager
+            Optional. When present, the vertex conversion of each SubMesh (and of its
+            shadow mapping buffers) is spread across the worker threads of this
+            SceneManager. Buffers are still locked and created on the calling thread.
+            @See SceneManager::executeUserScalableTask for when it can be used.
         */
-        void importV1( v1::Mesh *mesh, bool halfPos, bool halfTexCoords, bool qTangents );
+        void importV1( v1::Mesh *mesh, bool halfPos, bool halfTexCoords, bool qTangents,
+                       SceneManager *sceneManager = 0 );
 
         /// Converts this SubMesh to an efficient arrangement. @See Mesh::importV1 for an
         /// explanation on the parameters. @see dearrangeEfficientToInefficient
         /// to perform the opposite operation.
-        void arrangeEfficient( bool halfPos, bool halfTexCoords, bool qTangents );
+        void arrangeEfficient( bool halfPos, bool halfTexCoords, bool qTangents,
+                               SceneManager *sceneManager = 0 );
 
         /// Reverts the effects from arrangeEfficient by converting all 16-bit half float back
         /// to 32-bit float; and QTangents to Normal, Tangent + Reflection representation,
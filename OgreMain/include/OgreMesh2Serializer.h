@@ -58,9 +58,14 @@ namespace Ogre {
     /// See http://www.ogre3d.org/forums/viewtopic.php?f=25&t=85491&p=524682#p524682
     enum MeshVersion 
     {
-        /// Latest version available
+        /// Latest version available. When exporting, it means MESH_VERSION_2_1_R3
+        /// if MeshSerializer::setCompressBuffers is on, MESH_VERSION_2_1 otherwise.
         MESH_VERSION_LATEST,
         
+        /// Same as MESH_VERSION_2_1, but vertex & index buffers may be compressed.
+        /// @See MeshSerializer::setCompressBuffers
+        MESH_VERSION_2_1_R3,
+
         /// OGRE version v2.0+
         MESH_VERSION_2_1,
         MESH_VERSION_LEGACY //R0 & R1 (beta)
@@ -163,6 +168,35 @@ namespace Ogre {
         */
         void importMesh(DataStreamPtr& stream, Mesh* pDest);
 
+        /** First half of importMesh. Parses the .mesh, but leaves the vertex & index data
+            in outData instead of creating the GPU buffers.
+        @remarks
+            Doesn't touch the VaoManager nor other resources, thus it can be called from
+            a worker thread as long as nobody else is using pDest nor this serializer.
+            The MeshSerializerListener, if any, gets called from this thread too.
+        @param outData [out]
+            Must be passed to finaliseMesh afterwards. Frees its contents on destruction.
+        */
+        void prepareMesh( DataStreamPtr &stream, Mesh *pDest, PreparedMeshData *outData );
+
+        /** Second half of importMesh. Creates the Vaos out of the data parsed by
+            prepareMesh and links the skeleton. Must be called from the main thread.
+        */
+        void finaliseMesh( Mesh *pDest, PreparedMeshData *data );
+
+        /** Whether exportMesh should compress the vertex & index buffers.
+        @remarks
+            Uses MeshBufferCodec. The buffers are losslessly delta encoded & bit packed,
+            which is usually 1.5x - 3x smaller for vertices and ~2.5x for indices, while
+            decoding at several GB/s. Buffers that wouldn't get smaller are written raw.
+        @par
+            Only formats MESH_VERSION_2_1_R3 and newer support it; the setting is ignored
+            when exporting to older versions. Exporting with MESH_VERSION_LATEST writes R3
+            when this is on and R2 otherwise. Default is false.
+        */
+        void setCompressBuffers( bool compressBuffers );
+        bool getCompressBuffers(void) const         { return mCompressBuffers; }
+
         /// Sets the listener for this serializer
         void setListener(MeshSerializerListener *listener);
         /// Returns the current listener
@@ -188,6 +222,7 @@ namespace Ogre {
         MeshVersionDataList mVersionData;
 
         MeshSerializerListener *mListener;
+        bool                    mCompressBuffers;
 
     };
 
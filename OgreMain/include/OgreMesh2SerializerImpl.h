@@ -47,6 +47,59 @@ namespace Ogre {
     /** \addtogroup Resources
     *  @{
     */
+    /** Contents of a .mesh parsed by MeshSerializer::prepareMesh that still need the
+        render thread: the vertex & index data waiting for their GPU buffers, and the
+        skeleton to link. @See MeshSerializer::finaliseMesh
+    @remarks
+        Whatever finaliseMesh didn't consume is freed on destruction.
+    */
+    struct _OgreExport PreparedMeshData : public SerializerAlloc
+    {
+        typedef vector<uint8*>::type Uint8Vec;
+
+        struct SubMeshLod
+        {
+            uint32                  numVertices;
+            VertexElement2VecVec    vertexDeclarations;
+            Uint8Vec                vertexBuffers;
+            uint8                   lodSource;
+            bool                    index32Bit;
+            uint32                  numIndices;
+            void                    *indexData;
+            OperationType operationType;
+
+            SubMeshLod();
+        };
+
+        typedef vector<SubMeshLod>::type SubMeshLodVec;
+
+        struct PreparedSubMesh
+        {
+            SubMesh         *subMesh;
+            uint8           numVaoPasses;
+            /// Populate mBoneAssignments from the blend indices once the Vaos exist.
+            bool            buildBoneAssignments;
+            SubMeshLodVec   lods[NumVertexPass];
+        };
+
+        typedef vector<PreparedSubMesh>::type PreparedSubMeshVec;
+
+        PreparedSubMeshVec  subMeshes;
+        bool                hasSkeletonLink;
+        String              skeletonName;
+
+        PreparedMeshData();
+        ~PreparedMeshData();
+
+        /** Converts the vertex data to the efficient layout, like Mesh::arrangeEfficient
+            does with the GPU buffers. See Mesh::importV1 for the parameters.
+        */
+        void arrangeEfficient( bool halfPos, bool halfTexCoords, bool qTangents );
+
+        /// Frees the data of the given LODs and clears them.
+        static void freeLods( SubMeshLodVec &lods );
+    };
+
     /** Internal implementation of Mesh reading / writing for the latest version of the
     .mesh format.
     @remarks
@@ -70,9 +123,12 @@ namespace Ogre {
         @param pMesh Pointer to the Mesh to export
         @param stream The destination stream
         @param endianMode The endian mode for the written file
+        @param compressBuffers
+            Write the vertex & index buffers with MeshBufferCodec. Ignored if the
+            version doesn't support it. @See MeshSerializer::setCompressBuffers
         */
         void exportMesh(const Mesh* pMesh, DataStreamPtr stream,
-            Endian endianMode = ENDIAN_NATIVE);
+            Endian endianMode = ENDIAN_NATIVE, bool compressBuffers = false);
 
         /** Imports Mesh and (optionally) Material data from a .mesh file DataStream.
         @remarks
@@ -83,26 +139,38 @@ namespace Ogre {
         */
         void importMesh(DataStreamPtr& stream, Mesh* pDest, MeshSerializerListener *listener);
 
+        /// Same as importMesh, but leaves in outData what needs the render thread.
+        /// @See MeshSerializer::prepareMesh
+        void prepareMesh( DataStreamPtr &stream, Mesh *pDest, MeshSerializerListener *listener,
+                          PreparedMeshData *outData );
+
+        /// Creates the GPU buffers from data parsed by prepareMesh.
+        /// @See MeshSerializer::finaliseMesh
+        void finaliseMesh( Mesh *pDest, PreparedMeshData *data );
+
     protected:
         typedef vector<uint8>::type LodLevelVertexBufferTable;
         typedef vector<LodLevelVertexBufferTable>::type LodLevelVertexBufferTableVec; //One per submesh
-        typedef vector<uint8*>::type Uint8Vec;
+        typedef PreparedMeshData::Uint8Vec Uint8Vec;
+        typedef PreparedMeshData::SubMeshLod SubMeshLod;
+        typedef PreparedMeshData::SubMeshLodVec SubMeshLodVec;
 
-        struct SubMeshLod
-        {
-            uint32                  numVertices;
-            VertexElement2VecVec    vertexDeclarations;
-            Uint8Vec                vertexBuffers;
-            uint8                   lodSource;
-            bool                    index32Bit;
-            uint32                  numIndices;
-            void                    *indexData;
-            OperationType operationType;
+        typedef vector<uint8>::type EncodedBuffer;
+        typedef map<const BufferPacked*, EncodedBuffer>::type EncodedBufferMap;
 
-            SubMeshLod();
-        };
+        /// Where readSubMesh & readSkeletonLink leave what needs the render thread.
+        PreparedMeshData *mPreparedData;
 
-        typedef vector<SubMeshLod>::type SubMeshLodVec;
+        /// False for the versions that predate the compressed chunks.
+        bool mSupportsCompression;
+        /// Whether the current export compresses the buffers.
+        bool mCompressBuffers;
+        /// Buffers encoded during the current export. calc*Size needs the encoded size
+        /// before the data gets written, so each buffer is encoded once & kept here.
+        /// Empty when the buffer didn't get smaller and is written raw.
+        EncodedBufferMap mEncodedBuffers;
+        /// Reused while reading compressed chunks.
+        EncodedBuffer mDecodeScratch;
 
         // Internal methods
         virtual void writeSubMeshNameTable(const Mesh* pMesh);
@@ -111,6 +179,8 @@ namespace Ogre {
         virtual void writeSubMeshLod( const VertexArrayObject *vao, uint8 lodLevel, uint8 lodSource );
         virtual void writeSubMeshLodOperation( const VertexArrayObject *vao );
         virtual void writeIndexes(IndexBufferPacked *indexBuffer);
+        virtual void writeCompressedIndexes( IndexBufferPacked *indexBuffer,
+                                             const EncodedBuffer &encodedData );
         virtual void writeGeometry(const VertexBufferPackedVec &pGeom);
         virtual void writeSkeletonLink(const String& skelName);
 
@@ -147,16 +217,29 @@ namespace Ogre {
         virtual size_t calcPoseVertexSize(const Pose* pose);*/
         virtual size_t calcBoundsInfoSize(const Mesh* pMesh);
 
+        /// Returns the data to write in the compressed chunks, encoding it the first time.
+        /// Returns null if the buffer must be written raw.
+        const EncodedBuffer* getEncodedIndexBuffer( IndexBufferPacked *indexBuffer );
+        const EncodedBuffer* getEncodedVertexBuffer( VertexBufferPacked *vertexBuffer );
+
         virtual void readTextureLayer(DataStreamPtr& stream, Mesh* pMesh, MaterialPtr& pMat);
         virtual void readSubMeshNameTable(DataStreamPtr& stream, Mesh* pMesh);
         virtual void readMesh(DataStreamPtr& stream, Mesh* pMesh, MeshSerializerListener *listener);
         virtual void readSubMesh(DataStreamPtr& stream, Mesh* pMesh, MeshSerializerListener *listener, uint8 numVaoPasses);
+        /// Reads the M_SUBMESH_LOD chunks of a SubMesh into mPreparedData.
+        void readSubMeshLods( DataStreamPtr &stream, Mesh *pMesh, SubMesh *sm,
+                              uint8 numLodLevels, uint8 numVaoPasses,
+                              bool buildBoneAssignments );
         virtual void readSubMeshLod( DataStreamPtr& stream, Mesh *pMesh,
                                      SubMeshLod *subLod, uint8 currentLod );
         virtual void readIndexes(DataStreamPtr& stream, SubMeshLod *subLod);
         virtual void readGeometry(DataStreamPtr& stream, SubMeshLod *subLod);
         virtual void readVertexDeclaration(DataStreamPtr& stream, SubMeshLod *subLod);
         virtual void readVertexBuffer(DataStreamPtr& stream, SubMeshLod *subLod);
+        virtual void readCompressedIndexes( DataStreamPtr &stream, SubMeshLod *subLod );
+        virtual void readCompressedVertexBuffer( DataStreamPtr &stream, SubMeshLod *subLod );
+        /// Validates the source & allocates its data, owned by subLod.
+        uint8* allocateVertexBuffer( SubMeshLod *subLod, uint8 source, uint8 bytesPerVertex );
         virtual void readSubMeshLodOperation(DataStreamPtr& stream, SubMeshLod *subLod);
         /*virtual void readGeometry(DataStreamPtr& stream, Mesh* pMesh, VertexData* dest);
         virtual void readGeometryVertexDeclaration(DataStreamPtr& stream, Mesh* pMesh, VertexData* dest);
@@ -198,7 +281,15 @@ namespace Ogre {
         VaoManager *mVaoManager;
     };
 
-    class _OgrePrivate MeshSerializerImpl_v2_1_R1 : public MeshSerializerImpl
+    /// Identical to the latest version, without the compressed buffer chunks.
+    class _OgrePrivate MeshSerializerImpl_v2_1_R2 : public MeshSerializerImpl
+    {
+    public:
+        MeshSerializerImpl_v2_1_R2( VaoManager *vaoManager );
+        virtual ~MeshSerializerImpl_v2_1_R2();
+    };
+
+    class _OgrePrivate MeshSerializerImpl_v2_1_R1 : public MeshSerializerImpl_v2_1_R2
     {
     public:
         MeshSerializerImpl_v2_1_R1( VaoManager *vaoManager );
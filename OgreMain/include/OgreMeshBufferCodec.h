@@ -0,0 +1,125 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2017 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef _OgreMeshBufferCodec_H_
+#define _OgreMeshBufferCodec_H_
+
+#include "OgrePrerequisites.h"
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Resources
+    *  @{
+    */
+
+    /** Lossless byte-oriented codecs for vertex & index buffers, used by MeshSerializer
+        to write compressed v2 meshes (@see MeshSerializer::setCompressBuffers).
+        Decoding is a single pass without tables nor dynamic allocations.
+    @remarks
+        Vertex buffers:
+            Vertices are processed in blocks of up to 256. For each byte of the vertex
+            (i.e. each column of the buffer), the difference against the same byte of the
+            previous vertex is zigzag encoded so that small positive & negative deltas
+            become small numbers. The deltas are then grouped by 16 and each group is
+            bit-packed with 0, 2, 4 or 8 bits per delta; whichever is the smallest that
+            fits. A 2-bit code per group tells which one was used.
+            Smooth attributes (positions, normals, UVs of meshes with good vertex locality,
+            e.g. after OgreMeshTool -cache) mostly change in their low bytes, thus the high
+            bytes compress to nothing.
+        @par
+        Index buffers:
+            Each index is stored as the zigzag encoded difference against the previous
+            index, in LEB128 varints (7 bits per byte). Indices reordered for the vertex
+            cache usually take a single byte.
+        @par
+        The encoded data is endian independent for index buffers. Vertex buffers are
+        encoded byte by byte, thus they must be converted to the file's endianness before
+        encoding (and after decoding), like uncompressed buffers.
+    */
+    class _OgreExport MeshBufferCodec
+    {
+    public:
+        /// Maximum number of bytes encodeVertexBuffer may write.
+        static size_t getVertexBufferBound( size_t numVertices, size_t bytesPerVertex );
+
+        /** Encodes a vertex buffer.
+        @param dst
+            Output. Should be getVertexBufferBound bytes big.
+        @param dstCapacity
+            Size in bytes of dst.
+        @param bytesPerVertex
+            Must be in range [1; 256].
+        @return
+            Number of bytes written to dst. 0 if dst was too small.
+        */
+        static size_t encodeVertexBuffer( uint8 *dst, size_t dstCapacity, const uint8 *src,
+                                          size_t numVertices, size_t bytesPerVertex );
+
+        /** Decodes a vertex buffer written by encodeVertexBuffer.
+        @param dst
+            Output. Must hold numVertices * bytesPerVertex bytes.
+        @param srcSize
+            Size in bytes of the encoded data. Never reads past it.
+        @return
+            False if the data is corrupt or doesn't match numVertices & bytesPerVertex.
+        */
+        static bool decodeVertexBuffer( uint8 *dst, size_t numVertices, size_t bytesPerVertex,
+                                        const uint8 *src, size_t srcSize );
+
+        /// Maximum number of bytes encodeIndexBuffer may write.
+        static size_t getIndexBufferBound( size_t numIndices );
+
+        /** Encodes an index buffer.
+        @param indices
+            Array of uint16 or uint32, depending on index32Bit.
+        @return
+            Number of bytes written to dst. 0 if dst was too small.
+        */
+        static size_t encodeIndexBuffer( uint8 *dst, size_t dstCapacity, const void *indices,
+                                         size_t numIndices, bool index32Bit );
+
+        /** Decodes an index buffer written by encodeIndexBuffer.
+        @param dst
+            Output. Array of numIndices uint16 or uint32, depending on index32Bit.
+        @return
+            False if the data is corrupt or doesn't match numIndices.
+        */
+        static bool decodeIndexBuffer( void *dst, size_t numIndices, bool index32Bit,
+                                       const uint8 *src, size_t srcSize );
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -83,6 +83,12 @@ namespace Ogre {
                         // unsigned int* faceVertexIndices (indexCount)
                         // OR
                         // unsigned short* faceVertexIndices (indexCount)
+                    M_SUBMESH_INDEX_BUFFER_COMPRESSED = 0x4321, // optional, R3+
+                        // When present, the inline index data above has indexCount = 0
+                        // unsigned int indexCount
+                        // bool indexes32Bit
+                        // unsigned int encodedBytes
+                        // uint8* data (encodedBytes) // See MeshBufferCodec::encodeIndexBuffer
                     M_SUBMESH_M_GEOMETRY = 0x4330,
                         // unsigned int vertexCount
                         // uint8 numSources;    //Number of vertex buffers.
@@ -95,6 +101,12 @@ namespace Ogre {
                             // uint8 bindIndex;    // Index to bind this buffer to
                             // uint8 vertexSize;   // Per-vertex size, must agree with declaration at this index
                             // raw buffer data
+                        M_SUBMESH_M_GEOMETRY_VERTEX_BUFFER_COMPRESSED = 0x4333, // Repeating section, R3+
+                            // Alternative to M_SUBMESH_M_GEOMETRY_VERTEX_BUFFER, per source
+                            // uint8 bindIndex;    // Index to bind this buffer to
+                            // uint8 vertexSize;   // Per-vertex size, must agree with declaration at this index
+                            // unsigned int encodedBytes
+                            // uint8* data (encodedBytes) // See MeshBufferCodec::encodeVertexBuffer
                     M_SUBMESH_M_GEOMETRY_EXTERNAL_SOURCE = 0x4340,
                         // This section is mutually exclusive w/ M_SUBMESH_M_GEOMETRY
                         // uint8 lodSource; //Get this vertex buffer from a LOD different source.
@@ -33,6 +33,7 @@ THE SOFTWARE.
 #include "OgreResourceManager.h"
 #include "OgreSingleton.h"
 #include "OgreVector3.h"
+#include "OgreWorkQueue.h"
 #include "Vao/OgreBufferPacked.h"
 #include "OgreHeaderPrefix.h"
 
@@ -51,9 +52,38 @@ namespace Ogre
             the creation of resources (in this case mesh data),
             working within a fixed memory budget.
     */
-    class _OgreExport MeshManager: public ResourceManager, public Singleton<MeshManager>
+    class _OgreExport MeshManager: public ResourceManager, public Singleton<MeshManager>,
+            public WorkQueue::RequestHandler, public WorkQueue::ResponseHandler
     {
+    public:
+        /** Gets notified when a mesh requested via loadAsync finished loading.
+            Always called from the main thread (inside WorkQueue::processResponses,
+            which Root calls every frame).
+        */
+        class _OgreExport AsyncLoadListener
+        {
+        public:
+            virtual ~AsyncLoadListener() {}
+
+            /**
+            @param mesh
+                The mesh that was requested.
+            @param errorDescription
+                Empty on success. Otherwise the mesh failed to load and is left unloaded.
+            */
+            virtual void meshLoaded( const MeshPtr &mesh, const String &errorDescription ) = 0;
+        };
+
     protected:
+        struct AsyncLoadRequest
+        {
+            MeshPtr             mesh;
+            AsyncLoadListener   *listener;
+
+            _OgreExport friend std::ostream& operator<<( std::ostream& o, const AsyncLoadRequest& r )
+            { (void)r; return o; }
+        };
+
         /// @copydoc ResourceManager::createImpl
         Resource* createImpl(const String& name, ResourceHandle handle,
             const String& group, bool isManual, ManualResourceLoader* loader,
@@ -67,6 +97,16 @@ namespace Ogre
         // The listener to pass to serializers
         //MeshSerializerListener *mListener;
 
+        /// Null until _initialise registers our WorkQueue channel.
+        WorkQueue   *mWorkQueue;
+        uint16      mWorkQueueChannel;
+        size_t      mNumPendingAsyncLoads;
+
+        bool        mArrangeEfficientOnPrepare;
+        bool        mArrangeEfficientHalfPos;
+        bool        mArrangeEfficientHalfTexCoords;
+        bool        mArrangeEfficientQTangents;
+
     public:
         MeshManager();
         ~MeshManager();
@@ -159,6 +199,64 @@ namespace Ogre
                       bool vertexBufferShadowed = true, bool indexBufferShadowed = true );
 
 
+        /** Loads a mesh from a file without stalling the main thread. Reading, parsing
+            and (optionally, @see setArrangeEfficientOnPrepare) rearranging the vertex data
+            is done in a WorkQueue thread via Mesh::prepare; then only the creation of
+            the GPU buffers happens on the main thread, when the response is processed.
+        @remarks
+            The returned mesh is not usable until the listener gets called (or until
+            Mesh::isLoaded returns true). Calling Mesh::load before that is safe, but
+            will block until the background preparation is done.
+        @par
+            When Ogre is built without thread support (OGRE_THREAD_SUPPORT == 0) the
+            whole load happens synchronously inside this call, listener included.
+        @param listener
+            Optional. Called from the main thread once the mesh is loaded or failed.
+            Must outlive the request.
+        @param vertexBufferType
+            @See load. The buffer policies are only applied if the mesh didn't exist.
+        */
+        MeshPtr loadAsync( const String& filename, const String& groupName,
+                           AsyncLoadListener *listener = 0,
+                           BufferType vertexBufferType = BT_IMMUTABLE,
+                           BufferType indexBufferType = BT_IMMUTABLE,
+                           bool vertexBufferShadowed = true, bool indexBufferShadowed = true );
+
+        /// Number of loadAsync requests whose listener hasn't been called yet.
+        size_t getNumPendingAsyncLoads(void) const      { return mNumPendingAsyncLoads; }
+
+        /** When enabled, meshes rearrange their vertex data in Mesh::prepare the same way
+            Mesh::arrangeEfficient would (i.e. a single interleaved vertex buffer, with
+            optional half floats and QTangents). Since it's done on the system memory copy
+            before the GPU buffers are created, it works with loadAsync's background
+            threads, and avoids the cost of reading back & recreating the buffers later.
+        @remarks
+            Meshes exported by OgreMeshTool are usually already efficient; this is for
+            meshes exported with multiple vertex buffers or full 32-bit floats.
+            Off by default. Only affects meshes prepared afterwards.
+        @param halfPos
+            @See Mesh::importV1
+        @param halfTexCoords
+            @See Mesh::importV1
+        @param qTangents
+            @See Mesh::importV1
+        */
+        void setArrangeEfficientOnPrepare( bool enabled, bool halfPos = true,
+                                           bool halfTexCoords = true, bool qTangents = true );
+        bool getArrangeEfficientOnPrepare(void) const   { return mArrangeEfficientOnPrepare; }
+        bool getArrangeEfficientHalfPos(void) const     { return mArrangeEfficientHalfPos; }
+        bool getArrangeEfficientHalfTexCoords(void) const { return mArrangeEfficientHalfTexCoords; }
+        bool getArrangeEfficientQTangents(void) const   { return mArrangeEfficientQTangents; }
+
+        /// Implementation for WorkQueue::RequestHandler
+        bool canHandleRequest( const WorkQueue::Request *req, const WorkQueue *srcQ );
+        /// Implementation for WorkQueue::RequestHandler
+        WorkQueue::Response* handleRequest( const WorkQueue::Request *req, const WorkQueue *srcQ );
+        /// Implementation for WorkQueue::ResponseHandler
+        bool canHandleResponse( const WorkQueue::Response *res, const WorkQueue *srcQ );
+        /// Implementation for WorkQueue::ResponseHandler
+        void handleResponse( const WorkQueue::Response *res, const WorkQueue *srcQ );
+
         /** Creates a new Mesh specifically for manual definition rather
             than loading from an object file. 
         @remarks
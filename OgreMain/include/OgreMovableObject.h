@@ -33,6 +33,8 @@ THE SOFTWARE.
 #include "OgrePrerequisites.h"
 #include "OgreAxisAlignedBox.h"
 #include "OgreSphere.h"
+#include "OgrePlane.h"
+#include "OgreShadowCasterVolume.h"
 #include "OgreAnimable.h"
 #include "OgreSceneNode.h"
 #include "Math/Array/OgreObjectData.h"
@@ -95,6 +97,9 @@ namespace Ogre {
         //One for each submesh/Renderable
         FastArray<Real> const               *mLodMesh;
         unsigned char                       mCurrentMeshLod;
+        /// Last value calculated by the LodStrategy. Lowest possible value (highest detail)
+        /// until the first LOD update.
+        Real                                mCurrentLodValue;
 
         /// Minimum pixel size to still render
         Real mMinPixelSize;
@@ -106,6 +111,11 @@ namespace Ogre {
 
         /// List of lights for this object
         LightList mLightList;
+        /// Bounds, light mask & LightBinGrid frame mLightList was built with.
+        /// Only used when light binning is enabled. @See buildLightListBinned
+        Sphere  mLightListBounds;
+        uint32  mLightListMask;
+        uint32  mLightListFrameId;
 
         /// Only valid for V2 objects. Derived classes are in charge of
         /// creating and/or destroying it. Placed here since it's the
@@ -116,6 +126,11 @@ namespace Ogre {
         /// The memory manager used to allocate the ObjectData.
         ObjectMemoryManager *mObjectMemoryManager;
 
+        /// @See _setVisibilityDelayed
+        bool                mVisibilityDelayed;
+        /// What setVisible was last set to while mVisibilityDelayed is true.
+        bool                mDelayedVisible;
+
 #if OGRE_DEBUG_MODE
         mutable bool mCachedAabbOutOfDate;
 #endif
@@ -193,6 +208,7 @@ namespace Ogre {
         virtual void _notifyParentNodeMemoryChanged(void) {}
 
         unsigned char getCurrentMeshLod(void) const                         { return mCurrentMeshLod; }
+        Real getCurrentLodValue(void) const                                 { return mCurrentLodValue; }
 
         /// Checks whether this MovableObject is static. @See setStatic
         bool isStatic() const;
@@ -229,15 +245,20 @@ namespace Ogre {
         /** @See SceneManager::updateAllBounds
         @remarks
             We don't pass by reference on purpose (avoid implicit aliasing)
+        @param parentsFromBackBuffer
+            When true, the parent nodes' derived transforms are read from the back buffer.
+            @See Node::updateAllTransforms
         */
-        static void updateAllBounds( const size_t numNodes, ObjectData t );
+        static void updateAllBounds( const size_t numNodes, ObjectData t,
+                                     bool parentsFromBackBuffer=false );
 
         /** @See SceneManager::cullFrustum
         @remarks
             We don't pass by reference on purpose (avoid implicit aliasing)
             We perform frustum culling AND test visibility mask at the same time
         @param frustum
-            Frustum to clip against
+            Frustum to clip against. If it has a ShadowCasterVolume, objects outside
+            of it are culled too.
         @param sceneVisibilityFlags
             Combined scene's visibility flags (i.e. viewport | scene). Set LAYER_SHADOW_CASTER
             bit if you want to exclude non-shadow casters.
@@ -254,6 +275,84 @@ namespace Ogre {
                                  uint32 sceneVisibilityFlags, MovableObjectArray &outCulledObjects,
                                  const Camera *lodCamera );
 
+        /** Same as cullFrustum, but only tests the given packs (groups of ARRAY_PACKED_REALS
+            objects), which don't need to be contiguous. Used by StaticObjectBvh on its leaves.
+        @param packIndices
+            Array of numPacks pack indices, relative to firstObjData.
+        @param firstObjData
+            ObjectData of the first pack, as returned by ObjectMemoryManager::getFirstObjectData
+        @param testPlanes
+            When false the frustum planes aren't tested, because the caller already knows
+            all the packs are fully inside. Visibility flags, rendering distance and the
+            frustum's ShadowCasterVolume (if any) still are.
+        */
+        static void cullFrustumPacks( const uint32 *packIndices, size_t numPacks,
+                                      const ObjectData &firstObjData, const Camera *frustum,
+                                      uint32 sceneVisibilityFlags,
+                                      MovableObjectArray &outCulledObjects,
+                                      const Camera *lodCamera, bool testPlanes );
+
+        /** A frustum culled in advance by cullFrustumMulti, together with its results.
+        @remarks
+            All the camera settings are copied, so that the frustum can be culled before
+            the camera is setup for rendering it (e.g. several cubemap faces sharing
+            the same camera). @See SceneManager::_cullPhase01Multi
+        */
+        struct _OgreExport MultiFrustum
+        {
+            /// Maximum number of frusta tested at the same time by cullFrustumMulti
+            static const size_t MaxFrusta = 32u;
+
+            Plane           planes[6];
+            /// Copy of the camera's, if it had one. @See Camera::_setShadowCasterVolume
+            ShadowCasterVolume casterVolume;
+            Vector3         cameraPos;
+            Vector3         cameraDir;
+            Camera const    *lodCamera;
+            Vector3         lodCameraPos;
+            bool            useRenderingDistance;
+            /// Combined visibility flags. @See cullFrustum's sceneVisibilityFlags
+            uint32          sceneVisibilityFlags;
+            /// First RenderQueue ID to cull (inclusive)
+            uint8           firstRq;
+            /// Last RenderQueue ID to cull (exclusive)
+            uint8           lastRq;
+            /// Set once the culling results are ready, cleared once they've been consumed.
+            bool            valid;
+            /// Culled objects, one array per worker thread.
+            vector<MovableObjectArray>::type culledObjects;
+
+            MultiFrustum();
+
+            void set( const Camera *cullCamera, const Camera *lodCamera,
+                      uint32 sceneVisibilityFlags, uint8 firstRq, uint8 lastRq );
+
+            /// Returns true if the results can be used to render the given camera.
+            bool matches( const Camera *cullCamera, const Camera *lodCamera,
+                          uint32 sceneVisibilityFlags ) const;
+        };
+
+        /** Same as cullFrustum, but tests each pack of objects against multiple frusta
+            at once, so that the object data only has to be swept through once.
+        @remarks
+            The results are appended to frusta[i]->culledObjects[threadIdx]. Frusta
+            whose RenderQueue range doesn't include renderQueue are skipped.
+            Unlike cullFrustum, the distance to camera is not cached; use
+            _updateCachedDistanceToCamera when consuming the results.
+        @param renderQueue
+            RenderQueue ID of the objects in objData.
+        @param numFrusta
+            Must not be greater than MultiFrustum::MaxFrusta.
+        @param frameArena
+            Scratch memory for the SIMD frusta. @See SceneManager::_getFrameArena
+        */
+        static void cullFrustumMulti( const size_t numNodes, ObjectData t, uint8 renderQueue,
+                                      MultiFrustum * const *frusta, size_t numFrusta,
+                                      size_t threadIdx, FrameArena &frameArena );
+
+        /// Recalculates the value returned by getCachedDistanceToCamera. @See cullFrustumMulti
+        void _updateCachedDistanceToCamera( const Vector3 &cameraPos, const Vector3 &cameraDir );
+
         /// @See InstancingTheadedCullingMethod, @see InstanceBatch::instanceBatchCullFrustumThreaded
         virtual void instanceBatchCullFrustumThreaded( const Frustum *frustum, const Camera *lodCamera,
                                                         uint32 combinedVisibilityFlags ) {}
@@ -271,9 +370,12 @@ namespace Ogre {
         @param cubemapFrustums
             An array of all frustums that are used at least once as cubemaps
             (@See SceneManager::createCamera)
+        @param frameArena
+            Scratch memory for the SIMD planes. @See SceneManager::_getFrameArena
         */
         static void cullLights( const size_t numNodes, ObjectData t, LightListInfo &outGlobalLightList,
-                                const FrustumVec &frustums , const FrustumVec &cubemapFrustums );
+                                const FrustumVec &frustums , const FrustumVec &cubemapFrustums,
+                                FrameArena &frameArena );
 
         /** @See SceneManager::buildLightList
         @remarks
@@ -281,16 +383,33 @@ namespace Ogre {
         @param globalLightList
             List of lights already culled against all possible frustums and
             reorganized contiguously for SoA
+        @param frameArena
+            Scratch memory for sorting the lists. @See SceneManager::_getFrameArena
         */
         static void buildLightList( const size_t numNodes, ObjectData t,
-                                    const LightListInfo &globalLightList );
+                                    const LightListInfo &globalLightList, FrameArena &frameArena );
+
+        /** Same as buildLightList, but only tests the lights from the cells of lightBinGrid
+            each object touches, and keeps the previous list of the objects whose bounds
+            and light mask didn't change when none of those cells changed either.
+            @See SceneManager::setLightBinning
+        @remarks
+            Unlike buildLightList, LightClosest::globalIndex is the index to globalLightList.
+        */
+        static void buildLightListBinned( const size_t numNodes, ObjectData t,
+                                          const LightListInfo &globalLightList,
+                                          LightBinGrid &lightBinGrid, size_t threadIdx,
+                                          FrameArena &frameArena );
 
         static void calculateCastersBox( const size_t numNodes, ObjectData t,
                                          uint32 sceneVisibilityFlags, AxisAlignedBox *outBox );
 
         friend void LodStrategy::lodUpdateImpl( const size_t numNodes, ObjectData t,
-                                                const Camera *camera, Real bias ) const;
-        friend void LodStrategy::lodSet( ObjectData &t, Real lodValues[ARRAY_PACKED_REALS] );
+                                                const Camera *camera, Real bias, Real hysteresis,
+                                                LodStrategy::LodTransitions &outTransitions ) const;
+        friend void LodStrategy::lodSet( ObjectData &t, Real lodValues[ARRAY_PACKED_REALS],
+                                         Real hysteresis,
+                                         LodStrategy::LodTransitions &outTransitions );
 
         /** Tells this object whether to be visible or not, if it has a renderable component. 
         @note An alternative approach of making an object invisible is to detach it
@@ -314,6 +433,13 @@ namespace Ogre {
         */
         inline bool getVisible(void) const;
 
+        /** Internal use. While delayed, the object is not rendered and setVisible only
+            records the value, which gets applied when the delay ends.
+            @See SceneManager::setPipelinedUpdate
+        */
+        void _setVisibilityDelayed( bool bDelayed );
+        bool _getVisibilityDelayed(void) const              { return mVisibilityDelayed; }
+
         /** Returns whether or not this object is supposed to be visible or not. 
         @remarks
             Takes into account visibility flags and the setVisible, but not rendering distance.
@@ -555,6 +681,8 @@ namespace Ogre {
 #if OGRE_DEBUG_MODE
         void _setCachedAabbOutOfDate(void)                  { mCachedAabbOutOfDate = true; }
         bool isCachedAabbOutOfDate() const                  { return mCachedAabbOutOfDate; }
+        /// @See SceneManager::updateSceneGraphAsync
+        void _setCachedAabbUpToDate(void) const             { mCachedAabbOutOfDate = false; }
 #endif
 
     };
@@ -123,7 +123,9 @@ namespace Ogre
         assert( (!visible || mParentNode) && "Setting to visible an object without "
                 "attachment is not supported!" );
 
-        if( visible )
+        if( mVisibilityDelayed )
+            mDelayedVisible = visible;
+        else if( visible )
             mObjectData.mVisibilityFlags[mObjectData.mIndex] |= VisibilityFlags::LAYER_VISIBILITY;
         else
             mObjectData.mVisibilityFlags[mObjectData.mIndex] &= ~VisibilityFlags::LAYER_VISIBILITY;
@@ -131,6 +133,8 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     inline bool MovableObject::getVisible(void) const
     {
+        if( mVisibilityDelayed )
+            return mDelayedVisible;
         return (mObjectData.mVisibilityFlags[mObjectData.mIndex] &
                                                     VisibilityFlags::LAYER_VISIBILITY) != 0;
     }
@@ -253,6 +253,12 @@ namespace Ogre {
         /// Returns a direct access to the Transform state
         Transform& _getTransform()                                      { return mTransform; }
 
+        /** Returns a copy of our Transform whose derived position, orientation, scale and
+            transform point to the back buffer, if our NodeMemoryManager is double buffered.
+            @See SceneManager::setPipelinedUpdate
+        */
+        void _getBackBufferTransform( Transform &outTransform ) const;
+
         /// Called by SceneManager when it is telling we're a static node being dirty
         /// Don't call this directly. @see SceneManager::notifyStaticDirty
         virtual void _notifyStaticDirty(void) const;
@@ -697,8 +703,12 @@ namespace Ogre {
         /** @See SceneManager::updateAllTransforms()
         @remarks
             We don't pass by reference on purpose (avoid implicit aliasing)
+        @param parentsFromBackBuffer
+            When true, the parents' derived transforms are read from the back buffer.
+            Used by the pipelined scene update, where 't' points to the back buffer too.
         */
-        static void updateAllTransforms( const size_t numNodes, Transform t );
+        static void updateAllTransforms( const size_t numNodes, Transform t,
+                                         bool parentsFromBackBuffer=false );
         
         /** Gets the local position, relative to this node, of the given world-space position */
         virtual_l2 Vector3 convertWorldToLocalPosition( const Vector3 &worldPos );
@@ -760,6 +770,8 @@ namespace Ogre {
 #if OGRE_DEBUG_MODE >= OGRE_DEBUG_MEDIUM
         virtual void _setCachedTransformOutOfDate(void);
         bool isCachedTransformOutOfDate(void) const             { return mCachedTransformOutOfDate; }
+        /// @See SceneManager::updateSceneGraphAsync
+        void _setCachedTransformUpToDate(void) const            { mCachedTransformOutOfDate = false; }
 #endif
     };
     /** @} */
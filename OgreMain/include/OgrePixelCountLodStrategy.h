@@ -79,7 +79,8 @@ namespace Ogre {
         Real getValueImpl(const MovableObject *movableObject, const Camera *camera) const;
 
         virtual void lodUpdateImpl( const size_t numNodes, ObjectData t,
-                                    const Camera *camera, Real bias ) const;
+                                    const Camera *camera, Real bias, Real hysteresis,
+                                    LodTransitions &outTransitions ) const;
 
         /** Override standard Singleton retrieval.
         @remarks
@@ -127,7 +128,8 @@ namespace Ogre {
         Real getValueImpl(const MovableObject *movableObject, const Camera *camera) const;
 
         virtual void lodUpdateImpl( const size_t numNodes, ObjectData t,
-                                    const Camera *camera, Real bias ) const;
+                                    const Camera *camera, Real bias, Real hysteresis,
+                                    LodTransitions &outTransitions ) const;
 
         /** Override standard Singleton retrieval.
         @remarks
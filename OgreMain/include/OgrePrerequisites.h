@@ -183,9 +183,11 @@ namespace Ogre {
     class Forward3D;
     class ForwardClustered;
     class ForwardPlusBase;
+    class FrameArena;
     struct FrameEvent;
     class FrameListener;
     class Frustum;
+    class GpuBillboardSet;
     struct GpuLogicalBufferStruct;
     struct GpuNamedConstants;
     class GpuProgramParameters;
@@ -229,6 +231,7 @@ namespace Ogre {
     class Item;
     struct KfTransform;
     class Light;
+    class LightBinGrid;
     class Log;
     class LogManager;
     class LodStrategy;
@@ -302,6 +305,7 @@ namespace Ogre {
     class ScriptLoader;
     class Serializer;
     class ShadowCameraSetup;
+    class ShadowCasterVolume;
     class SimpleMatrixAf4x3;
     class SimpleSpline;
     class SkeletonDef;
@@ -310,6 +314,7 @@ namespace Ogre {
     class Sphere;
     class SphereSceneQuery;
     class StagingBuffer;
+    class StaticGeometry;
     class StreamSerialiser;
     class StringConverter;
     class StringInterface;
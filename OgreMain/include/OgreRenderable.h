@@ -409,7 +409,9 @@ namespace Ogre {
 
         uint8 getCurrentMaterialLod(void) const { return mCurrentMaterialLod; }
 
-        friend void LodStrategy::lodSet( ObjectData &t, Real lodValues[ARRAY_PACKED_REALS] );
+        friend void LodStrategy::lodSet( ObjectData &t, Real lodValues[ARRAY_PACKED_REALS],
+                                         Real hysteresis,
+                                         LodStrategy::LodTransitions &outTransitions );
 
         /** Sets the render queue sub group.
         @remarks
@@ -144,6 +144,7 @@ namespace Ogre
         MovableObjectFactory* mBillboardChainFactory;
         MovableObjectFactory* mRibbonTrailFactory;
         MovableObjectFactory* mWireAabbFactory;
+        MovableObjectFactory* mGpuBillboardSetFactory;
 
         /// Are we initialised yet?
         bool mIsInitialised;
@@ -933,6 +934,14 @@ namespace Ogre
         */
         bool _updateAllRenderTargets(FrameEvent& evt);
 
+        /** Calls SceneManager::waitForSceneGraphUpdate on all scene managers
+            with a pending pipelined update. @See SceneManager::setPipelinedUpdate
+        @remarks
+            Called by _updateAllRenderTargets once all workspaces were updated,
+            thus frameRenderingQueued listeners can safely modify the scene.
+        */
+        void _waitForSceneGraphUpdates(void);
+
         /** Override standard Singleton retrieval.
             @remarks
                 Why do we do this? Well, it's because the Singleton
@@ -45,6 +45,7 @@ Torus Knot Software Ltd.
 #include "OgreInstanceManager.h"
 #include "OgreRenderSystem.h"
 #include "OgreLodListener.h"
+#include "OgreLodStrategy.h"
 #include "OgreManualObject2.h"
 #include "OgreRawPtr.h"
 #include "Math/Array/OgreNodeMemoryManager.h"
@@ -144,6 +145,8 @@ namespace Ogre {
     struct EntityMaterialLodChangedEvent;
     class CompositorShadowNode;
     class UniformScalableTask;
+    class SoftwareOcclusionCulling;
+    class StaticObjectBvh;
 
     namespace v1
     {
@@ -172,10 +175,17 @@ namespace Ogre {
         Camera const                    *camera;
         /// Camera whose frustum we're to cull against. Must be const (read only for all threads).
         Camera const                    *lodCamera;
+        /** When not null, the objects were already culled by SceneManager::_cullPhase01Multi
+            and the results are taken from here instead of culling again.
+        */
+        MovableObject::MultiFrustum const *preCulled;
+        /// Whether the visible objects should be tested against the software occlusion buffer.
+        bool                            occlusionCulling;
 
         CullFrustumRequest() :
             firstRq( 0 ), lastRq( 0 ), casterPass( false ), addToRenderQueue( true ),
-            cullingLights( false ), objectMemManager( 0 ), camera( 0 ), lodCamera( 0 )
+            cullingLights( false ), objectMemManager( 0 ), camera( 0 ), lodCamera( 0 ),
+            preCulled( 0 ), occlusionCulling( false )
         {
         }
         CullFrustumRequest( uint8 _firstRq, uint8 _lastRq, bool _casterPass,
@@ -184,11 +194,41 @@ namespace Ogre {
                             const Camera *_camera, const Camera *_lodCamera ) :
             firstRq( _firstRq ), lastRq( _lastRq ), casterPass( _casterPass ),
             addToRenderQueue( _addToRenderQueue ), cullingLights( _cullingLights ),
-            objectMemManager( _objectMemManager ), camera( _camera ), lodCamera( _lodCamera )
+            objectMemManager( _objectMemManager ), camera( _camera ), lodCamera( _lodCamera ),
+            preCulled( 0 ), occlusionCulling( false )
         {
         }
     };
 
+    /// All variables are read-only for the worker threads.
+    struct MultiFrustumCullRequest
+    {
+        typedef vector<ObjectMemoryManager*>::type ObjectMemoryManagerVec;
+        /// First RenderQueue ID to cull (inclusive). Union of all the frusta's ranges.
+        uint8                           firstRq;
+        /// Last RenderQueue ID to cull (exclusive). Union of all the frusta's ranges.
+        uint8                           lastRq;
+        ObjectMemoryManagerVec const    *objectMemManager;
+        /// Each thread only writes to its own entry in MultiFrustum::culledObjects.
+        MovableObject::MultiFrustum * const *frusta;
+        size_t                          numFrusta;
+
+        MultiFrustumCullRequest() :
+            firstRq( 0 ), lastRq( 0 ), objectMemManager( 0 ), frusta( 0 ), numFrusta( 0 )
+        {
+        }
+    };
+
+    struct CastersBoxRequest
+    {
+        /// Combined scene's visibility flags. @See MovableObject::calculateCastersBox
+        uint32  visibilityMask;
+        uint8   firstRq;
+        uint8   lastRq;
+
+        CastersBoxRequest() : visibilityMask( 0 ), firstRq( 0 ), lastRq( 0 ) {}
+    };
+
     struct UpdateLodRequest : public CullFrustumRequest
     {
         Real    lodBias;
@@ -325,6 +365,24 @@ namespace Ogre {
             Real skyBoxDistance;
         };
 
+        /// @See getLodStats
+        struct LodStats
+        {
+            /// Number of updateAllLods calls this frame
+            size_t  numUpdates;
+            /// Render queues evaluated / skipped because they were already cached.
+            size_t  numEvaluatedRqs;
+            size_t  numCachedRqs;
+            /// Number of objects whose mesh LOD changed this frame
+            size_t  numMeshTransitions;
+            /// Number of renderables whose material LOD changed this frame
+            size_t  numMaterialTransitions;
+
+            LodStats() :
+                numUpdates( 0 ), numEvaluatedRqs( 0 ), numCachedRqs( 0 ),
+                numMeshTransitions( 0 ), numMaterialTransitions( 0 ) {}
+        };
+
         typedef vector<SceneNode*>::type SceneNodeList;
         typedef vector<MovableObject*>::type MovableObjectVec;
 
@@ -458,6 +516,12 @@ namespace Ogre {
         ObjectMemoryManagerVec  mEntitiesMemoryManagerUpdateList;
         ObjectMemoryManagerVec  mLightsMemoryManagerCulledList;
         SkeletonAnimManagerVec  mSkeletonAnimManagerCulledList;
+        /// Incremented by updateAllAnimations. @see SkeletonInstance::_updateWithLod
+        uint32                  mAnimationFrameCount;
+        /// @see setAnimationLodCamera
+        Camera const            *mAnimationLodCamera;
+        /// True from updateAllAnimations until the animation LOD values are taken.
+        bool                    mAnimationLodPending;
 
         /** Minimum depth level at which mNodeMemoryManager[SCENE_STATIC] is dirty.
         @remarks
@@ -495,6 +559,10 @@ namespace Ogre {
         LightArrayPerThread             mGlobalLightListPerThread;
         BuildLightListRequestPerThread  mBuildLightListRequestPerThread;
 
+        /// One per worker thread. Reset in _frameEnded. @See _getFrameArena
+        typedef vector<FrameArena*>::type FrameArenaVec;
+        FrameArenaVec                   mFrameArenas;
+
         /// Current ambient light.
         ColourValue mAmbientLight[2];
         Vector3     mAmbientLightHemisphereDir;
@@ -895,9 +963,65 @@ namespace Ogre {
         uint32 mVisibilityMask;
         bool mFindVisibleObjects;
 
+        /// @See setMultiFrustumCulling
+        bool mMultiFrustumCulling;
+        /// @See setShadowCasterVolumeCulling
+        bool mShadowCasterVolumeCulling;
+        /// @See _setPreCulledFrustum
+        MovableObject::MultiFrustum *mPreCulledFrustum;
+        /// @See setSoftwareOcclusionCulling
+        SoftwareOcclusionCulling    *mSoftwareOcclusionCulling;
+        /// @See setStaticBvhCulling
+        StaticObjectBvh             *mStaticObjectBvh;
+        /// @See setLightBinning
+        LightBinGrid                *mLightBinGrid;
+        /// @See setPipelinedUpdate
+        bool                        mPipelinedUpdate;
+        /// True between updateSceneGraphAsync and waitForSceneGraphUpdate
+        bool                        mPipelinedUpdatePending;
+        /// One per depth level, pointing to the back buffers. @See updateSceneGraphAsync
+        vector<UpdateTransformRequest>::type mPipelinedTransformRequests;
+        /// Objects attached since the last updateSceneGraphAsync. @See _delayVisibility
+        MovableObjectVec            mDelayedVisibilityObjects;
+        /// Objects whose bounds are being calculated by the pending pipelined update.
+        MovableObjectVec            mDelayedVisibilityInFlight;
+        /// @See setLodHysteresis
+        Real                        mLodHysteresis;
+
+        /// Who evaluated the LODs of a render queue last. @See setLodCaching
+        struct LodCacheEntry
+        {
+            Camera const    *lodCamera;
+            Viewport const  *viewport;
+            Vector3         position;
+            Real            lodBias;
+            uint32          frame;
+
+            LodCacheEntry() : lodCamera( 0 ), viewport( 0 ), position( Vector3::ZERO ),
+                              lodBias( 0 ), frame( 0 ) {}
+
+            bool operator == ( const LodCacheEntry &other ) const
+            {
+                return lodCamera == other.lodCamera && viewport == other.viewport &&
+                       position == other.position && lodBias == other.lodBias &&
+                       frame == other.frame;
+            }
+        };
+        typedef vector<LodCacheEntry>::type LodCacheEntryVec;
+
+        /// One per render queue when LOD caching is enabled, empty otherwise.
+        LodCacheEntryVec            mLodCache;
+        /// Incremented every frame & by invalidateLodCache.
+        uint32                      mLodFrame;
+        LodStats                    mLodStats;
+        /// One per thread. @See updateAllLods
+        vector<LodStrategy::LodTransitions>::type mLodTransitionsPerThread;
+
         enum RequestType
         {
             CULL_FRUSTUM,
+            CULL_FRUSTUM_MULTI,
+            CALCULATE_CASTERS_BOX,
             UPDATE_ALL_ANIMATIONS,
             UPDATE_ALL_TRANSFORMS,
             UPDATE_ALL_BONE_TO_TAG_TRANSFORMS,
@@ -916,6 +1040,10 @@ namespace Ogre {
         size_t mNumWorkerThreads;
 
         CullFrustumRequest              mCurrentCullFrustumRequest;
+        MultiFrustumCullRequest         mMultiFrustumCullRequest;
+        CastersBoxRequest               mCastersBoxRequest;
+        /// One per thread. @See _calculateCurrentCastersBox
+        vector<AxisAlignedBox>::type    mCastersBoxPerThread;
         UpdateLodRequest                mUpdateLodRequest;
         UpdateTransformRequest          mUpdateTransformRequest;
         ObjectMemoryManagerVec const    *mUpdateBoundsRequest;
@@ -925,6 +1053,10 @@ namespace Ogre {
         RequestType         mRequestType;
         Barrier             *mWorkerThreadsBarrier;
         ThreadHandleVec     mWorkerThreads;
+        /// Syncs the main thread with mPipelineThread. @See updateSceneGraphAsync
+        Barrier             *mPipelineBarrier;
+        ThreadHandlePtr     mPipelineThread;
+        bool                mStopPipelineThread;
 
         /** Contains MovableObjects to be visited and rendered.
         @rermarks
@@ -1024,7 +1156,20 @@ namespace Ogre {
             Thread index so we know at which point we should start at.
             Must be unique for each worker thread
         */
-        void updateAllBoundsThread( const ObjectMemoryManagerVec &objectMemManager, size_t threadIdx );
+        void updateAllBoundsThread( const ObjectMemoryManagerVec &objectMemManager, size_t threadIdx,
+                                    bool toBackBuffer=false );
+
+        /** Runs in mPipelineThread while the main thread culls and renders. Updates the
+            transforms depth by depth, then the bounds, writing into the back buffers.
+            @See updateSceneGraphAsync
+        */
+        void updateSceneGraphPipelined(void);
+
+        /** Processes mRequestType for the given thread.
+        @return
+            True if the thread must exit.
+        */
+        bool processWorkerRequest( size_t threadIdx );
 
         /**
         @param threadIdx
@@ -1033,6 +1178,10 @@ namespace Ogre {
         */
         void updateAllLodsThread( const UpdateLodRequest &request, size_t threadIdx );
 
+        /// Gives the skeleton instances whose LOD source is in [firstRq; lastRq) the
+        /// LOD value it has now. @see setAnimationLodCamera
+        void updateAnimationLodValues( uint8 firstRq, uint8 lastRq );
+
         /** Traverses mVisibleObjects[threadIdx] from each thread to call
             MovableObject::instanceBatchCullFrustumThreaded (which is supposed to cull objects)
         @param threadIdx
@@ -1052,11 +1201,29 @@ namespace Ogre {
         */
         void cullFrustum( const CullFrustumRequest &request, size_t threadIdx );
 
+        /** Culls all objects against multiple frusta in one sweep.
+            @See MovableObject::cullFrustumMulti, @see _cullPhase01Multi
+        @param threadIdx
+            Index to MultiFrustum::culledObjects. Must be unique for each worker thread
+        */
+        void cullFrustumMulti( const MultiFrustumCullRequest &request, size_t threadIdx );
+
+        /** Merges the bounds of this thread's share of the shadow casters into
+            mCastersBoxPerThread[threadIdx]. @See _calculateCurrentCastersBox
+        */
+        void calculateCastersBoxThread( const CastersBoxRequest &request, size_t threadIdx );
+
+        /// Adds the v2 objects to the render queue from a worker thread, then clears the list.
+        void addToRenderQueueV2( MovableObject::MovableObjectArray &visibleObjects,
+                                 size_t threadIdx, uint8 rq, bool casterPass );
+
         /** Builds a list of all lights that are visible by all queued cameras (this should be fed by
             Compositor). Then calls MovableObject::buildLightList with that list so that each
             MovableObject gets it's own sorted list of the closest lights.
         @remarks
             @See MovableObject::buildLightList()
+            The per-object lists are only built when light binning is enabled
+            (MovableObject::buildLightListBinned). @See setLightBinning
         */
         void buildLightList();
 
@@ -1393,6 +1560,15 @@ namespace Ogre {
         void _addWireAabb( WireAabb *wireAabb );
         void _removeWireAabb( WireAabb *wireAabb );
 
+        /// Create a GpuBillboardSet. See GpuBillboardSet::updateGpuData.
+        virtual GpuBillboardSet* createGpuBillboardSet( SceneMemoryMgrTypes sceneType = SCENE_DYNAMIC );
+
+        /// Removes & destroys a GpuBillboardSet from the SceneManager.
+        virtual void destroyGpuBillboardSet( GpuBillboardSet *billboardSet );
+
+        /// Removes & destroys all GpuBillboardSets.
+        virtual void destroyAllGpuBillboardSets(void);
+
         /** Create an Entity (instance of a discrete mesh).
             @param
                 meshName The name of the Mesh it is to be based on (e.g. 'knot.oof'). The
@@ -1884,6 +2060,9 @@ namespace Ogre {
             per frame during render, but the user might want to manually call this function.
         @remarks
             mSkeletonAnimManagerCulledList must be set. @See updateAllTransforms remarks
+        @par
+            Distant instances may skip their animation evaluation based on the LOD values
+            from the previous frame. @See SkeletonDef::setAnimationLodLevels
         */
         void updateAllAnimations();
 
@@ -1917,13 +2096,129 @@ namespace Ogre {
         void updateAllBounds( const ObjectMemoryManagerVec &objectMemManager );
 
         /** Updates the Lod values of all objects relative to the given camera.
+        @remarks
+            When LOD caching is enabled, render queues already evaluated this frame against
+            the same LOD camera (same position, viewport and bias) are skipped.
+            @See setLodCaching
         */
         void updateAllLods( const Camera *lodCamera, Real lodBias, uint8 firstRq, uint8 lastRq );
 
+        /** Sets the hysteresis band of the LOD switches. An object only switches to another LOD
+            once its LOD value is past the threshold by hysteresis * abs( threshold ), so that
+            objects moving around a threshold don't flicker between two LODs every frame.
+        @remarks
+            The LOD an object is in depends on its previous one. When the LOD of the same
+            objects is evaluated against more than one LOD camera (e.g. a reflection pass
+            using its own camera) they share that history.
+        @param hysteresis
+            Fraction of the threshold. 0 (default) disables it, 0.1 means 10%.
+        */
+        void setLodHysteresis( Real hysteresis )            { mLodHysteresis = hysteresis; }
+        Real getLodHysteresis(void) const                   { return mLodHysteresis; }
+
+        /** When enabled, updateAllLods doesn't evaluate again the render queues it already
+            evaluated this frame with the same LOD camera. Typically shadow map passes use
+            the main camera as LOD camera, which means the LODs get evaluated again for
+            every shadow map. Disabled by default.
+        @remarks
+            A frame starts with updateSceneGraph (or updateSceneGraphAsync). Objects created
+            or changed in between two passes won't have their LOD updated until the next
+            frame; call invalidateLodCache if that's a problem.
+        */
+        void setLodCaching( bool bEnabled );
+        bool getLodCaching(void) const                      { return !mLodCache.empty(); }
+
+        /// Forces the next updateAllLods call to evaluate all objects. @See setLodCaching
+        void invalidateLodCache(void)                       { ++mLodFrame; }
+
+        /// Accumulated by all updateAllLods calls since the last updateSceneGraph.
+        const LodStats& getLodStats(void) const             { return mLodStats; }
+
+        /** Sets the camera whose LOD values select the animation LOD of the skeletons in
+            the next frame. @See SkeletonDef::setAnimationLodLevels
+        @remarks
+            When null (the default), the first updateAllLods call after updateAllAnimations
+            is used, which normally is the main camera's first pass. LOD updates done later
+            in the frame (reflections, shadow passes with their own LOD camera, other
+            workspaces) don't affect the animations.
+        */
+        void setAnimationLodCamera( const Camera *camera )  { mAnimationLodCamera = camera; }
+        const Camera* getAnimationLodCamera(void) const     { return mAnimationLodCamera; }
+
         /** Updates the scene: Perform high level culling, Node transforms and entity animations.
         */
         void updateSceneGraph();
 
+        /** When enabled, Root::renderOneFrame updates the node transforms and the world
+            bounds for the next frame in a dedicated thread, while the main thread culls and
+            renders the current one using the worker threads as usual. Disabled by default.
+            @See updateSceneGraphAsync
+        @remarks
+            The transforms of the nodes and the bounds of the objects are double buffered:
+            the update reads a snapshot of the local ones and writes the derived ones to
+            the back buffer, while rendering reads from the front one.
+            waitForSceneGraphUpdate copies the results over.
+        @par
+            What gets rendered is one frame behind (i.e. the first frame shows the scene
+            as it was before any update). Objects attached since the previous update stay
+            hidden until their bounds are calculated, instead of being rendered for one
+            frame with the default transform.
+        @par
+            Only the node transforms and the world bounds overlap with rendering. They're
+            computed in the dedicated thread alone, i.e. not split among the worker threads.
+            Skeletal animations, TagPoints, instance managers and the bounds that depend on
+            them are still updated after rendering (in waitForSceneGraphUpdate, using the
+            worker threads), so scenes dominated by skeletal animation gain little.
+        @par
+            Pays off when updating the scene graph takes a significant portion of the
+            frame, i.e. many dynamic nodes.
+        */
+        void setPipelinedUpdate( bool bEnabled );
+        bool getPipelinedUpdate(void) const                 { return mPipelinedUpdate; }
+
+        /** First half of updateSceneGraph. Sync point: starts updating the node transforms
+            and the world bounds in the dedicated pipeline thread, and returns immediately.
+            Requires setPipelinedUpdate( true ).
+        @remarks
+            Until waitForSceneGraphUpdate is called, changing a transform or the local bounds
+            only takes effect in the next update. Creating, destroying, attaching, detaching
+            or moving nodes or objects finishes the pending update first (i.e. the rest of
+            the frame is rendered with the new transforms), so it's best to make those
+            changes before calling this function.
+            Culling, rendering and executeUserScalableTask use the worker threads as usual.
+        @par
+            Controllers and node animations are applied here, in the calling thread.
+            Skeletal animations, TagPoints, instance managers and the light lists need
+            the new transforms and are updated in waitForSceneGraphUpdate.
+        */
+        void updateSceneGraphAsync(void);
+
+        /** Second half of updateSceneGraph. Sync point: waits for the pipeline thread
+            started by updateSceneGraphAsync, makes its results current, and finishes
+            the update (skeletal animations, TagPoints, instance managers; these use the
+            worker threads). After it returns, the scene can be modified again.
+        */
+        void waitForSceneGraphUpdate(void);
+
+        /// True between updateSceneGraphAsync and waitForSceneGraphUpdate.
+        bool isSceneGraphUpdatePending(void) const          { return mPipelinedUpdatePending; }
+
+        /// Calls waitForSceneGraphUpdate if there is an update pending. Called before any
+        /// change that would race with the pipelined update.
+        void _finishPendingSceneGraphUpdate(void)
+        {
+            if( mPipelinedUpdatePending )
+                waitForSceneGraphUpdate();
+        }
+
+        /** Hides an object that just got attached until the pipelined update that calculates
+            its bounds is published. Called by MovableObject::_notifyAttached.
+            @See MovableObject::_setVisibilityDelayed
+        */
+        void _delayVisibility( MovableObject *movableObject );
+        /// Called when an object is detached before its visibility got restored.
+        void _cancelDelayedVisibility( MovableObject *movableObject );
+
         /** Internal method for applying animations to scene nodes.
         @remarks
             Uses the internally stored AnimationState objects to apply animation to SceneNodes.
@@ -1942,6 +2237,101 @@ namespace Ogre {
         virtual void _cullPhase01(Camera* camera, const Camera *lodCamera,
                                   Viewport* vp, uint8 firstRq, uint8 lastRq );
 
+        /** Culls the scene against all the given frusta at once, sweeping the objects only
+            once instead of once per frustum. Used by the Compositor when multi-frustum
+            culling is enabled (e.g. shadow map cascades, cubemap faces).
+            @See setMultiFrustumCulling
+        @remarks
+            The results are stored in each frustum and are consumed by _cullPhase01
+            after calling _setPreCulledFrustum. If by then the camera or visibility
+            mask has changed (e.g. a listener modified them), _cullPhase01 ignores
+            the results and culls normally.
+        @param frusta
+            Frusta to cull, already setup via MovableObject::MultiFrustum::set.
+            There is no limit to how many; they're split in batches of
+            MovableObject::MultiFrustum::MaxFrusta.
+        */
+        void _cullPhase01Multi( MovableObject::MultiFrustum * const *frusta, size_t numFrusta );
+
+        /** Makes the next call to _cullPhase01 use the results from _cullPhase01Multi
+            (if they're still valid). Reset after that call. Can be null.
+        */
+        void _setPreCulledFrustum( MovableObject::MultiFrustum *frustum )
+                                                        { mPreCulledFrustum = frustum; }
+
+        /** When enabled, the Compositor culls all eligible scene passes from the same node
+            (i.e. all shadow maps from a shadow node, all faces of a cubemap) in a single
+            sweep before executing them. Disabled by default.
+        @remarks
+            This is a performance optimization that pays off when there are many objects
+            and several frusta. If a CompositorWorkspaceListener changes a pass's camera
+            or visibility mask, those passes silently fall back to regular culling.
+        */
+        void setMultiFrustumCulling( bool bEnabled )    { mMultiFrustumCulling = bEnabled; }
+        bool getMultiFrustumCulling(void) const         { return mMultiFrustumCulling; }
+
+        /** When enabled, shadow casters are also culled against the receiver region (the
+            camera's frustum, or the PSSM split) extruded towards the light, rejecting casters
+            that are inside the shadow map camera but whose shadows can't be seen.
+            Disabled by default. @See ShadowCasterVolume
+        @remarks
+            Takes effect the next time the shadow nodes are updated.
+        */
+        void setShadowCasterVolumeCulling( bool bEnabled )  { mShadowCasterVolumeCulling = bEnabled; }
+        bool getShadowCasterVolumeCulling(void) const       { return mShadowCasterVolumeCulling; }
+
+        /** Enables CPU occlusion culling for regular (non shadow) passes with perspective
+            cameras. Disabled by default. @See SoftwareOcclusionCulling
+        @remarks
+            Nothing gets occluded until occluders are registered via
+            getSoftwareOcclusionCulling()->addOccluder. Disabling it destroys the
+            SoftwareOcclusionCulling instance, including its occluders.
+        @param width
+            Resolution of the depth buffer. Small sizes are recommended; the
+            cost of rasterizing grows with it.
+        */
+        void setSoftwareOcclusionCulling( bool bEnabled, uint32 width=256u, uint32 height=128u );
+
+        /** When enabled, static objects are frustum culled by walking a bounding volume
+            hierarchy instead of testing every one of them. Disabled by default.
+            @See StaticObjectBvh
+        @remarks
+            Pays off in big scenes where most static objects are outside the camera.
+            It only affects regular & shadow passes; other sweeps (e.g. light lists,
+            multi-frustum culling) still go through all objects.
+            The tree is built during the next updateSceneGraph.
+        */
+        void setStaticBvhCulling( bool bEnabled );
+
+        /// Returns null if the static BVH is disabled.
+        StaticObjectBvh* getStaticObjectBvh(void) const { return mStaticObjectBvh; }
+
+        /** When enabled, lights are binned into a uniform world-space grid every frame,
+            so that each object only gets tested against the lights near it, and cullLights
+            only tests the lights in the cells that intersect the camera. Disabled by default.
+            @See LightBinGrid
+        @remarks
+            Enabling it also builds the per-object light lists (MovableObject::queryLights),
+            which are otherwise not built. Objects whose bounds and light mask didn't change,
+            and whose surrounding lights didn't change either, keep the list from the previous
+            frame. See LightBinGrid::getStats for how many lists were reused vs rebuilt.
+        @par
+            Pays off with many local lights (e.g. thousands) spread over the scene.
+        @param cellSize
+            Size of each cell in world units. Works best when close to the typical light radius.
+        @param maxCellsPerAxis
+            Upper bound of cells along each axis; the cells get bigger if the lights are
+            spread over a larger area.
+        */
+        void setLightBinning( bool bEnabled, Real cellSize=10.0f, uint32 maxCellsPerAxis=32u );
+
+        /// Returns null if light binning is disabled.
+        LightBinGrid* getLightBinGrid(void) const       { return mLightBinGrid; }
+
+        /// Returns null if software occlusion culling is disabled.
+        SoftwareOcclusionCulling* getSoftwareOcclusionCulling(void) const
+                                                        { return mSoftwareOcclusionCulling; }
+
         /** Prompts the class to send its contents to the renderer.
             @remarks
                 This method prompts the scene manager to send the
@@ -1967,8 +2357,22 @@ namespace Ogre {
                          Light::LightTypes endType, LightArray &outLights );
 
         /// Called when the frame has fully ended (ALL passes have been executed to all RTTs)
+        /// Resets the frame arenas.
         void _frameEnded(void);
 
+        /** Returns the scratch arena of the given worker thread, for memory that only
+            lives within the current frame (culling planes, sort buffers, etc).
+            Everything allocated from it is invalidated by _frameEnded.
+        @remarks
+            Index 0 is also used by the rendering thread (i.e. RenderQueue), which never
+            runs at the same time as worker thread 0.
+        */
+        FrameArena& _getFrameArena( size_t threadIdx )  { return *mFrameArenas[threadIdx]; }
+
+        /// Sum of FrameArena::getNumHeapAllocations of every worker thread's arena.
+        /// Stops increasing once the per-frame scratch memory has reached its steady state.
+        size_t getFrameArenaHeapAllocations(void) const;
+
         /** Internal method for queueing the sky objects with the params as 
             previously set through setSkyBox, setSkyPlane and setSkyDome.
         */
@@ -3047,8 +3451,9 @@ namespace Ogre {
             valid during viewport update. */
         Camera* getCameraInProgress(void) const     { return mCameraInProgress; }
 
+        /// Merges the bounds of all shadow casters in the given render queues. Multithreaded.
         AxisAlignedBox _calculateCurrentCastersBox( uint32 viewportVisibilityMask,
-                                                    uint8 firstRq, uint8 lastRq ) const;
+                                                    uint8 firstRq, uint8 lastRq );
 
         /** @See CompositorShadowNode::getCastersBox
         @remarks
@@ -3128,6 +3533,12 @@ namespace Ogre {
 
         void fireWorkerThreadsAndWait(void);
 
+        /// Calls nodeUpdated on the listeners of all nodes. @See updateAllTransforms
+        void fireNodeListeners(void);
+
+        /// Everything in updateSceneGraph that comes after updating the bounds.
+        void finishSceneGraphUpdate(void);
+
         /** Launches cullFrustum on all worker threads with the requested parameters
         @remarks
             Will block until all threads are done.
@@ -3136,6 +3547,10 @@ namespace Ogre {
         void fireCullFrustumInstanceBatchThreads( const InstanceBatchCullRequest &request );
         void startWorkerThreads();
         void stopWorkerThreads();
+        void startPipelineThread(void);
+        void stopPipelineThread(void);
+        /// Restores the visibility of the objects in the given list, and clears it.
+        void restoreDelayedVisibility( MovableObjectVec &movableObjects );
 
     public:
 
@@ -3164,6 +3579,9 @@ namespace Ogre {
             requests when a sync is performed
         */
         unsigned long _updateWorkerThread( ThreadHandle *threadHandle );
+
+        /// Called from mPipelineThread, runs updateSceneGraphPipelined on every sync.
+        unsigned long _updatePipelineThread( ThreadHandle *threadHandle );
     };
 
     /** Default implementation of IntersectionSceneQuery. */
@@ -0,0 +1,117 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2017 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef _OgreShadowCasterVolume_H_
+#define _OgreShadowCasterVolume_H_
+
+#include "OgrePrerequisites.h"
+#include "OgrePlane.h"
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Scene
+    *  @{
+    */
+
+    /** Convex volume that encloses every object that can cast a shadow onto the visible
+        receivers of a shadow map: the receiver region (the camera's frustum, or just
+        a PSSM split) extruded towards the light.
+    @remarks
+        Shadow map cameras are fitted to the receivers but their frusta are usually much
+        bigger than this volume (e.g. the corners of the light space AABB, or a spot
+        light's cone covering areas that aren't on screen). Testing the casters against
+        these planes on top of the shadow camera's frustum rejects everything whose shadow
+        can't fall on anything visible.
+    @par
+        For directional lights the receivers are extruded infinitely in the opposite
+        direction of the light. For point & spot lights the volume is the convex hull
+        of the receivers and the light's position.
+    @par
+        Enable it via SceneManager::setShadowCasterVolumeCulling. CompositorShadowNode
+        builds one per shadow map and assigns it to the shadow map's camera
+        (@see Camera::_setShadowCasterVolume), where MovableObject::cullFrustum
+        picks it up.
+    */
+    class _OgreExport ShadowCasterVolume
+    {
+    public:
+        /// 6 faces from the receivers, plus one per silhouette edge (the hexahedron has 12).
+        static const size_t MaxPlanes = 18u;
+
+        /// Plane normals point inwards. Only the first numPlanes are used.
+        Plane   planes[MaxPlanes];
+        uint8   numPlanes;
+
+        ShadowCasterVolume() : numPlanes( 0 ) {}
+
+        /// Removes all planes. An empty volume doesn't cull anything.
+        void clear(void)                { numPlanes = 0; }
+        bool isEmpty(void) const        { return numPlanes == 0; }
+
+        /** Builds the volume from the 8 corners of the receiver region.
+        @remarks
+            If the corners are degenerate the volume is left empty.
+        @param corners
+            Same layout as Frustum::getWorldSpaceCorners: near top-right, near top-left,
+            near bottom-left, near bottom-right, then the same for the far plane.
+        @param light
+            Directional, point or spot light. Must be attached to a SceneNode.
+        */
+        void build( const Vector3 corners[8], const Light *light );
+
+        /** Builds the volume using as receivers the part of the camera's frustum between
+            the given distances (i.e. a PSSM split). @See build
+        @param farDist
+            Can't be infinite (0). Must be greater than nearDist.
+        */
+        void build( const Camera *camera, Real nearDist, Real farDist, const Light *light );
+
+        /** Outputs the corners of the camera's frustum between the given distances,
+            in the layout build expects.
+        */
+        static void getReceiverCorners( const Camera *camera, Real nearDist, Real farDist,
+                                        Vector3 outCorners[8] );
+
+        /// Returns false if the box is fully outside the volume. Scalar version, for
+        /// the SIMD version @see MovableObject::cullFrustum
+        bool isVisible( const Aabb &box ) const;
+
+        bool operator == ( const ShadowCasterVolume &other ) const;
+        bool operator != ( const ShadowCasterVolume &other ) const  { return !(*this == other); }
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -0,0 +1,199 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2017 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef _OgreSoftwareOcclusionCulling_H_
+#define _OgreSoftwareOcclusionCulling_H_
+
+#include "OgrePrerequisites.h"
+#include "OgreMovableObject.h"
+#include "OgreMatrix4.h"
+#include "Threading/OgreUniformScalableTask.h"
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Scene
+    *  @{
+    */
+
+    /** CPU occlusion culling. Occluders (low poly proxies of large objects, e.g. buildings)
+        are rasterized into a small depth buffer, and every object that passed frustum
+        culling has its AABB tested against it before being added to the RenderQueue.
+    @remarks
+        Enable it via SceneManager::setSoftwareOcclusionCulling. It's only used by regular
+        passes with perspective cameras (shadow caster passes are not affected).
+    @par
+        The buffer stores 1/w, which is linear in screen space. Rasterization is split
+        by rows across the SceneManager's worker threads, then each thread builds the
+        farthest depth of each 8x8 tile of its rows. Testing an object first checks
+        those tiles, and only goes down to individual pixels when the tile is inconclusive.
+    @par
+        Occluders must not be bigger than the actual geometry they stand for, or else
+        visible objects will disappear. Pixels are considered covered by an occluder if
+        their centre is, which is not strictly conservative at occluder edges; this is
+        rarely noticeable at the resolutions this is meant to be used with.
+    */
+    class _OgreExport SoftwareOcclusionCulling : public UniformScalableTask, public SceneMgtAlloc
+    {
+    public:
+        struct Stats
+        {
+            size_t  numOccluders;
+            /// After near plane clipping
+            size_t  numTriangles;
+            /// Objects that passed frustum culling, and were tested against the depth buffer.
+            size_t  numTested;
+            size_t  numCulled;
+            /// Time spent setting up & transforming the occluders (main thread).
+            uint64  setupMicroseconds;
+            /// Time spent rasterizing & building the hierarchical buffer (wall clock).
+            uint64  rasterMicroseconds;
+            /// Time spent testing objects (summed across all threads).
+            uint64  testMicroseconds;
+
+            Stats();
+            Real getCulledPercentage(void) const;
+        };
+
+    protected:
+        struct Occluder
+        {
+            MovableObject           *owner;
+            /// In local space
+            vector<Vector3>::type   vertices;
+            vector<uint32>::type    indices;
+        };
+        typedef vector<Occluder>::type OccluderVec;
+
+        struct ScreenTriangle
+        {
+            Real    x[3];
+            Real    y[3];
+            /// 1 / w
+            Real    iz[3];
+            int32   minY;
+            int32   maxY;
+        };
+        typedef vector<ScreenTriangle>::type ScreenTriangleVec;
+
+        /// Per thread. Padded to avoid false sharing.
+        struct ThreadStats
+        {
+            size_t  numTested;
+            size_t  numCulled;
+            uint64  testMicroseconds;
+            uint8   padding[64];
+        };
+        typedef vector<ThreadStats>::type ThreadStatsVec;
+
+        static const uint32 TileSize = 8u;
+
+        OccluderVec         mOccluders;
+        ScreenTriangleVec   mTriangles;
+
+        uint32              mWidth;
+        uint32              mHeight;
+        uint32              mNumTilesX;
+        uint32              mNumTilesY;
+        /// mWidth * mHeight. Holds 1/w of the closest occluder; 0 means nothing.
+        float               *mDepthBuffer;
+        /// mNumTilesX * mNumTilesY. Holds the smallest (farthest) value of each tile.
+        float               *mHiZBuffer;
+
+        Matrix4             mViewProjMatrix;
+        Real                mNearPlane;
+        Camera const        *mLastCamera;
+        unsigned long       mLastFrame;
+
+        Stats               mStats;
+        ThreadStatsVec      mThreadStats;
+
+        void rasterizeTriangle( const ScreenTriangle &tri, uint32 rowStart, uint32 rowEnd );
+        void buildHiZ( uint32 tileRowStart, uint32 tileRowEnd );
+
+        /// Clips against the near plane, projects, and adds the result to mTriangles.
+        void addTriangle( const Vector4 clipPos[3] );
+
+    public:
+        /// The resolution gets rounded up to a multiple of 8.
+        SoftwareOcclusionCulling( uint32 width, uint32 height, size_t numThreads );
+        virtual ~SoftwareOcclusionCulling();
+
+        void setResolution( uint32 width, uint32 height );
+        uint32 getWidth(void) const                 { return mWidth; }
+        uint32 getHeight(void) const                { return mHeight; }
+
+        /** Adds an occluder. Replaces the proxy if owner was already an occluder.
+        @remarks
+            The occluder is ignored while owner is invisible or detached. You must call
+            removeOccluder before destroying owner.
+        @param vertices
+            Proxy triangle list, in owner's local space. Should be a low poly version
+            of the object, fully contained within it.
+        */
+        void addOccluder( MovableObject *owner, const Vector3 *vertices, size_t numVertices,
+                          const uint32 *indices, size_t numIndices );
+
+        /// Same as addOccluder, using owner's local AABB as proxy (i.e. for box-like objects).
+        void addBoxOccluder( MovableObject *owner );
+
+        void removeOccluder( MovableObject *owner );
+        void removeAllOccluders(void);
+
+        size_t getNumOccluders(void) const          { return mOccluders.size(); }
+
+        /** Builds the depth buffer for the given camera. Called by SceneManager from the
+            main thread. Does nothing if it's already built for this camera & frame.
+        */
+        void _update( const Camera *camera, SceneManager *sceneManager );
+
+        /// Rasterizes its share of rows. @See UniformScalableTask
+        virtual void execute( size_t threadId, size_t numThreads );
+
+        /// Returns true if the box may be visible. Safe to call from multiple threads.
+        bool isVisible( const Aabb &worldAabb ) const;
+
+        /// Removes occluded objects from the array. Called from worker threads by SceneManager.
+        void _cullOccluded( MovableObject::MovableObjectArray &inOutObjects, size_t threadIdx );
+
+        /// Statistics since the last _update call that built the buffer.
+        Stats getStats(void) const;
+
+        /// Read-only access to the depth buffer (1/w, row-major, top row first), for debugging.
+        const float* getDepthBuffer(void) const     { return mDepthBuffer; }
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -0,0 +1,345 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2017 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef _OgreStaticGeometry2_H_
+#define _OgreStaticGeometry2_H_
+
+#include "OgrePrerequisites.h"
+#include "OgreMesh2.h"
+#include "Math/Simple/OgreAabb.h"
+#include "OgreHlmsPso.h"
+#include "Vao/OgreVertexBufferPacked.h"
+#include "Threading/OgreUniformScalableTask.h"
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Scene
+    *  @{
+    */
+    /** Merges static Items into a few large batches. This is the v2 counterpart of
+        v1::StaticGeometry, meant for scenes with many small static props.
+    @remarks
+        The world is divided in a grid of regions (@see setRegionDimensions). Within each
+        region, the SubItems that share the same datablock, vertex format and operation type
+        are merged into a single SubMesh. Each region becomes one Mesh and one Item in
+        SCENE_STATIC with its own Aabb; so it costs one cull entry, and one draw per
+        datablock and vertex format, no matter how many props were added to it.
+    @par
+        Usage: queue the Items with addItem or addSceneNode, then call build. The source
+        Items are left untouched; you will normally destroy them afterwards (or never
+        create them, @see addMesh). Nothing is merged until build is called, so it is
+        cheaper to queue everything first.
+    @par
+        build reads the vertex and index buffers back (which is fast if they were created
+        with a shadow copy), then transforms and merges them in the SceneManager's worker
+        threads. Since that is a load time operation, the result can be saved with
+        saveRegions and loaded later with loadRegions, which doesn't merge anything.
+    @par
+        LOD: like v1, the LOD values of a region are the highest of the values of its
+        meshes at each level (they all must use the same LOD strategy). Meshes with less
+        LOD levels than the region use their last level for the remaining ones.
+    @par
+        Limitations: skeletally animated meshes are not supported. Only list operation
+        types (triangles, lines, points) can be merged. Positions, normals, tangents and
+        binormals must be float or half (or QTangents for the normals) so they can be
+        transformed; other elements are copied as they are. QTangents only take the
+        orientation into account and can't be mirrored (negative scale).
+    */
+    class _OgreExport StaticGeometry : public BatchedGeometryAlloc, public UniformScalableTask
+    {
+    public:
+        struct QueuedSubMesh
+        {
+            SubMesh const   *subMesh;
+            /// From the SubMesh's local space to the space of the region (relative to its centre)
+            Matrix4         transform;
+            /// Only used by QTangents
+            Quaternion      orientation;
+        };
+        typedef vector<QueuedSubMesh>::type QueuedSubMeshVec;
+
+        /// Result of merging one Batch at one LOD level
+        struct BatchLod
+        {
+            /// One per vertex buffer. Empty if the vertex buffers are shared with vertexLod
+            vector<char*>::type vertexData;
+            uint32          numVertices;
+            /// The LOD whose vertex buffers are used. Equal to our own when not shared.
+            uint8           vertexLod;
+            void            *indexData;
+            uint32          numIndices;
+            bool            indices32;
+
+            BatchLod() :
+                numVertices( 0 ), vertexLod( 0 ), indexData( 0 ), numIndices( 0 ), indices32( false ) {}
+        };
+        typedef vector<BatchLod>::type BatchLodVec;
+
+        /// All the queued SubMeshes of a region that can be merged together.
+        /// Becomes a SubMesh of the region's Mesh.
+        struct Batch
+        {
+            HlmsDatablock       *datablock;
+            OperationType       operationType;
+            /// Index to mVertexFormats
+            uint32              vertexFormatIdx;
+            QueuedSubMeshVec    queuedSubMeshes;
+            BatchLodVec         lods;
+            /// Bounds of the merged vertices, relative to the region's centre
+            Aabb                aabb;
+
+            Batch( HlmsDatablock *_datablock, OperationType _operationType,
+                   uint32 _vertexFormatIdx ) :
+                datablock( _datablock ), operationType( _operationType ),
+                vertexFormatIdx( _vertexFormatIdx ), aabb( Aabb::BOX_NULL ) {}
+        };
+        typedef vector<Batch>::type BatchVec;
+
+        struct Region
+        {
+            int32               x, y, z;
+            Vector3             centre;
+            /// Already transformed by the LOD strategy. The first one is the base value.
+            Mesh::LodValueArray lodValues;
+            BatchVec            batches;
+            /// Bounds of the merged geometry, relative to the centre
+            Aabb                aabb;
+
+            MeshPtr             mesh;
+            SceneNode           *sceneNode;
+            Item                *item;
+
+            Region( int32 _x, int32 _y, int32 _z, const Vector3 &_centre ) :
+                x( _x ), y( _y ), z( _z ), centre( _centre ), aabb( Aabb::BOX_NULL ),
+                sceneNode( 0 ), item( 0 ) {}
+        };
+        typedef vector<Region*>::type RegionVec;
+
+    protected:
+        struct RegionKey
+        {
+            int32 x, y, z;
+            RegionKey( int32 _x, int32 _y, int32 _z ) : x( _x ), y( _y ), z( _z ) {}
+            bool operator < ( const RegionKey &other ) const
+            {
+                if( x != other.x )
+                    return x < other.x;
+                if( y != other.y )
+                    return y < other.y;
+                return z < other.z;
+            }
+        };
+        struct BatchKey
+        {
+            HlmsDatablock   *datablock;
+            OperationType   operationType;
+            uint32          vertexFormatIdx;
+            BatchKey( HlmsDatablock *_datablock, OperationType _operationType,
+                      uint32 _vertexFormatIdx ) :
+                datablock( _datablock ), operationType( _operationType ),
+                vertexFormatIdx( _vertexFormatIdx ) {}
+            bool operator < ( const BatchKey &other ) const
+            {
+                if( datablock != other.datablock )
+                    return datablock < other.datablock;
+                if( operationType != other.operationType )
+                    return operationType < other.operationType;
+                return vertexFormatIdx < other.vertexFormatIdx;
+            }
+        };
+        typedef map<RegionKey, size_t>::type RegionKeyMap;
+        typedef map<BatchKey, size_t>::type BatchKeyMap;
+        typedef vector<BatchKeyMap>::type BatchKeyMapVec;
+        typedef map<const BufferPacked*, const char*>::type BufferDataMap;
+
+        String          mName;
+        SceneManager    *mSceneManager;
+        VaoManager      *mVaoManager;
+
+        Vector3         mRegionDimensions;
+        Vector3         mOrigin;
+        String          mLodStrategyName;
+
+        uint8           mRenderQueueGroup;
+        uint32          mVisibilityFlags;
+        bool            mCastShadows;
+        bool            mVisible;
+        Real            mRenderingDistance;
+
+        RegionVec       mRegions;
+        RegionKeyMap    mRegionKeys;
+        /// One per region
+        BatchKeyMapVec  mBatchKeys;
+        size_t          mNumQueuedSubMeshes;
+
+        vector<VertexElement2VecVec>::type mVertexFormats;
+
+        /// Data of the source buffers while building; either their shadow copy or a download.
+        BufferDataMap           mBufferData;
+        vector<char*>::type     mDownloadedData;
+        struct PendingBatch
+        {
+            Batch   *batch;
+            /// LOD count of the region the batch belongs to
+            uint8   numLods;
+        };
+        /// Work for the worker threads while building.
+        vector<PendingBatch>::type  mPendingBatches;
+
+        /// Returns the index of the region containing the point, creating it if needed.
+        size_t getRegionIdx( const Vector3 &point );
+        uint32 getVertexFormatIdx( const VertexElement2VecVec &vertexFormat );
+        /// Throws if the SubMesh can't be merged.
+        void validateSubMesh( const SubMesh *subMesh, bool mirrored ) const;
+
+        /// Gathers the data of the source buffers of all the regions (main thread).
+        void downloadSourceBuffers(void);
+        void freeSourceBuffers(void);
+
+        /// Transforms and merges a batch at all LODs. Runs in the worker threads.
+        void mergeBatch( Batch &batch, uint8 numLods ) const;
+        void transformVertices( char *dstData, const char *srcData, uint32 numVertices,
+                                const VertexElement2Vec &vertexElements,
+                                const QueuedSubMesh &queued, Aabb *inOutAabb ) const;
+
+        /// Creates the Mesh of a region from its merged batches, and frees the merged data.
+        void createRegionMesh( Region *region );
+        /// Creates the Item & SceneNode of a region that already has its Mesh.
+        void createRegionItem( Region *region );
+        String getRegionMeshName( const Region *region ) const;
+
+    public:
+        StaticGeometry( const String &name, SceneManager *sceneManager );
+        virtual ~StaticGeometry();
+
+        const String& getName(void) const                   { return mName; }
+
+        /** Queues all the SubItems of an Item, with its current (derived) transform.
+        @remarks
+            The Item must be attached to a SceneNode. Its datablocks are the ones that
+            will be used; the Item itself isn't needed once this call returns.
+        */
+        void addItem( Item *item );
+
+        /** Queues all the SubItems of an Item, placed with the given transform.
+            Its parent node (if any) is ignored.
+        */
+        void addItem( Item *item, const Vector3 &position, const Quaternion &orientation,
+                      const Vector3 &scale = Vector3::UNIT_SCALE );
+
+        /** Queues a Mesh with the given datablocks, without having to create an Item.
+        @param datablocks
+            Datablocks to use, one per SubMesh. When null or shorter than the number
+            of SubMeshes, the datablock named after the SubMesh's material is used.
+        */
+        void addMesh( const MeshPtr &mesh, const Vector3 &position, const Quaternion &orientation,
+                      const Vector3 &scale = Vector3::UNIT_SCALE,
+                      const vector<HlmsDatablock*>::type *datablocks = 0 );
+
+        /** Queues all the Items attached to this node and all its children, recursively.
+            Other types of objects are ignored.
+        */
+        void addSceneNode( SceneNode *sceneNode );
+
+        /** Merges all the queued geometry and creates the regions' Meshes & Items.
+        @remarks
+            Any previous build is destroyed first. The queued geometry is kept, so
+            build can be called again (i.e. after queueing more geometry).
+            Geometry is assigned to its region when queued; to change the region
+            dimensions or origin, call reset and queue everything again.
+            Uses the SceneManager's worker threads.
+        */
+        void build(void);
+
+        /// Destroys the built regions (Items, SceneNodes & Meshes). The queue is kept.
+        void destroy(void);
+
+        /// Destroys the built regions and clears the queue.
+        void reset(void);
+
+        /** Saves the built regions to a file, so that they can be loaded with loadRegions
+            without merging again (i.e. merge offline, load at runtime).
+        @remarks
+            Each region is stored with its LOD values and its Mesh in the regular v2 .mesh
+            format. Datablocks are referenced by name; so they must have one (see
+            Hlms::createDatablock) and exist when loading.
+        */
+        void saveRegions( const String &filename ) const;
+
+        /** Loads regions saved with saveRegions and creates their Meshes & Items.
+            Calls reset first; so anything built or queued before is discarded.
+        */
+        void loadRegions( DataStreamPtr &stream );
+
+        const RegionVec& getRegions(void) const             { return mRegions; }
+
+        /// Number of SubMeshes queued so far
+        size_t getNumQueuedSubMeshes(void) const            { return mNumQueuedSubMeshes; }
+
+        /** Sets the size of a single region of geometry.
+        @remarks
+            Bigger regions mean less draw calls and cull entries, but coarser culling and
+            less effective LOD. Must be called before queueing anything.
+        */
+        void setRegionDimensions( const Vector3 &size );
+        const Vector3& getRegionDimensions(void) const      { return mRegionDimensions; }
+
+        /// Sets the origin of the region grid. Must be called before queueing anything.
+        void setOrigin( const Vector3 &origin );
+        const Vector3& getOrigin(void) const                { return mOrigin; }
+
+        /// Settings applied to the regions' Items. Take effect immediately if already built.
+        void setRenderQueueGroup( uint8 queueId );
+        uint8 getRenderQueueGroup(void) const               { return mRenderQueueGroup; }
+
+        void setVisibilityFlags( uint32 flags );
+        uint32 getVisibilityFlags(void) const               { return mVisibilityFlags; }
+
+        void setCastShadows( bool castShadows );
+        bool getCastShadows(void) const                     { return mCastShadows; }
+
+        void setVisible( bool visible );
+        bool isVisible(void) const                          { return mVisible; }
+
+        void setRenderingDistance( Real dist );
+        Real getRenderingDistance(void) const               { return mRenderingDistance; }
+
+        /// @copydoc UniformScalableTask::execute
+        virtual void execute( size_t threadId, size_t numThreads );
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -0,0 +1,173 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2017 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef _OgreStaticObjectBvh_H_
+#define _OgreStaticObjectBvh_H_
+
+#include "OgrePrerequisites.h"
+#include "OgreMovableObject.h"
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Scene
+    *  @{
+    */
+
+    /** Bounding volume hierarchy over the packs (groups of ARRAY_PACKED_REALS objects) of
+        the static ObjectMemoryManager, one tree per render queue.
+    @remarks
+        Enable it via SceneManager::setStaticBvhCulling. cullFrustum walks the tree and
+        rejects entire clusters outside the frustum without touching their objects.
+        Clusters fully inside the frustum skip the plane tests, while the rest get the
+        usual SIMD per-pack test (MovableObject::cullFrustumPacks) at the leaves.
+    @par
+        The tree is refit incrementally from SceneManager::notifyStaticAabbDirty (only
+        the leaves containing those objects, and their ancestors, are updated). It's
+        fully rebuilt when static objects are created, destroyed or change render queue,
+        or when too many packs were refit since the last build (the tree gets loose).
+    @par
+        Packs are the unit because objects can't be reordered in memory; each leaf
+        references up to LeafSize packs which are not necessarily contiguous.
+    */
+    class _OgreExport StaticObjectBvh : public SceneMgtAlloc
+    {
+    public:
+        static const uint32 InvalidNode = 0xffffffff;
+        /// Max number of packs per leaf.
+        static const uint32 LeafSize = 8u;
+
+        struct Node
+        {
+            Aabb    aabb;
+            uint32  parent;
+            /// InvalidNode if this is a leaf
+            uint32  left;
+            uint32  right;
+            /// Range in Tree::packIndices. Only valid on leaves.
+            uint32  firstPack;
+            uint32  numPacks;
+        };
+
+    protected:
+        typedef vector<Node>::type NodeVec;
+        typedef vector<Aabb>::type AabbVec;
+
+        /// Assigned to Tree::packToLeaf for packs with infinite objects.
+        static const uint32 InfinitePack = 0xfffffffe;
+
+        struct Tree
+        {
+            NodeVec                 nodes;
+            /// Indices of the packs, ordered so that each leaf references a contiguous range.
+            vector<uint32>::type    packIndices;
+            /// Maps each pack to its leaf. InvalidNode if the pack was empty.
+            vector<uint32>::type    packToLeaf;
+            AabbVec                 packAabbs;
+            /// Packs that contain objects with infinite bounds. Never culled by the tree.
+            vector<uint32>::type    infinitePacks;
+            /// Subtrees that are distributed across the worker threads.
+            vector<uint32>::type    taskRoots;
+        };
+        typedef vector<Tree>::type TreeVec;
+
+        struct DirtyPack
+        {
+            uint32  renderQueue;
+            uint32  packIdx;
+            DirtyPack( uint32 _renderQueue, uint32 _packIdx ) :
+                renderQueue( _renderQueue ), packIdx( _packIdx ) {}
+        };
+        typedef vector<DirtyPack>::type DirtyPackVec;
+
+        /// Per thread. Padded to avoid false sharing.
+        struct ThreadScratch
+        {
+            vector<uint32>::type    intersecting;
+            vector<uint32>::type    inside;
+            uint8                   padding[64];
+        };
+        typedef vector<ThreadScratch>::type ThreadScratchVec;
+
+        ObjectMemoryManager *mObjectMemoryManager;
+        size_t              mNumThreads;
+
+        TreeVec             mTrees;
+        DirtyPackVec        mDirtyPacks;
+        ThreadScratchVec    mThreadScratch;
+
+        bool                mNeedsRebuild;
+        uint32              mLayoutVersion;
+        size_t              mTotalPacks;
+        size_t              mNumRefitPacks;
+        size_t              mNumRebuilds;
+
+        /// Calculates the bounds of all the objects in the pack.
+        /// Returns false if the pack contains objects with infinite bounds.
+        static bool calculatePackAabb( const ObjectData &objData, Aabb &outAabb, bool &outEmpty );
+
+        void rebuild(void);
+        void rebuild( Tree &tree, size_t renderQueue );
+        uint32 buildNode( Tree &tree, const vector<Vector3>::type &centroids,
+                          uint32 first, uint32 numPacks, uint32 parent );
+        void buildTaskRoots( Tree &tree );
+
+        /// Returns false if the tree needs to be rebuilt instead.
+        bool refit(void);
+
+    public:
+        StaticObjectBvh( ObjectMemoryManager *staticMemoryManager, size_t numThreads );
+        virtual ~StaticObjectBvh();
+
+        /// Called by SceneManager::notifyStaticAabbDirty.
+        void _notifyObjectDirty( MovableObject *movableObject );
+
+        /// Rebuilds or refits the tree. Called by SceneManager once the bounds have been updated.
+        void _update(void);
+
+        /** Appends the objects from renderQueue that are inside the frustum to outCulledObjects.
+            Same parameters as MovableObject::cullFrustum. Called from worker threads.
+        */
+        void cullFrustum( size_t renderQueue, const Camera *frustum, uint32 sceneVisibilityFlags,
+                          MovableObject::MovableObjectArray &outCulledObjects,
+                          const Camera *lodCamera, size_t threadIdx );
+
+        size_t getNumNodes(void) const;
+        /// Number of full rebuilds so far. Useful for profiling.
+        size_t getNumRebuilds(void) const                   { return mNumRebuilds; }
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
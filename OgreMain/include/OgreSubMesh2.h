@@ -181,8 +181,16 @@ namespace Ogre {
         void setMaterialName( const String &name )          { mMaterialName = name; }
         String getMaterialName(void) const                  { return mMaterialName; }
 
-        /// Imports a v1 SubMesh @See Mesh::importV1. Automatically performs what arrangeEfficient does.
-        void importFromV1( v1::SubMesh *subMesh, bool halfPos, bool halfTexCoords, bool qTangents );
+        struct ArrangeEfficientJob;
+
+        /** Imports a v1 SubMesh @See Mesh::importV1. Automatically performs what arrangeEfficient does.
+        @param convertedJobs
+            Optional. Array of NumVertexPass jobs whose vertex data was already converted
+            by _arrangeEfficient (i.e. in parallel by Mesh::importV1). The data is taken
+            from them instead of converting it again. Entries with null data are converted here.
+        */
+        void importFromV1( v1::SubMesh *subMesh, bool halfPos, bool halfTexCoords, bool qTangents,
+                           ArrangeEfficientJob *convertedJobs = 0 );
 
         /// Converts this SubMesh to an efficient arrangement. @See Mesh::importV1 for an
         /// explanation on the parameters. @see dearrangeEfficientToInefficient
@@ -198,29 +206,11 @@ namespace Ogre {
 
     protected:
         void importBuffersFromV1( v1::SubMesh *subMesh, bool halfPos, bool halfTexCoords, bool qTangents,
-                                  size_t vaoPassIdx );
+                                  size_t vaoPassIdx, ArrangeEfficientJob *convertedJob );
 
         /// Converts a v1 IndexBuffer to a v2 format. Returns nullptr if indexData is also nullptr
         IndexBufferPacked* importFromV1( v1::IndexData *indexData );
 
-        /** @see arrangeEfficient overload
-        @param vao
-            The Vao to convert to.
-        @param sharedBuffers
-            Maps old Vertex Buffers to the new converted ones, so we can reuse them
-            when we detect the vertex buffers were being shared across Vaos.
-            Reads and writes from/to it.
-        @param vaoManager
-            Needed to create the new Vao
-        @return
-            New Vao containing the dearranged buffers. It will share the index buffers
-            with the original vao.
-        */
-        static VertexArrayObject* arrangeEfficient( bool halfPos, bool halfTexCoords, bool qTangents,
-                                                    VertexArrayObject *vao,
-                                                    SharedVertexBufferMap &sharedBuffers,
-                                                    VaoManager *vaoManager );
-
         /** @see dearrangeEfficientToInefficient. Works on an individual VertexArrayObject.
             Delegates work to the generic method @see _dearrangeEfficient which
             performs the actual buffer conversion.
@@ -253,6 +243,49 @@ namespace Ogre {
 
         typedef FastArray<SourceData> SourceDataArray;
 
+        /// One vertex buffer to convert with _arrangeEfficient. The source data is mapped
+        /// on the main thread, so that the conversion itself can run in worker threads.
+        struct ArrangeEfficientJob
+        {
+            SourceDataArray     srcData;
+            VertexElement2Vec   vertexElements;
+            uint32              vertexCount;
+            uint8               vaoPassIdx;
+
+            /// v2 buffers only: the buffer being converted and the tickets keeping it mapped.
+            VertexBufferPacked              *srcVertexBuffer;
+            vector<AsyncTicketPtr>::type    asyncTickets;
+
+            /// Converted data. Whoever consumes it must free it, or set it to null when
+            /// taking ownership. Must be freed with OGRE_FREE_SIMD( MEMCATEGORY_GEOMETRY ).
+            char                *data;
+
+            ArrangeEfficientJob() :
+                vertexCount( 0 ), vaoPassIdx( 0 ), srcVertexBuffer( 0 ), data( 0 ) {}
+        };
+
+        typedef vector<ArrangeEfficientJob>::type ArrangeEfficientJobVec;
+        typedef FastArray<ArrangeEfficientJob*> ArrangeEfficientJobPtrArray;
+
+        /** Computes the vertex format arrangeEfficient converts to, and the srcData
+            needed by the generic _arrangeEfficient overload; from raw buffers in system
+            memory. Doesn't touch the GPU, thus it's safe to call from worker threads.
+        @param srcVertexElements
+            The vertex format of each source buffer.
+        @param srcPtrs
+            Pointer to the data of each source buffer. Must be the same size as
+            srcVertexElements.
+        @param outVertexElements [out]
+            The new, single-buffer vertex format.
+        @param outSrcData [out]
+            Array to pass to _arrangeEfficient. Points into srcPtrs.
+        */
+        static void _getEfficientFormat( const VertexElement2VecVec &srcVertexElements,
+                                         const FastArray<char const*> &srcPtrs,
+                                         bool halfPos, bool halfTexCoords, bool qTangents,
+                                         VertexElement2Vec *outVertexElements,
+                                         SourceDataArray *outSrcData );
+
         /** Rearranges the buffers to be efficiently rendered in Ogre 2.1 with Hlms
             Takes a v1 SubMesh and returns a pointer with the data interleaved,
             and a VertexElement2Vec with the new vertex format.
@@ -274,6 +307,29 @@ namespace Ogre {
                                         bool qTangents, VertexElement2Vec *outVertexElements,
                                         size_t vaoPassIdx );
 
+        /** First half of the v1 overload of _arrangeEfficient: locks the vertex buffers
+            of the v1 SubMesh for reading and fills the job's format and source data.
+            Must be called from the main thread.
+        @remarks
+            The buffers stay locked until _unlockSourceBuffers is called.
+        */
+        static void _prepareArrangeEfficient( v1::SubMesh *subMesh, bool halfPos, bool halfTexCoords,
+                                              bool qTangents, size_t vaoPassIdx,
+                                              ArrangeEfficientJob *outJob );
+
+        /// Unlocks the buffers locked by _prepareArrangeEfficient.
+        static void _unlockSourceBuffers( v1::SubMesh *subMesh, size_t vaoPassIdx );
+
+        /** Runs the generic _arrangeEfficient on each job, filling ArrangeEfficientJob::data.
+            Doesn't touch the GPU.
+        @param sceneManager
+            Optional. When present, the jobs are spread across its worker threads
+            @See SceneManager::executeUserScalableTask. Otherwise they run serially
+            on the calling thread.
+        */
+        static void _arrangeEfficient( const ArrangeEfficientJobPtrArray &jobs,
+                                       SceneManager *sceneManager );
+
         /** Generic form that does the actual job for both v1 and v2 objects. Takes
             an array of pointers to source each vertex element, and returns a
             pointer with the valid data.
@@ -317,6 +373,18 @@ namespace Ogre {
 
     protected:
         void destroyShadowMappingVaos(void);
+
+        /** First half of arrangeEfficient: maps every vertex buffer of this SubMesh
+            that needs converting and adds a job for it. Must be called from the main thread.
+        */
+        void _prepareArrangeEfficient( bool halfPos, bool halfTexCoords, bool qTangents,
+                                       ArrangeEfficientJobVec &outJobs );
+
+        /** Second half of arrangeEfficient: unmaps the source buffers, creates the
+            converted vertex buffers from the jobs (taking ownership of their data)
+            and replaces the Vaos.
+        */
+        void _finishArrangeEfficient( ArrangeEfficientJobVec &jobs );
     };
     /** @} */
     /** @} */
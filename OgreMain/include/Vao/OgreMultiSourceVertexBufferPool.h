@@ -32,6 +32,7 @@ THE SOFTWARE.
 #include "OgrePrerequisites.h"
 
 #include "Vao/OgreVertexBufferPacked.h"
+#include "Vao/OgreTlsfSubAllocator.h"
 
 namespace Ogre
 {
@@ -70,6 +71,10 @@ namespace Ogre
         vector<size_t>::type    mSourceOffset;          /// Where each source starts, in vertices
         VaoManager              *mVaoManager;
 
+        /// Manages the free vertices, in vertices (not bytes). Already accounts for
+        /// the dynamic buffer multiplier.
+        TlsfSubAllocator        mFreeVertices;
+
         virtual void destroyVertexBuffersImpl( VertexBufferPackedVec &inOutVertexBuffers ) = 0;
 
     public:
@@ -0,0 +1,190 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2017 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _Ogre_TlsfSubAllocator_H_
+#define _Ogre_TlsfSubAllocator_H_
+
+#include "OgrePrerequisites.h"
+
+namespace Ogre
+{
+    /** Two-Level Segregated Fit sub-allocator. Manages the ranges of a buffer pool (i.e. a
+        VBO of 128MB) without touching the memory itself; it only hands out offsets.
+    @remarks
+        Allocation and deallocation are O(1): free blocks are kept in segregated lists indexed
+        by a first level (power of two) and a second level (linear subdivision of that power
+        of two) and a pair of bitmaps tell which lists are non-empty. Freed blocks are merged
+        immediately with their physical neighbours, so there is never the need to scan all
+        the free blocks like the old first-fit pools did.
+    @par
+        Alignment doesn't have to be a power of two (vertex buffers are aligned to their
+        stride, i.e. 12 or 36 bytes). The padding needed to honour the alignment is returned
+        to the free lists as a regular free block, hence there is no need to remember it
+        (no more "stride changers") and deallocate only needs the offset that was returned.
+    @par
+        The offsets and sizes are in arbitrary units: the VaoManagers use bytes, while the
+        MultiSourceVertexBufferPools use vertices.
+    */
+    class _OgreExport TlsfSubAllocator
+    {
+    public:
+        struct Stats
+        {
+            /// Sum of the capacity of all the pools.
+            size_t  capacity;
+            /// Bytes currently handed out (excludes alignment padding).
+            size_t  usedBytes;
+            /// Highest value ever seen in usedBytes. When merged across pools, it's the
+            /// sum of each pool's peak; an upper bound since the pools may have peaked
+            /// at different times.
+            size_t  peakUsedBytes;
+            size_t  freeBytes;
+            size_t  numFreeBlocks;
+            size_t  largestFreeBlock;
+            /// Number of live allocations.
+            size_t  numAllocations;
+            /// Number of pools (i.e. VBOs) these stats were gathered from.
+            size_t  numPools;
+
+            Stats();
+
+            /// 1 - largestFreeBlock / freeBytes. 0 means all free memory is contiguous.
+            /// When merged across pools, uses the largest block found in any of them.
+            Real getFragmentation(void) const;
+
+            /// Accumulates the stats of another pool into these.
+            void merge( const Stats &other );
+        };
+
+    protected:
+        static const uint32 InvalidNode;
+        static const uint32 SlLog2 = 5u;
+        static const uint32 SlCount = 1u << SlLog2;
+        /// Enough to address 4GB pools.
+        static const uint32 FlCount = 32u - SlLog2 + 1u;
+
+        struct Node
+        {
+            size_t  offset;
+            size_t  size;
+            uint32  prevPhysical;
+            uint32  nextPhysical;
+            uint32  prevFree;
+            uint32  nextFree;
+            bool    isFree;
+        };
+
+        typedef vector<Node>::type NodeVec;
+        typedef unordered_map<size_t, uint32>::type OffsetToNodeMap;
+
+        NodeVec         mNodes;
+        vector<uint32>::type mUnusedNodes;
+        /// Allocated offset -> node, so that deallocation is O(1).
+        OffsetToNodeMap mAllocated;
+
+        uint32  mFlBitmap;
+        uint32  mSlBitmap[FlCount];
+        uint32  mFreeHeads[FlCount][SlCount];
+
+        size_t  mCapacity;
+        size_t  mUsedBytes;
+        size_t  mPeakUsedBytes;
+        size_t  mNumFreeBlocks;
+
+        static void mappingInsert( size_t size, uint32 &outFl, uint32 &outSl );
+        static void mappingSearch( size_t size, uint32 &outFl, uint32 &outSl );
+
+        uint32 createNode( size_t offset, size_t size );
+        void releaseNode( uint32 nodeIdx );
+
+        void insertFreeNode( uint32 nodeIdx );
+        void removeFreeNode( uint32 nodeIdx );
+
+        /// Returns InvalidNode if there is no free block at least as big as 'size'
+        /// in the lists at or above the class 'size' maps to.
+        uint32 findSuitableNode( size_t size ) const;
+
+        /** Marks [offset; offset + sizeBytes) of the free node as used, returning the
+            leading and trailing excess to the free lists.
+        */
+        void carve( uint32 nodeIdx, size_t offset, size_t sizeBytes );
+
+    public:
+        /// Returned by allocate when the request can't be honoured.
+        static const size_t NoSpace;
+
+        TlsfSubAllocator();
+
+        /** Discards all allocations and manages a new range [0; capacity).
+        @param capacity
+            Must be less than 4GB.
+        */
+        void initialize( size_t capacity );
+
+        /** Allocates a range.
+        @param sizeBytes
+            Must be greater than 0.
+        @param alignment
+            The returned offset will be a multiple of this value. Needs not be a power of 2.
+        @return
+            The start of the range, or NoSpace if there is no free block big enough.
+        */
+        size_t allocate( size_t sizeBytes, size_t alignment );
+
+        /** Allocates the exact range [offset; offset + sizeBytes). Not O(1), it walks the
+            blocks (newest first, so packing ranges in increasing order is fast). Useful when
+            the layout was decided outside the allocator (i.e. D3D11 immutable buffers,
+            which are packed before being created).
+        @return
+            False if the range isn't entirely free.
+        */
+        bool allocateAt( size_t offset, size_t sizeBytes );
+
+        /** Releases a range returned by allocate or allocateAt.
+        @param sizeBytes
+            Only used for validation. Must match the size that was requested.
+        */
+        void deallocate( size_t offset, size_t sizeBytes );
+
+        size_t getCapacity(void) const          { return mCapacity; }
+        size_t getUsedBytes(void) const         { return mUsedBytes; }
+        size_t getPeakUsedBytes(void) const     { return mPeakUsedBytes; }
+        size_t getNumFreeBlocks(void) const     { return mNumFreeBlocks; }
+        size_t getNumAllocations(void) const    { return mAllocated.size(); }
+        /// True when there are no live allocations.
+        bool isEmpty(void) const                { return mAllocated.empty(); }
+
+        /// Size of the largest free block. Only walks the highest non-empty free list.
+        size_t getLargestFreeBlock(void) const;
+
+        /// Fills outStats with this pool's values (overwrites, doesn't merge).
+        void getStats( Stats &outStats ) const;
+    };
+}
+
+#endif
@@ -33,6 +33,7 @@ THE SOFTWARE.
 
 #include "Vao/OgreVertexBufferPacked.h"
 #include "Vao/OgreIndexBufferPacked.h"
+#include "Vao/OgreTlsfSubAllocator.h"
 #include "OgreRenderOperation.h"
 #include "OgrePixelFormat.h"
 
@@ -448,6 +449,25 @@ namespace Ogre
 
         /// If this returns true, then waitForSpecificFrameToFinish is guaranteed to return immediately.
         virtual bool isFrameFinished( uint32 frameCount ) = 0;
+
+        typedef TlsfSubAllocator::Stats MemoryStats;
+
+        /** Retrieves how the pools that back buffers of the given type are being used:
+            capacity, used and peak bytes, free blocks, largest free block (and therefore
+            fragmentation) and number of live allocations, merged across all the pools.
+        @remarks
+            Buffer types that share the same pools report the same values: BT_IMMUTABLE &
+            BT_DEFAULT share their pools in GL3+, Metal & NULL; while D3D11 keeps those two
+            apart but shares all the BT_DYNAMIC_* types since it doesn't support persistent
+            mapping.
+            Buffers that aren't sub-allocated from the pools (i.e. staging buffers, or
+            D3D11 immutable buffers that haven't been created yet) are not included.
+        @par
+            The default implementation returns all zeroes.
+        @param outStats [out]
+            Overwritten with the stats.
+        */
+        virtual void getMemoryStats( BufferType bufferType, MemoryStats &outStats ) const;
     };
 }
 
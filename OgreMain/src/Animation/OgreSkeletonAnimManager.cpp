@@ -104,6 +104,7 @@ namespace Ogre
         FastArray<SkeletonInstance*> &skeletonsArray = bySkelDef.skeletons;
         SkeletonInstance *newInstance = OGRE_NEW SkeletonInstance( skeletonDef,
                                                                     &bySkelDef.boneMemoryManager );
+        newInstance->_setAnimationLodPhase( static_cast<uint16>( skeletonsArray.size() ) );
         FastArray<SkeletonInstance*>::iterator it = std::lower_bound(
                                                             skeletonsArray.begin(), skeletonsArray.end(),
                                                             newInstance,
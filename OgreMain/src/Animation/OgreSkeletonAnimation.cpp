@@ -195,7 +195,8 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
-    void SkeletonAnimation::_applyAnimation( const TransformArray &boneTransforms )
+    void SkeletonAnimation::_applyAnimation( const TransformArray &boneTransforms,
+                                             size_t numDepthLevels )
     {
         SkeletonTrackVec::const_iterator itor = mDefinition->mTracks.begin();
         SkeletonTrackVec::const_iterator end  = mDefinition->mTracks.end();
@@ -207,8 +208,11 @@ namespace Ogre
 
         while( itor != end )
         {
-            itor->applyKeyFrameRigAt( *itLastKnownKeyFrame, mCurrentFrame, simdWeight,
-                                        boneWeights, boneTransforms );
+            if( (itor->getBoneBlockIdx() >> 24) < numDepthLevels )
+            {
+                itor->applyKeyFrameRigAt( *itLastKnownKeyFrame, mCurrentFrame, simdWeight,
+                                          boneWeights, boneTransforms );
+            }
             ++itLastKnownKeyFrame;
             ++boneWeights;
             ++itor;
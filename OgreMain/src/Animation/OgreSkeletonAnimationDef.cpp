@@ -41,6 +41,7 @@ THE SOFTWARE.
 #include "OgreKeyFrame.h"
 #include "OgreSkeleton.h"
 #include "OgreStringConverter.h"
+#include "OgreTimer.h"
 
 namespace Ogre
 {
@@ -204,6 +205,151 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    /// Samples every track at each of the given frames, a few times. Returns microseconds.
+    static uint64 sampleAllTracks( const SkeletonTrackVec &tracks,
+                                   const vector< vector<Real>::type >::type &framesPerTrack )
+    {
+        const size_t numPasses = 8u;
+
+        Timer timer;
+        KfTransform transform;
+        for( size_t pass=0; pass<numPasses; ++pass )
+        {
+            for( size_t i=0; i<tracks.size(); ++i )
+            {
+                const vector<Real>::type &frames = framesPerTrack[i];
+                for( size_t j=0; j<frames.size(); ++j )
+                    tracks[i]._getInterpolatedTransform( frames[j], transform );
+            }
+        }
+
+        return timer.getMicroseconds();
+    }
+    //-----------------------------------------------------------------------------------
+    KfCompressionReport SkeletonAnimationDef::compress( const KfCompressionSettings &settings )
+    {
+        KfCompressionReport report;
+
+        if( mCompressedData.get() || mTracks.empty() )
+            return report;
+
+        //Keep the original keyframes around to measure the error (their KfTransforms
+        //are still alive in mKfTransformMemoryManager until we're done)
+        vector<KeyFrameRigVec>::type originalKeyFrames;
+        vector<TimestampVec>::type framesPerTrack;
+
+        SkeletonTrackVec::iterator itor = mTracks.begin();
+        SkeletonTrackVec::iterator end  = mTracks.end();
+
+        while( itor != end )
+        {
+            const KeyFrameRigVec &keyFrames = itor->getKeyFrames();
+            report.numKeyFramesBefore += keyFrames.size();
+
+            if( settings.measure )
+            {
+                originalKeyFrames.push_back( keyFrames );
+                framesPerTrack.push_back( TimestampVec() );
+                framesPerTrack.back().reserve( keyFrames.size() );
+                for( size_t i=0; i<keyFrames.size(); ++i )
+                    framesPerTrack.back().push_back( keyFrames[i].mFrame );
+            }
+
+            ++itor;
+        }
+
+        report.uncompressedBytes = report.numKeyFramesBefore * sizeof(KfTransform);
+        if( settings.measure )
+            report.uncompressedSampleTimeUs = sampleAllTracks( mTracks, framesPerTrack );
+
+        if( settings.removeKeyFrames )
+        {
+            for( itor = mTracks.begin(); itor != end; ++itor )
+                itor->_removeRedundantKeyFrames( settings );
+        }
+
+        size_t totalBytes = 0;
+        for( itor = mTracks.begin(); itor != end; ++itor )
+        {
+            totalBytes += itor->_calculateCompressedSize( settings );
+            report.numKeyFramesAfter += itor->getKeyFrames().size();
+        }
+
+        RawSimdUniquePtr<uint8, MEMCATEGORY_ANIMATION> compressedData( totalBytes );
+        mCompressedData.swap( compressedData );
+
+        uint8 *dst = mCompressedData.get();
+        for( itor = mTracks.begin(); itor != end; ++itor )
+        {
+            const size_t trackBytes = itor->_calculateCompressedSize( settings );
+            report.numConstantChannels += itor->_compress( settings, dst );
+            report.numChannels += 3u;
+            dst += trackBytes;
+        }
+
+        report.compressedBytes = totalBytes;
+        if( settings.measure )
+            report.compressedSampleTimeUs = sampleAllTracks( mTracks, framesPerTrack );
+
+        //Measure the error against the original keyframes
+        for( size_t i=0; i<originalKeyFrames.size(); ++i )
+        {
+            const SkeletonTrack &track = mTracks[i];
+            const KeyFrameRigVec &keyFrames = originalKeyFrames[i];
+
+            KeyFrameRigVec::const_iterator itKeys = keyFrames.begin();
+            KeyFrameRigVec::const_iterator enKeys = keyFrames.end();
+
+            while( itKeys != enKeys )
+            {
+                KfTransform decoded;
+                track._getInterpolatedTransform( itKeys->mFrame, decoded );
+
+                for( size_t j=0; j<track.getUsedSlots(); ++j )
+                {
+                    Vector3 vA, vB;
+                    Quaternion qA, qB;
+
+                    itKeys->mBoneTransform->mPosition.getAsVector3( vA, j );
+                    decoded.mPosition.getAsVector3( vB, j );
+                    vA -= vB;
+                    report.maxPositionError = std::max( report.maxPositionError,
+                                                        std::max( std::max( Math::Abs( vA.x ),
+                                                                            Math::Abs( vA.y ) ),
+                                                                  Math::Abs( vA.z ) ) );
+
+                    itKeys->mBoneTransform->mScale.getAsVector3( vA, j );
+                    decoded.mScale.getAsVector3( vB, j );
+                    vA -= vB;
+                    report.maxScaleError = std::max( report.maxScaleError,
+                                                     std::max( std::max( Math::Abs( vA.x ),
+                                                                         Math::Abs( vA.y ) ),
+                                                               Math::Abs( vA.z ) ) );
+
+                    itKeys->mBoneTransform->mOrientation.getAsQuaternion( qA, j );
+                    decoded.mOrientation.getAsQuaternion( qB, j );
+                    qA.normalise();
+                    if( qA.Dot( qB ) < 0 )
+                        qB = -qB;
+                    qA = qA - qB;
+                    report.maxOrientationError = std::max(
+                                report.maxOrientationError,
+                                std::max( std::max( Math::Abs( qA.w ), Math::Abs( qA.x ) ),
+                                          std::max( Math::Abs( qA.y ), Math::Abs( qA.z ) ) ) );
+                }
+
+                ++itKeys;
+            }
+        }
+
+        //The uncompressed keyframes are no longer referenced
+        mKfTransformMemoryManager->destroy();
+        delete mKfTransformMemoryManager;
+        mKfTransformMemoryManager = 0;
+
+        return report;
+    }
+    //-----------------------------------------------------------------------------------
     void SkeletonAnimationDef::getInterpolatedUnnormalizedKeyFrame( v1::OldNodeAnimationTrack *oldTrack,
                                                                     const v1::TimeIndex& timeIndex,
                                                                     v1::TransformKeyFrame* kf )
@@ -403,7 +549,10 @@ namespace Ogre
                         outText += StringConverter::toString( itKeyFrames->mFrame );
                         outText += ",";
 
-                        const KfTransform * RESTRICT_ALIAS boneTransform = itKeyFrames->mBoneTransform;
+                        KfTransform boneTransformTmp;
+                        track._getKeyFrameTransform( itKeyFrames - keyFrames.begin(),
+                                                     boneTransformTmp );
+                        const KfTransform * RESTRICT_ALIAS boneTransform = &boneTransformTmp;
 
                         Vector3 vPos, vScale;
                         Quaternion qRot;
@@ -38,6 +38,10 @@ THE SOFTWARE.
 
 #include "OgreOldBone.h"
 #include "OgreSkeleton.h"
+#include "OgreLogManager.h"
+#include "OgreStringConverter.h"
+#include "OgreLodStrategyManager.h"
+#include "OgreLodStrategy.h"
 
 namespace Ogre
 {
@@ -310,6 +314,79 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    KfCompressionReport SkeletonDef::compressAnimations( const KfCompressionSettings &settings )
+    {
+        KfCompressionReport report;
+
+        SkeletonAnimationDefVec::iterator itor = mAnimationDefs.begin();
+        SkeletonAnimationDefVec::iterator end  = mAnimationDefs.end();
+
+        while( itor != end )
+        {
+            report += itor->compress( settings );
+            ++itor;
+        }
+
+        if( report.numKeyFramesBefore > 0 )
+        {
+            LogManager::getSingleton().logMessage(
+                        "Compressed animations of skeleton '" + mName + "': " +
+                        StringConverter::toString( report.uncompressedBytes / 1024u ) + " KB -> " +
+                        StringConverter::toString( report.compressedBytes / 1024u ) + " KB. Keyframes: " +
+                        StringConverter::toString( report.numKeyFramesBefore ) + " -> " +
+                        StringConverter::toString( report.numKeyFramesAfter ) + ". Constant channels: " +
+                        StringConverter::toString( report.numConstantChannels ) + "/" +
+                        StringConverter::toString( report.numChannels ) + ". Max error (pos/rot/scale): " +
+                        StringConverter::toString( report.maxPositionError ) + "/" +
+                        StringConverter::toString( report.maxOrientationError ) + "/" +
+                        StringConverter::toString( report.maxScaleError ) + ". Sampling time: " +
+                        StringConverter::toString( (size_t)report.uncompressedSampleTimeUs ) + "us -> " +
+                        StringConverter::toString( (size_t)report.compressedSampleTimeUs ) + "us" );
+        }
+
+        return report;
+    }
+    //-----------------------------------------------------------------------------------
+    static bool OrderAnimationLodByValue( const SkeletonDef::AnimationLod &_l,
+                                          const SkeletonDef::AnimationLod &_r )
+    {
+        return _l.lodValue < _r.lodValue;
+    }
+    static bool OrderValueByAnimationLod( Real lodValue, const SkeletonDef::AnimationLod &_r )
+    {
+        return lodValue < _r.lodValue;
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonDef::setAnimationLodLevels( const AnimationLodVec &lodLevels )
+    {
+        const LodStrategy *lodStrategy = LodStrategyManager::getSingleton().getDefaultStrategy();
+
+        mAnimationLods = lodLevels;
+
+        AnimationLodVec::iterator itor = mAnimationLods.begin();
+        AnimationLodVec::iterator end  = mAnimationLods.end();
+
+        while( itor != end )
+        {
+            itor->lodValue = lodStrategy->transformUserValue( itor->lodValue );
+            itor->updateInterval = std::max<uint16>( itor->updateInterval, 1u );
+            ++itor;
+        }
+
+        std::sort( mAnimationLods.begin(), mAnimationLods.end(), OrderAnimationLodByValue );
+    }
+    //-----------------------------------------------------------------------------------
+    const SkeletonDef::AnimationLod* SkeletonDef::getAnimationLod( Real lodValue ) const
+    {
+        AnimationLodVec::const_iterator itor = std::upper_bound( mAnimationLods.begin(),
+                                                                 mAnimationLods.end(),
+                                                                 lodValue, OrderValueByAnimationLod );
+        if( itor == mAnimationLods.begin() )
+            return 0;
+
+        return &(*(itor - 1));
+    }
+    //-----------------------------------------------------------------------------------
     void SkeletonDef::getBonesPerDepth( vector<size_t>::type &out ) const
     {
         out.clear();
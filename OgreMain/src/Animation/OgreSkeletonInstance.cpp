@@ -45,6 +45,9 @@ namespace Ogre
                                         BoneMemoryManager *boneMemoryManager ) :
             mDefinition( skeletonDef ),
             mParentNode( 0 ),
+            mLodSource( 0 ),
+            mLodValue( -std::numeric_limits<Real>::max() ),
+            mAnimationLodPhase( 0 ),
             mRefCount( 1 )
     {
         mBones.resize( mDefinition->getBones().size(), Bone() );
@@ -233,21 +236,51 @@ namespace Ogre
     }
     //-----------------------------------------------------------------------------------
     void SkeletonInstance::update(void)
+    {
+        applyAnimations( mBoneStartTransforms.size() );
+    }
+    //-----------------------------------------------------------------------------------
+    bool SkeletonInstance::_updateWithLod( uint32 frameCount )
+    {
+        const SkeletonDef::AnimationLod *animationLod = 0;
+        if( mLodSource )
+            animationLod = mDefinition->getAnimationLod( mLodValue );
+
+        if( !animationLod )
+        {
+            update();
+            return true;
+        }
+
+        if( (frameCount + mAnimationLodPhase) % animationLod->updateInterval )
+            return false;
+
+        applyAnimations( std::min<size_t>( animationLod->numDepthLevels,
+                                           mBoneStartTransforms.size() ) );
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonInstance::applyAnimations( size_t numDepthLevels )
     {
         if( !mActiveAnimations.empty() )
-            resetToPose();
+            resetToPose( numDepthLevels );
 
         ActiveAnimationsVec::iterator itor = mActiveAnimations.begin();
         ActiveAnimationsVec::iterator end  = mActiveAnimations.end();
 
         while( itor != end )
         {
-            (*itor)->_applyAnimation( mBoneStartTransforms );
+            (*itor)->_applyAnimation( mBoneStartTransforms, numDepthLevels );
             ++itor;
         }
     }
     //-----------------------------------------------------------------------------------
     void SkeletonInstance::resetToPose(void)
+    {
+        resetToPose( mBoneStartTransforms.size() );
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonInstance::resetToPose( size_t numDepthLevels )
     {
         KfTransform const * RESTRICT_ALIAS bindPose = mDefinition->getBindPose();
         ArrayReal const * RESTRICT_ALIAS manualBones = mManualBones.get();
@@ -256,7 +289,7 @@ namespace Ogre
                                                 mDefinition->getDepthLevelInfo().begin();
 
         TransformArray::iterator itor = mBoneStartTransforms.begin();
-        TransformArray::iterator end  = mBoneStartTransforms.end();
+        TransformArray::iterator end  = mBoneStartTransforms.begin() + numDepthLevels;
 
         while( itor != end )
         {
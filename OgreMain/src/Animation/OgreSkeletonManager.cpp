@@ -45,7 +45,8 @@ namespace Ogre
         assert( msSingleton );  return ( *msSingleton );  
     }
     //-----------------------------------------------------------------------
-    SkeletonManager::SkeletonManager()
+    SkeletonManager::SkeletonManager() :
+        mCompressAnimations( false )
     {
     }
     //-----------------------------------------------------------------------
@@ -62,6 +63,8 @@ namespace Ogre
         {
             oldSkeletonBase->load();
             retVal = SkeletonDefPtr( new SkeletonDef( oldSkeletonBase, 1.0f ) );
+            if( mCompressAnimations )
+                retVal->compressAnimations( mCompressionSettings );
             mSkeletonDefs[idName] = retVal;
         }
         else
@@ -95,6 +98,8 @@ namespace Ogre
             if( oldSkeleton->isLoaded() )
             {
                 retVal = SkeletonDefPtr( new SkeletonDef( oldSkeleton.get(), 1.0f ) );
+                if( mCompressAnimations )
+                    retVal->compressAnimations( mCompressionSettings );
                 if( wasUnloaded )
                     oldSkeleton->unload();
                 if( wasNonExistent )
@@ -111,6 +116,13 @@ namespace Ogre
         return retVal;
     }
     //-----------------------------------------------------------------------
+    void SkeletonManager::setAnimationCompression( bool bCompress,
+                                                   const KfCompressionSettings &settings )
+    {
+        mCompressAnimations = bCompress;
+        mCompressionSettings = settings;
+    }
+    //-----------------------------------------------------------------------
     void SkeletonManager::add( SkeletonDefPtr skeletonDef )
     {
         IdString idName( skeletonDef->getNameStr() );
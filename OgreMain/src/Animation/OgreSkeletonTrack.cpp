@@ -36,15 +36,84 @@ THE SOFTWARE.
 
 #include "OgreException.h"
 
+#if OGRE_USE_SIMD == 1 && OGRE_CPU == OGRE_CPU_X86 && OGRE_DOUBLE_PRECISION == 0
+    #define OGRE_KF_DECODE_SSE2 1
+#else
+    #define OGRE_KF_DECODE_SSE2 0
+#endif
+
 namespace Ogre
 {
+    /// Orientations are stored as the smallest three components, which are in
+    /// range [-1 / sqrt( 2 ); 1 / sqrt( 2 )]
+    static const Real c_kfOrientationQuantScale = Real( 32767.0 * 1.41421356237309504880 );
+    static const Real c_kfInvOrientationQuantScale = Real( 1.0 ) / c_kfOrientationQuantScale;
+
+#if OGRE_KF_DECODE_SSE2
+    static inline ArrayReal kfLoadU16( const uint16 *src )
+    {
+        __m128i v = _mm_loadl_epi64( reinterpret_cast<const __m128i*>( src ) );
+        return _mm_cvtepi32_ps( _mm_unpacklo_epi16( v, _mm_setzero_si128() ) );
+    }
+    static inline ArrayReal kfLoadS16( const int16 *src )
+    {
+        __m128i v = _mm_loadl_epi64( reinterpret_cast<const __m128i*>( src ) );
+        //Place the value in the upper 16 bits then shift back to sign extend
+        return _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpacklo_epi16( _mm_setzero_si128(), v ), 16 ) );
+    }
+    static inline ArrayMaskR kfLargestIs( __m128i largestIdx, int value )
+    {
+        return _mm_castsi128_ps( _mm_cmpeq_epi32( largestIdx, _mm_set1_epi32( value ) ) );
+    }
+    /// mask ? a : b
+    static inline ArrayReal kfSelect( ArrayMaskR mask, ArrayReal a, ArrayReal b )
+    {
+        return _mm_or_ps( _mm_and_ps( mask, a ), _mm_andnot_ps( mask, b ) );
+    }
+#endif
+    //-----------------------------------------------------------------------------------
+    KfCompressionReport::KfCompressionReport() :
+        uncompressedBytes( 0 ),
+        compressedBytes( 0 ),
+        numKeyFramesBefore( 0 ),
+        numKeyFramesAfter( 0 ),
+        numChannels( 0 ),
+        numConstantChannels( 0 ),
+        maxPositionError( 0 ),
+        maxOrientationError( 0 ),
+        maxScaleError( 0 ),
+        uncompressedSampleTimeUs( 0 ),
+        compressedSampleTimeUs( 0 )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    KfCompressionReport& KfCompressionReport::operator += ( const KfCompressionReport &other )
+    {
+        uncompressedBytes           += other.uncompressedBytes;
+        compressedBytes             += other.compressedBytes;
+        numKeyFramesBefore          += other.numKeyFramesBefore;
+        numKeyFramesAfter           += other.numKeyFramesAfter;
+        numChannels                 += other.numChannels;
+        numConstantChannels         += other.numConstantChannels;
+        maxPositionError            = std::max( maxPositionError, other.maxPositionError );
+        maxOrientationError         = std::max( maxOrientationError, other.maxOrientationError );
+        maxScaleError               = std::max( maxScaleError, other.maxScaleError );
+        uncompressedSampleTimeUs    += other.uncompressedSampleTimeUs;
+        compressedSampleTimeUs      += other.compressedSampleTimeUs;
+        return *this;
+    }
+    //-----------------------------------------------------------------------------------
     SkeletonTrack::SkeletonTrack( uint32 boneBlockIdx,
                                     KfTransformArrayMemoryManager *kfTransformMemoryManager ) :
         mKeyFrameRigs( 0 ),
         mNumFrames( 0 ),
         mBoneBlockIdx( boneBlockIdx ),
         mUsedSlots( 0 ),
-        mLocalMemoryManager( kfTransformMemoryManager )
+        mLocalMemoryManager( kfTransformMemoryManager ),
+        mCompressedHeader( 0 ),
+        mCompressedKeyFrames( 0 ),
+        mCompressedStride( 0 ),
+        mAnimatedChannels( KfChannelPosition|KfChannelOrientation|KfChannelScale )
     {
     }
     //-----------------------------------------------------------------------------------
@@ -118,6 +187,179 @@ namespace Ogre
         outNextFrame    = nextFrame;
     }
     //-----------------------------------------------------------------------------------
+    inline void SkeletonTrack::decodeKeyFrame( size_t keyFrameIdx, KfTransform &outTransform ) const
+    {
+        const KfCompressedHeader * RESTRICT_ALIAS header = mCompressedHeader;
+        const uint8 * RESTRICT_ALIAS data = mCompressedKeyFrames + keyFrameIdx * mCompressedStride;
+
+#if OGRE_KF_DECODE_SSE2
+        if( mAnimatedChannels & KfChannelPosition )
+        {
+            const uint16 *quantized = reinterpret_cast<const uint16*>( data );
+            for( size_t i=0; i<3u; ++i )
+            {
+                outTransform.mPosition.mChunkBase[i] =
+                        _mm_madd_ps( kfLoadU16( quantized + i * ARRAY_PACKED_REALS ),
+                                     header->positionStep.mChunkBase[i],
+                                     header->positionMin.mChunkBase[i] );
+            }
+            data += 3u * ARRAY_PACKED_REALS * sizeof(uint16);
+        }
+        else
+        {
+            outTransform.mPosition = header->constantTransform.mPosition;
+        }
+
+        if( mAnimatedChannels & KfChannelScale )
+        {
+            const uint16 *quantized = reinterpret_cast<const uint16*>( data );
+            for( size_t i=0; i<3u; ++i )
+            {
+                outTransform.mScale.mChunkBase[i] =
+                        _mm_madd_ps( kfLoadU16( quantized + i * ARRAY_PACKED_REALS ),
+                                     header->scaleStep.mChunkBase[i],
+                                     header->scaleMin.mChunkBase[i] );
+            }
+            data += 3u * ARRAY_PACKED_REALS * sizeof(uint16);
+        }
+        else
+        {
+            outTransform.mScale = header->constantTransform.mScale;
+        }
+
+        if( mAnimatedChannels & KfChannelOrientation )
+        {
+            const int16 *quantized = reinterpret_cast<const int16*>( data );
+            const ArrayReal invScale = _mm_set1_ps( c_kfInvOrientationQuantScale );
+            const ArrayReal a = _mm_mul_ps( kfLoadS16( quantized ), invScale );
+            const ArrayReal b = _mm_mul_ps( kfLoadS16( quantized + ARRAY_PACKED_REALS ), invScale );
+            const ArrayReal c = _mm_mul_ps( kfLoadS16( quantized + ARRAY_PACKED_REALS * 2u ),
+                                            invScale );
+
+            //The dropped component is always positive: d = sqrt( 1 - a² - b² - c² )
+            ArrayReal d = _mm_sub_ps( Mathlib::ONE, _mm_mul_ps( a, a ) );
+            d = _mm_nmsub_ps( b, b, d );
+            d = _mm_nmsub_ps( c, c, d );
+            d = _mm_sqrt_ps( _mm_max_ps( d, _mm_setzero_ps() ) );
+
+            int32 largestBytes;
+            memcpy( &largestBytes, data + 3u * ARRAY_PACKED_REALS * sizeof(int16), sizeof(int32) );
+            __m128i largestIdx = _mm_cvtsi32_si128( largestBytes );
+            largestIdx = _mm_unpacklo_epi8( largestIdx, _mm_setzero_si128() );
+            largestIdx = _mm_unpacklo_epi16( largestIdx, _mm_setzero_si128() );
+
+            const ArrayMaskR isW = kfLargestIs( largestIdx, 0 );
+            const ArrayMaskR isX = kfLargestIs( largestIdx, 1 );
+            const ArrayMaskR isY = kfLargestIs( largestIdx, 2 );
+            const ArrayMaskR isZ = kfLargestIs( largestIdx, 3 );
+
+            //The three stored components are the remaining ones, in wxyz order.
+            outTransform.mOrientation.mChunkBase[0] = kfSelect( isW, d, a );
+            outTransform.mOrientation.mChunkBase[1] = kfSelect( isW, a, kfSelect( isX, d, b ) );
+            outTransform.mOrientation.mChunkBase[2] = kfSelect( isY, d, kfSelect( isZ, c, b ) );
+            outTransform.mOrientation.mChunkBase[3] = kfSelect( isZ, d, c );
+        }
+        else
+        {
+            outTransform.mOrientation = header->constantTransform.mOrientation;
+        }
+#else
+        const Real * RESTRICT_ALIAS posMin  = reinterpret_cast<const Real*>(
+                                                        header->positionMin.mChunkBase );
+        const Real * RESTRICT_ALIAS posStep = reinterpret_cast<const Real*>(
+                                                        header->positionStep.mChunkBase );
+        const Real * RESTRICT_ALIAS scaleMin  = reinterpret_cast<const Real*>(
+                                                        header->scaleMin.mChunkBase );
+        const Real * RESTRICT_ALIAS scaleStep = reinterpret_cast<const Real*>(
+                                                        header->scaleStep.mChunkBase );
+
+        if( mAnimatedChannels & KfChannelPosition )
+        {
+            const uint16 *quantized = reinterpret_cast<const uint16*>( data );
+            Real * RESTRICT_ALIAS dst = reinterpret_cast<Real*>( outTransform.mPosition.mChunkBase );
+            for( size_t i=0; i<3u * ARRAY_PACKED_REALS; ++i )
+                dst[i] = posMin[i] + Real( quantized[i] ) * posStep[i];
+            data += 3u * ARRAY_PACKED_REALS * sizeof(uint16);
+        }
+        else
+        {
+            outTransform.mPosition = header->constantTransform.mPosition;
+        }
+
+        if( mAnimatedChannels & KfChannelScale )
+        {
+            const uint16 *quantized = reinterpret_cast<const uint16*>( data );
+            Real * RESTRICT_ALIAS dst = reinterpret_cast<Real*>( outTransform.mScale.mChunkBase );
+            for( size_t i=0; i<3u * ARRAY_PACKED_REALS; ++i )
+                dst[i] = scaleMin[i] + Real( quantized[i] ) * scaleStep[i];
+            data += 3u * ARRAY_PACKED_REALS * sizeof(uint16);
+        }
+        else
+        {
+            outTransform.mScale = header->constantTransform.mScale;
+        }
+
+        if( mAnimatedChannels & KfChannelOrientation )
+        {
+            const int16 *quantized = reinterpret_cast<const int16*>( data );
+            const uint8 *largestIdx = data + 3u * ARRAY_PACKED_REALS * sizeof(int16);
+            //wxyz are laid out as consecutive SoA chunks in all ArrayQuaternion implementations
+            Real * RESTRICT_ALIAS dst = reinterpret_cast<Real*>( &outTransform.mOrientation );
+            for( size_t i=0; i<ARRAY_PACKED_REALS; ++i )
+            {
+                Real smallest[3];
+                Real sqLength = 0;
+                for( size_t j=0; j<3u; ++j )
+                {
+                    smallest[j] = Real( quantized[j * ARRAY_PACKED_REALS + i] ) *
+                                  c_kfInvOrientationQuantScale;
+                    sqLength += smallest[j] * smallest[j];
+                }
+
+                const size_t largest = largestIdx[i];
+                size_t k = 0;
+                for( size_t j=0; j<4u; ++j )
+                {
+                    dst[j * ARRAY_PACKED_REALS + i] = j == largest ?
+                                Math::Sqrt( std::max( Real( 1 ) - sqLength, Real( 0 ) ) ) :
+                                smallest[k++];
+                }
+            }
+        }
+        else
+        {
+            outTransform.mOrientation = header->constantTransform.mOrientation;
+        }
+#endif
+    }
+    //-----------------------------------------------------------------------------------
+    inline void SkeletonTrack::getKeyFrameTransforms( KeyFrameRigVec::const_iterator prevFrame,
+                                                      KeyFrameRigVec::const_iterator nextFrame,
+                                                      KfTransform &tmpPrev, KfTransform &tmpNext,
+                                                      KfTransform const * RESTRICT_ALIAS &outPrev,
+                                                      KfTransform const * RESTRICT_ALIAS &outNext ) const
+    {
+        if( !mCompressedHeader )
+        {
+            outPrev = prevFrame->mBoneTransform;
+            outNext = nextFrame->mBoneTransform;
+        }
+        else
+        {
+            decodeKeyFrame( prevFrame - mKeyFrameRigs.begin(), tmpPrev );
+            outPrev = &tmpPrev;
+            if( nextFrame != prevFrame )
+            {
+                decodeKeyFrame( nextFrame - mKeyFrameRigs.begin(), tmpNext );
+                outNext = &tmpNext;
+            }
+            else
+            {
+                outNext = &tmpPrev;
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
     void SkeletonTrack::applyKeyFrameRigAt( KeyFrameRigVec::const_iterator &inOutLastKnownKeyFrameRig,
                                             float frame, ArrayReal animWeight,
                                             const ArrayReal * RESTRICT_ALIAS perBoneWeights,
@@ -137,8 +379,10 @@ namespace Ogre
         ArrayVector3 * RESTRICT_ALIAS finalScale    = boneTransforms[level].mScale + offset;
         ArrayQuaternion * RESTRICT_ALIAS finalRot   = boneTransforms[level].mOrientation + offset;
 
-        KfTransform * RESTRICT_ALIAS prevTransf = prevFrame->mBoneTransform;
-        KfTransform * RESTRICT_ALIAS nextTransf = nextFrame->mBoneTransform;
+        KfTransform decodedPrev, decodedNext;
+        KfTransform const * RESTRICT_ALIAS prevTransf;
+        KfTransform const * RESTRICT_ALIAS nextTransf;
+        getKeyFrameTransforms( prevFrame, nextFrame, decodedPrev, decodedNext, prevTransf, nextTransf );
 
         ArrayVector3 interpPos, interpScale;
         ArrayQuaternion interpRot;
@@ -191,4 +435,340 @@ namespace Ogre
             }
         }
     }
+    //-----------------------------------------------------------------------------------
+    static inline Real kfVectorError( const Vector3 &a, const Vector3 &b )
+    {
+        return std::max( std::max( Math::Abs( a.x - b.x ), Math::Abs( a.y - b.y ) ),
+                         Math::Abs( a.z - b.z ) );
+    }
+    //-----------------------------------------------------------------------------------
+    static inline Real kfQuaternionError( Quaternion a, Quaternion b )
+    {
+        a.normalise();
+        b.normalise();
+        if( a.Dot( b ) < 0 )
+            b = -b;
+        return std::max( std::max( Math::Abs( a.w - b.w ), Math::Abs( a.x - b.x ) ),
+                         std::max( Math::Abs( a.y - b.y ), Math::Abs( a.z - b.z ) ) );
+    }
+    //-----------------------------------------------------------------------------------
+    uint8 SkeletonTrack::getAnimatedChannels( const KfCompressionSettings &settings ) const
+    {
+        uint8 retVal = 0;
+
+        if( mKeyFrameRigs.empty() )
+            return retVal;
+
+        const KfTransform &first = *mKeyFrameRigs.front().mBoneTransform;
+
+        KeyFrameRigVec::const_iterator itor = mKeyFrameRigs.begin() + 1;
+        KeyFrameRigVec::const_iterator end  = mKeyFrameRigs.end();
+
+        while( itor != end )
+        {
+            for( size_t i=0; i<mUsedSlots; ++i )
+            {
+                Vector3 vA, vB;
+                Quaternion qA, qB;
+
+                first.mPosition.getAsVector3( vA, i );
+                itor->mBoneTransform->mPosition.getAsVector3( vB, i );
+                if( kfVectorError( vA, vB ) > settings.positionTolerance )
+                    retVal |= KfChannelPosition;
+
+                first.mScale.getAsVector3( vA, i );
+                itor->mBoneTransform->mScale.getAsVector3( vB, i );
+                if( kfVectorError( vA, vB ) > settings.scaleTolerance )
+                    retVal |= KfChannelScale;
+
+                first.mOrientation.getAsQuaternion( qA, i );
+                itor->mBoneTransform->mOrientation.getAsQuaternion( qB, i );
+                if( kfQuaternionError( qA, qB ) > settings.orientationTolerance )
+                    retVal |= KfChannelOrientation;
+            }
+
+            ++itor;
+        }
+
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------------
+    uint32 SkeletonTrack::getCompressedStride( uint8 animatedChannels )
+    {
+        uint32 stride = 0;
+        if( animatedChannels & KfChannelPosition )
+            stride += 3u * ARRAY_PACKED_REALS * sizeof(uint16);
+        if( animatedChannels & KfChannelScale )
+            stride += 3u * ARRAY_PACKED_REALS * sizeof(uint16);
+        if( animatedChannels & KfChannelOrientation )
+            stride += 3u * ARRAY_PACKED_REALS * sizeof(int16) + ARRAY_PACKED_REALS * sizeof(uint8);
+
+        //Keep the 16-bit loads aligned
+        return (stride + 3u) & ~3u;
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonTrack::_getKeyFrameTransform( size_t keyFrameIdx, KfTransform &outTransform ) const
+    {
+        if( mCompressedHeader )
+            decodeKeyFrame( keyFrameIdx, outTransform );
+        else
+            outTransform = *mKeyFrameRigs[keyFrameIdx].mBoneTransform;
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonTrack::_getInterpolatedTransform( Real frame, KfTransform &outTransform ) const
+    {
+        KeyFrameRigVec::const_iterator prevFrame = mKeyFrameRigs.begin();
+        KeyFrameRigVec::const_iterator nextFrame;
+        getKeyFrameRigAt( prevFrame, nextFrame, frame );
+
+        ArrayReal fTimeW = Mathlib::SetAll( (frame - prevFrame->mFrame) *
+                                            prevFrame->mInvNextFrameDistance );
+
+        KfTransform decodedPrev, decodedNext;
+        KfTransform const * RESTRICT_ALIAS prevTransf;
+        KfTransform const * RESTRICT_ALIAS nextTransf;
+        getKeyFrameTransforms( prevFrame, nextFrame, decodedPrev, decodedNext, prevTransf, nextTransf );
+
+        outTransform.mPosition      = Math::lerp( prevTransf->mPosition, nextTransf->mPosition, fTimeW );
+        outTransform.mOrientation   = ArrayQuaternion::nlerpShortest( fTimeW,
+                                                                      prevTransf->mOrientation,
+                                                                      nextTransf->mOrientation );
+        outTransform.mScale         = Math::lerp( prevTransf->mScale, nextTransf->mScale, fTimeW );
+    }
+    //-----------------------------------------------------------------------------------
+    size_t SkeletonTrack::_removeRedundantKeyFrames( const KfCompressionSettings &settings )
+    {
+        assert( !mCompressedHeader && "Can't remove keyframes after compressing" );
+
+        const size_t numKeyFrames = mKeyFrameRigs.size();
+        if( numKeyFrames <= 2u )
+            return 0;
+
+        //Greedy: Drop keyframe i if interpolating between the last kept keyframe and i+1
+        //reproduces every keyframe in between within tolerance.
+        vector<bool>::type keep( numKeyFrames, false );
+        keep.front()    = true;
+        keep.back()     = true;
+
+        size_t anchor = 0;
+        for( size_t i=1; i<numKeyFrames - 1u; ++i )
+        {
+            const KeyFrameRig &rigA = mKeyFrameRigs[anchor];
+            const KeyFrameRig &rigB = mKeyFrameRigs[i + 1u];
+            const Real invDistance = 1.0f / (rigB.mFrame - rigA.mFrame);
+
+            bool canDrop = true;
+            for( size_t j=anchor + 1u; j<=i && canDrop; ++j )
+            {
+                const KeyFrameRig &rig = mKeyFrameRigs[j];
+                const Real fTime = (rig.mFrame - rigA.mFrame) * invDistance;
+
+                for( size_t slot=0; slot<mUsedSlots && canDrop; ++slot )
+                {
+                    Vector3 vA, vB, vRef;
+                    Quaternion qA, qB, qRef;
+
+                    rigA.mBoneTransform->mPosition.getAsVector3( vA, slot );
+                    rigB.mBoneTransform->mPosition.getAsVector3( vB, slot );
+                    rig.mBoneTransform->mPosition.getAsVector3( vRef, slot );
+                    canDrop &= kfVectorError( Math::lerp( vA, vB, fTime ), vRef ) <=
+                               settings.positionTolerance;
+
+                    rigA.mBoneTransform->mScale.getAsVector3( vA, slot );
+                    rigB.mBoneTransform->mScale.getAsVector3( vB, slot );
+                    rig.mBoneTransform->mScale.getAsVector3( vRef, slot );
+                    canDrop &= kfVectorError( Math::lerp( vA, vB, fTime ), vRef ) <=
+                               settings.scaleTolerance;
+
+                    rigA.mBoneTransform->mOrientation.getAsQuaternion( qA, slot );
+                    rigB.mBoneTransform->mOrientation.getAsQuaternion( qB, slot );
+                    rig.mBoneTransform->mOrientation.getAsQuaternion( qRef, slot );
+                    canDrop &= kfQuaternionError( Quaternion::nlerp( fTime, qA, qB, true ), qRef ) <=
+                               settings.orientationTolerance;
+                }
+            }
+
+            if( !canDrop )
+            {
+                keep[i] = true;
+                anchor = i;
+            }
+        }
+
+        KeyFrameRigVec keyFrameRigs;
+        keyFrameRigs.reserve( numKeyFrames );
+        for( size_t i=0; i<numKeyFrames; ++i )
+        {
+            if( keep[i] )
+            {
+                if( !keyFrameRigs.empty() )
+                {
+                    KeyFrameRig &prevKeyFrame = keyFrameRigs.back();
+                    prevKeyFrame.mInvNextFrameDistance = 1.0f / (mKeyFrameRigs[i].mFrame -
+                                                                 prevKeyFrame.mFrame);
+                }
+                keyFrameRigs.push_back( mKeyFrameRigs[i] );
+            }
+        }
+
+        const size_t numRemoved = numKeyFrames - keyFrameRigs.size();
+        mKeyFrameRigs.swap( keyFrameRigs );
+
+        return numRemoved;
+    }
+    //-----------------------------------------------------------------------------------
+    size_t SkeletonTrack::_calculateCompressedSize( const KfCompressionSettings &settings ) const
+    {
+        const size_t keyFrameBytes = mKeyFrameRigs.size() *
+                                     getCompressedStride( getAnimatedChannels( settings ) );
+        return sizeof(KfCompressedHeader) +
+               ( (keyFrameBytes + OGRE_SIMD_ALIGNMENT - 1u) & ~(OGRE_SIMD_ALIGNMENT - 1u) );
+    }
+    //-----------------------------------------------------------------------------------
+    size_t SkeletonTrack::_compress( const KfCompressionSettings &settings, uint8 *dst )
+    {
+        assert( !mCompressedHeader && "Already compressed!" );
+        assert( !((size_t)dst & (OGRE_SIMD_ALIGNMENT - 1u)) && "dst must be aligned!" );
+
+        const uint8 animatedChannels = getAnimatedChannels( settings );
+        const uint32 stride = getCompressedStride( animatedChannels );
+
+        KfCompressedHeader *header = reinterpret_cast<KfCompressedHeader*>( dst );
+        uint8 *keyFrameData = dst + sizeof(KfCompressedHeader);
+
+        header->constantTransform = *mKeyFrameRigs.front().mBoneTransform;
+
+        //Calculate the quantization ranges, per SIMD lane
+        Real * RESTRICT_ALIAS posMin    = reinterpret_cast<Real*>( header->positionMin.mChunkBase );
+        Real * RESTRICT_ALIAS posStep   = reinterpret_cast<Real*>( header->positionStep.mChunkBase );
+        Real * RESTRICT_ALIAS scaleMin  = reinterpret_cast<Real*>( header->scaleMin.mChunkBase );
+        Real * RESTRICT_ALIAS scaleStep = reinterpret_cast<Real*>( header->scaleStep.mChunkBase );
+
+        {
+            Real posMax[3u * ARRAY_PACKED_REALS];
+            Real scaleMax[3u * ARRAY_PACKED_REALS];
+            for( size_t i=0; i<3u * ARRAY_PACKED_REALS; ++i )
+            {
+                posMin[i]   = std::numeric_limits<Real>::max();
+                posMax[i]   = -std::numeric_limits<Real>::max();
+                scaleMin[i] = std::numeric_limits<Real>::max();
+                scaleMax[i] = -std::numeric_limits<Real>::max();
+            }
+
+            KeyFrameRigVec::const_iterator itor = mKeyFrameRigs.begin();
+            KeyFrameRigVec::const_iterator end  = mKeyFrameRigs.end();
+
+            while( itor != end )
+            {
+                const Real *pos = reinterpret_cast<const Real*>(
+                                        itor->mBoneTransform->mPosition.mChunkBase );
+                const Real *scale = reinterpret_cast<const Real*>(
+                                        itor->mBoneTransform->mScale.mChunkBase );
+                for( size_t i=0; i<3u * ARRAY_PACKED_REALS; ++i )
+                {
+                    posMin[i]   = std::min( posMin[i], pos[i] );
+                    posMax[i]   = std::max( posMax[i], pos[i] );
+                    scaleMin[i] = std::min( scaleMin[i], scale[i] );
+                    scaleMax[i] = std::max( scaleMax[i], scale[i] );
+                }
+                ++itor;
+            }
+
+            for( size_t i=0; i<3u * ARRAY_PACKED_REALS; ++i )
+            {
+                posStep[i]      = (posMax[i] - posMin[i]) / Real( 65535 );
+                scaleStep[i]    = (scaleMax[i] - scaleMin[i]) / Real( 65535 );
+            }
+        }
+
+        KeyFrameRigVec::iterator itor = mKeyFrameRigs.begin();
+        KeyFrameRigVec::iterator end  = mKeyFrameRigs.end();
+
+        while( itor != end )
+        {
+            uint8 *data = keyFrameData;
+            const KfTransform &transform = *itor->mBoneTransform;
+
+            if( animatedChannels & KfChannelPosition )
+            {
+                uint16 *quantized = reinterpret_cast<uint16*>( data );
+                const Real *pos = reinterpret_cast<const Real*>( transform.mPosition.mChunkBase );
+                for( size_t i=0; i<3u * ARRAY_PACKED_REALS; ++i )
+                {
+                    quantized[i] = posStep[i] > 0 ? static_cast<uint16>(
+                                       Math::Clamp( (pos[i] - posMin[i]) / posStep[i] + Real( 0.5 ),
+                                                    Real( 0 ), Real( 65535 ) ) ) : 0;
+                }
+                data += 3u * ARRAY_PACKED_REALS * sizeof(uint16);
+            }
+
+            if( animatedChannels & KfChannelScale )
+            {
+                uint16 *quantized = reinterpret_cast<uint16*>( data );
+                const Real *scale = reinterpret_cast<const Real*>( transform.mScale.mChunkBase );
+                for( size_t i=0; i<3u * ARRAY_PACKED_REALS; ++i )
+                {
+                    quantized[i] = scaleStep[i] > 0 ? static_cast<uint16>(
+                                       Math::Clamp( (scale[i] - scaleMin[i]) / scaleStep[i] +
+                                                    Real( 0.5 ), Real( 0 ), Real( 65535 ) ) ) : 0;
+                }
+                data += 3u * ARRAY_PACKED_REALS * sizeof(uint16);
+            }
+
+            if( animatedChannels & KfChannelOrientation )
+            {
+                int16 *quantized = reinterpret_cast<int16*>( data );
+                uint8 *largestIdx = data + 3u * ARRAY_PACKED_REALS * sizeof(int16);
+
+                for( size_t i=0; i<ARRAY_PACKED_REALS; ++i )
+                {
+                    Quaternion qRot;
+                    transform.mOrientation.getAsQuaternion( qRot, i );
+                    qRot.normalise();
+
+                    const Real components[4] = { qRot.w, qRot.x, qRot.y, qRot.z };
+                    size_t largest = 0;
+                    for( size_t j=1; j<4u; ++j )
+                    {
+                        if( Math::Abs( components[j] ) > Math::Abs( components[largest] ) )
+                            largest = j;
+                    }
+
+                    //q and -q are the same rotation. Make the dropped component positive.
+                    const Real sign = components[largest] < 0 ? Real( -1 ) : Real( 1 );
+
+                    size_t k = 0;
+                    for( size_t j=0; j<4u; ++j )
+                    {
+                        if( j != largest )
+                        {
+                            const Real value = Math::Clamp( components[j] * sign *
+                                                            c_kfOrientationQuantScale,
+                                                            Real( -32767 ), Real( 32767 ) );
+                            quantized[k * ARRAY_PACKED_REALS + i] =
+                                    static_cast<int16>( Math::Floor( value + Real( 0.5 ) ) );
+                            ++k;
+                        }
+                    }
+
+                    largestIdx[i] = static_cast<uint8>( largest );
+                }
+            }
+
+            itor->mBoneTransform = 0;
+            keyFrameData += stride;
+            ++itor;
+        }
+
+        mCompressedHeader       = header;
+        mCompressedKeyFrames    = dst + sizeof(KfCompressedHeader);
+        mCompressedStride       = stride;
+        mAnimatedChannels       = animatedChannels;
+
+        size_t numConstantChannels = 0;
+        for( size_t i=0; i<3u; ++i )
+            numConstantChannels += (animatedChannels & (1u << i)) ? 0u : 1u;
+
+        return numConstantChannels;
+    }
 }
@@ -106,6 +106,12 @@ namespace Ogre
         //Destroy our local buffers
         TextureDefinitionBase::destroyBuffers( mDefinition->mLocalBufferDefs, mBuffers, mRenderSystem );
 
+        //Textures we share with other nodes are not ours to destroy
+        vector<size_t>::type::const_iterator itAliased = mAliasedLocalTextures.begin();
+        vector<size_t>::type::const_iterator enAliased = mAliasedLocalTextures.end();
+        while( itAliased != enAliased )
+            mLocalTextures[*itAliased++] = CompositorChannel();
+
         //Destroy our local textures
         TextureDefinitionBase::destroyTextures( mLocalTextures, mRenderSystem );
     }
@@ -452,6 +458,54 @@ namespace Ogre
         mConnectedNodes.clear();
     }
     //-----------------------------------------------------------------------------------
+    void CompositorNode::_aliasLocalTexture( size_t localTextureIdx,
+                                             const CompositorChannel &sharedChannel )
+    {
+        assert( localTextureIdx < mLocalTextures.size() );
+        assert( mPasses.empty() && "Textures must be aliased before creating the passes!" );
+        assert( !isLocalTextureAliased( localTextureIdx ) );
+
+        CompositorChannelVec oldChannel( 1, mLocalTextures[localTextureIdx] );
+        mLocalTextures[localTextureIdx] = sharedChannel;
+        mAliasedLocalTextures.push_back( localTextureIdx );
+
+        //Update our outputs and the inputs of the nodes we're connected to.
+        notifyRecreated( oldChannel[0], sharedChannel );
+
+        TextureDefinitionBase::destroyTextures( oldChannel, mRenderSystem );
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorNode::_restoreAliasedLocalTextures( const RenderTarget *finalTarget )
+    {
+        assert( mPasses.empty() && mConnectedNodes.empty() &&
+                "Call _notifyCleared before restoring the textures" );
+
+        const TextureDefinitionBase::TextureDefinitionVec &textureDefs =
+                mDefinition->getLocalTextureDefinitions();
+
+        vector<size_t>::type::const_iterator itor = mAliasedLocalTextures.begin();
+        vector<size_t>::type::const_iterator end  = mAliasedLocalTextures.end();
+
+        while( itor != end )
+        {
+            const TextureDefinitionBase::TextureDefinition &textureDef = textureDefs[*itor];
+            const String textureName = (textureDef.getName() + IdString( getId() )).getFriendlyText();
+            mLocalTextures[*itor] = TextureDefinitionBase::createTexture( textureDef, textureName,
+                                                                          finalTarget, mRenderSystem );
+            ++itor;
+        }
+
+        mAliasedLocalTextures.clear();
+
+        routeOutputs();
+    }
+    //-----------------------------------------------------------------------------------
+    bool CompositorNode::isLocalTextureAliased( size_t localTextureIdx ) const
+    {
+        return std::find( mAliasedLocalTextures.begin(), mAliasedLocalTextures.end(),
+                          localTextureIdx ) != mAliasedLocalTextures.end();
+    }
+    //-----------------------------------------------------------------------------------
     void CompositorNode::setEnabled( bool bEnabled )
     {
         if( mEnabled != bEnabled )
@@ -963,6 +1017,48 @@ namespace Ogre
                                      ReadBarrier::RenderTarget );
     }
     //-----------------------------------------------------------------------------------
+    static bool isPassExecutable( const CompositorPassDef *passDef, uint8 executionMask,
+                                  const CompositorShadowNode *shadowNode )
+    {
+        const CompositorTargetDef *targetDef = passDef->getParentTargetDef();
+
+        return executionMask & passDef->mExecutionMask &&
+                (!shadowNode || (!shadowNode->isShadowMapIdxInValidRange( passDef->mShadowMapIdx )
+                || (shadowNode->_shouldUpdateShadowMapIdx( passDef->mShadowMapIdx )
+                && (shadowNode->getShadowMapLightTypeMask( passDef->mShadowMapIdx ) &
+                    targetDef->getShadowMapSupportedLightTypes()))));
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorNode::cullPassesMultiFrustum( const Camera *lodCamera, SceneManager *sceneManager,
+                                                 const CompositorShadowNode *shadowNode,
+                                                 uint8 executionMask )
+    {
+        mMultiFrusta.clear();
+
+        CompositorPassVec::const_iterator itor = mPasses.begin();
+        CompositorPassVec::const_iterator end  = mPasses.end();
+
+        while( itor != end )
+        {
+            CompositorPass *pass = *itor;
+            if( pass->getType() == PASS_SCENE &&
+                isPassExecutable( pass->getDefinition(), executionMask, shadowNode ) )
+            {
+                assert( dynamic_cast<CompositorPassScene*>( pass ) );
+                CompositorPassScene *passScene = static_cast<CompositorPassScene*>( pass );
+                MovableObject::MultiFrustum *multiFrustum =
+                        passScene->_prepareMultiFrustumCull( lodCamera );
+                if( multiFrustum )
+                    mMultiFrusta.push_back( multiFrustum );
+            }
+            ++itor;
+        }
+
+        //Nothing to gain with just one frustum
+        if( mMultiFrusta.size() > 1u )
+            sceneManager->_cullPhase01Multi( mMultiFrusta.begin(), mMultiFrusta.size() );
+    }
+    //-----------------------------------------------------------------------------------
     void CompositorNode::_update( const Camera *lodCamera, SceneManager *sceneManager )
     {
         //If we're in a caster pass, we need to skip shadow map passes that have no light associated
@@ -971,6 +1067,9 @@ namespace Ogre
             shadowNode = sceneManager->getCurrentShadowNode();
         uint8 executionMask = mWorkspace->getExecutionMask();
 
+        if( sceneManager->getMultiFrustumCulling() )
+            cullPassesMultiFrustum( lodCamera, sceneManager, shadowNode, executionMask );
+
         RenderTarget *lastTarget = 0;
 
         if( !mPasses.empty() )
@@ -991,13 +1090,7 @@ namespace Ogre
                 lastTarget = pass->getRenderTarget();
             }
 
-            const CompositorTargetDef *targetDef = passDef->getParentTargetDef();
-
-            if( executionMask & passDef->mExecutionMask &&
-                (!shadowNode || (!shadowNode->isShadowMapIdxInValidRange( passDef->mShadowMapIdx )
-                || (shadowNode->_shouldUpdateShadowMapIdx( passDef->mShadowMapIdx )
-                && (shadowNode->getShadowMapLightTypeMask( passDef->mShadowMapIdx ) &
-                    targetDef->getShadowMapSupportedLightTypes())))) )
+            if( isPassExecutable( passDef, executionMask, shadowNode ) )
             {
                 //Make explicitly exposed textures available to materials during this pass.
                 const size_t oldNumTextures = sceneManager->getNumCompositorTextures();
@@ -1024,6 +1117,16 @@ namespace Ogre
 
         if( !mPasses.empty() )
             mRenderSystem->_notifyCompositorNodeSwitchedRenderTarget( lastTarget );
+
+        //Results from passes that didn't get to consume them must not be used next time.
+        FastArray<MovableObject::MultiFrustum*>::const_iterator itMultiFrustum = mMultiFrusta.begin();
+        FastArray<MovableObject::MultiFrustum*>::const_iterator enMultiFrustum = mMultiFrusta.end();
+        while( itMultiFrustum != enMultiFrustum )
+        {
+            (*itMultiFrustum)->valid = false;
+            ++itMultiFrustum;
+        }
+        mMultiFrusta.clear();
     }
     //-----------------------------------------------------------------------------------
     void CompositorNode::finalTargetResized( const RenderTarget *finalTarget )
@@ -337,7 +337,7 @@ namespace Ogre
         mLastCamera = newCamera;
 
         const Viewport *viewport = newCamera->getLastViewport();
-        const SceneManager *sceneManager = newCamera->getSceneManager();
+        SceneManager *sceneManager = newCamera->getSceneManager();
         const LightListInfo &globalLightList = sceneManager->getGlobalLightList();
 
         uint32 combinedVisibilityFlags = viewport->getVisibilityMask() &
@@ -601,6 +601,17 @@ namespace Ogre
 
                 itShadowCamera->minDistance = itShadowCamera->shadowCameraSetup->getMinDistance();
                 itShadowCamera->maxDistance = itShadowCamera->shadowCameraSetup->getMaxDistance();
+
+                //Static shadow maps must contain everything, not just what's currently visible.
+                if( sceneManager->getShadowCasterVolumeCulling() &&
+                    !mShadowMapCastingLights[itor->light].isStatic )
+                {
+                    updateShadowCasterVolume( *itShadowCamera, *itor, camera, light );
+                }
+                else
+                {
+                    texCamera->_setShadowCasterVolume( 0 );
+                }
             }
             //Else... this shadow map shouldn't be rendered and when used, return a blank one.
             //The Nth closest lights don't cast shadows
@@ -629,6 +640,51 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    void CompositorShadowNode::updateShadowCasterVolume( ShadowMapCamera &shadowMapCamera,
+                                                         const ShadowTextureDefinition &shadowTexDef,
+                                                         const Camera *camera, const Light *light )
+    {
+        Real nearDist = camera->getNearClipDistance();
+        Real farDist  = light->getShadowFarDistance();
+        if( camera->getFarClipDistance() != 0 )
+            farDist = std::min( farDist, camera->getFarClipDistance() );
+
+        if( shadowTexDef.shadowMapTechnique == SHADOWMAP_PSSM )
+        {
+            //Same range PSSMShadowCameraSetup uses, plus the region
+            //blended with the previous split, which also samples us.
+            const PSSMShadowCameraSetup *pssmSetup = static_cast<const PSSMShadowCameraSetup*>(
+                                                        shadowMapCamera.shadowCameraSetup.get() );
+            const PSSMShadowCameraSetup::SplitPointList &splitPoints = pssmSetup->getSplitPoints();
+            const PSSMShadowCameraSetup::SplitPointList &blendPoints =
+                    pssmSetup->getSplitBlendPoints();
+            const size_t split = shadowTexDef.split;
+
+            nearDist = splitPoints[split];
+            farDist  = splitPoints[split + 1u];
+            if( split > 0 )
+            {
+                nearDist -= pssmSetup->getSplitPadding();
+                if( split - 1u < blendPoints.size() )
+                    nearDist = std::min( nearDist, blendPoints[split - 1u] );
+                nearDist = std::max( nearDist, splitPoints[0] );
+            }
+            if( split + 1u < pssmSetup->getSplitCount() )
+                farDist += pssmSetup->getSplitPadding();
+        }
+
+        if( farDist > nearDist )
+        {
+            shadowMapCamera.casterVolume.build( camera, nearDist, farDist, light );
+            shadowMapCamera.camera->_setShadowCasterVolume( &shadowMapCamera.casterVolume );
+        }
+        else
+        {
+            //Infinite or empty receiver region
+            shadowMapCamera.camera->_setShadowCasterVolume( 0 );
+        }
+    }
+    //-----------------------------------------------------------------------------------
     void CompositorShadowNode::postInitializePass( CompositorPass *pass )
     {
         const CompositorPassDef *passDef = pass->getDefinition();
@@ -0,0 +1,216 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2017 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "Compositor/OgreCompositorTextureAliasing.h"
+
+namespace Ogre
+{
+    namespace
+    {
+        struct OrderByFirstUse
+        {
+            const CompositorTextureAliasing::LifetimeVec &lifetimes;
+
+            OrderByFirstUse( const CompositorTextureAliasing::LifetimeVec &_lifetimes ) :
+                lifetimes( _lifetimes ) {}
+
+            bool operator () ( size_t a, size_t b ) const
+            {
+                return lifetimes[a].firstUse < lifetimes[b].firstUse;
+            }
+        };
+
+        struct LiveEvent
+        {
+            uint32  passIdx;
+            bool    released;
+            size_t  sizeBytes;
+
+            bool operator < ( const LiveEvent &other ) const
+            {
+                //Release before acquiring at the same pass index
+                if( passIdx != other.passIdx )
+                    return passIdx < other.passIdx;
+                return released && !other.released;
+            }
+        };
+    }
+
+    void CompositorTextureAliasing::Lifetime::addUse( uint32 passIdx )
+    {
+        firstUse    = std::min( firstUse, passIdx );
+        lastUse     = std::max( lastUse, passIdx );
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorTextureAliasing::assignAllocations( const LifetimeVec &lifetimes,
+                                                       vector<size_t>::type &outAllocation,
+                                                       Stats &outStats )
+    {
+        outStats = Stats();
+        outStats.numTextures = lifetimes.size();
+
+        outAllocation.resize( lifetimes.size() );
+
+        vector<size_t>::type order;
+        order.reserve( lifetimes.size() );
+
+        for( size_t i=0; i<lifetimes.size(); ++i )
+        {
+            outAllocation[i] = i;
+            outStats.naiveBytes += lifetimes[i].sizeBytes;
+            if( lifetimes[i].canAlias && lifetimes[i].isUsed() )
+                order.push_back( i );
+        }
+
+        std::stable_sort( order.begin(), order.end(), OrderByFirstUse( lifetimes ) );
+
+        //Allocations whose owner has been processed. lastUse gets pushed forward
+        //every time another texture starts using it.
+        vector< std::pair<size_t, uint32> >::type allocations;
+        allocations.reserve( order.size() );
+
+        vector<size_t>::type::const_iterator itor = order.begin();
+        vector<size_t>::type::const_iterator end  = order.end();
+
+        while( itor != end )
+        {
+            const Lifetime &lifetime = lifetimes[*itor];
+
+            vector< std::pair<size_t, uint32> >::type::iterator itAlloc = allocations.begin();
+            vector< std::pair<size_t, uint32> >::type::iterator enAlloc = allocations.end();
+
+            while( itAlloc != enAlloc &&
+                   (lifetimes[itAlloc->first].compatibilityClass != lifetime.compatibilityClass ||
+                    itAlloc->second >= lifetime.firstUse) )
+            {
+                ++itAlloc;
+            }
+
+            if( itAlloc != enAlloc )
+            {
+                outAllocation[*itor] = itAlloc->first;
+                itAlloc->second = lifetime.lastUse;
+                ++outStats.numAliased;
+            }
+            else
+            {
+                allocations.push_back( std::pair<size_t, uint32>( *itor, lifetime.lastUse ) );
+            }
+
+            ++itor;
+        }
+
+        //Textures that don't alias are alive during the whole frame.
+        size_t alwaysLiveBytes = 0;
+        vector<LiveEvent>::type events;
+        events.reserve( order.size() * 2u );
+
+        for( size_t i=0; i<lifetimes.size(); ++i )
+        {
+            if( outAllocation[i] == i )
+                outStats.allocatedBytes += lifetimes[i].sizeBytes;
+
+            if( lifetimes[i].canAlias && lifetimes[i].isUsed() )
+            {
+                LiveEvent acquire = { lifetimes[i].firstUse, false, lifetimes[i].sizeBytes };
+                LiveEvent release = { lifetimes[i].lastUse + 1u, true, lifetimes[i].sizeBytes };
+                events.push_back( acquire );
+                events.push_back( release );
+            }
+            else
+            {
+                alwaysLiveBytes += lifetimes[i].sizeBytes;
+            }
+        }
+
+        std::sort( events.begin(), events.end() );
+
+        size_t liveBytes = 0;
+        size_t peakBytes = 0;
+        vector<LiveEvent>::type::const_iterator itEvent = events.begin();
+        vector<LiveEvent>::type::const_iterator enEvent = events.end();
+        while( itEvent != enEvent )
+        {
+            if( itEvent->released )
+                liveBytes -= itEvent->sizeBytes;
+            else
+                liveBytes += itEvent->sizeBytes;
+            peakBytes = std::max( peakBytes, liveBytes );
+            ++itEvent;
+        }
+
+        outStats.peakLiveBytes = alwaysLiveBytes + peakBytes;
+    }
+    //-----------------------------------------------------------------------------------
+    bool CompositorTextureAliasing::areCompatible( const TextureDefinitionBase::TextureDefinition &a,
+                                                   const TextureDefinitionBase::TextureDefinition &b )
+    {
+        return a.textureType == b.textureType &&
+               a.width == b.width && a.height == b.height && a.depth == b.depth &&
+               a.numMipmaps == b.numMipmaps &&
+               a.widthFactor == b.widthFactor && a.heightFactor == b.heightFactor &&
+               a.formatList == b.formatList &&
+               a.fsaa == b.fsaa && a.uav == b.uav && a.automipmaps == b.automipmaps &&
+               a.hwGammaWrite == b.hwGammaWrite && a.depthBufferId == b.depthBufferId &&
+               a.preferDepthTexture == b.preferDepthTexture &&
+               a.depthBufferFormat == b.depthBufferFormat &&
+               a.fsaaExplicitResolve == b.fsaaExplicitResolve;
+    }
+    //-----------------------------------------------------------------------------------
+    bool CompositorTextureAliasing::isAliasable( const TextureDefinitionBase::TextureDefinition &textureDef )
+    {
+        //Passes address slices of 3D, cubemaps & arrays through RenderTargets we don't
+        //track. Depth textures get accessed behind our back by the RenderSystem.
+        return textureDef.textureType == TEX_TYPE_2D && !textureDef.preferDepthTexture;
+    }
+    //-----------------------------------------------------------------------------------
+    size_t CompositorTextureAliasing::getMemoryUsage( const CompositorChannel &channel )
+    {
+        size_t retVal = 0;
+
+        CompositorChannel::TextureVec::const_iterator itor = channel.textures.begin();
+        CompositorChannel::TextureVec::const_iterator end  = channel.textures.end();
+
+        while( itor != end )
+        {
+            const Texture *texture = itor->get();
+            size_t texSize = PixelUtil::calculateSizeBytes( texture->getWidth(), texture->getHeight(),
+                                                            texture->getDepth(),
+                                                            static_cast<uint32>( texture->getNumFaces() ),
+                                                            texture->getFormat(),
+                                                            texture->getNumMipmaps() + 1u );
+            texSize *= std::max( texture->getFSAA(), 1u );
+            retVal += texSize;
+            ++itor;
+        }
+
+        return retVal;
+    }
+}
@@ -33,7 +33,13 @@ THE SOFTWARE.
 #include "Compositor/OgreCompositorManager2.h"
 #include "Compositor/OgreCompositorShadowNode.h"
 
+#include "Compositor/Pass/PassClear/OgreCompositorPassClearDef.h"
+#include "Compositor/Pass/PassCompute/OgreCompositorPassComputeDef.h"
+#include "Compositor/Pass/PassDepthCopy/OgreCompositorPassDepthCopyDef.h"
+#include "Compositor/Pass/PassQuad/OgreCompositorPassQuadDef.h"
 #include "Compositor/Pass/PassScene/OgreCompositorPassScene.h"
+#include "Compositor/Pass/PassStencil/OgreCompositorPassStencilDef.h"
+#include "Compositor/Pass/PassUav/OgreCompositorPassUavDef.h"
 
 #include "OgreHardwarePixelBuffer.h"
 #include "OgreRenderTexture.h"
@@ -43,10 +49,137 @@ THE SOFTWARE.
 #include "OgreRenderTarget.h"
 #include "OgreLogManager.h"
 
+#include "OgreRoot.h"
+#include "OgreHlmsManager.h"
+#include "OgreMaterialManager.h"
+#include "OgreTechnique.h"
+#include "OgrePass.h"
+
 #include "OgreProfiler.h"
 
 namespace Ogre
 {
+    namespace
+    {
+        /// Tracks which passes touch the local textures of the nodes.
+        /// @See CompositorWorkspace::aliasTransientTextures
+        struct TransientTextureTracker
+        {
+            typedef map<const RenderTarget*, size_t>::type TargetToTextureMap;
+
+            CompositorTextureAliasing::LifetimeVec  lifetimes;
+            TargetToTextureMap                      targetToTexture;
+
+            /// Returns null for global textures, they live as long as the workspace.
+            static const CompositorChannel* findChannel( const CompositorNode *node, IdString name )
+            {
+                const CompositorChannel *retVal = 0;
+
+                size_t index;
+                TextureDefinitionBase::TextureSource textureSource;
+                node->getDefinition()->getTextureSource( name, index, textureSource );
+                if( textureSource == TextureDefinitionBase::TEXTURE_INPUT )
+                    retVal = &node->getInputChannel()[index];
+                else if( textureSource == TextureDefinitionBase::TEXTURE_LOCAL )
+                    retVal = &node->getLocalTextures()[index];
+
+                return retVal;
+            }
+
+            CompositorTextureAliasing::Lifetime* findLifetime( const CompositorChannel *channel )
+            {
+                CompositorTextureAliasing::Lifetime *retVal = 0;
+                if( channel && channel->isValid() )
+                {
+                    TargetToTextureMap::const_iterator itor = targetToTexture.find( channel->target );
+                    if( itor != targetToTexture.end() )
+                        retVal = &lifetimes[itor->second];
+                }
+                return retVal;
+            }
+
+            /**
+            @param overwritesAll
+                True if the pass overwrites the whole texture without looking at its contents.
+            */
+            void use( const CompositorChannel *channel, uint32 passIdx,
+                      bool overwritesAll, bool runsEveryFrame )
+            {
+                CompositorTextureAliasing::Lifetime *lifetime = findLifetime( channel );
+                if( lifetime )
+                {
+                    //If the first access each frame doesn't overwrite it,
+                    //the contents from the previous frame are needed.
+                    if( (!lifetime->isUsed() && !overwritesAll) || !runsEveryFrame )
+                        lifetime->canAlias = false;
+                    lifetime->addUse( passIdx );
+                }
+            }
+
+            void use( const CompositorNode *node, IdString name, uint32 passIdx, bool runsEveryFrame )
+            {
+                if( name != IdString() )
+                    use( findChannel( node, name ), passIdx, false, runsEveryFrame );
+            }
+
+            void forbidAliasing( const CompositorChannel *channel )
+            {
+                CompositorTextureAliasing::Lifetime *lifetime = findLifetime( channel );
+                if( lifetime )
+                    lifetime->canAlias = false;
+            }
+
+            void forbidAliasing( const CompositorChannelVec &channels )
+            {
+                CompositorChannelVec::const_iterator itor = channels.begin();
+                CompositorChannelVec::const_iterator end  = channels.end();
+
+                while( itor != end )
+                    forbidAliasing( &(*itor++) );
+            }
+
+            /// Returns true if the quad's material writes all channels with blending off.
+            /// The material is resolved the same way CompositorPassQuad does, since the
+            /// passes haven't been created yet at this point.
+            static bool quadReplacesContents( const CompositorPassQuadDef *quadDef )
+            {
+                const HlmsBlendblock *blendblock = 0;
+
+                if( quadDef->mMaterialIsHlms )
+                {
+                    HlmsManager *hlmsManager = Root::getSingleton().getHlmsManager();
+                    HlmsDatablock *datablock =
+                            hlmsManager->getDatablockNoDefault( quadDef->mMaterialName );
+                    if( datablock )
+                        blendblock = datablock->getBlendblock();
+                }
+                else
+                {
+                    MaterialPtr material =
+                            MaterialManager::getSingleton().getByName( quadDef->mMaterialName );
+                    if( !material.isNull() )
+                    {
+                        material->load();
+                        Technique *technique = material->getBestTechnique();
+                        if( technique && technique->getPass( 0 ) )
+                            blendblock = technique->getPass( 0 )->getBlendblock();
+                    }
+                }
+
+                return blendblock &&
+                       blendblock->mBlendChannelMask == HlmsBlendblock::BlendChannelAll &&
+                       !blendblock->mAlphaToCoverageEnabled &&
+                       blendblock->mSourceBlendFactor == SBF_ONE &&
+                       blendblock->mDestBlendFactor == SBF_ZERO &&
+                       blendblock->mBlendOperation == SBO_ADD &&
+                       (!blendblock->mSeparateBlend ||
+                        (blendblock->mSourceBlendFactorAlpha == SBF_ONE &&
+                         blendblock->mDestBlendFactorAlpha == SBF_ZERO &&
+                         blendblock->mBlendOperationAlpha == SBO_ADD));
+            }
+        };
+    }
+
     CompositorWorkspace::CompositorWorkspace( IdType id, const CompositorWorkspaceDef *definition,
                                               const CompositorChannelVec &externalRenderTargets,
                                               SceneManager *sceneManager, Camera *defaultCam,
@@ -69,7 +202,8 @@ namespace Ogre
             mExecutionMask( executionMask ),
             mViewportModifierMask( viewportModifierMask ),
             mViewportModifier( vpOffsetScale ),
-            mBarriersDirty( true )
+            mBarriersDirty( true ),
+            mTransientTextureAliasing( false )
     {
         assert( (!defaultCam || (defaultCam->getSceneManager() == sceneManager)) &&
                 "Camera was created with a different SceneManager than supplied" );
@@ -325,6 +459,10 @@ namespace Ogre
             mNodeSequence.clear();
             mNodeSequence.insert( mNodeSequence.end(), processedList.begin(), processedList.end() );
 
+            mTransientTextureStats = CompositorTextureAliasing::Stats();
+            if( mTransientTextureAliasing )
+                aliasTransientTextures();
+
             CompositorNodeVec::iterator itor = mNodeSequence.begin();
             CompositorNodeVec::iterator end  = mNodeSequence.end();
 
@@ -354,12 +492,16 @@ namespace Ogre
     void CompositorWorkspace::clearAllConnections(void)
     {
         {
+            RenderTarget *finalTarget = getFinalTarget();
+
             CompositorNodeVec::iterator itor = mNodeSequence.begin();
             CompositorNodeVec::iterator end  = mNodeSequence.end();
 
             while( itor != end )
             {
                 (*itor)->_notifyCleared();
+                //Shared textures will be assigned again (if still possible) when reconnecting
+                (*itor)->_restoreAliasedLocalTextures( finalTarget );
                 ++itor;
             }
         }
@@ -530,6 +672,254 @@ namespace Ogre
         mBarriersDirty = false;
     }
     //-----------------------------------------------------------------------------------
+    void CompositorWorkspace::aliasTransientTextures(void)
+    {
+        TransientTextureTracker tracker;
+        vector< std::pair<CompositorNode*, size_t> >::type localTextures;
+
+        {
+            //Gather the local textures from all nodes
+            vector<const TextureDefinitionBase::TextureDefinition*>::type compatibilityClasses;
+
+            CompositorNodeVec::const_iterator itor = mNodeSequence.begin();
+            CompositorNodeVec::const_iterator end  = mNodeSequence.end();
+
+            while( itor != end )
+            {
+                CompositorNode *node = *itor;
+                const TextureDefinitionBase::TextureDefinitionVec &textureDefs =
+                        node->getDefinition()->getLocalTextureDefinitions();
+                const CompositorChannelVec &channels = node->getLocalTextures();
+
+                for( size_t i=0; i<channels.size(); ++i )
+                {
+                    CompositorTextureAliasing::Lifetime lifetime;
+                    lifetime.sizeBytes  = CompositorTextureAliasing::getMemoryUsage( channels[i] );
+                    lifetime.canAlias   = CompositorTextureAliasing::isAliasable( textureDefs[i] );
+
+                    size_t classIdx = 0;
+                    while( classIdx < compatibilityClasses.size() &&
+                           !CompositorTextureAliasing::areCompatible( *compatibilityClasses[classIdx],
+                                                                      textureDefs[i] ) )
+                    {
+                        ++classIdx;
+                    }
+
+                    if( classIdx == compatibilityClasses.size() )
+                        compatibilityClasses.push_back( &textureDefs[i] );
+                    lifetime.compatibilityClass = static_cast<uint32>( classIdx );
+
+                    tracker.targetToTexture[channels[i].target] = tracker.lifetimes.size();
+                    tracker.lifetimes.push_back( lifetime );
+                    localTextures.push_back( std::pair<CompositorNode*, size_t>( node, i ) );
+                }
+
+                ++itor;
+            }
+        }
+
+        {
+            //Walk all passes in order of execution. Disabled nodes are
+            //included since they can be enabled without reconnecting.
+            const bool applyVpModifier = mViewportModifier != Vector4( 0, 0, 1, 1 );
+            uint32 passIdx = 0;
+            //Stencil state set by a stencil pass stays until another one changes it.
+            bool stencilEnabled = false;
+
+            CompositorNodeVec::const_iterator itor = mNodeSequence.begin();
+            CompositorNodeVec::const_iterator end  = mNodeSequence.end();
+
+            while( itor != end )
+            {
+                const CompositorNode *node = *itor;
+                const CompositorNodeDef *nodeDef = node->getDefinition();
+
+                for( size_t i=0; i<nodeDef->getNumTargetPasses(); ++i )
+                {
+                    const CompositorTargetDef *targetDef = nodeDef->getTargetPass( i );
+                    const CompositorChannel *target =
+                            TransientTextureTracker::findChannel( node, targetDef->getRenderTargetName() );
+
+                    const CompositorPassDefVec &passDefs = targetDef->getCompositorPasses();
+                    CompositorPassDefVec::const_iterator itPass = passDefs.begin();
+                    CompositorPassDefVec::const_iterator enPass = passDefs.end();
+
+                    while( itPass != enPass )
+                    {
+                        const CompositorPassDef *passDef = *itPass;
+                        const CompositorPassType passType = passDef->getType();
+
+                        const bool runsEveryFrame = passDef->mNumInitialPasses ==
+                                                        std::numeric_limits<uint32>::max();
+                        bool overwritesAll = passDef->mVpLeft == 0 && passDef->mVpTop == 0 &&
+                                             passDef->mVpWidth == 1 && passDef->mVpHeight == 1 &&
+                                             passDef->mVpScissorLeft == 0 &&
+                                             passDef->mVpScissorTop == 0 &&
+                                             passDef->mVpScissorWidth == 1 &&
+                                             passDef->mVpScissorHeight == 1 &&
+                                             (!applyVpModifier ||
+                                              !(mViewportModifierMask & passDef->mViewportModifierMask));
+                        if( passType == PASS_CLEAR )
+                        {
+                            assert( dynamic_cast<const CompositorPassClearDef*>( passDef ) );
+                            const CompositorPassClearDef *clearDef =
+                                    static_cast<const CompositorPassClearDef*>( passDef );
+                            overwritesAll &= (clearDef->mClearBufferFlags & FBT_COLOUR) != 0;
+                        }
+                        else if( passType == PASS_QUAD )
+                        {
+                            //A quad only replaces what was there if every pixel gets written
+                            //as is. Shaders that discard can't be detected; those nodes
+                            //should clear first.
+                            assert( dynamic_cast<const CompositorPassQuadDef*>( passDef ) );
+                            overwritesAll &= passDef->mColourWrite && !stencilEnabled &&
+                                             TransientTextureTracker::quadReplacesContents(
+                                                 static_cast<const CompositorPassQuadDef*>(
+                                                     passDef ) );
+                        }
+                        else
+                        {
+                            overwritesAll = false;
+                        }
+
+                        if( passType == PASS_STENCIL )
+                        {
+                            assert( dynamic_cast<const CompositorPassStencilDef*>( passDef ) );
+                            stencilEnabled = static_cast<const CompositorPassStencilDef*>(
+                                                 passDef )->mStencilParams.enabled;
+                        }
+
+                        //Textures being read. They're used by the same pass that writes to
+                        //the target, so they can't share memory with the target either.
+                        switch( passType )
+                        {
+                        case PASS_SCENE:
+                            {
+                                assert( dynamic_cast<const CompositorPassSceneDef*>( passDef ) );
+                                const CompositorPassSceneDef *sceneDef =
+                                        static_cast<const CompositorPassSceneDef*>( passDef );
+                                tracker.use( node, sceneDef->mPrePassTexture, passIdx, runsEveryFrame );
+                                tracker.use( node, sceneDef->mPrePassDepthTexture, passIdx,
+                                             runsEveryFrame );
+                                tracker.use( node, sceneDef->mPrePassSsrTexture, passIdx, runsEveryFrame );
+                            }
+                            break;
+                        case PASS_QUAD:
+                            {
+                                assert( dynamic_cast<const CompositorPassQuadDef*>( passDef ) );
+                                const CompositorPassQuadDef::TextureSources &textureSources =
+                                        static_cast<const CompositorPassQuadDef*>( passDef )->
+                                        getTextureSources();
+                                CompositorPassQuadDef::TextureSources::const_iterator itTex =
+                                        textureSources.begin();
+                                while( itTex != textureSources.end() )
+                                {
+                                    tracker.use( node, itTex->textureName, passIdx, runsEveryFrame );
+                                    ++itTex;
+                                }
+                            }
+                            break;
+                        case PASS_DEPTHCOPY:
+                            {
+                                assert( dynamic_cast<const CompositorPassDepthCopyDef*>( passDef ) );
+                                const CompositorPassDepthCopyDef *depthCopyDef =
+                                        static_cast<const CompositorPassDepthCopyDef*>( passDef );
+                                //The copy may end up swapping their depth buffers instead
+                                tracker.forbidAliasing( TransientTextureTracker::findChannel(
+                                                            node, depthCopyDef->getSrcDepthTextureName() ) );
+                                tracker.forbidAliasing( TransientTextureTracker::findChannel(
+                                                            node, depthCopyDef->getDstDepthTextureName() ) );
+                            }
+                            break;
+                        case PASS_UAV:
+                            {
+                                assert( dynamic_cast<const CompositorPassUavDef*>( passDef ) );
+                                const CompositorPassUavDef::TextureSources &textureSources =
+                                        static_cast<const CompositorPassUavDef*>( passDef )->
+                                        getTextureSources();
+                                CompositorPassUavDef::TextureSources::const_iterator itTex =
+                                        textureSources.begin();
+                                while( itTex != textureSources.end() )
+                                {
+                                    if( itTex->externalTextureName.empty() )
+                                        tracker.use( node, itTex->textureName, passIdx, runsEveryFrame );
+                                    ++itTex;
+                                }
+                            }
+                            break;
+                        case PASS_COMPUTE:
+                            {
+                                assert( dynamic_cast<const CompositorPassComputeDef*>( passDef ) );
+                                const CompositorPassComputeDef *computeDef =
+                                        static_cast<const CompositorPassComputeDef*>( passDef );
+                                CompositorPassComputeDef::TextureSources::const_iterator itTex =
+                                        computeDef->getTextureSources().begin();
+                                while( itTex != computeDef->getTextureSources().end() )
+                                {
+                                    tracker.use( node, itTex->textureName, passIdx, runsEveryFrame );
+                                    ++itTex;
+                                }
+                                itTex = computeDef->getUavSources().begin();
+                                while( itTex != computeDef->getUavSources().end() )
+                                {
+                                    tracker.use( node, itTex->textureName, passIdx, runsEveryFrame );
+                                    ++itTex;
+                                }
+                            }
+                            break;
+                        case PASS_CUSTOM:
+                            //We don't know what it does with them
+                            tracker.forbidAliasing( node->getInputChannel() );
+                            tracker.forbidAliasing( node->getLocalTextures() );
+                            break;
+                        default:
+                            break;
+                        }
+
+                        IdStringVec::const_iterator itExposed = passDef->mExposedTextures.begin();
+                        IdStringVec::const_iterator enExposed = passDef->mExposedTextures.end();
+                        while( itExposed != enExposed )
+                            tracker.use( node, *itExposed++, passIdx, runsEveryFrame );
+
+                        tracker.use( target, passIdx, overwritesAll, runsEveryFrame );
+
+                        ++passIdx;
+                        ++itPass;
+                    }
+                }
+
+                ++itor;
+            }
+        }
+
+        vector<size_t>::type allocations;
+        CompositorTextureAliasing::assignAllocations( tracker.lifetimes, allocations,
+                                                      mTransientTextureStats );
+
+        for( size_t i=0; i<allocations.size(); ++i )
+        {
+            if( allocations[i] != i )
+            {
+                //Owners never use someone else's allocation, so their channel is still theirs.
+                const std::pair<CompositorNode*, size_t> &owner = localTextures[allocations[i]];
+                const CompositorChannel sharedChannel = owner.first->getLocalTextures()[owner.second];
+                localTextures[i].first->_aliasLocalTexture( localTextures[i].second, sharedChannel );
+            }
+        }
+
+        LogManager::getSingleton().logMessage(
+                    "Workspace '" + mDefinition->mName.getFriendlyText() + "': " +
+                    StringConverter::toString( mTransientTextureStats.numAliased ) + " of " +
+                    StringConverter::toString( mTransientTextureStats.numTextures ) +
+                    " local textures aliased. " +
+                    StringConverter::toString( mTransientTextureStats.allocatedBytes / 1024u ) +
+                    " KB used instead of " +
+                    StringConverter::toString( mTransientTextureStats.naiveBytes / 1024u ) +
+                    " KB (peak live: " +
+                    StringConverter::toString( mTransientTextureStats.peakLiveBytes / 1024u ) +
+                    " KB)" );
+    }
+    //-----------------------------------------------------------------------------------
     CompositorNode* CompositorWorkspace::getLastEnabledNode(void)
     {
         CompositorNode *retVal = 0;
@@ -603,6 +993,15 @@ namespace Ogre
         connectAllNodes();
     }
     //-----------------------------------------------------------------------------------
+    void CompositorWorkspace::setTransientTextureAliasing( bool bEnabled )
+    {
+        if( mTransientTextureAliasing != bEnabled )
+        {
+            mTransientTextureAliasing = bEnabled;
+            reconnectAllNodes();
+        }
+    }
+    //-----------------------------------------------------------------------------------
     void CompositorWorkspace::resetAllNumPassesLeft(void)
     {
         CompositorNodeVec::const_iterator itor = mNodeSequence.begin();
@@ -701,6 +1100,11 @@ namespace Ogre
             mCurrentWidth   = finalTarget->getWidth();
             mCurrentHeight  = finalTarget->getHeight();
 
+            //When nodes share textures, resizing one would resize the other's. Just
+            //recreate them all once the global textures are resized (see below).
+            const bool recreateNodes = mTransientTextureStats.numAliased != 0;
+
+            if( !recreateNodes )
             {
                 CompositorNodeVec::const_iterator itor = mNodeSequence.begin();
                 CompositorNodeVec::const_iterator end  = mNodeSequence.end();
@@ -735,6 +1139,9 @@ namespace Ogre
             TextureDefinitionBase::recreateResizableBuffers( mDefinition->mLocalBufferDefs,
                                                              mGlobalBuffers, finalTarget,
                                                              mRenderSys, allNodes, 0 );
+
+            if( recreateNodes )
+                recreateAllNodes();
         }
 
         CompositorNodeVec::const_iterator itor = mNodeSequence.begin();
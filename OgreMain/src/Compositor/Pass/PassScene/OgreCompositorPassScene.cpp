@@ -204,6 +204,8 @@ namespace Ogre
 
         if( !mDefinition->mReuseCullData )
         {
+            if( mMultiFrustum.valid )
+                sceneManager->_setPreCulledFrustum( &mMultiFrustum );
             mTarget->_updateViewportCullPhase01( mViewport, mCullCamera, usedLodCamera,
                                                  mDefinition->mFirstRQ, mDefinition->mLastRQ );
         }
@@ -242,6 +244,46 @@ namespace Ogre
         profilingEnd();
     }
     //-----------------------------------------------------------------------------------
+    MovableObject::MultiFrustum* CompositorPassScene::_prepareMultiFrustumCull(
+            const Camera *lodCamera )
+    {
+        mMultiFrustum.valid = false;
+
+        if( mDefinition->mReuseCullData || !mNumPassesLeft )
+            return 0;
+
+        Camera const *usedLodCamera = mLodCamera;
+        if( lodCamera && mDefinition->mLodCameraName == IdString() )
+            usedLodCamera = lodCamera;
+
+        //Mimic what execute & Viewport::_updateCullPhase01 will do to the camera.
+        //If we get it wrong, SceneManager will notice and cull normally.
+        const Real aspectRatio = (Real)mViewport->getActualWidth() /
+                                 (Real)std::max( 1, mViewport->getActualHeight() );
+        if( mCullCamera->getAutoAspectRatio() && mCullCamera->getAspectRatio() != aspectRatio )
+            mCullCamera->setAspectRatio( aspectRatio );
+
+        const Quaternion oldCameraOrientation( mCamera->getOrientation() );
+        if( mDefinition->mCameraCubemapReorient )
+        {
+            uint32 sliceIdx = std::min<uint32>( mDefinition->getRtIndex(), 5 );
+            mCamera->setOrientation( oldCameraOrientation * CubemapRotations[sliceIdx] );
+        }
+
+        const SceneManager *sceneManager = mCamera->getSceneManager();
+        const uint32 visibilityMask = (mDefinition->mVisibilityMask & sceneManager->getVisibilityMask()) |
+                                      (mDefinition->mVisibilityMask &
+                                       ~VisibilityFlags::RESERVED_VISIBILITY_FLAGS);
+
+        mMultiFrustum.set( mCullCamera, usedLodCamera, visibilityMask,
+                           mDefinition->mFirstRQ, mDefinition->mLastRQ );
+
+        if( mDefinition->mCameraCubemapReorient )
+            mCamera->setOrientation( oldCameraOrientation );
+
+        return &mMultiFrustum;
+    }
+    //-----------------------------------------------------------------------------------
     void CompositorPassScene::_placeBarriersAndEmulateUavExecution( BoundUav boundUavs[64],
                                                                     ResourceAccessMap &uavsAccess,
                                                                     ResourceLayoutMap &resourcesLayout )
@@ -60,7 +60,9 @@ namespace Ogre
                             mMaxHardLimit( maxHardLimit ),
                             mCleanupThreshold( cleanupThreshold ),
                             mRebaseListener( rebaseListener ),
-                            mLevel( depthLevel )
+                            mLevel( depthLevel ),
+                            mBackPoolsMaxMemory( 0 ),
+                            mBackPoolsDirty( false )
     {
         //If the assert triggers, their values will overflow to 0 when
         //trying to round to nearest multiple of ARRAY_PACKED_REALS
@@ -126,6 +128,8 @@ namespace Ogre
             OGRE_FREE_SIMD( *itor, MEMCATEGORY_SCENE_OBJECTS );
             *itor++ = 0;
         }
+
+        setDoubleBuffered( false );
     }
     //-----------------------------------------------------------------------------------
     size_t ArrayMemoryManager::getNumUsedSlotsIncludingFragmented() const
@@ -154,10 +158,93 @@ namespace Ogre
         return mMaxMemory * mTotalMemoryMultiplier;
     }
     //-----------------------------------------------------------------------------------
+    void ArrayMemoryManager::setDoubleBuffered( bool doubleBuffered )
+    {
+        if( doubleBuffered == getDoubleBuffered() )
+            return;
+
+        if( doubleBuffered )
+        {
+            mBackPools.resize( mMemoryPools.size(), 0 );
+            mBackPoolsMaxMemory = 0;
+            mBackPoolsDirty     = true;
+            _syncBackBuffers();
+        }
+        else
+        {
+            MemoryPoolVec::iterator itor = mBackPools.begin();
+            MemoryPoolVec::iterator end  = mBackPools.end();
+
+            while( itor != end )
+            {
+                if( *itor )
+                    OGRE_FREE_SIMD( *itor, MEMCATEGORY_SCENE_OBJECTS );
+                ++itor;
+            }
+
+            mBackPools.clear();
+            mBackPoolsMaxMemory = 0;
+            mBackPoolsDirty     = false;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void ArrayMemoryManager::_syncBackBuffers(void)
+    {
+        if( mBackPools.empty() )
+            return;
+
+        //SoA data is read in packs, so copy whole packs
+        const size_t numSlots = ( (mUsedMemory + ARRAY_PACKED_REALS - 1) / ARRAY_PACKED_REALS ) *
+                                ARRAY_PACKED_REALS;
+
+        for( size_t i=0; i<mMemoryPools.size(); ++i )
+        {
+            if( !needsBackBuffer( i ) && !isBackBufferInput( i ) )
+                continue;
+
+            if( mBackPoolsMaxMemory != mMaxMemory )
+            {
+                //The front pools grew (or this is the first sync)
+                if( mBackPools[i] )
+                    OGRE_FREE_SIMD( mBackPools[i], MEMCATEGORY_SCENE_OBJECTS );
+                mBackPools[i] = (char*)OGRE_MALLOC_SIMD( mMaxMemory * mElementsMemSizes[i],
+                                                         MEMCATEGORY_SCENE_OBJECTS );
+            }
+
+            if( mBackPoolsDirty )
+                memcpy( mBackPools[i], mMemoryPools[i], mMaxMemory * mElementsMemSizes[i] );
+            else if( isBackBufferInput( i ) )
+                memcpy( mBackPools[i], mMemoryPools[i], numSlots * mElementsMemSizes[i] );
+        }
+
+        mBackPoolsMaxMemory = mMaxMemory;
+        mBackPoolsDirty     = false;
+    }
+    //-----------------------------------------------------------------------------------
+    void ArrayMemoryManager::_publishBackBuffers(void)
+    {
+        assert( !mBackPoolsDirty && "Slots were created or destroyed while "
+                "the back buffer was being written to!" );
+
+        if( mBackPools.empty() )
+            return;
+
+        //SoA data is written in packs, so copy whole packs
+        const size_t numSlots = ( (mUsedMemory + ARRAY_PACKED_REALS - 1) / ARRAY_PACKED_REALS ) *
+                                ARRAY_PACKED_REALS;
+
+        for( size_t i=0; i<mMemoryPools.size(); ++i )
+        {
+            if( needsBackBuffer( i ) )
+                memcpy( mMemoryPools[i], mBackPools[i], numSlots * mElementsMemSizes[i] );
+        }
+    }
+    //-----------------------------------------------------------------------------------
     size_t ArrayMemoryManager::createNewSlot()
     {
         size_t nextSlot = mUsedMemory;
         ++mUsedMemory;
+        mBackPoolsDirty = true;
 
         //See if we can reuse a slot that was previously acquired and released
         if( !mAvailableSlots.empty() )
@@ -176,51 +263,86 @@ namespace Ogre
                             "ArrayMemoryManager::createNewNode" );
             }
 
-            //Build the diff list for rebase later.
-            PtrdiffVec diffsList;
-            diffsList.reserve( mUsedMemory );
-            mRebaseListener->buildDiffList( mLevel, mMemoryPools, diffsList );
-
-            //Reallocate, grow by 50% increments, rounding up to next multiple of ARRAY_PACKED_REALS
+            //Grow by 50% increments, rounding up to next multiple of ARRAY_PACKED_REALS
             size_t newMemory = std::min( mMaxMemory + (mMaxMemory >> 1), mMaxHardLimit );
             newMemory+= (ARRAY_PACKED_REALS - newMemory % ARRAY_PACKED_REALS) % ARRAY_PACKED_REALS;
             newMemory = std::min( newMemory, mMaxHardLimit );
 
-            size_t i=0;
-            MemoryPoolVec::iterator itor = mMemoryPools.begin();
-            MemoryPoolVec::iterator end  = mMemoryPools.end();
+            growPools( newMemory );
+        }
 
-            while( itor != end )
+        return nextSlot;
+    }
+    //-----------------------------------------------------------------------------------
+    void ArrayMemoryManager::growPools( size_t newMemory )
+    {
+        //Build the diff list for rebase later.
+        PtrdiffVec diffsList;
+        diffsList.reserve( mUsedMemory );
+        mRebaseListener->buildDiffList( mLevel, mMemoryPools, diffsList );
+
+        size_t i=0;
+        MemoryPoolVec::iterator itor = mMemoryPools.begin();
+        MemoryPoolVec::iterator end  = mMemoryPools.end();
+
+        while( itor != end )
+        {
+            //Reallocate
+            char *tmp = (char*)OGRE_MALLOC_SIMD( newMemory * mElementsMemSizes[i],
+                                                 MEMCATEGORY_SCENE_OBJECTS );
+            memcpy( tmp, *itor, mMaxMemory * mElementsMemSizes[i] );
+            if( mInitRoutines && mInitRoutines[i] )
             {
-                //Reallocate
-                char *tmp = (char*)OGRE_MALLOC_SIMD( newMemory * mElementsMemSizes[i],
-                                                     MEMCATEGORY_SCENE_OBJECTS );
-                memcpy( tmp, *itor, mMaxMemory * mElementsMemSizes[i] );
-                if( mInitRoutines && mInitRoutines[i] )
-                {
-                    mInitRoutines[i]( tmp + mMaxMemory * mElementsMemSizes[i], 0, 0, 0, 0,
-                                      newMemory - mMaxMemory, mElementsMemSizes[i] );
-                }
-                else
-                {
-                    memset( tmp + mMaxMemory * mElementsMemSizes[i], 0,
-                            (newMemory - mMaxMemory) * mElementsMemSizes[i] );
-                }
-                OGRE_FREE_SIMD( *itor, MEMCATEGORY_SCENE_OBJECTS );
-                *itor = tmp;
-                ++i;
-                ++itor;
+                mInitRoutines[i]( tmp + mMaxMemory * mElementsMemSizes[i], 0, 0, 0, 0,
+                                  newMemory - mMaxMemory, mElementsMemSizes[i] );
             }
+            else
+            {
+                memset( tmp + mMaxMemory * mElementsMemSizes[i], 0,
+                        (newMemory - mMaxMemory) * mElementsMemSizes[i] );
+            }
+            OGRE_FREE_SIMD( *itor, MEMCATEGORY_SCENE_OBJECTS );
+            *itor = tmp;
+            ++i;
+            ++itor;
+        }
+
+        const size_t prevNumSlots = mMaxMemory;
+        mMaxMemory = newMemory;
+        initializeEmptySlots( prevNumSlots );
+
+        //The front pools moved. The back pools must be reallocated & resynced
+        //(reserve() grows without creating slots, so nobody else flags it)
+        mBackPoolsDirty = true;
 
-            const size_t prevNumSlots = mMaxMemory;
-            mMaxMemory = newMemory;
-            initializeEmptySlots( prevNumSlots );
+        //Rebase all ptrs
+        mRebaseListener->applyRebase( mLevel, mMemoryPools, diffsList );
+    }
+    //-----------------------------------------------------------------------------------
+    bool ArrayMemoryManager::reserve( size_t numSlots )
+    {
+        //Released slots get reused first
+        numSlots -= std::min( numSlots, mAvailableSlots.size() );
 
-            //Rebase all ptrs
-            mRebaseListener->applyRebase( mLevel, mMemoryPools, diffsList );
+        const size_t requiredMemory = mUsedMemory + numSlots + OGRE_PREFETCH_SLOT_DISTANCE;
+        if( requiredMemory <= mMaxMemory )
+            return false;
+
+        if( requiredMemory > mMaxHardLimit )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                        "Trying to allocate more memory than the limit allowed by user",
+                        "ArrayMemoryManager::reserve" );
         }
 
-        return nextSlot;
+        //Same rounding as createNewSlot; never grow by less than it would.
+        size_t newMemory = std::max( requiredMemory, mMaxMemory + (mMaxMemory >> 1) );
+        newMemory+= (ARRAY_PACKED_REALS - newMemory % ARRAY_PACKED_REALS) % ARRAY_PACKED_REALS;
+        newMemory = std::min( newMemory, mMaxHardLimit );
+
+        growPools( newMemory );
+
+        return true;
     }
     //-----------------------------------------------------------------------------------
     void ArrayMemoryManager::destroySlot( const char *ptrToFirstElement, uint8 index )
@@ -231,6 +353,8 @@ namespace Ogre
 
         assert( slot < mMaxMemory && "This slot does not belong to this ArrayMemoryManager" );
 
+        mBackPoolsDirty = true;
+
         if( slot + 1 == mUsedMemory )
         {
             //Lucky us, LIFO. We're done.
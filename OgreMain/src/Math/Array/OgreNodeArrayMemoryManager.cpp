@@ -99,6 +99,17 @@ namespace Ogre
             *nodesPtr++ = mDummyNode;
     }
     //-----------------------------------------------------------------------------------
+    bool NodeArrayMemoryManager::needsBackBuffer( size_t memoryType ) const
+    {
+        return memoryType >= DerivedPosition && memoryType <= WorldMat;
+    }
+    //-----------------------------------------------------------------------------------
+    bool NodeArrayMemoryManager::isBackBufferInput( size_t memoryType ) const
+    {
+        return ( memoryType >= Position && memoryType <= Scale ) ||
+               memoryType == InheritOrientation || memoryType == InheritScale;
+    }
+    //-----------------------------------------------------------------------------------
     void NodeArrayMemoryManager::createNewNode( Transform &outTransform )
     {
         const size_t nextSlot = createNewSlot();
@@ -178,4 +189,24 @@ namespace Ogre
 
         return mUsedMemory;
     }
+    //-----------------------------------------------------------------------------------
+    void NodeArrayMemoryManager::_toBackBuffer( Transform &inOutTransform ) const
+    {
+        inOutTransform.mPosition            = _getBackBufferPtr( inOutTransform.mPosition, Position );
+        inOutTransform.mOrientation         = _getBackBufferPtr( inOutTransform.mOrientation,
+                                                                 Orientation );
+        inOutTransform.mScale               = _getBackBufferPtr( inOutTransform.mScale, Scale );
+        inOutTransform.mDerivedPosition     = _getBackBufferPtr( inOutTransform.mDerivedPosition,
+                                                                 DerivedPosition );
+        inOutTransform.mDerivedOrientation  = _getBackBufferPtr( inOutTransform.mDerivedOrientation,
+                                                                 DerivedOrientation );
+        inOutTransform.mDerivedScale        = _getBackBufferPtr( inOutTransform.mDerivedScale,
+                                                                 DerivedScale );
+        inOutTransform.mDerivedTransform    = _getBackBufferPtr( inOutTransform.mDerivedTransform,
+                                                                 WorldMat );
+        inOutTransform.mInheritOrientation  = _getBackBufferPtr( inOutTransform.mInheritOrientation,
+                                                                 InheritOrientation );
+        inOutTransform.mInheritScale        = _getBackBufferPtr( inOutTransform.mInheritScale,
+                                                                 InheritScale );
+    }
 }
@@ -31,13 +31,16 @@ THE SOFTWARE.
 #include "Math/Array/OgreNodeMemoryManager.h"
 
 #include "OgreSceneNode.h"
+#include "OgreSceneManager.h"
 
 namespace Ogre
 {
     NodeMemoryManager::NodeMemoryManager() :
             mDummyNode( 0 ),
             mMemoryManagerType( SCENE_DYNAMIC ),
-            mTwinMemoryManager( 0 )
+            mTwinMemoryManager( 0 ),
+            mDoubleBuffered( false ),
+            mSceneManager( 0 )
     {
         //Manually allocate the memory for the dummy scene nodes (since we can't pass ourselves
         //or yet another object) We only allocate what's needed to prevent access violations.
@@ -111,6 +114,12 @@ namespace Ogre
         mTwinMemoryManager = twinMemoryManager;
     }
     //-----------------------------------------------------------------------------------
+    void NodeMemoryManager::finishPendingSceneGraphUpdate(void)
+    {
+        if( mSceneManager )
+            mSceneManager->_finishPendingSceneGraphUpdate();
+    }
+    //-----------------------------------------------------------------------------------
     void NodeMemoryManager::growToDepth( size_t newDepth )
     {
         //TODO: (dark_sylinc) give a specialized hint for each depth
@@ -121,11 +130,14 @@ namespace Ogre
                                                                 ArrayMemoryManager::MAX_MEMORY_SLOTS,
                                                                 this ) );
             mMemoryManagers.back().initialize();
+            mMemoryManagers.back().setDoubleBuffered( mDoubleBuffered );
         }
     }
     //-----------------------------------------------------------------------------------
     void NodeMemoryManager::nodeCreated( Transform &outTransform, size_t depth )
     {
+        finishPendingSceneGraphUpdate();
+
         growToDepth( depth );
 
         NodeArrayMemoryManager& mgr = mMemoryManagers[depth];
@@ -139,6 +151,8 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void NodeMemoryManager::nodeDettached( Transform &outTransform, size_t depth )
     {
+        finishPendingSceneGraphUpdate();
+
         Transform tmp;
         mMemoryManagers[0].createNewNode( tmp );
 
@@ -153,12 +167,16 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void NodeMemoryManager::nodeDestroyed( Transform &outTransform, size_t depth )
     {
+        finishPendingSceneGraphUpdate();
+
         NodeArrayMemoryManager &mgr = mMemoryManagers[depth];
         mgr.destroyNode( outTransform );
     }
     //-----------------------------------------------------------------------------------
     void NodeMemoryManager::nodeMoved( Transform &inOutTransform, size_t oldDepth, size_t newDepth )
     {
+        finishPendingSceneGraphUpdate();
+
         growToDepth( newDepth );
 
         Transform tmp;
@@ -202,6 +220,8 @@ namespace Ogre
     void NodeMemoryManager::migrateToAndDetach( Transform &outTransform, size_t depth,
                                                 NodeMemoryManager *dstNodeMemoryManager )
     {
+        finishPendingSceneGraphUpdate();
+
         Transform tmp;
         dstNodeMemoryManager->mMemoryManagers[0].createNewNode( tmp );
 
@@ -236,6 +256,53 @@ namespace Ogre
         return mMemoryManagers[depth].getFirstNode( outTransform );
     }
     //-----------------------------------------------------------------------------------
+    void NodeMemoryManager::reserve( size_t depth, size_t numNodes )
+    {
+        finishPendingSceneGraphUpdate();
+
+        growToDepth( depth );
+        mMemoryManagers[depth].reserve( numNodes );
+    }
+    //-----------------------------------------------------------------------------------
+    void NodeMemoryManager::setDoubleBuffered( bool doubleBuffered, SceneManager *sceneManager )
+    {
+        mDoubleBuffered = doubleBuffered;
+        mSceneManager   = doubleBuffered ? sceneManager : 0;
+
+        ArrayMemoryManagerVec::iterator itor = mMemoryManagers.begin();
+        ArrayMemoryManagerVec::iterator end  = mMemoryManagers.end();
+
+        while( itor != end )
+        {
+            itor->setDoubleBuffered( doubleBuffered );
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void NodeMemoryManager::_syncBackBuffers(void)
+    {
+        ArrayMemoryManagerVec::iterator itor = mMemoryManagers.begin();
+        ArrayMemoryManagerVec::iterator end  = mMemoryManagers.end();
+
+        while( itor != end )
+        {
+            itor->_syncBackBuffers();
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void NodeMemoryManager::_publishBackBuffers( size_t firstDepth )
+    {
+        for( size_t i=firstDepth; i<mMemoryManagers.size(); ++i )
+            mMemoryManagers[i]._publishBackBuffers();
+    }
+    //-----------------------------------------------------------------------------------
+    void NodeMemoryManager::_toBackBuffer( Transform &inOutTransform, size_t depth ) const
+    {
+        if( mDoubleBuffered && depth < mMemoryManagers.size() )
+            mMemoryManagers[depth]._toBackBuffer( inOutTransform );
+    }
+    //-----------------------------------------------------------------------------------
     void NodeMemoryManager::buildDiffList( uint16 level, const MemoryPoolVec &basePtrs,
                                            ArrayMemoryManager::PtrdiffVec &outDiffsList )
     {
@@ -91,6 +91,16 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    bool ObjectDataArrayMemoryManager::needsBackBuffer( size_t memoryType ) const
+    {
+        return memoryType == WorldAabb || memoryType == WorldRadius;
+    }
+    //-----------------------------------------------------------------------------------
+    bool ObjectDataArrayMemoryManager::isBackBufferInput( size_t memoryType ) const
+    {
+        return memoryType == LocalAabb || memoryType == LocalRadius;
+    }
+    //-----------------------------------------------------------------------------------
     void ObjectDataArrayMemoryManager::createNewNode( ObjectData &outData )
     {
         const size_t nextSlot = createNewSlot();
@@ -156,4 +166,12 @@ namespace Ogre
         memcpy( &outData.mParents, &mMemoryPools[0], sizeof(void*) * mMemoryPools.size() );
         return mUsedMemory;
     }
+    //-----------------------------------------------------------------------------------
+    void ObjectDataArrayMemoryManager::_toBackBuffer( ObjectData &inOutData ) const
+    {
+        inOutData.mLocalAabb    = _getBackBufferPtr( inOutData.mLocalAabb, LocalAabb );
+        inOutData.mWorldAabb    = _getBackBufferPtr( inOutData.mWorldAabb, WorldAabb );
+        inOutData.mLocalRadius  = _getBackBufferPtr( inOutData.mLocalRadius, LocalRadius );
+        inOutData.mWorldRadius  = _getBackBufferPtr( inOutData.mWorldRadius, WorldRadius );
+    }
 }
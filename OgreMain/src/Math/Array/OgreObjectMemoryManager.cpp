@@ -31,15 +31,19 @@ THE SOFTWARE.
 #include "Math/Array/OgreObjectMemoryManager.h"
 
 #include "OgreMovableObject.h"
+#include "OgreSceneManager.h"
 
 namespace Ogre
 {
     ObjectMemoryManager::ObjectMemoryManager() :
             mTotalObjects( 0 ),
+            mLayoutVersion( 0 ),
             mDummyNode( 0 ),
             mDummyObject( 0 ),
             mMemoryManagerType( SCENE_DYNAMIC ),
-            mTwinMemoryManager( 0 )
+            mTwinMemoryManager( 0 ),
+            mDoubleBuffered( false ),
+            mSceneManager( 0 )
     {
         //Manually allocate the memory for the dummy scene nodes (since we can't pass ourselves
         //or yet another object) We only allocate what's needed to prevent access violations.
@@ -115,6 +119,12 @@ namespace Ogre
         mTwinMemoryManager = twinMemoryManager;
     }
     //-----------------------------------------------------------------------------------
+    void ObjectMemoryManager::finishPendingSceneGraphUpdate(void)
+    {
+        if( mSceneManager )
+            mSceneManager->_finishPendingSceneGraphUpdate();
+    }
+    //-----------------------------------------------------------------------------------
     void ObjectMemoryManager::growToDepth( size_t newDepth )
     {
         //TODO: (dark_sylinc) give a specialized hint for each depth
@@ -124,22 +134,28 @@ namespace Ogre
                                             mDummyNode, mDummyObject, 100,
                                             ArrayMemoryManager::MAX_MEMORY_SLOTS, this ) );
             mMemoryManagers.back().initialize();
+            mMemoryManagers.back().setDoubleBuffered( mDoubleBuffered );
         }
     }
     //-----------------------------------------------------------------------------------
     void ObjectMemoryManager::objectCreated( ObjectData &outObjectData, size_t renderQueue )
     {
+        finishPendingSceneGraphUpdate();
+
         growToDepth( renderQueue );
 
         ObjectDataArrayMemoryManager& mgr = mMemoryManagers[renderQueue];
         mgr.createNewNode( outObjectData );
 
         ++mTotalObjects;
+        ++mLayoutVersion;
     }
     //-----------------------------------------------------------------------------------
     void ObjectMemoryManager::objectMoved( ObjectData &inOutObjectData, size_t oldRenderQueue,
                                             size_t newRenderQueue )
     {
+        finishPendingSceneGraphUpdate();
+
         growToDepth( newRenderQueue );
 
         ObjectData tmp;
@@ -151,14 +167,19 @@ namespace Ogre
         mgr.destroyNode( inOutObjectData );
 
         inOutObjectData = tmp;
+
+        ++mLayoutVersion;
     }
     //-----------------------------------------------------------------------------------
     void ObjectMemoryManager::objectDestroyed( ObjectData &outObjectData, size_t renderQueue )
     {
+        finishPendingSceneGraphUpdate();
+
         ObjectDataArrayMemoryManager &mgr = mMemoryManagers[renderQueue];
         mgr.destroyNode( outObjectData );
 
         --mTotalObjects;
+        ++mLayoutVersion;
     }
     //-----------------------------------------------------------------------------------
     void ObjectMemoryManager::migrateTo( ObjectData &inOutObjectData, size_t renderQueue,
@@ -209,6 +230,60 @@ namespace Ogre
         return mMemoryManagers[renderQueue].getFirstNode( outObjectData );
     }
     //-----------------------------------------------------------------------------------
+    void ObjectMemoryManager::reserve( size_t renderQueue, size_t numObjects )
+    {
+        finishPendingSceneGraphUpdate();
+
+        growToDepth( renderQueue );
+        if( mMemoryManagers[renderQueue].reserve( numObjects ) )
+            ++mLayoutVersion;
+    }
+    //-----------------------------------------------------------------------------------
+    void ObjectMemoryManager::setDoubleBuffered( bool doubleBuffered, SceneManager *sceneManager )
+    {
+        mDoubleBuffered = doubleBuffered;
+        mSceneManager   = doubleBuffered ? sceneManager : 0;
+
+        ArrayMemoryManagerVec::iterator itor = mMemoryManagers.begin();
+        ArrayMemoryManagerVec::iterator end  = mMemoryManagers.end();
+
+        while( itor != end )
+        {
+            itor->setDoubleBuffered( doubleBuffered );
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void ObjectMemoryManager::_syncBackBuffers(void)
+    {
+        ArrayMemoryManagerVec::iterator itor = mMemoryManagers.begin();
+        ArrayMemoryManagerVec::iterator end  = mMemoryManagers.end();
+
+        while( itor != end )
+        {
+            itor->_syncBackBuffers();
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void ObjectMemoryManager::_publishBackBuffers(void)
+    {
+        ArrayMemoryManagerVec::iterator itor = mMemoryManagers.begin();
+        ArrayMemoryManagerVec::iterator end  = mMemoryManagers.end();
+
+        while( itor != end )
+        {
+            itor->_publishBackBuffers();
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void ObjectMemoryManager::_toBackBuffer( ObjectData &inOutObjectData, size_t renderQueue ) const
+    {
+        if( mDoubleBuffered )
+            mMemoryManagers[renderQueue]._toBackBuffer( inOutObjectData );
+    }
+    //-----------------------------------------------------------------------------------
     void ObjectMemoryManager::buildDiffList( uint16 level, const MemoryPoolVec &basePtrs,
                                              ArrayMemoryManager::PtrdiffVec &outDiffsList )
     {
@@ -256,6 +331,8 @@ namespace Ogre
                                               size_t const *elementsMemSizes,
                                               size_t startInstance, size_t diffInstances )
     {
+        ++mLayoutVersion;
+
         ObjectData objectData;
         const size_t numObjs = this->getFirstObjectData( objectData, level );
 
@@ -55,6 +55,7 @@ namespace Ogre {
         mCullFrustum(0),
         mUseRenderingDistance(true),
         mLodCamera(0),
+        mShadowCasterVolume(0),
         mUseMinPixelSize(false),
         mPixelDisplayRatio(0)
     {
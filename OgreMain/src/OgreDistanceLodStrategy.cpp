@@ -78,7 +78,8 @@ namespace Ogre {
     }
     //-----------------------------------------------------------------------
     void DistanceLodStrategyBase::lodUpdateImpl( const size_t numNodes, ObjectData objData,
-                                             const Camera *camera, Real bias ) const
+                                             const Camera *camera, Real bias,
+                                             Real hysteresis, LodTransitions &outTransitions ) const
     {
         ArrayVector3 cameraPos;
         cameraPos.setAll( camera->_getCachedDerivedPosition() );
@@ -94,7 +95,7 @@ namespace Ogre {
             arrayLodValue = arrayLodValue * lodInvBias;
             CastArrayToReal( lodValues, arrayLodValue );
 
-            lodSet( objData, lodValues );
+            lodSet( objData, lodValues, hysteresis, outTransitions );
 
             objData.advanceLodPack();
         }
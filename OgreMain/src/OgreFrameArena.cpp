@@ -0,0 +1,118 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2017 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreFrameArena.h"
+
+namespace Ogre
+{
+    FrameArena::FrameArena( size_t initialCapacity ) :
+        mBlock( 0 ),
+        mCapacity( alignToNextMultiple( std::max<size_t>( initialCapacity, 1u ),
+                                        OGRE_SIMD_ALIGNMENT ) ),
+        mOffset( 0 ),
+        mOverflowOffset( 0 ),
+        mOverflowCapacity( 0 ),
+        mOverflowBytes( 0 ),
+        mPeakBytes( 0 ),
+        mHighWaterMark( 0 ),
+        mNumHeapAllocations( 1u )
+    {
+        mBlock = reinterpret_cast<uint8*>( OGRE_MALLOC_SIMD( mCapacity, MEMCATEGORY_SCENE_CONTROL ) );
+    }
+    //-----------------------------------------------------------------------------------
+    FrameArena::~FrameArena()
+    {
+        FastArray<uint8*>::const_iterator itor = mOverflowBlocks.begin();
+        FastArray<uint8*>::const_iterator end  = mOverflowBlocks.end();
+
+        while( itor != end )
+        {
+            OGRE_FREE_SIMD( *itor, MEMCATEGORY_SCENE_CONTROL );
+            ++itor;
+        }
+
+        mOverflowBlocks.clear();
+
+        OGRE_FREE_SIMD( mBlock, MEMCATEGORY_SCENE_CONTROL );
+        mBlock = 0;
+    }
+    //-----------------------------------------------------------------------------------
+    void* FrameArena::allocateOverflow( size_t bytes )
+    {
+        if( mOverflowBlocks.empty() || mOverflowOffset + bytes > mOverflowCapacity )
+        {
+            //Grow geometrically so a frame that needs a lot more than
+            //the main block doesn't end up doing lots of small allocations.
+            mOverflowCapacity = std::max( bytes, mCapacity + mOverflowBytes );
+            mOverflowOffset = 0;
+            mOverflowBlocks.push_back( reinterpret_cast<uint8*>(
+                                           OGRE_MALLOC_SIMD( mOverflowCapacity,
+                                                             MEMCATEGORY_SCENE_CONTROL ) ) );
+            ++mNumHeapAllocations;
+        }
+
+        void *retVal = mOverflowBlocks.back() + mOverflowOffset;
+        mOverflowOffset += bytes;
+        mOverflowBytes  += bytes;
+        mPeakBytes = std::max( mPeakBytes, mOffset + mOverflowBytes );
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------------
+    void FrameArena::reset(void)
+    {
+        if( !mOverflowBlocks.empty() )
+        {
+            FastArray<uint8*>::const_iterator itor = mOverflowBlocks.begin();
+            FastArray<uint8*>::const_iterator end  = mOverflowBlocks.end();
+
+            while( itor != end )
+            {
+                OGRE_FREE_SIMD( *itor, MEMCATEGORY_SCENE_CONTROL );
+                ++itor;
+            }
+
+            mOverflowBlocks.clear();
+
+            //Grow the main block so that next time everything fits in it.
+            OGRE_FREE_SIMD( mBlock, MEMCATEGORY_SCENE_CONTROL );
+            mCapacity = alignToNextMultiple( mPeakBytes + (mPeakBytes >> 2u), OGRE_SIMD_ALIGNMENT );
+            mBlock = reinterpret_cast<uint8*>( OGRE_MALLOC_SIMD( mCapacity,
+                                                                 MEMCATEGORY_SCENE_CONTROL ) );
+            ++mNumHeapAllocations;
+        }
+
+        mHighWaterMark      = std::max( mHighWaterMark, mPeakBytes );
+        mOffset             = 0;
+        mOverflowOffset     = 0;
+        mOverflowCapacity   = 0;
+        mOverflowBytes      = 0;
+        mPeakBytes          = 0;
+    }
+}
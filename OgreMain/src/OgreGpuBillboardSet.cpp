@@ -0,0 +1,520 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2017 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreGpuBillboardSet.h"
+
+#include "Vao/OgreVaoManager.h"
+#include "Vao/OgreVertexArrayObject.h"
+#include "Vao/OgreTexBufferPacked.h"
+
+#include "OgreSceneManager.h"
+#include "OgreCamera.h"
+#include "OgreParticleSystem.h"
+#include "OgreParticle.h"
+#include "OgreParticleIterator.h"
+#include "OgreRenderSystem.h"
+
+#include "OgreRoot.h"
+#include "OgreHlms.h"
+#include "OgreHlmsManager.h"
+
+#if OGRE_USE_SIMD == 1 && OGRE_CPU == OGRE_CPU_X86
+    #include <emmintrin.h>
+    #define OGRE_GPU_BILLBOARD_SSE2 1
+#else
+    #define OGRE_GPU_BILLBOARD_SSE2 0
+#endif
+
+namespace Ogre
+{
+    namespace
+    {
+        /// Maps the depth to a uint32 whose ascending order is descending depth
+        /// (i.e. back to front). Same as the SSE2 path in computeDepthKeys.
+        inline uint32 depthToKey( float depth )
+        {
+            uint32 bits;
+            memcpy( &bits, &depth, sizeof( bits ) );
+            //Negative floats: flip all bits. Positive ones: flip the sign bit.
+            //That gives an unsigned int with the same order as the float.
+            const uint32 mask = static_cast<uint32>( -static_cast<int32>( bits >> 31u ) ) |
+                                0x80000000u;
+            return ~(bits ^ mask);
+        }
+    }
+
+    const size_t GpuBillboardSet::CustomParameterIdx = 0x47425353; //'GBSS'
+    //-----------------------------------------------------------------------------------
+    GpuBillboardSet::GpuBillboardSet( IdType id, ObjectMemoryManager *objectMemoryManager,
+                                      SceneManager *manager ) :
+        MovableObject( id, objectMemoryManager, manager, 0 ),
+        Renderable(),
+        mSortingEnabled( true ),
+        mVaoManager( 0 ),
+        mRecordBuffer( 0 ),
+        mRecordBufferTexels( 0 )
+    {
+        Aabb aabb( Aabb::BOX_ZERO );
+        mObjectData.mLocalAabb->setFromAabb( aabb, mObjectData.mIndex );
+        mObjectData.mWorldAabb->setFromAabb( aabb, mObjectData.mIndex );
+        mObjectData.mLocalRadius[mObjectData.mIndex] = aabb.getRadius();
+        mObjectData.mWorldRadius[mObjectData.mIndex] = aabb.getRadius();
+
+        mUvRects.push_back( Vector4( 0, 0, 1, 1 ) );
+
+        mVaoManager = mManager->getDestinationRenderSystem()->getVaoManager();
+
+        //Bufferless Vao. The vertex shader builds the quads from mRecordBuffer.
+        VertexBufferPackedVec vertexBuffers;
+        VertexArrayObject *vao = mVaoManager->createVertexArrayObject( vertexBuffers, 0,
+                                                                       OT_TRIANGLE_LIST );
+        vao->setPrimitiveRange( 0, 0 );
+        mVaoPerLod[VpNormal].push_back( vao );
+        mVaoPerLod[VpShadow].push_back( vao );
+
+        createRecordBuffer( 256u );
+
+        setCastShadows( false );
+        mRenderables.push_back( this );
+
+        setCustomParameter( CustomParameterIdx, Vector4::ZERO );
+
+        this->setDatablock( Root::getSingleton().getHlmsManager()->
+                            getHlms( HLMS_UNLIT )->getDefaultDatablock() );
+    }
+    //-----------------------------------------------------------------------------------
+    GpuBillboardSet::~GpuBillboardSet()
+    {
+        destroyRecordBuffer();
+
+        VertexArrayObjectArray::const_iterator itor = mVaoPerLod[VpNormal].begin();
+        VertexArrayObjectArray::const_iterator end  = mVaoPerLod[VpNormal].end();
+
+        while( itor != end )
+            mVaoManager->destroyVertexArrayObject( *itor++ );
+
+        mVaoPerLod[VpNormal].clear();
+        mVaoPerLod[VpShadow].clear();
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuBillboardSet::createRecordBuffer( size_t numTexels )
+    {
+        assert( !mRecordBuffer );
+        mRecordBuffer = mVaoManager->createTexBuffer( PF_FLOAT32_RGBA,
+                                                      numTexels * 4u * sizeof(float),
+                                                      BT_DYNAMIC_DEFAULT, 0, false );
+        mRecordBufferTexels = numTexels;
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuBillboardSet::destroyRecordBuffer(void)
+    {
+        if( mRecordBuffer )
+        {
+            if( mRecordBuffer->getMappingState() != MS_UNMAPPED )
+                mRecordBuffer->unmap( UO_UNMAP_ALL );
+            mVaoManager->destroyTexBuffer( mRecordBuffer );
+            mRecordBuffer = 0;
+            mRecordBufferTexels = 0;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuBillboardSet::clear(void)
+    {
+        mRecords.clear();
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuBillboardSet::reserve( size_t numBillboards )
+    {
+        mRecords.reserve( numBillboards );
+    }
+    //-----------------------------------------------------------------------------------
+    size_t GpuBillboardSet::addBillboard( const Vector3 &position, const Vector2 &size,
+                                          const ColourValue &colour, Radian rotation,
+                                          uint32 uvRectIdx )
+    {
+        assert( uvRectIdx < mUvRects.size() );
+        mRecords.push_back( Record() );
+        packRecord( mRecords.back(), position, size * 0.5f, colour, rotation, uvRectIdx );
+        return mRecords.size() - 1u;
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuBillboardSet::setFromParticles( ParticleSystem *particleSystem )
+    {
+        mRecords.clear();
+        mRecords.reserve( particleSystem->getNumParticles() );
+
+        const Vector2 defaultHalfSize( particleSystem->getDefaultWidth() * 0.5f,
+                                       particleSystem->getDefaultHeight() * 0.5f );
+
+        ParticleIterator itor = particleSystem->_getIterator();
+        while( !itor.end() )
+        {
+            const Particle *particle = itor.getNext();
+            if( particle->mParticleType == Particle::Visual )
+            {
+                Vector2 halfSize = defaultHalfSize;
+                if( particle->mOwnDimensions )
+                    halfSize = Vector2( particle->mWidth, particle->mHeight ) * 0.5f;
+
+                mRecords.push_back( Record() );
+                packRecord( mRecords.back(), particle->mPosition, halfSize,
+                            particle->mColour, particle->mRotation, 0 );
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuBillboardSet::setUvRects( const Vector4 *uvRects, size_t numUvRects )
+    {
+        if( !numUvRects )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "At least one UV rect is required",
+                         "GpuBillboardSet::setUvRects" );
+        }
+
+        mUvRects.clear();
+        mUvRects.appendPOD( uvRects, uvRects + numUvRects );
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuBillboardSet::setTextureStacksAndSlices( uint8 stacks, uint8 slices )
+    {
+        if( stacks == 0 ) stacks = 1;
+        if( slices == 0 ) slices = 1;
+
+        mUvRects.clear();
+        mUvRects.reserve( stacks * slices );
+
+        const float width   = 1.0f / slices;
+        const float height  = 1.0f / stacks;
+
+        for( uint8 v=0; v<stacks; ++v )
+        {
+            for( uint8 u=0; u<slices; ++u )
+            {
+                mUvRects.push_back( Vector4( u * width, v * height,
+                                             (u + 1) * width, (v + 1) * height ) );
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuBillboardSet::updateLocalAabb(void)
+    {
+        if( mRecords.empty() )
+        {
+            mObjectData.mLocalAabb->setFromAabb( Aabb::BOX_ZERO, mObjectData.mIndex );
+            mObjectData.mLocalRadius[mObjectData.mIndex] = 0;
+            return;
+        }
+
+        Vector3 vMin( Math::POS_INFINITY );
+        Vector3 vMax( Math::NEG_INFINITY );
+        Real maxHalfDiagonalSq = 0;
+
+        RecordArray::const_iterator itor = mRecords.begin();
+        RecordArray::const_iterator end  = mRecords.end();
+
+        while( itor != end )
+        {
+            const Vector3 pos( itor->position[0], itor->position[1], itor->position[2] );
+            vMin.makeFloor( pos );
+            vMax.makeCeil( pos );
+            maxHalfDiagonalSq = std::max<Real>( maxHalfDiagonalSq,
+                                                itor->halfSize[0] * itor->halfSize[0] +
+                                                itor->halfSize[1] * itor->halfSize[1] );
+            ++itor;
+        }
+
+        //Quads face the camera and may be rotated, so pad by the largest half diagonal.
+        const Vector3 padding( Math::Sqrt( maxHalfDiagonalSq ) );
+        Aabb aabb;
+        aabb.setExtents( vMin - padding, vMax + padding );
+
+        mObjectData.mLocalAabb->setFromAabb( aabb, mObjectData.mIndex );
+        mObjectData.mLocalRadius[mObjectData.mIndex] = aabb.getRadius();
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuBillboardSet::updateGpuData( const Camera *camera )
+    {
+        updateLocalAabb();
+
+        const size_t numRecords = mRecords.size();
+        mVaoPerLod[VpNormal][0]->setPrimitiveRange( 0, static_cast<uint32>( numRecords * 6u ) );
+
+        if( !numRecords )
+            return;
+
+        const size_t recordStart = 2u + mUvRects.size();
+        const size_t numTexels = recordStart + numRecords * 2u;
+
+        if( numTexels > mRecordBufferTexels )
+        {
+            const size_t newTexels = std::max( numTexels,
+                                               mRecordBufferTexels + (mRecordBufferTexels >> 1u) );
+            destroyRecordBuffer();
+            createRecordBuffer( newTexels );
+        }
+
+        //The shader multiplies the corner offsets by the node's transform, so the
+        //camera axes need its inverse. The depth of a local position p along the
+        //view direction d is dot( M * p, d ) = dot( p, M^T * d ) (plus a constant
+        //that doesn't affect the order), hence the transpose for the sort.
+        Matrix3 world3x3( Matrix3::IDENTITY );
+        if( mParentNode )
+            mParentNode->_getFullTransform().extract3x3Matrix( world3x3 );
+        const Matrix3 invWorld3x3 = world3x3.Inverse();
+
+        const Vector3 localRight    = invWorld3x3 * camera->getDerivedRight();
+        const Vector3 localUp       = invWorld3x3 * camera->getDerivedUp();
+        const Vector3 localViewDir  = world3x3.Transpose() * camera->getDerivedDirection();
+
+        if( mSortingEnabled )
+        {
+            mSortKeys.resize( numRecords );
+            mSortScratch.resize( numRecords );
+            computeDepthKeys( mRecords.begin(), numRecords, localViewDir, mSortKeys.begin() );
+            sortBackToFront( mSortKeys.begin(), mSortScratch.begin(), numRecords );
+        }
+
+        float * RESTRICT_ALIAS texBuffer = reinterpret_cast<float*>(
+                    mRecordBuffer->map( 0, numTexels * 4u * sizeof(float) ) );
+
+        const uint32 recordStart32 = static_cast<uint32>( recordStart );
+        texBuffer[0] = static_cast<float>( localRight.x );
+        texBuffer[1] = static_cast<float>( localRight.y );
+        texBuffer[2] = static_cast<float>( localRight.z );
+        memcpy( &texBuffer[3], &recordStart32, sizeof(uint32) );
+        texBuffer[4] = static_cast<float>( localUp.x );
+        texBuffer[5] = static_cast<float>( localUp.y );
+        texBuffer[6] = static_cast<float>( localUp.z );
+        texBuffer[7] = 0;
+        texBuffer += 8u;
+
+        FastArray<Vector4>::const_iterator itUv = mUvRects.begin();
+        FastArray<Vector4>::const_iterator enUv = mUvRects.end();
+        while( itUv != enUv )
+        {
+            *texBuffer++ = static_cast<float>( itUv->x );
+            *texBuffer++ = static_cast<float>( itUv->y );
+            *texBuffer++ = static_cast<float>( itUv->z );
+            *texBuffer++ = static_cast<float>( itUv->w );
+            ++itUv;
+        }
+
+        Record * RESTRICT_ALIAS dstRecords = reinterpret_cast<Record*>( texBuffer );
+        if( mSortingEnabled )
+        {
+            const Record *srcRecords = mRecords.begin();
+            for( size_t i=0; i<numRecords; ++i )
+                dstRecords[i] = srcRecords[static_cast<uint32>( mSortKeys[i] )];
+        }
+        else
+        {
+            memcpy( dstRecords, mRecords.begin(), numRecords * sizeof(Record) );
+        }
+
+        mRecordBuffer->unmap( UO_UNMAP_ALL );
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuBillboardSet::packRecord( Record &outRecord, const Vector3 &position,
+                                      const Vector2 &halfSize, const ColourValue &colour,
+                                      Radian rotation, uint32 uvRectIdx )
+    {
+        outRecord.position[0]   = static_cast<float>( position.x );
+        outRecord.position[1]   = static_cast<float>( position.y );
+        outRecord.position[2]   = static_cast<float>( position.z );
+        outRecord.rotation      = static_cast<float>( rotation.valueRadians() );
+        outRecord.halfSize[0]   = static_cast<float>( halfSize.x );
+        outRecord.halfSize[1]   = static_cast<float>( halfSize.y );
+        outRecord.colour        = colour.getAsABGR();
+        outRecord.uvRectIdx     = uvRectIdx;
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuBillboardSet::computeDepthKeys( const Record *records, size_t numRecords,
+                                            const Vector3 &viewDir, uint64 *outKeys )
+    {
+        const float dirX = static_cast<float>( viewDir.x );
+        const float dirY = static_cast<float>( viewDir.y );
+        const float dirZ = static_cast<float>( viewDir.z );
+
+        size_t i = 0;
+
+#if OGRE_GPU_BILLBOARD_SSE2
+        const __m128 vDirX = _mm_set1_ps( dirX );
+        const __m128 vDirY = _mm_set1_ps( dirY );
+        const __m128 vDirZ = _mm_set1_ps( dirZ );
+        const __m128i signBit   = _mm_set1_epi32( static_cast<int>( 0x80000000u ) );
+        const __m128i allOnes   = _mm_set1_epi32( -1 );
+        const __m128i four      = _mm_set1_epi32( 4 );
+        __m128i indices = _mm_set_epi32( 3, 2, 1, 0 );
+
+        for( ; i + 4u <= numRecords; i += 4u )
+        {
+            //position + rotation are the first 16 bytes of each record.
+            __m128 x = _mm_loadu_ps( records[i+0].position );
+            __m128 y = _mm_loadu_ps( records[i+1].position );
+            __m128 z = _mm_loadu_ps( records[i+2].position );
+            __m128 w = _mm_loadu_ps( records[i+3].position );
+            _MM_TRANSPOSE4_PS( x, y, z, w );
+
+            const __m128 depth = _mm_add_ps( _mm_add_ps( _mm_mul_ps( x, vDirX ),
+                                                         _mm_mul_ps( y, vDirY ) ),
+                                             _mm_mul_ps( z, vDirZ ) );
+
+            //See depthToKey
+            const __m128i bits = _mm_castps_si128( depth );
+            const __m128i mask = _mm_or_si128( _mm_srai_epi32( bits, 31 ), signBit );
+            const __m128i keys = _mm_xor_si128( bits, _mm_xor_si128( mask, allOnes ) );
+
+            //Interleave as ( index, key ) pairs, i.e. ( key << 32u ) | index in little endian.
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( outKeys + i ),
+                              _mm_unpacklo_epi32( indices, keys ) );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( outKeys + i + 2u ),
+                              _mm_unpackhi_epi32( indices, keys ) );
+
+            indices = _mm_add_epi32( indices, four );
+        }
+#endif
+
+        for( ; i<numRecords; ++i )
+        {
+            const float *pos = records[i].position;
+            const float depth = pos[0] * dirX + pos[1] * dirY + pos[2] * dirZ;
+            outKeys[i] = (static_cast<uint64>( depthToKey( depth ) ) << 32u) | static_cast<uint64>( i );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuBillboardSet::sortBackToFront( uint64 *inOutKeys, uint64 *scratch, size_t numKeys )
+    {
+        if( numKeys < 2u )
+            return;
+
+        //All four histograms are built in one go.
+        uint32 histograms[4][256];
+        memset( histograms, 0, sizeof( histograms ) );
+
+        for( size_t i=0; i<numKeys; ++i )
+        {
+            const uint32 key = static_cast<uint32>( inOutKeys[i] >> 32u );
+            ++histograms[0][key & 0xFFu];
+            ++histograms[1][(key >> 8u) & 0xFFu];
+            ++histograms[2][(key >> 16u) & 0xFFu];
+            ++histograms[3][key >> 24u];
+        }
+
+        uint64 *src = inOutKeys;
+        uint64 *dst = scratch;
+
+        for( uint32 pass=0; pass<4u; ++pass )
+        {
+            uint32 *histogram = histograms[pass];
+            const uint32 shift = 32u + pass * 8u;
+
+            //Every key has the same digit. Nothing to do.
+            if( histogram[(src[0] >> shift) & 0xFFu] == numKeys )
+                continue;
+
+            uint32 offset = 0;
+            for( size_t j=0; j<256u; ++j )
+            {
+                const uint32 count = histogram[j];
+                histogram[j] = offset;
+                offset += count;
+            }
+
+            for( size_t i=0; i<numKeys; ++i )
+            {
+                const uint64 key = src[i];
+                dst[histogram[(key >> shift) & 0xFFu]++] = key;
+            }
+
+            std::swap( src, dst );
+        }
+
+        if( src != inOutKeys )
+            memcpy( inOutKeys, src, numKeys * sizeof(uint64) );
+    }
+    //-----------------------------------------------------------------------------------
+    const String& GpuBillboardSet::getMovableType(void) const
+    {
+        return GpuBillboardSetFactory::FACTORY_TYPE_NAME;
+    }
+    //-----------------------------------------------------------------------------------
+    const LightList& GpuBillboardSet::getLights(void) const
+    {
+        return this->queryLights(); //Return the data from our MovableObject base class.
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuBillboardSet::getRenderOperation( v1::RenderOperation& op , bool casterPass )
+    {
+        OGRE_EXCEPT( Exception::ERR_NOT_IMPLEMENTED,
+                        "GpuBillboardSet do not implement getRenderOperation."
+                        " You've put a v2 object in "
+                        "the wrong RenderQueue ID (which is set to be compatible with "
+                        "v1::Entity). Do not mix v2 and v1 objects",
+                        "GpuBillboardSet::getRenderOperation" );
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuBillboardSet::getWorldTransforms( Matrix4* xform ) const
+    {
+        OGRE_EXCEPT( Exception::ERR_NOT_IMPLEMENTED,
+                        "GpuBillboardSet do not implement getWorldTransforms."
+                        " You've put a v2 object in "
+                        "the wrong RenderQueue ID (which is set to be compatible with "
+                        "v1::Entity). Do not mix v2 and v1 objects",
+                        "GpuBillboardSet::getWorldTransforms" );
+    }
+    //-----------------------------------------------------------------------------------
+    bool GpuBillboardSet::getCastsShadows(void) const
+    {
+        return false;
+    }
+
+    //-----------------------------------------------------------------------
+    //-----------------------------------------------------------------------
+    String GpuBillboardSetFactory::FACTORY_TYPE_NAME = "GpuBillboardSet";
+    //-----------------------------------------------------------------------
+    const String& GpuBillboardSetFactory::getType(void) const
+    {
+        return FACTORY_TYPE_NAME;
+    }
+    //-----------------------------------------------------------------------
+    MovableObject* GpuBillboardSetFactory::createInstanceImpl( IdType id,
+                                                               ObjectMemoryManager *objectMemoryManager,
+                                                               SceneManager *manager,
+                                                               const NameValuePairList* params )
+    {
+        return OGRE_NEW GpuBillboardSet( id, objectMemoryManager, manager );
+    }
+    //-----------------------------------------------------------------------
+    void GpuBillboardSetFactory::destroyInstance( MovableObject* obj )
+    {
+        OGRE_DELETE obj;
+    }
+}
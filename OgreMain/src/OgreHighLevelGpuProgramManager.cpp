@@ -67,6 +67,15 @@ namespace Ogre {
         const String& getLanguage(void) const { return sNullLang; }
         size_t calculateSize(void) const { return 0; }
 
+        /// Overridden from HighLevelGpuProgram. We're never supported, so
+        /// populateParameterNames doesn't get the chance to do this.
+        GpuProgramParametersSharedPtr createParameters(void)
+        {
+            GpuProgramParametersSharedPtr params = HighLevelGpuProgram::createParameters();
+            params->setIgnoreMissingParams(true);
+            return params;
+        }
+
         /// Overridden from StringInterface
         bool setParameter(const String& name, const String& value)
         {
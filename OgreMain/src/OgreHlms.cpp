@@ -1431,24 +1431,72 @@ namespace Ogre
         //return parseProperties( inBuffer, outBuffer );
     }
     //-----------------------------------------------------------------------------------
+    static uint32 calculateRenderableCacheHash( const HlmsPropertyVec &properties,
+                                                const PiecesMap *pieces )
+    {
+        uint32 hash = 0;
+
+        HlmsPropertyVec::const_iterator itor = properties.begin();
+        HlmsPropertyVec::const_iterator end  = properties.end();
+
+        while( itor != end )
+        {
+            hash = HashCombine( hash, itor->keyName.mHash );
+            hash = HashCombine( hash, itor->value );
+            ++itor;
+        }
+
+        if( pieces )
+        {
+            for( size_t i=0; i<NumShaderTypes; ++i )
+            {
+                PiecesMap::const_iterator itPiece = pieces[i].begin();
+                PiecesMap::const_iterator enPiece = pieces[i].end();
+
+                while( itPiece != enPiece )
+                {
+                    hash = HashCombine( hash, itPiece->first.mHash );
+                    hash = FastHash( itPiece->second.c_str(),
+                                     static_cast<int>( itPiece->second.size() ), hash );
+                    ++itPiece;
+                }
+
+                hash = HashCombine( hash, i );
+            }
+        }
+
+        return hash;
+    }
+    //-----------------------------------------------------------------------------------
     size_t Hlms::addRenderableCache( const HlmsPropertyVec &renderableSetProperties,
                                      const PiecesMap *pieces )
     {
         assert( mRenderableCache.size() <= HlmsBits::RenderableMask );
 
-        RenderableCache cacheEntry( renderableSetProperties, pieces );
+        const uint32 contentHash = calculateRenderableCacheHash( renderableSetProperties, pieces );
+
+        size_t idx = mRenderableCache.size();
+
+        std::pair<RenderableCacheIndexMap::const_iterator,
+                  RenderableCacheIndexMap::const_iterator> range =
+                mRenderableCacheIndex.equal_range( contentHash );
 
-        RenderableCacheVec::iterator it = std::find( mRenderableCache.begin(), mRenderableCache.end(),
-                                                     cacheEntry );
-        if( it == mRenderableCache.end() )
+        while( range.first != range.second && idx == mRenderableCache.size() )
         {
-            mRenderableCache.push_back( cacheEntry );
-            it = mRenderableCache.end() - 1;
+            if( mRenderableCache[range.first->second].equals( renderableSetProperties, pieces ) )
+                idx = range.first->second;
+            ++range.first;
+        }
+
+        if( idx == mRenderableCache.size() )
+        {
+            mRenderableCache.push_back( RenderableCache( renderableSetProperties, pieces ) );
+            mRenderableCacheIndex.insert( RenderableCacheIndexMap::value_type(
+                                              contentHash, static_cast<uint32>( idx ) ) );
         }
 
         //3 bits for mType (see getMaterial)
-        return (mType << HlmsBits::HlmsTypeShift) |
-                ((it - mRenderableCache.begin()) << HlmsBits::RenderableShift);
+        return (mType << HlmsBits::HlmsTypeShift) | (idx << HlmsBits::RenderableShift);
     }
     //-----------------------------------------------------------------------------------
     const Hlms::RenderableCache &Hlms::getRenderableCache( uint32 hash ) const
@@ -1632,6 +1680,9 @@ namespace Ogre
 
         OGRE_DELETE itor->second.datablock;
         mDatablocks.erase( itor );
+
+        //A new datablock may be created at the same address
+        clearRenderableHashMemo();
     }
     //-----------------------------------------------------------------------------------
     void Hlms::_destroyAllDatablocks(void)
@@ -1647,6 +1698,8 @@ namespace Ogre
 
         mDatablocks.clear();
         mDefaultDatablock = 0;
+
+        clearRenderableHashMemo();
     }
     //-----------------------------------------------------------------------------------
     void Hlms::destroyAllDatablocks(void)
@@ -2161,7 +2214,104 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    void Hlms::fillRenderableHashKey( Renderable *renderable )
+    {
+        RenderableHashKey &key = mTmpRenderableHashKey;
+        key.datablock = renderable->getDatablock();
+        key.flags = (renderable->hasSkeletonAnimation() ? 0x01u : 0u) |
+                    (renderable->getUseIdentityWorldMatrix() ? 0x02u : 0u) |
+                    (renderable->getUseIdentityViewProjMatrixIsDynamic() ? 0x04u : 0u) |
+                    (renderable->getUseIdentityProjection() ? 0x08u : 0u);
+        key.vertexLayout.clear();
+
+        if( renderable->getVaos( VpNormal ).empty() )
+        {
+            v1::RenderOperation op;
+            renderable->getRenderOperation( op, false );
+            const v1::VertexDeclaration::VertexElementList &elementList =
+                    op.vertexData->vertexDeclaration->getElements();
+            v1::VertexDeclaration::VertexElementList::const_iterator itor = elementList.begin();
+            v1::VertexDeclaration::VertexElementList::const_iterator end  = elementList.end();
+
+            while( itor != end )
+            {
+                key.vertexLayout.push_back( (itor->getSemantic() << 24u) |
+                                            (itor->getType() << 16u) | itor->getIndex() );
+                ++itor;
+            }
+
+            key.flags |= 0x10u | (op.operationType << 8u);
+        }
+        else
+        {
+            VertexArrayObject *vao = renderable->getVaos( VpNormal )[0];
+            const VertexBufferPackedVec &vertexBuffers = vao->getVertexBuffers();
+            VertexBufferPackedVec::const_iterator itor = vertexBuffers.begin();
+            VertexBufferPackedVec::const_iterator end  = vertexBuffers.end();
+
+            while( itor != end )
+            {
+                const VertexElement2Vec &vertexElements = (*itor)->getVertexElements();
+                VertexElement2Vec::const_iterator itElements = vertexElements.begin();
+                VertexElement2Vec::const_iterator enElements = vertexElements.end();
+
+                while( itElements != enElements )
+                {
+                    key.vertexLayout.push_back( (itElements->mSemantic << 24u) |
+                                                (itElements->mType << 16u) );
+                    ++itElements;
+                }
+
+                ++itor;
+            }
+        }
+
+        uint32 hash = HashCombine( 0, key.datablock );
+        hash = HashCombine( hash, key.flags );
+        if( !key.vertexLayout.empty() )
+        {
+            hash = FastHash( reinterpret_cast<const char*>( &key.vertexLayout[0] ),
+                             static_cast<int>( key.vertexLayout.size() * sizeof(uint32) ), hash );
+        }
+        key.hash = hash;
+    }
+    //-----------------------------------------------------------------------------------
     void Hlms::calculateHashFor( Renderable *renderable, uint32 &outHash, uint32 &outCasterHash )
+    {
+        const bool canMemoise = canMemoiseRenderableHash( renderable );
+
+        if( canMemoise )
+        {
+            fillRenderableHashKey( renderable );
+
+            RenderableHashMemoMap::const_iterator itor =
+                    mRenderableHashMemo.find( mTmpRenderableHashKey );
+            if( itor != mRenderableHashMemo.end() &&
+                itor->second.datablockVersion == mTmpRenderableHashKey.datablock->_getHashVersion() )
+            {
+                outHash         = itor->second.hash;
+                outCasterHash   = itor->second.casterHash;
+                return;
+            }
+        }
+
+        calculateHashForImpl( renderable, outHash, outCasterHash );
+
+        if( canMemoise )
+        {
+            RenderableHashMemo &memo = mRenderableHashMemo[mTmpRenderableHashKey];
+            memo.datablockVersion   = mTmpRenderableHashKey.datablock->_getHashVersion();
+            memo.hash               = outHash;
+            memo.casterHash         = outCasterHash;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void Hlms::clearRenderableHashMemo(void)
+    {
+        mRenderableHashMemo.clear();
+    }
+    //-----------------------------------------------------------------------------------
+    void Hlms::calculateHashForImpl( Renderable *renderable, uint32 &outHash, uint32 &outCasterHash )
     {
         mSetProperties.clear();
 
@@ -2921,6 +3071,8 @@ namespace Ogre
     void Hlms::_changeRenderSystem( RenderSystem *newRs )
     {
         clearShaderCache();
+        //mFastShaderBuildHack may change
+        clearRenderableHashMemo();
         mRenderSystem = newRs;
 
         mShaderProfile = "unset!";
@@ -99,6 +99,7 @@ namespace Ogre
                                   const HlmsParamVec &params ) :
         mCreator( creator ),
         mName( name ),
+        mHashVersion( 0 ),
         mTextureHash( 0 ),
         mType( creator->getType() ),
         mAlphaTestCmp( CMPF_ALWAYS_PASS ),
@@ -393,6 +394,8 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void HlmsDatablock::flushRenderables(void)
     {
+        ++mHashVersion;
+
         vector<Renderable*>::type::const_iterator itor = mLinkedRenderables.begin();
         vector<Renderable*>::type::const_iterator end  = mLinkedRenderables.end();
 
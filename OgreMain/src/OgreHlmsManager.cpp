@@ -150,7 +150,86 @@ namespace Ogre
         ++realBlock->mRefCount;
     }
     //-----------------------------------------------------------------------------------
-    uint16 HlmsManager::getFreeBasicBlock( uint8 type )
+    static inline float normalizeZero( float value )
+    {
+        //-0.0f == 0.0f but they don't hash the same
+        return value == 0.0f ? 0.0f : value;
+    }
+    //-----------------------------------------------------------------------------------
+    static uint32 calculateBlockHash( const HlmsMacroblock &block )
+    {
+        //Must hash the same members HlmsMacroblock::operator != compares
+        uint32 hash = HashCombine( 0, block.mAllowGlobalDefaults );
+        hash = HashCombine( hash, block.mScissorTestEnabled );
+        hash = HashCombine( hash, block.mDepthCheck );
+        hash = HashCombine( hash, block.mDepthWrite );
+        hash = HashCombine( hash, block.mDepthFunc );
+        hash = HashCombine( hash, normalizeZero( block.mDepthBiasConstant ) );
+        hash = HashCombine( hash, normalizeZero( block.mDepthBiasSlopeScale ) );
+        hash = HashCombine( hash, block.mCullMode );
+        hash = HashCombine( hash, block.mPolygonMode );
+        return hash;
+    }
+    //-----------------------------------------------------------------------------------
+    static uint32 calculateBlockHash( const HlmsBlendblock &block )
+    {
+        //Must hash the same members HlmsBlendblock::operator != compares
+        uint32 hash = HashCombine( 0, block.mAllowGlobalDefaults );
+        hash = HashCombine( hash, block.mSeparateBlend );
+        hash = HashCombine( hash, block.mSourceBlendFactor );
+        hash = HashCombine( hash, block.mDestBlendFactor );
+        hash = HashCombine( hash, block.mSourceBlendFactorAlpha );
+        hash = HashCombine( hash, block.mDestBlendFactorAlpha );
+        hash = HashCombine( hash, block.mBlendOperation );
+        hash = HashCombine( hash, block.mBlendOperationAlpha );
+        hash = HashCombine( hash, block.mAlphaToCoverageEnabled );
+        hash = HashCombine( hash, block.mBlendChannelMask );
+        return hash;
+    }
+    //-----------------------------------------------------------------------------------
+    static uint32 calculateBlockHash( const HlmsSamplerblock &block )
+    {
+        //Must hash the same members HlmsSamplerblock::operator != compares
+        uint32 hash = HashCombine( 0, block.mAllowGlobalDefaults );
+        hash = HashCombine( hash, block.mMinFilter );
+        hash = HashCombine( hash, block.mMagFilter );
+        hash = HashCombine( hash, block.mMipFilter );
+        hash = HashCombine( hash, block.mU );
+        hash = HashCombine( hash, block.mV );
+        hash = HashCombine( hash, block.mW );
+        hash = HashCombine( hash, normalizeZero( block.mMipLodBias ) );
+        hash = HashCombine( hash, normalizeZero( block.mMaxAnisotropy ) );
+        hash = HashCombine( hash, block.mCompareFunction );
+        hash = HashCombine( hash, normalizeZero( block.mBorderColour.r ) );
+        hash = HashCombine( hash, normalizeZero( block.mBorderColour.g ) );
+        hash = HashCombine( hash, normalizeZero( block.mBorderColour.b ) );
+        hash = HashCombine( hash, normalizeZero( block.mBorderColour.a ) );
+        hash = HashCombine( hash, normalizeZero( block.mMinLod ) );
+        hash = HashCombine( hash, normalizeZero( block.mMaxLod ) );
+        return hash;
+    }
+    //-----------------------------------------------------------------------------------
+    template <typename T>
+    static T* findBlockByHash( const HlmsManager::BlockHashMap &blocksByHash, uint32 contentHash,
+                               T *blocks, const T &baseParams )
+    {
+        T *retVal = 0;
+
+        std::pair<HlmsManager::BlockHashMap::const_iterator,
+                  HlmsManager::BlockHashMap::const_iterator> range =
+                blocksByHash.equal_range( contentHash );
+
+        while( range.first != range.second && !retVal )
+        {
+            if( !(blocks[range.first->second] != baseParams) )
+                retVal = &blocks[range.first->second];
+            ++range.first;
+        }
+
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------------
+    uint16 HlmsManager::getFreeBasicBlock( uint8 type, uint32 contentHash )
     {
         if( mFreeBlockIds[type].empty() )
         {
@@ -167,6 +246,8 @@ namespace Ogre
         mFreeBlockIds[type].pop_back();
 
         mActiveBlocks[type].push_back( idx );
+        mActiveBlocksByHash[type].insert( BlockHashMap::value_type( contentHash, idx ) );
+        mBlockHashes[type][idx] = contentHash;
 
         return idx;
     }
@@ -181,6 +262,14 @@ namespace Ogre
         assert( itor != mActiveBlocks[block->mBlockType].end() );
         mActiveBlocks[block->mBlockType].erase( itor );
 
+        BlockHashMap &blocksByHash = mActiveBlocksByHash[block->mBlockType];
+        std::pair<BlockHashMap::iterator, BlockHashMap::iterator> range =
+                blocksByHash.equal_range( mBlockHashes[block->mBlockType][block->mId] );
+        while( range.first != range.second && range.first->second != block->mId )
+            ++range.first;
+        assert( range.first != range.second );
+        blocksByHash.erase( range.first );
+
         mFreeBlockIds[block->mBlockType].push_back( block->mId );
     }
     //-----------------------------------------------------------------------------------
@@ -192,21 +281,12 @@ namespace Ogre
                 " but it usually indicates memory corruption (or you created the block without "
                 "its default constructor)." );
 
-        BlockIdxVec::iterator itor = mActiveBlocks[BLOCK_MACRO].begin();
-        BlockIdxVec::iterator end  = mActiveBlocks[BLOCK_MACRO].end();
-
-        while( itor != end && mMacroblocks[*itor] != baseParams )
-            ++itor;
-
-        HlmsMacroblock *retVal = 0;
-        if( itor != end )
-        {
-            //Already exists
-            retVal = &mMacroblocks[*itor];
-        }
-        else
+        const uint32 contentHash = calculateBlockHash( baseParams );
+        HlmsMacroblock *retVal = findBlockByHash( mActiveBlocksByHash[BLOCK_MACRO], contentHash,
+                                                  mMacroblocks, baseParams );
+        if( !retVal )
         {
-            size_t idx = getFreeBasicBlock( BLOCK_MACRO );
+            size_t idx = getFreeBasicBlock( BLOCK_MACRO, contentHash );
 
             mMacroblocks[idx] = baseParams;
             //Restore the values which has just been overwritten and we need properly set.
@@ -256,21 +336,12 @@ namespace Ogre
                 " but it usually indicates memory corruption (or you created the block without "
                 "its default constructor)." );
 
-        BlockIdxVec::iterator itor = mActiveBlocks[BLOCK_BLEND].begin();
-        BlockIdxVec::iterator end  = mActiveBlocks[BLOCK_BLEND].end();
-
-        while( itor != end && mBlendblocks[*itor] != baseParams )
-            ++itor;
-
-        HlmsBlendblock *retVal = 0;
-        if( itor != end )
-        {
-            //Already exists
-            retVal = &mBlendblocks[*itor];
-        }
-        else
+        const uint32 contentHash = calculateBlockHash( baseParams );
+        HlmsBlendblock *retVal = findBlockByHash( mActiveBlocksByHash[BLOCK_BLEND], contentHash,
+                                                  mBlendblocks, baseParams );
+        if( !retVal )
         {
-            size_t idx = getFreeBasicBlock( BLOCK_BLEND );
+            size_t idx = getFreeBasicBlock( BLOCK_BLEND, contentHash );
 
             mBlendblocks[idx] = baseParams;
 
@@ -350,21 +421,12 @@ namespace Ogre
                                                    " They've been corrected." );
         }
 
-        BlockIdxVec::iterator itor = mActiveBlocks[BLOCK_SAMPLER].begin();
-        BlockIdxVec::iterator end  = mActiveBlocks[BLOCK_SAMPLER].end();
-
-        while( itor != end && mSamplerblocks[*itor] != baseParams )
-            ++itor;
-
-        HlmsSamplerblock *retVal = 0;
-        if( itor != end )
-        {
-            //Already exists
-            retVal = &mSamplerblocks[*itor];
-        }
-        else
+        const uint32 contentHash = calculateBlockHash( baseParams );
+        HlmsSamplerblock *retVal = findBlockByHash( mActiveBlocksByHash[BLOCK_SAMPLER], contentHash,
+                                                    mSamplerblocks, baseParams );
+        if( !retVal )
         {
-            size_t idx = getFreeBasicBlock( BLOCK_SAMPLER );
+            size_t idx = getFreeBasicBlock( BLOCK_SAMPLER, contentHash );
 
             mSamplerblocks[idx] = baseParams;
             //Restore the values which has just been overwritten and we need properly set.
@@ -35,10 +35,26 @@ THE SOFTWARE.
 #include "OgreRenderSystem.h"
 #include "OgreBitwise.h"
 #include "OgreLogManager.h"
+#include "OgreRoot.h"
+#include "OgreHlmsManager.h"
+#include "OgreHlms.h"
+#include "OgreHlmsDatablock.h"
 
 namespace Ogre
 {
-    HlmsTextureManager::HlmsTextureManager() : mRenderSystem( 0 ), mTextureId( 0 )
+    HlmsTextureManager::HlmsTextureManager() :
+        mRenderSystem( 0 ),
+        mTextureId( 0 ),
+        mStreamingEnabled( false ),
+        mStreamingHandlersRegistered( false ),
+        mWorkQueueChannel( 0 ),
+        mStreamingBudget( 256u * 1024u * 1024u ),
+        mUploadBytesPerFrame( 4u * 1024u * 1024u ),
+        mMinResidentResolution( 64u ),
+        mListener( 0 ),
+        mBytesUploadedThisFrame( 0 ),
+        mBytesUploadedLastFrame( 0 ),
+        mNumEvictions( 0 )
     {
         mDefaultTextureParameters[TEXTURE_TYPE_DIFFUSE].hwGammaCorrection   = true;
         mDefaultTextureParameters[TEXTURE_TYPE_MONOCHROME].pixelFormat      = PF_L8;
@@ -53,6 +69,25 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     HlmsTextureManager::~HlmsTextureManager()
     {
+        if( mStreamingHandlersRegistered && Root::getSingletonPtr() )
+        {
+            WorkQueue *workQueue = Root::getSingleton().getWorkQueue();
+            workQueue->abortRequestsByChannel( mWorkQueueChannel );
+            workQueue->removeRequestHandler( mWorkQueueChannel, this );
+            workQueue->removeResponseHandler( mWorkQueueChannel, this );
+            mStreamingHandlersRegistered = false;
+        }
+
+        StreamedTextureMap::const_iterator itor = mStreamedTextures.begin();
+        StreamedTextureMap::const_iterator end  = mStreamedTextures.end();
+
+        while( itor != end )
+        {
+            OGRE_DELETE itor->second.image;
+            ++itor;
+        }
+
+        mStreamedTextures.clear();
     }
     //-----------------------------------------------------------------------------------
     void HlmsTextureManager::_changeRenderSystem( RenderSystem *newRs )
@@ -119,32 +154,40 @@ namespace Ogre
                     mDefaultTextureParameters[TEXTURE_TYPE_DETAIL_NORMAL_MAP].pixelFormat = pf;
                 }
 
-                mBlankTexture = TextureManager::getSingleton().createManual( "Hlms_Blanktexture",
-                                                ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
-                                                textureType, 4, 4, 1, 0, PF_R8G8B8A8, TU_DEFAULT, 0,
-                                                false, 0, BLANKSTRING, false );
-
-                v1::HardwarePixelBufferSharedPtr pixelBufferBuf = mBlankTexture->getBuffer(0);
-                const PixelBox &currImage = pixelBufferBuf->lock( Box( 0, 0, 0, 4, 4, 1 ),
-                                                                  v1::HardwareBuffer::HBL_DISCARD );
-                uint8 *data = reinterpret_cast<uint8*>( currImage.data );
-                for( size_t y=0; y<currImage.getHeight(); ++y )
-                {
-                    for( size_t x=0; x<currImage.getWidth(); ++x )
-                    {
-                        *data++ = 255;
-                        *data++ = 255;
-                        *data++ = 255;
-                        *data++ = 255;
-                    }
-
-                    data += ( currImage.rowPitch - currImage.getWidth() ) * 4;
-                }
-                pixelBufferBuf->unlock();
+                mBlankTexture = createBlankTexture( "Hlms_Blanktexture", textureType );
             }
         }
     }
     //-----------------------------------------------------------------------------------
+    TexturePtr HlmsTextureManager::createBlankTexture( const String &name,
+                                                       TextureType textureType ) const
+    {
+        TexturePtr retVal = TextureManager::getSingleton().createManual( name,
+                                        ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
+                                        textureType, 4, 4, 1, 0, PF_R8G8B8A8, TU_DEFAULT, 0,
+                                        false, 0, BLANKSTRING, false );
+
+        v1::HardwarePixelBufferSharedPtr pixelBufferBuf = retVal->getBuffer(0);
+        const PixelBox &currImage = pixelBufferBuf->lock( Box( 0, 0, 0, 4, 4, 1 ),
+                                                          v1::HardwareBuffer::HBL_DISCARD );
+        uint8 *data = reinterpret_cast<uint8*>( currImage.data );
+        for( size_t y=0; y<currImage.getHeight(); ++y )
+        {
+            for( size_t x=0; x<currImage.getWidth(); ++x )
+            {
+                *data++ = 255;
+                *data++ = 255;
+                *data++ = 255;
+                *data++ = 255;
+            }
+
+            data += ( currImage.rowPitch - currImage.getWidth() ) * 4;
+        }
+        pixelBufferBuf->unlock();
+
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------------
     void HlmsTextureManager::copyTextureToArray( const Image &srcImage, TexturePtr dst, uint16 entryIdx,
                                                  uint8 srcBaseMip, bool isNormalMap )
     {
@@ -248,6 +291,64 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    PixelFormat HlmsTextureManager::selectPixelFormat( PixelFormat imageFormat,
+                                                       TextureMapType mapType,
+                                                       const String &texName ) const
+    {
+        const RenderSystemCapabilities *caps = mRenderSystem->getCapabilities();
+
+        if( mDefaultTextureParameters[mapType].pixelFormat != PF_UNKNOWN )
+        {
+            //Don't force non-compressed sources to be compressed when we can't do it
+            //automatically, but force them to a format we actually understand.
+            if( mDefaultTextureParameters[mapType].isNormalMap &&
+                mDefaultTextureParameters[mapType].pixelFormat == PF_BC5_SNORM &&
+                imageFormat != PF_BC5_SNORM )
+            {
+                LogManager::getSingleton().logMessage(
+                            "WARNING: normal map texture " + texName + " is not BC5S compressed. "
+                            "This is encouraged for lower memory usage. If you don't want to see "
+                            "this message without compressing to BC5, set "
+                            "getDefaultTextureParameters()[TEXTURE_TYPE_NORMALS].pixelFormat to "
+                            "PF_R8G8_SNORM (or PF_BYTE_LA if RSC_TEXTURE_SIGNED_INT is not "
+                            "supported)", LML_NORMAL);
+                imageFormat = caps->hasCapability( RSC_TEXTURE_SIGNED_INT ) ? PF_R8G8_SNORM :
+                                                                              PF_BYTE_LA;
+            }
+            else if (mDefaultTextureParameters[mapType].pixelFormat != imageFormat &&
+                     (PixelUtil::isCompressed(imageFormat) ||
+                      PixelUtil::isCompressed(mDefaultTextureParameters[mapType].pixelFormat)))
+            {
+                //Image formats do not match, and one or both of the formats is compressed
+                //and therefore we can not convert it to the desired format.
+                //So we use the src image format instead of the requested image format
+                LogManager::getSingleton().logMessage(
+                    "WARNING: The input texture " + texName + " is a " + PixelUtil::getFormatName(imageFormat) + " " +
+                    "texture and can not be converted to the requested pixel format of " +
+                    PixelUtil::getFormatName(mDefaultTextureParameters[mapType].pixelFormat) + ". " +
+                    "This will potentially cause both an increase in memory usage and a decrease in performance. " +
+                    "It is highly recommended you convert this texture to the requested format.", LML_NORMAL);
+            }
+            else
+            {	
+                imageFormat = mDefaultTextureParameters[mapType].pixelFormat;
+            }
+        }
+
+        if( imageFormat == PF_X8R8G8B8 || imageFormat == PF_R8G8B8 ||
+            imageFormat == PF_X8B8G8R8 || imageFormat == PF_B8G8R8 ||
+            imageFormat == PF_A8R8G8B8 )
+        {
+#if OGRE_PLATFORM >= OGRE_PLATFORM_ANDROID
+            imageFormat = PF_A8B8G8R8;
+#else
+            imageFormat = PF_A8R8G8B8;
+#endif
+        }
+
+        return imageFormat;
+    }
+    //-----------------------------------------------------------------------------------
     HlmsTextureManager::TextureArrayVec::iterator HlmsTextureManager::findSuitableArray(
                                                                             TextureMapType mapType,
                                                                             uint32 width, uint32 height,
@@ -286,6 +387,113 @@ namespace Ogre
         return retVal;
     }
     //-----------------------------------------------------------------------------------
+    HlmsTextureManager::TextureArrayVec::iterator HlmsTextureManager::findOrCreateArray(
+                                                                            TextureMapType mapType,
+                                                                            TextureType texType,
+                                                                            uint32 width, uint32 height,
+                                                                            uint32 depth, uint32 faces,
+                                                                            PixelFormat format,
+                                                                            uint8 numMipmaps,
+                                                                            ushort maxResolution )
+    {
+        //Find an array where we can put it. If there is none, we'll have have to create a new one
+        TextureArrayVec::iterator dstArrayIt = findSuitableArray( mapType, width, height, depth,
+                                                                  faces, format, numMipmaps );
+
+        if( dstArrayIt == mTextureArrays[mapType].end() )
+        {
+            //Create a new array
+            uint limit          = mDefaultTextureParameters[mapType].maxTexturesPerArray;
+            uint limitSquared   = mDefaultTextureParameters[mapType].maxTexturesPerArray;
+            bool packNonPow2    = mDefaultTextureParameters[mapType].packNonPow2;
+            float packMaxRatio  = mDefaultTextureParameters[mapType].packMaxRatio;
+
+            if( !packNonPow2 )
+            {
+                if( !Bitwise::isPO2( width ) || !Bitwise::isPO2( height ) )
+                    limit = limitSquared = 1;
+            }
+
+            if( width / (float)height >= packMaxRatio || height / (float)width >= packMaxRatio )
+                limit = limitSquared = 1;
+
+            if( mDefaultTextureParameters[mapType].packingMethod == TextureArrays )
+            {
+                limit = 1;
+
+                //Texture Arrays
+                if( texType == TEX_TYPE_3D || texType == TEX_TYPE_CUBE_MAP )
+                {
+                    //APIs don't support arrays + 3D textures
+                    //TODO: Cubemap arrays supported since D3D10.1
+                    limitSquared = 1;
+                }
+                else if( texType == TEX_TYPE_2D_ARRAY )
+                {
+                    size_t textureSizeNoMips = PixelUtil::getMemorySize( width, height, 1, format );
+
+                    ThresholdVec::const_iterator itThres =  mDefaultTextureParameters[mapType].
+                                                                textureArraysTresholds.begin();
+                    ThresholdVec::const_iterator enThres =  mDefaultTextureParameters[mapType].
+                                                                textureArraysTresholds.end();
+
+                    while( itThres != enThres && textureSizeNoMips > itThres->minTextureSize )
+                        ++itThres;
+
+                    if( itThres == enThres )
+                    {
+                        itThres = mDefaultTextureParameters[mapType].
+                                    textureArraysTresholds.end() - 1;
+                    }
+
+                    limitSquared = std::min<uint16>( limitSquared, itThres->maxTexturesPerArray );
+                    depth = limitSquared;
+                }
+            }
+            else
+            {
+                //UV Atlas
+                limit        = static_cast<uint>( ceilf( sqrtf( (Real)limitSquared ) ) );
+                limitSquared = limit * limit;
+
+                if( texType == TEX_TYPE_3D || texType == TEX_TYPE_CUBE_MAP )
+                    limit = 1; //No UV atlas for 3D and Cubemaps
+
+                uint texWidth  = width  * limit;
+                uint texHeight = height * limit;
+
+                if( texWidth > maxResolution || texHeight > maxResolution )
+                {
+                    limit = maxResolution / width;
+                    limit = std::min<uint>( limit, maxResolution / height );
+
+                    width  = width  * limit;
+                    height = height * limit;
+                }
+
+                limitSquared = limit * limit;
+            }
+
+            TextureArray textureArray( limit, limitSquared, true,
+                                       mDefaultTextureParameters[mapType].isNormalMap );
+
+            textureArray.texture = TextureManager::getSingleton().createManual(
+                                        "HlmsTextureManager/" +
+                                        StringConverter::toString( mTextureId++ ),
+                                        ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
+                                        texType, width, height, depth, numMipmaps,
+                                        format,
+                                        TU_DEFAULT & ~TU_AUTOMIPMAP, 0,
+                                        mDefaultTextureParameters[mapType].hwGammaCorrection,
+                                        0, BLANKSTRING, false );
+
+            mTextureArrays[mapType].push_back( textureArray );
+            dstArrayIt = mTextureArrays[mapType].end() - 1;
+        }
+
+        return dstArrayIt;
+    }
+    //-----------------------------------------------------------------------------------
     HlmsTextureManager::TextureLocation HlmsTextureManager::createOrRetrieveTexture(
                                                                         const String &texName,
                                                                         TextureMapType mapType )
@@ -306,6 +514,21 @@ namespace Ogre
 
         assert( !aliasName.empty() && "Alias name can't be left empty!" );
 
+        StreamedTextureMap::iterator itStreamed = mStreamedTextures.find( searchName.name );
+        if( itStreamed != mStreamedTextures.end() )
+        {
+            StreamedTexture &streamed = itStreamed->second;
+            if( streamed.image && streamed.residentMip != streamed.baseMip )
+                streamed.needsDatablockUpdate = true;
+            return getStreamedLocation( streamed );
+        }
+
+        if( mStreamingEnabled && !imgSource && (it == mEntries.end() || it->name != searchName.name) &&
+            mDefaultTextureParameters[mapType].packingMethod == TextureArrays )
+        {
+            return getStreamedLocation( queueStreamedTexture( aliasName, texName, mapType ) );
+        }
+
         try
         {
         if( it == mEntries.end() || it->name != searchName.name )
@@ -321,58 +544,9 @@ namespace Ogre
                 image->load( texName, ResourceGroupManager::AUTODETECT_RESOURCE_GROUP_NAME );
             }
 
-            PixelFormat imageFormat = image->getFormat();
+            const PixelFormat imageFormat = selectPixelFormat( image->getFormat(), mapType, texName );
             const RenderSystemCapabilities *caps = mRenderSystem->getCapabilities();
 
-            if( mDefaultTextureParameters[mapType].pixelFormat != PF_UNKNOWN )
-            {
-                //Don't force non-compressed sources to be compressed when we can't do it
-                //automatically, but force them to a format we actually understand.
-                if( mDefaultTextureParameters[mapType].isNormalMap &&
-                    mDefaultTextureParameters[mapType].pixelFormat == PF_BC5_SNORM &&
-                    imageFormat != PF_BC5_SNORM )
-                {
-                    LogManager::getSingleton().logMessage(
-                                "WARNING: normal map texture " + texName + " is not BC5S compressed. "
-                                "This is encouraged for lower memory usage. If you don't want to see "
-                                "this message without compressing to BC5, set "
-                                "getDefaultTextureParameters()[TEXTURE_TYPE_NORMALS].pixelFormat to "
-                                "PF_R8G8_SNORM (or PF_BYTE_LA if RSC_TEXTURE_SIGNED_INT is not "
-                                "supported)", LML_NORMAL);
-                    imageFormat = caps->hasCapability( RSC_TEXTURE_SIGNED_INT ) ? PF_R8G8_SNORM :
-                                                                                  PF_BYTE_LA;
-                }
-                else if (mDefaultTextureParameters[mapType].pixelFormat != imageFormat &&
-                         (PixelUtil::isCompressed(imageFormat) ||
-                          PixelUtil::isCompressed(mDefaultTextureParameters[mapType].pixelFormat)))
-                {
-                    //Image formats do not match, and one or both of the formats is compressed
-                    //and therefore we can not convert it to the desired format.
-                    //So we use the src image format instead of the requested image format
-                    LogManager::getSingleton().logMessage(
-                        "WARNING: The input texture " + texName + " is a " + PixelUtil::getFormatName(imageFormat) + " " +
-                        "texture and can not be converted to the requested pixel format of " +
-                        PixelUtil::getFormatName(mDefaultTextureParameters[mapType].pixelFormat) + ". " +
-                        "This will potentially cause both an increase in memory usage and a decrease in performance. " +
-                        "It is highly recommended you convert this texture to the requested format.", LML_NORMAL);
-                }
-                else
-                {	
-                    imageFormat = mDefaultTextureParameters[mapType].pixelFormat;
-                }
-            }
-
-            if( imageFormat == PF_X8R8G8B8 || imageFormat == PF_R8G8B8 ||
-                imageFormat == PF_X8B8G8R8 || imageFormat == PF_B8G8R8 ||
-                imageFormat == PF_A8R8G8B8 )
-            {
-#if OGRE_PLATFORM >= OGRE_PLATFORM_ANDROID
-                imageFormat = PF_A8B8G8R8;
-#else
-                imageFormat = PF_A8R8G8B8;
-#endif
-            }
-
             uint8 numMipmaps = 0;
 
             if( mDefaultTextureParameters[mapType].mipmaps )
@@ -484,102 +658,10 @@ namespace Ogre
                 }
             }
 
-            //Find an array where we can put it. If there is none, we'll have have to create a new one
-            TextureArrayVec::iterator dstArrayIt = findSuitableArray( mapType, width, height, depth,
-                                                                      faces, imageFormat,
-                                                                      numMipmaps - baseMipLevel );
-
-            if( dstArrayIt == mTextureArrays[mapType].end() )
-            {
-                //Create a new array
-                uint limit          = mDefaultTextureParameters[mapType].maxTexturesPerArray;
-                uint limitSquared   = mDefaultTextureParameters[mapType].maxTexturesPerArray;
-                bool packNonPow2    = mDefaultTextureParameters[mapType].packNonPow2;
-                float packMaxRatio  = mDefaultTextureParameters[mapType].packMaxRatio;
-
-                if( !packNonPow2 )
-                {
-                    if( !Bitwise::isPO2( width ) || !Bitwise::isPO2( height ) )
-                        limit = limitSquared = 1;
-                }
-
-                if( width / (float)height >= packMaxRatio || height / (float)width >= packMaxRatio )
-                    limit = limitSquared = 1;
-
-                if( mDefaultTextureParameters[mapType].packingMethod == TextureArrays )
-                {
-                    limit = 1;
-
-                    //Texture Arrays
-                    if( texType == TEX_TYPE_3D || texType == TEX_TYPE_CUBE_MAP )
-                    {
-                        //APIs don't support arrays + 3D textures
-                        //TODO: Cubemap arrays supported since D3D10.1
-                        limitSquared = 1;
-                    }
-                    else if( texType == TEX_TYPE_2D_ARRAY )
-                    {
-                        size_t textureSizeNoMips = PixelUtil::getMemorySize( width, height, 1,
-                                                                             imageFormat );
-
-                        ThresholdVec::const_iterator itThres =  mDefaultTextureParameters[mapType].
-                                                                    textureArraysTresholds.begin();
-                        ThresholdVec::const_iterator enThres =  mDefaultTextureParameters[mapType].
-                                                                    textureArraysTresholds.end();
-
-                        while( itThres != enThres && textureSizeNoMips > itThres->minTextureSize )
-                            ++itThres;
-
-                        if( itThres == enThres )
-                        {
-                            itThres = mDefaultTextureParameters[mapType].
-                                        textureArraysTresholds.end() - 1;
-                        }
-
-                        limitSquared = std::min<uint16>( limitSquared, itThres->maxTexturesPerArray );
-                        depth = limitSquared;
-                    }
-                }
-                else
-                {
-                    //UV Atlas
-                    limit        = static_cast<uint>( ceilf( sqrtf( (Real)limitSquared ) ) );
-                    limitSquared = limit * limit;
-
-                    if( texType == TEX_TYPE_3D || texType == TEX_TYPE_CUBE_MAP )
-                        limit = 1; //No UV atlas for 3D and Cubemaps
-
-                    uint texWidth  = width  * limit;
-                    uint texHeight = height * limit;
-
-                    if( texWidth > maxResolution || texHeight > maxResolution )
-                    {
-                        limit = maxResolution / width;
-                        limit = std::min<uint>( limit, maxResolution / height );
-
-                        width  = width  * limit;
-                        height = height * limit;
-                    }
-
-                    limitSquared = limit * limit;
-                }
-
-                TextureArray textureArray( limit, limitSquared, true,
-                                           mDefaultTextureParameters[mapType].isNormalMap );
-
-                textureArray.texture = TextureManager::getSingleton().createManual(
-                                            "HlmsTextureManager/" +
-                                            StringConverter::toString( mTextureId++ ),
-                                            ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
-                                            texType, width, height, depth, numMipmaps - baseMipLevel,
-                                            imageFormat,
-                                            TU_DEFAULT & ~TU_AUTOMIPMAP, 0,
-                                            mDefaultTextureParameters[mapType].hwGammaCorrection,
-                                            0, BLANKSTRING, false );
-
-                mTextureArrays[mapType].push_back( textureArray );
-                dstArrayIt = mTextureArrays[mapType].end() - 1;
-            }
+            TextureArrayVec::iterator dstArrayIt = findOrCreateArray( mapType, texType, width, height,
+                                                                      depth, faces, imageFormat,
+                                                                      numMipmaps - baseMipLevel,
+                                                                      maxResolution );
 
             uint16 entryIdx = dstArrayIt->createEntry();
             uint16 arrayIdx = dstArrayIt - mTextureArrays[mapType].begin();
@@ -617,21 +699,7 @@ namespace Ogre
             }
         }
 
-        const TextureArray &texArray = mTextureArrays[it->mapType][it->arrayIdx];
-        retVal.texture = texArray.texture;
-
-        if( !texArray.texture->isTextureTypeArray() )
-        {
-            retVal.xIdx = it->entryIdx % texArray.sqrtMaxTextures;
-            retVal.yIdx = it->entryIdx / texArray.sqrtMaxTextures;
-            retVal.divisor= texArray.sqrtMaxTextures;
-        }
-        else
-        {
-            retVal.xIdx = it->entryIdx;
-            retVal.yIdx = 0;
-            retVal.divisor= 1;
-        }
+        retVal = getTextureLocation( *it );
         }
         catch( Exception &e )
         {
@@ -651,8 +719,44 @@ namespace Ogre
         return retVal;
     }
     //-----------------------------------------------------------------------------------
+    HlmsTextureManager::TextureLocation HlmsTextureManager::getTextureLocation(
+                                                                const TextureEntry &entry ) const
+    {
+        TextureLocation retVal;
+
+        const TextureArray &texArray = mTextureArrays[entry.mapType][entry.arrayIdx];
+        retVal.texture = texArray.texture;
+
+        if( !texArray.texture->isTextureTypeArray() )
+        {
+            retVal.xIdx = entry.entryIdx % texArray.sqrtMaxTextures;
+            retVal.yIdx = entry.entryIdx / texArray.sqrtMaxTextures;
+            retVal.divisor= texArray.sqrtMaxTextures;
+        }
+        else
+        {
+            retVal.xIdx = entry.entryIdx;
+            retVal.yIdx = 0;
+            retVal.divisor= 1;
+        }
+
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------------
     void HlmsTextureManager::destroyTexture( IdString aliasName )
     {
+        StreamedTextureMap::iterator itStreamed = mStreamedTextures.find( aliasName );
+        if( itStreamed != mStreamedTextures.end() )
+        {
+            StreamedTexture &streamed = itStreamed->second;
+            if( !streamed.image )
+                Root::getSingleton().getWorkQueue()->abortRequest( streamed.requestId );
+            OGRE_DELETE streamed.image;
+            removeTexture( streamed.placeholder );
+            mStreamedTextures.erase( itStreamed );
+            //Once decoded, the texture also has a regular entry. Fall through.
+        }
+
         TextureEntry searchName( aliasName );
         TextureEntryVec::iterator it = std::lower_bound( mEntries.begin(), mEntries.end(), searchName );
 
@@ -718,6 +822,19 @@ namespace Ogre
             }
         }
 
+        StreamedTextureMap::const_iterator itor = mStreamedTextures.begin();
+        StreamedTextureMap::const_iterator end  = mStreamedTextures.end();
+
+        while( itor != end && !retVal )
+        {
+            if( !itor->second.placeholder.isNull() &&
+                itor->second.placeholder == textureLocation.texture )
+            {
+                retVal = &itor->second.aliasName;
+            }
+            ++itor;
+        }
+
         return retVal;
     }
     //-----------------------------------------------------------------------------------
@@ -725,6 +842,10 @@ namespace Ogre
     {
         const String *retVal = 0;
 
+        StreamedTextureMap::const_iterator itStreamed = mStreamedTextures.find( aliasName );
+        if( itStreamed != mStreamedTextures.end() )
+            return &itStreamed->second.resourceName;
+
         TextureEntry searchName( aliasName );
         TextureEntryVec::const_iterator it = std::lower_bound( mEntries.begin(), mEntries.end(),
                                                                searchName );
@@ -1040,6 +1161,518 @@ namespace Ogre
                     LML_CRITICAL );
     }
     //-----------------------------------------------------------------------------------
+    size_t HlmsTextureManager::copyMipToTexture( const Image &srcImage, uint8 srcMip, TexturePtr dst,
+                                                 uint8 dstMip, uint16 dstSlice, bool isNormalMap )
+    {
+        v1::HardwarePixelBufferSharedPtr pixelBufferBuf = dst->getBuffer( 0, dstMip );
+        const PixelBox &currImage = pixelBufferBuf->lock( Box( 0, 0, dstSlice,
+                                                               pixelBufferBuf->getWidth(),
+                                                               pixelBufferBuf->getHeight(),
+                                                               dstSlice + 1 ),
+                                                          v1::HardwareBuffer::HBL_DISCARD );
+        if( isNormalMap && srcImage.getFormat() != dst->getFormat() )
+            PixelUtil::convertForNormalMapping( srcImage.getPixelBox( 0, srcMip ), currImage );
+        else
+            PixelUtil::bulkPixelConversion( srcImage.getPixelBox( 0, srcMip ), currImage );
+        pixelBufferBuf->unlock();
+
+        return PixelUtil::getMemorySize( pixelBufferBuf->getWidth(), pixelBufferBuf->getHeight(),
+                                         1, dst->getFormat() );
+    }
+    //-----------------------------------------------------------------------------------
+    size_t HlmsTextureManager::getMipChainSize( const Image &image, PixelFormat format, uint8 firstMip )
+    {
+        size_t retVal = 0;
+
+        for( size_t i=firstMip; i<=image.getNumMipmaps(); ++i )
+        {
+            retVal += PixelUtil::getMemorySize( std::max<uint32>( image.getWidth() >> i, 1u ),
+                                                std::max<uint32>( image.getHeight() >> i, 1u ),
+                                                1, format );
+        }
+
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------------
+    void HlmsTextureManager::removeTexture( TexturePtr &texture )
+    {
+        if( !texture.isNull() )
+        {
+            ResourcePtr texResource = texture;
+            TextureManager::getSingleton().remove( texResource );
+            texture.setNull();
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    const HlmsTextureManager::StreamedTexture& HlmsTextureManager::queueStreamedTexture(
+                                                                        const String &aliasName,
+                                                                        const String &texName,
+                                                                        TextureMapType mapType )
+    {
+        LogManager::getSingleton().logMessage( "Texture: streaming " + texName + " as " + aliasName );
+
+        StreamingRequest request;
+        request.aliasName           = aliasName;
+        request.resourceName        = texName;
+        request.mipmaps             = mDefaultTextureParameters[mapType].mipmaps;
+        request.hwGammaCorrection   = mDefaultTextureParameters[mapType].hwGammaCorrection;
+
+        //Insert it before adding the request; without threads the request is processed right away.
+        StreamedTexture &streamed = mStreamedTextures[request.aliasName];
+        streamed.aliasName      = aliasName;
+        streamed.resourceName   = texName;
+        streamed.mapType        = mapType;
+        streamed.placeholder    = createBlankTexture( "HlmsTextureManager/Streamed/" +
+                                                      StringConverter::toString( mTextureId++ ),
+                                                      mBlankTexture->getTextureType() );
+        streamed.requestId      = Root::getSingleton().getWorkQueue()->addRequest( mWorkQueueChannel, 0,
+                                                                                   Any( request ) );
+        return streamed;
+    }
+    //-----------------------------------------------------------------------------------
+    WorkQueue::Response* HlmsTextureManager::handleRequest( const WorkQueue::Request *req,
+                                                            const WorkQueue *srcQ )
+    {
+        //Runs in a worker thread. Don't touch anything but the request.
+        StreamingRequest request = any_cast<StreamingRequest>( req->getData() );
+
+        StreamingResponse response;
+        response.aliasName  = request.aliasName;
+        response.image      = 0;
+
+        if( req->getAborted() )
+            return OGRE_NEW WorkQueue::Response( req, true, Any( response ) );
+
+        Image *image = OGRE_NEW Image();
+
+        try
+        {
+            image->load( request.resourceName, ResourceGroupManager::AUTODETECT_RESOURCE_GROUP_NAME );
+
+            //Cubemaps & 3D textures aren't streamed. Their mipmaps get
+            //generated by createOrRetrieveTexture once they're back.
+            if( request.mipmaps && !image->hasFlag( IF_CUBEMAP ) && !image->hasFlag( IF_3D_TEXTURE ) )
+            {
+                const uint32 heighestRes = std::max( image->getWidth(), image->getHeight() );
+                const uint8 numMipmaps = static_cast<uint8>( Bitwise::mostSignificantBitSet( heighestRes ) );
+
+                //Compressed formats can't generate mipmaps. We'll stream whatever they have.
+                if( image->getNumMipmaps() != numMipmaps )
+                    image->generateMipmaps( request.hwGammaCorrection );
+            }
+        }
+        catch( Exception &e )
+        {
+            OGRE_DELETE image;
+            return OGRE_NEW WorkQueue::Response( req, false, Any( response ), e.getFullDescription() );
+        }
+
+        response.image = image;
+        return OGRE_NEW WorkQueue::Response( req, true, Any( response ) );
+    }
+    //-----------------------------------------------------------------------------------
+    void HlmsTextureManager::handleResponse( const WorkQueue::Response *res, const WorkQueue *srcQ )
+    {
+        StreamingResponse response = any_cast<StreamingResponse>( res->getData() );
+
+        StreamedTextureMap::iterator itor = mStreamedTextures.find( response.aliasName );
+
+        if( res->getRequest()->getAborted() || itor == mStreamedTextures.end() ||
+            itor->second.requestId != res->getRequest()->getID() )
+        {
+            //The texture was destroyed while it was being decoded.
+            OGRE_DELETE response.image;
+            return;
+        }
+
+        String errorDescription;
+
+        if( res->succeeded() )
+        {
+            try
+            {
+                streamedTextureDecoded( itor, response.image );
+            }
+            catch( Exception &e )
+            {
+                errorDescription = e.getFullDescription();
+                destroyTexture( response.aliasName );
+            }
+        }
+        else
+        {
+            errorDescription = res->getMessages();
+            removeTexture( itor->second.placeholder );
+            mStreamedTextures.erase( itor );
+        }
+
+        if( !errorDescription.empty() )
+        {
+            LogManager::getSingleton().logMessage( LML_CRITICAL, errorDescription );
+            if( mListener )
+                mListener->textureStreamingFailed( response.aliasName, errorDescription );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void HlmsTextureManager::streamedTextureDecoded( StreamedTextureMap::iterator itor, Image *image )
+    {
+        StreamedTexture &streamed = itor->second;
+
+        const TextureLocation placeholderLocation = getStreamedLocation( streamed );
+
+        if( image->hasFlag( IF_CUBEMAP ) || image->hasFlag( IF_3D_TEXTURE ) )
+        {
+            //Not streamed. Now that the decoding is done, load it the regular way.
+            const String aliasName          = streamed.aliasName;
+            const String resourceName       = streamed.resourceName;
+            const TextureMapType mapType    = streamed.mapType;
+            TexturePtr placeholder          = streamed.placeholder;
+            mStreamedTextures.erase( itor );
+
+            TextureLocation location;
+
+            try
+            {
+                location = createOrRetrieveTexture( aliasName, resourceName, mapType, image );
+            }
+            catch( Exception &e )
+            {
+                OGRE_DELETE image;
+                removeTexture( placeholder );
+                throw;
+            }
+
+            OGRE_DELETE image;
+
+            updateDatablocks( placeholderLocation, location, 0.0f );
+            removeTexture( placeholder );
+
+            if( mListener )
+            {
+                mListener->textureLocationChanged( aliasName, location, 0,
+                                                   location.texture->getNumMipmaps() );
+            }
+            return;
+        }
+
+        streamed.image          = image;
+        streamed.pixelFormat    = selectPixelFormat( image->getFormat(), streamed.mapType,
+                                                     streamed.resourceName );
+
+        const uint8 numMipmaps      = image->getNumMipmaps();
+        const uint32 imageRes       = std::max( image->getWidth(), image->getHeight() );
+        const ushort maxResolution  = mRenderSystem->getCapabilities()->getMaximumResolution2D();
+
+        //The texture is too big. Take a smaller mip.
+        while( streamed.baseMip < numMipmaps && (imageRes >> streamed.baseMip) > maxResolution )
+            ++streamed.baseMip;
+
+        if( (imageRes >> streamed.baseMip) > maxResolution )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Texture " + streamed.resourceName + " is bigger than the maximum "
+                         "resolution and has no mipmaps to fall back to. Streamed textures "
+                         "can't be resized. Bake the mipmaps offline, or disable streaming.",
+                         "HlmsTextureManager::streamedTextureDecoded" );
+        }
+
+        streamed.lowestMip = streamed.baseMip;
+        while( streamed.lowestMip < numMipmaps &&
+               (imageRes >> streamed.lowestMip) > mMinResidentResolution )
+        {
+            ++streamed.lowestMip;
+        }
+
+        //Reserve a slot at full size, like any other texture would. The
+        //mips that aren't uploaded yet are hidden through the min LOD.
+        TextureArrayVec::iterator dstArrayIt = findOrCreateArray(
+                    streamed.mapType, TEX_TYPE_2D_ARRAY,
+                    std::max<uint32>( image->getWidth() >> streamed.baseMip, 1u ),
+                    std::max<uint32>( image->getHeight() >> streamed.baseMip, 1u ), 1, 1,
+                    streamed.pixelFormat, numMipmaps - streamed.baseMip, maxResolution );
+
+        const uint16 entryIdx = dstArrayIt->createEntry();
+        const uint16 arrayIdx = dstArrayIt - mTextureArrays[streamed.mapType].begin();
+
+        dstArrayIt->entries[entryIdx] = TextureArray::NamePair( streamed.aliasName,
+                                                                streamed.resourceName );
+        const TextureEntry entry( itor->first, streamed.mapType, arrayIdx, entryIdx );
+        mEntries.insert( std::lower_bound( mEntries.begin(), mEntries.end(), entry ), entry );
+
+        streamed.residentMip    = streamed.lowestMip;
+        streamed.uploadedMip    = streamed.lowestMip;
+        streamed.targetMip      = streamed.lowestMip;
+
+        for( uint8 i=streamed.lowestMip; i<=numMipmaps; ++i )
+        {
+            mBytesUploadedThisFrame += copyMipToTexture( *image, i, dstArrayIt->texture,
+                                                         i - streamed.baseMip, entryIdx,
+                                                         dstArrayIt->isNormalMap );
+        }
+
+        updateDatablocks( placeholderLocation, getStreamedLocation( streamed ),
+                          static_cast<float>( streamed.residentMip - streamed.baseMip ) );
+        removeTexture( streamed.placeholder );
+
+        if( mListener )
+        {
+            mListener->textureLocationChanged( streamed.aliasName, getStreamedLocation( streamed ),
+                                               streamed.residentMip, numMipmaps );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    HlmsTextureManager::TextureLocation HlmsTextureManager::getStreamedLocation(
+                                                        const StreamedTexture &streamed ) const
+    {
+        TextureLocation retVal = getBlankTexture();
+
+        if( !streamed.image )
+        {
+            if( !streamed.placeholder.isNull() )
+                retVal.texture = streamed.placeholder;
+        }
+        else
+        {
+            TextureEntry searchName( streamed.aliasName );
+            TextureEntryVec::const_iterator it = std::lower_bound( mEntries.begin(), mEntries.end(),
+                                                                   searchName );
+            if( it != mEntries.end() && it->name == searchName.name )
+                retVal = getTextureLocation( *it );
+        }
+
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------------
+    void HlmsTextureManager::updateDatablocks( const TextureLocation &oldLocation,
+                                               const TextureLocation &newLocation, float minLod )
+    {
+        Root *root = Root::getSingletonPtr();
+
+        if( !root || oldLocation.texture.isNull() )
+            return;
+
+        HlmsManager *hlmsManager = root->getHlmsManager();
+
+        for( size_t i=0; i<HLMS_MAX; ++i )
+        {
+            Hlms *hlms = hlmsManager->getHlms( static_cast<HlmsTypes>( i ) );
+
+            if( hlms )
+            {
+                const Hlms::HlmsDatablockMap &datablocks = hlms->getDatablockMap();
+
+                Hlms::HlmsDatablockMap::const_iterator itor = datablocks.begin();
+                Hlms::HlmsDatablockMap::const_iterator end  = datablocks.end();
+
+                while( itor != end )
+                {
+                    itor->second.datablock->_replaceTexture( oldLocation.texture, oldLocation.xIdx,
+                                                             newLocation.texture, newLocation.xIdx,
+                                                             minLod );
+                    ++itor;
+                }
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void HlmsTextureManager::notifyResidencyChanged( StreamedTexture &streamed )
+    {
+        const TextureLocation location = getStreamedLocation( streamed );
+        updateDatablocks( location, location,
+                          static_cast<float>( streamed.residentMip - streamed.baseMip ) );
+        streamed.needsDatablockUpdate = false;
+
+        if( mListener )
+        {
+            mListener->textureLocationChanged( streamed.aliasName, location,
+                                               streamed.residentMip, streamed.image->getNumMipmaps() );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void HlmsTextureManager::updateStreamingTargets(void)
+    {
+        mStreamedByDemand.clear();
+
+        StreamedTextureMap::iterator itMap = mStreamedTextures.begin();
+        StreamedTextureMap::iterator enMap = mStreamedTextures.end();
+
+        while( itMap != enMap )
+        {
+            if( itMap->second.image )
+                mStreamedByDemand.push_back( &itMap->second );
+            ++itMap;
+        }
+
+        std::sort( mStreamedByDemand.begin(), mStreamedByDemand.end(),
+                   StreamedTexture::OrderByHighestDemand );
+
+        //The lowest mips are always resident, so they're not accounted in the budget.
+        size_t usedBytes = 0;
+
+        StreamedTextureVec::const_iterator itor = mStreamedByDemand.begin();
+        StreamedTextureVec::const_iterator end  = mStreamedByDemand.end();
+
+        while( itor != end )
+        {
+            StreamedTexture &streamed = **itor;
+
+            //Pick the smallest mip that still covers the size on screen
+            uint8 wantedMip = streamed.lowestMip;
+            if( streamed.demand > Real( 0 ) )
+            {
+                const uint32 imageRes = std::max( streamed.image->getWidth(),
+                                                  streamed.image->getHeight() );
+                wantedMip = streamed.baseMip;
+                while( wantedMip < streamed.lowestMip &&
+                       Real( imageRes >> (wantedMip + 1u) ) >= streamed.demand )
+                {
+                    ++wantedMip;
+                }
+            }
+
+            //Take the most detailed mip that fits in what's left of the budget
+            const size_t lowestMipsSize = getMipChainSize( *streamed.image, streamed.pixelFormat,
+                                                           streamed.lowestMip );
+            uint8 targetMip = streamed.lowestMip;
+            for( uint8 mip=wantedMip; mip<streamed.lowestMip && targetMip == streamed.lowestMip; ++mip )
+            {
+                const size_t extraSize = getMipChainSize( *streamed.image, streamed.pixelFormat, mip ) -
+                                         lowestMipsSize;
+                if( usedBytes + extraSize <= mStreamingBudget )
+                {
+                    targetMip = mip;
+                    usedBytes += extraSize;
+                }
+            }
+
+            streamed.targetMip = targetMip;
+
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void HlmsTextureManager::uploadPendingMips(void)
+    {
+        //Evictions just hide mips, and mips that were evicted are still in
+        //the array; neither costs an upload. The rest get uploaded one mip at
+        //a time, serving the textures with the highest demand first.
+        StreamedTextureVec::const_iterator itor = mStreamedByDemand.begin();
+        StreamedTextureVec::const_iterator end  = mStreamedByDemand.end();
+
+        while( itor != end )
+        {
+            StreamedTexture &streamed = **itor;
+            const uint8 oldResidentMip = streamed.residentMip;
+
+            if( streamed.targetMip > streamed.residentMip )
+            {
+                streamed.residentMip = streamed.targetMip;
+                ++mNumEvictions;
+            }
+
+            while( streamed.residentMip > streamed.targetMip )
+            {
+                const uint8 mip = streamed.residentMip - 1u;
+
+                if( mip < streamed.uploadedMip )
+                {
+                    if( mBytesUploadedThisFrame >= mUploadBytesPerFrame )
+                        break;
+
+                    const TextureLocation location = getStreamedLocation( streamed );
+                    mBytesUploadedThisFrame += copyMipToTexture(
+                                *streamed.image, mip, location.texture, mip - streamed.baseMip,
+                                location.xIdx, mDefaultTextureParameters[streamed.mapType].isNormalMap );
+                    streamed.uploadedMip = mip;
+                }
+
+                streamed.residentMip = mip;
+            }
+
+            if( streamed.residentMip != oldResidentMip )
+            {
+                notifyResidencyChanged( streamed );
+            }
+            else if( streamed.needsDatablockUpdate )
+            {
+                const TextureLocation location = getStreamedLocation( streamed );
+                updateDatablocks( location, location,
+                                  static_cast<float>( streamed.residentMip - streamed.baseMip ) );
+                streamed.needsDatablockUpdate = false;
+            }
+
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void HlmsTextureManager::setStreamingEnabled( bool bEnabled )
+    {
+        if( bEnabled && !mStreamingHandlersRegistered )
+        {
+            WorkQueue *workQueue = Root::getSingleton().getWorkQueue();
+            mWorkQueueChannel = workQueue->getChannel( "Ogre/HlmsTextureManager" );
+            workQueue->addRequestHandler( mWorkQueueChannel, this );
+            workQueue->addResponseHandler( mWorkQueueChannel, this );
+            mStreamingHandlersRegistered = true;
+        }
+
+        mStreamingEnabled = bEnabled;
+    }
+    //-----------------------------------------------------------------------------------
+    void HlmsTextureManager::setStreamingDemand( IdString aliasName, Real screenSize )
+    {
+        StreamedTextureMap::iterator itor = mStreamedTextures.find( aliasName );
+        if( itor != mStreamedTextures.end() )
+            itor->second.demand = screenSize;
+    }
+    //-----------------------------------------------------------------------------------
+    HlmsTextureManager::StreamingStats HlmsTextureManager::getStreamingStats(void) const
+    {
+        StreamingStats retVal;
+        retVal.numStreamedTextures      = mStreamedTextures.size();
+        retVal.bytesUploadedLastFrame   = mBytesUploadedLastFrame;
+        retVal.numEvictions             = mNumEvictions;
+
+        StreamedTextureMap::const_iterator itor = mStreamedTextures.begin();
+        StreamedTextureMap::const_iterator end  = mStreamedTextures.end();
+
+        while( itor != end )
+        {
+            const StreamedTexture &streamed = itor->second;
+
+            if( !streamed.image )
+            {
+                ++retVal.numPendingDecodes;
+            }
+            else
+            {
+                if( streamed.residentMip > streamed.targetMip )
+                    ++retVal.numPendingUploads;
+                if( streamed.residentMip == streamed.baseMip )
+                    ++retVal.numFullyResident;
+
+                retVal.residentBytes += getMipChainSize( *streamed.image, streamed.pixelFormat,
+                                                         streamed.residentMip );
+            }
+
+            ++itor;
+        }
+
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------------
+    void HlmsTextureManager::_update(void)
+    {
+        if( !mStreamedTextures.empty() )
+        {
+            updateStreamingTargets();
+            uploadPendingMips();
+        }
+
+        mBytesUploadedLastFrame = mBytesUploadedThisFrame;
+        mBytesUploadedThisFrame = 0;
+    }
+    //-----------------------------------------------------------------------------------
     //-----------------------------------------------------------------------------------
     //-----------------------------------------------------------------------------------
     uint16 HlmsTextureManager::TextureArray::createEntry(void)
@@ -99,6 +99,7 @@ namespace Ogre {
         {
             const SkeletonDef *skeletonDef = mMesh->getSkeleton().get();
             mSkeletonInstance = mManager->createSkeletonInstance( skeletonDef );
+            mSkeletonInstance->_setLodSource( this );
         }
 
         mLodMesh = mMesh->_getLodValueArray();
@@ -144,6 +145,8 @@ namespace Ogre {
             mSkeletonInstance->_decrementRefCount();
             if( mSkeletonInstance->_getRefCount() == 0u )
                 mManager->destroySkeletonInstance( mSkeletonInstance );
+            else if( mSkeletonInstance->_getLodSource() == this )
+                mSkeletonInstance->_setLodSource( 0 );
 
             mSkeletonInstance = 0;
         }
@@ -294,10 +297,14 @@ namespace Ogre {
             mSkeletonInstance->_decrementRefCount();
             if( mSkeletonInstance->_getRefCount() == 0u )
                 mManager->destroySkeletonInstance( mSkeletonInstance );
+            else if( mSkeletonInstance->_getLodSource() == this )
+                mSkeletonInstance->_setLodSource( 0 );
         }
 
         mSkeletonInstance = master->mSkeletonInstance;
         mSkeletonInstance->_incrementRefCount();
+        if( !mSkeletonInstance->_getLodSource() )
+            mSkeletonInstance->_setLodSource( this );
     }
     //-----------------------------------------------------------------------
     void Item::stopUsingSkeletonInstanceFromMaster()
@@ -310,9 +317,12 @@ namespace Ogre {
             mSkeletonInstance->_decrementRefCount();
             if( mSkeletonInstance->_getRefCount() == 0u )
                 mManager->destroySkeletonInstance( mSkeletonInstance );
+            else if( mSkeletonInstance->_getLodSource() == this )
+                mSkeletonInstance->_setLodSource( 0 );
 
             const SkeletonDef *skeletonDef = mMesh->getSkeleton().get();
             mSkeletonInstance = mManager->createSkeletonInstance( skeletonDef );
+            mSkeletonInstance->_setLodSource( this );
         }
     }
     //-----------------------------------------------------------------------
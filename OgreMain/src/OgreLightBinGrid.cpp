@@ -0,0 +1,650 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2017 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreLightBinGrid.h"
+#include "OgreLight.h"
+#include "OgreCamera.h"
+#include "Math/Array/OgreObjectMemoryManager.h"
+
+namespace Ogre
+{
+    /// Unique across all grids, so that an object moved to another SceneManager
+    /// can't mistake its old light list for a valid one.
+    static uint32 sNextFrameId = 1u;
+
+    static inline bool isFiniteBox( const Vector3 &vMin, const Vector3 &vMax )
+    {
+        const Real maxReal = std::numeric_limits<Real>::max();
+        for( size_t i=0; i<3; ++i )
+        {
+            if( !(vMin[i] >= -maxReal && vMax[i] <= maxReal) )
+                return false;
+        }
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    LightBinGrid::LightBinGrid( Real cellSize, uint32 maxCellsPerAxis, size_t numThreads ) :
+        mCellSize( cellSize ),
+        mMaxCellsPerAxis( std::max( maxCellsPerAxis, 1u ) ),
+        mNumThreads( numThreads ),
+        mOrigin( Vector3::ZERO ),
+        mCellDimensions( cellSize ),
+        mFrameId( 0 ),
+        mPrevFrameId( 0 ),
+        mUnboundedHash( 0 ),
+        mUnboundedDirty( true ),
+        mHashesValid( false ),
+        mPreparedCamera( 0 ),
+        mPreparedFirstRq( 0 ),
+        mPreparedLastRq( 0 ),
+        mCullStamp( 0 )
+    {
+        if( cellSize <= Real( 0 ) )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS, "cellSize must be greater than 0",
+                         "LightBinGrid::LightBinGrid" );
+        }
+
+        mNumCells[0] = mNumCells[1] = mNumCells[2] = 0;
+        mThreadScratch.resize( numThreads );
+    }
+    //-----------------------------------------------------------------------------------
+    LightBinGrid::~LightBinGrid()
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    size_t LightBinGrid::getNumCells(void) const
+    {
+        return mNumCells[0] * mNumCells[1] * mNumCells[2];
+    }
+    //-----------------------------------------------------------------------------------
+    bool LightBinGrid::updateLayout( const Vector3 &vMin, const Vector3 &vMax )
+    {
+        //Keep the current grid while it still covers all the lights and isn't
+        //much bigger than needed. Otherwise every light list would be rebuilt
+        //each time a light at the edge of the scene moves a bit.
+        if( mNumCells[0] )
+        {
+            bool keep = true;
+            for( size_t i=0; i<3 && keep; ++i )
+            {
+                const Real gridMax = mOrigin[i] + mCellDimensions[i] * Real( mNumCells[i] );
+                const Real neededCells = (vMax[i] - vMin[i]) / mCellDimensions[i];
+                keep = vMin[i] >= mOrigin[i] && vMax[i] <= gridMax &&
+                        Real( mNumCells[i] ) <= neededCells * Real( 2 ) + Real( 3 );
+            }
+
+            if( keep )
+                return false;
+        }
+
+        for( size_t i=0; i<3; ++i )
+        {
+            //Pad by one cell on each side, snapped to the cell size
+            const double firstCell = Math::Floor( vMin[i] / mCellSize ) - 1.0;
+            const double lastCell  = Math::Floor( vMax[i] / mCellSize ) + 1.0;
+            const double numCells  = lastCell - firstCell + 1.0;
+
+            double cellsPerBin = 1.0;
+            if( numCells > double( mMaxCellsPerAxis ) )
+                cellsPerBin = std::ceil( numCells / double( mMaxCellsPerAxis ) );
+
+            mOrigin[i]          = Real( firstCell * mCellSize );
+            mCellDimensions[i]  = Real( cellsPerBin * mCellSize );
+            mNumCells[i]        = static_cast<uint32>( std::min( std::ceil( numCells / cellsPerBin ),
+                                                                 double( mMaxCellsPerAxis ) ) );
+        }
+
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    bool LightBinGrid::getCellRange( const Vector3 &vMin, const Vector3 &vMax,
+                                     uint32 outMin[3], uint32 outMax[3] ) const
+    {
+        for( size_t i=0; i<3; ++i )
+        {
+            const Real lo = (vMin[i] - mOrigin[i]) / mCellDimensions[i];
+            const Real hi = (vMax[i] - mOrigin[i]) / mCellDimensions[i];
+
+            if( !(hi >= Real( 0 ) && lo < Real( mNumCells[i] )) )
+                return false;
+
+            outMin[i] = lo <= Real( 0 ) ? 0u : static_cast<uint32>( lo );
+            outMax[i] = hi >= Real( mNumCells[i] - 1u ) ? mNumCells[i] - 1u :
+                                                          static_cast<uint32>( hi );
+        }
+
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    void LightBinGrid::_update( const LightListInfo &globalLightList,
+                                ObjectMemoryManager *lightMemoryManager )
+    {
+        mPreparedCamera = 0;
+        mPrevFrameId    = mFrameId;
+        mFrameId        = sNextFrameId++;
+        if( !sNextFrameId )
+            sNextFrameId = 1u;
+
+        //Fit the grid around all the lights with finite bounds
+        Vector3 vMin( Vector3::UNIT_SCALE * std::numeric_limits<Real>::max() );
+        Vector3 vMax( -vMin );
+
+        const size_t numGlobalLights = globalLightList.lights.size();
+        for( size_t i=0; i<numGlobalLights; ++i )
+        {
+            const Sphere &sphere = globalLightList.boundingSphere[i];
+            const Vector3 vRadius( sphere.getRadius() );
+            if( isFiniteBox( sphere.getCenter() - vRadius, sphere.getCenter() + vRadius ) )
+            {
+                vMin.makeFloor( sphere.getCenter() - vRadius );
+                vMax.makeCeil( sphere.getCenter() + vRadius );
+            }
+        }
+
+        const size_t numRenderQueues = lightMemoryManager->getNumRenderQueues();
+        for( size_t i=1; i<numRenderQueues; ++i )
+        {
+            ObjectData objData;
+            const size_t totalObjs = lightMemoryManager->getFirstObjectData( objData, i );
+
+            for( size_t j=0; j<totalObjs; j += ARRAY_PACKED_REALS )
+            {
+                for( size_t k=0; k<ARRAY_PACKED_REALS; ++k )
+                {
+                    if( objData.mOwner[k] )
+                    {
+                        const Vector3 center    = objData.mWorldAabb->mCenter.getAsVector3( k );
+                        const Vector3 halfSize  = objData.mWorldAabb->mHalfSize.getAsVector3( k );
+                        if( isFiniteBox( center - halfSize, center + halfSize ) )
+                        {
+                            vMin.makeFloor( center - halfSize );
+                            vMax.makeCeil( center + halfSize );
+                        }
+                    }
+                }
+
+                objData.advancePack();
+            }
+        }
+
+        if( vMin.x > vMax.x )
+            vMin = vMax = Vector3::ZERO;
+
+        const size_t oldNumCells = getNumCells();
+        const bool layoutChanged = updateLayout( vMin, vMax );
+        mHashesValid = !layoutChanged && mPrevFrameId != 0 && oldNumCells == getNumCells();
+
+        binGlobalLights( globalLightList );
+        binLightPacks( lightMemoryManager );
+
+        for( size_t i=0; i<mNumThreads; ++i )
+        {
+            ThreadScratch &scratch = mThreadScratch[i];
+            scratch.lightStamp.clear();
+            scratch.lightStamp.resize( numGlobalLights, 0 );
+            scratch.stamp = 0;
+            scratch.numReusedLists = 0;
+            scratch.numRebuiltLists = 0;
+        }
+
+        mStats.numReusedLists = 0;
+        mStats.numRebuiltLists = 0;
+    }
+    //-----------------------------------------------------------------------------------
+    void LightBinGrid::binGlobalLights( const LightListInfo &globalLightList )
+    {
+        const size_t numCells = getNumCells();
+        const size_t numGlobalLights = globalLightList.lights.size();
+
+        //Hash everything that affects the light lists
+        mLightHash.resize( numGlobalLights );
+        for( size_t i=0; i<numGlobalLights; ++i )
+        {
+            struct
+            {
+                Light   *light;
+                uint32  globalIndex;
+                uint32  visibilityMask;
+                Real    sphere[4];
+            } hashEntry;
+            memset( &hashEntry, 0, sizeof( hashEntry ) );
+
+            const Sphere &sphere = globalLightList.boundingSphere[i];
+            hashEntry.light         = globalLightList.lights[i];
+            hashEntry.globalIndex   = static_cast<uint32>( i );
+            hashEntry.visibilityMask= globalLightList.visibilityMask[i];
+            hashEntry.sphere[0]     = sphere.getCenter().x;
+            hashEntry.sphere[1]     = sphere.getCenter().y;
+            hashEntry.sphere[2]     = sphere.getCenter().z;
+            hashEntry.sphere[3]     = sphere.getRadius();
+            mLightHash[i] = FastHash( reinterpret_cast<const char*>( &hashEntry ),
+                                      sizeof( hashEntry ) );
+        }
+
+        mUnboundedLights.clear();
+        mLightCellEntries.clear();
+        mLightCellStart.clear();
+        mLightCellStart.resize( numCells + 1u, 0 );
+
+        //Two passes: count the lights in each cell, then fill them.
+        vector<uint32>::type cellCursor;
+        for( size_t pass=0; pass<2u; ++pass )
+        {
+            for( size_t i=0; i<numGlobalLights; ++i )
+            {
+                const Sphere &sphere = globalLightList.boundingSphere[i];
+                const Vector3 vRadius( sphere.getRadius() );
+                const Vector3 vMin( sphere.getCenter() - vRadius );
+                const Vector3 vMax( sphere.getCenter() + vRadius );
+
+                if( globalLightList.lights[i]->getType() == Light::LT_DIRECTIONAL ||
+                    !isFiniteBox( vMin, vMax ) )
+                {
+                    if( pass == 0 )
+                        mUnboundedLights.push_back( static_cast<uint32>( i ) );
+                    continue;
+                }
+
+                uint32 cellMin[3], cellMax[3];
+                if( !getCellRange( vMin, vMax, cellMin, cellMax ) )
+                    continue;
+
+                for( uint32 z=cellMin[2]; z<=cellMax[2]; ++z )
+                {
+                    for( uint32 y=cellMin[1]; y<=cellMax[1]; ++y )
+                    {
+                        for( uint32 x=cellMin[0]; x<=cellMax[0]; ++x )
+                        {
+                            const uint32 cellIdx = getCellIdx( x, y, z );
+                            if( pass == 0 )
+                                ++mLightCellStart[cellIdx + 1u];
+                            else
+                                mLightCellEntries[cellCursor[cellIdx]++] = static_cast<uint32>( i );
+                        }
+                    }
+                }
+            }
+
+            if( pass == 0 )
+            {
+                for( size_t i=0; i<numCells; ++i )
+                    mLightCellStart[i + 1u] += mLightCellStart[i];
+                mLightCellEntries.resize( mLightCellStart.back() );
+                cellCursor.assign( mLightCellStart.begin(), mLightCellStart.end() - 1 );
+            }
+        }
+
+        //Compare against last frame
+        mStats.numDirtyCells = 0;
+        mStats.numUsedCells = 0;
+        mCellHash.resize( numCells, 0 );
+        mCellDirty.resize( numCells, 1u );
+        for( size_t i=0; i<numCells; ++i )
+        {
+            uint32 hash = mLightCellStart[i + 1u] - mLightCellStart[i];
+            for( uint32 j=mLightCellStart[i]; j<mLightCellStart[i + 1u]; ++j )
+                hash = FastHash( reinterpret_cast<const char*>( &mLightHash[mLightCellEntries[j]] ),
+                                 sizeof( uint32 ), hash );
+
+            mCellDirty[i] = !mHashesValid || hash != mCellHash[i];
+            mCellHash[i] = hash;
+            mStats.numDirtyCells += mCellDirty[i];
+            mStats.numUsedCells += mLightCellStart[i + 1u] != mLightCellStart[i];
+        }
+
+        uint32 unboundedHash = static_cast<uint32>( mUnboundedLights.size() );
+        vector<uint32>::type::const_iterator itor = mUnboundedLights.begin();
+        vector<uint32>::type::const_iterator end  = mUnboundedLights.end();
+        while( itor != end )
+        {
+            unboundedHash = FastHash( reinterpret_cast<const char*>( &mLightHash[*itor] ),
+                                      sizeof( uint32 ), unboundedHash );
+            ++itor;
+        }
+
+        mUnboundedDirty = mPrevFrameId == 0 || unboundedHash != mUnboundedHash;
+        mUnboundedHash = unboundedHash;
+    }
+    //-----------------------------------------------------------------------------------
+    void LightBinGrid::binLightPacks( ObjectMemoryManager *lightMemoryManager )
+    {
+        const size_t numCells = getNumCells();
+        const size_t numRenderQueues = lightMemoryManager->getNumRenderQueues();
+
+        mPackBins.resize( numRenderQueues );
+        mCellLastPack.resize( numCells );
+
+        vector<uint32>::type cellCursor;
+
+        //Render queue 0 holds the directional lights; they're never binned.
+        for( size_t rq=1; rq<numRenderQueues; ++rq )
+        {
+            PackBins &bins = mPackBins[rq];
+
+            ObjectData firstObjData;
+            const size_t totalObjs = lightMemoryManager->getFirstObjectData( firstObjData, rq );
+            const uint32 numPacks = static_cast<uint32>( (totalObjs + ARRAY_PACKED_REALS - 1u) /
+                                                         ARRAY_PACKED_REALS );
+
+            bins.numObjects = totalObjs;
+            bins.packs.clear();
+            bins.unboundedPacks.clear();
+            bins.visiblePacks.clear();
+            bins.packStamp.clear();
+            bins.packStamp.resize( numPacks, 0 );
+            bins.cellStart.clear();
+            bins.cellStart.resize( numCells + 1u, 0 );
+
+            for( size_t pass=0; pass<2u; ++pass )
+            {
+                std::fill( mCellLastPack.begin(), mCellLastPack.end(), ~0u );
+
+                ObjectData objData = firstObjData;
+                for( uint32 packIdx=0; packIdx<numPacks; ++packIdx )
+                {
+                    bool isUnbounded = false;
+                    for( size_t k=0; k<ARRAY_PACKED_REALS && !isUnbounded; ++k )
+                    {
+                        if( objData.mOwner[k] )
+                        {
+                            const Vector3 center    = objData.mWorldAabb->mCenter.getAsVector3( k );
+                            const Vector3 halfSize  = objData.mWorldAabb->mHalfSize.getAsVector3( k );
+                            isUnbounded = !isFiniteBox( center - halfSize, center + halfSize );
+                        }
+                    }
+
+                    if( isUnbounded )
+                    {
+                        if( pass == 0 )
+                            bins.unboundedPacks.push_back( packIdx );
+                        objData.advancePack();
+                        continue;
+                    }
+
+                    for( size_t k=0; k<ARRAY_PACKED_REALS; ++k )
+                    {
+                        if( !objData.mOwner[k] )
+                            continue;
+
+                        const Vector3 center    = objData.mWorldAabb->mCenter.getAsVector3( k );
+                        const Vector3 halfSize  = objData.mWorldAabb->mHalfSize.getAsVector3( k );
+
+                        uint32 cellMin[3], cellMax[3];
+                        if( !getCellRange( center - halfSize, center + halfSize, cellMin, cellMax ) )
+                            continue;
+
+                        for( uint32 z=cellMin[2]; z<=cellMax[2]; ++z )
+                        {
+                            for( uint32 y=cellMin[1]; y<=cellMax[1]; ++y )
+                            {
+                                for( uint32 x=cellMin[0]; x<=cellMax[0]; ++x )
+                                {
+                                    const uint32 cellIdx = getCellIdx( x, y, z );
+                                    if( mCellLastPack[cellIdx] != packIdx )
+                                    {
+                                        mCellLastPack[cellIdx] = packIdx;
+                                        if( pass == 0 )
+                                            ++bins.cellStart[cellIdx + 1u];
+                                        else
+                                            bins.packs[cellCursor[cellIdx]++] = packIdx;
+                                    }
+                                }
+                            }
+                        }
+                    }
+
+                    objData.advancePack();
+                }
+
+                if( pass == 0 )
+                {
+                    for( size_t i=0; i<numCells; ++i )
+                        bins.cellStart[i + 1u] += bins.cellStart[i];
+                    bins.packs.resize( bins.cellStart.back() );
+                    cellCursor.assign( bins.cellStart.begin(), bins.cellStart.end() - 1 );
+                }
+            }
+        }
+
+        mPackCells.clear();
+        for( uint32 i=0; i<numCells; ++i )
+        {
+            bool isUsed = false;
+            for( size_t rq=1; rq<numRenderQueues && !isUsed; ++rq )
+                isUsed = mPackBins[rq].cellStart[i + 1u] != mPackBins[rq].cellStart[i];
+
+            if( isUsed )
+                mPackCells.push_back( i );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    bool LightBinGrid::isClean( uint32 builtFrameId, const Vector3 &vMin,
+                                const Vector3 &vMax ) const
+    {
+        if( builtFrameId != mPrevFrameId || !mHashesValid || mUnboundedDirty )
+            return false;
+
+        uint32 cellMin[3], cellMax[3];
+        if( !getCellRange( vMin, vMax, cellMin, cellMax ) )
+            return true; //Only the unbounded lights can affect it
+
+        for( uint32 z=cellMin[2]; z<=cellMax[2]; ++z )
+        {
+            for( uint32 y=cellMin[1]; y<=cellMax[1]; ++y )
+            {
+                const uint32 rowStart = getCellIdx( 0, y, z );
+                for( uint32 x=cellMin[0]; x<=cellMax[0]; ++x )
+                {
+                    if( mCellDirty[rowStart + x] )
+                        return false;
+                }
+            }
+        }
+
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    const vector<uint32>::type& LightBinGrid::gatherLights( const Vector3 &vMin,
+                                                            const Vector3 &vMax,
+                                                            size_t threadIdx )
+    {
+        ThreadScratch &scratch = mThreadScratch[threadIdx];
+        vector<uint32>::type &candidates = scratch.candidates;
+
+        candidates.clear();
+        candidates.insert( candidates.end(), mUnboundedLights.begin(), mUnboundedLights.end() );
+
+        ++scratch.stamp;
+        if( !scratch.stamp )
+        {
+            std::fill( scratch.lightStamp.begin(), scratch.lightStamp.end(), 0u );
+            scratch.stamp = 1u;
+        }
+
+        uint32 cellMin[3], cellMax[3];
+        if( getCellRange( vMin, vMax, cellMin, cellMax ) )
+        {
+            for( uint32 z=cellMin[2]; z<=cellMax[2]; ++z )
+            {
+                for( uint32 y=cellMin[1]; y<=cellMax[1]; ++y )
+                {
+                    for( uint32 x=cellMin[0]; x<=cellMax[0]; ++x )
+                    {
+                        const uint32 cellIdx = getCellIdx( x, y, z );
+                        for( uint32 i=mLightCellStart[cellIdx]; i<mLightCellStart[cellIdx + 1u]; ++i )
+                        {
+                            const uint32 lightIdx = mLightCellEntries[i];
+                            if( scratch.lightStamp[lightIdx] != scratch.stamp )
+                            {
+                                scratch.lightStamp[lightIdx] = scratch.stamp;
+                                candidates.push_back( lightIdx );
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        //Keep the same order as the global light list
+        std::sort( candidates.begin(), candidates.end() );
+
+        return candidates;
+    }
+    //-----------------------------------------------------------------------------------
+    void LightBinGrid::_notifyLightListBuilt( size_t threadIdx, bool reused )
+    {
+        if( reused )
+            ++mThreadScratch[threadIdx].numReusedLists;
+        else
+            ++mThreadScratch[threadIdx].numRebuiltLists;
+    }
+    //-----------------------------------------------------------------------------------
+    void LightBinGrid::_mergeStats(void)
+    {
+        mStats.numReusedLists = 0;
+        mStats.numRebuiltLists = 0;
+        for( size_t i=0; i<mNumThreads; ++i )
+        {
+            mStats.numReusedLists   += mThreadScratch[i].numReusedLists;
+            mStats.numRebuiltLists  += mThreadScratch[i].numRebuiltLists;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void LightBinGrid::_prepareCullLights( const Camera *camera,
+                                           ObjectMemoryManager *lightMemoryManager,
+                                           size_t firstRq, size_t lastRq )
+    {
+        firstRq = std::max<size_t>( firstRq, 1u );
+        lastRq  = std::min( lastRq, mPackBins.size() );
+
+        mPreparedCamera     = camera;
+        mPreparedFirstRq    = firstRq;
+        mPreparedLastRq     = lastRq;
+
+        ++mCullStamp;
+        if( !mCullStamp )
+        {
+            for( size_t rq=1; rq<mPackBins.size(); ++rq )
+                std::fill( mPackBins[rq].packStamp.begin(), mPackBins[rq].packStamp.end(), 0u );
+            mCullStamp = 1u;
+        }
+
+        for( size_t rq=firstRq; rq<lastRq; ++rq )
+        {
+            PackBins &bins = mPackBins[rq];
+            bins.visiblePacks.clear();
+
+            vector<uint32>::type::const_iterator itor = bins.unboundedPacks.begin();
+            vector<uint32>::type::const_iterator end  = bins.unboundedPacks.end();
+            while( itor != end )
+            {
+                bins.packStamp[*itor] = mCullStamp;
+                bins.visiblePacks.push_back( *itor );
+                ++itor;
+            }
+        }
+
+        vector<uint32>::type::const_iterator itor = mPackCells.begin();
+        vector<uint32>::type::const_iterator end  = mPackCells.end();
+
+        while( itor != end )
+        {
+            const uint32 cellIdx = *itor;
+            const uint32 x = cellIdx % mNumCells[0];
+            const uint32 y = (cellIdx / mNumCells[0]) % mNumCells[1];
+            const uint32 z = cellIdx / (mNumCells[0] * mNumCells[1]);
+
+            const Vector3 cellMin( mOrigin + mCellDimensions * Vector3( Real( x ), Real( y ),
+                                                                         Real( z ) ) );
+            if( camera->isVisible( AxisAlignedBox( cellMin, cellMin + mCellDimensions ) ) )
+            {
+                for( size_t rq=firstRq; rq<lastRq; ++rq )
+                {
+                    PackBins &bins = mPackBins[rq];
+                    for( uint32 i=bins.cellStart[cellIdx]; i<bins.cellStart[cellIdx + 1u]; ++i )
+                    {
+                        const uint32 packIdx = bins.packs[i];
+                        if( bins.packStamp[packIdx] != mCullStamp )
+                        {
+                            bins.packStamp[packIdx] = mCullStamp;
+                            bins.visiblePacks.push_back( packIdx );
+                        }
+                    }
+                }
+            }
+
+            ++itor;
+        }
+
+        //Sweep through memory in order
+        for( size_t rq=firstRq; rq<lastRq; ++rq )
+            std::sort( mPackBins[rq].visiblePacks.begin(), mPackBins[rq].visiblePacks.end() );
+    }
+    //-----------------------------------------------------------------------------------
+    bool LightBinGrid::hasVisiblePacks( const Camera *camera, size_t renderQueue,
+                                        ObjectMemoryManager *lightMemoryManager ) const
+    {
+        if( camera != mPreparedCamera ||
+            renderQueue < mPreparedFirstRq || renderQueue >= mPreparedLastRq )
+        {
+            return false;
+        }
+
+        //Lights created after the bins were built aren't in them.
+        ObjectData objData;
+        return lightMemoryManager->getFirstObjectData( objData, renderQueue ) ==
+                mPackBins[renderQueue].numObjects;
+    }
+    //-----------------------------------------------------------------------------------
+    void LightBinGrid::cullLights( size_t renderQueue, const Camera *camera,
+                                   uint32 sceneVisibilityFlags,
+                                   ObjectMemoryManager *lightMemoryManager,
+                                   MovableObject::MovableObjectArray &outCulledObjects,
+                                   const Camera *lodCamera, size_t threadIdx ) const
+    {
+        const vector<uint32>::type &visiblePacks = mPackBins[renderQueue].visiblePacks;
+
+        //Distribute the work evenly across all threads
+        const size_t totalPacks = visiblePacks.size();
+        size_t numPacks = (totalPacks + mNumThreads - 1u) / mNumThreads;
+        const size_t firstPack = std::min( threadIdx * numPacks, totalPacks );
+        numPacks = std::min( numPacks, totalPacks - firstPack );
+
+        if( numPacks )
+        {
+            ObjectData firstObjData;
+            lightMemoryManager->getFirstObjectData( firstObjData, renderQueue );
+            MovableObject::cullFrustumPacks( &visiblePacks[firstPack], numPacks, firstObjData,
+                                             camera, sceneVisibilityFlags, outCulledObjects,
+                                             lodCamera, true );
+        }
+    }
+}
@@ -28,6 +28,8 @@ THE SOFTWARE.
 #include "OgreStableHeaders.h"
 
 #include "OgreLog.h"
+#include "OgreBitwise.h"
+#include "OgreStringConverter.h"
 #include <iomanip>
 #include <iostream>
 
@@ -35,6 +37,10 @@ THE SOFTWARE.
 #   include <windows.h>
 #endif
 
+#if OGRE_COMPILER == OGRE_COMPILER_MSVC
+#   include <intrin.h>
+#endif
+
 #if OGRE_PLATFORM == OGRE_PLATFORM_NACL
 #   include "ppapi/cpp/var.h"
 #   include "ppapi/cpp/instance.h"
@@ -46,10 +52,65 @@ namespace Ogre
     pp::Instance* Log::mInstance = NULL;    
 #endif
     
+    //-----------------------------------------------------------------------
+    // AtomicScalar is only atomic when OGRE_THREAD_SUPPORT is enabled, but the
+    // async queue must work regardless; so use the compiler intrinsics directly.
+    static inline uint32 atomicLoadAcquire( const volatile uint32 *ptr )
+    {
+#if OGRE_COMPILER == OGRE_COMPILER_MSVC
+        return static_cast<uint32>( _InterlockedOr( (volatile long*)ptr, 0 ) );
+#else
+        return __atomic_load_n( ptr, __ATOMIC_ACQUIRE );
+#endif
+    }
+    static inline void atomicStoreRelease( volatile uint32 *ptr, uint32 value )
+    {
+#if OGRE_COMPILER == OGRE_COMPILER_MSVC
+        _InterlockedExchange( (volatile long*)ptr, static_cast<long>( value ) );
+#else
+        __atomic_store_n( ptr, value, __ATOMIC_RELEASE );
+#endif
+    }
+    static inline bool atomicCompareAndSwap( volatile uint32 *ptr, uint32 oldValue, uint32 newValue )
+    {
+#if OGRE_COMPILER == OGRE_COMPILER_MSVC
+        return _InterlockedCompareExchange( (volatile long*)ptr, static_cast<long>( newValue ),
+                                            static_cast<long>( oldValue ) ) ==
+                static_cast<long>( oldValue );
+#else
+        return __sync_bool_compare_and_swap( ptr, oldValue, newValue );
+#endif
+    }
+    static inline void atomicIncrement( volatile uint32 *ptr )
+    {
+#if OGRE_COMPILER == OGRE_COMPILER_MSVC
+        _InterlockedExchangeAdd( (volatile long*)ptr, 1 );
+#else
+        __sync_fetch_and_add( ptr, 1u );
+#endif
+    }
+    //-----------------------------------------------------------------------
+    unsigned long asyncLogWriterThread( ThreadHandle *threadHandle )
+    {
+        Log *log = reinterpret_cast<Log*>( threadHandle->getUserParam() );
+        return log->_asyncWriterThread();
+    }
+    THREAD_DECLARE( asyncLogWriterThread );
+    //-----------------------------------------------------------------------
+    /// Queued strings bigger than this get their memory released once written,
+    /// so that one huge message doesn't stay pinned in the ring forever.
+    static const size_t c_maxRetainedAsyncMessageCapacity = 1024u;
     //-----------------------------------------------------------------------
     Log::Log( const String& name, bool debuggerOuput, bool suppressFile ) : 
         mLogLevel(LL_NORMAL), mDebugOut(debuggerOuput),
-        mSuppressFile(suppressFile), mTimeStamp(true), mLogName(name)
+        mSuppressFile(suppressFile), mTimeStamp(true), mLogName(name),
+        mAsyncCells( 0 ),
+        mAsyncCapacityMask( 0 ),
+        mAsyncEnqueuePos( 0 ),
+        mAsyncDequeuePos( 0 ),
+        mAsyncNumDropped( 0 ),
+        mAsyncNumDroppedReported( 0 ),
+        mAsyncStopWriter( 0 )
     {
         if (!mSuppressFile)
         {
@@ -59,6 +120,8 @@ namespace Ogre
     //-----------------------------------------------------------------------
     Log::~Log()
     {
+        setAsyncEnabled( false );
+
         OGRE_LOCK_AUTO_MUTEX;
         if (!mSuppressFile)
         {
@@ -68,61 +131,260 @@ namespace Ogre
     //-----------------------------------------------------------------------
     void Log::logMessage( const String& message, LogMessageLevel lml, bool maskDebug )
     {
-        OGRE_LOCK_AUTO_MUTEX;
-        if ((mLogLevel + lml) >= OGRE_LOG_THRESHOLD)
+        if( mAsyncCells )
         {
-            bool skipThisMessage = false;
-            for( mtLogListener::iterator i = mListeners.begin(); i != mListeners.end(); ++i )
-                (*i)->messageLogged( message, lml, maskDebug, mLogName, skipThisMessage);
-            
-            if (!skipThisMessage)
+            if( (mLogLevel + lml) >= OGRE_LOG_THRESHOLD )
             {
-#if OGRE_PLATFORM == OGRE_PLATFORM_NACL
-                if(mInstance != NULL)
+                enqueueAsyncMessage( message, lml, maskDebug );
+
+                //Best effort: if someone else is already draining (e.g. the writer
+                //thread, or a listener logging from inside it) they'll write it.
+                if( lml == LML_CRITICAL && mAsyncWriterMutex.tryLock() )
                 {
-                    mInstance->PostMessage(message.c_str());
+                    drainAsyncQueue();
+                    mAsyncWriterMutex.unlock();
                 }
+            }
+            return;
+        }
+
+        OGRE_LOCK_AUTO_MUTEX;
+        if ((mLogLevel + lml) >= OGRE_LOG_THRESHOLD)
+        {
+            time_t ctTime; time(&ctTime);
+            writeMessage( message, lml, maskDebug, ctTime, true );
+        }
+    }
+    //-----------------------------------------------------------------------
+    void Log::writeMessage( const String &message, LogMessageLevel lml, bool maskDebug,
+                            time_t timeStamp, bool flushEachLine )
+    {
+        bool skipThisMessage = false;
+        for( mtLogListener::iterator i = mListeners.begin(); i != mListeners.end(); ++i )
+            (*i)->messageLogged( message, lml, maskDebug, mLogName, skipThisMessage);
+
+        if (!skipThisMessage)
+        {
+#if OGRE_PLATFORM == OGRE_PLATFORM_NACL
+            if(mInstance != NULL)
+            {
+                mInstance->PostMessage(message.c_str());
+            }
 #else
-                if (mDebugOut && !maskDebug)
-                {
+            if (mDebugOut && !maskDebug)
+            {
 #    if (OGRE_PLATFORM == OGRE_PLATFORM_WIN32 || OGRE_PLATFORM == OGRE_PLATFORM_WINRT) && OGRE_DEBUG_MODE
 #        if OGRE_WCHAR_T_STRINGS
-                    OutputDebugStringW(message.c_str());
-                    OutputDebugStringW(L"\n");
+                OutputDebugStringW(message.c_str());
+                OutputDebugStringW(L"\n");
 #        else
-                    OutputDebugStringA(message.c_str());
-                    OutputDebugStringA("\n");
+                OutputDebugStringA(message.c_str());
+                OutputDebugStringA("\n");
 #        endif
 #    endif
-                    if (lml == LML_CRITICAL)
-                        std::cerr << message << std::endl;
-                    else
-                        std::cout << message << std::endl;
-                }
+                if (lml == LML_CRITICAL)
+                    std::cerr << message << std::endl;
+                else if( flushEachLine )
+                    std::cout << message << std::endl;
+                else
+                    std::cout << message << '\n';
+            }
 #endif
 
-                // Write time into log
-                if (!mSuppressFile)
+            // Write time into log
+            if (!mSuppressFile)
+            {
+                if (mTimeStamp)
                 {
-                    if (mTimeStamp)
-                    {
-                        struct tm *pTime;
-                        time_t ctTime; time(&ctTime);
-                        pTime = localtime( &ctTime );
-                        mLog << std::setw(2) << std::setfill('0') << pTime->tm_hour
-                            << ":" << std::setw(2) << std::setfill('0') << pTime->tm_min
-                            << ":" << std::setw(2) << std::setfill('0') << pTime->tm_sec
-                            << ": ";
-                    }
-                    mLog << message << std::endl;
-
-                    // Flush stcmdream to ensure it is written (incase of a crash, we need log to be up to date)
-                    mLog.flush();
+                    struct tm *pTime;
+                    pTime = localtime( &timeStamp );
+                    mLog << std::setw(2) << std::setfill('0') << pTime->tm_hour
+                        << ":" << std::setw(2) << std::setfill('0') << pTime->tm_min
+                        << ":" << std::setw(2) << std::setfill('0') << pTime->tm_sec
+                        << ": ";
                 }
+                mLog << message << '\n';
+
+                // Flush stream to ensure it is written (incase of a crash, we need log to be up to date)
+                if( flushEachLine )
+                    mLog.flush();
             }
         }
     }
-    
+    //-----------------------------------------------------------------------
+    void Log::enqueueAsyncMessage( const String &message, LogMessageLevel lml, bool maskDebug )
+    {
+        AsyncCell *cell = 0;
+        uint32 pos = atomicLoadAcquire( &mAsyncEnqueuePos );
+
+        while( !cell )
+        {
+            AsyncCell *candidate = &mAsyncCells[pos & mAsyncCapacityMask];
+            const int32 diff = static_cast<int32>( atomicLoadAcquire( &candidate->sequence ) - pos );
+
+            if( diff == 0 )
+            {
+                //The slot is free for this lap. Try to claim it.
+                if( atomicCompareAndSwap( &mAsyncEnqueuePos, pos, pos + 1u ) )
+                    cell = candidate;
+                else
+                    pos = atomicLoadAcquire( &mAsyncEnqueuePos );
+            }
+            else if( diff < 0 )
+            {
+                //The writer hasn't consumed this slot from the previous lap: full.
+                atomicIncrement( &mAsyncNumDropped );
+                return;
+            }
+            else
+            {
+                //Another producer claimed it first.
+                pos = atomicLoadAcquire( &mAsyncEnqueuePos );
+            }
+        }
+
+        time( &cell->timeStamp );
+        cell->lml       = lml;
+        cell->maskDebug = maskDebug;
+        cell->message   = message;
+
+        //Publish it to the writer.
+        atomicStoreRelease( &cell->sequence, pos + 1u );
+    }
+    //-----------------------------------------------------------------------
+    size_t Log::drainAsyncQueue(void)
+    {
+        size_t numWritten = 0;
+
+        bool queueEmpty = false;
+        while( !queueEmpty )
+        {
+            AsyncCell &cell = mAsyncCells[mAsyncDequeuePos & mAsyncCapacityMask];
+            const int32 diff = static_cast<int32>( atomicLoadAcquire( &cell.sequence ) -
+                                                   (mAsyncDequeuePos + 1u) );
+            if( diff < 0 )
+            {
+                //Nothing queued, or the producer is still copying the message.
+                queueEmpty = true;
+            }
+            else
+            {
+                writeMessage( cell.message, cell.lml, cell.maskDebug, cell.timeStamp, false );
+
+                if( cell.message.capacity() > c_maxRetainedAsyncMessageCapacity )
+                    String().swap( cell.message );
+                else
+                    cell.message.clear();
+
+                //Hand the slot back to the producers for the next lap.
+                atomicStoreRelease( &cell.sequence, mAsyncDequeuePos + mAsyncCapacityMask + 1u );
+                ++mAsyncDequeuePos;
+                ++numWritten;
+            }
+        }
+
+        const uint32 numDropped = atomicLoadAcquire( &mAsyncNumDropped );
+        if( numDropped != mAsyncNumDroppedReported )
+        {
+            time_t ctTime; time(&ctTime);
+            writeMessage( "Log: " + StringConverter::toString( numDropped - mAsyncNumDroppedReported ) +
+                          " messages were dropped because the async queue was full",
+                          LML_CRITICAL, false, ctTime, false );
+            mAsyncNumDroppedReported = numDropped;
+            ++numWritten;
+        }
+
+        if( numWritten )
+        {
+            if( mDebugOut )
+                std::cout.flush();
+            if( !mSuppressFile )
+                mLog.flush();
+        }
+
+        return numWritten;
+    }
+    //-----------------------------------------------------------------------
+    unsigned long Log::_asyncWriterThread(void)
+    {
+        while( !atomicLoadAcquire( &mAsyncStopWriter ) )
+        {
+            mAsyncWriterMutex.lock();
+            const size_t numWritten = drainAsyncQueue();
+            mAsyncWriterMutex.unlock();
+
+            //A couple of ms of latency is fine for a log; don't spin.
+            if( !numWritten )
+                Threads::Sleep( 1u );
+        }
+
+        return 0;
+    }
+    //-----------------------------------------------------------------------
+    void Log::setAsyncEnabled( bool asyncEnabled, size_t queueCapacity )
+    {
+        if( asyncEnabled == (mAsyncCells != 0) )
+            return;
+
+        if( asyncEnabled )
+        {
+            OGRE_LOCK_AUTO_MUTEX;
+
+            const uint32 capacity = Bitwise::firstPO2From(
+                        static_cast<uint32>( std::max<size_t>( queueCapacity, 2u ) ) );
+
+            AsyncCell *cells = OGRE_NEW_ARRAY_T( AsyncCell, capacity, MEMCATEGORY_GENERAL );
+            for( uint32 i=0; i<capacity; ++i )
+                cells[i].sequence = i;
+
+            mAsyncCapacityMask          = capacity - 1u;
+            mAsyncEnqueuePos            = 0;
+            mAsyncDequeuePos            = 0;
+            mAsyncNumDropped            = 0;
+            mAsyncNumDroppedReported    = 0;
+            mAsyncStopWriter            = 0;
+            mAsyncCells                 = cells;
+
+            mAsyncWriterThread = Threads::CreateThread( THREAD_GET( asyncLogWriterThread ), 0, this );
+        }
+        else
+        {
+            atomicStoreRelease( &mAsyncStopWriter, 1u );
+            Threads::WaitForThreads( 1u, &mAsyncWriterThread );
+            mAsyncWriterThread.setNull();
+
+            OGRE_LOCK_AUTO_MUTEX;
+            mAsyncWriterMutex.lock();
+            drainAsyncQueue();
+            mAsyncWriterMutex.unlock();
+
+            AsyncCell *cells = mAsyncCells;
+            mAsyncCells = 0;
+            OGRE_DELETE_ARRAY_T( cells, AsyncCell, mAsyncCapacityMask + 1u, MEMCATEGORY_GENERAL );
+            mAsyncCapacityMask = 0;
+        }
+    }
+    //-----------------------------------------------------------------------
+    void Log::flush(void)
+    {
+        if( mAsyncCells )
+        {
+            mAsyncWriterMutex.lock();
+            drainAsyncQueue();
+            mAsyncWriterMutex.unlock();
+        }
+        else
+        {
+            OGRE_LOCK_AUTO_MUTEX;
+            if( !mSuppressFile )
+                mLog.flush();
+        }
+    }
+    //-----------------------------------------------------------------------
+    uint32 Log::getNumDroppedMessages(void) const
+    {
+        return atomicLoadAcquire( &mAsyncNumDropped );
+    }
     //-----------------------------------------------------------------------
     void Log::setTimeStampEnabled(bool timeStamp)
     {
@@ -148,14 +410,22 @@ namespace Ogre
     void Log::addListener(LogListener* listener)
     {
         OGRE_LOCK_AUTO_MUTEX;
+        if( mAsyncCells )
+            mAsyncWriterMutex.lock();
         mListeners.push_back(listener);
+        if( mAsyncCells )
+            mAsyncWriterMutex.unlock();
     }
 
     //-----------------------------------------------------------------------
     void Log::removeListener(LogListener* listener)
     {
         OGRE_LOCK_AUTO_MUTEX;
+        if( mAsyncCells )
+            mAsyncWriterMutex.lock();
         mListeners.erase(std::find(mListeners.begin(), mListeners.end(), listener));
+        if( mAsyncCells )
+            mAsyncWriterMutex.unlock();
     }
     //---------------------------------------------------------------------
     Log::Stream Log::stream(LogMessageLevel lml, bool maskDebug) 
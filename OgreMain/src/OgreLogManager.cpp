@@ -147,6 +147,19 @@ namespace Ogre {
             mDefaultLog->setLogDetail(ll);
         }
     }
+    //-----------------------------------------------------------------------
+    void LogManager::flush(void)
+    {
+        OGRE_LOCK_AUTO_MUTEX;
+        LogList::const_iterator itor = mLogs.begin();
+        LogList::const_iterator end  = mLogs.end();
+
+        while( itor != end )
+        {
+            itor->second->flush();
+            ++itor;
+        }
+    }
     //---------------------------------------------------------------------
     Log::Stream LogManager::stream(LogMessageLevel lml, bool maskDebug)
     {
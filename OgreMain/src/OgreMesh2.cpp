@@ -29,6 +29,7 @@ THE SOFTWARE.
 #include "OgreMesh2.h"
 
 #include "OgreSubMesh2.h"
+#include "OgreSubMesh.h"
 #include "OgreLogManager.h"
 #include "OgreMesh2Serializer.h"
 #include "OgreMeshManager2.h"
@@ -47,6 +48,7 @@ THE SOFTWARE.
 
 #include "Vao/OgreIndexBufferPacked.h"
 #include "Vao/OgreVertexArrayObject.h"
+#include "Vao/OgreAsyncTicket.h"
 
 #include "OgreOldSkeletonManager.h"
 
@@ -57,6 +59,7 @@ namespace Ogre {
     Mesh::Mesh( ResourceManager* creator, const String& name, ResourceHandle handle,
                 const String& group, VaoManager *vaoManager, bool isManual, ManualResourceLoader* loader )
         : Resource(creator, name, handle, group, isManual, loader),
+        mPreparedData( 0 ),
         mBoundRadius( 0.0f ),
         mLodStrategyName( LodStrategyManager::getSingleton().getDefaultStrategy()->getName() ),
         mNumLods( 1 ),
@@ -74,6 +77,9 @@ namespace Ogre {
         // have to call this here reather than in Resource destructor
         // since calling virtual methods in base destructors causes crash
         unload();
+
+        OGRE_DELETE mPreparedData;
+        mPreparedData = 0;
     }
     //-----------------------------------------------------------------------
     SubMesh* Mesh::createSubMesh( size_t index )
@@ -150,36 +156,77 @@ namespace Ogre {
         if (getCreator()->getVerbose())
             LogManager::getSingleton().logMessage("Mesh: Loading "+mName+".");
 
-        mFreshFromDisk =
+        DataStreamPtr data =
             ResourceGroupManager::getSingleton().openResource(
                 mName, mGroup, true, this);
  
         // fully prebuffer into host RAM
-        mFreshFromDisk = DataStreamPtr(OGRE_NEW MemoryDataStream(mName,mFreshFromDisk));
+        data = DataStreamPtr(OGRE_NEW MemoryDataStream(mName,data));
+
+        mPreparedData = OGRE_NEW PreparedMeshData();
+
+        try
+        {
+            MeshSerializer serializer( mVaoManager );
+            serializer.prepareMesh( data, this, mPreparedData );
+
+            MeshManager *meshManager = static_cast<MeshManager*>( mCreator );
+            if( meshManager->getArrangeEfficientOnPrepare() )
+            {
+                mPreparedData->arrangeEfficient( meshManager->getArrangeEfficientHalfPos(),
+                                                 meshManager->getArrangeEfficientHalfTexCoords(),
+                                                 meshManager->getArrangeEfficientQTangents() );
+            }
+        }
+        catch( Exception &e )
+        {
+            OGRE_DELETE mPreparedData;
+            mPreparedData = 0;
+            unloadImpl();
+            throw e;
+        }
     }
     //-----------------------------------------------------------------------
     void Mesh::unprepareImpl()
     {
-        mFreshFromDisk.setNull();
+        if( mPreparedData )
+        {
+            OGRE_DELETE mPreparedData;
+            mPreparedData = 0;
+
+            //prepareImpl already created the submeshes.
+            unloadImpl();
+        }
     }
     //-----------------------------------------------------------------------
     void Mesh::loadImpl()
     {
-        MeshSerializer serializer( mVaoManager );
-        //serializer.setListener(MeshManager::getSingleton().getListener());
-
-        // If the only copy is local on the stack, it will be cleaned
-        // up reliably in case of exceptions, etc
-        DataStreamPtr data(mFreshFromDisk);
-        mFreshFromDisk.setNull();
-
-        if (data.isNull()) {
+        if( !mPreparedData )
+        {
             OGRE_EXCEPT(Exception::ERR_INVALID_STATE,
                         "Data doesn't appear to have been prepared in " + mName,
                         "Mesh::loadImpl()");
         }
 
-        serializer.importMesh(data, this);
+        MeshSerializer serializer( mVaoManager );
+        //serializer.setListener(MeshManager::getSingleton().getListener());
+
+        //Whatever happens, the system memory copy is no longer needed.
+        try
+        {
+            serializer.finaliseMesh( this, mPreparedData );
+        }
+        catch( Exception &e )
+        {
+            OGRE_DELETE mPreparedData;
+            mPreparedData = 0;
+            //Resource::load leaves us UNLOADED. Don't keep half-built submeshes around.
+            unloadImpl();
+            throw e;
+        }
+
+        OGRE_DELETE mPreparedData;
+        mPreparedData = 0;
     }
     //-----------------------------------------------------------------------
     void Mesh::unloadImpl()
@@ -491,7 +538,8 @@ namespace Ogre {
         return retVal;
     }
     //---------------------------------------------------------------------
-    void Mesh::importV1( v1::Mesh *mesh, bool halfPos, bool halfTexCoords, bool qTangents )
+    void Mesh::importV1( v1::Mesh *mesh, bool halfPos, bool halfTexCoords, bool qTangents,
+                         SceneManager *sceneManager )
     {
         mesh->load();
 
@@ -530,10 +578,60 @@ namespace Ogre {
         {
         }
 
-        for( size_t i=0; i<mesh->getNumSubMeshes(); ++i )
+        const size_t numSubMeshes = mesh->getNumSubMeshes();
+        SubMesh::ArrangeEfficientJobVec convertedJobs;
+
+        if( sceneManager && numSubMeshes > 1u )
+        {
+            //Convert the vertex data of all SubMeshes in parallel; one pass at a time
+            //as the shadow mapping buffers may reference the same v1 buffers.
+            convertedJobs.resize( numSubMeshes * NumVertexPass );
+
+            for( size_t vaoPassIdx=0; vaoPassIdx<NumVertexPass; ++vaoPassIdx )
+            {
+                SubMesh::ArrangeEfficientJobPtrArray jobs;
+                FastArray<v1::SubMesh*> lockedSubMeshes;
+                jobs.reserve( numSubMeshes );
+                lockedSubMeshes.reserve( numSubMeshes );
+
+                for( size_t i=0; i<numSubMeshes; ++i )
+                {
+                    v1::SubMesh *v1SubMesh = mesh->getSubMesh( i );
+                    if( vaoPassIdx == VpNormal ||
+                        v1SubMesh->vertexData[VpNormal] != v1SubMesh->vertexData[VpShadow] ||
+                        v1SubMesh->indexData[VpNormal] != v1SubMesh->indexData[VpShadow] )
+                    {
+                        SubMesh::ArrangeEfficientJob *job = &convertedJobs[i * NumVertexPass +
+                                                                           vaoPassIdx];
+                        SubMesh::_prepareArrangeEfficient( v1SubMesh, halfPos, halfTexCoords,
+                                                           qTangents, vaoPassIdx, job );
+                        jobs.push_back( job );
+                        lockedSubMeshes.push_back( v1SubMesh );
+                    }
+                }
+
+                SubMesh::_arrangeEfficient( jobs, sceneManager );
+
+                for( size_t i=0; i<lockedSubMeshes.size(); ++i )
+                    SubMesh::_unlockSourceBuffers( lockedSubMeshes[i], vaoPassIdx );
+            }
+        }
+
+        try
         {
-            SubMesh *subMesh = createSubMesh();
-            subMesh->importFromV1( mesh->getSubMesh( i ), halfPos, halfTexCoords, qTangents );
+            for( size_t i=0; i<numSubMeshes; ++i )
+            {
+                SubMesh *subMesh = createSubMesh();
+                subMesh->importFromV1( mesh->getSubMesh( i ), halfPos, halfTexCoords, qTangents,
+                                       convertedJobs.empty() ? 0 : &convertedJobs[i * NumVertexPass] );
+            }
+        }
+        catch( Exception & )
+        {
+            //importFromV1 takes ownership of the converted data. Free what's left.
+            for( size_t i=0; i<convertedJobs.size(); ++i )
+                OGRE_FREE_SIMD( convertedJobs[i].data, MEMCATEGORY_GEOMETRY );
+            throw;
         }
 
         mSubMeshNameMap = mesh->getSubMeshNameMap();
@@ -557,15 +655,38 @@ namespace Ogre {
         setToLoaded();
     }
     //---------------------------------------------------------------------
-    void Mesh::arrangeEfficient( bool halfPos, bool halfTexCoords, bool qTangents )
+    void Mesh::arrangeEfficient( bool halfPos, bool halfTexCoords, bool qTangents,
+                                 SceneManager *sceneManager )
     {
-        SubMeshVec::const_iterator itor = mSubMeshes.begin();
-        SubMeshVec::const_iterator end  = mSubMeshes.end();
+        if( !sceneManager || mSubMeshes.size() <= 1u )
+        {
+            SubMeshVec::const_iterator itor = mSubMeshes.begin();
+            SubMeshVec::const_iterator end  = mSubMeshes.end();
 
-        while( itor != end )
+            while( itor != end )
+            {
+                (*itor)->arrangeEfficient( halfPos, halfTexCoords, qTangents );
+                ++itor;
+            }
+        }
+        else
         {
-            (*itor)->arrangeEfficient( halfPos, halfTexCoords, qTangents );
-            ++itor;
+            //Map everything first, convert all the SubMeshes in parallel,
+            //then create the new buffers.
+            vector<SubMesh::ArrangeEfficientJobVec>::type jobs( mSubMeshes.size() );
+            SubMesh::ArrangeEfficientJobPtrArray jobPtrs;
+
+            for( size_t i=0; i<mSubMeshes.size(); ++i )
+            {
+                mSubMeshes[i]->_prepareArrangeEfficient( halfPos, halfTexCoords, qTangents, jobs[i] );
+                for( size_t j=0; j<jobs[i].size(); ++j )
+                    jobPtrs.push_back( &jobs[i][j] );
+            }
+
+            SubMesh::_arrangeEfficient( jobPtrs, sceneManager );
+
+            for( size_t i=0; i<mSubMeshes.size(); ++i )
+                mSubMeshes[i]->_finishArrangeEfficient( jobs[i] );
         }
     }
     //---------------------------------------------------------------------
@@ -37,7 +37,7 @@ namespace Ogre {
     const unsigned short HEADER_CHUNK_ID = 0x1000;
     //---------------------------------------------------------------------
     MeshSerializer::MeshSerializer( VaoManager *vaoManager )
-        :mListener(0)
+        :mListener(0), mCompressBuffers(false)
     {
         // Init implementations
         // String identifiers have not always been 100% unified with OGRE version
@@ -45,9 +45,13 @@ namespace Ogre {
         // Note MUST be added in reverse order so latest is first in the list
 
         mVersionData.push_back(OGRE_NEW MeshVersionData(
-            MESH_VERSION_2_1, "[MeshSerializer_v2.1 R2]",
+            MESH_VERSION_2_1_R3, "[MeshSerializer_v2.1 R3]",
             OGRE_NEW MeshSerializerImpl( vaoManager )));
 
+        mVersionData.push_back(OGRE_NEW MeshVersionData(
+            MESH_VERSION_2_1, "[MeshSerializer_v2.1 R2]",
+            OGRE_NEW MeshSerializerImpl_v2_1_R2( vaoManager )));
+
         //These formats will be removed on release
         mVersionData.push_back(OGRE_NEW MeshVersionData(
             MESH_VERSION_LEGACY, "[MeshSerializer_v2.1 R1]",
@@ -110,8 +114,14 @@ namespace Ogre {
                                     MeshVersion version, Endian endianMode)
     {
         MeshSerializerImpl* impl = 0;
-        if (version == MESH_VERSION_LATEST)
+        if (version == MESH_VERSION_LATEST && mCompressBuffers)
             impl = mVersionData[0]->impl;
+        else if (version == MESH_VERSION_LATEST)
+        {
+            //R3 only adds compression. Keep writing R2 when it isn't
+            //used so the files still open with older builds.
+            impl = mVersionData[1]->impl;
+        }
         else 
         {
             for (MeshVersionDataList::iterator i = mVersionData.begin(); 
@@ -132,10 +142,18 @@ namespace Ogre {
         }
 
                     
-        impl->exportMesh(pMesh, stream, endianMode);
+        impl->exportMesh(pMesh, stream, endianMode, mCompressBuffers);
     }
     //---------------------------------------------------------------------
     void MeshSerializer::importMesh(DataStreamPtr& stream, Mesh* pDest)
+    {
+        PreparedMeshData preparedData;
+        prepareMesh( stream, pDest, &preparedData );
+        finaliseMesh( pDest, &preparedData );
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializer::prepareMesh( DataStreamPtr &stream, Mesh *pDest,
+                                      PreparedMeshData *outData )
     {
         determineEndianness(stream);
 
@@ -148,7 +166,7 @@ namespace Ogre {
         if (headerID != HEADER_CHUNK_ID)
         {
             OGRE_EXCEPT(Exception::ERR_INTERNAL_ERROR, "File header not found",
-                "MeshSerializer::importMesh");
+                "MeshSerializer::prepareMesh");
         }
         // Read version
         String ver = readString(stream);
@@ -168,22 +186,33 @@ namespace Ogre {
         }           
         if (!impl)
             OGRE_EXCEPT(Exception::ERR_INTERNAL_ERROR, "Cannot find serializer implementation for "
-                        "mesh version " + ver, "MeshSerializer::importMesh");
+                        "mesh version " + ver, "MeshSerializer::prepareMesh");
         
         // Call implementation
-        impl->importMesh(stream, pDest, mListener);
-        // Warn on old version of mesh
-        if (ver != mVersionData[0]->versionString)
+        impl->prepareMesh(stream, pDest, mListener, outData);
+        // Warn on old version of mesh. R2 is still current, it just can't be compressed.
+        if (ver != mVersionData[0]->versionString && ver != mVersionData[1]->versionString)
         {
             LogManager::getSingleton().logMessage("WARNING: " + pDest->getName() + 
                 " is an older format (" + ver + "); you should upgrade it as soon as possible" +
                 " using the OgreMeshTool tool.", LML_CRITICAL);
         }
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializer::finaliseMesh( Mesh *pDest, PreparedMeshData *data )
+    {
+        //Creating the Vaos is the same for all versions.
+        mVersionData[0]->impl->finaliseMesh( pDest, data );
 
         if(mListener)
             mListener->processMeshCompleted(pDest);
     }
     //---------------------------------------------------------------------
+    void MeshSerializer::setCompressBuffers( bool compressBuffers )
+    {
+        mCompressBuffers = compressBuffers;
+    }
+    //---------------------------------------------------------------------
     void MeshSerializer::setListener( MeshSerializerListener *listener )
     {
         mListener = listener;
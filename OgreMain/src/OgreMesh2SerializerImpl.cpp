@@ -41,6 +41,7 @@ THE SOFTWARE.
 #include "OgreLodStrategyManager.h"
 #include "OgreDistanceLodStrategy.h"
 #include "OgreBitwise.h"
+#include "OgreMeshBufferCodec.h"
 
 #include "Vao/OgreVaoManager.h"
 #include "Vao/OgreMultiSourceVertexBufferPool.h"
@@ -59,10 +60,13 @@ namespace Ogre {
     const long MSTREAM_OVERHEAD_SIZE = sizeof(uint16) + sizeof(uint32);
     //---------------------------------------------------------------------
     MeshSerializerImpl::MeshSerializerImpl( VaoManager *vaoManager ) :
+        mPreparedData( 0 ),
+        mSupportsCompression( true ),
+        mCompressBuffers( false ),
         mVaoManager( vaoManager )
     {
         // Version number
-        mVersion = "[MeshSerializer_v2.1 R2]";
+        mVersion = "[MeshSerializer_v2.1 R3]";
     }
     //---------------------------------------------------------------------
     MeshSerializerImpl::~MeshSerializerImpl()
@@ -70,7 +74,7 @@ namespace Ogre {
     }
     //---------------------------------------------------------------------
     void MeshSerializerImpl::exportMesh(const Mesh* pMesh, 
-        DataStreamPtr stream, Endian endianMode)
+        DataStreamPtr stream, Endian endianMode, bool compressBuffers)
     {
         LogManager::getSingleton().logMessage("MeshSerializer writing mesh data to stream " + stream->getName() + "...");
 
@@ -104,6 +108,9 @@ namespace Ogre {
             }
         }
 
+        mCompressBuffers = compressBuffers && mSupportsCompression;
+        mEncodedBuffers.clear();
+
         writeFileHeader();
         LogManager::getSingleton().logMessage("File header written.");
 
@@ -114,32 +121,104 @@ namespace Ogre {
         popInnerChunk(mStream);
         LogManager::getSingleton().logMessage("Mesh data exported.");
 
+        mEncodedBuffers.clear();
+        mCompressBuffers = false;
+
         LogManager::getSingleton().logMessage("MeshSerializer export successful.");
     }
     //---------------------------------------------------------------------
     void MeshSerializerImpl::importMesh(DataStreamPtr& stream, Mesh* pMesh, MeshSerializerListener *listener)
     {
-        // Determine endianness (must be the first thing we do!)
-        determineEndianness(stream);
+        PreparedMeshData preparedData;
+        prepareMesh( stream, pMesh, listener, &preparedData );
+        finaliseMesh( pMesh, &preparedData );
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::prepareMesh( DataStreamPtr &stream, Mesh *pMesh,
+                                          MeshSerializerListener *listener,
+                                          PreparedMeshData *outData )
+    {
+        mPreparedData = outData;
+
+        try
+        {
+            // Determine endianness (must be the first thing we do!)
+            determineEndianness(stream);
 
 #if OGRE_SERIALIZER_VALIDATE_CHUNKSIZE
-        enableValidation();
+            enableValidation();
 #endif
-        // Check header
-        readFileHeader(stream);
-        pushInnerChunk(stream);
-        uint16 streamID;
-        while(!stream->eof())
+            // Check header
+            readFileHeader(stream);
+            pushInnerChunk(stream);
+            uint16 streamID;
+            while(!stream->eof())
+            {
+                streamID = readChunk(stream);
+                switch (streamID)
+                {
+                case M_MESH:
+                    readMesh(stream, pMesh, listener);
+                    break;
+                }
+            }
+            popInnerChunk(stream);
+        }
+        catch( Exception &e )
         {
-            streamID = readChunk(stream);
-            switch (streamID)
+            mPreparedData = 0;
+            throw e;
+        }
+
+        mPreparedData = 0;
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::finaliseMesh( Mesh *pMesh, PreparedMeshData *data )
+    {
+        PreparedMeshData::PreparedSubMeshVec::iterator itor = data->subMeshes.begin();
+        PreparedMeshData::PreparedSubMeshVec::iterator end  = data->subMeshes.end();
+
+        while( itor != end )
+        {
+            SubMesh *sm = itor->subMesh;
+
+            for( uint8 i=0; i<itor->numVaoPasses; ++i )
             {
-            case M_MESH:
-                readMesh(stream, pMesh, listener);
-                break;
+                createSubMeshVao( sm, itor->lods[i], i );
+                PreparedMeshData::freeLods( itor->lods[i] );
+            }
+
+            //Populate mBoneAssignments and mBlendIndexToBoneIndexMap;
+            size_t indexSource = 0;
+            size_t unusedVar = 0;
+
+            const VertexElement2 *indexElement = 0;
+            if( itor->buildBoneAssignments )
+            {
+                indexElement = sm->mVao[VpNormal][0]->findBySemantic( VES_BLEND_INDICES,
+                                                                      indexSource, unusedVar );
+            }
+            if( indexElement )
+            {
+                //createSubMeshVao already freed our copy unless the buffer is shadowed.
+                const uint8 *vertexData = static_cast<const uint8*>(
+                            sm->mVao[VpNormal][0]->getVertexBuffers()[indexSource]->getShadowCopy() );
+                if( vertexData )
+                    sm->_buildBoneAssignmentsFromVertexData( vertexData );
+                else
+                    sm->_buildBoneAssignmentsFromVertexData();
             }
+
+            ++itor;
+        }
+
+        data->subMeshes.clear();
+
+        if( data->hasSkeletonLink )
+        {
+            pMesh->setSkeletonName( data->skeletonName );
+            data->hasSkeletonLink = false;
         }
-        popInnerChunk(stream);
 
         if( !pMesh->hasValidShadowMappingVaos() )
             pMesh->prepareForShadowMapping( false );
@@ -291,7 +370,19 @@ namespace Ogre {
         pushInnerChunk(mStream);
         writeChunkHeader( M_SUBMESH_LOD, calcSubMeshLodSize( vao, skipVertexBuffer ) );
 
-        writeIndexes( vao->getIndexBuffer() );
+        IndexBufferPacked *indexBuffer = vao->getIndexBuffer();
+        const EncodedBuffer *encodedIndices = indexBuffer ? getEncodedIndexBuffer( indexBuffer ) : 0;
+
+        if( !encodedIndices )
+        {
+            writeIndexes( indexBuffer );
+        }
+        else
+        {
+            //The inline section says there are no indices; they're in the compressed chunk.
+            writeIndexes( 0 );
+            writeCompressedIndexes( indexBuffer, *encodedIndices );
+        }
 
         if( !skipVertexBuffer )
         {
@@ -376,6 +467,27 @@ namespace Ogre {
         }
     }
     //---------------------------------------------------------------------
+    void MeshSerializerImpl::writeCompressedIndexes( IndexBufferPacked *indexBuffer,
+                                                     const EncodedBuffer &encodedData )
+    {
+        pushInnerChunk(mStream);
+        writeChunkHeader( M_SUBMESH_INDEX_BUFFER_COMPRESSED,
+                          MSTREAM_OVERHEAD_SIZE + sizeof(uint32) * 2u + sizeof(bool) +
+                          encodedData.size() );
+
+        uint32 indexCount = static_cast<uint32>( indexBuffer->getNumElements() );
+        writeInts( &indexCount, 1 );
+
+        bool idx32bit = indexBuffer->getIndexType() == IndexBufferPacked::IT_32BIT;
+        writeBools( &idx32bit, 1 );
+
+        uint32 encodedBytes = static_cast<uint32>( encodedData.size() );
+        writeInts( &encodedBytes, 1 );
+        writeData( &encodedData[0], 1, encodedData.size() );
+
+        popInnerChunk(mStream);
+    }
+    //---------------------------------------------------------------------
     void MeshSerializerImpl::writeGeometry( const VertexBufferPackedVec &vertexData )
     {
         // Header
@@ -429,6 +541,31 @@ namespace Ogre {
 
             for( uint8 i=0; i<numSources; ++i )
             {
+                const EncodedBuffer *encodedData = getEncodedVertexBuffer( vertexData[i] );
+
+                if( encodedData )
+                {
+                    size_t size = MSTREAM_OVERHEAD_SIZE + (sizeof(uint8)* 2) + sizeof(uint32) +
+                                    encodedData->size();
+
+                    pushInnerChunk(mStream);
+                    writeChunkHeader(M_SUBMESH_M_GEOMETRY_VERTEX_BUFFER_COMPRESSED, size);
+
+                    //Source
+                    writeData( &i, 1, 1 );
+
+                    uint8 bytesPerVertex = vertexData[i]->getBytesPerElement();
+                    writeData( &bytesPerVertex, 1, 1 );
+
+                    //Already flipped to the output endianness before encoding.
+                    uint32 encodedBytes = static_cast<uint32>( encodedData->size() );
+                    writeInts( &encodedBytes, 1 );
+                    writeData( &(*encodedData)[0], 1, encodedData->size() );
+
+                    popInnerChunk(mStream);
+                    continue;
+                }
+
                 size_t size = MSTREAM_OVERHEAD_SIZE + (sizeof(uint8)* 2) +
                                 vertexData[i]->getTotalSizeBytes();
 
@@ -571,12 +708,25 @@ namespace Ogre {
 
         // uint32 indexCount
         size += sizeof(uint32);
-        // bool indexes32bit
-        size += sizeof(bool);
 
-        const IndexBufferPacked *indexBuffer = vao->getIndexBuffer();
-        if( indexBuffer )
-            size += indexBuffer->getTotalSizeBytes();
+        IndexBufferPacked *indexBuffer = vao->getIndexBuffer();
+        const EncodedBuffer *encodedIndices = indexBuffer ? getEncodedIndexBuffer( indexBuffer ) : 0;
+
+        if( encodedIndices )
+        {
+            // M_SUBMESH_INDEX_BUFFER_COMPRESSED
+            // uint32 indexCount, bool indexes32bit, uint32 encodedBytes
+            size += MSTREAM_OVERHEAD_SIZE + sizeof(uint32) * 2u + sizeof(bool);
+            size += encodedIndices->size();
+        }
+        else
+        {
+            // bool indexes32bit
+            size += sizeof(bool);
+
+            if( indexBuffer )
+                size += indexBuffer->getTotalSizeBytes();
+        }
 
         if( !skipVertexBuffer )
         {
@@ -620,7 +770,16 @@ namespace Ogre {
 
             while( itor != end )
             {
-                size += (*itor)->getTotalSizeBytes();
+                const EncodedBuffer *encodedData = getEncodedVertexBuffer( *itor );
+                if( encodedData )
+                {
+                    // uint32 encodedBytes
+                    size += sizeof(uint32) + encodedData->size();
+                }
+                else
+                {
+                    size += (*itor)->getTotalSizeBytes();
+                }
                 ++itor;
             }
         }
@@ -628,6 +787,91 @@ namespace Ogre {
         return size;
     }
     //---------------------------------------------------------------------
+    const MeshSerializerImpl::EncodedBuffer* MeshSerializerImpl::getEncodedIndexBuffer(
+            IndexBufferPacked *indexBuffer )
+    {
+        if( !mCompressBuffers || !indexBuffer->getNumElements() )
+            return 0;
+
+        EncodedBufferMap::iterator itor = mEncodedBuffers.find( indexBuffer );
+
+        if( itor == mEncodedBuffers.end() )
+        {
+            itor = mEncodedBuffers.insert( std::make_pair( indexBuffer, EncodedBuffer() ) ).first;
+            EncodedBuffer &encodedData = itor->second;
+
+            const size_t numIndices = indexBuffer->getNumElements();
+            const bool idx32bit = indexBuffer->getIndexType() == IndexBufferPacked::IT_32BIT;
+
+            encodedData.resize( MeshBufferCodec::getIndexBufferBound( numIndices ) );
+
+            AsyncTicketPtr asyncTicket = indexBuffer->readRequest( 0, numIndices );
+            const size_t encodedBytes = MeshBufferCodec::encodeIndexBuffer(
+                                            &encodedData[0], encodedData.size(),
+                                            asyncTicket->map(), numIndices, idx32bit );
+            asyncTicket->unmap();
+
+            //Not worth it if it doesn't get smaller. Write it raw.
+            if( encodedBytes == 0 || encodedBytes >= indexBuffer->getTotalSizeBytes() )
+                encodedData.clear();
+            else
+                encodedData.resize( encodedBytes );
+        }
+
+        return itor->second.empty() ? 0 : &itor->second;
+    }
+    //---------------------------------------------------------------------
+    const MeshSerializerImpl::EncodedBuffer* MeshSerializerImpl::getEncodedVertexBuffer(
+            VertexBufferPacked *vertexBuffer )
+    {
+        if( !mCompressBuffers || !vertexBuffer->getNumElements() )
+            return 0;
+
+        EncodedBufferMap::iterator itor = mEncodedBuffers.find( vertexBuffer );
+
+        if( itor == mEncodedBuffers.end() )
+        {
+            itor = mEncodedBuffers.insert( std::make_pair( vertexBuffer, EncodedBuffer() ) ).first;
+            EncodedBuffer &encodedData = itor->second;
+
+            const size_t numVertices = vertexBuffer->getNumElements();
+            const size_t bytesPerVertex = vertexBuffer->getBytesPerElement();
+
+            encodedData.resize( MeshBufferCodec::getVertexBufferBound( numVertices, bytesPerVertex ) );
+
+            AsyncTicketPtr asyncTicket = vertexBuffer->readRequest( 0, numVertices );
+            const uint8 *srcData = reinterpret_cast<const uint8*>( asyncTicket->map() );
+
+            size_t encodedBytes;
+            if( mFlipEndian )
+            {
+                //The codec works on bytes, flip first so the decoded data is already
+                //in the file's endianness.
+                EncodedBuffer tempData( srcData, srcData + vertexBuffer->getTotalSizeBytes() );
+                flipLittleEndian( &tempData[0], vertexBuffer );
+                encodedBytes = MeshBufferCodec::encodeVertexBuffer( &encodedData[0],
+                                                                    encodedData.size(),
+                                                                    &tempData[0], numVertices,
+                                                                    bytesPerVertex );
+            }
+            else
+            {
+                encodedBytes = MeshBufferCodec::encodeVertexBuffer( &encodedData[0],
+                                                                    encodedData.size(), srcData,
+                                                                    numVertices, bytesPerVertex );
+            }
+
+            asyncTicket->unmap();
+
+            if( encodedBytes == 0 || encodedBytes >= vertexBuffer->getTotalSizeBytes() )
+                encodedData.clear();
+            else
+                encodedData.resize( encodedBytes );
+        }
+
+        return itor->second.empty() ? 0 : &itor->second;
+    }
+    //---------------------------------------------------------------------
     size_t MeshSerializerImpl::calcVertexDeclSize( const VertexBufferPackedVec &vertexData )
     {
         size_t size = MSTREAM_OVERHEAD_SIZE;
@@ -786,74 +1030,38 @@ namespace Ogre {
         uint8 numLodLevels = 0;
         readChar( stream, &numLodLevels );
 
-        SubMeshLodVec totalSubmeshLods;
-        totalSubmeshLods.reserve( numLodLevels * numVaoPasses );
+        readSubMeshLods( stream, pMesh, sm, numLodLevels, numVaoPasses, true );
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::readSubMeshLods( DataStreamPtr &stream, Mesh *pMesh, SubMesh *sm,
+                                              uint8 numLodLevels, uint8 numVaoPasses,
+                                              bool buildBoneAssignments )
+    {
+        //The SubMeshLods are owned by mPreparedData, which frees them if we throw.
+        mPreparedData->subMeshes.push_back( PreparedMeshData::PreparedSubMesh() );
+        PreparedMeshData::PreparedSubMesh &preparedSubMesh = mPreparedData->subMeshes.back();
+        preparedSubMesh.subMesh = sm;
+        preparedSubMesh.numVaoPasses = numVaoPasses;
+        preparedSubMesh.buildBoneAssignments = buildBoneAssignments;
 
         //M_SUBMESH_LOD
         pushInnerChunk(stream);
-        try
+
+        for( uint8 i=0; i<numVaoPasses; ++i )
         {
-            SubMeshLodVec submeshLods;
+            SubMeshLodVec &submeshLods = preparedSubMesh.lods[i];
             submeshLods.reserve( numLodLevels );
 
-            for( uint8 i=0; i<numVaoPasses; ++i )
+            for( uint8 j=0; j<numLodLevels; ++j )
             {
-                for( uint8 j=0; j<numLodLevels; ++j )
-                {
-                    uint16 streamID = readChunk(stream);
-                    assert( streamID == M_SUBMESH_LOD && !stream->eof() );
-
-                    totalSubmeshLods.push_back( SubMeshLod() );
-                    const uint8 currentLod = static_cast<uint8>( submeshLods.size() );
-                    readSubMeshLod( stream, pMesh, &totalSubmeshLods.back(), currentLod );
-
-                    submeshLods.push_back( totalSubmeshLods.back() );
-                }
-
-                createSubMeshVao( sm, submeshLods, i );
-                submeshLods.clear();
-            }
-
-            //Populate mBoneAssignments and mBlendIndexToBoneIndexMap;
-            size_t indexSource = 0;
-            size_t unusedVar = 0;
+                uint16 streamID = readChunk(stream);
+                assert( streamID == M_SUBMESH_LOD && !stream->eof() );
 
-            const VertexElement2 *indexElement =
-                    sm->mVao[VpNormal][0]->findBySemantic( VES_BLEND_INDICES, indexSource, unusedVar );
-            if( indexElement )
-            {
-                const uint8 *vertexData = totalSubmeshLods[0].vertexBuffers[indexSource];
-                sm->_buildBoneAssignmentsFromVertexData( vertexData );
+                const uint8 currentLod = static_cast<uint8>( submeshLods.size() );
+                submeshLods.push_back( SubMeshLod() );
+                readSubMeshLod( stream, pMesh, &submeshLods.back(), currentLod );
             }
         }
-        catch( Exception &e )
-        {
-            SubMeshLodVec::iterator itor = totalSubmeshLods.begin();
-            SubMeshLodVec::iterator end  = totalSubmeshLods.end();
-
-            while( itor != end )
-            {
-                Uint8Vec::iterator it = itor->vertexBuffers.begin();
-                Uint8Vec::iterator en = itor->vertexBuffers.end();
-
-                while( it != en )
-                    OGRE_FREE_SIMD( *it++, MEMCATEGORY_GEOMETRY );
-
-                itor->vertexBuffers.clear();
-
-                if( itor->indexData )
-                {
-                    OGRE_FREE_SIMD( itor->indexData, MEMCATEGORY_GEOMETRY );
-                    itor->indexData = 0;
-                }
-
-                ++itor;
-            }
-
-            //TODO: Delete created mVaos. Don't erase the data from those vaos?
-
-            throw e;
-        }
 
         popInnerChunk(stream);
     }
@@ -881,11 +1089,10 @@ namespace Ogre {
                         subMeshLod.vertexDeclarations[0], subMeshLod.numVertices, sm->mParent->getVertexBufferDefaultType(),
                         subMeshLod.vertexBuffers[0], sm->mParent->isVertexBufferShadowed() );
 
+                    //Either freed or owned by the buffer's shadow copy now
                     if( !sm->mParent->isVertexBufferShadowed() )
-                    {
                         OGRE_FREE_SIMD( submeshLods[i].vertexBuffers[0], MEMCATEGORY_GEOMETRY );
-                        submeshLods[i].vertexBuffers.erase( submeshLods[i].vertexBuffers.begin() );
-                    }
+                    submeshLods[i].vertexBuffers.erase( submeshLods[i].vertexBuffers.begin() );
 
                     vertexBuffers.push_back( vertexBuffer );
                 }
@@ -926,10 +1133,8 @@ namespace Ogre {
                                     subMeshLod.indexData, sm->mParent->isIndexBufferShadowed() );
 
                 if( !sm->mParent->isIndexBufferShadowed() )
-                {
                     OGRE_FREE_SIMD( subMeshLod.indexData, MEMCATEGORY_GEOMETRY );
-                    submeshLods[ i ].indexData = 0;
-                }
+                submeshLods[ i ].indexData = 0;
             }
 
             VertexArrayObject *vao = mVaoManager->createVertexArrayObject( vertexBuffers, indexBuffer,
@@ -952,10 +1157,15 @@ namespace Ogre {
         while( !stream->eof() &&
                (streamID == M_SUBMESH_M_GEOMETRY ||
                 streamID == M_SUBMESH_M_GEOMETRY_EXTERNAL_SOURCE ||
-                streamID == M_SUBMESH_LOD_OPERATION ) )
+                streamID == M_SUBMESH_LOD_OPERATION ||
+                streamID == M_SUBMESH_INDEX_BUFFER_COMPRESSED ) )
         {
             switch( streamID )
             {
+            case M_SUBMESH_INDEX_BUFFER_COMPRESSED:
+                readCompressedIndexes( stream, subLod );
+                break;
+
             case M_SUBMESH_M_GEOMETRY:
                 if( subLod->lodSource != currentLod )
                 {
@@ -1029,6 +1239,39 @@ namespace Ogre {
         }
     }
     //---------------------------------------------------------------------
+    void MeshSerializerImpl::readCompressedIndexes( DataStreamPtr &stream, SubMeshLod *subLod )
+    {
+        if( subLod->indexData )
+        {
+            OGRE_EXCEPT(Exception::ERR_INTERNAL_ERROR,
+                        "Submesh LOD has both inline and compressed indices."
+                        " This mesh is invalid.",
+                        "MeshSerializerImpl::readCompressedIndexes");
+        }
+
+        readInts( stream, &subLod->numIndices, 1 );
+        readBools( stream, &subLod->index32Bit, 1 );
+
+        uint32 encodedBytes;
+        readInts( stream, &encodedBytes, 1 );
+
+        const size_t bytesPerIndex = subLod->index32Bit ? sizeof(uint32) : sizeof(uint16);
+        subLod->indexData = OGRE_MALLOC_SIMD( bytesPerIndex * subLod->numIndices,
+                                              MEMCATEGORY_GEOMETRY );
+
+        mDecodeScratch.resize( std::max<size_t>( encodedBytes, 1u ) );
+        stream->read( &mDecodeScratch[0], encodedBytes );
+
+        if( !MeshBufferCodec::decodeIndexBuffer( subLod->indexData, subLod->numIndices,
+                                                 subLod->index32Bit,
+                                                 &mDecodeScratch[0], encodedBytes ) )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALID_STATE,
+                         "Compressed index buffer is corrupt. This mesh is invalid.",
+                         "MeshSerializerImpl::readCompressedIndexes" );
+        }
+    }
+    //---------------------------------------------------------------------
     void MeshSerializerImpl::readGeometry(DataStreamPtr& stream, SubMeshLod *subLod)
     {
         readInts( stream, &subLod->numVertices, 1 );
@@ -1044,7 +1287,8 @@ namespace Ogre {
         uint16 streamID = readChunk(stream);
         while( !stream->eof() &&
                (streamID == M_SUBMESH_M_GEOMETRY_VERTEX_DECLARATION ||
-                streamID == M_SUBMESH_M_GEOMETRY_VERTEX_BUFFER) )
+                streamID == M_SUBMESH_M_GEOMETRY_VERTEX_BUFFER ||
+                streamID == M_SUBMESH_M_GEOMETRY_VERTEX_BUFFER_COMPRESSED) )
         {
             switch( streamID )
             {
@@ -1054,6 +1298,9 @@ namespace Ogre {
             case M_SUBMESH_M_GEOMETRY_VERTEX_BUFFER:
                 readVertexBuffer( stream, subLod );
                 break;
+            case M_SUBMESH_M_GEOMETRY_VERTEX_BUFFER_COMPRESSED:
+                readCompressedVertexBuffer( stream, subLod );
+                break;
             }
             // Get next stream
             streamID = readChunk(stream);
@@ -1104,13 +1351,64 @@ namespace Ogre {
         uint8 bytesPerVertex;
         readChar( stream, &bytesPerVertex );
 
+        uint8 *vertexData = allocateVertexBuffer( subLod, source, bytesPerVertex );
+
+        stream->read( vertexData, bytesPerVertex * subLod->numVertices );
+
+        // Endian conversion
+        flipLittleEndian( vertexData, subLod->numVertices, bytesPerVertex,
+                          subLod->vertexDeclarations[source] );
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::readCompressedVertexBuffer( DataStreamPtr &stream, SubMeshLod *subLod )
+    {
+        //Source
+        uint8 source;
+        readChar( stream, &source );
+
+        // Per-vertex size, must agree with declaration at this source
+        uint8 bytesPerVertex;
+        readChar( stream, &bytesPerVertex );
+
+        uint8 *vertexData = allocateVertexBuffer( subLod, source, bytesPerVertex );
+
+        uint32 encodedBytes;
+        readInts( stream, &encodedBytes, 1 );
+
+        mDecodeScratch.resize( std::max<size_t>( encodedBytes, 1u ) );
+        stream->read( &mDecodeScratch[0], encodedBytes );
+
+        if( !MeshBufferCodec::decodeVertexBuffer( vertexData, subLod->numVertices, bytesPerVertex,
+                                                  &mDecodeScratch[0], encodedBytes ) )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALID_STATE,
+                         "Compressed vertex buffer is corrupt. This mesh is invalid.",
+                         "MeshSerializerImpl::readCompressedVertexBuffer" );
+        }
+
+        // Endian conversion
+        flipLittleEndian( vertexData, subLod->numVertices, bytesPerVertex,
+                          subLod->vertexDeclarations[source] );
+    }
+    //---------------------------------------------------------------------
+    uint8* MeshSerializerImpl::allocateVertexBuffer( SubMeshLod *subLod, uint8 source,
+                                                     uint8 bytesPerVertex )
+    {
+        if( source >= subLod->vertexDeclarations.size() )
+        {
+            OGRE_EXCEPT(Exception::ERR_INTERNAL_ERROR,
+                        "Vertex buffer stream is assigned to a source out of range."
+                        " This mesh is invalid.",
+                        "MeshSerializerImpl::allocateVertexBuffer");
+        }
+
         const VertexElement2Vec &vertexElements = subLod->vertexDeclarations[source];
 
         if( bytesPerVertex != VaoManager::calculateVertexSize( vertexElements ) )
         {
             OGRE_EXCEPT(Exception::ERR_INTERNAL_ERROR,
                         "Buffer vertex size does not agree with vertex declaration",
-                        "MeshSerializerImpl::readVertexBuffer");
+                        "MeshSerializerImpl::allocateVertexBuffer");
         }
 
         if( subLod->vertexBuffers[source] )
@@ -1118,7 +1416,7 @@ namespace Ogre {
             OGRE_EXCEPT(Exception::ERR_INTERNAL_ERROR,
                         "Two vertex buffer streams are assigned to the same source."
                         " This mesh is invalid.",
-                        "MeshSerializerImpl::readVertexBuffer");
+                        "MeshSerializerImpl::allocateVertexBuffer");
         }
 
         uint8 *vertexData = reinterpret_cast<uint8*>( OGRE_MALLOC_SIMD(
@@ -1126,11 +1424,7 @@ namespace Ogre {
                                 MEMCATEGORY_GEOMETRY ) );
         subLod->vertexBuffers[source] = vertexData;
 
-        stream->read( vertexData, bytesPerVertex * subLod->numVertices );
-
-        // Endian conversion
-        flipLittleEndian( vertexData, subLod->numVertices, bytesPerVertex,
-                          vertexElements );
+        return vertexData;
     }
     //---------------------------------------------------------------------
     void MeshSerializerImpl::readSubMeshLodOperation( DataStreamPtr& stream,
@@ -1157,7 +1451,9 @@ namespace Ogre {
         if(listener)
             listener->processSkeletonName(pMesh, &skelName);
 
-        pMesh->setSkeletonName(skelName);
+        //Loading the skeleton isn't thread safe; finaliseMesh links it.
+        mPreparedData->hasSkeletonLink = true;
+        mPreparedData->skeletonName = skelName;
     }
     //---------------------------------------------------------------------
     void MeshSerializerImpl::readTextureLayer(DataStreamPtr& stream, Mesh* pMesh,
@@ -2180,7 +2476,7 @@ namespace Ogre {
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    MeshSerializerImpl::SubMeshLod::SubMeshLod() :
+    PreparedMeshData::SubMeshLod::SubMeshLod() :
         numVertices( 0 ),
         lodSource( 0 ),
         index32Bit( false ),
@@ -2188,13 +2484,125 @@ namespace Ogre {
         indexData( 0 )
     {
     }
+    //---------------------------------------------------------------------
+    PreparedMeshData::PreparedMeshData() :
+        hasSkeletonLink( false )
+    {
+    }
+    //---------------------------------------------------------------------
+    PreparedMeshData::~PreparedMeshData()
+    {
+        PreparedSubMeshVec::iterator itor = subMeshes.begin();
+        PreparedSubMeshVec::iterator end  = subMeshes.end();
+
+        while( itor != end )
+        {
+            for( size_t i=0; i<NumVertexPass; ++i )
+                freeLods( itor->lods[i] );
+            ++itor;
+        }
+    }
+    //---------------------------------------------------------------------
+    void PreparedMeshData::freeLods( SubMeshLodVec &lods )
+    {
+        SubMeshLodVec::iterator itor = lods.begin();
+        SubMeshLodVec::iterator end  = lods.end();
+
+        while( itor != end )
+        {
+            Uint8Vec::iterator it = itor->vertexBuffers.begin();
+            Uint8Vec::iterator en = itor->vertexBuffers.end();
+
+            while( it != en )
+                OGRE_FREE_SIMD( *it++, MEMCATEGORY_GEOMETRY );
+
+            itor->vertexBuffers.clear();
+
+            if( itor->indexData )
+            {
+                OGRE_FREE_SIMD( itor->indexData, MEMCATEGORY_GEOMETRY );
+                itor->indexData = 0;
+            }
+
+            ++itor;
+        }
+
+        lods.clear();
+    }
+    //---------------------------------------------------------------------
+    void PreparedMeshData::arrangeEfficient( bool halfPos, bool halfTexCoords, bool qTangents )
+    {
+        PreparedSubMeshVec::iterator itor = subMeshes.begin();
+        PreparedSubMeshVec::iterator end  = subMeshes.end();
+
+        while( itor != end )
+        {
+            for( size_t i=0; i<itor->numVaoPasses; ++i )
+            {
+                SubMeshLodVec::iterator itLod = itor->lods[i].begin();
+                SubMeshLodVec::iterator enLod = itor->lods[i].end();
+
+                while( itLod != enLod )
+                {
+                    //LODs sharing the vertex buffer of another LOD have no data of their own.
+                    if( !itLod->vertexBuffers.empty() )
+                    {
+                        FastArray<char const *> srcPtrs;
+                        srcPtrs.reserve( itLod->vertexBuffers.size() );
+                        for( size_t j=0; j<itLod->vertexBuffers.size(); ++j )
+                            srcPtrs.push_back( reinterpret_cast<const char*>( itLod->vertexBuffers[j] ) );
+
+                        VertexElement2Vec vertexElements;
+                        SubMesh::SourceDataArray srcData;
+                        SubMesh::_getEfficientFormat( itLod->vertexDeclarations, srcPtrs,
+                                                      halfPos, halfTexCoords, qTangents,
+                                                      &vertexElements, &srcData );
+
+                        uint8 *data = reinterpret_cast<uint8*>( SubMesh::_arrangeEfficient(
+                                                                    srcData, vertexElements,
+                                                                    itLod->numVertices ) );
+
+                        Uint8Vec::iterator it = itLod->vertexBuffers.begin();
+                        Uint8Vec::iterator en = itLod->vertexBuffers.end();
+                        while( it != en )
+                            OGRE_FREE_SIMD( *it++, MEMCATEGORY_GEOMETRY );
+
+                        itLod->vertexBuffers.clear();
+                        itLod->vertexBuffers.push_back( data );
+                        itLod->vertexDeclarations.clear();
+                        itLod->vertexDeclarations.push_back( vertexElements );
+                    }
+
+                    ++itLod;
+                }
+            }
+
+            ++itor;
+        }
+    }
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    MeshSerializerImpl_v2_1_R1::MeshSerializerImpl_v2_1_R1( VaoManager *vaoManager ) :
+    MeshSerializerImpl_v2_1_R2::MeshSerializerImpl_v2_1_R2( VaoManager *vaoManager ) :
         MeshSerializerImpl( vaoManager )
+    {
+        // Version number
+        mVersion = "[MeshSerializer_v2.1 R2]";
+        mSupportsCompression = false;
+    }
+    //---------------------------------------------------------------------
+    MeshSerializerImpl_v2_1_R2::~MeshSerializerImpl_v2_1_R2()
+    {
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    MeshSerializerImpl_v2_1_R1::MeshSerializerImpl_v2_1_R1( VaoManager *vaoManager ) :
+        MeshSerializerImpl_v2_1_R2( vaoManager )
     {
         // Version number
         mVersion = "[MeshSerializer_v2.1 R1]";
@@ -2218,64 +2626,7 @@ namespace Ogre {
         uint8 numLodLevels = 0;
         readChar( stream, &numLodLevels );
 
-        SubMeshLodVec totalSubmeshLods;
-        totalSubmeshLods.reserve( numLodLevels * numVaoPasses );
-
-        //M_SUBMESH_LOD
-        pushInnerChunk(stream);
-        try
-        {
-            SubMeshLodVec submeshLods;
-            submeshLods.reserve( numLodLevels );
-
-            for( uint8 i=0; i<numVaoPasses; ++i )
-            {
-                for( uint8 j=0; j<numLodLevels; ++j )
-                {
-                    uint16 streamID = readChunk(stream);
-                    assert( streamID == M_SUBMESH_LOD && !stream->eof() );
-
-                    totalSubmeshLods.push_back( SubMeshLod() );
-                    const uint8 currentLod = static_cast<uint8>( submeshLods.size() );
-                    readSubMeshLod( stream, pMesh, &totalSubmeshLods.back(), currentLod );
-
-                    submeshLods.push_back( totalSubmeshLods.back() );
-                }
-
-                createSubMeshVao( sm, submeshLods, i );
-                submeshLods.clear();
-            }
-        }
-        catch( Exception &e )
-        {
-            SubMeshLodVec::iterator itor = totalSubmeshLods.begin();
-            SubMeshLodVec::iterator end  = totalSubmeshLods.end();
-
-            while( itor != end )
-            {
-                Uint8Vec::iterator it = itor->vertexBuffers.begin();
-                Uint8Vec::iterator en = itor->vertexBuffers.end();
-
-                while( it != en )
-                    OGRE_FREE_SIMD( *it++, MEMCATEGORY_GEOMETRY );
-
-                itor->vertexBuffers.clear();
-
-                if( itor->indexData )
-                {
-                    OGRE_FREE_SIMD( itor->indexData, MEMCATEGORY_GEOMETRY );
-                    itor->indexData = 0;
-                }
-
-                ++itor;
-            }
-
-            //TODO: Delete created mVaos. Don't erase the data from those vaos?
-
-            throw e;
-        }
-
-        popInnerChunk(stream);
+        readSubMeshLods( stream, pMesh, sm, numLodLevels, numVaoPasses, false );
     }
 
     //---------------------------------------------------------------------
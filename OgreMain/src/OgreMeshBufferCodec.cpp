@@ -0,0 +1,530 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2017 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreMeshBufferCodec.h"
+
+#include "Math/Array/OgreArrayConfig.h"
+
+#if OGRE_USE_SIMD == 1 && OGRE_CPU == OGRE_CPU_X86
+    #define OGRE_MESH_CODEC_SSE2 1
+#else
+    #define OGRE_MESH_CODEC_SSE2 0
+#endif
+
+namespace Ogre
+{
+    namespace
+    {
+        /// First byte of the encoded streams. Bump if the layout changes.
+        const uint8 c_vertexCodecTag    = 0xA1;
+        const uint8 c_indexCodecTag     = 0xB1;
+
+        const size_t c_groupSize        = 16u;
+        const size_t c_maxBlockVertices = 256u;
+        const size_t c_maxGroups        = c_maxBlockVertices / c_groupSize;
+        const size_t c_maxBytesPerVertex= 256u;
+
+        /// Size in bytes of a group of 16 deltas encoded with the given 2-bit code.
+        const size_t c_groupBytes[4]    = { 0u, 4u, 8u, 16u };
+
+        inline uint8 zigzag8( uint8 v )
+        {
+            return static_cast<uint8>( (v << 1u) ^ static_cast<uint8>( static_cast<int8>( v ) >> 7 ) );
+        }
+        inline uint8 unzigzag8( uint8 v )
+        {
+            return static_cast<uint8>( (v >> 1u) ^ static_cast<uint8>( -static_cast<int>( v & 1u ) ) );
+        }
+        inline uint32 zigzag32( int32 v )
+        {
+            return (static_cast<uint32>( v ) << 1u) ^ static_cast<uint32>( v >> 31 );
+        }
+        inline int32 unzigzag32( uint32 v )
+        {
+            return static_cast<int32>( (v >> 1u) ^ (0u - (v & 1u)) );
+        }
+        //---------------------------------------------------------------------
+        size_t getBlockBound( size_t blockVertices, size_t bytesPerVertex )
+        {
+            const size_t numGroups = (blockVertices + c_groupSize - 1u) / c_groupSize;
+            return bytesPerVertex * ( (numGroups + 3u) / 4u + numGroups * c_groupSize );
+        }
+        //---------------------------------------------------------------------
+        /// Returns the size in bytes of the deltas of one column of a block.
+        size_t encodeGroups( uint8 *dst, const uint8 * RESTRICT_ALIAS deltas, size_t numGroups )
+        {
+            uint8 *header = dst;
+            uint8 *data = dst + (numGroups + 3u) / 4u;
+            memset( header, 0, (numGroups + 3u) / 4u );
+
+            for( size_t g=0; g<numGroups; ++g )
+            {
+                const uint8 *group = deltas + g * c_groupSize;
+
+                uint8 maxValue = 0;
+                for( size_t i=0; i<c_groupSize; ++i )
+                    maxValue |= group[i];
+
+                uint8 code;
+                if( maxValue == 0 )
+                    code = 0;
+                else if( maxValue < 4u )
+                    code = 1;
+                else if( maxValue < 16u )
+                    code = 2;
+                else
+                    code = 3;
+
+                header[g >> 2u] |= static_cast<uint8>( code << ((g & 3u) << 1u) );
+
+                switch( code )
+                {
+                case 1:
+                    for( size_t i=0; i<4u; ++i )
+                    {
+                        *data++ = static_cast<uint8>( (group[i*4u+0] << 6u) | (group[i*4u+1] << 4u) |
+                                                      (group[i*4u+2] << 2u) | group[i*4u+3] );
+                    }
+                    break;
+                case 2:
+                    for( size_t i=0; i<8u; ++i )
+                        *data++ = static_cast<uint8>( (group[i*2u+0] << 4u) | group[i*2u+1] );
+                    break;
+                case 3:
+                    memcpy( data, group, c_groupSize );
+                    data += c_groupSize;
+                    break;
+                }
+            }
+
+            return static_cast<size_t>( data - dst );
+        }
+        //---------------------------------------------------------------------
+        /// Returns the number of bytes consumed, 0 if the data would be read out of bounds.
+        size_t decodeGroups( uint8 * RESTRICT_ALIAS deltas, const uint8 * RESTRICT_ALIAS src,
+                             size_t srcSize, size_t numGroups )
+        {
+            const size_t headerSize = (numGroups + 3u) / 4u;
+            if( srcSize < headerSize )
+                return 0;
+
+            //Validate the whole column once, so the loop below doesn't need to.
+            size_t totalSize = headerSize;
+            for( size_t g=0; g<numGroups; ++g )
+                totalSize += c_groupBytes[(src[g >> 2u] >> ((g & 3u) << 1u)) & 0x03u];
+            if( srcSize < totalSize )
+                return 0;
+
+            const uint8 *data = src + headerSize;
+
+            for( size_t g=0; g<numGroups; ++g )
+            {
+                uint8 *group = deltas + g * c_groupSize;
+                const uint8 code = (src[g >> 2u] >> ((g & 3u) << 1u)) & 0x03u;
+
+                switch( code )
+                {
+                case 0:
+                    memset( group, 0, c_groupSize );
+                    break;
+#if OGRE_MESH_CODEC_SSE2
+                case 1:
+                {
+                    uint32 packed;
+                    memcpy( &packed, data, sizeof(packed) );
+                    data += 4u;
+                    const __m128i mask = _mm_set1_epi8( 0x03 );
+                    const __m128i v = _mm_cvtsi32_si128( static_cast<int>( packed ) );
+                    const __m128i v6 = _mm_and_si128( _mm_srli_epi16( v, 6 ), mask );
+                    const __m128i v4 = _mm_and_si128( _mm_srli_epi16( v, 4 ), mask );
+                    const __m128i v2 = _mm_and_si128( _mm_srli_epi16( v, 2 ), mask );
+                    const __m128i v0 = _mm_and_si128( v, mask );
+                    _mm_storeu_si128( reinterpret_cast<__m128i*>( group ),
+                                      _mm_unpacklo_epi16( _mm_unpacklo_epi8( v6, v4 ),
+                                                          _mm_unpacklo_epi8( v2, v0 ) ) );
+                    break;
+                }
+                case 2:
+                {
+                    const __m128i mask = _mm_set1_epi8( 0x0F );
+                    const __m128i v = _mm_loadl_epi64( reinterpret_cast<const __m128i*>( data ) );
+                    data += 8u;
+                    _mm_storeu_si128( reinterpret_cast<__m128i*>( group ),
+                                      _mm_unpacklo_epi8( _mm_and_si128( _mm_srli_epi16( v, 4 ), mask ),
+                                                         _mm_and_si128( v, mask ) ) );
+                    break;
+                }
+#else
+                case 1:
+                    for( size_t i=0; i<4u; ++i )
+                    {
+                        const uint8 v = *data++;
+                        group[i*4u+0] = v >> 6u;
+                        group[i*4u+1] = (v >> 4u) & 0x03u;
+                        group[i*4u+2] = (v >> 2u) & 0x03u;
+                        group[i*4u+3] = v & 0x03u;
+                    }
+                    break;
+                case 2:
+                    for( size_t i=0; i<8u; ++i )
+                    {
+                        const uint8 v = *data++;
+                        group[i*2u+0] = v >> 4u;
+                        group[i*2u+1] = v & 0x0Fu;
+                    }
+                    break;
+#endif
+                case 3:
+                    memcpy( group, data, c_groupSize );
+                    data += c_groupSize;
+                    break;
+                }
+            }
+
+            return totalSize;
+        }
+#if OGRE_MESH_CODEC_SSE2
+        //---------------------------------------------------------------------
+        /// Unzigzags 'numGroups * 16' deltas and adds them up starting from 'prev',
+        /// 16 at a time. The running sum no longer depends on the previous byte.
+        inline void prefixSumDeltas( uint8 * RESTRICT_ALIAS values,
+                                     const uint8 * RESTRICT_ALIAS deltas,
+                                     size_t numGroups, uint8 prev )
+        {
+            const __m128i oneMask = _mm_set1_epi8( 1 );
+            const __m128i lowMask = _mm_set1_epi8( 0x7F );
+            __m128i carry = _mm_set1_epi8( static_cast<char>( prev ) );
+
+            for( size_t g=0; g<numGroups; ++g )
+            {
+                __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( deltas + g * 16u ) );
+
+                //(v >> 1) ^ -(v & 1)
+                __m128i sign = _mm_sub_epi8( _mm_setzero_si128(), _mm_and_si128( v, oneMask ) );
+                v = _mm_xor_si128( _mm_and_si128( _mm_srli_epi16( v, 1 ), lowMask ), sign );
+
+                v = _mm_add_epi8( v, _mm_slli_si128( v, 1 ) );
+                v = _mm_add_epi8( v, _mm_slli_si128( v, 2 ) );
+                v = _mm_add_epi8( v, _mm_slli_si128( v, 4 ) );
+                v = _mm_add_epi8( v, _mm_slli_si128( v, 8 ) );
+                v = _mm_add_epi8( v, carry );
+
+                _mm_storeu_si128( reinterpret_cast<__m128i*>( values + g * 16u ), v );
+
+                //Broadcast the last byte
+                carry = _mm_unpackhi_epi8( v, v );
+                carry = _mm_shufflehi_epi16( carry, _MM_SHUFFLE( 3, 3, 3, 3 ) );
+                carry = _mm_unpackhi_epi64( carry, carry );
+            }
+        }
+        //---------------------------------------------------------------------
+        /// Writes 16 decoded columns (c_maxBlockVertices apart in 'columns') to the
+        /// interleaved vertices, transposing 16x16 bytes at a time instead of storing
+        /// each byte at its stride.
+        void storeColumns16( uint8 * RESTRICT_ALIAS dst, const uint8 * RESTRICT_ALIAS columns,
+                             size_t numVertices, size_t bytesPerVertex )
+        {
+            for( size_t v0=0; v0<numVertices; v0 += 16u )
+            {
+                __m128i rows[16];
+                for( size_t i=0; i<16u; ++i )
+                {
+                    rows[i] = _mm_loadu_si128( reinterpret_cast<const __m128i*>(
+                                                   columns + i * c_maxBlockVertices + v0 ) );
+                }
+
+                //Interleaving row i with row i+8 four times transposes the matrix.
+                for( size_t pass=0; pass<4u; ++pass )
+                {
+                    __m128i tmp[16];
+                    for( size_t i=0; i<8u; ++i )
+                    {
+                        tmp[i * 2u + 0] = _mm_unpacklo_epi8( rows[i], rows[i + 8u] );
+                        tmp[i * 2u + 1] = _mm_unpackhi_epi8( rows[i], rows[i + 8u] );
+                    }
+                    for( size_t i=0; i<16u; ++i )
+                        rows[i] = tmp[i];
+                }
+
+                const size_t tileVertices = std::min<size_t>( numVertices - v0, 16u );
+                for( size_t i=0; i<tileVertices; ++i )
+                {
+                    _mm_storeu_si128( reinterpret_cast<__m128i*>(
+                                          dst + (v0 + i) * bytesPerVertex ), rows[i] );
+                }
+            }
+        }
+#endif
+        //---------------------------------------------------------------------
+        inline uint8* writeVarint( uint8 *dst, uint32 value )
+        {
+            while( value >= 0x80u )
+            {
+                *dst++ = static_cast<uint8>( value | 0x80u );
+                value >>= 7u;
+            }
+            *dst++ = static_cast<uint8>( value );
+            return dst;
+        }
+    }
+    //-------------------------------------------------------------------------
+    size_t MeshBufferCodec::getVertexBufferBound( size_t numVertices, size_t bytesPerVertex )
+    {
+        const size_t numFullBlocks = numVertices / c_maxBlockVertices;
+        const size_t lastBlockVertices = numVertices % c_maxBlockVertices;
+
+        return 1u + numFullBlocks * getBlockBound( c_maxBlockVertices, bytesPerVertex ) +
+                getBlockBound( lastBlockVertices, bytesPerVertex );
+    }
+    //-------------------------------------------------------------------------
+    size_t MeshBufferCodec::encodeVertexBuffer( uint8 *dst, size_t dstCapacity, const uint8 *src,
+                                                size_t numVertices, size_t bytesPerVertex )
+    {
+        if( bytesPerVertex == 0 || bytesPerVertex > c_maxBytesPerVertex || dstCapacity < 1u )
+            return 0;
+
+        uint8 *dstStart = dst;
+        uint8 *dstEnd = dst + dstCapacity;
+
+        *dst++ = c_vertexCodecTag;
+
+        uint8 lastVertex[c_maxBytesPerVertex];
+        memset( lastVertex, 0, sizeof( lastVertex ) );
+
+        uint8 deltas[c_maxBlockVertices];
+
+        for( size_t blockStart=0; blockStart<numVertices; blockStart += c_maxBlockVertices )
+        {
+            const size_t blockVertices = std::min( numVertices - blockStart, c_maxBlockVertices );
+            const size_t numGroups = (blockVertices + c_groupSize - 1u) / c_groupSize;
+
+            if( static_cast<size_t>( dstEnd - dst ) < getBlockBound( blockVertices, bytesPerVertex ) )
+                return 0;
+
+            //Pad the last group with zeroes; they compress to nothing.
+            memset( deltas + blockVertices, 0, numGroups * c_groupSize - blockVertices );
+
+            for( size_t k=0; k<bytesPerVertex; ++k )
+            {
+                const uint8 *column = src + blockStart * bytesPerVertex + k;
+                uint8 prev = lastVertex[k];
+
+                for( size_t i=0; i<blockVertices; ++i )
+                {
+                    const uint8 value = column[i * bytesPerVertex];
+                    deltas[i] = zigzag8( static_cast<uint8>( value - prev ) );
+                    prev = value;
+                }
+
+                lastVertex[k] = prev;
+                dst += encodeGroups( dst, deltas, numGroups );
+            }
+        }
+
+        return static_cast<size_t>( dst - dstStart );
+    }
+    //-------------------------------------------------------------------------
+    bool MeshBufferCodec::decodeVertexBuffer( uint8 *dst, size_t numVertices, size_t bytesPerVertex,
+                                              const uint8 *src, size_t srcSize )
+    {
+        if( bytesPerVertex == 0 || bytesPerVertex > c_maxBytesPerVertex ||
+            srcSize < 1u || src[0] != c_vertexCodecTag )
+        {
+            return false;
+        }
+
+        const uint8 *srcEnd = src + srcSize;
+        ++src;
+
+        uint8 lastVertex[c_maxBytesPerVertex];
+        memset( lastVertex, 0, sizeof( lastVertex ) );
+
+        uint8 deltas[c_maxGroups * c_groupSize];
+#if OGRE_MESH_CODEC_SSE2
+        //16 columns of a block, decoded before being interleaved together.
+        uint8 columns[16u * c_maxBlockVertices];
+#endif
+
+        for( size_t blockStart=0; blockStart<numVertices; blockStart += c_maxBlockVertices )
+        {
+            const size_t blockVertices = std::min( numVertices - blockStart, c_maxBlockVertices );
+            const size_t numGroups = (blockVertices + c_groupSize - 1u) / c_groupSize;
+
+#if OGRE_MESH_CODEC_SSE2
+            for( size_t k0=0; k0<bytesPerVertex; k0 += 16u )
+            {
+                const size_t numColumns = std::min<size_t>( bytesPerVertex - k0, 16u );
+
+                for( size_t c=0; c<numColumns; ++c )
+                {
+                    const size_t consumed = decodeGroups( deltas, src,
+                                                          static_cast<size_t>( srcEnd - src ),
+                                                          numGroups );
+                    if( !consumed )
+                        return false;
+                    src += consumed;
+
+                    uint8 *values = columns + c * c_maxBlockVertices;
+                    prefixSumDeltas( values, deltas, numGroups, lastVertex[k0 + c] );
+                    lastVertex[k0 + c] = values[blockVertices - 1u];
+                }
+
+                uint8 *blockDst = dst + blockStart * bytesPerVertex + k0;
+
+                if( numColumns == 16u )
+                {
+                    storeColumns16( blockDst, columns, blockVertices, bytesPerVertex );
+                }
+                else
+                {
+                    //A full 16 byte store would overwrite the start of the next vertex.
+                    for( size_t c=0; c<numColumns; ++c )
+                    {
+                        const uint8 *values = columns + c * c_maxBlockVertices;
+                        for( size_t i=0; i<blockVertices; ++i )
+                            blockDst[i * bytesPerVertex + c] = values[i];
+                    }
+                }
+            }
+#else
+            for( size_t k=0; k<bytesPerVertex; ++k )
+            {
+                const size_t consumed = decodeGroups( deltas, src, static_cast<size_t>( srcEnd - src ),
+                                                      numGroups );
+                if( !consumed )
+                    return false;
+                src += consumed;
+
+                uint8 * RESTRICT_ALIAS column = dst + blockStart * bytesPerVertex + k;
+                uint8 prev = lastVertex[k];
+
+                for( size_t i=0; i<blockVertices; ++i )
+                {
+                    prev = static_cast<uint8>( prev + unzigzag8( deltas[i] ) );
+                    column[i * bytesPerVertex] = prev;
+                }
+
+                lastVertex[k] = prev;
+            }
+#endif
+        }
+
+        return src == srcEnd;
+    }
+    //-------------------------------------------------------------------------
+    size_t MeshBufferCodec::getIndexBufferBound( size_t numIndices )
+    {
+        return 1u + numIndices * 5u;
+    }
+    //-------------------------------------------------------------------------
+    size_t MeshBufferCodec::encodeIndexBuffer( uint8 *dst, size_t dstCapacity, const void *indices,
+                                               size_t numIndices, bool index32Bit )
+    {
+        if( dstCapacity < getIndexBufferBound( numIndices ) )
+            return 0;
+
+        uint8 *dstStart = dst;
+        *dst++ = c_indexCodecTag;
+
+        uint32 prev = 0;
+
+        if( index32Bit )
+        {
+            const uint32 *indices32 = reinterpret_cast<const uint32*>( indices );
+            for( size_t i=0; i<numIndices; ++i )
+            {
+                dst = writeVarint( dst, zigzag32( static_cast<int32>( indices32[i] - prev ) ) );
+                prev = indices32[i];
+            }
+        }
+        else
+        {
+            const uint16 *indices16 = reinterpret_cast<const uint16*>( indices );
+            for( size_t i=0; i<numIndices; ++i )
+            {
+                dst = writeVarint( dst, zigzag32( static_cast<int32>( indices16[i] ) -
+                                                  static_cast<int32>( prev ) ) );
+                prev = indices16[i];
+            }
+        }
+
+        return static_cast<size_t>( dst - dstStart );
+    }
+    //-------------------------------------------------------------------------
+    bool MeshBufferCodec::decodeIndexBuffer( void *dst, size_t numIndices, bool index32Bit,
+                                             const uint8 *src, size_t srcSize )
+    {
+        if( srcSize < 1u || src[0] != c_indexCodecTag )
+            return false;
+
+        const uint8 *srcEnd = src + srcSize;
+        ++src;
+
+        uint32 * RESTRICT_ALIAS dst32 = reinterpret_cast<uint32*>( dst );
+        uint16 * RESTRICT_ALIAS dst16 = reinterpret_cast<uint16*>( dst );
+
+        uint32 prev = 0;
+
+        for( size_t i=0; i<numIndices; ++i )
+        {
+            uint32 value;
+
+            if( src < srcEnd && *src < 0x80u )
+            {
+                //Fast path: deltas in [-64; 63] take one byte.
+                value = *src++;
+            }
+            else
+            {
+                value = 0;
+                uint32 shift = 0;
+                uint8 byte;
+                do
+                {
+                    if( src == srcEnd || shift > 28u )
+                        return false;
+                    byte = *src++;
+                    value |= static_cast<uint32>( byte & 0x7Fu ) << shift;
+                    shift += 7u;
+                }
+                while( byte & 0x80u );
+            }
+
+            prev = static_cast<uint32>( static_cast<int32>( prev ) + unzigzag32( value ) );
+
+            if( index32Bit )
+                dst32[i] = prev;
+            else
+                dst16[i] = static_cast<uint16>( prev );
+        }
+
+        return src == srcEnd;
+    }
+}
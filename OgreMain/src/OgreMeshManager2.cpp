@@ -34,6 +34,7 @@ THE SOFTWARE.
 #include "OgreMatrix4.h"
 #include "OgrePatchMesh.h"
 #include "OgreException.h"
+#include "OgreRoot.h"
 
 #include "OgrePrefabFactory.h"
 
@@ -52,8 +53,15 @@ namespace Ogre
     //-----------------------------------------------------------------------
     MeshManager::MeshManager() :
         mVaoManager( 0 ),
-        mBoundsPaddingFactor( 0.01 )/*,
-        mListener( 0 )*/
+        mBoundsPaddingFactor( 0.01 ),/*
+        mListener( 0 ),*/
+        mWorkQueue( 0 ),
+        mWorkQueueChannel( 0 ),
+        mNumPendingAsyncLoads( 0 ),
+        mArrangeEfficientOnPrepare( false ),
+        mArrangeEfficientHalfPos( true ),
+        mArrangeEfficientHalfTexCoords( true ),
+        mArrangeEfficientQTangents( true )
     {
         mLoadOrder = 300.0f;
         mResourceType = "Mesh2";
@@ -63,6 +71,14 @@ namespace Ogre
     //-----------------------------------------------------------------------
     MeshManager::~MeshManager()
     {
+        if( mWorkQueue )
+        {
+            mWorkQueue->abortRequestsByChannel( mWorkQueueChannel );
+            mWorkQueue->removeRequestHandler( mWorkQueueChannel, this );
+            mWorkQueue->removeResponseHandler( mWorkQueueChannel, this );
+            mWorkQueue = 0;
+        }
+
         ResourceGroupManager::getSingleton()._unregisterResourceManager(mResourceType);
     }
     //-----------------------------------------------------------------------
@@ -73,6 +89,13 @@ namespace Ogre
     //-----------------------------------------------------------------------
     void MeshManager::_initialise(void)
     {
+        if( !mWorkQueue )
+        {
+            mWorkQueue = Root::getSingleton().getWorkQueue();
+            mWorkQueueChannel = mWorkQueue->getChannel( "Ogre/Mesh2" );
+            mWorkQueue->addRequestHandler( mWorkQueueChannel, this );
+            mWorkQueue->addResponseHandler( mWorkQueueChannel, this );
+        }
     }
     //-----------------------------------------------------------------------
     void MeshManager::_setVaoManager( VaoManager *vaoManager )
@@ -127,6 +150,109 @@ namespace Ogre
         return pMesh;
     }
     //-----------------------------------------------------------------------
+    MeshPtr MeshManager::loadAsync( const String& filename, const String& groupName,
+                                    AsyncLoadListener *listener,
+                                    BufferType vertexBufferType,
+                                    BufferType indexBufferType,
+                                    bool vertexBufferShadowed, bool indexBufferShadowed )
+    {
+        if( !mWorkQueue )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALID_STATE,
+                         "Root must be initialised before calling loadAsync",
+                         "MeshManager::loadAsync" );
+        }
+
+        MeshPtr pMesh = createOrRetrieve( filename, groupName, false, 0, 0,
+                                          vertexBufferType, indexBufferType,
+                                          vertexBufferShadowed, indexBufferShadowed ).
+                        first.staticCast<Mesh>();
+
+        AsyncLoadRequest request;
+        request.mesh        = pMesh;
+        request.listener    = listener;
+
+        //Without thread support, this processes the request & response right away.
+        ++mNumPendingAsyncLoads;
+        mWorkQueue->addRequest( mWorkQueueChannel, 0, Any( request ) );
+
+        return pMesh;
+    }
+    //-----------------------------------------------------------------------
+    void MeshManager::setArrangeEfficientOnPrepare( bool enabled, bool halfPos,
+                                                    bool halfTexCoords, bool qTangents )
+    {
+        mArrangeEfficientOnPrepare      = enabled;
+        mArrangeEfficientHalfPos        = halfPos;
+        mArrangeEfficientHalfTexCoords  = halfTexCoords;
+        mArrangeEfficientQTangents      = qTangents;
+    }
+    //-----------------------------------------------------------------------
+    bool MeshManager::canHandleRequest( const WorkQueue::Request *req, const WorkQueue *srcQ )
+    {
+        return true;
+    }
+    //-----------------------------------------------------------------------
+    WorkQueue::Response* MeshManager::handleRequest( const WorkQueue::Request *req,
+                                                     const WorkQueue *srcQ )
+    {
+        const AsyncLoadRequest &request = any_cast<AsyncLoadRequest>( req->getData() );
+
+        if( req->getAborted() )
+            return OGRE_NEW WorkQueue::Response( req, false, req->getData() );
+
+        try
+        {
+            //Does nothing if already prepared or loaded.
+            request.mesh->prepare( true );
+        }
+        catch( Exception &e )
+        {
+            return OGRE_NEW WorkQueue::Response( req, false, req->getData(),
+                                                 e.getFullDescription() );
+        }
+
+        return OGRE_NEW WorkQueue::Response( req, true, req->getData() );
+    }
+    //-----------------------------------------------------------------------
+    bool MeshManager::canHandleResponse( const WorkQueue::Response *res, const WorkQueue *srcQ )
+    {
+        return true;
+    }
+    //-----------------------------------------------------------------------
+    void MeshManager::handleResponse( const WorkQueue::Response *res, const WorkQueue *srcQ )
+    {
+        assert( mNumPendingAsyncLoads > 0 );
+        --mNumPendingAsyncLoads;
+
+        if( res->getRequest()->getAborted() )
+            return;
+
+        const AsyncLoadRequest &request = any_cast<AsyncLoadRequest>( res->getData() );
+
+        String errorDescription = res->getMessages();
+
+        if( res->succeeded() )
+        {
+            try
+            {
+                //Only the GPU buffers are left to create.
+                request.mesh->load();
+            }
+            catch( Exception &e )
+            {
+                errorDescription = e.getFullDescription();
+            }
+        }
+        else if( errorDescription.empty() )
+        {
+            errorDescription = "Failed to prepare " + request.mesh->getName();
+        }
+
+        if( request.listener )
+            request.listener->meshLoaded( request.mesh, errorDescription );
+    }
+    //-----------------------------------------------------------------------
     MeshPtr MeshManager::create( const String& name, const String& group,
                                     bool isManual, ManualResourceLoader* loader,
                                     const NameValuePairList* createParams)
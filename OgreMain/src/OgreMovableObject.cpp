@@ -41,6 +41,8 @@ THE SOFTWARE.
 #include "Math/Array/OgreArraySphere.h"
 #include "Math/Array/OgreBooleanMask.h"
 #include "OgreRawPtr.h"
+#include "OgreLightBinGrid.h"
+#include "OgreFrameArena.h"
 
 namespace Ogre {
     using namespace VisibilityFlags;
@@ -62,10 +64,15 @@ namespace Ogre {
         , mManager( manager )
         , mLodMesh( &c_DefaultLodMesh )
         , mCurrentMeshLod( 0 )
+        , mCurrentLodValue( -std::numeric_limits<Real>::max() )
         , mMinPixelSize(0)
         , mListener(0)
+        , mLightListMask( 0 )
+        , mLightListFrameId( 0 )
         , mSkeletonInstance( 0 )
         , mObjectMemoryManager( objectMemoryManager )
+        , mVisibilityDelayed( false )
+        , mDelayedVisible( false )
         , mGlobalIndex( -1 )
         , mParentIndex( -1 )
     {
@@ -86,10 +93,15 @@ namespace Ogre {
         , mManager(0)
         , mLodMesh( &c_DefaultLodMesh )
         , mCurrentMeshLod( 0 )
+        , mCurrentLodValue( -std::numeric_limits<Real>::max() )
         , mMinPixelSize(0)
         , mListener(0)
+        , mLightListMask( 0 )
+        , mLightListFrameId( 0 )
         , mSkeletonInstance( 0 )
         , mObjectMemoryManager( 0 )
+        , mVisibilityDelayed( false )
+        , mDelayedVisible( false )
         , mGlobalIndex( -1 )
         , mParentIndex( -1 )
     {
@@ -119,6 +131,24 @@ namespace Ogre {
         assert( !mSkeletonInstance );
     }
     //-----------------------------------------------------------------------
+    void MovableObject::_setVisibilityDelayed( bool bDelayed )
+    {
+        if( bDelayed == mVisibilityDelayed )
+            return;
+
+        if( bDelayed )
+        {
+            mDelayedVisible = getVisible();
+            mObjectData.mVisibilityFlags[mObjectData.mIndex] &= ~VisibilityFlags::LAYER_VISIBILITY;
+            mVisibilityDelayed = true;
+        }
+        else
+        {
+            mVisibilityDelayed = false;
+            setVisible( mDelayedVisible && mParentNode );
+        }
+    }
+    //-----------------------------------------------------------------------
     void MovableObject::_notifyAttached( Node* parent )
     {
         assert(!mParentNode || !parent);
@@ -127,6 +157,10 @@ namespace Ogre {
 
         if( different )
         {
+            //mParents is read by the pipelined update
+            if( mManager )
+                mManager->_finishPendingSceneGraphUpdate();
+
             mParentNode = parent;
             if( parent )
                 mObjectData.mParents[mObjectData.mIndex] = parent;
@@ -135,6 +169,15 @@ namespace Ogre {
 
             setVisible( parent != 0 );
 
+            //Until the pipelined update calculates our bounds, they're stale
+            if( mManager && mManager->getPipelinedUpdate() )
+            {
+                if( parent )
+                    mManager->_delayVisibility( this );
+                else
+                    mManager->_cancelDelayedVisibility( this );
+            }
+
             // Call listener (note, only called if there's something to do)
             if (mListener)
             {
@@ -369,9 +412,11 @@ namespace Ogre {
         return mWorldBoundingSphere;
     }*/
     //-----------------------------------------------------------------------
-    void MovableObject::updateAllBounds( const size_t numNodes, ObjectData objData )
+    void MovableObject::updateAllBounds( const size_t numNodes, ObjectData objData,
+                                         bool parentsFromBackBuffer )
     {
         SimpleMatrix4 mats[ARRAY_PACKED_REALS];
+        Transform parentBackTransform;
         for( size_t i=0; i<numNodes; i += ARRAY_PACKED_REALS )
         {
             //Retrieve from parents. Unfortunately we need to do SoA -> AoS -> SoA conversion
@@ -387,7 +432,13 @@ namespace Ogre {
             for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
             {
                 Vector3 scale;
-                const Transform &parentTransform = objData.mParents[j]->_getTransform();
+                const Transform *parentTransformPtr = &objData.mParents[j]->_getTransform();
+                if( parentsFromBackBuffer )
+                {
+                    objData.mParents[j]->_getBackBufferTransform( parentBackTransform );
+                    parentTransformPtr = &parentBackTransform;
+                }
+                const Transform &parentTransform = *parentTransformPtr;
                 parentTransform.mDerivedScale->getAsVector3( scale, parentTransform.mIndex );
                 mats[j].load( parentTransform.mDerivedTransform[parentTransform.mIndex] );
                 parentScale.setFromVector3( scale, j );
@@ -412,7 +463,8 @@ namespace Ogre {
             *worldRadius = (*localRadius) * parentScale.getMaxComponent();
 
 #if OGRE_DEBUG_MODE
-            for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
+            //The pipelined update already did this from the main thread
+            for( size_t j=0; j<ARRAY_PACKED_REALS && !parentsFromBackBuffer; ++j )
             {
                 if( objData.mOwner[j] )
                     objData.mOwner[j]->mCachedAabbOutOfDate = false;
@@ -423,71 +475,103 @@ namespace Ogre {
         }
     }
     //-----------------------------------------------------------------------
-    void MovableObject::cullFrustum( const size_t numNodes, ObjectData objData, const Camera *frustum,
-                                     uint32 sceneVisibilityFlags, MovableObjectArray &outCulledObjects,
-                                     const Camera *lodCamera )
+    //Thanks to Fabian Giesen for summing up all known methods of frustum culling:
+    //http://fgiesen.wordpress.com/2010/10/17/view-frustum-culling/
+    // (we use method Method 5: "If you really don't care whether a box is
+    // partially or fully inside"):
+    // vector4 signFlip = componentwise_and(plane, 0x80000000);
+    // return dot3(center + xor(extent, signFlip), plane) > -plane.w;
+    namespace
     {
-        //On threaded environments, the internal variables from outCulledObjects cause
-        //a false cache sharing because they're too close to each other. Perfoming
-        //a swap places those internal vars in the local stack, increasing scalability
-        MovableObjectArray culledObjects;
-        culledObjects.swap( outCulledObjects );
+    struct ArrayPlane
+    {
+        ArrayVector3    planeNormal;
+        ArrayVector3    signFlip;
+        ArrayReal       planeNegD;
+    };
 
-        //Thanks to Fabian Giesen for summing up all known methods of frustum culling:
-        //http://fgiesen.wordpress.com/2010/10/17/view-frustum-culling/
-        // (we use method Method 5: "If you really don't care whether a box is
-        // partially or fully inside"):
-        // vector4 signFlip = componentwise_and(plane, 0x80000000);
-        // return dot3(center + xor(extent, signFlip), plane) > -plane.w;
-        struct ArrayPlane
+    /// Everything cullFrustumPack needs that is the same for all packs.
+    struct ArrayFrustumCullSetup
+    {
+        ArrayPlane      planes[6];
+        ArrayVector3    cameraPos;
+        ArrayVector3    cameraDir;
+        ArrayVector3    lodCameraPos;
+        ArrayInt        includeNonCasters;
+        ArrayInt        sceneFlags;
+        ArrayMaskR      ignoreRenderingDistance;
+        /// @See Camera::_setShadowCasterVolume
+        ArrayPlane      casterPlanes[ShadowCasterVolume::MaxPlanes];
+        size_t          numCasterPlanes;
+
+        ArrayFrustumCullSetup( const Camera *frustum, uint32 sceneVisibilityFlags,
+                               const Camera *lodCamera ) :
+            numCasterPlanes( 0 )
         {
-            ArrayVector3    planeNormal;
-            ArrayVector3    signFlip;
-            ArrayReal       planeNegD;
-        };
+            cameraPos.setAll( frustum->_getCachedDerivedPosition() );
+            cameraDir.setAll( -frustum->_getCachedDerivedOrientation().zAxis() );
+            lodCameraPos.setAll( lodCamera->_getCachedDerivedPosition() );
 
-        ArrayVector3 cameraPos, cameraDir, lodCameraPos;
-        cameraPos.setAll( frustum->_getCachedDerivedPosition() );
-        cameraDir.setAll( -frustum->_getCachedDerivedOrientation().zAxis() );
-        lodCameraPos.setAll( lodCamera->_getCachedDerivedPosition() );
+            // Flip the bit from shadow caster, and leave only that in "includeNonCasters"
+            includeNonCasters = Mathlib::SetAll( ((sceneVisibilityFlags & LAYER_SHADOW_CASTER) ^ -1)
+                                                    & LAYER_SHADOW_CASTER );
+            sceneVisibilityFlags &= RESERVED_VISIBILITY_FLAGS;
 
-        // Flip the bit from shadow caster, and leave only that in "includeNonCasters"
-        ArrayInt includeNonCasters = Mathlib::SetAll( ((sceneVisibilityFlags & LAYER_SHADOW_CASTER) ^ -1)
-                                                        & LAYER_SHADOW_CASTER );
-        sceneVisibilityFlags &= RESERVED_VISIBILITY_FLAGS;
+            sceneFlags = Mathlib::SetAll( sceneVisibilityFlags );
+            const Plane *frustumPlanes = frustum->_getCachedFrustumPlanes();
 
-        ArrayInt sceneFlags = Mathlib::SetAll( sceneVisibilityFlags );
-        ArrayPlane planes[6];
-        const Plane *frustumPlanes = frustum->_getCachedFrustumPlanes();
+            for( size_t i=0; i<6; ++i )
+            {
+                planes[i].planeNormal.setAll( frustumPlanes[i].normal );
+                planes[i].signFlip.setAll( frustumPlanes[i].normal );
+                planes[i].signFlip.setToSign();
+                planes[i].planeNegD = Mathlib::SetAll( -frustumPlanes[i].d );
+            }
 
-        for( size_t i=0; i<6; ++i )
-        {
-            planes[i].planeNormal.setAll( frustumPlanes[i].normal );
-            planes[i].signFlip.setAll( frustumPlanes[i].normal );
-            planes[i].signFlip.setToSign();
-            planes[i].planeNegD = Mathlib::SetAll( -frustumPlanes[i].d );
+            ignoreRenderingDistance = CastIntToReal(
+                        Mathlib::SetAll( lodCamera->getUseRenderingDistance() ? 0 : 0xffffffff ) );
+
+            const ShadowCasterVolume *casterVolume = frustum->getShadowCasterVolume();
+            if( casterVolume )
+            {
+                numCasterPlanes = casterVolume->numPlanes;
+                for( size_t i=0; i<numCasterPlanes; ++i )
+                {
+                    const Plane &plane = casterVolume->planes[i];
+                    casterPlanes[i].planeNormal.setAll( plane.normal );
+                    casterPlanes[i].signFlip.setAll( plane.normal );
+                    casterPlanes[i].signFlip.setToSign();
+                    casterPlanes[i].planeNegD = Mathlib::SetAll( -plane.d );
+                }
+            }
         }
-        
-        const ArrayMaskR ignoreRenderingDistance = CastIntToReal(
-                    Mathlib::SetAll( lodCamera->getUseRenderingDistance() ? 0 : 0xffffffff ) );
+    };
+    }
+
+    /// Culls a single pack of ARRAY_PACKED_REALS objects. @See MovableObject::cullFrustum
+    static inline void cullFrustumPack( const ObjectData &objData, const ArrayFrustumCullSetup &setup,
+                                        bool testPlanes,
+                                        MovableObject::MovableObjectArray &culledObjects )
+    {
+        const ArrayPlane *planes = setup.planes;
+
+        ArrayInt * RESTRICT_ALIAS visibilityFlags = reinterpret_cast<ArrayInt*RESTRICT_ALIAS>
+                                                                    (objData.mVisibilityFlags);
+        ArrayReal * RESTRICT_ALIAS worldRadius = reinterpret_cast<ArrayReal*RESTRICT_ALIAS>
+                                                                    (objData.mWorldRadius);
+        ArrayReal * RESTRICT_ALIAS upperDistance = reinterpret_cast<ArrayReal*RESTRICT_ALIAS>
+                                                                    (objData.mUpperDistance);
+        ArrayReal * RESTRICT_ALIAS distanceToCamera = reinterpret_cast<ArrayReal*RESTRICT_ALIAS>
+                                                                    (objData.mDistanceToCamera);
 
         //TODO: Profile whether we should use XOR to flip the sign or simple multiplication.
         //In theory xor is faster, but some archs have a penalty for switching between integer
         //& floating point, even if it's simd sse
-        for( size_t i=0; i<numNodes; i += ARRAY_PACKED_REALS )
+        ArrayMaskR mask;
+        if( testPlanes )
         {
-            ArrayInt * RESTRICT_ALIAS visibilityFlags = reinterpret_cast<ArrayInt*RESTRICT_ALIAS>
-                                                                        (objData.mVisibilityFlags);
-            ArrayReal * RESTRICT_ALIAS worldRadius = reinterpret_cast<ArrayReal*RESTRICT_ALIAS>
-                                                                        (objData.mWorldRadius);
-            ArrayReal * RESTRICT_ALIAS upperDistance = reinterpret_cast<ArrayReal*RESTRICT_ALIAS>
-                                                                        (objData.mUpperDistance);
-            ArrayReal * RESTRICT_ALIAS distanceToCamera = reinterpret_cast<ArrayReal*RESTRICT_ALIAS>
-                                                                        (objData.mDistanceToCamera);
-
             //Test all 6 planes and AND the dot product. If one is false, then we're not visible
             ArrayReal dotResult;
-            ArrayMaskR mask;
             ArrayVector3 centerPlusFlippedHS;
             centerPlusFlippedHS = objData.mWorldAabb->mCenter + objData.mWorldAabb->mHalfSize *
                                                                  planes[0].signFlip;
@@ -518,7 +602,25 @@ namespace Ogre {
                                                                  planes[5].signFlip;
             dotResult = planes[5].planeNormal.dotProduct( centerPlusFlippedHS );
             mask = Mathlib::And( mask, Mathlib::CompareGreater( dotResult, planes[5].planeNegD ) );
+        }
+        else
+        {
+            mask = CastIntToReal( Mathlib::SetAll( 0xffffffff ) );
+        }
+
+        //Shadow casters whose shadow can't be seen. Always tested, as the caller only
+        //knows whether the packs are fully inside the frustum, not inside this volume.
+        for( size_t i=0; i<setup.numCasterPlanes; ++i )
+        {
+            const ArrayPlane &casterPlane = setup.casterPlanes[i];
+            ArrayVector3 centerPlusFlippedHS = objData.mWorldAabb->mCenter +
+                                               objData.mWorldAabb->mHalfSize * casterPlane.signFlip;
+            ArrayReal dotResult = casterPlane.planeNormal.dotProduct( centerPlusFlippedHS );
+            mask = Mathlib::And( mask, Mathlib::CompareGreater( dotResult, casterPlane.planeNegD ) );
+        }
 
+        if( testPlanes || setup.numCasterPlanes )
+        {
             //Always pass the test if any of the components were
             //Infinity (dot product above could've caused nans)
             ArrayMaskR tmpMask = Mathlib::Or(
@@ -526,53 +628,326 @@ namespace Ogre {
                             Mathlib::isInfinity( objData.mWorldAabb->mHalfSize.mChunkBase[1] ) );
             mask = Mathlib::Or( Mathlib::isInfinity( objData.mWorldAabb->mHalfSize.mChunkBase[2] ),
                                 mask );
+            mask = Mathlib::Or( mask, tmpMask );
+        }
 
-            ArrayReal distance = lodCameraPos.distance( objData.mWorldAabb->mCenter );
-            ArrayMaskR isCloseEnough = Mathlib::CompareLessEqual( distance, *worldRadius + *upperDistance );
-            isCloseEnough = Mathlib::Or( ignoreRenderingDistance, isCloseEnough );
+        ArrayReal distance = setup.lodCameraPos.distance( objData.mWorldAabb->mCenter );
+        ArrayMaskR isCloseEnough = Mathlib::CompareLessEqual( distance, *worldRadius + *upperDistance );
+        isCloseEnough = Mathlib::Or( setup.ignoreRenderingDistance, isCloseEnough );
 
-            mask = Mathlib::And( Mathlib::Or( mask, tmpMask ), isCloseEnough );
+        mask = Mathlib::And( mask, isCloseEnough );
 
-            //isVisible = isVisible() && (isCaster || includeNonCasters)
-            ArrayMaskI isVisible = Mathlib::And(
-                                Mathlib::TestFlags4( *visibilityFlags,
-                                                        Mathlib::SetAll( LAYER_VISIBILITY ) ),
-                                Mathlib::TestFlags4( Mathlib::Or( *visibilityFlags, includeNonCasters ),
-                                                        Mathlib::SetAll( LAYER_SHADOW_CASTER ) ) );
+        //isVisible = isVisible() && (isCaster || includeNonCasters)
+        ArrayMaskI isVisible = Mathlib::And(
+                            Mathlib::TestFlags4( *visibilityFlags,
+                                                    Mathlib::SetAll( LAYER_VISIBILITY ) ),
+                            Mathlib::TestFlags4( Mathlib::Or( *visibilityFlags,
+                                                              setup.includeNonCasters ),
+                                                    Mathlib::SetAll( LAYER_SHADOW_CASTER ) ) );
 
-            //Project the vector to the object into the camera's plane. This allows
-            //us to use depth for sorting, rather than euclidean distance
-            *distanceToCamera = cameraDir.dotProduct( objData.mWorldAabb->mCenter -
-                                                      cameraPos ) - *worldRadius;
+        //Project the vector to the object into the camera's plane. This allows
+        //us to use depth for sorting, rather than euclidean distance
+        *distanceToCamera = setup.cameraDir.dotProduct( objData.mWorldAabb->mCenter -
+                                                        setup.cameraPos ) - *worldRadius;
 
-            //Fuse result with visibility flag
-            // finalMask = ((visible|infinite_aabb) & sceneFlags & visibilityFlags) != 0 ? 0xffffffff : 0
-            ArrayMaskI finalMask = Mathlib::TestFlags4( CastRealToInt( mask ),
-                                                        Mathlib::And( sceneFlags, *visibilityFlags ) );
-            finalMask               = Mathlib::And( finalMask, isVisible );
+        //Fuse result with visibility flag
+        // finalMask = ((visible|infinite_aabb) & sceneFlags & visibilityFlags) != 0 ? 0xffffffff : 0
+        ArrayMaskI finalMask = Mathlib::TestFlags4( CastRealToInt( mask ),
+                                                    Mathlib::And( setup.sceneFlags,
+                                                                  *visibilityFlags ) );
+        finalMask               = Mathlib::And( finalMask, isVisible );
 
-            const uint32 scalarMask = BooleanMask4::getScalarMask( finalMask );
+        const uint32 scalarMask = BooleanMask4::getScalarMask( finalMask );
 
-            for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
+        for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
+        {
+            //Decompose the result for analyzing each MovableObject's
+            //There's no need to check objData.mOwner[j] is null because
+            //we set mVisibilityFlags to 0 on slot removals
+            if( IS_BIT_SET( j, scalarMask ) )
             {
-                //Decompose the result for analyzing each MovableObject's
-                //There's no need to check objData.mOwner[j] is null because
-                //we set mVisibilityFlags to 0 on slot removals
-                if( IS_BIT_SET( j, scalarMask ) )
+                culledObjects.push_back( objData.mOwner[j] );
+            }
+        }
+    }
+    //-----------------------------------------------------------------------
+    void MovableObject::cullFrustum( const size_t numNodes, ObjectData objData, const Camera *frustum,
+                                     uint32 sceneVisibilityFlags, MovableObjectArray &outCulledObjects,
+                                     const Camera *lodCamera )
+    {
+        //On threaded environments, the internal variables from outCulledObjects cause
+        //a false cache sharing because they're too close to each other. Perfoming
+        //a swap places those internal vars in the local stack, increasing scalability
+        MovableObjectArray culledObjects;
+        culledObjects.swap( outCulledObjects );
+
+        const ArrayFrustumCullSetup setup( frustum, sceneVisibilityFlags, lodCamera );
+
+        for( size_t i=0; i<numNodes; i += ARRAY_PACKED_REALS )
+        {
+            cullFrustumPack( objData, setup, true, culledObjects );
+            objData.advanceFrustumPack();
+        }
+
+        culledObjects.swap( outCulledObjects );
+    }
+    //-----------------------------------------------------------------------
+    void MovableObject::cullFrustumPacks( const uint32 *packIndices, size_t numPacks,
+                                          const ObjectData &firstObjData, const Camera *frustum,
+                                          uint32 sceneVisibilityFlags,
+                                          MovableObjectArray &outCulledObjects,
+                                          const Camera *lodCamera, bool testPlanes )
+    {
+        MovableObjectArray culledObjects;
+        culledObjects.swap( outCulledObjects );
+
+        const ArrayFrustumCullSetup setup( frustum, sceneVisibilityFlags, lodCamera );
+
+        for( size_t i=0; i<numPacks; ++i )
+        {
+            ObjectData objData = firstObjData;
+            objData.advancePack( packIndices[i] );
+            cullFrustumPack( objData, setup, testPlanes, culledObjects );
+        }
+
+        culledObjects.swap( outCulledObjects );
+    }
+    //-----------------------------------------------------------------------
+    MovableObject::MultiFrustum::MultiFrustum() :
+        cameraPos( Vector3::ZERO ),
+        cameraDir( Vector3::NEGATIVE_UNIT_Z ),
+        lodCamera( 0 ),
+        lodCameraPos( Vector3::ZERO ),
+        useRenderingDistance( true ),
+        sceneVisibilityFlags( 0 ),
+        firstRq( 0 ),
+        lastRq( 0 ),
+        valid( false )
+    {
+    }
+    //-----------------------------------------------------------------------
+    void MovableObject::MultiFrustum::set( const Camera *cullCamera, const Camera *_lodCamera,
+                                           uint32 _sceneVisibilityFlags,
+                                           uint8 _firstRq, uint8 _lastRq )
+    {
+        const Plane *frustumPlanes = cullCamera->getFrustumPlanes();
+        for( size_t i=0; i<6; ++i )
+            planes[i] = frustumPlanes[i];
+
+        const ShadowCasterVolume *cullCasterVolume = cullCamera->getShadowCasterVolume();
+        if( cullCasterVolume )
+            casterVolume = *cullCasterVolume;
+        else
+            casterVolume.clear();
+
+        cameraPos               = cullCamera->getDerivedPosition();
+        cameraDir               = -cullCamera->getDerivedOrientation().zAxis();
+        lodCamera               = _lodCamera;
+        lodCameraPos            = _lodCamera->getDerivedPosition();
+        useRenderingDistance    = _lodCamera->getUseRenderingDistance();
+        sceneVisibilityFlags    = _sceneVisibilityFlags;
+        firstRq                 = _firstRq;
+        lastRq                  = _lastRq;
+        valid                   = false;
+    }
+    //-----------------------------------------------------------------------
+    bool MovableObject::MultiFrustum::matches( const Camera *cullCamera, const Camera *_lodCamera,
+                                               uint32 _sceneVisibilityFlags ) const
+    {
+        if( !valid || lodCamera != _lodCamera || sceneVisibilityFlags != _sceneVisibilityFlags ||
+            lodCameraPos != _lodCamera->getDerivedPosition() ||
+            useRenderingDistance != _lodCamera->getUseRenderingDistance() )
+        {
+            return false;
+        }
+
+        //If a listener moved the camera after the results were
+        //calculated, we can't use them. Comparing planes catches it.
+        const Plane *frustumPlanes = cullCamera->getFrustumPlanes();
+        for( size_t i=0; i<6; ++i )
+        {
+            if( planes[i] != frustumPlanes[i] )
+                return false;
+        }
+
+        const ShadowCasterVolume *cullCasterVolume = cullCamera->getShadowCasterVolume();
+        if( cullCasterVolume ? casterVolume != *cullCasterVolume : !casterVolume.isEmpty() )
+            return false;
+
+        return true;
+    }
+    //-----------------------------------------------------------------------
+    void MovableObject::cullFrustumMulti( const size_t numNodes, ObjectData objData, uint8 renderQueue,
+                                          MultiFrustum * const *frusta, size_t numFrusta,
+                                          size_t threadIdx, FrameArena &frameArena )
+    {
+        assert( numFrusta <= MultiFrustum::MaxFrusta );
+
+        struct ArrayPlane
+        {
+            ArrayVector3    planeNormal;
+            ArrayVector3    signFlip;
+            ArrayReal       planeNegD;
+        };
+        struct ArrayFrustum
+        {
+            /// The 6 frustum planes followed by the caster volume's
+            ArrayPlane      planes[6 + ShadowCasterVolume::MaxPlanes];
+            size_t          numPlanes;
+            ArrayVector3    lodCameraPos;
+            ArrayMaskR      ignoreRenderingDistance;
+            ArrayInt        includeNonCasters;
+            ArrayInt        sceneFlags;
+        };
+
+        //Only the frusta interested in this RenderQueue
+        size_t frustumIndices[MultiFrustum::MaxFrusta];
+        size_t numActiveFrusta = 0;
+        for( size_t i=0; i<numFrusta; ++i )
+        {
+            if( renderQueue >= frusta[i]->firstRq && renderQueue < frusta[i]->lastRq )
+                frustumIndices[numActiveFrusta++] = i;
+        }
+
+        if( !numActiveFrusta || !numNodes )
+            return;
+
+        const FrameArena::Marker arenaMarker = frameArena.getMarker();
+        ArrayFrustum *arrayFrusta = frameArena.allocate<ArrayFrustum>( numActiveFrusta );
+
+        //See cullFrustum on why we swap. Also see it for details about the math.
+        MovableObjectArray culledObjects[MultiFrustum::MaxFrusta];
+
+        for( size_t i=0; i<numActiveFrusta; ++i )
+        {
+            MultiFrustum *multiFrustum = frusta[frustumIndices[i]];
+            ArrayFrustum &arrayFrustum = arrayFrusta[i];
+
+            for( size_t j=0; j<6; ++j )
+            {
+                arrayFrustum.planes[j].planeNormal.setAll( multiFrustum->planes[j].normal );
+                arrayFrustum.planes[j].signFlip.setAll( multiFrustum->planes[j].normal );
+                arrayFrustum.planes[j].signFlip.setToSign();
+                arrayFrustum.planes[j].planeNegD = Mathlib::SetAll( -multiFrustum->planes[j].d );
+            }
+
+            const ShadowCasterVolume &casterVolume = multiFrustum->casterVolume;
+            arrayFrustum.numPlanes = 6u + casterVolume.numPlanes;
+            for( size_t j=0; j<casterVolume.numPlanes; ++j )
+            {
+                ArrayPlane &arrayPlane = arrayFrustum.planes[6u + j];
+                arrayPlane.planeNormal.setAll( casterVolume.planes[j].normal );
+                arrayPlane.signFlip.setAll( casterVolume.planes[j].normal );
+                arrayPlane.signFlip.setToSign();
+                arrayPlane.planeNegD = Mathlib::SetAll( -casterVolume.planes[j].d );
+            }
+
+            arrayFrustum.lodCameraPos.setAll( multiFrustum->lodCameraPos );
+            arrayFrustum.ignoreRenderingDistance = CastIntToReal(
+                        Mathlib::SetAll( multiFrustum->useRenderingDistance ? 0 : 0xffffffff ) );
+
+            const uint32 sceneVisibilityFlags = multiFrustum->sceneVisibilityFlags;
+            arrayFrustum.includeNonCasters = Mathlib::SetAll(
+                        ((sceneVisibilityFlags & LAYER_SHADOW_CASTER) ^ -1) & LAYER_SHADOW_CASTER );
+            arrayFrustum.sceneFlags = Mathlib::SetAll( sceneVisibilityFlags &
+                                                       RESERVED_VISIBILITY_FLAGS );
+
+            culledObjects[i].swap( multiFrustum->culledObjects[threadIdx] );
+        }
+
+        for( size_t i=0; i<numNodes; i += ARRAY_PACKED_REALS )
+        {
+            ArrayInt * RESTRICT_ALIAS visibilityFlags = reinterpret_cast<ArrayInt*RESTRICT_ALIAS>
+                                                                        (objData.mVisibilityFlags);
+            ArrayReal * RESTRICT_ALIAS worldRadius = reinterpret_cast<ArrayReal*RESTRICT_ALIAS>
+                                                                        (objData.mWorldRadius);
+            ArrayReal * RESTRICT_ALIAS upperDistance = reinterpret_cast<ArrayReal*RESTRICT_ALIAS>
+                                                                        (objData.mUpperDistance);
+
+            //Everything that doesn't depend on the frustum is loaded & calculated once.
+            const ArrayVector3 center   = objData.mWorldAabb->mCenter;
+            const ArrayVector3 halfSize = objData.mWorldAabb->mHalfSize;
+            const ArrayInt objVisibilityFlags = *visibilityFlags;
+
+            ArrayMaskR isInfinite = Mathlib::Or( Mathlib::isInfinity( halfSize.mChunkBase[0] ),
+                                                 Mathlib::isInfinity( halfSize.mChunkBase[1] ) );
+            isInfinite = Mathlib::Or( Mathlib::isInfinity( halfSize.mChunkBase[2] ), isInfinite );
+
+            const ArrayReal maxDistance = *worldRadius + *upperDistance;
+            const ArrayReal maxDistanceSq = maxDistance * maxDistance;
+
+            const ArrayMaskI isVisibleLayer = Mathlib::TestFlags4( objVisibilityFlags,
+                                                                   Mathlib::SetAll( LAYER_VISIBILITY ) );
+
+            for( size_t j=0; j<numActiveFrusta; ++j )
+            {
+                const ArrayFrustum &arrayFrustum = arrayFrusta[j];
+
+                ArrayVector3 centerPlusFlippedHS;
+                centerPlusFlippedHS = center + halfSize * arrayFrustum.planes[0].signFlip;
+                ArrayMaskR mask = Mathlib::CompareGreater(
+                            arrayFrustum.planes[0].planeNormal.dotProduct( centerPlusFlippedHS ),
+                            arrayFrustum.planes[0].planeNegD );
+                for( size_t k=1; k<arrayFrustum.numPlanes; ++k )
                 {
-                    culledObjects.push_back( objData.mOwner[j] );
+                    centerPlusFlippedHS = center + halfSize * arrayFrustum.planes[k].signFlip;
+                    mask = Mathlib::And( mask, Mathlib::CompareGreater(
+                            arrayFrustum.planes[k].planeNormal.dotProduct( centerPlusFlippedHS ),
+                            arrayFrustum.planes[k].planeNegD ) );
+                }
+
+                //Squared distances are good enough (and avoid the sqrt per frustum)
+                ArrayMaskR isCloseEnough = Mathlib::CompareLessEqual(
+                            arrayFrustum.lodCameraPos.squaredDistance( center ), maxDistanceSq );
+                isCloseEnough = Mathlib::Or( arrayFrustum.ignoreRenderingDistance, isCloseEnough );
+
+                mask = Mathlib::And( Mathlib::Or( mask, isInfinite ), isCloseEnough );
+
+                ArrayMaskI isVisible = Mathlib::And( isVisibleLayer,
+                            Mathlib::TestFlags4( Mathlib::Or( objVisibilityFlags,
+                                                              arrayFrustum.includeNonCasters ),
+                                                 Mathlib::SetAll( LAYER_SHADOW_CASTER ) ) );
+
+                ArrayMaskI finalMask = Mathlib::TestFlags4( CastRealToInt( mask ),
+                                                            Mathlib::And( arrayFrustum.sceneFlags,
+                                                                          objVisibilityFlags ) );
+                finalMask = Mathlib::And( finalMask, isVisible );
+
+                const uint32 scalarMask = BooleanMask4::getScalarMask( finalMask );
+
+                if( scalarMask )
+                {
+                    for( size_t k=0; k<ARRAY_PACKED_REALS; ++k )
+                    {
+                        if( IS_BIT_SET( k, scalarMask ) )
+                            culledObjects[j].push_back( objData.mOwner[k] );
+                    }
                 }
             }
 
             objData.advanceFrustumPack();
         }
 
-        culledObjects.swap( outCulledObjects );
+        for( size_t i=0; i<numActiveFrusta; ++i )
+            culledObjects[i].swap( frusta[frustumIndices[i]]->culledObjects[threadIdx] );
+
+        frameArena.rewind( arenaMarker );
+    }
+    //-----------------------------------------------------------------------
+    void MovableObject::_updateCachedDistanceToCamera( const Vector3 &cameraPos,
+                                                       const Vector3 &cameraDir )
+    {
+        Vector3 center;
+        mObjectData.mWorldAabb->mCenter.getAsVector3( center, mObjectData.mIndex );
+        const Real distance = cameraDir.dotProduct( center - cameraPos ) -
+                              mObjectData.mWorldRadius[mObjectData.mIndex];
+        reinterpret_cast<Real*RESTRICT_ALIAS>( mObjectData.mDistanceToCamera )
+                [mObjectData.mIndex] = distance;
     }
     //-----------------------------------------------------------------------
     void MovableObject::cullLights( const size_t numNodes, ObjectData objData,
                                     LightListInfo &outGlobalLightList, const FrustumVec &frustums,
-                                    const FrustumVec &cubemapFrustums )
+                                    const FrustumVec &cubemapFrustums, FrameArena &frameArena )
     {
         struct ArrayPlane
         {
@@ -585,8 +960,8 @@ namespace Ogre {
             ArrayPlane planes[6];
         };
         const size_t numFrustums = frustums.size();
-        ArraySixPlanes *planes = OGRE_ALLOC_T_SIMD( ArraySixPlanes, numFrustums,
-                                                    MEMCATEGORY_SCENE_CONTROL );
+        const FrameArena::Marker arenaMarker = frameArena.getMarker();
+        ArraySixPlanes *planes = frameArena.allocate<ArraySixPlanes>( numFrustums );
 
         FrustumVec::const_iterator itor = frustums.begin();
         FrustumVec::const_iterator end  = frustums.end();
@@ -735,12 +1110,13 @@ namespace Ogre {
             objData.advanceCullLightPack();
         }
 
-        OGRE_FREE_SIMD( planes, MEMCATEGORY_SCENE_CONTROL );
+        frameArena.rewind( arenaMarker );
         planes = 0;
     }
     //-----------------------------------------------------------------------
     void MovableObject::buildLightList( const size_t numNodes, ObjectData objData,
-                                        const LightListInfo &globalLightList )
+                                        const LightListInfo &globalLightList,
+                                        FrameArena &frameArena )
     {
         const size_t numGlobalLights = globalLightList.lights.size();
         ArraySphere lightSphere;
@@ -814,8 +1190,8 @@ namespace Ogre {
                 //    of the dummy NullEntity pointer
                 if( !objData.mOwner[j]->mLightList.empty() )
                 {
-                    std::stable_sort( objData.mOwner[j]->mLightList.begin(),
-                                      objData.mOwner[j]->mLightList.end() );
+                    stableSortWithArena( objData.mOwner[j]->mLightList.begin(),
+                                         objData.mOwner[j]->mLightList.end(), frameArena );
                     objData.mOwner[j]->mLightList.getHash();
                 }
             }
@@ -824,6 +1200,91 @@ namespace Ogre {
         }
     }
     //-----------------------------------------------------------------------
+    void MovableObject::buildLightListBinned( const size_t numNodes, ObjectData objData,
+                                              const LightListInfo &globalLightList,
+                                              LightBinGrid &lightBinGrid, size_t threadIdx,
+                                              FrameArena &frameArena )
+    {
+        const uint32 frameId = lightBinGrid.getFrameId();
+
+        for( size_t i=0; i<numNodes; i += ARRAY_PACKED_REALS )
+        {
+            for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
+            {
+                MovableObject *owner = objData.mOwner[j];
+                if( !owner )
+                    continue;
+
+                if( !(objData.mVisibilityFlags[j] & LAYER_VISIBILITY) )
+                {
+                    //Avoid writing to shared dummies unless needed
+                    if( !owner->mLightList.empty() )
+                        owner->mLightList.clear();
+                    if( owner->mLightListFrameId )
+                        owner->mLightListFrameId = 0;
+                    continue;
+                }
+
+                const Sphere objSphere( objData.mWorldAabb->mCenter.getAsVector3( j ),
+                                        objData.mWorldRadius[j] );
+                const uint32 objLightMask = objData.mLightMask[j];
+                const Vector3 vRadius( objSphere.getRadius() );
+                const Vector3 vMin( objSphere.getCenter() - vRadius );
+                const Vector3 vMax( objSphere.getCenter() + vRadius );
+
+                if( owner->mLightListFrameId &&
+                    owner->mLightListMask == objLightMask &&
+                    owner->mLightListBounds.getCenter() == objSphere.getCenter() &&
+                    owner->mLightListBounds.getRadius() == objSphere.getRadius() &&
+                    lightBinGrid.isClean( owner->mLightListFrameId, vMin, vMax ) )
+                {
+                    owner->mLightListFrameId = frameId;
+                    lightBinGrid._notifyLightListBuilt( threadIdx, true );
+                    continue;
+                }
+
+                LightList &lightList = owner->mLightList;
+                lightList.clear();
+                lightList.dirtyHash(); //Don't calculate hash incrementally
+
+                const vector<uint32>::type &candidates = lightBinGrid.gatherLights( vMin, vMax,
+                                                                                    threadIdx );
+                vector<uint32>::type::const_iterator itor = candidates.begin();
+                vector<uint32>::type::const_iterator end  = candidates.end();
+
+                while( itor != end )
+                {
+                    const size_t lightIdx = *itor;
+                    const Sphere &lightSphere = globalLightList.boundingSphere[lightIdx];
+
+                    if( (objLightMask & globalLightList.visibilityMask[lightIdx]) &&
+                        lightSphere.intersects( objSphere ) )
+                    {
+                        const Real distance = objSphere.getCenter().distance(
+                                                  lightSphere.getCenter() ) - lightSphere.getRadius();
+                        lightList.push_back( LightClosest( globalLightList.lights[lightIdx],
+                                                           lightIdx, distance ) );
+                    }
+
+                    ++itor;
+                }
+
+                if( !lightList.empty() )
+                {
+                    stableSortWithArena( lightList.begin(), lightList.end(), frameArena );
+                    lightList.getHash();
+                }
+
+                owner->mLightListBounds     = objSphere;
+                owner->mLightListMask       = objLightMask;
+                owner->mLightListFrameId    = frameId;
+                lightBinGrid._notifyLightListBuilt( threadIdx, false );
+            }
+
+            objData.advanceLightPack();
+        }
+    }
+    //-----------------------------------------------------------------------
     void MovableObject::calculateCastersBox( const size_t numNodes, ObjectData objData,
                                              uint32 sceneVisibilityFlags, AxisAlignedBox *outBox )
     {
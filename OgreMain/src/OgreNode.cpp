@@ -363,9 +363,17 @@ namespace Ogre {
 #endif
     }
     //-----------------------------------------------------------------------
-    void Node::updateAllTransforms( const size_t numNodes, Transform t )
+    void Node::_getBackBufferTransform( Transform &outTransform ) const
+    {
+        outTransform = mTransform;
+        if( mNodeMemoryManager )
+            mNodeMemoryManager->_toBackBuffer( outTransform, mDepthLevel );
+    }
+    //-----------------------------------------------------------------------
+    void Node::updateAllTransforms( const size_t numNodes, Transform t, bool parentsFromBackBuffer )
     {
         ArrayMatrix4 derivedTransform;
+        Transform parentBackTransform;
         for( size_t i=0; i<numNodes; i += ARRAY_PACKED_REALS )
         {
             //Retrieve from parents. Unfortunately we need to do SoA -> AoS -> SoA conversion
@@ -376,7 +384,13 @@ namespace Ogre {
             {
                 Vector3 pos, scale;
                 Quaternion qRot;
-                const Transform &parentTransform = t.mParents[j]->mTransform;
+                const Transform *parentTransformPtr = &t.mParents[j]->mTransform;
+                if( parentsFromBackBuffer )
+                {
+                    t.mParents[j]->_getBackBufferTransform( parentBackTransform );
+                    parentTransformPtr = &parentBackTransform;
+                }
+                const Transform &parentTransform = *parentTransformPtr;
                 parentTransform.mDerivedPosition->getAsVector3( pos, parentTransform.mIndex );
                 parentTransform.mDerivedOrientation->getAsQuaternion( qRot, parentTransform.mIndex );
                 parentTransform.mDerivedScale->getAsVector3( scale, parentTransform.mIndex );
@@ -407,7 +421,8 @@ namespace Ogre {
                                             *t.mDerivedOrientation );
             derivedTransform.storeToAoS( t.mDerivedTransform );
 #if OGRE_DEBUG_MODE >= OGRE_DEBUG_MEDIUM
-            for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
+            //The pipelined update already did this from the main thread
+            for( size_t j=0; j<ARRAY_PACKED_REALS && !parentsFromBackBuffer; ++j )
             {
                 if( t.mOwner[j] )
                     t.mOwner[j]->mCachedTransformOutOfDate = false;
@@ -123,7 +123,8 @@ namespace Ogre {
     }
     //-----------------------------------------------------------------------
     void AbsolutePixelCountLodStrategy::lodUpdateImpl( const size_t numNodes, ObjectData objData,
-                                                       const Camera *camera, Real bias ) const
+                                                       const Camera *camera, Real bias,
+                                                       Real hysteresis, LodTransitions &outTransitions ) const
     {
         const Viewport *viewport = camera->getLastViewport();
         Real viewportArea = static_cast<Real>(viewport->getActualWidth() * viewport->getActualHeight());
@@ -159,7 +160,7 @@ namespace Ogre {
 
                 CastArrayToReal( lodValues, arrayLodValue );
 
-                lodSet( objData, lodValues );
+                lodSet( objData, lodValues, hysteresis, outTransitions );
 
                 objData.advanceLodPack();
             }
@@ -185,7 +186,7 @@ namespace Ogre {
                                             PiDotVpAreaDivOrhtoArea * lodBias;
                 CastArrayToReal( lodValues, arrayLodValue );
 
-                lodSet( objData, lodValues );
+                lodSet( objData, lodValues, hysteresis, outTransitions );
 
                 objData.advanceLodPack();
             }
@@ -226,7 +227,8 @@ namespace Ogre {
     }
     //-----------------------------------------------------------------------
     void ScreenRatioPixelCountLodStrategy::lodUpdateImpl( const size_t numNodes, ObjectData objData,
-                                                       const Camera *camera, Real bias ) const
+                                                       const Camera *camera, Real bias,
+                                                       Real hysteresis, LodTransitions &outTransitions ) const
     {
         ArrayVector3 cameraPos;
         cameraPos.setAll( camera->_getCachedDerivedPosition() );
@@ -260,7 +262,7 @@ namespace Ogre {
 
                 CastArrayToReal( lodValues, arrayLodValue );
 
-                lodSet( objData, lodValues );
+                lodSet( objData, lodValues, hysteresis, outTransitions );
 
                 objData.advanceLodPack();
             }
@@ -286,7 +288,7 @@ namespace Ogre {
                                             PiDotVpAreaDivOrhtoArea * lodBias;
                 CastArrayToReal( lodValues, arrayLodValue );
 
-                lodSet( objData, lodValues );
+                lodSet( objData, lodValues, hysteresis, outTransitions );
 
                 objData.advanceLodPack();
             }
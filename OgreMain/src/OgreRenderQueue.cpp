@@ -40,6 +40,7 @@ THE SOFTWARE.
 #include "OgreHlmsDatablock.h"
 #include "OgreHlmsManager.h"
 #include "OgreHlms.h"
+#include "OgreFrameArena.h"
 
 #include "Vao/OgreVaoManager.h"
 #include "Vao/OgreVertexArrayObject.h"
@@ -408,7 +409,9 @@ namespace Ogre
                 }
                 else if( mRenderQueues[i].mSortMode == StableSort )
                 {
-                    std::stable_sort( queuedRenderables.begin(), queuedRenderables.end() );
+                    //std::stable_sort would allocate a merge buffer from the heap every time.
+                    stableSortWithArena( queuedRenderables.begin(), queuedRenderables.end(),
+                                         mSceneManager->_getFrameArena( 0 ) );
                     mRenderQueues[i].mSorted = true;
                 }
             }
@@ -66,8 +66,10 @@ THE SOFTWARE.
 #include "Threading/OgreDefaultWorkQueue.h"
 #include "OgreFrameListener.h"
 #include "OgreWireAabb.h"
+#include "OgreGpuBillboardSet.h"
 #include "OgreNameGenerator.h"
 #include "OgreHlmsManager.h"
+#include "OgreHlmsTextureManager.h"
 #include "OgreHlmsCompute.h"
 #include "OgreHlmsLowLevel.h"
 #include "Animation/OgreSkeletonManager.h"
@@ -292,6 +294,8 @@ namespace Ogre {
         addMovableObjectFactory(mRibbonTrailFactory);
         mWireAabbFactory = OGRE_NEW WireAabbFactory();
         addMovableObjectFactory(mWireAabbFactory);
+        mGpuBillboardSetFactory = OGRE_NEW GpuBillboardSetFactory();
+        addMovableObjectFactory(mGpuBillboardSetFactory);
 
         // Load plugins
         if (!pluginFileName.empty())
@@ -388,6 +392,7 @@ namespace Ogre {
         OGRE_DELETE mBillboardChainFactory;
         OGRE_DELETE mRibbonTrailFactory;
         OGRE_DELETE mWireAabbFactory;
+        OGRE_DELETE mGpuBillboardSetFactory;
 
         OGRE_DELETE mWorkQueue;
 
@@ -952,6 +957,9 @@ namespace Ogre {
         // Tell the queue to process responses
         mWorkQueue->processResponses();
 
+        // Stream texture mips in and out
+        mHlmsManager->getTextureManager()->_update();
+
 #if OGRE_PROFILING
         if( OgreProfilerUseStableMarkers )
         {
@@ -1076,7 +1084,10 @@ namespace Ogre {
         while( itor.hasMoreElements() )
         {
             SceneManager *sceneManager = itor.getNext();
-            sceneManager->updateSceneGraph();
+            if( sceneManager->getPipelinedUpdate() )
+                sceneManager->updateSceneGraphAsync();
+            else
+                sceneManager->updateSceneGraph();
         }
 
         if (!_updateAllRenderTargets())
@@ -1109,7 +1120,10 @@ namespace Ogre {
         while( itor.hasMoreElements() )
         {
             SceneManager *sceneManager = itor.getNext();
-            sceneManager->updateSceneGraph();
+            if( sceneManager->getPipelinedUpdate() )
+                sceneManager->updateSceneGraphAsync();
+            else
+                sceneManager->updateSceneGraph();
         }
 
         if (!_updateAllRenderTargets(evt))
@@ -1557,6 +1571,7 @@ namespace Ogre {
         // update all targets but don't swap buffers
         //mActiveRenderer->_updateAllRenderTargets(false);
         mCompositorManager2->_update( *mSceneManagerEnum, mHlmsManager );
+        _waitForSceneGraphUpdates();
 
         // give client app opportunity to use queued GPU time
         bool ret = _fireFrameRenderingQueued();
@@ -1576,6 +1591,7 @@ namespace Ogre {
     {
         // update all targets but don't swap buffers
         mCompositorManager2->_update( *mSceneManagerEnum, mHlmsManager );
+        _waitForSceneGraphUpdates();
         // give client app opportunity to use queued GPU time
         bool ret = _fireFrameRenderingQueued(evt);
         // block for final swap
@@ -1590,6 +1606,17 @@ namespace Ogre {
         return ret;
     }
     //-----------------------------------------------------------------------
+    void Root::_waitForSceneGraphUpdates(void)
+    {
+        SceneManagerEnumerator::SceneManagerIterator itor = mSceneManagerEnum->getSceneManagerIterator();
+        while( itor.hasMoreElements() )
+        {
+            SceneManager *sceneManager = itor.getNext();
+            if( sceneManager->isSceneGraphUpdatePending() )
+                sceneManager->waitForSceneGraphUpdate();
+        }
+    }
+    //-----------------------------------------------------------------------
     void Root::clearEventTimes(void)
     {
         // Clear event times
@@ -68,9 +68,14 @@ THE SOFTWARE.
 #include "OgreRenderQueueListener.h"
 #include "OgreViewport.h"
 #include "OgreWireAabb.h"
+#include "OgreGpuBillboardSet.h"
 #include "OgreHlmsManager.h"
 #include "OgreForward3D.h"
 #include "OgreForwardClustered.h"
+#include "OgreSoftwareOcclusionCulling.h"
+#include "OgreStaticObjectBvh.h"
+#include "OgreLightBinGrid.h"
+#include "OgreFrameArena.h"
 #include "Animation/OgreSkeletonDef.h"
 #include "Animation/OgreSkeletonInstance.h"
 #include "Animation/OgreTagPoint.h"
@@ -93,6 +98,9 @@ uint32 SceneManager::QUERY_FRUSTUM_DEFAULT_MASK        = 0x08000000;
 //-----------------------------------------------------------------------
 SceneManager::SceneManager(const String& name, size_t numWorkerThreads,
                            InstancingThreadedCullingMethod threadedCullingMethod) :
+mAnimationFrameCount( 0 ),
+mAnimationLodCamera( 0 ),
+mAnimationLodPending( true ),
 mStaticMinDepthLevelDirty( 0 ),
 mStaticEntitiesDirty( true ),
 mPrePassMode( PrePassNone ),
@@ -143,12 +151,24 @@ mShadowTextureCustomCasterPass(0),
 mCompositorTarget( IdString(), 0 ),
 mVisibilityMask(0xFFFFFFFF & VisibilityFlags::RESERVED_VISIBILITY_FLAGS),
 mFindVisibleObjects(true),
+mMultiFrustumCulling(false),
+mShadowCasterVolumeCulling(false),
+mPreCulledFrustum(0),
+mSoftwareOcclusionCulling(0),
+mStaticObjectBvh(0),
+mLightBinGrid(0),
+mPipelinedUpdate(false),
+mPipelinedUpdatePending(false),
+mLodHysteresis(0),
+mLodFrame(0),
 mNumWorkerThreads( numWorkerThreads ),
 mUpdateBoundsRequest( 0 ),
 mInstancingThreadedCullingMethod( threadedCullingMethod ),
 mUserTask( 0 ),
 mRequestType( NUM_REQUESTS ),
 mWorkerThreadsBarrier( 0 ),
+mPipelineBarrier( 0 ),
+mStopPipelineThread( false ),
 mSuppressRenderStateChanges(false),
 mLastLightHash(0),
 mLastLightLimit(0),
@@ -190,8 +210,14 @@ mGpuParamsDirty((uint16)GPV_ALL)
     mGlobalLightListPerThread.resize( mNumWorkerThreads );
     mBuildLightListRequestPerThread.resize( mNumWorkerThreads );
     mVisibleObjects.resize( mNumWorkerThreads );
+    mCastersBoxPerThread.resize( mNumWorkerThreads );
+    mLodTransitionsPerThread.resize( mNumWorkerThreads );
     mTmpVisibleObjects.resize( mNumWorkerThreads );
 
+    mFrameArenas.reserve( mNumWorkerThreads );
+    for( size_t i=0; i<mNumWorkerThreads; ++i )
+        mFrameArenas.push_back( OGRE_NEW FrameArena() );
+
     startWorkerThreads();
 
     // Init shadow caster material for texture shadows
@@ -239,10 +265,28 @@ mGpuParamsDirty((uint16)GPV_ALL)
 //-----------------------------------------------------------------------
 SceneManager::~SceneManager()
 {
+    if( mPipelinedUpdatePending )
+        waitForSceneGraphUpdate();
+
     OGRE_DELETE mForwardPlusSystem;
     mForwardPlusSystem  = 0;
     mForwardPlusImpl    = 0;
 
+    OGRE_DELETE mSoftwareOcclusionCulling;
+    mSoftwareOcclusionCulling = 0;
+
+    OGRE_DELETE mStaticObjectBvh;
+    mStaticObjectBvh = 0;
+
+    OGRE_DELETE mLightBinGrid;
+    mLightBinGrid = 0;
+
+    FrameArenaVec::const_iterator itArena = mFrameArenas.begin();
+    FrameArenaVec::const_iterator enArena = mFrameArenas.end();
+    while( itArena != enArena )
+        OGRE_DELETE *itArena++;
+    mFrameArenas.clear();
+
     fireSceneManagerDestroyed();
     clearScene( true, false );
     destroyAllCameras();
@@ -507,6 +551,22 @@ void SceneManager::destroyAllWireAabbs(void)
     destroyAllMovableObjectsByType(WireAabbFactory::FACTORY_TYPE_NAME);
 }
 //-----------------------------------------------------------------------
+GpuBillboardSet* SceneManager::createGpuBillboardSet( SceneMemoryMgrTypes sceneType )
+{
+    return static_cast<GpuBillboardSet*>( createMovableObject( GpuBillboardSetFactory::FACTORY_TYPE_NAME,
+                                                               &mEntityMemoryManager[sceneType], 0 ) );
+}
+//-----------------------------------------------------------------------
+void SceneManager::destroyGpuBillboardSet( GpuBillboardSet *billboardSet )
+{
+    destroyMovableObject( billboardSet );
+}
+//-----------------------------------------------------------------------
+void SceneManager::destroyAllGpuBillboardSets(void)
+{
+    destroyAllMovableObjectsByType(GpuBillboardSetFactory::FACTORY_TYPE_NAME);
+}
+//-----------------------------------------------------------------------
 void SceneManager::_addWireAabb( WireAabb *wireAabb )
 {
     mTrackingWireAabbs.push_back( wireAabb );
@@ -700,6 +760,9 @@ void SceneManager::destroyAllParticleSystems(void)
 //-----------------------------------------------------------------------
 void SceneManager::clearScene( bool deleteIndestructibleToo, bool reattachCameras )
 {
+    if( mSoftwareOcclusionCulling )
+        mSoftwareOcclusionCulling->removeAllOccluders();
+
     destroyAllStaticGeometry();
     destroyAllInstanceManagers();
     destroyAllMovableObjects();
@@ -1090,13 +1153,122 @@ void SceneManager::_cullPhase01( Camera* camera, const Camera *lodCamera, Viewpo
             CullFrustumRequest cullRequest( realFirstRq, realLastRq,
                                             mIlluminationStage == IRS_RENDER_TO_TEXTURE, true, false,
                                             &mEntitiesMemoryManagerCulledList, camera, lodCamera );
+
+            if( mPreCulledFrustum )
+            {
+                const uint32 visibilityMask = (vp->getVisibilityMask() & this->getVisibilityMask()) |
+                                              (vp->getVisibilityMask() &
+                                               ~VisibilityFlags::RESERVED_VISIBILITY_FLAGS);
+                if( mPreCulledFrustum->matches( camera, lodCamera, visibilityMask ) )
+                    cullRequest.preCulled = mPreCulledFrustum;
+            }
+
+            if( mSoftwareOcclusionCulling && mIlluminationStage != IRS_RENDER_TO_TEXTURE &&
+                camera->getProjectionType() == PT_PERSPECTIVE )
+            {
+                //Rasterize the occluders (uses the worker threads) before we start culling.
+                mSoftwareOcclusionCulling->_update( camera, this );
+                cullRequest.occlusionCulling = true;
+            }
+
             fireCullFrustumThreads( cullRequest );
         }
     } // end lock on scene graph mutex
 
+    if( mPreCulledFrustum )
+    {
+        mPreCulledFrustum->valid = false;
+        mPreCulledFrustum = 0;
+    }
+
     Root::getSingleton()._popCurrentSceneManager(this);
 }
 //-----------------------------------------------------------------------
+void SceneManager::setSoftwareOcclusionCulling( bool bEnabled, uint32 width, uint32 height )
+{
+    if( bEnabled )
+    {
+        if( !mSoftwareOcclusionCulling )
+        {
+            mSoftwareOcclusionCulling = OGRE_NEW SoftwareOcclusionCulling( width, height,
+                                                                           mNumWorkerThreads );
+        }
+        else
+        {
+            mSoftwareOcclusionCulling->setResolution( width, height );
+        }
+    }
+    else
+    {
+        OGRE_DELETE mSoftwareOcclusionCulling;
+        mSoftwareOcclusionCulling = 0;
+    }
+}
+//-----------------------------------------------------------------------
+void SceneManager::setStaticBvhCulling( bool bEnabled )
+{
+    if( bEnabled && !mStaticObjectBvh )
+    {
+        mStaticObjectBvh = OGRE_NEW StaticObjectBvh( &mEntityMemoryManager[SCENE_STATIC],
+                                                     mNumWorkerThreads );
+    }
+    else if( !bEnabled )
+    {
+        OGRE_DELETE mStaticObjectBvh;
+        mStaticObjectBvh = 0;
+    }
+}
+//-----------------------------------------------------------------------
+void SceneManager::setLightBinning( bool bEnabled, Real cellSize, uint32 maxCellsPerAxis )
+{
+    OGRE_DELETE mLightBinGrid;
+    mLightBinGrid = 0;
+
+    if( bEnabled )
+        mLightBinGrid = OGRE_NEW LightBinGrid( cellSize, maxCellsPerAxis, mNumWorkerThreads );
+}
+//-----------------------------------------------------------------------
+void SceneManager::_cullPhase01Multi( MovableObject::MultiFrustum * const *frusta, size_t numFrusta )
+{
+    OgreProfileGroup( "Frustum Culling (Multi)", OGREPROF_CULLING );
+
+    if( !mFindVisibleObjects )
+        return;
+
+    OGRE_LOCK_MUTEX(sceneGraphMutex);
+
+    assert( !mEntitiesMemoryManagerCulledList.empty() );
+
+    while( numFrusta )
+    {
+        const size_t numFrustaInBatch = std::min( numFrusta,
+                                                  MovableObject::MultiFrustum::MaxFrusta );
+
+        uint8 firstRq = std::numeric_limits<uint8>::max();
+        uint8 lastRq  = 0;
+        for( size_t i=0; i<numFrustaInBatch; ++i )
+        {
+            frusta[i]->culledObjects.resize( mNumWorkerThreads );
+            firstRq = std::min( firstRq, frusta[i]->firstRq );
+            lastRq  = std::max( lastRq, frusta[i]->lastRq );
+        }
+
+        mMultiFrustumCullRequest.firstRq            = firstRq;
+        mMultiFrustumCullRequest.lastRq             = lastRq;
+        mMultiFrustumCullRequest.objectMemManager   = &mEntitiesMemoryManagerCulledList;
+        mMultiFrustumCullRequest.frusta             = frusta;
+        mMultiFrustumCullRequest.numFrusta          = numFrustaInBatch;
+        mRequestType = CULL_FRUSTUM_MULTI;
+        fireWorkerThreadsAndWait();
+
+        for( size_t i=0; i<numFrustaInBatch; ++i )
+            frusta[i]->valid = true;
+
+        frusta      += numFrustaInBatch;
+        numFrusta   -= numFrustaInBatch;
+    }
+}
+//-----------------------------------------------------------------------
 void SceneManager::_renderPhase02(Camera* camera, const Camera *lodCamera, Viewport* vp,
                                   uint8 firstRq, uint8 lastRq, bool includeOverlays)
 {
@@ -1258,6 +1430,9 @@ void SceneManager::_renderPhase02(Camera* camera, const Camera *lodCamera, Viewp
 void SceneManager::cullLights( Camera *camera, Light::LightTypes startType,
                                Light::LightTypes endType, LightArray &outLights )
 {
+    if( mLightBinGrid )
+        mLightBinGrid->_prepareCullLights( camera, &mLightMemoryManager, startType, endType );
+
     mVisibleObjects.swap( mTmpVisibleObjects );
     CullFrustumRequest cullRequest( startType, endType, false, false, true,
                                     &mLightsMemoryManagerCulledList, camera, camera );
@@ -1285,11 +1460,39 @@ void SceneManager::cullLights( Camera *camera, Light::LightTypes startType,
     }
 
     mVisibleObjects.swap( mTmpVisibleObjects );
+
+    if( mLightBinGrid )
+        mLightBinGrid->_finishCullLights();
 }
 //-----------------------------------------------------------------------
 void SceneManager::_frameEnded(void)
 {
     mRenderQueue->frameEnded();
+
+    FrameArenaVec::const_iterator itor = mFrameArenas.begin();
+    FrameArenaVec::const_iterator end  = mFrameArenas.end();
+
+    while( itor != end )
+    {
+        (*itor)->reset();
+        ++itor;
+    }
+}
+//-----------------------------------------------------------------------
+size_t SceneManager::getFrameArenaHeapAllocations(void) const
+{
+    size_t retVal = 0;
+
+    FrameArenaVec::const_iterator itor = mFrameArenas.begin();
+    FrameArenaVec::const_iterator end  = mFrameArenas.end();
+
+    while( itor != end )
+    {
+        retVal += (*itor)->getNumHeapAllocations();
+        ++itor;
+    }
+
+    return retVal;
 }
 //-----------------------------------------------------------------------
 void SceneManager::_setDestinationRenderSystem(RenderSystem* sys)
@@ -1929,6 +2132,9 @@ void SceneManager::notifyStaticAabbDirty( MovableObject *movableObject )
 {
     mStaticEntitiesDirty = true;
     movableObject->_notifyStaticDirty();
+
+    if( mStaticObjectBvh )
+        mStaticObjectBvh->_notifyObjectDirty( movableObject );
 }
 //-----------------------------------------------------------------------
 void SceneManager::notifyStaticDirty( Node *node )
@@ -1957,7 +2163,7 @@ void SceneManager::updateAllAnimationsThread( size_t threadIdx )
                                                                     itByDef->threadStarts[threadIdx+1];
             while( itor != end )
             {
-                (*itor)->update();
+                (*itor)->_updateWithLod( mAnimationFrameCount );
                 ++itor;
             }
 
@@ -2022,8 +2228,11 @@ void SceneManager::updateAnimationTransforms( BySkeletonDef &bySkeletonDef, size
 //-----------------------------------------------------------------------
 void SceneManager::updateAllAnimations()
 {
+    ++mAnimationFrameCount;
     mRequestType = UPDATE_ALL_ANIMATIONS;
     fireWorkerThreadsAndWait();
+
+    mAnimationLodPending = true;
 }
 //-----------------------------------------------------------------------
 void SceneManager::updateAllTransformsThread( const UpdateTransformRequest &request, size_t threadIdx )
@@ -2078,7 +2287,11 @@ void SceneManager::updateAllTransforms()
         ++it;
     }
 
-    //Call all listeners
+    fireNodeListeners();
+}
+//-----------------------------------------------------------------------
+void SceneManager::fireNodeListeners(void)
+{
     SceneNodeList::const_iterator itor = mSceneNodesWithListeners.begin();
     SceneNodeList::const_iterator end  = mSceneNodesWithListeners.end();
 
@@ -2156,7 +2369,8 @@ void SceneManager::updateAllTransformsTagOnTagThread( const UpdateTransformReque
     TagPoint::updateAllTransformsTagOnTag( numNodes, t );
 }
 //-----------------------------------------------------------------------
-void SceneManager::updateAllBoundsThread( const ObjectMemoryManagerVec &objectMemManager, size_t threadIdx )
+void SceneManager::updateAllBoundsThread( const ObjectMemoryManagerVec &objectMemManager,
+                                          size_t threadIdx, bool toBackBuffer )
 {
     ObjectMemoryManagerVec::const_iterator it = objectMemManager.begin();
     ObjectMemoryManagerVec::const_iterator en = objectMemManager.end();
@@ -2170,6 +2384,8 @@ void SceneManager::updateAllBoundsThread( const ObjectMemoryManagerVec &objectMe
         {
             ObjectData objData;
             const size_t totalObjs = memoryManager->getFirstObjectData( objData, i );
+            if( toBackBuffer )
+                memoryManager->_toBackBuffer( objData, i );
 
             //Distribute the work evenly across all threads (not perfect), taking into
             //account we need to distribute in multiples of ARRAY_PACKED_REALS
@@ -2184,7 +2400,7 @@ void SceneManager::updateAllBoundsThread( const ObjectMemoryManagerVec &objectMe
             numObjs = std::min( numObjs, totalObjs - toAdvance );
             objData.advancePack( toAdvance / ARRAY_PACKED_REALS );
 
-            MovableObject::updateAllBounds( numObjs, objData );
+            MovableObject::updateAllBounds( numObjs, objData, toBackBuffer );
         }
 
         ++it;
@@ -2203,6 +2419,7 @@ void SceneManager::updateAllLodsThread( const UpdateLodRequest &request, size_t
     LodStrategy *lodStrategy = LodStrategyManager::getSingleton().getDefaultStrategy();
 
     const Camera *lodCamera = request.lodCamera;
+    LodStrategy::LodTransitions transitions;
     ObjectMemoryManagerVec::const_iterator it = request.objectMemManager->begin();
     ObjectMemoryManagerVec::const_iterator en = request.objectMemManager->end();
 
@@ -2232,23 +2449,108 @@ void SceneManager::updateAllLodsThread( const UpdateLodRequest &request, size_t
             numObjs = std::min( numObjs, totalObjs - toAdvance );
             objData.advancePack( toAdvance / ARRAY_PACKED_REALS );
 
-            lodStrategy->lodUpdateImpl( numObjs, objData, lodCamera, request.lodBias );
+            lodStrategy->lodUpdateImpl( numObjs, objData, lodCamera, request.lodBias,
+                                        mLodHysteresis, transitions );
         }
 
         ++it;
     }
+
+    mLodTransitionsPerThread[threadIdx] = transitions;
 }
 //-----------------------------------------------------------------------
 void SceneManager::updateAllLods( const Camera *lodCamera, Real lodBias, uint8 firstRq, uint8 lastRq )
 {
+    ++mLodStats.numUpdates;
+
+    //Brings the derived position up to date
+    lodCamera->getFrustumPlanes();
+
+    const bool updateAnimationLods = mAnimationLodCamera ? lodCamera == mAnimationLodCamera :
+                                                           mAnimationLodPending;
+    const uint8 requestedFirstRq    = firstRq;
+    const uint8 requestedLastRq     = lastRq;
+
+    if( !mLodCache.empty() )
+    {
+        LodCacheEntry cacheEntry;
+        cacheEntry.lodCamera    = lodCamera;
+        cacheEntry.viewport     = lodCamera->getLastViewport();
+        cacheEntry.position     = lodCamera->_getCachedDerivedPosition();
+        cacheEntry.lodBias      = lodBias * lodCamera->getLodBias();
+        cacheEntry.frame        = mLodFrame;
+
+        //Skip the render queues at both ends of the range that are up to date
+        while( firstRq < lastRq && mLodCache[firstRq] == cacheEntry )
+            ++firstRq;
+        while( lastRq > firstRq && mLodCache[lastRq - 1u] == cacheEntry )
+            --lastRq;
+
+        mLodStats.numCachedRqs += (requestedLastRq - requestedFirstRq) - (lastRq - firstRq);
+
+        if( firstRq == lastRq )
+        {
+            if( updateAnimationLods )
+                updateAnimationLodValues( requestedFirstRq, requestedLastRq );
+            return;
+        }
+
+        for( size_t i=firstRq; i<lastRq; ++i )
+            mLodCache[i] = cacheEntry;
+    }
+
+    mLodStats.numEvaluatedRqs += lastRq - firstRq;
+
     mRequestType        = UPDATE_ALL_LODS;
     mUpdateLodRequest   = UpdateLodRequest( firstRq, lastRq, &mEntitiesMemoryManagerCulledList,
                                              lodCamera, lodCamera, lodBias );
 
-    mUpdateLodRequest.camera->getFrustumPlanes();
-    mUpdateLodRequest.lodCamera->getFrustumPlanes();
-
     fireWorkerThreadsAndWait();
+
+    for( size_t i=0; i<mNumWorkerThreads; ++i )
+    {
+        mLodStats.numMeshTransitions        += mLodTransitionsPerThread[i].mesh;
+        mLodStats.numMaterialTransitions    += mLodTransitionsPerThread[i].material;
+    }
+
+    if( updateAnimationLods )
+        updateAnimationLodValues( requestedFirstRq, requestedLastRq );
+}
+//-----------------------------------------------------------------------
+void SceneManager::updateAnimationLodValues( uint8 firstRq, uint8 lastRq )
+{
+    mAnimationLodPending = false;
+
+    SkeletonAnimManager::BySkeletonDefList::const_iterator itByDef =
+            mSkeletonAnimationManager.bySkeletonDefs.begin();
+    SkeletonAnimManager::BySkeletonDefList::const_iterator enByDef =
+            mSkeletonAnimationManager.bySkeletonDefs.end();
+
+    while( itByDef != enByDef )
+    {
+        FastArray<SkeletonInstance*>::const_iterator itor = itByDef->skeletons.begin();
+        FastArray<SkeletonInstance*>::const_iterator end  = itByDef->skeletons.end();
+
+        while( itor != end )
+        {
+            const MovableObject *lodSource = (*itor)->_getLodSource();
+            if( lodSource && lodSource->getRenderQueueGroup() >= firstRq &&
+                lodSource->getRenderQueueGroup() < lastRq )
+            {
+                (*itor)->_setLodValue( lodSource->getCurrentLodValue() );
+            }
+            ++itor;
+        }
+
+        ++itByDef;
+    }
+}
+//-----------------------------------------------------------------------
+void SceneManager::setLodCaching( bool bEnabled )
+{
+    mLodCache.clear();
+    if( bEnabled )
+        mLodCache.resize( 256u );
 }
 //-----------------------------------------------------------------------
 void SceneManager::instanceBatchCullFrustumThread( const InstanceBatchCullRequest &request,
@@ -2288,6 +2590,48 @@ void SceneManager::cullFrustum( const CullFrustumRequest &request, size_t thread
         }
     }
 
+    if( request.preCulled )
+    {
+        //Culling was already done by _cullPhase01Multi. Just sort by RenderQueue.
+        const MovableObject::MultiFrustum *preCulled = request.preCulled;
+        const MovableObject::MovableObjectArray &culledObjects =
+                preCulled->culledObjects[threadIdx];
+
+        MovableObject::MovableObjectArray::const_iterator itor = culledObjects.begin();
+        MovableObject::MovableObjectArray::const_iterator end  = culledObjects.end();
+
+        while( itor != end )
+        {
+            const uint8 rq = (*itor)->getRenderQueueGroup();
+            if( rq >= request.firstRq && rq < request.lastRq )
+            {
+                (*itor)->_updateCachedDistanceToCamera( preCulled->cameraPos, preCulled->cameraDir );
+                visibleObjectsPerRq[rq].push_back( *itor );
+            }
+            ++itor;
+        }
+
+        if( request.occlusionCulling )
+        {
+            for( size_t i=request.firstRq; i<request.lastRq; ++i )
+                mSoftwareOcclusionCulling->_cullOccluded( visibleObjectsPerRq[i], threadIdx );
+        }
+
+        if( request.addToRenderQueue )
+        {
+            for( size_t i=request.firstRq; i<request.lastRq; ++i )
+            {
+                if( mRenderQueue->getRenderQueueMode(i) == RenderQueue::FAST )
+                {
+                    addToRenderQueueV2( visibleObjectsPerRq[i], threadIdx,
+                                        static_cast<uint8>( i ), request.casterPass );
+                }
+            }
+        }
+
+        return;
+    }
+
     const Camera *camera    = request.camera;
     const Camera *lodCamera = request.lodCamera;
 
@@ -2308,51 +2652,118 @@ void SceneManager::cullFrustum( const CullFrustumRequest &request, size_t thread
         size_t firstRq = std::min<size_t>( request.firstRq, numRenderQueues );
         size_t lastRq  = std::min<size_t>( request.lastRq,  numRenderQueues );
 
+        const bool useStaticBvh = mStaticObjectBvh &&
+                                  memoryManager == &mEntityMemoryManager[SCENE_STATIC];
+        const bool useLightBins = mLightBinGrid && request.cullingLights &&
+                                  memoryManager == &mLightMemoryManager;
+
         for( size_t i=firstRq; i<lastRq; ++i )
         {
             MovableObject::MovableObjectArray &outVisibleObjects = *(visibleObjectsPerRq.begin() + i);
 
+            if( useStaticBvh )
+            {
+                mStaticObjectBvh->cullFrustum( i, camera, visibilityMask, outVisibleObjects,
+                                               lodCamera, threadIdx );
+            }
+            else if( useLightBins && mLightBinGrid->hasVisiblePacks( camera, i, memoryManager ) )
+            {
+                mLightBinGrid->cullLights( i, camera, visibilityMask, memoryManager,
+                                           outVisibleObjects, lodCamera, threadIdx );
+            }
+            else
+            {
+                ObjectData objData;
+                const size_t totalObjs = memoryManager->getFirstObjectData( objData, i );
+
+                //Distribute the work evenly across all threads (not perfect), taking into
+                //account we need to distribute in multiples of ARRAY_PACKED_REALS
+                size_t numObjs  = ( totalObjs + (mNumWorkerThreads-1) ) / mNumWorkerThreads;
+                numObjs         = ( (numObjs + ARRAY_PACKED_REALS - 1) / ARRAY_PACKED_REALS ) *
+                                    ARRAY_PACKED_REALS;
+
+                const size_t toAdvance = std::min( threadIdx * numObjs, totalObjs );
+
+                //Prevent going out of bounds (usually in the last threadIdx, or
+                //when there are less entities than ARRAY_PACKED_REALS
+                numObjs = std::min( numObjs, totalObjs - toAdvance );
+                objData.advancePack( toAdvance / ARRAY_PACKED_REALS );
+
+                MovableObject::cullFrustum( numObjs, objData, camera, visibilityMask,
+                                            outVisibleObjects, lodCamera );
+            }
+
+            if( request.occlusionCulling )
+                mSoftwareOcclusionCulling->_cullOccluded( outVisibleObjects, threadIdx );
+
+            if( mRenderQueue->getRenderQueueMode(i) == RenderQueue::FAST && request.addToRenderQueue )
+            {
+                addToRenderQueueV2( outVisibleObjects, threadIdx,
+                                    static_cast<uint8>( i ), request.casterPass );
+            }
+        }
+
+        ++it;
+    }
+}
+//-----------------------------------------------------------------------
+void SceneManager::addToRenderQueueV2( MovableObject::MovableObjectArray &visibleObjects,
+                                       size_t threadIdx, uint8 rq, bool casterPass )
+{
+    //V2 meshes can be added to the render queue in parallel
+    MovableObject::MovableObjectArray::const_iterator itor = visibleObjects.begin();
+    MovableObject::MovableObjectArray::const_iterator end  = visibleObjects.end();
+
+    while( itor != end )
+    {
+        RenderableArray::const_iterator itRend = (*itor)->mRenderables.begin();
+        RenderableArray::const_iterator enRend = (*itor)->mRenderables.end();
+
+        while( itRend != enRend )
+        {
+            mRenderQueue->addRenderableV2( threadIdx, rq, casterPass, *itRend, *itor );
+            ++itRend;
+        }
+        ++itor;
+    }
+
+    visibleObjects.clear();
+}
+//-----------------------------------------------------------------------
+void SceneManager::cullFrustumMulti( const MultiFrustumCullRequest &request, size_t threadIdx )
+{
+    for( size_t i=0; i<request.numFrusta; ++i )
+        request.frusta[i]->culledObjects[threadIdx].clear();
+
+    ObjectMemoryManagerVec::const_iterator it = request.objectMemManager->begin();
+    ObjectMemoryManagerVec::const_iterator en = request.objectMemManager->end();
+
+    while( it != en )
+    {
+        ObjectMemoryManager *memoryManager = *it;
+        const size_t numRenderQueues = memoryManager->getNumRenderQueues();
+
+        size_t firstRq = std::min<size_t>( request.firstRq, numRenderQueues );
+        size_t lastRq  = std::min<size_t>( request.lastRq,  numRenderQueues );
+
+        for( size_t i=firstRq; i<lastRq; ++i )
+        {
             ObjectData objData;
             const size_t totalObjs = memoryManager->getFirstObjectData( objData, i );
 
-            //Distribute the work evenly across all threads (not perfect), taking into
-            //account we need to distribute in multiples of ARRAY_PACKED_REALS
+            //Same work distribution as cullFrustum
             size_t numObjs  = ( totalObjs + (mNumWorkerThreads-1) ) / mNumWorkerThreads;
             numObjs         = ( (numObjs + ARRAY_PACKED_REALS - 1) / ARRAY_PACKED_REALS ) *
                                 ARRAY_PACKED_REALS;
 
             const size_t toAdvance = std::min( threadIdx * numObjs, totalObjs );
 
-            //Prevent going out of bounds (usually in the last threadIdx, or
-            //when there are less entities than ARRAY_PACKED_REALS
             numObjs = std::min( numObjs, totalObjs - toAdvance );
             objData.advancePack( toAdvance / ARRAY_PACKED_REALS );
 
-            MovableObject::cullFrustum( numObjs, objData, camera, visibilityMask,
-                                        outVisibleObjects, lodCamera );
-
-            if( mRenderQueue->getRenderQueueMode(i) == RenderQueue::FAST && request.addToRenderQueue )
-            {
-                //V2 meshes can be added to the render queue in parallel
-                bool casterPass = request.casterPass;
-                MovableObject::MovableObjectArray::const_iterator itor = outVisibleObjects.begin();
-                MovableObject::MovableObjectArray::const_iterator end  = outVisibleObjects.end();
-
-                while( itor != end )
-                {
-                    RenderableArray::const_iterator itRend = (*itor)->mRenderables.begin();
-                    RenderableArray::const_iterator enRend = (*itor)->mRenderables.end();
-
-                    while( itRend != enRend )
-                    {
-                        mRenderQueue->addRenderableV2( threadIdx, i, casterPass, *itRend, *itor );
-                        ++itRend;
-                    }
-                    ++itor;
-                }
-
-                outVisibleObjects.clear();
-            }
+            MovableObject::cullFrustumMulti( numObjs, objData, static_cast<uint8>( i ),
+                                             request.frusta, request.numFrusta, threadIdx,
+                                             *mFrameArenas[threadIdx] );
         }
 
         ++it;
@@ -2504,7 +2915,7 @@ void SceneManager::buildLightList()
         accumStartLightIdx += totalObjsInThread;
     }
 
-    if( accumStartLightIdx == mGlobalLightList.lights.size() )
+    if( accumStartLightIdx == mGlobalLightList.lights.size() && !mLightBinGrid )
     {
         //All of the lights were directional. We're done. Avoid the sync point with worker threads.
         return;
@@ -2566,11 +2977,13 @@ void SceneManager::buildLightList()
         dstOffset += numCollectedLights;
     }
 
-    //Now fire the threads again, to build the per-MovableObject lists
+    //Now fire the threads again, to build the per-MovableObject lists.
+    //Testing every light against every object is too expensive, so
+    //this is only done when the lights are binned. @See setLightBinning
+    if( !mLightBinGrid )
+        return;
 
-    if( mForwardPlusSystem )
-        return; //Don't do this on non-forward passes.
-    return;
+    mLightBinGrid->_update( mGlobalLightList, &mLightMemoryManager );
 
     mRequestType = BUILD_LIGHT_LIST02;
 #if OGRE_PLATFORM == OGRE_PLATFORM_EMSCRIPTEN
@@ -2579,6 +2992,8 @@ void SceneManager::buildLightList()
     mWorkerThreadsBarrier->sync(); //Fire threads
     mWorkerThreadsBarrier->sync(); //Wait them to complete
 #endif
+
+    mLightBinGrid->_mergeStats();
 }
 //-----------------------------------------------------------------------
 void SceneManager::buildLightListThread01( const BuildLightListRequest &buildLightListRequest,
@@ -2622,7 +3037,7 @@ void SceneManager::buildLightListThread01( const BuildLightListRequest &buildLig
             objData.advancePack( toAdvance / ARRAY_PACKED_REALS );
 
             Light::cullLights( numObjs, objData, threadLocalLightList,
-                               mVisibleCameras, mCubeMapCameras );
+                               mVisibleCameras, mCubeMapCameras, *mFrameArenas[threadIdx] );
         }
 
         ++it;
@@ -2662,7 +3077,17 @@ void SceneManager::buildLightListThread02( size_t threadIdx )
             numObjs = std::min( numObjs, totalObjs - toAdvance );
             objData.advancePack( toAdvance / ARRAY_PACKED_REALS );
 
-            MovableObject::buildLightList( numObjs, objData, mGlobalLightList );
+            if( mLightBinGrid )
+            {
+                MovableObject::buildLightListBinned( numObjs, objData, mGlobalLightList,
+                                                     *mLightBinGrid, threadIdx,
+                                                     *mFrameArenas[threadIdx] );
+            }
+            else
+            {
+                MovableObject::buildLightList( numObjs, objData, mGlobalLightList,
+                                               *mFrameArenas[threadIdx] );
+            }
         }
 
         ++it;
@@ -2715,8 +3140,13 @@ void SceneManager::updateSceneGraph()
         camera->_autoTrack();
     }*/
 
+    assert( !mPipelinedUpdatePending && "Call waitForSceneGraphUpdate first!" );
+
     OgreProfileGroup( "updateSceneGraph", OGREPROF_GENERAL );
 
+    ++mLodFrame;
+    mLodStats = LodStats();
+
     // Update controllers 
     ControllerManager::getSingleton().updateAllControllers();
 
@@ -2732,6 +3162,288 @@ void SceneManager::updateSceneGraph()
     updateAllBounds( mEntitiesMemoryManagerUpdateList );
     updateAllBounds( mLightsMemoryManagerCulledList );
 
+    finishSceneGraphUpdate();
+
+    //In case the pipelined update is enabled but not being used
+    restoreDelayedVisibility( mDelayedVisibilityObjects );
+}
+//-----------------------------------------------------------------------
+void SceneManager::setPipelinedUpdate( bool bEnabled )
+{
+    if( mPipelinedUpdatePending )
+        waitForSceneGraphUpdate();
+
+    if( mPipelinedUpdate == bEnabled )
+        return;
+
+    mPipelinedUpdate = bEnabled;
+
+    for( size_t i=0; i<NUM_SCENE_MEMORY_MANAGER_TYPES; ++i )
+    {
+        mNodeMemoryManager[i].setDoubleBuffered( bEnabled, this );
+        mEntityMemoryManager[i].setDoubleBuffered( bEnabled, this );
+    }
+    mLightMemoryManager.setDoubleBuffered( bEnabled, this );
+
+    if( bEnabled )
+    {
+        startPipelineThread();
+    }
+    else
+    {
+        stopPipelineThread();
+        restoreDelayedVisibility( mDelayedVisibilityObjects );
+    }
+}
+//-----------------------------------------------------------------------
+void SceneManager::_delayVisibility( MovableObject *movableObject )
+{
+    if( !movableObject->_getVisibilityDelayed() )
+    {
+        movableObject->_setVisibilityDelayed( true );
+        mDelayedVisibilityObjects.push_back( movableObject );
+    }
+}
+//-----------------------------------------------------------------------
+void SceneManager::_cancelDelayedVisibility( MovableObject *movableObject )
+{
+    if( !movableObject->_getVisibilityDelayed() )
+        return;
+
+    MovableObjectVec::iterator itor = std::find( mDelayedVisibilityObjects.begin(),
+                                                 mDelayedVisibilityObjects.end(), movableObject );
+    if( itor != mDelayedVisibilityObjects.end() )
+    {
+        efficientVectorRemove( mDelayedVisibilityObjects, itor );
+    }
+    else
+    {
+        itor = std::find( mDelayedVisibilityInFlight.begin(),
+                          mDelayedVisibilityInFlight.end(), movableObject );
+        assert( itor != mDelayedVisibilityInFlight.end() );
+        efficientVectorRemove( mDelayedVisibilityInFlight, itor );
+    }
+
+    movableObject->_setVisibilityDelayed( false );
+}
+//-----------------------------------------------------------------------
+void SceneManager::restoreDelayedVisibility( MovableObjectVec &movableObjects )
+{
+    MovableObjectVec::const_iterator itor = movableObjects.begin();
+    MovableObjectVec::const_iterator end  = movableObjects.end();
+
+    while( itor != end )
+    {
+        (*itor)->_setVisibilityDelayed( false );
+        ++itor;
+    }
+
+    movableObjects.clear();
+}
+//-----------------------------------------------------------------------
+void SceneManager::updateSceneGraphAsync(void)
+{
+    assert( mPipelinedUpdate && "Call setPipelinedUpdate( true ) first!" );
+    assert( !mPipelinedUpdatePending && "Call waitForSceneGraphUpdate first!" );
+
+    OgreProfileGroup( "updateSceneGraphAsync", OGREPROF_GENERAL );
+
+    ++mLodFrame;
+    mLodStats = LodStats();
+
+    ControllerManager::getSingleton().updateAllControllers();
+
+    highLevelCull();
+    _applySceneAnimations();
+
+    //The objects attached until now get their bounds from this update
+    assert( mDelayedVisibilityInFlight.empty() );
+    mDelayedVisibilityInFlight.swap( mDelayedVisibilityObjects );
+
+    //Snapshot the local transforms & bounds, and bring the back buffers up to date
+    //with the nodes & objects created, destroyed or moved since the last update.
+    for( size_t i=0; i<NUM_SCENE_MEMORY_MANAGER_TYPES; ++i )
+    {
+        mNodeMemoryManager[i]._syncBackBuffers();
+        mEntityMemoryManager[i]._syncBackBuffers();
+    }
+    mLightMemoryManager._syncBackBuffers();
+
+    mPipelinedTransformRequests.clear();
+
+    NodeMemoryManagerVec::const_iterator it = mNodeMemoryManagerUpdateList.begin();
+    NodeMemoryManagerVec::const_iterator en = mNodeMemoryManagerUpdateList.end();
+
+    while( it != en )
+    {
+        NodeMemoryManager *nodeMemoryManager = *it;
+        const size_t numDepths = nodeMemoryManager->getNumDepths();
+
+        assert( nodeMemoryManager->getDoubleBuffered() );
+
+        size_t start = nodeMemoryManager->getMemoryManagerType() == SCENE_STATIC ?
+                                                    mStaticMinDepthLevelDirty : 0;
+
+        for( size_t i=start; i<numDepths; ++i )
+        {
+            Transform t;
+            const size_t numNodes = nodeMemoryManager->getFirstNode( t, i );
+            nodeMemoryManager->_toBackBuffer( t, i );
+
+            if( numNodes )
+            {
+                mPipelinedTransformRequests.push_back(
+                            UpdateTransformRequest( t, numNodes, numNodes ) );
+            }
+        }
+
+        ++it;
+    }
+
+#if OGRE_DEBUG_MODE
+    {
+        //Until waitForSceneGraphUpdate, the current transforms & bounds are the ones from the
+        //last update, which is what we intend to render. Don't let the debug checks complain.
+#if OGRE_DEBUG_MODE >= OGRE_DEBUG_MEDIUM
+        vector<UpdateTransformRequest>::type::const_iterator itor = mPipelinedTransformRequests.begin();
+        vector<UpdateTransformRequest>::type::const_iterator end  = mPipelinedTransformRequests.end();
+        while( itor != end )
+        {
+            Transform t( itor->t );
+            for( size_t i=0; i<itor->numTotalNodes; i += ARRAY_PACKED_REALS )
+            {
+                for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
+                {
+                    if( t.mOwner[j] )
+                        t.mOwner[j]->_setCachedTransformUpToDate();
+                }
+                t.advancePack();
+            }
+            ++itor;
+        }
+#endif
+
+        for( size_t listIdx=0; listIdx<2u; ++listIdx )
+        {
+            const ObjectMemoryManagerVec &objMemoryManagers = listIdx == 0 ?
+                        mEntitiesMemoryManagerUpdateList : mLightsMemoryManagerCulledList;
+            ObjectMemoryManagerVec::const_iterator itObj = objMemoryManagers.begin();
+            ObjectMemoryManagerVec::const_iterator enObj = objMemoryManagers.end();
+            while( itObj != enObj )
+            {
+                const size_t numRenderQueues = (*itObj)->getNumRenderQueues();
+                for( size_t i=0; i<numRenderQueues; ++i )
+                {
+                    ObjectData objData;
+                    const size_t numObjs = (*itObj)->getFirstObjectData( objData, i );
+                    for( size_t k=0; k<numObjs; k += ARRAY_PACKED_REALS )
+                    {
+                        for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
+                        {
+                            if( objData.mOwner[j] )
+                                objData.mOwner[j]->_setCachedAabbUpToDate();
+                        }
+                        objData.advancePack();
+                    }
+                }
+                ++itObj;
+            }
+        }
+    }
+#endif
+
+    mPipelinedUpdatePending = true;
+
+#if OGRE_PLATFORM == OGRE_PLATFORM_EMSCRIPTEN
+    //No threads to overlap with
+    updateSceneGraphPipelined();
+#else
+    mPipelineBarrier->sync(); //Fire the thread, don't wait
+#endif
+}
+//-----------------------------------------------------------------------
+void SceneManager::updateSceneGraphPipelined(void)
+{
+    vector<UpdateTransformRequest>::type::const_iterator itor = mPipelinedTransformRequests.begin();
+    vector<UpdateTransformRequest>::type::const_iterator end  = mPipelinedTransformRequests.end();
+
+    while( itor != end )
+    {
+        Node::updateAllTransforms( itor->numTotalNodes, itor->t, true );
+        ++itor;
+    }
+
+    //updateAllBoundsThread splits the objects in mNumWorkerThreads slices. Do all of them.
+    for( size_t i=0; i<mNumWorkerThreads; ++i )
+    {
+        updateAllBoundsThread( mEntitiesMemoryManagerUpdateList, i, true );
+        updateAllBoundsThread( mLightsMemoryManagerCulledList, i, true );
+    }
+}
+//-----------------------------------------------------------------------
+void SceneManager::waitForSceneGraphUpdate(void)
+{
+    assert( mPipelinedUpdatePending && "Call updateSceneGraphAsync first!" );
+
+    OgreProfileGroup( "waitForSceneGraphUpdate", OGREPROF_GENERAL );
+
+#if OGRE_PLATFORM != OGRE_PLATFORM_EMSCRIPTEN
+    mPipelineBarrier->sync(); //Wait it to complete
+#endif
+    mPipelinedUpdatePending = false;
+
+    {
+        //Make the results current
+        NodeMemoryManagerVec::const_iterator itor = mNodeMemoryManagerUpdateList.begin();
+        NodeMemoryManagerVec::const_iterator end  = mNodeMemoryManagerUpdateList.end();
+        while( itor != end )
+        {
+            (*itor)->_publishBackBuffers( (*itor)->getMemoryManagerType() == SCENE_STATIC ?
+                                              mStaticMinDepthLevelDirty : 0 );
+            ++itor;
+        }
+
+        ObjectMemoryManagerVec::const_iterator itObj = mEntitiesMemoryManagerUpdateList.begin();
+        ObjectMemoryManagerVec::const_iterator enObj = mEntitiesMemoryManagerUpdateList.end();
+        while( itObj != enObj )
+            (*itObj++)->_publishBackBuffers();
+
+        itObj = mLightsMemoryManagerCulledList.begin();
+        enObj = mLightsMemoryManagerCulledList.end();
+        while( itObj != enObj )
+            (*itObj++)->_publishBackBuffers();
+    }
+
+    fireNodeListeners();
+
+    updateAllAnimations();
+    updateAllTagPoints();
+#ifdef OGRE_LEGACY_ANIMATIONS
+    updateInstanceManagerAnimations();
+#endif
+    updateInstanceManagers();
+
+    //Objects attached to TagPoints and instance batches need their bounds to be
+    //calculated after the steps above. This time the front buffer gets written to.
+    Transform tagPointTransform;
+    if( !mInstanceManagers.empty() ||
+        ( mTagPointNodeMemoryManager.getNumDepths() != 0 &&
+          mTagPointNodeMemoryManager.getFirstNode( tagPointTransform, 0 ) != 0 ) )
+    {
+        updateAllBounds( mEntitiesMemoryManagerUpdateList );
+    }
+
+    finishSceneGraphUpdate();
+
+    //Their bounds are current now
+    restoreDelayedVisibility( mDelayedVisibilityInFlight );
+}
+//-----------------------------------------------------------------------
+void SceneManager::finishSceneGraphUpdate(void)
+{
+    if( mStaticObjectBvh )
+        mStaticObjectBvh->_update();
+
     {
         // Auto-track nodes
         AutoTrackingSceneNodeVec::const_iterator itor = mAutoTrackingSceneNodes.begin();
@@ -4015,9 +4727,27 @@ void SceneManager::getMinMaxDepthRange( const Frustum *shadowMapCamera,
 }
 //---------------------------------------------------------------------
 AxisAlignedBox SceneManager::_calculateCurrentCastersBox( uint32 viewportVisibilityMask,
-                                                            uint8 _firstRq, uint8 _lastRq ) const
+                                                            uint8 firstRq, uint8 lastRq )
 {
+    mCastersBoxRequest.visibilityMask = (viewportVisibilityMask & getVisibilityMask()) |
+                                        (viewportVisibilityMask &
+                                         ~VisibilityFlags::RESERVED_VISIBILITY_FLAGS);
+    mCastersBoxRequest.firstRq  = firstRq;
+    mCastersBoxRequest.lastRq   = lastRq;
+
+    mRequestType = CALCULATE_CASTERS_BOX;
+    fireWorkerThreadsAndWait();
+
     AxisAlignedBox retVal;
+    for( size_t i=0; i<mNumWorkerThreads; ++i )
+        retVal.merge( mCastersBoxPerThread[i] );
+
+    return retVal;
+}
+//---------------------------------------------------------------------
+void SceneManager::calculateCastersBoxThread( const CastersBoxRequest &request, size_t threadIdx )
+{
+    AxisAlignedBox castersBox;
 
     ObjectMemoryManagerVec::const_iterator it = mEntitiesMemoryManagerCulledList.begin();
     ObjectMemoryManagerVec::const_iterator en = mEntitiesMemoryManagerCulledList.end();
@@ -4027,30 +4757,32 @@ AxisAlignedBox SceneManager::_calculateCurrentCastersBox( uint32 viewportVisibil
         ObjectMemoryManager *objMemoryManager = *it;
         const size_t numRenderQueues = objMemoryManager->getNumRenderQueues();
 
-        //TODO: Send this to worker threads (dark_sylinc)
-
-        size_t firstRq = std::min<size_t>( _firstRq, numRenderQueues );
-        size_t lastRq  = std::min<size_t>( _lastRq,  numRenderQueues );
+        size_t firstRq = std::min<size_t>( request.firstRq, numRenderQueues );
+        size_t lastRq  = std::min<size_t>( request.lastRq,  numRenderQueues );
 
         for( size_t i=firstRq; i<lastRq; ++i )
         {
-            AxisAlignedBox tmpBox;
-
             ObjectData objData;
-            const size_t numObjs = objMemoryManager->getFirstObjectData( objData, i );
-
-            MovableObject::calculateCastersBox( numObjs, objData,
-                                                (viewportVisibilityMask&getVisibilityMask()) |
-                                                (viewportVisibilityMask &
-                                                 ~VisibilityFlags::RESERVED_VISIBILITY_FLAGS),
-                                                &tmpBox );
-            retVal.merge( tmpBox );
+            const size_t totalObjs = objMemoryManager->getFirstObjectData( objData, i );
+
+            //Distribute the work evenly across all threads. @See cullFrustum
+            size_t numObjs  = ( totalObjs + (mNumWorkerThreads-1) ) / mNumWorkerThreads;
+            numObjs         = ( (numObjs + ARRAY_PACKED_REALS - 1) / ARRAY_PACKED_REALS ) *
+                                ARRAY_PACKED_REALS;
+
+            const size_t toAdvance = std::min( threadIdx * numObjs, totalObjs );
+            numObjs = std::min( numObjs, totalObjs - toAdvance );
+            objData.advancePack( toAdvance / ARRAY_PACKED_REALS );
+
+            AxisAlignedBox tmpBox;
+            MovableObject::calculateCastersBox( numObjs, objData, request.visibilityMask, &tmpBox );
+            castersBox.merge( tmpBox );
         }
 
         ++it;
     }
 
-    return retVal;
+    mCastersBoxPerThread[threadIdx] = castersBox;
 }
 //---------------------------------------------------------------------
 void SceneManager::propagateRelativeOrigin( SceneNode *sceneNode, const Vector3 &relativeOrigin )
@@ -5214,6 +5946,11 @@ void SceneManager::startWorkerThreads()
 void SceneManager::stopWorkerThreads()
 {
 #if OGRE_PLATFORM != OGRE_PLATFORM_EMSCRIPTEN
+    if( mPipelinedUpdatePending )
+        waitForSceneGraphUpdate();
+
+    stopPipelineThread();
+
     mRequestType = STOP_THREADS;
     fireWorkerThreadsAndWait();
 
@@ -5224,6 +5961,43 @@ void SceneManager::stopWorkerThreads()
 #endif
 }
 //---------------------------------------------------------------------
+unsigned long updatePipelineThread( ThreadHandle *threadHandle )
+{
+    SceneManager *sceneManager = reinterpret_cast<SceneManager*>( threadHandle->getUserParam() );
+    return sceneManager->_updatePipelineThread( threadHandle );
+}
+THREAD_DECLARE( updatePipelineThread );
+//---------------------------------------------------------------------
+void SceneManager::startPipelineThread(void)
+{
+#if OGRE_PLATFORM != OGRE_PLATFORM_EMSCRIPTEN
+    assert( !mPipelineBarrier );
+    mStopPipelineThread = false;
+    mPipelineBarrier = new Barrier( 2 );
+    mPipelineThread = Threads::CreateThread( THREAD_GET( updatePipelineThread ), 0, this );
+#endif
+}
+//---------------------------------------------------------------------
+void SceneManager::stopPipelineThread(void)
+{
+#if OGRE_PLATFORM != OGRE_PLATFORM_EMSCRIPTEN
+    if( !mPipelineBarrier )
+        return;
+
+    assert( !mPipelinedUpdatePending );
+
+    mStopPipelineThread = true;
+    mPipelineBarrier->sync(); //Fire thread
+    mPipelineBarrier->sync(); //Wait it to complete
+
+    Threads::WaitForThreads( 1, &mPipelineThread );
+    mPipelineThread.setNull();
+
+    delete mPipelineBarrier;
+    mPipelineBarrier = 0;
+#endif
+}
+//---------------------------------------------------------------------
 unsigned long SceneManager::_updateWorkerThread( ThreadHandle *threadHandle )
 {
 #if OGRE_PLATFORM != OGRE_PLATFORM_EMSCRIPTEN
@@ -5232,56 +6006,83 @@ unsigned long SceneManager::_updateWorkerThread( ThreadHandle *threadHandle )
     while( !exitThread )
     {
         mWorkerThreadsBarrier->sync();
-#else
-        bool exitThread = false;
-        size_t threadIdx = 0;
-#endif
-        switch( mRequestType )
-        {
-        case CULL_FRUSTUM:
-            cullFrustum( mCurrentCullFrustumRequest, threadIdx );
-            break;
-        case UPDATE_ALL_ANIMATIONS:
-            updateAllAnimationsThread( threadIdx );
-            break;
-        case UPDATE_ALL_TRANSFORMS:
-            updateAllTransformsThread( mUpdateTransformRequest, threadIdx );
-            break;
-        case UPDATE_ALL_BONE_TO_TAG_TRANSFORMS:
-            updateAllTransformsBoneToTagThread( mUpdateTransformRequest, threadIdx );
-            break;
-        case UPDATE_ALL_TAG_ON_TAG_TRANSFORMS:
-            updateAllTransformsTagOnTagThread( mUpdateTransformRequest, threadIdx );
-            break;
-        case UPDATE_ALL_BOUNDS:
-            updateAllBoundsThread( *mUpdateBoundsRequest, threadIdx );
-            break;
-        case UPDATE_ALL_LODS:
-            updateAllLodsThread( mUpdateLodRequest, threadIdx );
-            break;
-        case UPDATE_INSTANCE_MANAGERS:
-            updateInstanceManagersThread( threadIdx );
-            break;
-        case BUILD_LIGHT_LIST01:
-            buildLightListThread01( mBuildLightListRequestPerThread[threadIdx], threadIdx );
-            break;
-        case BUILD_LIGHT_LIST02:
-            buildLightListThread02( threadIdx );
-            break;
-        case USER_UNIFORM_SCALABLE_TASK:
-            mUserTask->execute( threadIdx, mNumWorkerThreads );
-            break;
-        case STOP_THREADS:
-            exitThread = true;
-            break;
-        default:
-            break;
-        }
-#if OGRE_PLATFORM != OGRE_PLATFORM_EMSCRIPTEN
+        exitThread = processWorkerRequest( threadIdx );
         mWorkerThreadsBarrier->sync();
     }
+#else
+    processWorkerRequest( 0 );
 #endif
 
     return 0;
 }
+//---------------------------------------------------------------------
+unsigned long SceneManager::_updatePipelineThread( ThreadHandle *threadHandle )
+{
+    bool exitThread = false;
+    while( !exitThread )
+    {
+        mPipelineBarrier->sync();
+        exitThread = mStopPipelineThread;
+        if( !exitThread )
+            updateSceneGraphPipelined();
+        mPipelineBarrier->sync();
+    }
+
+    return 0;
+}
+//---------------------------------------------------------------------
+bool SceneManager::processWorkerRequest( size_t threadIdx )
+{
+    bool exitThread = false;
+
+    switch( mRequestType )
+    {
+    case CULL_FRUSTUM:
+        cullFrustum( mCurrentCullFrustumRequest, threadIdx );
+        break;
+    case CULL_FRUSTUM_MULTI:
+        cullFrustumMulti( mMultiFrustumCullRequest, threadIdx );
+        break;
+    case CALCULATE_CASTERS_BOX:
+        calculateCastersBoxThread( mCastersBoxRequest, threadIdx );
+        break;
+    case UPDATE_ALL_ANIMATIONS:
+        updateAllAnimationsThread( threadIdx );
+        break;
+    case UPDATE_ALL_TRANSFORMS:
+        updateAllTransformsThread( mUpdateTransformRequest, threadIdx );
+        break;
+    case UPDATE_ALL_BONE_TO_TAG_TRANSFORMS:
+        updateAllTransformsBoneToTagThread( mUpdateTransformRequest, threadIdx );
+        break;
+    case UPDATE_ALL_TAG_ON_TAG_TRANSFORMS:
+        updateAllTransformsTagOnTagThread( mUpdateTransformRequest, threadIdx );
+        break;
+    case UPDATE_ALL_BOUNDS:
+        updateAllBoundsThread( *mUpdateBoundsRequest, threadIdx );
+        break;
+    case UPDATE_ALL_LODS:
+        updateAllLodsThread( mUpdateLodRequest, threadIdx );
+        break;
+    case UPDATE_INSTANCE_MANAGERS:
+        updateInstanceManagersThread( threadIdx );
+        break;
+    case BUILD_LIGHT_LIST01:
+        buildLightListThread01( mBuildLightListRequestPerThread[threadIdx], threadIdx );
+        break;
+    case BUILD_LIGHT_LIST02:
+        buildLightListThread02( threadIdx );
+        break;
+    case USER_UNIFORM_SCALABLE_TASK:
+        mUserTask->execute( threadIdx, mNumWorkerThreads );
+        break;
+    case STOP_THREADS:
+        exitThread = true;
+        break;
+    default:
+        break;
+    }
+
+    return exitThread;
+}
 }
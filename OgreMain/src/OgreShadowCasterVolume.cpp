@@ -0,0 +1,192 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2017 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreShadowCasterVolume.h"
+#include "OgreCamera.h"
+#include "OgreLight.h"
+#include "OgreSceneNode.h"
+#include "Math/Simple/OgreAabb.h"
+
+#include <limits>
+
+namespace Ogre
+{
+    //Indices to the corners, @see Frustum::getWorldSpaceCorners
+    static const uint8 c_faceCorners[6][3] =
+    {
+        { 0, 1, 2 },    //Near
+        { 4, 5, 6 },    //Far
+        { 1, 5, 6 },    //Left
+        { 0, 3, 7 },    //Right
+        { 0, 4, 5 },    //Top
+        { 2, 6, 7 },    //Bottom
+    };
+    //Both corners of each edge, followed by the two faces sharing it.
+    static const uint8 c_edges[12][4] =
+    {
+        { 0, 1, 0, 4 }, { 1, 2, 0, 2 }, { 2, 3, 0, 5 }, { 3, 0, 0, 3 },
+        { 4, 5, 1, 4 }, { 5, 6, 1, 2 }, { 6, 7, 1, 5 }, { 7, 4, 1, 3 },
+        { 0, 4, 4, 3 }, { 1, 5, 4, 2 }, { 2, 6, 5, 2 }, { 3, 7, 5, 3 },
+    };
+    //-----------------------------------------------------------------------------------
+    static void orientInwards( Plane &plane, const Vector3 &interiorPoint )
+    {
+        if( plane.getDistance( interiorPoint ) < 0 )
+        {
+            plane.normal = -plane.normal;
+            plane.d = -plane.d;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void ShadowCasterVolume::build( const Vector3 corners[8], const Light *light )
+    {
+        numPlanes = 0;
+
+        Vector3 centre( Vector3::ZERO );
+        for( size_t i=0; i<8; ++i )
+            centre += corners[i];
+        centre *= 0.125f;
+
+        const bool isDirectional = light->getType() == Light::LT_DIRECTIONAL;
+        const Vector3 toLight = -light->getDerivedDirection();
+        const Vector3 lightPos = light->getParentNode()->_getDerivedPosition();
+
+        //Keep the faces the extrusion doesn't cross (i.e. the light is on their inner side).
+        Plane faces[6];
+        bool facesLight[6];
+        for( size_t i=0; i<6; ++i )
+        {
+            const Vector3 &p0 = corners[c_faceCorners[i][0]];
+            const Vector3 &p1 = corners[c_faceCorners[i][1]];
+            const Vector3 &p2 = corners[c_faceCorners[i][2]];
+            if( (p1 - p0).crossProduct( p2 - p0 ).isZeroLength() )
+                return; //Degenerate receivers. Don't cull anything.
+
+            faces[i].redefine( p0, p1, p2 );
+            orientInwards( faces[i], centre );
+
+            facesLight[i] = isDirectional ? faces[i].normal.dotProduct( toLight ) >= 0 :
+                                            faces[i].getDistance( lightPos ) >= 0;
+            if( facesLight[i] )
+                planes[numPlanes++] = faces[i];
+        }
+
+        //Close the volume with the planes that contain the silhouette edges (as seen
+        //from the light) and the light, either its direction or its position.
+        for( size_t i=0; i<12; ++i )
+        {
+            if( facesLight[c_edges[i][2]] != facesLight[c_edges[i][3]] )
+            {
+                const Vector3 &a = corners[c_edges[i][0]];
+                const Vector3 &b = corners[c_edges[i][1]];
+                Vector3 normal = (b - a).crossProduct( isDirectional ? toLight : (lightPos - a) );
+
+                //Dropping a plane only makes the volume bigger, so it's always safe.
+                if( !normal.isZeroLength() )
+                {
+                    normal.normalise();
+                    Plane plane( normal, a );
+                    orientInwards( plane, centre );
+                    planes[numPlanes++] = plane;
+                }
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void ShadowCasterVolume::build( const Camera *camera, Real nearDist, Real farDist,
+                                    const Light *light )
+    {
+        Vector3 corners[8];
+        getReceiverCorners( camera, nearDist, farDist, corners );
+        build( corners, light );
+    }
+    //-----------------------------------------------------------------------------------
+    void ShadowCasterVolume::getReceiverCorners( const Camera *camera, Real nearDist, Real farDist,
+                                                 Vector3 outCorners[8] )
+    {
+        assert( farDist > nearDist && "The receiver region must be finite" );
+
+        const Vector3 *cameraCorners = camera->getWorldSpaceCorners();
+        const Real cameraNear = camera->getNearClipDistance();
+
+        if( camera->getProjectionType() == PT_PERSPECTIVE )
+        {
+            const Vector3 cameraPos = camera->getDerivedPosition();
+            for( size_t i=0; i<4; ++i )
+            {
+                const Vector3 dir = (cameraCorners[i] - cameraPos) / cameraNear;
+                outCorners[i]      = cameraPos + dir * nearDist;
+                outCorners[i + 4u] = cameraPos + dir * farDist;
+            }
+        }
+        else
+        {
+            const Vector3 cameraDir = -camera->getDerivedOrientation().zAxis();
+            for( size_t i=0; i<4; ++i )
+            {
+                outCorners[i]      = cameraCorners[i] + cameraDir * (nearDist - cameraNear);
+                outCorners[i + 4u] = cameraCorners[i] + cameraDir * (farDist - cameraNear);
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    bool ShadowCasterVolume::isVisible( const Aabb &box ) const
+    {
+        //Same as the SIMD version, infinite boxes always pass
+        const Real infinity = std::numeric_limits<Real>::infinity();
+        if( box.mHalfSize.x == infinity || box.mHalfSize.y == infinity ||
+            box.mHalfSize.z == infinity )
+        {
+            return true;
+        }
+
+        for( size_t i=0; i<numPlanes; ++i )
+        {
+            if( planes[i].getSide( box.mCenter, box.mHalfSize ) == Plane::NEGATIVE_SIDE )
+                return false;
+        }
+
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    bool ShadowCasterVolume::operator == ( const ShadowCasterVolume &other ) const
+    {
+        if( numPlanes != other.numPlanes )
+            return false;
+
+        for( size_t i=0; i<numPlanes; ++i )
+        {
+            if( planes[i] != other.planes[i] )
+                return false;
+        }
+
+        return true;
+    }
+}
@@ -0,0 +1,587 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2017 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreSoftwareOcclusionCulling.h"
+#include "OgreSceneManager.h"
+#include "OgreCamera.h"
+#include "OgreRoot.h"
+#include "OgreTimer.h"
+#include "Math/Array/OgreArrayConfig.h"
+
+namespace Ogre
+{
+    SoftwareOcclusionCulling::Stats::Stats() :
+        numOccluders( 0 ),
+        numTriangles( 0 ),
+        numTested( 0 ),
+        numCulled( 0 ),
+        setupMicroseconds( 0 ),
+        rasterMicroseconds( 0 ),
+        testMicroseconds( 0 )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    Real SoftwareOcclusionCulling::Stats::getCulledPercentage(void) const
+    {
+        return numTested ? Real( numCulled * 100u ) / Real( numTested ) : Real( 0 );
+    }
+    //-----------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------
+    SoftwareOcclusionCulling::SoftwareOcclusionCulling( uint32 width, uint32 height,
+                                                        size_t numThreads ) :
+        mWidth( 0 ),
+        mHeight( 0 ),
+        mNumTilesX( 0 ),
+        mNumTilesY( 0 ),
+        mDepthBuffer( 0 ),
+        mHiZBuffer( 0 ),
+        mViewProjMatrix( Matrix4::IDENTITY ),
+        mNearPlane( 0 ),
+        mLastCamera( 0 ),
+        mLastFrame( std::numeric_limits<unsigned long>::max() )
+    {
+        ThreadStats threadStats;
+        memset( &threadStats, 0, sizeof( ThreadStats ) );
+        mThreadStats.resize( numThreads, threadStats );
+
+        setResolution( width, height );
+    }
+    //-----------------------------------------------------------------------------------
+    SoftwareOcclusionCulling::~SoftwareOcclusionCulling()
+    {
+        OGRE_FREE_SIMD( mDepthBuffer, MEMCATEGORY_SCENE_CONTROL );
+        mDepthBuffer = 0;
+        OGRE_FREE_SIMD( mHiZBuffer, MEMCATEGORY_SCENE_CONTROL );
+        mHiZBuffer = 0;
+    }
+    //-----------------------------------------------------------------------------------
+    void SoftwareOcclusionCulling::setResolution( uint32 width, uint32 height )
+    {
+        //TileSize is a multiple of ARRAY_PACKED_REALS, so rows stay aligned.
+        width   = static_cast<uint32>( alignToNextMultiple( std::max( width, 1u ), TileSize ) );
+        height  = static_cast<uint32>( alignToNextMultiple( std::max( height, 1u ), TileSize ) );
+
+        if( mWidth == width && mHeight == height )
+            return;
+
+        OGRE_FREE_SIMD( mDepthBuffer, MEMCATEGORY_SCENE_CONTROL );
+        OGRE_FREE_SIMD( mHiZBuffer, MEMCATEGORY_SCENE_CONTROL );
+
+        mWidth      = width;
+        mHeight     = height;
+        mNumTilesX  = width / TileSize;
+        mNumTilesY  = height / TileSize;
+
+        mDepthBuffer = reinterpret_cast<float*>( OGRE_MALLOC_SIMD( sizeof(float) * mWidth * mHeight,
+                                                                   MEMCATEGORY_SCENE_CONTROL ) );
+        mHiZBuffer = reinterpret_cast<float*>( OGRE_MALLOC_SIMD( sizeof(float) *
+                                                                 mNumTilesX * mNumTilesY,
+                                                                 MEMCATEGORY_SCENE_CONTROL ) );
+        memset( mDepthBuffer, 0, sizeof(float) * mWidth * mHeight );
+        memset( mHiZBuffer, 0, sizeof(float) * mNumTilesX * mNumTilesY );
+
+        mLastCamera = 0;
+    }
+    //-----------------------------------------------------------------------------------
+    void SoftwareOcclusionCulling::addOccluder( MovableObject *owner,
+                                                const Vector3 *vertices, size_t numVertices,
+                                                const uint32 *indices, size_t numIndices )
+    {
+        assert( numIndices % 3u == 0 );
+
+        Occluder *occluder = 0;
+        OccluderVec::iterator itor = mOccluders.begin();
+        OccluderVec::iterator end  = mOccluders.end();
+        while( itor != end && !occluder )
+        {
+            if( itor->owner == owner )
+                occluder = &(*itor);
+            ++itor;
+        }
+
+        if( !occluder )
+        {
+            mOccluders.push_back( Occluder() );
+            occluder = &mOccluders.back();
+            occluder->owner = owner;
+        }
+
+        occluder->vertices.assign( vertices, vertices + numVertices );
+        occluder->indices.assign( indices, indices + numIndices );
+
+        mLastCamera = 0;
+    }
+    //-----------------------------------------------------------------------------------
+    void SoftwareOcclusionCulling::addBoxOccluder( MovableObject *owner )
+    {
+        const Aabb aabb = owner->getLocalAabb();
+        const Vector3 minimum = aabb.getMinimum();
+        const Vector3 maximum = aabb.getMaximum();
+
+        const Vector3 vertices[8] =
+        {
+            Vector3( minimum.x, minimum.y, minimum.z ),
+            Vector3( maximum.x, minimum.y, minimum.z ),
+            Vector3( maximum.x, maximum.y, minimum.z ),
+            Vector3( minimum.x, maximum.y, minimum.z ),
+            Vector3( minimum.x, minimum.y, maximum.z ),
+            Vector3( maximum.x, minimum.y, maximum.z ),
+            Vector3( maximum.x, maximum.y, maximum.z ),
+            Vector3( minimum.x, maximum.y, maximum.z )
+        };
+        const uint32 indices[36] =
+        {
+            0, 2, 1, 2, 0, 3,   4, 5, 6, 6, 7, 4,   0, 1, 5, 5, 4, 0,
+            3, 6, 2, 6, 3, 7,   1, 2, 6, 6, 5, 1,   0, 4, 7, 7, 3, 0
+        };
+
+        addOccluder( owner, vertices, 8u, indices, 36u );
+    }
+    //-----------------------------------------------------------------------------------
+    void SoftwareOcclusionCulling::removeOccluder( MovableObject *owner )
+    {
+        OccluderVec::iterator itor = mOccluders.begin();
+        OccluderVec::iterator end  = mOccluders.end();
+        while( itor != end && itor->owner != owner )
+            ++itor;
+
+        if( itor != end )
+        {
+            efficientVectorRemove( mOccluders, itor );
+            mLastCamera = 0;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void SoftwareOcclusionCulling::removeAllOccluders(void)
+    {
+        mOccluders.clear();
+        mLastCamera = 0;
+    }
+    //-----------------------------------------------------------------------------------
+    void SoftwareOcclusionCulling::addTriangle( const Vector4 clipPos[3] )
+    {
+        //Trivially reject triangles fully outside one of the side planes
+        if( (clipPos[0].x >  clipPos[0].w && clipPos[1].x >  clipPos[1].w &&
+             clipPos[2].x >  clipPos[2].w) ||
+            (clipPos[0].x < -clipPos[0].w && clipPos[1].x < -clipPos[1].w &&
+             clipPos[2].x < -clipPos[2].w) ||
+            (clipPos[0].y >  clipPos[0].w && clipPos[1].y >  clipPos[1].w &&
+             clipPos[2].y >  clipPos[2].w) ||
+            (clipPos[0].y < -clipPos[0].w && clipPos[1].y < -clipPos[1].w &&
+             clipPos[2].y < -clipPos[2].w) )
+        {
+            return;
+        }
+
+        //Clip against the near plane (w >= near). Produces up to 4 vertices.
+        Vector4 clipped[4];
+        size_t numClipped = 0;
+        for( size_t i=0; i<3u; ++i )
+        {
+            const Vector4 &a = clipPos[i];
+            const Vector4 &b = clipPos[(i + 1u) % 3u];
+            const bool aInside = a.w >= mNearPlane;
+            const bool bInside = b.w >= mNearPlane;
+
+            if( aInside )
+                clipped[numClipped++] = a;
+            if( aInside != bInside )
+            {
+                const Real t = (mNearPlane - a.w) / (b.w - a.w);
+                clipped[numClipped++] = a + (b - a) * t;
+            }
+        }
+
+        if( numClipped < 3u )
+            return;
+
+        Real screenX[4], screenY[4], screenIz[4];
+        for( size_t i=0; i<numClipped; ++i )
+        {
+            const Real invW = Real( 1.0 ) / clipped[i].w;
+            screenX[i]  = ( clipped[i].x * invW * Real( 0.5 ) + Real( 0.5 ) ) * Real( mWidth );
+            screenY[i]  = ( Real( 0.5 ) - clipped[i].y * invW * Real( 0.5 ) ) * Real( mHeight );
+            screenIz[i] = invW;
+        }
+
+        //Triangle fan
+        for( size_t i=2u; i<numClipped; ++i )
+        {
+            const size_t idx[3] = { 0, i - 1u, i };
+
+            ScreenTriangle tri;
+            Real minY = std::numeric_limits<Real>::max();
+            Real maxY = -std::numeric_limits<Real>::max();
+            for( size_t j=0; j<3u; ++j )
+            {
+                tri.x[j]    = screenX[idx[j]];
+                tri.y[j]    = screenY[idx[j]];
+                tri.iz[j]   = screenIz[idx[j]];
+                minY = std::min( minY, tri.y[j] );
+                maxY = std::max( maxY, tri.y[j] );
+            }
+
+            tri.minY = static_cast<int32>( Math::Floor( std::max( minY, Real( 0 ) ) ) );
+            tri.maxY = static_cast<int32>( Math::Ceil( std::min( maxY, Real( mHeight ) ) ) );
+
+            if( tri.minY < tri.maxY )
+                mTriangles.push_back( tri );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void SoftwareOcclusionCulling::_update( const Camera *camera, SceneManager *sceneManager )
+    {
+        const unsigned long currentFrame = Root::getSingleton().getNextFrameNumber();
+        const Matrix4 viewProjMatrix = camera->getProjectionMatrix() * camera->getViewMatrix( true );
+
+        if( mLastCamera == camera && mLastFrame == currentFrame && mViewProjMatrix == viewProjMatrix )
+            return;
+
+        mLastCamera     = camera;
+        mLastFrame      = currentFrame;
+        mViewProjMatrix = viewProjMatrix;
+        mNearPlane      = camera->getNearClipDistance();
+
+        Timer timer;
+
+        mStats = Stats();
+        {
+            ThreadStatsVec::iterator itor = mThreadStats.begin();
+            ThreadStatsVec::iterator end  = mThreadStats.end();
+            while( itor != end )
+            {
+                itor->numTested = 0;
+                itor->numCulled = 0;
+                itor->testMicroseconds = 0;
+                ++itor;
+            }
+        }
+
+        mTriangles.clear();
+
+        OccluderVec::const_iterator itor = mOccluders.begin();
+        OccluderVec::const_iterator end  = mOccluders.end();
+
+        while( itor != end )
+        {
+            if( itor->owner->isAttached() && itor->owner->isVisible() )
+            {
+                const Matrix4 worldViewProj = mViewProjMatrix *
+                                              itor->owner->_getParentNodeFullTransform();
+
+                const size_t numIndices = itor->indices.size();
+                for( size_t i=0; i<numIndices; i += 3u )
+                {
+                    Vector4 clipPos[3];
+                    for( size_t j=0; j<3u; ++j )
+                        clipPos[j] = worldViewProj * Vector4( itor->vertices[itor->indices[i+j]] );
+
+                    addTriangle( clipPos );
+                }
+
+                ++mStats.numOccluders;
+            }
+
+            ++itor;
+        }
+
+        mStats.numTriangles = mTriangles.size();
+        mStats.setupMicroseconds = timer.getMicroseconds();
+
+        timer.reset();
+        sceneManager->executeUserScalableTask( this, true );
+        mStats.rasterMicroseconds = timer.getMicroseconds();
+    }
+    //-----------------------------------------------------------------------------------
+    void SoftwareOcclusionCulling::execute( size_t threadId, size_t numThreads )
+    {
+        //Each thread owns a range of tile rows, so there's no contention.
+        const uint32 tileRowStart = static_cast<uint32>( (mNumTilesY * threadId) / numThreads );
+        const uint32 tileRowEnd   = static_cast<uint32>( (mNumTilesY * (threadId + 1u)) / numThreads );
+
+        if( tileRowStart == tileRowEnd )
+            return;
+
+        const uint32 rowStart = tileRowStart * TileSize;
+        const uint32 rowEnd   = tileRowEnd * TileSize;
+
+        memset( mDepthBuffer + rowStart * mWidth, 0, sizeof(float) * (rowEnd - rowStart) * mWidth );
+
+        ScreenTriangleVec::const_iterator itor = mTriangles.begin();
+        ScreenTriangleVec::const_iterator end  = mTriangles.end();
+
+        while( itor != end )
+        {
+            if( itor->maxY > static_cast<int32>( rowStart ) &&
+                itor->minY < static_cast<int32>( rowEnd ) )
+            {
+                rasterizeTriangle( *itor, rowStart, rowEnd );
+            }
+            ++itor;
+        }
+
+        buildHiZ( tileRowStart, tileRowEnd );
+    }
+    //-----------------------------------------------------------------------------------
+    void SoftwareOcclusionCulling::rasterizeTriangle( const ScreenTriangle &tri,
+                                                      uint32 rowStart, uint32 rowEnd )
+    {
+        //Edge functions: e_i( x, y ) = a_i * x + b_i * y + c_i, where edge i
+        //is the one opposite to vertex i. Positive inside the triangle.
+        Real a[3], b[3], c[3];
+        for( size_t i=0; i<3u; ++i )
+        {
+            const size_t i1 = (i + 1u) % 3u;
+            const size_t i2 = (i + 2u) % 3u;
+            a[i] = tri.y[i1] - tri.y[i2];
+            b[i] = tri.x[i2] - tri.x[i1];
+            c[i] = tri.x[i1] * tri.y[i2] - tri.x[i2] * tri.y[i1];
+        }
+
+        Real area = a[0] * tri.x[0] + b[0] * tri.y[0] + c[0];
+        if( Math::Abs( area ) < Real( 1e-6 ) )
+            return;
+
+        //Occluders are rasterized regardless of winding
+        if( area < 0 )
+        {
+            for( size_t i=0; i<3u; ++i )
+            {
+                a[i] = -a[i];
+                b[i] = -b[i];
+                c[i] = -c[i];
+            }
+            area = -area;
+        }
+
+        //1/w is linear in screen space
+        const Real invArea = Real( 1.0 ) / area;
+        const Real izA = (a[0] * tri.iz[0] + a[1] * tri.iz[1] + a[2] * tri.iz[2]) * invArea;
+        const Real izB = (b[0] * tri.iz[0] + b[1] * tri.iz[1] + b[2] * tri.iz[2]) * invArea;
+        const Real izC = (c[0] * tri.iz[0] + c[1] * tri.iz[1] + c[2] * tri.iz[2]) * invArea;
+
+        const Real minX = std::min( std::min( tri.x[0], tri.x[1] ), tri.x[2] );
+        const Real maxX = std::max( std::max( tri.x[0], tri.x[1] ), tri.x[2] );
+
+        int32 startX = static_cast<int32>( Math::Floor( std::max( minX, Real( 0 ) ) ) );
+        int32 endX   = static_cast<int32>( Math::Ceil( std::min( maxX, Real( mWidth ) ) ) );
+        if( startX >= endX )
+            return;
+        //Align to ARRAY_PACKED_REALS. Rows are padded, so we can't write out of bounds.
+        startX -= startX % ARRAY_PACKED_REALS;
+
+        const uint32 startY = std::max<uint32>( static_cast<uint32>( tri.minY ), rowStart );
+        const uint32 endY   = std::min<uint32>( static_cast<uint32>( tri.maxY ), rowEnd );
+
+        OGRE_ALIGNED_DECL( Real, laneOffsets[ARRAY_PACKED_REALS], OGRE_SIMD_ALIGNMENT );
+        for( size_t i=0; i<ARRAY_PACKED_REALS; ++i )
+            laneOffsets[i] = Real( i );
+
+        const ArrayReal aA0 = Mathlib::SetAll( a[0] );
+        const ArrayReal aA1 = Mathlib::SetAll( a[1] );
+        const ArrayReal aA2 = Mathlib::SetAll( a[2] );
+        const ArrayReal aIzA = Mathlib::SetAll( izA );
+        const ArrayReal zero = Mathlib::SetAll( Real( 0 ) );
+        const ArrayReal laneStep = *reinterpret_cast<const ArrayReal*>( laneOffsets );
+
+        for( uint32 y=startY; y<endY; ++y )
+        {
+            const Real py = Real( y ) + Real( 0.5 );
+            const ArrayReal rowE0 = Mathlib::SetAll( b[0] * py + c[0] );
+            const ArrayReal rowE1 = Mathlib::SetAll( b[1] * py + c[1] );
+            const ArrayReal rowE2 = Mathlib::SetAll( b[2] * py + c[2] );
+            const ArrayReal rowIz = Mathlib::SetAll( izB * py + izC );
+
+            ArrayReal * RESTRICT_ALIAS depth = reinterpret_cast<ArrayReal*RESTRICT_ALIAS>(
+                        mDepthBuffer + y * mWidth + startX );
+
+            for( int32 x=startX; x<endX; x += ARRAY_PACKED_REALS )
+            {
+                const ArrayReal px = Mathlib::SetAll( Real( x ) + Real( 0.5 ) ) + laneStep;
+
+                ArrayMaskR inside = Mathlib::CompareGreaterEqual( aA0 * px + rowE0, zero );
+                inside = Mathlib::And( inside,
+                                       Mathlib::CompareGreaterEqual( aA1 * px + rowE1, zero ) );
+                inside = Mathlib::And( inside,
+                                       Mathlib::CompareGreaterEqual( aA2 * px + rowE2, zero ) );
+
+                const ArrayReal iz = aIzA * px + rowIz;
+                *depth = Mathlib::Cmov4( Mathlib::Max( *depth, iz ), *depth, inside );
+                ++depth;
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void SoftwareOcclusionCulling::buildHiZ( uint32 tileRowStart, uint32 tileRowEnd )
+    {
+        for( uint32 tileY=tileRowStart; tileY<tileRowEnd; ++tileY )
+        {
+            for( uint32 tileX=0; tileX<mNumTilesX; ++tileX )
+            {
+                ArrayReal farthest = Mathlib::SetAll( std::numeric_limits<Real>::max() );
+                for( uint32 y=0; y<TileSize; ++y )
+                {
+                    const ArrayReal * RESTRICT_ALIAS depth =
+                            reinterpret_cast<const ArrayReal*RESTRICT_ALIAS>(
+                                mDepthBuffer + (tileY * TileSize + y) * mWidth + tileX * TileSize );
+                    for( uint32 x=0; x<TileSize; x += ARRAY_PACKED_REALS )
+                        farthest = Mathlib::Min( farthest, *depth++ );
+                }
+
+                mHiZBuffer[tileY * mNumTilesX + tileX] = Mathlib::CollapseMin( farthest );
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    bool SoftwareOcclusionCulling::isVisible( const Aabb &worldAabb ) const
+    {
+        const Real infinity = std::numeric_limits<Real>::infinity();
+        if( worldAabb.mHalfSize.x == infinity || worldAabb.mHalfSize.y == infinity ||
+            worldAabb.mHalfSize.z == infinity )
+        {
+            return true;
+        }
+
+        Real minX = std::numeric_limits<Real>::max();
+        Real minY = std::numeric_limits<Real>::max();
+        Real maxX = -std::numeric_limits<Real>::max();
+        Real maxY = -std::numeric_limits<Real>::max();
+        Real closestIz = 0;
+
+        for( size_t i=0; i<8u; ++i )
+        {
+            const Vector3 corner( worldAabb.mCenter.x + ((i & 0x01) ? worldAabb.mHalfSize.x :
+                                                                      -worldAabb.mHalfSize.x),
+                                  worldAabb.mCenter.y + ((i & 0x02) ? worldAabb.mHalfSize.y :
+                                                                      -worldAabb.mHalfSize.y),
+                                  worldAabb.mCenter.z + ((i & 0x04) ? worldAabb.mHalfSize.z :
+                                                                      -worldAabb.mHalfSize.z) );
+            const Vector4 clipPos = mViewProjMatrix * Vector4( corner );
+
+            //Crosses the near plane; the camera may be inside it.
+            if( clipPos.w < mNearPlane )
+                return true;
+
+            const Real invW = Real( 1.0 ) / clipPos.w;
+            const Real x = ( clipPos.x * invW * Real( 0.5 ) + Real( 0.5 ) ) * Real( mWidth );
+            const Real y = ( Real( 0.5 ) - clipPos.y * invW * Real( 0.5 ) ) * Real( mHeight );
+            minX = std::min( minX, x );
+            maxX = std::max( maxX, x );
+            minY = std::min( minY, y );
+            maxY = std::max( maxY, y );
+            closestIz = std::max( closestIz, invW );
+        }
+
+        const int32 startX = static_cast<int32>( Math::Floor( std::max( minX, Real( 0 ) ) ) );
+        const int32 startY = static_cast<int32>( Math::Floor( std::max( minY, Real( 0 ) ) ) );
+        const int32 endX   = static_cast<int32>( Math::Ceil( std::min( maxX, Real( mWidth ) ) ) );
+        const int32 endY   = static_cast<int32>( Math::Ceil( std::min( maxY, Real( mHeight ) ) ) );
+
+        //Off screen. Frustum culling said it was visible, so don't argue.
+        if( startX >= endX || startY >= endY )
+            return true;
+
+        const int32 tileStartX  = startX / static_cast<int32>( TileSize );
+        const int32 tileStartY  = startY / static_cast<int32>( TileSize );
+        const int32 tileEndX    = (endX - 1) / static_cast<int32>( TileSize );
+        const int32 tileEndY    = (endY - 1) / static_cast<int32>( TileSize );
+
+        for( int32 tileY=tileStartY; tileY<=tileEndY; ++tileY )
+        {
+            for( int32 tileX=tileStartX; tileX<=tileEndX; ++tileX )
+            {
+                //The whole tile is closer than the object. Occluded here.
+                if( mHiZBuffer[tileY * mNumTilesX + tileX] > closestIz )
+                    continue;
+
+                //Inconclusive. Look at the individual pixels.
+                const int32 pixelStartX = std::max<int32>( startX, tileX * TileSize );
+                const int32 pixelStartY = std::max<int32>( startY, tileY * TileSize );
+                const int32 pixelEndX   = std::min<int32>( endX, (tileX + 1) * TileSize );
+                const int32 pixelEndY   = std::min<int32>( endY, (tileY + 1) * TileSize );
+
+                for( int32 y=pixelStartY; y<pixelEndY; ++y )
+                {
+                    const float *depth = mDepthBuffer + y * mWidth;
+                    for( int32 x=pixelStartX; x<pixelEndX; ++x )
+                    {
+                        if( depth[x] <= closestIz )
+                            return true;
+                    }
+                }
+            }
+        }
+
+        return false;
+    }
+    //-----------------------------------------------------------------------------------
+    void SoftwareOcclusionCulling::_cullOccluded( MovableObject::MovableObjectArray &inOutObjects,
+                                                  size_t threadIdx )
+    {
+        Timer timer;
+
+        const size_t numTested = inOutObjects.size();
+
+        MovableObject::MovableObjectArray::iterator itor = inOutObjects.begin();
+        MovableObject::MovableObjectArray::iterator end  = inOutObjects.end();
+        MovableObject::MovableObjectArray::iterator dst  = inOutObjects.begin();
+
+        while( itor != end )
+        {
+            if( isVisible( (*itor)->getWorldAabb() ) )
+                *dst++ = *itor;
+            ++itor;
+        }
+
+        inOutObjects.resize( dst - inOutObjects.begin() );
+
+        ThreadStats &threadStats = mThreadStats[threadIdx];
+        threadStats.numTested += numTested;
+        threadStats.numCulled += numTested - inOutObjects.size();
+        threadStats.testMicroseconds += timer.getMicroseconds();
+    }
+    //-----------------------------------------------------------------------------------
+    SoftwareOcclusionCulling::Stats SoftwareOcclusionCulling::getStats(void) const
+    {
+        Stats retVal = mStats;
+
+        ThreadStatsVec::const_iterator itor = mThreadStats.begin();
+        ThreadStatsVec::const_iterator end  = mThreadStats.end();
+        while( itor != end )
+        {
+            retVal.numTested        += itor->numTested;
+            retVal.numCulled        += itor->numCulled;
+            retVal.testMicroseconds += itor->testMicroseconds;
+            ++itor;
+        }
+
+        return retVal;
+    }
+}
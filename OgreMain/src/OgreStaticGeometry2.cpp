@@ -0,0 +1,1169 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2017 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreStaticGeometry2.h"
+#include "OgreSceneManager.h"
+#include "OgreSceneNode.h"
+#include "OgreItem.h"
+#include "OgreSubItem.h"
+#include "OgreSubMesh2.h"
+#include "OgreMeshManager2.h"
+#include "OgreMesh2Serializer.h"
+#include "OgreSerializer.h"
+#include "OgreRoot.h"
+#include "OgreRenderSystem.h"
+#include "OgreHlmsManager.h"
+#include "OgreHlmsDatablock.h"
+#include "OgreHardwareVertexBuffer.h"
+#include "OgreBitwise.h"
+#include "OgreMatrix3.h"
+#include "OgreException.h"
+#include "OgreStringConverter.h"
+#include "OgreLogManager.h"
+
+#include "Vao/OgreVaoManager.h"
+#include "Vao/OgreVertexArrayObject.h"
+#include "Vao/OgreIndexBufferPacked.h"
+#include "Vao/OgreAsyncTicket.h"
+
+namespace Ogre
+{
+    namespace
+    {
+        /// Meshes with less LODs than the region keep using their last one.
+        inline VertexArrayObject* getVao( const SubMesh *subMesh, size_t lod )
+        {
+            const VertexArrayObjectArray &vaos = subMesh->mVao[VpNormal];
+            return vaos[std::min( lod, vaos.size() - 1u )];
+        }
+        //-----------------------------------------------------------------------------------
+        inline Vector3 readVector3( const char *data, VertexElementType type )
+        {
+            if( type == VET_HALF4 )
+            {
+                const uint16 *data16 = reinterpret_cast<const uint16*>( data );
+                return Vector3( Bitwise::halfToFloat( data16[0] ),
+                                Bitwise::halfToFloat( data16[1] ),
+                                Bitwise::halfToFloat( data16[2] ) );
+            }
+
+            const float *dataF32 = reinterpret_cast<const float*>( data );
+            return Vector3( dataF32[0], dataF32[1], dataF32[2] );
+        }
+        //-----------------------------------------------------------------------------------
+        inline void writeVector3( char *data, VertexElementType type, const Vector3 &value )
+        {
+            if( type == VET_HALF4 )
+            {
+                uint16 *data16 = reinterpret_cast<uint16*>( data );
+                data16[0] = Bitwise::floatToHalf( static_cast<float>( value.x ) );
+                data16[1] = Bitwise::floatToHalf( static_cast<float>( value.y ) );
+                data16[2] = Bitwise::floatToHalf( static_cast<float>( value.z ) );
+            }
+            else
+            {
+                float *dataF32 = reinterpret_cast<float*>( data );
+                dataF32[0] = static_cast<float>( value.x );
+                dataF32[1] = static_cast<float>( value.y );
+                dataF32[2] = static_cast<float>( value.z );
+            }
+        }
+        //-----------------------------------------------------------------------------------
+        /// Flips the handedness stored in the w component of a tangent.
+        inline void negateW( char *data, VertexElementType type )
+        {
+            if( type == VET_HALF4 )
+            {
+                uint16 *data16 = reinterpret_cast<uint16*>( data );
+                data16[3] = Bitwise::floatToHalf( -Bitwise::halfToFloat( data16[3] ) );
+            }
+            else if( type == VET_FLOAT4 )
+            {
+                float *dataF32 = reinterpret_cast<float*>( data );
+                dataF32[3] = -dataF32[3];
+            }
+        }
+        //-----------------------------------------------------------------------------------
+        inline bool isTransformableVector( VertexElementType type )
+        {
+            return type == VET_FLOAT3 || type == VET_FLOAT4 || type == VET_HALF4;
+        }
+        //-----------------------------------------------------------------------------------
+        void getVertexFormat( const VertexArrayObject *vao, VertexElement2VecVec &outVertexFormat )
+        {
+            const VertexBufferPackedVec &vertexBuffers = vao->getVertexBuffers();
+            outVertexFormat.clear();
+            outVertexFormat.reserve( vertexBuffers.size() );
+
+            VertexBufferPackedVec::const_iterator itor = vertexBuffers.begin();
+            VertexBufferPackedVec::const_iterator end  = vertexBuffers.end();
+            while( itor != end )
+            {
+                outVertexFormat.push_back( (*itor)->getVertexElements() );
+                ++itor;
+            }
+        }
+        //-----------------------------------------------------------------------------------
+        /// Gives access to the Serializer helpers, to store the regions next to their meshes.
+        class RegionSerializer : public Serializer
+        {
+        public:
+            RegionSerializer( const DataStreamPtr &stream )
+            {
+                mVersion = "[StaticGeometry_v2.1]";
+                mStream = stream;
+                determineEndianness( ENDIAN_NATIVE );
+            }
+
+            using Serializer::writeFileHeader;
+            using Serializer::readFileHeader;
+            using Serializer::writeInts;
+            using Serializer::readInts;
+            using Serializer::writeShorts;
+            using Serializer::readShorts;
+            using Serializer::writeFloats;
+            using Serializer::readFloats;
+            using Serializer::writeObject;
+            using Serializer::readObject;
+        };
+    }
+
+    //-----------------------------------------------------------------------------------
+    StaticGeometry::StaticGeometry( const String &name, SceneManager *sceneManager ) :
+        mName( name ),
+        mSceneManager( sceneManager ),
+        mVaoManager( sceneManager->getDestinationRenderSystem()->getVaoManager() ),
+        mRegionDimensions( 1000.0f, 1000.0f, 1000.0f ),
+        mOrigin( Vector3::ZERO ),
+        mRenderQueueGroup( 10u ),
+        mVisibilityFlags( MovableObject::getDefaultVisibilityFlags() ),
+        mCastShadows( false ),
+        mVisible( true ),
+        mRenderingDistance( std::numeric_limits<Real>::max() ),
+        mNumQueuedSubMeshes( 0 )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    StaticGeometry::~StaticGeometry()
+    {
+        reset();
+    }
+    //-----------------------------------------------------------------------------------
+    size_t StaticGeometry::getRegionIdx( const Vector3 &point )
+    {
+        const Vector3 gridPos = (point - mOrigin) / mRegionDimensions;
+        const RegionKey key( static_cast<int32>( Math::Floor( gridPos.x ) ),
+                             static_cast<int32>( Math::Floor( gridPos.y ) ),
+                             static_cast<int32>( Math::Floor( gridPos.z ) ) );
+
+        RegionKeyMap::const_iterator itor = mRegionKeys.find( key );
+        if( itor != mRegionKeys.end() )
+            return itor->second;
+
+        const Vector3 centre = mOrigin + (Vector3( Real( key.x ), Real( key.y ), Real( key.z ) ) +
+                                          Vector3( 0.5f )) * mRegionDimensions;
+        const size_t regionIdx = mRegions.size();
+        mRegions.push_back( OGRE_NEW_T( Region, MEMCATEGORY_GEOMETRY )( key.x, key.y, key.z,
+                                                                       centre ) );
+        mBatchKeys.push_back( BatchKeyMap() );
+        mRegionKeys[key] = regionIdx;
+
+        return regionIdx;
+    }
+    //-----------------------------------------------------------------------------------
+    uint32 StaticGeometry::getVertexFormatIdx( const VertexElement2VecVec &vertexFormat )
+    {
+        vector<VertexElement2VecVec>::type::const_iterator itor =
+                std::find( mVertexFormats.begin(), mVertexFormats.end(), vertexFormat );
+
+        if( itor == mVertexFormats.end() )
+        {
+            mVertexFormats.push_back( vertexFormat );
+            itor = mVertexFormats.end() - 1u;
+        }
+
+        return static_cast<uint32>( itor - mVertexFormats.begin() );
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::validateSubMesh( const SubMesh *subMesh, bool mirrored ) const
+    {
+        const VertexArrayObjectArray &vaos = subMesh->mVao[VpNormal];
+
+        if( vaos.empty() )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "SubMesh from Mesh '" + subMesh->mParent->getName() + "' has no Vaos",
+                         "StaticGeometry::validateSubMesh" );
+        }
+
+        VertexElement2VecVec baseFormat;
+        getVertexFormat( vaos[0], baseFormat );
+
+        VertexArrayObjectArray::const_iterator itor = vaos.begin();
+        VertexArrayObjectArray::const_iterator end  = vaos.end();
+
+        while( itor != end )
+        {
+            const VertexArrayObject *vao = *itor;
+
+            const OperationType opType = vao->getOperationType();
+            if( (opType != OT_TRIANGLE_LIST && opType != OT_LINE_LIST && opType != OT_POINT_LIST) ||
+                opType != vaos[0]->getOperationType() )
+            {
+                OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                             "Mesh '" + subMesh->mParent->getName() + "' uses strips or fans, "
+                             "or different operation types per LOD. They can't be merged.",
+                             "StaticGeometry::validateSubMesh" );
+            }
+
+            VertexElement2VecVec vertexFormat;
+            getVertexFormat( vao, vertexFormat );
+            if( vertexFormat != baseFormat )
+            {
+                OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                             "Mesh '" + subMesh->mParent->getName() + "' uses different vertex "
+                             "formats per LOD. They can't be merged.",
+                             "StaticGeometry::validateSubMesh" );
+            }
+
+            ++itor;
+        }
+
+        VertexElement2VecVec::const_iterator itFormat = baseFormat.begin();
+        VertexElement2VecVec::const_iterator enFormat = baseFormat.end();
+        while( itFormat != enFormat )
+        {
+            VertexElement2Vec::const_iterator itElement = itFormat->begin();
+            VertexElement2Vec::const_iterator enElement = itFormat->end();
+            while( itElement != enElement )
+            {
+                const VertexElementSemantic semantic = itElement->mSemantic;
+                const bool isQTangent = semantic == VES_NORMAL &&
+                                        itElement->mType == VET_SHORT4_SNORM;
+
+                if( semantic == VES_BLEND_INDICES || semantic == VES_BLEND_WEIGHTS ||
+                    semantic == VES_BLEND_INDICES2 || semantic == VES_BLEND_WEIGHTS2 ||
+                    itElement->mInstancingStepRate != 0 ||
+                    ((semantic == VES_POSITION || semantic == VES_NORMAL ||
+                      semantic == VES_TANGENT || semantic == VES_BINORMAL) &&
+                     !isTransformableVector( itElement->mType ) && !isQTangent) )
+                {
+                    OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                                 "Mesh '" + subMesh->mParent->getName() + "' has a vertex "
+                                 "format that can't be transformed. Positions, normals, "
+                                 "tangents and binormals must be float or half, and there "
+                                 "can't be skinning data.",
+                                 "StaticGeometry::validateSubMesh" );
+                }
+
+                if( isQTangent && mirrored )
+                {
+                    OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                                 "Mesh '" + subMesh->mParent->getName() + "' uses QTangents "
+                                 "and can't be added with a negative scale.",
+                                 "StaticGeometry::validateSubMesh" );
+                }
+
+                ++itElement;
+            }
+
+            ++itFormat;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::addItem( Item *item )
+    {
+        Node *parentNode = item->getParentNode();
+
+        if( !parentNode )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Item '" + item->getName() + "' must be attached to a SceneNode",
+                         "StaticGeometry::addItem" );
+        }
+
+        addItem( item, parentNode->_getDerivedPositionUpdated(),
+                 parentNode->_getDerivedOrientationUpdated(),
+                 parentNode->_getDerivedScaleUpdated() );
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::addItem( Item *item, const Vector3 &position,
+                                  const Quaternion &orientation, const Vector3 &scale )
+    {
+        vector<HlmsDatablock*>::type datablocks;
+        datablocks.reserve( item->getNumSubItems() );
+
+        for( size_t i=0; i<item->getNumSubItems(); ++i )
+            datablocks.push_back( item->getSubItem( i )->getDatablock() );
+
+        addMesh( item->getMesh(), position, orientation, scale, &datablocks );
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::addMesh( const MeshPtr &mesh, const Vector3 &position,
+                                  const Quaternion &orientation, const Vector3 &scale,
+                                  const vector<HlmsDatablock*>::type *datablocks )
+    {
+        mesh->load();
+
+        if( mesh->hasSkeleton() )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Mesh '" + mesh->getName() + "' is skeletally animated",
+                         "StaticGeometry::addMesh" );
+        }
+
+        if( mLodStrategyName.empty() )
+        {
+            mLodStrategyName = mesh->getLodStrategyName();
+        }
+        else if( mLodStrategyName != mesh->getLodStrategyName() )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Mesh '" + mesh->getName() + "' uses the LOD strategy '" +
+                         mesh->getLodStrategyName() + "' but previously added meshes use '" +
+                         mLodStrategyName + "'. All must use the same one.",
+                         "StaticGeometry::addMesh" );
+        }
+
+        const Mesh::LodValueArray &meshLodValues = *mesh->_getLodValueArray();
+        if( meshLodValues.size() > 255u )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Mesh '" + mesh->getName() + "' has more than 255 LODs",
+                         "StaticGeometry::addMesh" );
+        }
+
+        Matrix4 worldTransform;
+        worldTransform.makeTransform( position, scale, orientation );
+        const bool mirrored = worldTransform.hasNegativeScale();
+
+        //Validate everything before queueing anything
+        const Mesh::SubMeshVec &subMeshes = mesh->getSubMeshes();
+        Mesh::SubMeshVec::const_iterator itor = subMeshes.begin();
+        Mesh::SubMeshVec::const_iterator end  = subMeshes.end();
+        while( itor != end )
+            validateSubMesh( *itor++, mirrored );
+
+        Aabb worldAabb = mesh->getAabb();
+        worldAabb.transformAffine( worldTransform );
+
+        const size_t regionIdx = getRegionIdx( worldAabb.mCenter );
+        Region *region = mRegions[regionIdx];
+
+        //Same as v1: the region uses the highest value of all its meshes at each level.
+        Mesh::LodValueArray &lodValues = region->lodValues;
+        for( size_t i=0; i<meshLodValues.size(); ++i )
+        {
+            if( i < lodValues.size() )
+                lodValues[i] = std::max( lodValues[i], meshLodValues[i] );
+            else
+                lodValues.push_back( meshLodValues[i] );
+        }
+
+        QueuedSubMesh queued;
+        queued.transform    = Matrix4::getTrans( -region->centre ) * worldTransform;
+        queued.orientation  = orientation;
+
+        HlmsManager *hlmsManager = Root::getSingleton().getHlmsManager();
+        BatchKeyMap &batchKeys = mBatchKeys[regionIdx];
+        VertexElement2VecVec vertexFormat;
+
+        for( size_t i=0; i<subMeshes.size(); ++i )
+        {
+            const SubMesh *subMesh = subMeshes[i];
+
+            HlmsDatablock *datablock = 0;
+            if( datablocks && i < datablocks->size() )
+                datablock = (*datablocks)[i];
+            if( !datablock )
+                datablock = hlmsManager->getDatablock( subMesh->getMaterialName() );
+
+            VertexArrayObject *vao = subMesh->mVao[VpNormal][0];
+            getVertexFormat( vao, vertexFormat );
+            const BatchKey batchKey( datablock, vao->getOperationType(),
+                                     getVertexFormatIdx( vertexFormat ) );
+
+            BatchKeyMap::const_iterator itKey = batchKeys.find( batchKey );
+            size_t batchIdx;
+            if( itKey == batchKeys.end() )
+            {
+                batchIdx = region->batches.size();
+                region->batches.push_back( Batch( batchKey.datablock, batchKey.operationType,
+                                                  batchKey.vertexFormatIdx ) );
+                batchKeys[batchKey] = batchIdx;
+            }
+            else
+            {
+                batchIdx = itKey->second;
+            }
+
+            queued.subMesh = subMesh;
+            region->batches[batchIdx].queuedSubMeshes.push_back( queued );
+            ++mNumQueuedSubMeshes;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::addSceneNode( SceneNode *sceneNode )
+    {
+        const size_t numAttachedObjects = sceneNode->numAttachedObjects();
+        for( size_t i=0; i<numAttachedObjects; ++i )
+        {
+            MovableObject *movableObject = sceneNode->getAttachedObject( i );
+            if( movableObject->getMovableType() == ItemFactory::FACTORY_TYPE_NAME )
+                addItem( static_cast<Item*>( movableObject ) );
+        }
+
+        const size_t numChildren = sceneNode->numChildren();
+        for( size_t i=0; i<numChildren; ++i )
+            addSceneNode( static_cast<SceneNode*>( sceneNode->getChild( i ) ) );
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::downloadSourceBuffers(void)
+    {
+        typedef vector< std::pair<const BufferPacked*, AsyncTicketPtr> >::type TicketVec;
+        TicketVec tickets;
+        set<const SubMesh*>::type seenSubMeshes;
+
+        //Issue all the read requests first, then map them; so that we only stall once.
+        RegionVec::const_iterator itRegion = mRegions.begin();
+        RegionVec::const_iterator enRegion = mRegions.end();
+        while( itRegion != enRegion )
+        {
+            BatchVec::const_iterator itBatch = (*itRegion)->batches.begin();
+            BatchVec::const_iterator enBatch = (*itRegion)->batches.end();
+            while( itBatch != enBatch )
+            {
+                QueuedSubMeshVec::const_iterator itor = itBatch->queuedSubMeshes.begin();
+                QueuedSubMeshVec::const_iterator end  = itBatch->queuedSubMeshes.end();
+                while( itor != end )
+                {
+                    if( seenSubMeshes.insert( itor->subMesh ).second )
+                    {
+                        const VertexArrayObjectArray &vaos = itor->subMesh->mVao[VpNormal];
+                        for( size_t i=0; i<vaos.size(); ++i )
+                        {
+                            vector<BufferPacked*>::type buffers( vaos[i]->getVertexBuffers().begin(),
+                                                                 vaos[i]->getVertexBuffers().end() );
+                            if( vaos[i]->getIndexBuffer() )
+                                buffers.push_back( vaos[i]->getIndexBuffer() );
+
+                            vector<BufferPacked*>::type::const_iterator itBuffer = buffers.begin();
+                            vector<BufferPacked*>::type::const_iterator enBuffer = buffers.end();
+                            while( itBuffer != enBuffer )
+                            {
+                                BufferPacked *buffer = *itBuffer;
+                                if( mBufferData.find( buffer ) == mBufferData.end() )
+                                {
+                                    const char *shadowCopy =
+                                            static_cast<const char*>( buffer->getShadowCopy() );
+                                    mBufferData[buffer] = shadowCopy;
+                                    if( !shadowCopy )
+                                    {
+                                        tickets.push_back( std::make_pair(
+                                            buffer, buffer->readRequest( 0, buffer->getNumElements() ) ) );
+                                    }
+                                }
+                                ++itBuffer;
+                            }
+                        }
+                    }
+
+                    ++itor;
+                }
+
+                ++itBatch;
+            }
+
+            ++itRegion;
+        }
+
+        mDownloadedData.reserve( tickets.size() );
+
+        TicketVec::const_iterator itor = tickets.begin();
+        TicketVec::const_iterator end  = tickets.end();
+        while( itor != end )
+        {
+            const BufferPacked *buffer = itor->first;
+            const size_t sizeBytes = buffer->getNumElements() * buffer->getBytesPerElement();
+
+            char *data = static_cast<char*>( OGRE_MALLOC_SIMD( sizeBytes, MEMCATEGORY_GEOMETRY ) );
+            memcpy( data, itor->second->map(), sizeBytes );
+            itor->second->unmap();
+
+            mBufferData[buffer] = data;
+            mDownloadedData.push_back( data );
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::freeSourceBuffers(void)
+    {
+        vector<char*>::type::const_iterator itor = mDownloadedData.begin();
+        vector<char*>::type::const_iterator end  = mDownloadedData.end();
+        while( itor != end )
+            OGRE_FREE_SIMD( *itor++, MEMCATEGORY_GEOMETRY );
+
+        mDownloadedData.clear();
+        mBufferData.clear();
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::transformVertices( char *dstData, const char *srcData, uint32 numVertices,
+                                           const VertexElement2Vec &vertexElements,
+                                           const QueuedSubMesh &queued, Aabb *inOutAabb ) const
+    {
+        const size_t bytesPerVertex = VaoManager::calculateVertexSize( vertexElements );
+        memcpy( dstData, srcData, numVertices * bytesPerVertex );
+
+        Matrix3 matrix3;
+        queued.transform.extract3x3Matrix( matrix3 );
+        const Matrix3 normalMatrix = matrix3.Inverse().Transpose();
+        const bool mirrored = matrix3.Determinant() < 0;
+
+        Vector3 vMin( std::numeric_limits<Real>::max() );
+        Vector3 vMax( -std::numeric_limits<Real>::max() );
+
+        size_t offset = 0;
+
+        VertexElement2Vec::const_iterator itor = vertexElements.begin();
+        VertexElement2Vec::const_iterator end  = vertexElements.end();
+        while( itor != end )
+        {
+            const VertexElementType type = itor->mType;
+            char *data = dstData + offset;
+
+            switch( itor->mSemantic )
+            {
+            case VES_POSITION:
+                for( uint32 i=0; i<numVertices; ++i )
+                {
+                    const Vector3 pos = queued.transform * readVector3( data, type );
+                    writeVector3( data, type, pos );
+                    vMin.makeFloor( pos );
+                    vMax.makeCeil( pos );
+                    data += bytesPerVertex;
+                }
+                break;
+            case VES_NORMAL:
+                if( type == VET_SHORT4_SNORM )
+                {
+                    //QTangents. See SubMesh::_arrangeEfficient for the encoding.
+                    const Real bias = 1.0f / 32767.0f;
+                    for( uint32 i=0; i<numVertices; ++i )
+                    {
+                        int16 *data16 = reinterpret_cast<int16*>( data );
+                        Quaternion qTangent( Bitwise::snorm16ToFloat( data16[3] ),
+                                             Bitwise::snorm16ToFloat( data16[0] ),
+                                             Bitwise::snorm16ToFloat( data16[1] ),
+                                             Bitwise::snorm16ToFloat( data16[2] ) );
+                        const bool reflected = qTangent.w < 0;
+                        if( reflected )
+                            qTangent = -qTangent;
+
+                        qTangent = queued.orientation * qTangent;
+                        qTangent.normalise();
+
+                        if( qTangent.w < 0 )
+                            qTangent = -qTangent;
+                        if( qTangent.w < bias )
+                        {
+                            const Real normFactor = Math::Sqrt( 1 - bias * bias );
+                            qTangent.x *= normFactor;
+                            qTangent.y *= normFactor;
+                            qTangent.z *= normFactor;
+                            qTangent.w = bias;
+                        }
+                        if( reflected )
+                            qTangent = -qTangent;
+
+                        data16[0] = Bitwise::floatToSnorm16( qTangent.x );
+                        data16[1] = Bitwise::floatToSnorm16( qTangent.y );
+                        data16[2] = Bitwise::floatToSnorm16( qTangent.z );
+                        data16[3] = Bitwise::floatToSnorm16( qTangent.w );
+                        data += bytesPerVertex;
+                    }
+                }
+                else
+                {
+                    for( uint32 i=0; i<numVertices; ++i )
+                    {
+                        Vector3 normal = normalMatrix * readVector3( data, type );
+                        normal.normalise();
+                        writeVector3( data, type, normal );
+                        data += bytesPerVertex;
+                    }
+                }
+                break;
+            case VES_TANGENT:
+            case VES_BINORMAL:
+                for( uint32 i=0; i<numVertices; ++i )
+                {
+                    Vector3 direction = matrix3 * readVector3( data, type );
+                    direction.normalise();
+                    writeVector3( data, type, direction );
+                    //Mirroring flips the binormal the shader reconstructs from the tangent
+                    if( mirrored && itor->mSemantic == VES_TANGENT )
+                        negateW( data, type );
+                    data += bytesPerVertex;
+                }
+                break;
+            default:
+                break;
+            }
+
+            offset += v1::VertexElement::getTypeSize( type );
+            ++itor;
+        }
+
+        if( inOutAabb && vMin.x <= vMax.x )
+            inOutAabb->merge( Aabb::newFromExtents( vMin, vMax ) );
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::mergeBatch( Batch &batch, uint8 numLods ) const
+    {
+        const VertexElement2VecVec &vertexFormat = mVertexFormats[batch.vertexFormatIdx];
+        const QueuedSubMeshVec &queuedSubMeshes = batch.queuedSubMeshes;
+
+        batch.lods.resize( numLods );
+
+        for( uint8 lod=0; lod<numLods; ++lod )
+        {
+            BatchLod &batchLod = batch.lods[lod];
+
+            //LODs often share the vertex buffers (only the indices change). If all the
+            //queued SubMeshes do, so does the merged one.
+            batchLod.vertexLod = lod;
+            for( uint8 prevLod=0; prevLod<lod && batchLod.vertexLod == lod; ++prevLod )
+            {
+                bool sameBuffers = true;
+                QueuedSubMeshVec::const_iterator itor = queuedSubMeshes.begin();
+                QueuedSubMeshVec::const_iterator end  = queuedSubMeshes.end();
+                while( itor != end && sameBuffers )
+                {
+                    sameBuffers = getVao( itor->subMesh, prevLod )->getVertexBuffers() ==
+                                  getVao( itor->subMesh, lod )->getVertexBuffers();
+                    ++itor;
+                }
+
+                if( sameBuffers )
+                    batchLod.vertexLod = prevLod;
+            }
+
+            uint32 numVertices = 0;
+            uint32 numIndices = 0;
+            QueuedSubMeshVec::const_iterator itor = queuedSubMeshes.begin();
+            QueuedSubMeshVec::const_iterator end  = queuedSubMeshes.end();
+            while( itor != end )
+            {
+                const VertexArrayObject *vao = getVao( itor->subMesh, lod );
+                numVertices += vao->getVertexBuffers()[0]->getNumElements();
+                numIndices  += vao->getPrimitiveCount();
+                ++itor;
+            }
+
+            batchLod.numVertices = numVertices;
+
+            if( batchLod.vertexLod == lod )
+            {
+                batchLod.vertexData.resize( vertexFormat.size() );
+                for( size_t i=0; i<vertexFormat.size(); ++i )
+                {
+                    const size_t bytesPerVertex = VaoManager::calculateVertexSize( vertexFormat[i] );
+                    batchLod.vertexData[i] = static_cast<char*>(
+                                OGRE_MALLOC_SIMD( numVertices * bytesPerVertex,
+                                                  MEMCATEGORY_GEOMETRY ) );
+
+                    char *dstData = batchLod.vertexData[i];
+                    itor = queuedSubMeshes.begin();
+                    while( itor != end )
+                    {
+                        const VertexBufferPacked *vertexBuffer =
+                                getVao( itor->subMesh, lod )->getVertexBuffers()[i];
+                        const char *srcData = mBufferData.find( vertexBuffer )->second;
+                        transformVertices( dstData, srcData, vertexBuffer->getNumElements(),
+                                           vertexFormat[i], *itor, lod == 0 ? &batch.aabb : 0 );
+                        dstData += vertexBuffer->getNumElements() * bytesPerVertex;
+                        ++itor;
+                    }
+                }
+            }
+
+            batchLod.indices32  = numVertices > 0xFFFF;
+            batchLod.numIndices = numIndices;
+            batchLod.indexData  = OGRE_MALLOC_SIMD( numIndices * (batchLod.indices32 ? 4u : 2u),
+                                                    MEMCATEGORY_GEOMETRY );
+
+            uint32 baseVertex = 0;
+            uint32 indexOffset = 0;
+            itor = queuedSubMeshes.begin();
+            while( itor != end )
+            {
+                const VertexArrayObject *vao = getVao( itor->subMesh, lod );
+                const IndexBufferPacked *indexBuffer = vao->getIndexBuffer();
+                const uint32 primStart = vao->getPrimitiveStart();
+                const uint32 primCount = vao->getPrimitiveCount();
+
+                //Mirrored triangles need their winding flipped
+                const bool flipWinding = batch.operationType == OT_TRIANGLE_LIST &&
+                                         itor->transform.hasNegativeScale();
+
+                const void *srcIndices = 0;
+                bool srcIndices32 = false;
+                if( indexBuffer )
+                {
+                    srcIndices = mBufferData.find( indexBuffer )->second;
+                    srcIndices32 = indexBuffer->getIndexType() == IndexBufferPacked::IT_32BIT;
+                }
+
+                for( uint32 i=0; i<primCount; ++i )
+                {
+                    uint32 srcIdx = i;
+                    if( flipWinding && (i % 3u) != 0u )
+                        srcIdx = (i % 3u) == 1u ? i + 1u : i - 1u;
+
+                    uint32 index;
+                    if( !srcIndices )
+                        index = primStart + srcIdx;
+                    else if( srcIndices32 )
+                        index = reinterpret_cast<const uint32*>( srcIndices )[primStart + srcIdx];
+                    else
+                        index = reinterpret_cast<const uint16*>( srcIndices )[primStart + srcIdx];
+
+                    index += baseVertex;
+
+                    if( batchLod.indices32 )
+                        reinterpret_cast<uint32*>( batchLod.indexData )[indexOffset + i] = index;
+                    else
+                        reinterpret_cast<uint16*>( batchLod.indexData )[indexOffset + i] =
+                                static_cast<uint16>( index );
+                }
+
+                baseVertex  += vao->getVertexBuffers()[0]->getNumElements();
+                indexOffset += primCount;
+                ++itor;
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::execute( size_t threadId, size_t numThreads )
+    {
+        for( size_t i=threadId; i<mPendingBatches.size(); i += numThreads )
+            mergeBatch( *mPendingBatches[i].batch, mPendingBatches[i].numLods );
+    }
+    //-----------------------------------------------------------------------------------
+    String StaticGeometry::getRegionMeshName( const Region *region ) const
+    {
+        return "StaticGeometry/" + mName + "/" + StringConverter::toString( region->x ) + "_" +
+                StringConverter::toString( region->y ) + "_" +
+                StringConverter::toString( region->z );
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::createRegionMesh( Region *region )
+    {
+        MeshPtr mesh = MeshManager::getSingleton().createManual(
+                    getRegionMeshName( region ), ResourceGroupManager::INTERNAL_RESOURCE_GROUP_NAME );
+        if( !mLodStrategyName.empty() )
+            mesh->setLodStrategyName( mLodStrategyName );
+
+        region->aabb = Aabb::BOX_NULL;
+
+        BatchVec::iterator itBatch = region->batches.begin();
+        BatchVec::iterator enBatch = region->batches.end();
+        while( itBatch != enBatch )
+        {
+            Batch &batch = *itBatch;
+            const VertexElement2VecVec &vertexFormat = mVertexFormats[batch.vertexFormatIdx];
+
+            SubMesh *subMesh = mesh->createSubMesh();
+            const String *datablockName = batch.datablock->getNameStr();
+            if( datablockName )
+                subMesh->setMaterialName( *datablockName );
+
+            for( size_t lod=0; lod<batch.lods.size(); ++lod )
+            {
+                BatchLod &batchLod = batch.lods[lod];
+
+                VertexBufferPackedVec vertexBuffers;
+                if( batchLod.vertexLod == lod )
+                {
+                    for( size_t i=0; i<vertexFormat.size(); ++i )
+                    {
+                        vertexBuffers.push_back( mVaoManager->createVertexBuffer(
+                                                     vertexFormat[i], batchLod.numVertices,
+                                                     BT_IMMUTABLE, batchLod.vertexData[i],
+                                                     false ) );
+                        OGRE_FREE_SIMD( batchLod.vertexData[i], MEMCATEGORY_GEOMETRY );
+                    }
+                    batchLod.vertexData.clear();
+                }
+                else
+                {
+                    vertexBuffers = subMesh->mVao[VpNormal][batchLod.vertexLod]->getVertexBuffers();
+                }
+
+                IndexBufferPacked *indexBuffer = mVaoManager->createIndexBuffer(
+                            batchLod.indices32 ? IndexBufferPacked::IT_32BIT :
+                                                 IndexBufferPacked::IT_16BIT,
+                            batchLod.numIndices, BT_IMMUTABLE, batchLod.indexData, false );
+                OGRE_FREE_SIMD( batchLod.indexData, MEMCATEGORY_GEOMETRY );
+                batchLod.indexData = 0;
+
+                subMesh->mVao[VpNormal].push_back( mVaoManager->createVertexArrayObject(
+                                                       vertexBuffers, indexBuffer,
+                                                       batch.operationType ) );
+            }
+
+            region->aabb.merge( batch.aabb );
+            batch.lods.clear();
+            ++itBatch;
+        }
+
+        mesh->_setLodValues( region->lodValues );
+        mesh->_setBounds( region->aabb, false );
+        mesh->_setBoundingSphereRadius( region->aabb.getRadius() );
+        mesh->prepareForShadowMapping( false );
+
+        region->mesh = mesh;
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::createRegionItem( Region *region )
+    {
+        region->item = mSceneManager->createItem( region->mesh, SCENE_STATIC );
+
+        //Datablocks without a name couldn't be stored in the SubMesh
+        for( size_t i=0; i<region->batches.size() && i<region->item->getNumSubItems(); ++i )
+            region->item->getSubItem( i )->setDatablock( region->batches[i].datablock );
+
+        region->item->setRenderQueueGroup( mRenderQueueGroup );
+        region->item->setVisibilityFlags( mVisibilityFlags );
+        region->item->setCastShadows( mCastShadows );
+        region->item->setVisible( mVisible );
+        region->item->setRenderingDistance( mRenderingDistance );
+
+        region->sceneNode = mSceneManager->getRootSceneNode( SCENE_STATIC )->
+                createChildSceneNode( SCENE_STATIC, region->centre );
+        region->sceneNode->attachObject( region->item );
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::build(void)
+    {
+        destroy();
+
+        //Keep the LOD values sorted; meshes with less LODs may have raised a lower level.
+        RegionVec::const_iterator itRegion = mRegions.begin();
+        RegionVec::const_iterator enRegion = mRegions.end();
+        while( itRegion != enRegion )
+        {
+            Mesh::LodValueArray &lodValues = (*itRegion)->lodValues;
+            for( size_t i=1; i<lodValues.size(); ++i )
+                lodValues[i] = std::max( lodValues[i], lodValues[i-1u] );
+
+            BatchVec::iterator itBatch = (*itRegion)->batches.begin();
+            BatchVec::iterator enBatch = (*itRegion)->batches.end();
+            while( itBatch != enBatch )
+            {
+                itBatch->aabb = Aabb::BOX_NULL;
+                PendingBatch pendingBatch;
+                pendingBatch.batch = &(*itBatch);
+                pendingBatch.numLods = static_cast<uint8>( lodValues.size() );
+                mPendingBatches.push_back( pendingBatch );
+                ++itBatch;
+            }
+
+            ++itRegion;
+        }
+
+        downloadSourceBuffers();
+        mSceneManager->executeUserScalableTask( this, true );
+        mPendingBatches.clear();
+        freeSourceBuffers();
+
+        itRegion = mRegions.begin();
+        while( itRegion != enRegion )
+        {
+            if( !(*itRegion)->batches.empty() )
+            {
+                createRegionMesh( *itRegion );
+                createRegionItem( *itRegion );
+            }
+            ++itRegion;
+        }
+
+        LogManager::getSingleton().logMessage( "StaticGeometry '" + mName + "' built " +
+                                               StringConverter::toString( mRegions.size() ) +
+                                               " regions from " +
+                                               StringConverter::toString( mNumQueuedSubMeshes ) +
+                                               " SubMeshes" );
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::destroy(void)
+    {
+        RegionVec::const_iterator itor = mRegions.begin();
+        RegionVec::const_iterator end  = mRegions.end();
+        while( itor != end )
+        {
+            Region *region = *itor;
+
+            if( region->item )
+            {
+                mSceneManager->destroyItem( region->item );
+                region->item = 0;
+            }
+            if( region->sceneNode )
+            {
+                mSceneManager->destroySceneNode( region->sceneNode );
+                region->sceneNode = 0;
+            }
+            if( !region->mesh.isNull() )
+            {
+                MeshManager::getSingleton().remove( region->mesh->getHandle() );
+                region->mesh.setNull();
+            }
+
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::reset(void)
+    {
+        destroy();
+
+        RegionVec::const_iterator itor = mRegions.begin();
+        RegionVec::const_iterator end  = mRegions.end();
+        while( itor != end )
+        {
+            OGRE_DELETE_T( *itor, Region, MEMCATEGORY_GEOMETRY );
+            ++itor;
+        }
+
+        mRegions.clear();
+        mRegionKeys.clear();
+        mBatchKeys.clear();
+        mVertexFormats.clear();
+        mLodStrategyName.clear();
+        mNumQueuedSubMeshes = 0;
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::saveRegions( const String &filename ) const
+    {
+        std::fstream *f = OGRE_NEW_T( std::fstream, MEMCATEGORY_GENERAL )();
+        f->open( filename.c_str(), std::ios::binary | std::ios::in | std::ios::out |
+                                   std::ios::trunc );
+        if( !f->is_open() )
+        {
+            OGRE_DELETE_T( f, basic_fstream, MEMCATEGORY_GENERAL );
+            OGRE_EXCEPT( Exception::ERR_CANNOT_WRITE_TO_FILE,
+                         "Cannot open '" + filename + "' for writing",
+                         "StaticGeometry::saveRegions" );
+        }
+
+        DataStreamPtr stream( OGRE_NEW FileStreamDataStream( filename, f, true ) );
+        RegionSerializer serializer( stream );
+        MeshSerializer meshSerializer( mVaoManager );
+
+        uint32 numRegions = 0;
+        RegionVec::const_iterator itor = mRegions.begin();
+        RegionVec::const_iterator end  = mRegions.end();
+        while( itor != end )
+            numRegions += (*itor++)->mesh.isNull() ? 0u : 1u;
+
+        serializer.writeFileHeader();
+        serializer.writeInts( &numRegions, 1 );
+        serializer.writeObject( mRegionDimensions );
+        serializer.writeObject( mOrigin );
+
+        itor = mRegions.begin();
+        while( itor != end )
+        {
+            const Region *region = *itor;
+            if( !region->mesh.isNull() )
+            {
+                const uint32 key[3] = { static_cast<uint32>( region->x ),
+                                        static_cast<uint32>( region->y ),
+                                        static_cast<uint32>( region->z ) };
+                serializer.writeInts( key, 3 );
+                serializer.writeObject( region->centre );
+
+                const uint16 numLods = static_cast<uint16>( region->lodValues.size() );
+                serializer.writeShorts( &numLods, 1 );
+                for( size_t i=0; i<numLods; ++i )
+                {
+                    const float lodValue = static_cast<float>( region->lodValues[i] );
+                    serializer.writeFloats( &lodValue, 1 );
+                }
+
+                //The mesh goes right after its size, which we only know after writing it.
+                const size_t sizePos = stream->tell();
+                uint32 meshSize = 0;
+                serializer.writeInts( &meshSize, 1 );
+                meshSerializer.exportMesh( region->mesh.get(), stream );
+                const size_t endPos = stream->tell();
+                meshSize = static_cast<uint32>( endPos - sizePos - sizeof(uint32) );
+                stream->seek( sizePos );
+                serializer.writeInts( &meshSize, 1 );
+                stream->seek( endPos );
+            }
+            ++itor;
+        }
+
+        stream->close();
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::loadRegions( DataStreamPtr &stream )
+    {
+        reset();
+
+        RegionSerializer serializer( stream );
+        MeshSerializer meshSerializer( mVaoManager );
+
+        serializer.readFileHeader( stream );
+
+        uint32 numRegions = 0;
+        serializer.readInts( stream, &numRegions, 1 );
+        serializer.readObject( stream, mRegionDimensions );
+        serializer.readObject( stream, mOrigin );
+
+        for( uint32 i=0; i<numRegions; ++i )
+        {
+            uint32 key[3];
+            serializer.readInts( stream, key, 3 );
+            Vector3 centre;
+            serializer.readObject( stream, centre );
+
+            const size_t regionIdx = getRegionIdx( centre );
+            Region *region = mRegions[regionIdx];
+            assert( region->x == static_cast<int32>( key[0] ) &&
+                    region->y == static_cast<int32>( key[1] ) &&
+                    region->z == static_cast<int32>( key[2] ) );
+
+            uint16 numLods = 0;
+            serializer.readShorts( stream, &numLods, 1 );
+            region->lodValues.resize( numLods );
+            for( size_t j=0; j<numLods; ++j )
+            {
+                float lodValue;
+                serializer.readFloats( stream, &lodValue, 1 );
+                region->lodValues[j] = lodValue;
+            }
+
+            uint32 meshSize = 0;
+            serializer.readInts( stream, &meshSize, 1 );
+            MemoryDataStream *meshStream = OGRE_NEW MemoryDataStream( meshSize );
+            stream->read( meshStream->getPtr(), meshSize );
+            DataStreamPtr meshStreamPtr( meshStream );
+
+            region->mesh = MeshManager::getSingleton().createManual(
+                        getRegionMeshName( region ), ResourceGroupManager::INTERNAL_RESOURCE_GROUP_NAME );
+            meshSerializer.importMesh( meshStreamPtr, region->mesh.get() );
+            region->mesh->_setLodValues( region->lodValues );
+            region->aabb = region->mesh->getAabb();
+
+            mLodStrategyName = region->mesh->getLodStrategyName();
+
+            createRegionItem( region );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::setRegionDimensions( const Vector3 &size )
+    {
+        assert( !mNumQueuedSubMeshes && "Region dimensions must be set before queueing" );
+        mRegionDimensions = size;
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::setOrigin( const Vector3 &origin )
+    {
+        assert( !mNumQueuedSubMeshes && "Origin must be set before queueing" );
+        mOrigin = origin;
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::setRenderQueueGroup( uint8 queueId )
+    {
+        mRenderQueueGroup = queueId;
+        RegionVec::const_iterator itor = mRegions.begin();
+        RegionVec::const_iterator end  = mRegions.end();
+        while( itor != end )
+        {
+            if( (*itor)->item )
+                (*itor)->item->setRenderQueueGroup( queueId );
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::setVisibilityFlags( uint32 flags )
+    {
+        mVisibilityFlags = flags;
+        RegionVec::const_iterator itor = mRegions.begin();
+        RegionVec::const_iterator end  = mRegions.end();
+        while( itor != end )
+        {
+            if( (*itor)->item )
+                (*itor)->item->setVisibilityFlags( flags );
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::setCastShadows( bool castShadows )
+    {
+        mCastShadows = castShadows;
+        RegionVec::const_iterator itor = mRegions.begin();
+        RegionVec::const_iterator end  = mRegions.end();
+        while( itor != end )
+        {
+            if( (*itor)->item )
+                (*itor)->item->setCastShadows( castShadows );
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::setVisible( bool visible )
+    {
+        mVisible = visible;
+        RegionVec::const_iterator itor = mRegions.begin();
+        RegionVec::const_iterator end  = mRegions.end();
+        while( itor != end )
+        {
+            if( (*itor)->item )
+                (*itor)->item->setVisible( visible );
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::setRenderingDistance( Real dist )
+    {
+        mRenderingDistance = dist;
+        RegionVec::const_iterator itor = mRegions.begin();
+        RegionVec::const_iterator end  = mRegions.end();
+        while( itor != end )
+        {
+            if( (*itor)->item )
+                (*itor)->item->setRenderingDistance( dist );
+            ++itor;
+        }
+    }
+}
@@ -0,0 +1,465 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2017 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreStaticObjectBvh.h"
+#include "OgreCamera.h"
+#include "Math/Array/OgreObjectMemoryManager.h"
+
+namespace Ogre
+{
+    struct OrderPackByCentroid
+    {
+        const vector<Vector3>::type &centroids;
+        size_t axis;
+
+        OrderPackByCentroid( const vector<Vector3>::type &_centroids, size_t _axis ) :
+            centroids( _centroids ), axis( _axis ) {}
+
+        bool operator () ( uint32 l, uint32 r ) const
+        {
+            return centroids[l][axis] < centroids[r][axis];
+        }
+    };
+    //-----------------------------------------------------------------------------------
+    StaticObjectBvh::StaticObjectBvh( ObjectMemoryManager *staticMemoryManager,
+                                      size_t numThreads ) :
+        mObjectMemoryManager( staticMemoryManager ),
+        mNumThreads( numThreads ),
+        mNeedsRebuild( true ),
+        mLayoutVersion( 0 ),
+        mTotalPacks( 0 ),
+        mNumRefitPacks( 0 ),
+        mNumRebuilds( 0 )
+    {
+        mThreadScratch.resize( numThreads );
+    }
+    //-----------------------------------------------------------------------------------
+    StaticObjectBvh::~StaticObjectBvh()
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    bool StaticObjectBvh::calculatePackAabb( const ObjectData &objData, Aabb &outAabb,
+                                             bool &outEmpty )
+    {
+        outAabb = Aabb::BOX_NULL;
+        outEmpty = true;
+
+        for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
+        {
+            if( objData.mOwner[j] )
+            {
+                Aabb aabb;
+                objData.mWorldAabb->getAsAabb( aabb, j );
+
+                if( aabb.mHalfSize.x == std::numeric_limits<Real>::infinity() ||
+                    aabb.mHalfSize.y == std::numeric_limits<Real>::infinity() ||
+                    aabb.mHalfSize.z == std::numeric_limits<Real>::infinity() )
+                {
+                    outEmpty = false;
+                    return false;
+                }
+
+                outAabb.merge( aabb );
+                outEmpty = false;
+            }
+        }
+
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticObjectBvh::_notifyObjectDirty( MovableObject *movableObject )
+    {
+        if( mNeedsRebuild || mLayoutVersion != mObjectMemoryManager->_getLayoutVersion() )
+            return; //Will be rebuilt anyway
+
+        const uint8 renderQueue = movableObject->getRenderQueueGroup();
+        if( renderQueue >= mTrees.size() )
+        {
+            mNeedsRebuild = true;
+            return;
+        }
+
+        ObjectData firstObjData;
+        mObjectMemoryManager->getFirstObjectData( firstObjData, renderQueue );
+
+        const ObjectData &objData = movableObject->_getObjectData();
+        const size_t packIdx = static_cast<size_t>( objData.mWorldAabb - firstObjData.mWorldAabb );
+
+        mDirtyPacks.push_back( DirtyPack( renderQueue, static_cast<uint32>( packIdx ) ) );
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticObjectBvh::_update(void)
+    {
+        const uint32 layoutVersion = mObjectMemoryManager->_getLayoutVersion();
+
+        //Refitting loosens the tree. Rebuild after a quarter of the packs were refit.
+        if( mNeedsRebuild || mLayoutVersion != layoutVersion ||
+            mNumRefitPacks * 4u > mTotalPacks || !refit() )
+        {
+            rebuild();
+        }
+
+        mLayoutVersion = layoutVersion;
+        mDirtyPacks.clear();
+    }
+    //-----------------------------------------------------------------------------------
+    bool StaticObjectBvh::refit(void)
+    {
+        if( mDirtyPacks.empty() )
+            return true;
+
+        vector<uint32>::type dirtyLeaves;
+        dirtyLeaves.reserve( mDirtyPacks.size() );
+
+        DirtyPackVec::const_iterator itor = mDirtyPacks.begin();
+        DirtyPackVec::const_iterator end  = mDirtyPacks.end();
+
+        while( itor != end )
+        {
+            Tree &tree = mTrees[itor->renderQueue];
+            if( itor->packIdx >= tree.packToLeaf.size() )
+                return false;
+
+            ObjectData objData;
+            mObjectMemoryManager->getFirstObjectData( objData, itor->renderQueue );
+            objData.advancePack( itor->packIdx );
+
+            Aabb packAabb;
+            bool isEmpty;
+            const bool isFinite = calculatePackAabb( objData, packAabb, isEmpty );
+
+            const uint32 leafIdx = tree.packToLeaf[itor->packIdx];
+
+            if( leafIdx == InfinitePack || leafIdx == InvalidNode )
+            {
+                //Packs outside the tree can stay that way, as long as they're still
+                //infinite (or still empty). Otherwise only a rebuild can fix that.
+                const bool unchanged = leafIdx == InfinitePack ? !isFinite : isEmpty;
+                if( !unchanged )
+                    return false;
+            }
+            else if( !isFinite || isEmpty )
+            {
+                return false;
+            }
+            else
+            {
+                tree.packAabbs[itor->packIdx] = packAabb;
+                dirtyLeaves.push_back( (itor->renderQueue << 24u) | leafIdx );
+            }
+
+            ++itor;
+        }
+
+        std::sort( dirtyLeaves.begin(), dirtyLeaves.end() );
+        dirtyLeaves.erase( std::unique( dirtyLeaves.begin(), dirtyLeaves.end() ), dirtyLeaves.end() );
+
+        vector<uint32>::type::const_iterator itLeaf = dirtyLeaves.begin();
+        vector<uint32>::type::const_iterator enLeaf = dirtyLeaves.end();
+
+        while( itLeaf != enLeaf )
+        {
+            Tree &tree = mTrees[*itLeaf >> 24u];
+            const uint32 leafIdx = *itLeaf & 0x00ffffff;
+
+            Node &leaf = tree.nodes[leafIdx];
+            leaf.aabb = Aabb::BOX_NULL;
+            for( uint32 i=leaf.firstPack; i<leaf.firstPack + leaf.numPacks; ++i )
+                leaf.aabb.merge( tree.packAabbs[tree.packIndices[i]] );
+
+            //Propagate to the ancestors.
+            uint32 nodeIdx = leaf.parent;
+            while( nodeIdx != InvalidNode )
+            {
+                Node &node = tree.nodes[nodeIdx];
+                node.aabb = tree.nodes[node.left].aabb;
+                node.aabb.merge( tree.nodes[node.right].aabb );
+                nodeIdx = node.parent;
+            }
+
+            ++itLeaf;
+        }
+
+        mNumRefitPacks += mDirtyPacks.size();
+
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticObjectBvh::rebuild(void)
+    {
+        const size_t numRenderQueues = mObjectMemoryManager->getNumRenderQueues();
+        mTrees.resize( numRenderQueues );
+
+        mTotalPacks = 0;
+        for( size_t i=0; i<numRenderQueues; ++i )
+            rebuild( mTrees[i], i );
+
+        mNeedsRebuild = false;
+        mNumRefitPacks = 0;
+        ++mNumRebuilds;
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticObjectBvh::rebuild( Tree &tree, size_t renderQueue )
+    {
+        tree.nodes.clear();
+        tree.packIndices.clear();
+        tree.infinitePacks.clear();
+        tree.taskRoots.clear();
+
+        ObjectData objData;
+        const size_t numObjs = mObjectMemoryManager->getFirstObjectData( objData, renderQueue );
+        const size_t numPacks = (numObjs + ARRAY_PACKED_REALS - 1u) / ARRAY_PACKED_REALS;
+
+        //Leaves are indexed with 24 bits while refitting.
+        assert( numPacks / LeafSize * 2u < 0x00ffffff && "Too many static objects!" );
+
+        tree.packToLeaf.clear();
+        tree.packToLeaf.resize( numPacks, static_cast<uint32>( InvalidNode ) );
+        tree.packAabbs.resize( numPacks );
+
+        vector<Vector3>::type centroids( numPacks );
+        tree.packIndices.reserve( numPacks );
+
+        for( size_t i=0; i<numPacks; ++i )
+        {
+            bool isEmpty;
+            if( !calculatePackAabb( objData, tree.packAabbs[i], isEmpty ) )
+            {
+                tree.packToLeaf[i] = InfinitePack;
+                tree.infinitePacks.push_back( static_cast<uint32>( i ) );
+            }
+            else if( !isEmpty )
+            {
+                centroids[i] = tree.packAabbs[i].mCenter;
+                tree.packIndices.push_back( static_cast<uint32>( i ) );
+            }
+
+            objData.advancePack();
+        }
+
+        mTotalPacks += numPacks;
+
+        if( !tree.packIndices.empty() )
+        {
+            tree.nodes.reserve( (tree.packIndices.size() / LeafSize + 1u) * 2u );
+            buildNode( tree, centroids, 0, static_cast<uint32>( tree.packIndices.size() ),
+                       InvalidNode );
+        }
+
+        buildTaskRoots( tree );
+    }
+    //-----------------------------------------------------------------------------------
+    uint32 StaticObjectBvh::buildNode( Tree &tree, const vector<Vector3>::type &centroids,
+                                       uint32 first, uint32 numPacks, uint32 parent )
+    {
+        const uint32 nodeIdx = static_cast<uint32>( tree.nodes.size() );
+        tree.nodes.push_back( Node() );
+
+        Aabb aabb = Aabb::BOX_NULL;
+        Aabb centroidBounds = Aabb::BOX_NULL;
+        for( uint32 i=first; i<first + numPacks; ++i )
+        {
+            const uint32 packIdx = tree.packIndices[i];
+            aabb.merge( tree.packAabbs[packIdx] );
+            centroidBounds.merge( centroids[packIdx] );
+        }
+
+        Node node;
+        node.aabb       = aabb;
+        node.parent     = parent;
+        node.left       = InvalidNode;
+        node.right      = InvalidNode;
+        node.firstPack  = first;
+        node.numPacks   = numPacks;
+
+        if( numPacks <= LeafSize )
+        {
+            for( uint32 i=first; i<first + numPacks; ++i )
+                tree.packToLeaf[tree.packIndices[i]] = nodeIdx;
+        }
+        else
+        {
+            //Median split along the longest axis of the centroids. Always balanced,
+            //even when all centroids are the same.
+            size_t axis = 0;
+            const Vector3 &extent = centroidBounds.mHalfSize;
+            if( extent.y > extent[axis] )
+                axis = 1;
+            if( extent.z > extent[axis] )
+                axis = 2;
+
+            const uint32 half = numPacks / 2u;
+            vector<uint32>::type::iterator begin = tree.packIndices.begin() + first;
+            std::nth_element( begin, begin + half, begin + numPacks,
+                              OrderPackByCentroid( centroids, axis ) );
+
+            node.left   = buildNode( tree, centroids, first, half, nodeIdx );
+            node.right  = buildNode( tree, centroids, first + half, numPacks - half, nodeIdx );
+        }
+
+        tree.nodes[nodeIdx] = node;
+
+        return nodeIdx;
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticObjectBvh::buildTaskRoots( Tree &tree )
+    {
+        if( tree.nodes.empty() )
+            return;
+
+        //Go down the tree until there's enough subtrees to keep all threads busy.
+        tree.taskRoots.push_back( 0 );
+        bool anyInternal = true;
+        while( tree.taskRoots.size() < mNumThreads * 4u && anyInternal && mNumThreads > 1u )
+        {
+            anyInternal = false;
+            vector<uint32>::type nextLevel;
+            nextLevel.reserve( tree.taskRoots.size() * 2u );
+
+            vector<uint32>::type::const_iterator itor = tree.taskRoots.begin();
+            vector<uint32>::type::const_iterator end  = tree.taskRoots.end();
+            while( itor != end )
+            {
+                const Node &node = tree.nodes[*itor];
+                if( node.left != InvalidNode )
+                {
+                    nextLevel.push_back( node.left );
+                    nextLevel.push_back( node.right );
+                    anyInternal = true;
+                }
+                else
+                {
+                    nextLevel.push_back( *itor );
+                }
+                ++itor;
+            }
+
+            tree.taskRoots.swap( nextLevel );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticObjectBvh::cullFrustum( size_t renderQueue, const Camera *frustum,
+                                       uint32 sceneVisibilityFlags,
+                                       MovableObject::MovableObjectArray &outCulledObjects,
+                                       const Camera *lodCamera, size_t threadIdx )
+    {
+        if( renderQueue >= mTrees.size() )
+            return;
+
+        const Tree &tree = mTrees[renderQueue];
+        ThreadScratch &scratch = mThreadScratch[threadIdx];
+        scratch.intersecting.clear();
+        scratch.inside.clear();
+
+        for( size_t i=threadIdx; i<tree.infinitePacks.size(); i += mNumThreads )
+            scratch.intersecting.push_back( tree.infinitePacks[i] );
+
+        const Plane *planes = frustum->_getCachedFrustumPlanes();
+
+        //The tree is balanced, so its depth is at most log2( numPacks ) + 1.
+        uint32 stack[128];
+        bool insideStack[128];
+
+        for( size_t i=threadIdx; i<tree.taskRoots.size(); i += mNumThreads )
+        {
+            size_t stackSize = 0;
+            stack[stackSize] = tree.taskRoots[i];
+            insideStack[stackSize++] = false;
+
+            while( stackSize )
+            {
+                --stackSize;
+                const Node &node = tree.nodes[stack[stackSize]];
+                bool fullyInside = insideStack[stackSize];
+
+                if( !fullyInside )
+                {
+                    bool isOutside = false;
+                    fullyInside = true;
+                    for( size_t j=0; j<6u && !isOutside; ++j )
+                    {
+                        const Real dist   = planes[j].normal.dotProduct( node.aabb.mCenter ) +
+                                            planes[j].d;
+                        const Real radius = planes[j].normal.absDotProduct( node.aabb.mHalfSize );
+                        isOutside   = dist + radius <= Real( 0 );
+                        fullyInside = fullyInside && dist - radius > Real( 0 );
+                    }
+
+                    if( isOutside )
+                        continue;
+                }
+
+                if( node.left == InvalidNode )
+                {
+                    vector<uint32>::type &dst = fullyInside ? scratch.inside : scratch.intersecting;
+                    dst.insert( dst.end(), tree.packIndices.begin() + node.firstPack,
+                                tree.packIndices.begin() + node.firstPack + node.numPacks );
+                }
+                else
+                {
+                    assert( stackSize + 2u <= 128u );
+                    stack[stackSize] = node.left;
+                    insideStack[stackSize++] = fullyInside;
+                    stack[stackSize] = node.right;
+                    insideStack[stackSize++] = fullyInside;
+                }
+            }
+        }
+
+        ObjectData firstObjData;
+        mObjectMemoryManager->getFirstObjectData( firstObjData, renderQueue );
+
+        if( !scratch.intersecting.empty() )
+        {
+            MovableObject::cullFrustumPacks( &scratch.intersecting[0], scratch.intersecting.size(),
+                                             firstObjData, frustum, sceneVisibilityFlags,
+                                             outCulledObjects, lodCamera, true );
+        }
+        if( !scratch.inside.empty() )
+        {
+            MovableObject::cullFrustumPacks( &scratch.inside[0], scratch.inside.size(),
+                                             firstObjData, frustum, sceneVisibilityFlags,
+                                             outCulledObjects, lodCamera, false );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    size_t StaticObjectBvh::getNumNodes(void) const
+    {
+        size_t retVal = 0;
+        TreeVec::const_iterator itor = mTrees.begin();
+        TreeVec::const_iterator end  = mTrees.end();
+        while( itor != end )
+        {
+            retVal += itor->nodes.size();
+            ++itor;
+        }
+        return retVal;
+    }
+}
@@ -43,8 +43,434 @@ THE SOFTWARE.
 
 #include "OgreVertexShadowMapHelper.h"
 #include "OgreStringConverter.h"
+#include "OgreSceneManager.h"
+#include "Threading/OgreUniformScalableTask.h"
+
+#include "Math/Array/OgreArrayConfig.h"
+#include "Math/Array/OgreArrayVector3.h"
+#include "Math/Array/OgreMathlib.h"
+
+#if OGRE_USE_SIMD == 1 && OGRE_CPU == OGRE_CPU_X86
+    #define OGRE_VERTEX_CONVERSION_SSE2 1
+    //PlatformInformation has no F16C flag, so this relies on the compiler
+    //targeting it (i.e. -mf16c, -march=haswell or /arch:AVX2).
+    #if defined( __F16C__ ) || defined( __AVX2__ )
+        #include <immintrin.h>
+        #define OGRE_VERTEX_CONVERSION_F16C 1
+    #else
+        #define OGRE_VERTEX_CONVERSION_F16C 0
+    #endif
+#else
+    #define OGRE_VERTEX_CONVERSION_SSE2 0
+    #define OGRE_VERTEX_CONVERSION_F16C 0
+#endif
 
 namespace Ogre {
+    namespace
+    {
+        /// Vertices converted per element before moving on to the next element;
+        /// keeps the source and destination of each block in cache.
+        const uint32 c_conversionBlockSize = 1024u;
+
+#if OGRE_VERTEX_CONVERSION_SSE2
+        inline __m128i selectInt4( __m128i mask, __m128i a, __m128i b )
+        {
+            return _mm_or_si128( _mm_and_si128( mask, a ), _mm_andnot_si128( mask, b ) );
+        }
+        //-----------------------------------------------------------------------------------
+        /** Vectorised Bitwise::floatToHalfI. Produces exactly the same bits (i.e. truncates
+            the mantissa, flushes values below 2^-25 to +0 and overflows to Inf).
+        @return
+            The 4 halves in the low 64 bits.
+        */
+        inline __m128i floatToHalf4Exact( __m128 value )
+        {
+            const __m128i x     = _mm_castps_si128( value );
+            const __m128i absX  = _mm_and_si128( x, _mm_set1_epi32( 0x7fffffff ) );
+            const __m128i sign  = _mm_and_si128( _mm_srli_epi32( x, 16 ), _mm_set1_epi32( 0x8000 ) );
+
+            //Normalised: ((e - 112) << 10) | (m >> 13)
+            __m128i result = _mm_sub_epi32( _mm_srli_epi32( absX, 13 ), _mm_set1_epi32( 112 << 10 ) );
+
+            //Denormalised: (m | 0x800000) >> (14 - e), which is exactly |value| * 2^24 truncated.
+            const __m128i denormal = _mm_cvttps_epi32( _mm_mul_ps( _mm_castsi128_ps( absX ),
+                                                                   _mm_set1_ps( 16777216.0f ) ) );
+            result = selectInt4( _mm_cmplt_epi32( absX, _mm_set1_epi32( 113 << 23 ) ),
+                                 denormal, result );
+
+            //Overflow and Inf.
+            result = selectInt4( _mm_cmpgt_epi32( absX, _mm_set1_epi32( (143 << 23) - 1 ) ),
+                                 _mm_set1_epi32( 0x7c00 ), result );
+
+            //NaN keeps the top of the mantissa, but must not become Inf.
+            __m128i nanMantissa = _mm_srli_epi32( _mm_and_si128( x, _mm_set1_epi32( 0x007fffff ) ), 13 );
+            nanMantissa = _mm_or_si128( nanMantissa,
+                                        _mm_and_si128( _mm_cmpeq_epi32( nanMantissa,
+                                                                        _mm_setzero_si128() ),
+                                                       _mm_set1_epi32( 1 ) ) );
+            result = selectInt4( _mm_cmpgt_epi32( absX, _mm_set1_epi32( 0x7f800000 ) ),
+                                 _mm_or_si128( nanMantissa, _mm_set1_epi32( 0x7c00 ) ), result );
+
+            result = _mm_or_si128( result, sign );
+
+            //Too small: +0, the sign is dropped too.
+            result = _mm_andnot_si128( _mm_cmplt_epi32( absX, _mm_set1_epi32( 102 << 23 ) ), result );
+
+            //Sign-extend so that the saturating pack keeps the 16 bits as they are.
+            result = _mm_srai_epi32( _mm_slli_epi32( result, 16 ), 16 );
+            return _mm_packs_epi32( result, result );
+        }
+        //-----------------------------------------------------------------------------------
+        /// Loads 3 floats as (x, y, z, 1) without reading past them.
+        inline __m128 loadFloat3( const char *src )
+        {
+            const __m128 xy = _mm_loadl_pi( _mm_setzero_ps(), reinterpret_cast<const __m64*>( src ) );
+            const __m128 z1 = _mm_unpacklo_ps( _mm_load_ss( reinterpret_cast<const float*>( src ) + 2u ),
+                                               _mm_set1_ps( 1.0f ) );
+            return _mm_movelh_ps( xy, z1 );
+        }
+        //-----------------------------------------------------------------------------------
+        /// @See floatToHalf4Exact. Uses the F16C instruction when the compiler targets it.
+        inline __m128i floatToHalf4( __m128 value )
+        {
+#if OGRE_VERTEX_CONVERSION_F16C
+            //Truncating matches Bitwise::floatToHalf everywhere except overflow (F16C clamps
+            //to 65504), NaN payloads and tiny negatives (F16C keeps -0). Those are rare
+            //enough to just fall back to the exact version.
+            const __m128i x     = _mm_castps_si128( value );
+            const __m128i absX  = _mm_and_si128( x, _mm_set1_epi32( 0x7fffffff ) );
+            const __m128i special = _mm_or_si128(
+                        _mm_cmpgt_epi32( absX, _mm_set1_epi32( (143 << 23) - 1 ) ),
+                        _mm_and_si128( _mm_cmplt_epi32( absX, _mm_set1_epi32( 102 << 23 ) ),
+                                       _mm_cmplt_epi32( x, _mm_setzero_si128() ) ) );
+            if( _mm_movemask_epi8( special ) == 0 )
+                return _mm_cvtps_ph( value, _MM_FROUND_TO_ZERO );
+#endif
+            return floatToHalf4Exact( value );
+        }
+#endif
+        //-----------------------------------------------------------------------------------
+        /** Converts one float element of vertexCount vertices to half.
+            Missing components are filled with 0, except w which is filled with 1.
+        */
+        void convertToHalf( char * RESTRICT_ALIAS dst, size_t dstStride, size_t dstComponents,
+                            char const * RESTRICT_ALIAS src, size_t srcStride,
+                            size_t srcComponents, size_t vertexCount )
+        {
+            size_t i = 0;
+
+#if OGRE_VERTEX_CONVERSION_SSE2
+            if( dstComponents == 4u && srcComponents >= 3u )
+            {
+                for( ; i<vertexCount; ++i )
+                {
+                    //Don't read past the element, it may be the end of the buffer.
+                    const __m128 value = srcComponents == 4u ?
+                                             _mm_loadu_ps( reinterpret_cast<const float*>( src ) ) :
+                                             loadFloat3( src );
+
+                    _mm_storel_epi64( reinterpret_cast<__m128i*>( dst ), floatToHalf4( value ) );
+
+                    src += srcStride;
+                    dst += dstStride;
+                }
+            }
+            else if( dstComponents == 2u && srcComponents == 2u )
+            {
+                //Two vertices at a time.
+                for( ; i + 1u < vertexCount; i += 2u )
+                {
+                    __m128 value = _mm_loadl_pi( _mm_setzero_ps(),
+                                                 reinterpret_cast<const __m64*>( src ) );
+                    value = _mm_loadh_pi( value, reinterpret_cast<const __m64*>( src + srcStride ) );
+
+                    const __m128i halves = floatToHalf4( value );
+                    const int32 first   = _mm_cvtsi128_si32( halves );
+                    const int32 second  = _mm_cvtsi128_si32( _mm_srli_si128( halves, 4 ) );
+                    memcpy( dst, &first, sizeof(int32) );
+                    memcpy( dst + dstStride, &second, sizeof(int32) );
+
+                    src += srcStride * 2u;
+                    dst += dstStride * 2u;
+                }
+            }
+#endif
+
+            for( ; i<vertexCount; ++i )
+            {
+                float fpData[4];
+                fpData[0] = fpData[1] = fpData[2] = 0.0f;
+                fpData[3] = 1.0f;
+                memcpy( fpData, src, srcComponents * sizeof(float) );
+
+                uint16 *dstData16 = reinterpret_cast<uint16*>( dst );
+                for( size_t j=0; j<dstComponents; ++j )
+                    dstData16[j] = Bitwise::floatToHalf( fpData[j] );
+
+                src += srcStride;
+                dst += dstStride;
+            }
+        }
+        //-----------------------------------------------------------------------------------
+        inline ArrayReal loadArrayReal( const Real *aligned )
+        {
+            return *reinterpret_cast<const ArrayReal*>( aligned );
+        }
+        //-----------------------------------------------------------------------------------
+        /** Converts the normals & tangents (and optionally binormals) of vertexCount vertices
+            to QTangents, ARRAY_PACKED_REALS vertices at a time. Same results as the scalar
+            conversion (Matrix3 -> Quaternion) but for rounding.
+        @param tangentSrc
+            3 or 4 floats. The 4th component is the reflection.
+        @param binormalSrc
+            Optional. When present, the reflection is computed from it.
+        */
+        void convertToQTangents( char * RESTRICT_ALIAS dst, size_t dstStride,
+                                 const SubMesh::SourceData &normalSrc,
+                                 const SubMesh::SourceData &tangentSrc,
+                                 const SubMesh::SourceData *binormalSrc,
+                                 size_t vertexCount )
+        {
+            const size_t tangentSize = v1::VertexElement::getTypeSize( tangentSrc.element.mType );
+            assert( v1::VertexElement::getTypeSize( normalSrc.element.mType ) == sizeof(float) * 3 );
+            assert( tangentSize <= sizeof(float) * 4 && tangentSize >= sizeof(float) * 3 );
+            const bool hasTangentW = tangentSize == sizeof(float) * 4;
+            assert( !binormalSrc ||
+                    v1::VertexElement::getTypeSize( binormalSrc->element.mType ) == sizeof(float) * 3 );
+
+            //Bias = 1 / [2^(bits-1) - 1]
+            const ArrayReal bias        = Mathlib::SetAll( 1.0f / 32767.0f );
+            const ArrayReal normFactor  = Mathlib::SetAll( Math::Sqrt( 1.0f - (1.0f / 32767.0f) *
+                                                                              (1.0f / 32767.0f) ) );
+            const ArrayReal zero        = Mathlib::SetAll( 0.0f );
+            const ArrayReal one         = Mathlib::ONE;
+
+            for( size_t i=0; i<vertexCount; i += ARRAY_PACKED_REALS )
+            {
+                const size_t numLanes = std::min<size_t>( ARRAY_PACKED_REALS, vertexCount - i );
+
+                ArrayVector3 vNormal, vTangent, vBinormal;
+                ArrayReal tangentW;
+
+#if OGRE_VERTEX_CONVERSION_SSE2 && OGRE_DOUBLE_PRECISION == 0
+                {
+                    __m128 normal[4], tangent[4], binormal[4];
+                    for( size_t j=0; j<4u; ++j )
+                    {
+                        //Unused lanes repeat the last vertex.
+                        const size_t idx = i + std::min( j, numLanes - 1u );
+                        const char *tangentData = tangentSrc.data + idx * tangentSrc.bytesPerVertex;
+
+                        normal[j]   = loadFloat3( normalSrc.data + idx * normalSrc.bytesPerVertex );
+                        tangent[j]  = hasTangentW ?
+                                          _mm_loadu_ps( reinterpret_cast<const float*>( tangentData ) ) :
+                                          loadFloat3( tangentData );
+                        binormal[j] = binormalSrc ?
+                                          loadFloat3( binormalSrc->data +
+                                                      idx * binormalSrc->bytesPerVertex ) :
+                                          _mm_setzero_ps();
+                    }
+
+                    _MM_TRANSPOSE4_PS( normal[0], normal[1], normal[2], normal[3] );
+                    _MM_TRANSPOSE4_PS( tangent[0], tangent[1], tangent[2], tangent[3] );
+                    _MM_TRANSPOSE4_PS( binormal[0], binormal[1], binormal[2], binormal[3] );
+
+                    vNormal     = ArrayVector3( normal[0], normal[1], normal[2] );
+                    vTangent    = ArrayVector3( tangent[0], tangent[1], tangent[2] );
+                    vBinormal   = ArrayVector3( binormal[0], binormal[1], binormal[2] );
+                    tangentW    = tangent[3];
+                }
+#else
+                {
+                    //Normal xyz, tangent xyzw, binormal xyz; in SoA form.
+                    OGRE_ALIGNED_DECL( Real, soa[10][ARRAY_PACKED_REALS], OGRE_SIMD_ALIGNMENT );
+
+                    for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
+                    {
+                        //Unused lanes repeat the last vertex.
+                        const size_t idx = i + std::min( j, numLanes - 1u );
+
+                        float normal[3];
+                        float tangent[4];
+                        float binormal[3];
+                        tangent[3] = 1.0f;
+                        binormal[0] = binormal[1] = binormal[2] = 0.0f;
+                        memcpy( normal, normalSrc.data + idx * normalSrc.bytesPerVertex,
+                                sizeof(normal) );
+                        memcpy( tangent, tangentSrc.data + idx * tangentSrc.bytesPerVertex,
+                                hasTangentW ? sizeof(float) * 4u : sizeof(float) * 3u );
+                        if( binormalSrc )
+                        {
+                            memcpy( binormal, binormalSrc->data + idx * binormalSrc->bytesPerVertex,
+                                    sizeof(binormal) );
+                        }
+
+                        for( size_t k=0; k<3u; ++k )
+                        {
+                            soa[k][j]       = normal[k];
+                            soa[3u + k][j]  = tangent[k];
+                            soa[7u + k][j]  = binormal[k];
+                        }
+                        soa[6][j] = tangent[3];
+                    }
+
+                    vNormal     = ArrayVector3( loadArrayReal( soa[0] ), loadArrayReal( soa[1] ),
+                                                loadArrayReal( soa[2] ) );
+                    vTangent    = ArrayVector3( loadArrayReal( soa[3] ), loadArrayReal( soa[4] ),
+                                                loadArrayReal( soa[5] ) );
+                    vBinormal   = ArrayVector3( loadArrayReal( soa[7] ), loadArrayReal( soa[8] ),
+                                                loadArrayReal( soa[9] ) );
+                    tangentW    = loadArrayReal( soa[6] );
+                }
+#endif
+
+                const ArrayVector3 vCross = vNormal.crossProduct( vTangent );
+
+                //Reflected if tangent.w < 0, or if the binormal goes against the natural one.
+                ArrayMaskR reflected = Mathlib::CompareLess( tangentW, zero );
+                if( binormalSrc )
+                {
+                    const ArrayVector3 naturalBinormal = vTangent.crossProduct( vNormal );
+                    reflected = Mathlib::Or( reflected,
+                                             Mathlib::CompareLessEqual(
+                                                 naturalBinormal.dotProduct( vBinormal ), zero ) );
+                }
+
+                //TBN matrix with the normal, tangent & their cross product as columns.
+                const ArrayReal m00 = vNormal.mChunkBase[0];
+                const ArrayReal m10 = vNormal.mChunkBase[1];
+                const ArrayReal m20 = vNormal.mChunkBase[2];
+                const ArrayReal m01 = vTangent.mChunkBase[0];
+                const ArrayReal m11 = vTangent.mChunkBase[1];
+                const ArrayReal m21 = vTangent.mChunkBase[2];
+                const ArrayReal m02 = vCross.mChunkBase[0];
+                const ArrayReal m12 = vCross.mChunkBase[1];
+                const ArrayReal m22 = vCross.mChunkBase[2];
+
+                //Branchless Quaternion::FromRotationMatrix: evaluate the four cases of
+                //Shoemake's algorithm, pick the same one the scalar version would, then
+                //normalise. Each case is the scalar result times 2 * sqrt( t ). In wxyz order.
+                const ArrayReal qW[4] = { one + m00 + m11 + m22, m21 - m12, m02 - m20, m10 - m01 };
+                const ArrayReal qX[4] = { m21 - m12, one + m00 - m11 - m22, m01 + m10, m02 + m20 };
+                const ArrayReal qY[4] = { m02 - m20, m01 + m10, one - m00 + m11 - m22, m12 + m21 };
+                const ArrayReal qZ[4] = { m10 - m01, m02 + m20, m12 + m21, one - m00 - m11 + m22 };
+
+                const ArrayMaskR pickY = Mathlib::CompareGreater( m11, m00 );
+                const ArrayMaskR pickZ = Mathlib::CompareGreater( m22, Mathlib::Cmov4( m11, m00,
+                                                                                       pickY ) );
+                const ArrayMaskR pickW = Mathlib::CompareGreater( m00 + m11 + m22, zero );
+
+                ArrayReal q[4];
+                for( size_t k=0; k<4u; ++k )
+                {
+                    q[k] = Mathlib::Cmov4( qW[k], Mathlib::Cmov4( qZ[k], Mathlib::Cmov4( qY[k], qX[k],
+                                                                                        pickY ),
+                                                                  pickZ ),
+                                           pickW );
+                }
+
+                //Normalise, and make sure QTangent is always positive
+                const ArrayReal invLength = Mathlib::InvSqrt4( q[0] * q[0] + q[1] * q[1] +
+                                                               q[2] * q[2] + q[3] * q[3] );
+                const ArrayReal sign = Mathlib::Cmov4( Mathlib::NEG_ONE, one,
+                                                       Mathlib::CompareLess( q[0], zero ) );
+                for( size_t k=0; k<4u; ++k )
+                    q[k] = (q[k] * invLength) * sign;
+
+                //Because '-0' sign information is lost when using integers,
+                //we need to apply a "bias"; while making sure the Quatenion
+                //stays normalized.
+                // ** Also our shaders assume qTangent.w is never 0. **
+                const ArrayMaskR needsBias = Mathlib::CompareLess( q[0], bias );
+                q[0] = Mathlib::Cmov4( bias, q[0], needsBias );
+                for( size_t k=1; k<4u; ++k )
+                    q[k] = Mathlib::Cmov4( q[k] * normFactor, q[k], needsBias );
+
+                //Now negate if we require reflection
+                const ArrayReal reflection = Mathlib::Cmov4( Mathlib::NEG_ONE, one, reflected );
+                for( size_t k=0; k<4u; ++k )
+                    q[k] = q[k] * reflection;
+
+#if OGRE_VERTEX_CONVERSION_SSE2 && OGRE_DOUBLE_PRECISION == 0
+                //Bitwise::floatToSnorm16 on all lanes, then transpose to xyzw per vertex.
+                __m128i snorm[4];
+                for( size_t k=0; k<4u; ++k )
+                {
+                    ArrayReal v = q[k] * Mathlib::SetAll( 32767.0f );
+                    v = v + Mathlib::Cmov4( Mathlib::HALF, -Mathlib::HALF,
+                                            Mathlib::CompareGreaterEqual( v, zero ) );
+                    v = Mathlib::Min( Mathlib::Max( v, Mathlib::SetAll( -32768.0f ) ),
+                                      Mathlib::SetAll( 32767.0f ) );
+                    snorm[k] = _mm_cvttps_epi32( v );
+                }
+
+                const __m128i xy = _mm_packs_epi32( snorm[1], snorm[2] );
+                const __m128i zw = _mm_packs_epi32( snorm[3], snorm[0] );
+                const __m128i xzxz = _mm_unpacklo_epi16( xy, zw );
+                const __m128i ywyw = _mm_unpackhi_epi16( xy, zw );
+                __m128i xyzw[2];
+                xyzw[0] = _mm_unpacklo_epi16( xzxz, ywyw );
+                xyzw[1] = _mm_unpackhi_epi16( xzxz, ywyw );
+
+                for( size_t j=0; j<numLanes; ++j )
+                {
+                    const __m128i vertex = (j & 1u) ? _mm_srli_si128( xyzw[j >> 1u], 8 ) :
+                                                      xyzw[j >> 1u];
+                    _mm_storel_epi64( reinterpret_cast<__m128i*>( dst + (i + j) * dstStride ),
+                                      vertex );
+                }
+#else
+                OGRE_ALIGNED_DECL( Real, result[4][ARRAY_PACKED_REALS], OGRE_SIMD_ALIGNMENT );
+                for( size_t k=0; k<4u; ++k )
+                    *reinterpret_cast<ArrayReal*>( result[k] ) = q[k];
+
+                for( size_t j=0; j<numLanes; ++j )
+                {
+                    int16 *dstData16 = reinterpret_cast<int16*>( dst + (i + j) * dstStride );
+                    dstData16[0] = Bitwise::floatToSnorm16( result[1][j] );
+                    dstData16[1] = Bitwise::floatToSnorm16( result[2][j] );
+                    dstData16[2] = Bitwise::floatToSnorm16( result[3][j] );
+                    dstData16[3] = Bitwise::floatToSnorm16( result[0][j] );
+                }
+#endif
+            }
+        }
+        //-----------------------------------------------------------------------------------
+        inline SubMesh::SourceData offsetSourceData( const SubMesh::SourceData &src,
+                                                     size_t firstVertex )
+        {
+            return SubMesh::SourceData( src.data + firstVertex * src.bytesPerVertex,
+                                        src.bytesPerVertex, src.element );
+        }
+        //-----------------------------------------------------------------------------------
+        /// Runs SubMesh::_arrangeEfficient on a set of jobs from the worker threads.
+        class ArrangeEfficientTask : public UniformScalableTask
+        {
+            const SubMesh::ArrangeEfficientJobPtrArray &mJobs;
+
+        public:
+            ArrangeEfficientTask( const SubMesh::ArrangeEfficientJobPtrArray &jobs ) :
+                mJobs( jobs ) {}
+
+            virtual void execute( size_t threadId, size_t numThreads )
+            {
+                //Jobs are sorted from biggest to smallest, so interleaving them
+                //keeps the threads reasonably balanced.
+                for( size_t i=threadId; i<mJobs.size(); i += numThreads )
+                {
+                    SubMesh::ArrangeEfficientJob *job = mJobs[i];
+                    job->data = SubMesh::_arrangeEfficient( job->srcData, job->vertexElements,
+                                                            job->vertexCount );
+                }
+            }
+        };
+        //-----------------------------------------------------------------------------------
+        bool OrderArrangeEfficientJobBySizeDesc( const SubMesh::ArrangeEfficientJob *l,
+                                                 const SubMesh::ArrangeEfficientJob *r )
+        {
+            return l->vertexCount > r->vertexCount;
+        }
+    }
     //-----------------------------------------------------------------------
     SubMesh::SubMesh() :
         mParent( 0 ),
@@ -492,7 +918,8 @@ namespace Ogre {
         return 0;
     }
     //---------------------------------------------------------------------
-    void SubMesh::importFromV1( v1::SubMesh *subMesh, bool halfPos, bool halfTexCoords, bool qTangents )
+    void SubMesh::importFromV1( v1::SubMesh *subMesh, bool halfPos, bool halfTexCoords, bool qTangents,
+                                ArrangeEfficientJob *convertedJobs )
     {
         mMaterialName = subMesh->getMaterialName();
 
@@ -517,7 +944,8 @@ namespace Ogre {
         mBlendIndexToBoneIndexMap = subMesh->blendIndexToBoneIndexMap;
         mBoneAssignmentsOutOfDate = false;
 
-        importBuffersFromV1( subMesh, halfPos, halfTexCoords, qTangents, 0 );
+        importBuffersFromV1( subMesh, halfPos, halfTexCoords, qTangents, 0,
+                             convertedJobs ? &convertedJobs[VpNormal] : 0 );
 
         assert( subMesh->parent->hasValidShadowMappingBuffers() );
 
@@ -526,7 +954,8 @@ namespace Ogre {
             subMesh->indexData[VpNormal] != subMesh->indexData[VpShadow] )
         {
             //Use the special version already built for v1
-            importBuffersFromV1( subMesh, halfPos, halfTexCoords, qTangents, 1 );
+            importBuffersFromV1( subMesh, halfPos, halfTexCoords, qTangents, 1,
+                                 convertedJobs ? &convertedJobs[VpShadow] : 0 );
         }
         else
         {
@@ -536,11 +965,24 @@ namespace Ogre {
     }
     //---------------------------------------------------------------------
     void SubMesh::importBuffersFromV1( v1::SubMesh *subMesh, bool halfPos, bool halfTexCoords,
-                                       bool qTangents, size_t vaoPassIdx )
+                                       bool qTangents, size_t vaoPassIdx,
+                                       ArrangeEfficientJob *convertedJob )
     {
         VertexElement2Vec vertexElements;
-        char *data = _arrangeEfficient( subMesh, halfPos, halfTexCoords, qTangents, &vertexElements,
-                                        vaoPassIdx );
+        char *data = 0;
+
+        if( convertedJob && convertedJob->data )
+        {
+            //Already converted. Take ownership.
+            data = convertedJob->data;
+            convertedJob->data = 0;
+            vertexElements.swap( convertedJob->vertexElements );
+        }
+        else
+        {
+            data = _arrangeEfficient( subMesh, halfPos, halfTexCoords, qTangents, &vertexElements,
+                                      vaoPassIdx );
+        }
 
         //Wrap the ptrs around these, because the VaoManager's call
         //can throw thus causing a leak if we don't free them.
@@ -618,27 +1060,129 @@ namespace Ogre {
     //---------------------------------------------------------------------
     void SubMesh::arrangeEfficient( bool halfPos, bool halfTexCoords, bool qTangents )
     {
-        uint8 numVaoPasses = mParent->hasIndependentShadowMappingVaos() + 1;
+        ArrangeEfficientJobVec jobs;
+        _prepareArrangeEfficient( halfPos, halfTexCoords, qTangents, jobs );
+
+        ArrangeEfficientJobPtrArray jobPtrs;
+        jobPtrs.reserve( jobs.size() );
+        for( size_t i=0; i<jobs.size(); ++i )
+            jobPtrs.push_back( &jobs[i] );
+
+        _arrangeEfficient( jobPtrs, 0 );
+        _finishArrangeEfficient( jobs );
+    }
+    //---------------------------------------------------------------------
+    void SubMesh::_prepareArrangeEfficient( bool halfPos, bool halfTexCoords, bool qTangents,
+                                            ArrangeEfficientJobVec &outJobs )
+    {
+        const uint8 numVaoPasses = mParent->hasIndependentShadowMappingVaos() + 1;
+
+        for( uint8 vaoPassIdx=0; vaoPassIdx<numVaoPasses; ++vaoPassIdx )
+        {
+            //Vertex buffers may be shared across Vaos (i.e. LODs). Convert them only once.
+            set<VertexBufferPacked*>::type usedBuffers;
+
+            VertexArrayObjectArray::const_iterator itor = mVao[vaoPassIdx].begin();
+            VertexArrayObjectArray::const_iterator end  = mVao[vaoPassIdx].end();
+
+            while( itor != end )
+            {
+                const VertexBufferPackedVec &vertexBuffers = (*itor)->getVertexBuffers();
+
+                if( usedBuffers.insert( vertexBuffers[0] ).second )
+                {
+                    outJobs.push_back( ArrangeEfficientJob() );
+                    ArrangeEfficientJob &job = outJobs.back();
+                    job.vertexCount     = static_cast<uint32>( vertexBuffers[0]->getNumElements() );
+                    job.vaoPassIdx      = vaoPassIdx;
+                    job.srcVertexBuffer = vertexBuffers[0];
+
+                    VertexElement2VecVec srcVertexElements;
+                    FastArray<char const *> srcPtrs;
+
+                    for( size_t i=0; i<vertexBuffers.size(); ++i )
+                    {
+                        //Retrieve the data from each buffer
+                        AsyncTicketPtr asyncTicket = vertexBuffers[i]->readRequest(
+                                                            0, vertexBuffers[i]->getNumElements() );
+                        job.asyncTickets.push_back( asyncTicket );
+                        srcPtrs.push_back( reinterpret_cast<const char*>( asyncTicket->map() ) );
+                        srcVertexElements.push_back( vertexBuffers[i]->getVertexElements() );
+                    }
+
+                    //Setup the VertexElement array and the srcData for the conversion.
+                    _getEfficientFormat( srcVertexElements, srcPtrs, halfPos, halfTexCoords,
+                                         qTangents, &job.vertexElements, &job.srcData );
+                }
+
+                ++itor;
+            }
+        }
+    }
+    //---------------------------------------------------------------------
+    void SubMesh::_finishArrangeEfficient( ArrangeEfficientJobVec &jobs )
+    {
+        VaoManager *vaoManager = mParent->mVaoManager;
+        const uint8 numVaoPasses = mParent->hasIndependentShadowMappingVaos() + 1;
 
         for( uint8 vaoPassIdx=0; vaoPassIdx<numVaoPasses; ++vaoPassIdx )
         {
+            SharedVertexBufferMap sharedBuffers;
+
+            ArrangeEfficientJobVec::iterator itJob = jobs.begin();
+            ArrangeEfficientJobVec::iterator enJob = jobs.end();
+
+            while( itJob != enJob )
+            {
+                if( itJob->vaoPassIdx == vaoPassIdx )
+                {
+                    //Cleanup the mappings, free some memory.
+                    for( size_t i=0; i<itJob->asyncTickets.size(); ++i )
+                        itJob->asyncTickets[i]->unmap();
+                    itJob->asyncTickets.clear();
+
+                    FreeOnDestructor dataPtrContainer( itJob->data );
+                    itJob->data = 0;
+
+                    //Create the new vertex buffer.
+                    VertexBufferPacked *srcVertexBuffer = itJob->srcVertexBuffer;
+                    const bool keepAsShadow = srcVertexBuffer->getShadowCopy() != 0;
+                    VertexBufferPacked *newVertexBuffer = vaoManager->createVertexBuffer(
+                                itJob->vertexElements, srcVertexBuffer->getNumElements(),
+                                srcVertexBuffer->getBufferType(), dataPtrContainer.ptr,
+                                keepAsShadow );
+
+                    if( keepAsShadow ) //Don't free the pointer ourselves
+                        dataPtrContainer.ptr = 0;
+
+                    sharedBuffers[srcVertexBuffer] = newVertexBuffer;
+                }
+
+                ++itJob;
+            }
+
             VertexArrayObjectArray newVaos;
             newVaos.reserve( mVao[vaoPassIdx].size() );
-            SharedVertexBufferMap sharedBuffers;
             VertexArrayObjectArray::const_iterator itor = mVao[vaoPassIdx].begin();
             VertexArrayObjectArray::const_iterator end  = mVao[vaoPassIdx].end();
 
             while( itor != end )
             {
-                newVaos.push_back( arrangeEfficient( halfPos, halfTexCoords, qTangents, *itor,
-                                                     sharedBuffers, mParent->mVaoManager ) );
+                const VertexArrayObject *vao = *itor;
+
+                VertexBufferPackedVec newVertexBuffers;
+                newVertexBuffers.push_back( sharedBuffers[vao->getVertexBuffers()[0]] );
+
+                newVaos.push_back( vaoManager->createVertexArrayObject( newVertexBuffers,
+                                                                        vao->getIndexBuffer(),
+                                                                        vao->getOperationType() ) );
                 ++itor;
             }
 
             mVao[vaoPassIdx].swap( newVaos );
             //Now 'newVaos' contains the old ones. We need to destroy all of them at
             //the end because vertex buffers may be shared while we still iterate.
-            destroyVaos( newVaos, mParent->mVaoManager, false );
+            destroyVaos( newVaos, vaoManager, false );
         }
 
         //If we shared vaos, we need to share the new Vaos (and remove the dangling pointers)
@@ -646,124 +1190,79 @@ namespace Ogre {
             mVao[VpShadow] = mVao[VpNormal];
     }
     //---------------------------------------------------------------------
-    VertexArrayObject* SubMesh::arrangeEfficient( bool halfPos, bool halfTexCoords, bool qTangents,
-                                                  VertexArrayObject *vao,
-                                                  SharedVertexBufferMap &sharedBuffers,
-                                                  VaoManager *vaoManager )
+    void SubMesh::_getEfficientFormat( const VertexElement2VecVec &srcVertexElements,
+                                       const FastArray<char const*> &srcPtrs,
+                                       bool halfPos, bool halfTexCoords, bool qTangents,
+                                       VertexElement2Vec *outVertexElements,
+                                       SourceDataArray *outSrcData )
     {
-        const VertexBufferPackedVec &vertexBuffers = vao->getVertexBuffers();
-        VertexBufferPacked *newVertexBuffer = 0;
+        assert( srcVertexElements.size() == srcPtrs.size() );
 
-        SharedVertexBufferMap::const_iterator itShared = sharedBuffers.find( vertexBuffers[0] );
-        if( itShared != sharedBuffers.end() )
-        {
-            //Shared vertex buffer. We've already converted this one. Reuse.
-            newVertexBuffer = itShared->second;
-        }
-        else
-        {
-            VertexElement2Vec vertexElements;
-            SourceDataArray srcData;
-            bool hasTangents = false;
+        bool hasTangents = false;
 
-            vector<AsyncTicketPtr>::type asyncTickets;
-            FastArray<char const *> srcPtrs;
+        for( size_t i=0; i<srcVertexElements.size(); ++i )
+        {
+            const size_t bytesPerVertex = VaoManager::calculateVertexSize( srcVertexElements[i] );
+            size_t accumOffset = 0, reorderedElements = 0;
+            VertexElement2Vec::const_iterator itor = srcVertexElements[i].begin();
+            VertexElement2Vec::const_iterator end  = srcVertexElements[i].end();
 
-            for( size_t i=0; i<vertexBuffers.size(); ++i )
+            while( itor != end )
             {
-                //Retrieve the data from each buffer
-                AsyncTicketPtr asyncTicket = vertexBuffers[i]->readRequest(
-                                                    0, vertexBuffers[i]->getNumElements() );
-                asyncTickets.push_back( asyncTicket );
-                srcPtrs.push_back( reinterpret_cast<const char*>( asyncTicket->map() ) );
+                const VertexElement2 &origElement = *itor;
 
-                //Setup the VertexElement array and the srcData for the conversion.
-                size_t accumOffset = 0, reorderedElements = 0;
-                VertexElement2Vec::const_iterator itor = vertexBuffers[i]->getVertexElements().begin();
-                VertexElement2Vec::const_iterator end  = vertexBuffers[i]->getVertexElements().end();
+                const SourceData sourceData( srcPtrs[i] + accumOffset,
+                                             bytesPerVertex,
+                                             *itor );
 
-                while( itor != end )
+                if( origElement.mSemantic == VES_TANGENT ||
+                    origElement.mSemantic == VES_BINORMAL )
                 {
-                    const VertexElement2 &origElement = *itor;
-
-                    const SourceData sourceData( srcPtrs.back() + accumOffset,
-                                                 vertexBuffers[i]->getBytesPerElement(),
-                                                 *itor );
-
-                    if( origElement.mSemantic == VES_TANGENT ||
-                        origElement.mSemantic == VES_BINORMAL )
-                    {
-                        hasTangents = true;
-                        //Put VES_TANGENT & VES_BINORMAL at the bottom of the array.
-                        srcData.push_back( sourceData );
-                        ++reorderedElements;
-                    }
-                    else
-                    {
-                        vertexElements.push_back( origElement );
-                        srcData.insert( srcData.end() - reorderedElements, sourceData );
-                    }
+                    hasTangents = true;
+                    //Put VES_TANGENT & VES_BINORMAL at the bottom of the array.
+                    outSrcData->push_back( sourceData );
+                    ++reorderedElements;
+                }
+                else
+                {
+                    outVertexElements->push_back( origElement );
+                    outSrcData->insert( outSrcData->end() - reorderedElements, sourceData );
+                }
 
-                    accumOffset += v1::VertexElement::getTypeSize( itor->mType );
+                accumOffset += v1::VertexElement::getTypeSize( itor->mType );
 
-                    //We can't convert to half if it wasn't in floating point
-                    //Also avoid converting 1 Float ==> 2 Half.
-                    if( v1::VertexElement::getBaseType( origElement.mType ) == VET_FLOAT1 &&
-                        v1::VertexElement::getTypeCount( origElement.mType ) != 1 )
+                //We can't convert to half if it wasn't in floating point
+                //Also avoid converting 1 Float ==> 2 Half.
+                if( v1::VertexElement::getBaseType( origElement.mType ) == VET_FLOAT1 &&
+                    v1::VertexElement::getTypeCount( origElement.mType ) != 1 )
+                {
+                    if( (origElement.mSemantic == VES_POSITION && halfPos) ||
+                        (origElement.mSemantic == VES_TEXTURE_COORDINATES && halfTexCoords) )
                     {
-                        if( (origElement.mSemantic == VES_POSITION && halfPos) ||
-                            (origElement.mSemantic == VES_TEXTURE_COORDINATES && halfTexCoords) )
-                        {
-                            VertexElementType type = v1::VertexElement::multiplyTypeCount(
-                                        VET_HALF2, v1::VertexElement::getTypeCount( origElement.mType ) );
+                        VertexElementType type = v1::VertexElement::multiplyTypeCount(
+                                    VET_HALF2, v1::VertexElement::getTypeCount( origElement.mType ) );
 
-                            VertexElement2 &lastInserted = *(vertexElements.end() -
-                                                             reorderedElements - 1);
-                            lastInserted.mType = type;
-                        }
+                        //Tangents & binormals aren't in outVertexElements (only in
+                        //outSrcData), so the element we just pushed is always the last one.
+                        VertexElement2 &lastInserted = outVertexElements->back();
+                        lastInserted.mType = type;
                     }
-
-                    ++itor;
                 }
 
-                //If the vertex format has tangents, prepare the normal to hold QTangents.
-                if( hasTangents == true && qTangents )
-                {
-                    VertexElement2Vec::iterator it = std::find( vertexElements.begin(),
-                                                                vertexElements.end(),
-                                                                VertexElement2( VET_FLOAT3,
-                                                                                VES_NORMAL ) );
-                    if( it != vertexElements.end() )
-                        it->mType = VET_SHORT4_SNORM;
-                }
+                ++itor;
             }
 
-            char *data = _arrangeEfficient( srcData, vertexElements, vertexBuffers[0]->getNumElements() );
-            FreeOnDestructor dataPtrContainer( data );
-
-            //Cleanup the mappings, free some memory.
-            for( size_t i=0; i<asyncTickets.size(); ++i )
-                asyncTickets[i]->unmap();
-            asyncTickets.clear();
-
-            //Create the new vertex buffer.
-            const bool keepAsShadow = vertexBuffers[0]->getShadowCopy() != 0;
-            newVertexBuffer = vaoManager->createVertexBuffer( vertexElements,
-                                                              vertexBuffers[0]->getNumElements(),
-                                                              vertexBuffers[0]->getBufferType(),
-                                                              data, keepAsShadow );
-
-            if( keepAsShadow ) //Don't free the pointer ourselves
-                dataPtrContainer.ptr = 0;
-
-            sharedBuffers[vertexBuffers[0]] = newVertexBuffer;
+            //If the vertex format has tangents, prepare the normal to hold QTangents.
+            if( hasTangents == true && qTangents )
+            {
+                VertexElement2Vec::iterator it = std::find( outVertexElements->begin(),
+                                                            outVertexElements->end(),
+                                                            VertexElement2( VET_FLOAT3,
+                                                                            VES_NORMAL ) );
+                if( it != outVertexElements->end() )
+                    it->mType = VET_SHORT4_SNORM;
+            }
         }
-
-        VertexBufferPackedVec newVertexBuffers;
-        newVertexBuffers.push_back( newVertexBuffer );
-
-        return vaoManager->createVertexArrayObject( newVertexBuffers, vao->getIndexBuffer(),
-                                                    vao->getOperationType() );
     }
     //---------------------------------------------------------------------
     bool sortVertexElementsBySemantic2( const VertexElement2 &l, const VertexElement2 &r )
@@ -781,6 +1280,25 @@ namespace Ogre {
     char* SubMesh::_arrangeEfficient( v1::SubMesh *subMesh, bool halfPos, bool halfTexCoords,
                                       bool qTangents, VertexElement2Vec *outVertexElements,
                                       size_t vaoPassIdx )
+    {
+        ArrangeEfficientJob job;
+        _prepareArrangeEfficient( subMesh, halfPos, halfTexCoords, qTangents, vaoPassIdx, &job );
+
+        //Perform actual transfer
+        char *retVal = _arrangeEfficient( job.srcData, job.vertexElements, job.vertexCount );
+
+        //Cleanup
+        _unlockSourceBuffers( subMesh, vaoPassIdx );
+
+        if( outVertexElements )
+            outVertexElements->swap( job.vertexElements );
+
+        return retVal;
+    }
+    //---------------------------------------------------------------------
+    void SubMesh::_prepareArrangeEfficient( v1::SubMesh *subMesh, bool halfPos, bool halfTexCoords,
+                                            bool qTangents, size_t vaoPassIdx,
+                                            ArrangeEfficientJob *outJob )
     {
         typedef FastArray<v1::VertexElement> VertexElementArray;
 
@@ -904,18 +1422,42 @@ namespace Ogre {
             ++itor;
         }
 
-        //Perform actual transfer
-        char *retVal = _arrangeEfficient( sourceData, vertexElements,
-                                          static_cast<uint32>(vertexData->vertexCount) );
-
-        //Cleanup
+        outJob->srcData.swap( sourceData );
+        outJob->vertexElements.swap( vertexElements );
+        outJob->vertexCount = static_cast<uint32>( vertexData->vertexCount );
+        outJob->vaoPassIdx  = static_cast<uint8>( vaoPassIdx );
+    }
+    //---------------------------------------------------------------------
+    void SubMesh::_unlockSourceBuffers( v1::SubMesh *subMesh, size_t vaoPassIdx )
+    {
+        v1::VertexData *vertexData = subMesh->vertexData[vaoPassIdx];
         for( size_t i=0; i<vertexData->vertexBufferBinding->getBufferCount(); ++i )
             vertexData->vertexBufferBinding->getBuffer( i )->unlock();
+    }
+    //---------------------------------------------------------------------
+    void SubMesh::_arrangeEfficient( const ArrangeEfficientJobPtrArray &jobs,
+                                     SceneManager *sceneManager )
+    {
+        if( !sceneManager || sceneManager->getNumWorkerThreads() <= 1u || jobs.size() <= 1u )
+        {
+            ArrangeEfficientJobPtrArray::const_iterator itor = jobs.begin();
+            ArrangeEfficientJobPtrArray::const_iterator end  = jobs.end();
 
-        if( outVertexElements )
-            outVertexElements->swap( vertexElements );
+            while( itor != end )
+            {
+                (*itor)->data = _arrangeEfficient( (*itor)->srcData, (*itor)->vertexElements,
+                                                   (*itor)->vertexCount );
+                ++itor;
+            }
+        }
+        else
+        {
+            ArrangeEfficientJobPtrArray sortedJobs( jobs );
+            std::sort( sortedJobs.begin(), sortedJobs.end(), OrderArrangeEfficientJobBySizeDesc );
 
-        return retVal;
+            ArrangeEfficientTask task( sortedJobs );
+            sceneManager->executeUserScalableTask( &task, true );
+        }
     }
     //---------------------------------------------------------------------
     char* SubMesh::_arrangeEfficient( SourceDataArray srcData,
@@ -926,10 +1468,9 @@ namespace Ogre {
         size_t vertexSize = VaoManager::calculateVertexSize( vertexElements );
         char *data = static_cast<char*>( OGRE_MALLOC_SIMD( vertexSize * vertexCount,
                                                            MEMCATEGORY_GEOMETRY ) );
-        char *dstData = data;
 
-        SourceData *tangentSrc = 0;
-        SourceData *binormalSrc = 0;
+        const SourceData *tangentSrc = 0;
+        const SourceData *binormalSrc = 0;
 
         {
             //Find the pointers for tangentSrc & binormalSrc (may both be null) since
@@ -951,8 +1492,8 @@ namespace Ogre {
 
             if( wantsQTangents )
             {
-                SourceDataArray::iterator itor = srcData.begin();
-                SourceDataArray::iterator end  = srcData.end();
+                SourceDataArray::const_iterator itor = srcData.begin();
+                SourceDataArray::const_iterator end  = srcData.end();
 
                 while( itor != end )
                 {
@@ -983,140 +1524,75 @@ namespace Ogre {
         //Perform the transfer. Note that vertexElements & srcElements do not match.
         //As vertexElements is modified for smaller types and may include padding
         //for alignment reasons.
-        for( size_t i=0; i<vertexCount; ++i )
+        //Each element is converted for a block of vertices at a time, so that
+        //the conversions can be vectorised.
+        for( uint32 blockStart=0; blockStart<vertexCount; blockStart += c_conversionBlockSize )
         {
+            const uint32 blockSize = std::min( c_conversionBlockSize, vertexCount - blockStart );
+            char *dstData = data + blockStart * vertexSize;
+
             size_t acumOffset = 0;
             VertexElement2Vec::const_iterator itor = vertexElements.begin();
             VertexElement2Vec::const_iterator end  = vertexElements.end();
-            SourceDataArray::iterator itSrc = srcData.begin();
+            SourceDataArray::const_iterator itSrc = srcData.begin();
 
             while( itor != end )
             {
                 const VertexElement2 &vElement = *itor;
-                size_t writeSize = v1::VertexElement::getTypeSize( vElement.mType );
+                const size_t writeSize = v1::VertexElement::getTypeSize( vElement.mType );
+                const SourceData blockSrc = offsetSourceData( *itSrc, blockStart );
 
                 assert( itor->mSemantic == itSrc->element.mSemantic );
 
                 if( vElement.mSemantic == VES_NORMAL &&
                     vElement.mType == VET_SHORT4_SNORM && tangentSrc )
                 {
-                    //QTangents
-                    const size_t readSize = v1::VertexElement::getTypeSize( itSrc->element.mType );
-                    const size_t tangentSize = v1::VertexElement::getTypeSize( tangentSrc->element.mType );
-
                     //Convert TBN matrix (between 6 to 9 floats, 24-36 bytes)
                     //to a QTangent (4 shorts, 8 bytes)
-                    assert( readSize == sizeof(float) * 3 );
-                    assert( tangentSize <= sizeof(float) * 4 &&
-                            tangentSize >= sizeof(float) * 3 );
-
-                    float normal[3];
-                    float tangent[4];
-                    tangent[3] = 1.0f;
-                    memcpy( normal, itSrc->data, readSize );
-                    memcpy( tangent, tangentSrc->data, tangentSize );
-
-                    tangentSrc->data += tangentSrc->bytesPerVertex;
-
-                    Vector3 vNormal( normal[0], normal[1], normal[2] );
-                    Vector3 vTangent( tangent[0], tangent[1], tangent[2] );
+                    const SourceData blockTangent = offsetSourceData( *tangentSrc, blockStart );
 
                     if( binormalSrc )
                     {
-                        const size_t binormalSize = v1::VertexElement::getTypeSize( binormalSrc->
-                                                                                    element.mType );
-
-                        assert( binormalSize == sizeof(float) * 3 );
-                        float binormal[3];
-                        memcpy( binormal, binormalSrc->data, binormalSize );
-
-                        Vector3 vBinormal( binormal[0], binormal[1], binormal[2] );
-
-                        //It is reflected.
-                        Vector3 naturalBinormal = vTangent.crossProduct( vNormal );
-                        if( naturalBinormal.dotProduct( vBinormal ) <= 0 )
-                            tangent[3] = -1.0f;
-
-                        binormalSrc->data += binormalSrc->bytesPerVertex;
+                        const SourceData blockBinormal = offsetSourceData( *binormalSrc, blockStart );
+                        convertToQTangents( dstData + acumOffset, vertexSize, blockSrc, blockTangent,
+                                            &blockBinormal, blockSize );
                     }
-
-                    Matrix3 tbn;
-                    tbn.SetColumn( 0, vNormal );
-                    tbn.SetColumn( 1, vTangent );
-                    tbn.SetColumn( 2, vNormal.crossProduct( vTangent ) );
-
-                    //See Spherical Skinning with Dual-Quaternions and QTangents,
-                    //Ivo Zoltan Frey, SIGRAPH 2011 Vancounver.
-                    //http://www.crytek.com/download/izfrey_siggraph2011.ppt
-
-                    Quaternion qTangent( tbn );
-                    qTangent.normalise();
-
-                    //Bias = 1 / [2^(bits-1) - 1]
-                    const Real bias = 1.0f / 32767.0f;
-
-                    //Make sure QTangent is always positive
-                    if( qTangent.w < 0 )
-                        qTangent = -qTangent;
-
-                    //Because '-0' sign information is lost when using integers,
-                    //we need to apply a "bias"; while making sure the Quatenion
-                    //stays normalized.
-                    // ** Also our shaders assume qTangent.w is never 0. **
-                    if( qTangent.w < bias )
+                    else
                     {
-                        Real normFactor = Math::Sqrt( 1 - bias * bias );
-                        qTangent.w = bias;
-                        qTangent.x *= normFactor;
-                        qTangent.y *= normFactor;
-                        qTangent.z *= normFactor;
+                        convertToQTangents( dstData + acumOffset, vertexSize, blockSrc, blockTangent,
+                                            0, blockSize );
                     }
-
-                    //Now negate if we require reflection
-                    if( tangent[3] < 0 )
-                        qTangent = -qTangent;
-
-                    int16 *dstData16 = reinterpret_cast<int16*>(dstData + acumOffset);
-
-                    dstData16[0] = Bitwise::floatToSnorm16( qTangent.x );
-                    dstData16[1] = Bitwise::floatToSnorm16( qTangent.y );
-                    dstData16[2] = Bitwise::floatToSnorm16( qTangent.z );
-                    dstData16[3] = Bitwise::floatToSnorm16( qTangent.w );
                 }
                 else if( v1::VertexElement::getBaseType( vElement.mType ) == VET_HALF2 &&
                          v1::VertexElement::getBaseType( itSrc->element.mType ) == VET_FLOAT1 )
                 {
-                    size_t readSize = v1::VertexElement::getTypeSize( itSrc->element.mType );
-
                     //Convert float to half.
-                    float fpData[4];
-                    fpData[0] = fpData[1] = fpData[2] = 0.0f;
-                    fpData[3] = 1.0f;
-                    memcpy( fpData, itSrc->data, readSize );
-
-                    uint16 *dstData16 = reinterpret_cast<uint16*>(dstData + acumOffset);
-
-                    for( size_t j=0; j<v1::VertexElement::getTypeCount( vElement.mType ); ++j )
-                        dstData16[j] = Bitwise::floatToHalf( fpData[j] );
+                    convertToHalf( dstData + acumOffset, vertexSize,
+                                   v1::VertexElement::getTypeCount( vElement.mType ),
+                                   blockSrc.data, blockSrc.bytesPerVertex,
+                                   v1::VertexElement::getTypeCount( itSrc->element.mType ),
+                                   blockSize );
                 }
                 else
                 {
                     //Raw. Transfer as is.
-                    memcpy( dstData + acumOffset, itSrc->data, writeSize ); //writeSize = readSize
+                    char *dstElement = dstData + acumOffset;
+                    char const *srcElement = blockSrc.data;
+                    for( size_t i=0; i<blockSize; ++i )
+                    {
+                        memcpy( dstElement, srcElement, writeSize ); //writeSize = readSize
+                        dstElement += vertexSize;
+                        srcElement += blockSrc.bytesPerVertex;
+                    }
                 }
 
-                acumOffset  += writeSize;
-                itSrc->data += itSrc->bytesPerVertex;
+                acumOffset += writeSize;
 
                 ++itSrc;
                 ++itor;
             }
-
-            dstData += vertexSize;
         }
 
-        assert( dstData == data + vertexSize * vertexCount );
-
         return data;
     }
     //---------------------------------------------------------------------
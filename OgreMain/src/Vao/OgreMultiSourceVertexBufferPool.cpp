@@ -67,6 +67,8 @@ namespace Ogre
 
             accumulatedOffset += bytesPerVertex * mMaxVertices * dynamicBufferMultiplier;
         }
+
+        mFreeVertices.initialize( mMaxVertices * dynamicBufferMultiplier );
     }
     //-----------------------------------------------------------------------------------
     void MultiSourceVertexBufferPool::destroyVertexBuffers( VertexBufferPackedVec &inOutVertexBuffers )
@@ -0,0 +1,495 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2017 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+#include "Vao/OgreTlsfSubAllocator.h"
+
+#include "OgreException.h"
+#include "OgreStringConverter.h"
+
+#if OGRE_COMPILER == OGRE_COMPILER_MSVC
+    #include <intrin.h>
+    #pragma intrinsic(_BitScanForward)
+    #pragma intrinsic(_BitScanReverse)
+#endif
+
+namespace Ogre
+{
+    const uint32 TlsfSubAllocator::InvalidNode = 0xFFFFFFFF;
+    const size_t TlsfSubAllocator::NoSpace = ~static_cast<size_t>( 0 );
+
+    /// Index of the lowest set bit. value must not be 0.
+    static inline uint32 ctz32( uint32 value )
+    {
+#if OGRE_COMPILER == OGRE_COMPILER_MSVC
+        unsigned long trailingZero = 0;
+        _BitScanForward( &trailingZero, value );
+        return trailingZero;
+#else
+        return __builtin_ctz( value );
+#endif
+    }
+    /// Index of the highest set bit. value must not be 0.
+    static inline uint32 fls32( uint32 value )
+    {
+#if OGRE_COMPILER == OGRE_COMPILER_MSVC
+        unsigned long lastBit = 0;
+        _BitScanReverse( &lastBit, value );
+        return lastBit;
+#else
+        return 31u - __builtin_clz( value );
+#endif
+    }
+
+    TlsfSubAllocator::Stats::Stats() :
+        capacity( 0 ),
+        usedBytes( 0 ),
+        peakUsedBytes( 0 ),
+        freeBytes( 0 ),
+        numFreeBlocks( 0 ),
+        largestFreeBlock( 0 ),
+        numAllocations( 0 ),
+        numPools( 0 )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    Real TlsfSubAllocator::Stats::getFragmentation(void) const
+    {
+        if( !freeBytes )
+            return 0;
+        return Real( 1.0 ) - Real( largestFreeBlock ) / Real( freeBytes );
+    }
+    //-----------------------------------------------------------------------------------
+    void TlsfSubAllocator::Stats::merge( const Stats &other )
+    {
+        capacity        += other.capacity;
+        usedBytes       += other.usedBytes;
+        peakUsedBytes   += other.peakUsedBytes;
+        freeBytes       += other.freeBytes;
+        numFreeBlocks   += other.numFreeBlocks;
+        largestFreeBlock = std::max( largestFreeBlock, other.largestFreeBlock );
+        numAllocations  += other.numAllocations;
+        numPools        += other.numPools;
+    }
+    //-----------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------
+    TlsfSubAllocator::TlsfSubAllocator() :
+        mFlBitmap( 0 ),
+        mCapacity( 0 ),
+        mUsedBytes( 0 ),
+        mPeakUsedBytes( 0 ),
+        mNumFreeBlocks( 0 )
+    {
+        initialize( 0 );
+    }
+    //-----------------------------------------------------------------------------------
+    void TlsfSubAllocator::initialize( size_t capacity )
+    {
+        if( static_cast<uint64>( capacity ) > 0xFFFFFFFFull )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Pools can't be bigger than 4GB. Requested: " +
+                         StringConverter::toString( capacity ),
+                         "TlsfSubAllocator::initialize" );
+        }
+
+        mNodes.clear();
+        mUnusedNodes.clear();
+        mAllocated.clear();
+
+        mFlBitmap = 0;
+        for( uint32 fl=0; fl<FlCount; ++fl )
+        {
+            mSlBitmap[fl] = 0;
+            for( uint32 sl=0; sl<SlCount; ++sl )
+                mFreeHeads[fl][sl] = InvalidNode;
+        }
+
+        mCapacity       = capacity;
+        mUsedBytes      = 0;
+        mPeakUsedBytes  = 0;
+        mNumFreeBlocks  = 0;
+
+        if( capacity )
+            insertFreeNode( createNode( 0, capacity ) );
+    }
+    //-----------------------------------------------------------------------------------
+    void TlsfSubAllocator::mappingInsert( size_t size, uint32 &outFl, uint32 &outSl )
+    {
+        if( size < SlCount )
+        {
+            //Small blocks are stored linearly in the first list
+            outFl = 0;
+            outSl = static_cast<uint32>( size );
+        }
+        else
+        {
+            const uint32 lastBit = fls32( static_cast<uint32>( size ) );
+            outFl = lastBit - SlLog2 + 1u;
+            outSl = static_cast<uint32>( size >> (lastBit - SlLog2) ) ^ SlCount;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void TlsfSubAllocator::mappingSearch( size_t size, uint32 &outFl, uint32 &outSl )
+    {
+        //Round up to the next class so that any block in the list we start
+        //looking from is guaranteed to be big enough.
+        if( size >= SlCount )
+            size += ( size_t( 1u ) << (fls32( static_cast<uint32>( size ) ) - SlLog2) ) - 1u;
+
+        if( static_cast<uint64>( size ) > 0xFFFFFFFFull )
+        {
+            outFl = FlCount;
+            outSl = 0;
+            return;
+        }
+
+        mappingInsert( size, outFl, outSl );
+    }
+    //-----------------------------------------------------------------------------------
+    uint32 TlsfSubAllocator::createNode( size_t offset, size_t size )
+    {
+        uint32 nodeIdx;
+        if( !mUnusedNodes.empty() )
+        {
+            nodeIdx = mUnusedNodes.back();
+            mUnusedNodes.pop_back();
+        }
+        else
+        {
+            nodeIdx = static_cast<uint32>( mNodes.size() );
+            mNodes.push_back( Node() );
+        }
+
+        Node &node = mNodes[nodeIdx];
+        node.offset         = offset;
+        node.size           = size;
+        node.prevPhysical   = InvalidNode;
+        node.nextPhysical   = InvalidNode;
+        node.prevFree       = InvalidNode;
+        node.nextFree       = InvalidNode;
+        node.isFree         = false;
+
+        return nodeIdx;
+    }
+    //-----------------------------------------------------------------------------------
+    void TlsfSubAllocator::releaseNode( uint32 nodeIdx )
+    {
+        Node &node = mNodes[nodeIdx];
+        node.size   = 0;
+        node.isFree = false;
+        mUnusedNodes.push_back( nodeIdx );
+    }
+    //-----------------------------------------------------------------------------------
+    void TlsfSubAllocator::insertFreeNode( uint32 nodeIdx )
+    {
+        Node &node = mNodes[nodeIdx];
+
+        uint32 fl, sl;
+        mappingInsert( node.size, fl, sl );
+
+        const uint32 head = mFreeHeads[fl][sl];
+        node.isFree     = true;
+        node.prevFree   = InvalidNode;
+        node.nextFree   = head;
+        if( head != InvalidNode )
+            mNodes[head].prevFree = nodeIdx;
+
+        mFreeHeads[fl][sl] = nodeIdx;
+        mFlBitmap       |= 1u << fl;
+        mSlBitmap[fl]   |= 1u << sl;
+
+        ++mNumFreeBlocks;
+    }
+    //-----------------------------------------------------------------------------------
+    void TlsfSubAllocator::removeFreeNode( uint32 nodeIdx )
+    {
+        Node &node = mNodes[nodeIdx];
+        assert( node.isFree );
+
+        uint32 fl, sl;
+        mappingInsert( node.size, fl, sl );
+
+        if( node.prevFree != InvalidNode )
+            mNodes[node.prevFree].nextFree = node.nextFree;
+        if( node.nextFree != InvalidNode )
+            mNodes[node.nextFree].prevFree = node.prevFree;
+
+        if( mFreeHeads[fl][sl] == nodeIdx )
+        {
+            mFreeHeads[fl][sl] = node.nextFree;
+            if( node.nextFree == InvalidNode )
+            {
+                mSlBitmap[fl] &= ~(1u << sl);
+                if( !mSlBitmap[fl] )
+                    mFlBitmap &= ~(1u << fl);
+            }
+        }
+
+        node.isFree     = false;
+        node.prevFree   = InvalidNode;
+        node.nextFree   = InvalidNode;
+
+        --mNumFreeBlocks;
+    }
+    //-----------------------------------------------------------------------------------
+    uint32 TlsfSubAllocator::findSuitableNode( size_t size ) const
+    {
+        uint32 fl, sl;
+        mappingSearch( size, fl, sl );
+
+        if( fl >= FlCount )
+            return InvalidNode;
+
+        uint32 slMap = mSlBitmap[fl] & (~0u << sl);
+        if( !slMap )
+        {
+            //Nothing left in this first level, go to the next non-empty one.
+            const uint32 flMap = fl + 1u < FlCount ? (mFlBitmap & (~0u << (fl + 1u))) : 0u;
+            if( !flMap )
+                return InvalidNode;
+
+            fl = ctz32( flMap );
+            slMap = mSlBitmap[fl];
+        }
+
+        sl = ctz32( slMap );
+        return mFreeHeads[fl][sl];
+    }
+    //-----------------------------------------------------------------------------------
+    void TlsfSubAllocator::carve( uint32 nodeIdx, size_t offset, size_t sizeBytes )
+    {
+        removeFreeNode( nodeIdx );
+
+        const size_t nodeOffset = mNodes[nodeIdx].offset;
+        const size_t nodeSize   = mNodes[nodeIdx].size;
+
+        assert( offset >= nodeOffset && offset + sizeBytes <= nodeOffset + nodeSize );
+
+        if( offset > nodeOffset )
+        {
+            //Return the padding before the allocation to the free lists.
+            const uint32 frontIdx = createNode( nodeOffset, offset - nodeOffset );
+            Node &front = mNodes[frontIdx];
+            Node &node  = mNodes[nodeIdx];
+            front.prevPhysical = node.prevPhysical;
+            front.nextPhysical = nodeIdx;
+            if( node.prevPhysical != InvalidNode )
+                mNodes[node.prevPhysical].nextPhysical = frontIdx;
+            node.prevPhysical = frontIdx;
+            insertFreeNode( frontIdx );
+        }
+
+        const size_t endOffset = nodeOffset + nodeSize;
+        if( offset + sizeBytes < endOffset )
+        {
+            //Return the remainder after the allocation to the free lists.
+            const uint32 tailIdx = createNode( offset + sizeBytes, endOffset - (offset + sizeBytes) );
+            Node &tail = mNodes[tailIdx];
+            Node &node = mNodes[nodeIdx];
+            tail.prevPhysical = nodeIdx;
+            tail.nextPhysical = node.nextPhysical;
+            if( node.nextPhysical != InvalidNode )
+                mNodes[node.nextPhysical].prevPhysical = tailIdx;
+            node.nextPhysical = tailIdx;
+            insertFreeNode( tailIdx );
+        }
+
+        Node &node = mNodes[nodeIdx];
+        node.offset = offset;
+        node.size   = sizeBytes;
+
+        mAllocated[offset] = nodeIdx;
+
+        mUsedBytes += sizeBytes;
+        mPeakUsedBytes = std::max( mPeakUsedBytes, mUsedBytes );
+    }
+    //-----------------------------------------------------------------------------------
+    size_t TlsfSubAllocator::allocate( size_t sizeBytes, size_t alignment )
+    {
+        assert( alignment > 0 );
+
+        sizeBytes = std::max<size_t>( sizeBytes, 1u );
+
+        if( sizeBytes > mCapacity - mUsedBytes )
+            return NoSpace;
+
+        //Try first without accounting for alignment; often the block is already aligned
+        //(or alignment is 1) and we avoid skipping to a bigger size class.
+        uint32 nodeIdx = findSuitableNode( sizeBytes );
+        size_t offset = 0;
+
+        if( nodeIdx != InvalidNode )
+        {
+            const Node &node = mNodes[nodeIdx];
+            offset = ( (node.offset + alignment - 1u) / alignment ) * alignment;
+            if( offset + sizeBytes > node.offset + node.size )
+                nodeIdx = InvalidNode;
+        }
+
+        if( nodeIdx == InvalidNode && alignment > 1u )
+        {
+            //Any block from this class can hold the request regardless of its alignment.
+            nodeIdx = findSuitableNode( sizeBytes + alignment - 1u );
+            if( nodeIdx != InvalidNode )
+            {
+                const Node &node = mNodes[nodeIdx];
+                offset = ( (node.offset + alignment - 1u) / alignment ) * alignment;
+            }
+        }
+
+        if( nodeIdx == InvalidNode )
+        {
+            //The good-fit search skips the list sizeBytes belongs to, since not every block
+            //in it is big enough. Before giving up (and making the caller create a whole
+            //new pool) walk that list. This is the only non O(1) path.
+            uint32 fl, sl;
+            mappingInsert( sizeBytes, fl, sl );
+            uint32 candidate = mFreeHeads[fl][sl];
+            while( candidate != InvalidNode && nodeIdx == InvalidNode )
+            {
+                const Node &node = mNodes[candidate];
+                offset = ( (node.offset + alignment - 1u) / alignment ) * alignment;
+                if( offset + sizeBytes <= node.offset + node.size )
+                    nodeIdx = candidate;
+                candidate = node.nextFree;
+            }
+        }
+
+        if( nodeIdx == InvalidNode )
+            return NoSpace;
+
+        carve( nodeIdx, offset, sizeBytes );
+
+        return offset;
+    }
+    //-----------------------------------------------------------------------------------
+    bool TlsfSubAllocator::allocateAt( size_t offset, size_t sizeBytes )
+    {
+        sizeBytes = std::max<size_t>( sizeBytes, 1u );
+
+        //Walk backwards: when packing sequentially the remainder is always the newest
+        //node, so the common case is found immediately.
+        NodeVec::const_reverse_iterator itor = mNodes.rbegin();
+        NodeVec::const_reverse_iterator end  = mNodes.rend();
+
+        while( itor != end )
+        {
+            if( itor->isFree && itor->offset <= offset &&
+                offset + sizeBytes <= itor->offset + itor->size )
+            {
+                carve( static_cast<uint32>( end - itor - 1 ), offset, sizeBytes );
+                return true;
+            }
+
+            ++itor;
+        }
+
+        return false;
+    }
+    //-----------------------------------------------------------------------------------
+    void TlsfSubAllocator::deallocate( size_t offset, size_t sizeBytes )
+    {
+        sizeBytes = std::max<size_t>( sizeBytes, 1u );
+
+        OffsetToNodeMap::iterator itAlloc = mAllocated.find( offset );
+        assert( itAlloc != mAllocated.end() && "Offset was not allocated by this allocator!" );
+        if( itAlloc == mAllocated.end() )
+            return;
+
+        uint32 nodeIdx = itAlloc->second;
+        mAllocated.erase( itAlloc );
+
+        assert( mNodes[nodeIdx].size == sizeBytes && "Deallocated size doesn't match!" );
+        mUsedBytes -= mNodes[nodeIdx].size;
+
+        //Merge with the physical neighbours. They can't be free themselves
+        //at the same time (they would've been merged already).
+        const uint32 prevIdx = mNodes[nodeIdx].prevPhysical;
+        if( prevIdx != InvalidNode && mNodes[prevIdx].isFree )
+        {
+            removeFreeNode( prevIdx );
+            Node &prev = mNodes[prevIdx];
+            Node &node = mNodes[nodeIdx];
+            prev.size += node.size;
+            prev.nextPhysical = node.nextPhysical;
+            if( node.nextPhysical != InvalidNode )
+                mNodes[node.nextPhysical].prevPhysical = prevIdx;
+            releaseNode( nodeIdx );
+            nodeIdx = prevIdx;
+        }
+
+        const uint32 nextIdx = mNodes[nodeIdx].nextPhysical;
+        if( nextIdx != InvalidNode && mNodes[nextIdx].isFree )
+        {
+            removeFreeNode( nextIdx );
+            Node &next = mNodes[nextIdx];
+            Node &node = mNodes[nodeIdx];
+            node.size += next.size;
+            node.nextPhysical = next.nextPhysical;
+            if( next.nextPhysical != InvalidNode )
+                mNodes[next.nextPhysical].prevPhysical = nodeIdx;
+            releaseNode( nextIdx );
+        }
+
+        insertFreeNode( nodeIdx );
+    }
+    //-----------------------------------------------------------------------------------
+    size_t TlsfSubAllocator::getLargestFreeBlock(void) const
+    {
+        if( !mFlBitmap )
+            return 0;
+
+        //Every block in the highest non-empty list is bigger than any block in lower ones.
+        const uint32 fl = fls32( mFlBitmap );
+        const uint32 sl = fls32( mSlBitmap[fl] );
+
+        size_t largest = 0;
+        uint32 nodeIdx = mFreeHeads[fl][sl];
+        while( nodeIdx != InvalidNode )
+        {
+            largest = std::max( largest, mNodes[nodeIdx].size );
+            nodeIdx = mNodes[nodeIdx].nextFree;
+        }
+
+        return largest;
+    }
+    //-----------------------------------------------------------------------------------
+    void TlsfSubAllocator::getStats( Stats &outStats ) const
+    {
+        outStats.capacity           = mCapacity;
+        outStats.usedBytes          = mUsedBytes;
+        outStats.peakUsedBytes      = mPeakUsedBytes;
+        outStats.freeBytes          = mCapacity - mUsedBytes;
+        outStats.numFreeBlocks      = mNumFreeBlocks;
+        outStats.largestFreeBlock   = getLargestFreeBlock();
+        outStats.numAllocations     = mAllocated.size();
+        outStats.numPools           = 1u;
+    }
+}
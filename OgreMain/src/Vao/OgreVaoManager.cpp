@@ -601,5 +601,10 @@ namespace Ogre
         mDefaultStagingBufferLifetime       = lifetime;
         mDefaultStagingBufferUnfencedTime   = unfencedTime;
     }
+    //-----------------------------------------------------------------------------------
+    void VaoManager::getMemoryStats( BufferType bufferType, MemoryStats &outStats ) const
+    {
+        outStats = MemoryStats();
+    }
 }
 
@@ -180,49 +180,26 @@ namespace Ogre
             sizeBytes   *= mDynamicBufferMultiplier;
         }
 
-        VboVec::const_iterator itor = mVbos[internalType][bufferType].begin();
-        VboVec::const_iterator end  = mVbos[internalType][bufferType].end();
+        VboVec::iterator itor = mVbos[internalType][bufferType].begin();
+        VboVec::iterator end  = mVbos[internalType][bufferType].end();
 
-        //Find a suitable VBO that can hold the requested size. We prefer those free
-        //blocks that have a matching stride (the current offset is a multiple of
-        //bytesPerElement) in order to minimize the amount of memory padding.
+        //Find a VBO that can hold the requested size. Each pool's allocator answers in O(1)
+        //and already gives the alignment padding back to its free lists.
         size_t bestVboIdx   = ~0;
-        size_t bestBlockIdx = ~0;
-        bool foundMatchingStride = false;
+        size_t bufferOffset = TlsfSubAllocator::NoSpace;
 
-        while( itor != end && !foundMatchingStride )
+        while( itor != end && bufferOffset == TlsfSubAllocator::NoSpace )
         {
-            BlockVec::const_iterator blockIt = itor->freeBlocks.begin();
-            BlockVec::const_iterator blockEn = itor->freeBlocks.end();
-
-            while( blockIt != blockEn && !foundMatchingStride )
-            {
-                const Block &block = *blockIt;
-
-                //Round to next multiple of alignment
-                size_t newOffset = ( (block.offset + alignment - 1) / alignment ) * alignment;
-                size_t padding = newOffset - block.offset;
-
-                if( sizeBytes + padding <= block.size )
-                {
-                    bestVboIdx      = itor - mVbos[internalType][bufferType].begin();
-                    bestBlockIdx    = blockIt - itor->freeBlocks.begin();
-
-                    if( newOffset == block.offset )
-                        foundMatchingStride = true;
-                }
-
-                ++blockIt;
-            }
+            bufferOffset = itor->allocator.allocate( sizeBytes, alignment );
+            if( bufferOffset != TlsfSubAllocator::NoSpace )
+                bestVboIdx = itor - mVbos[internalType][bufferType].begin();
 
             ++itor;
         }
 
-        if( bestBlockIdx == (size_t)~0 )
+        if( bestVboIdx == (size_t)~0 )
         {
-            bestVboIdx      = mVbos[internalType][bufferType].size();
-            bestBlockIdx    = 0;
-            foundMatchingStride = true;
+            bestVboIdx = mVbos[internalType][bufferType].size();
 
             Vbo newVbo;
 
@@ -265,7 +242,7 @@ namespace Ogre
             }
 
             newVbo.sizeBytes = poolSize;
-            newVbo.freeBlocks.push_back( Block( 0, poolSize ) );
+            newVbo.allocator.initialize( poolSize );
             newVbo.dynamicBuffer = 0;
 
             if( bufferType >= BT_DYNAMIC_DEFAULT )
@@ -275,31 +252,14 @@ namespace Ogre
             }
 
             mVbos[internalType][bufferType].push_back( newVbo );
-        }
 
-        Vbo &bestVbo        = mVbos[internalType][bufferType][bestVboIdx];
-        Block &bestBlock    = bestVbo.freeBlocks[bestBlockIdx];
-
-        size_t newOffset = ( (bestBlock.offset + alignment - 1) / alignment ) * alignment;
-        size_t padding = newOffset - bestBlock.offset;
-        //Shrink our records about available data.
-        bestBlock.size   -= sizeBytes + padding;
-        bestBlock.offset = newOffset + sizeBytes;
-
-        if( !foundMatchingStride )
-        {
-            //This is a stride changer, record as such.
-            StrideChangerVec::iterator itStride = std::lower_bound( bestVbo.strideChangers.begin(),
-                                                                    bestVbo.strideChangers.end(),
-                                                                    newOffset, StrideChanger() );
-            bestVbo.strideChangers.insert( itStride, StrideChanger( newOffset, padding ) );
+            bufferOffset = mVbos[internalType][bufferType].back().allocator.allocate( sizeBytes,
+                                                                                   alignment );
+            assert( bufferOffset != TlsfSubAllocator::NoSpace );
         }
 
-        if( bestBlock.size == 0 )
-            bestVbo.freeBlocks.erase( bestVbo.freeBlocks.begin() + bestBlockIdx );
-
         outVboIdx       = bestVboIdx;
-        outBufferOffset = newOffset;
+        outBufferOffset = bufferOffset;
     }
     //-----------------------------------------------------------------------------------
     void D3D11VaoManager::deallocateVbo( size_t vboIdx, size_t bufferOffset, size_t sizeBytes,
@@ -312,23 +272,9 @@ namespace Ogre
         }
 
         Vbo &vbo = mVbos[internalType][bufferType][vboIdx];
-        StrideChangerVec::iterator itStride = std::lower_bound( vbo.strideChangers.begin(),
-                                                                vbo.strideChangers.end(),
-                                                                bufferOffset, StrideChanger() );
-
-        if( itStride != vbo.strideChangers.end() && itStride->offsetAfterPadding == bufferOffset )
-        {
-            bufferOffset    -= itStride->paddedBytes;
-            sizeBytes       += itStride->paddedBytes;
-
-            vbo.strideChangers.erase( itStride );
-        }
+        vbo.allocator.deallocate( bufferOffset, sizeBytes );
 
-        //See if we're contiguous to a free block and make that block grow.
-        vbo.freeBlocks.push_back( Block( bufferOffset, sizeBytes ) );
-        mergeContiguousBlocks( vbo.freeBlocks.end() - 1, vbo.freeBlocks );
-
-        if( vbo.freeBlocks.back().size == vbo.sizeBytes && bufferType == BT_IMMUTABLE )
+        if( vbo.allocator.isEmpty() && bufferType == BT_IMMUTABLE )
         {
             //Immutable buffer is empty. It can't be filled again. Release the GPU memory.
             //The vbo is not removed from mVbos since that would alter the index of other
@@ -383,7 +329,8 @@ namespace Ogre
         }
 
         inOutVbo.sizeBytes = poolSize;
-        inOutVbo.freeBlocks.clear(); //No free blocks
+        //The caller carves the buffers at their packed offsets (see allocateAt)
+        inOutVbo.allocator.initialize( poolSize );
         inOutVbo.dynamicBuffer = 0;
 
         mVbos[internalType][BT_IMMUTABLE].push_back( inOutVbo );
@@ -570,20 +517,8 @@ namespace Ogre
                     D3D11BufferInterface *bufferInterface = static_cast<D3D11BufferInterface*>(
                                 (*itor)->getBufferInterface() );
 
-                    const size_t dstOffsetBeforeAlignment = dstOffset;
                     dstOffset = alignToNextMultiple( dstOffset, (*itor)->getBytesPerElement() );
 
-                    if( dstOffsetBeforeAlignment != dstOffset )
-                    {
-                        //This is a stride changer, record as such.
-                        StrideChangerVec::iterator itStride = std::lower_bound(
-                                    newVbo.strideChangers.begin(),
-                                    newVbo.strideChangers.end(),
-                                    dstOffset, StrideChanger() );
-                        const size_t padding = dstOffset - dstOffsetBeforeAlignment;
-                        newVbo.strideChangers.insert( itStride, StrideChanger( dstOffset, padding ) );
-                    }
-
                     memcpy( mergedData + dstOffset, bufferInterface->_getInitialData(),
                             (*itor)->getTotalSizeBytes() );
 
@@ -600,6 +535,7 @@ namespace Ogre
 
                 const size_t vboIdx = mVbos[i][BT_IMMUTABLE].size() - 1;
                 ID3D11Buffer *vboName = newVbo.vboName;
+                TlsfSubAllocator &allocator = mVbos[i][BT_IMMUTABLE].back().allocator;
                 dstOffset = 0;
 
                 //Each buffer needs to be told about its new D3D11 object
@@ -613,6 +549,12 @@ namespace Ogre
 
                     bufferInterface->_setVboName( vboIdx, vboName, dstOffset );
 
+                    //Record the packed layout so the pool knows when it's entirely free.
+                    const bool allocated = allocator.allocateAt( dstOffset,
+                                                                 (*itor)->getTotalSizeBytes() );
+                    assert( allocated );
+                    (void)allocated;
+
                     dstOffset += (*itor)->getTotalSizeBytes();
                     ++itor;
                 }
@@ -1633,4 +1575,31 @@ namespace Ogre
     {
         return waitFor( fenceName, mDevice.GetImmediateContext() );
     }
+    //-----------------------------------------------------------------------------------
+    void D3D11VaoManager::getMemoryStats( BufferType bufferType, MemoryStats &outStats ) const
+    {
+        outStats = MemoryStats();
+
+        //Persistent mapping not supported in D3D11, all dynamic types share the same pools.
+        if( bufferType >= BT_DYNAMIC_DEFAULT )
+            bufferType = BT_DYNAMIC_DEFAULT;
+
+        for( size_t i=0; i<NumInternalBufferTypes; ++i )
+        {
+            VboVec::const_iterator itor = mVbos[i][bufferType].begin();
+            VboVec::const_iterator end  = mVbos[i][bufferType].end();
+
+            while( itor != end )
+            {
+                //Released immutable pools are kept to preserve the indices of the rest.
+                if( itor->vboName )
+                {
+                    MemoryStats poolStats;
+                    itor->allocator.getStats( poolStats );
+                    outStats.merge( poolStats );
+                }
+                ++itor;
+            }
+        }
+    }
 }
@@ -46,40 +46,6 @@ namespace Ogre
             MAX_VBO_FLAG
         };
 
-    public:
-        struct Block
-        {
-            size_t offset;
-            size_t size;
-
-            Block( size_t _offset, size_t _size ) : offset( _offset ), size( _size ) {}
-        };
-        struct StrideChanger
-        {
-            size_t offsetAfterPadding;
-            size_t paddedBytes;
-
-            StrideChanger() : offsetAfterPadding( 0 ), paddedBytes( 0 ) {}
-            StrideChanger( size_t _offsetAfterPadding, size_t _paddedBytes ) :
-                offsetAfterPadding( _offsetAfterPadding ), paddedBytes( _paddedBytes ) {}
-
-            bool operator () ( const StrideChanger &left, size_t right ) const
-            {
-                return left.offsetAfterPadding < right;
-            }
-            bool operator () ( size_t left, const StrideChanger &right ) const
-            {
-                return left < right.offsetAfterPadding;
-            }
-            bool operator () ( const StrideChanger &left, const StrideChanger &right ) const
-            {
-                return left.offsetAfterPadding < right.offsetAfterPadding;
-            }
-        };
-
-        typedef vector<Block>::type BlockVec;
-        typedef vector<StrideChanger>::type StrideChangerVec;
-
     protected:
         struct Vbo
         {
@@ -87,8 +53,7 @@ namespace Ogre
             size_t sizeBytes;
             GL3PlusDynamicBuffer *dynamicBuffer; //Null for CPU_INACCESSIBLE BOs.
 
-            BlockVec            freeBlocks;
-            StrideChangerVec    strideChangers;
+            TlsfSubAllocator    allocator;
         };
 
         struct Vao
@@ -189,12 +154,6 @@ namespace Ogre
         void deallocateVbo( size_t vboIdx, size_t bufferOffset, size_t sizeBytes,
                             BufferType bufferType );
 
-    public:
-        /// @see StagingBuffer::mergeContiguousBlocks
-        static void mergeContiguousBlocks( BlockVec::iterator blockToMerge,
-                                           BlockVec &blocks );
-
-    protected:
         virtual VertexBufferPacked* createVertexBufferImpl( size_t numElements,
                                                             uint32 bytesPerElement,
                                                             BufferType bufferType,
@@ -277,6 +236,9 @@ namespace Ogre
         /// See VaoManager::isFrameFinished
         virtual bool isFrameFinished( uint32 frameCount );
 
+        /// See VaoManager::getMemoryStats
+        virtual void getMemoryStats( BufferType bufferType, MemoryStats &outStats ) const;
+
         /** Will stall undefinitely until GPU finishes (signals the sync object).
         @param fenceName
             Sync object to wait for. Will be deleted on success. On failure,
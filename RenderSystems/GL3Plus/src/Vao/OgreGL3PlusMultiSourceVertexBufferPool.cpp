@@ -55,30 +55,10 @@ namespace Ogre
         if( mBufferType >= BT_DYNAMIC_DEFAULT )
             numVertices *= mVaoManager->getDynamicBufferMultiplier();
 
-        GL3PlusVaoManager::BlockVec::iterator blockIt = mFreeBlocks.begin();
-        GL3PlusVaoManager::BlockVec::iterator blockEn = mFreeBlocks.end();
+        outBufferOffset = mFreeVertices.allocate( numVertices, 1u );
 
-        while( blockIt != blockEn && numVertices < blockIt->size )
-            ++blockIt;
-
-        if( blockIt != blockEn )
-        {
-            GL3PlusVaoManager::Block &bestBlock = *blockIt;
-
-            //Tell caller the offset
-            outBufferOffset = bestBlock.offset;
-
-            //Shrink our records about available data.
-            bestBlock.size   -= numVertices;
-            bestBlock.offset += numVertices;
-
-            if( bestBlock.size == 0 )
-                efficientVectorRemove( mFreeBlocks, blockIt );
-        }
-        else
-        {
+        if( outBufferOffset == TlsfSubAllocator::NoSpace )
             outBufferOffset = mMaxVertices;
-        }
     }
     //-----------------------------------------------------------------------------------
     void GL3PlusMultiSourceVertexBufferPool::deallocateVbo( size_t bufferOffset, size_t numVertices )
@@ -86,9 +66,7 @@ namespace Ogre
         if( mBufferType >= BT_DYNAMIC_DEFAULT )
             numVertices *= mVaoManager->getDynamicBufferMultiplier();
 
-        //See if we're contiguous to a free block and make that block grow.
-        mFreeBlocks.push_back( GL3PlusVaoManager::Block( bufferOffset, numVertices ) );
-        GL3PlusVaoManager::mergeContiguousBlocks( mFreeBlocks.end() - 1, mFreeBlocks );
+        mFreeVertices.deallocate( bufferOffset, numVertices );
     }
     //-----------------------------------------------------------------------------------
     void GL3PlusMultiSourceVertexBufferPool::createVertexBuffers(
@@ -99,7 +77,7 @@ namespace Ogre
         size_t vertexOffset;
         allocateVbo( numVertices, vertexOffset );
 
-        if( vertexOffset == mMaxVertices )
+        if( vertexOffset != mMaxVertices )
         {
             for( size_t i=0; i<mVertexElementsBySource.size(); ++i )
             {
@@ -109,7 +87,8 @@ namespace Ogre
                     _initialData = initialData[i];
 
                 outVertexBuffers.push_back(
-                    OGRE_NEW VertexBufferPacked( mInternalBufferStart + vertexOffset + mSourceOffset[i],
+                    OGRE_NEW VertexBufferPacked( mInternalBufferStart + mSourceOffset[i] +
+                                                 vertexOffset * mBytesPerVertexPerSource[i],
                                                  numVertices, mBytesPerVertexPerSource[i], 0,
                                                  mBufferType, _initialData, keepAsShadow, mVaoManager,
                                                  bufferInterface, mVertexElementsBySource[i],
@@ -125,8 +104,8 @@ namespace Ogre
         VertexBufferPacked *vertexBuffer = inOutVertexBuffers[0];
         uint32 numVertices = vertexBuffer->getNumElements();
 
-        deallocateVbo( vertexBuffer->_getInternalBufferStart() - mInternalBufferStart -
-                       mSourceOffset[vertexBuffer->_getSourceIndex()], numVertices );
+        //The multisource id is the vertex offset returned by allocateVbo
+        deallocateVbo( vertexBuffer->getMultiSourceId(), numVertices );
     }
 }
 
@@ -41,10 +41,8 @@ namespace Ogre
         size_t mVboPoolIndex;
         id<MTLBuffer> mVboName;
 
-        MetalVaoManager::BlockVec mFreeBlocks;
-
         /** @See MetalVaoManager::allocateVbo. This is very similar, except we don't have to deal with
-            stride changes (as the vertex format remains the same) and we can't request another
+            alignment (as the vertex format remains the same) and we can't request another
             pool if we're out of space (in other words, it's simpler).
         @param numVertices
             The number of vertices to allocate
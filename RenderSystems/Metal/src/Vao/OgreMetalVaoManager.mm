@@ -165,49 +165,26 @@ namespace Ogre
         if( bufferType >= BT_DYNAMIC_DEFAULT )
             sizeBytes   *= mDynamicBufferMultiplier;
 
-        VboVec::const_iterator itor = mVbos[vboFlag].begin();
-        VboVec::const_iterator end  = mVbos[vboFlag].end();
+        VboVec::iterator itor = mVbos[vboFlag].begin();
+        VboVec::iterator end  = mVbos[vboFlag].end();
 
-        //Find a suitable VBO that can hold the requested size. We prefer those free
-        //blocks that have a matching stride (the current offset is a multiple of
-        //bytesPerElement) in order to minimize the amount of memory padding.
+        //Find a VBO that can hold the requested size. Each pool's allocator answers in O(1)
+        //and already gives the alignment padding back to its free lists.
         size_t bestVboIdx   = ~0;
-        size_t bestBlockIdx = ~0;
-        bool foundMatchingStride = false;
+        size_t bufferOffset = TlsfSubAllocator::NoSpace;
 
-        while( itor != end && !foundMatchingStride )
+        while( itor != end && bufferOffset == TlsfSubAllocator::NoSpace )
         {
-            BlockVec::const_iterator blockIt = itor->freeBlocks.begin();
-            BlockVec::const_iterator blockEn = itor->freeBlocks.end();
-
-            while( blockIt != blockEn && !foundMatchingStride )
-            {
-                const Block &block = *blockIt;
-
-                //Round to next multiple of alignment
-                size_t newOffset = ( (block.offset + alignment - 1) / alignment ) * alignment;
-                size_t padding = newOffset - block.offset;
-
-                if( sizeBytes + padding <= block.size )
-                {
-                    bestVboIdx      = itor - mVbos[vboFlag].begin();
-                    bestBlockIdx    = blockIt - itor->freeBlocks.begin();
-
-                    if( newOffset == block.offset )
-                        foundMatchingStride = true;
-                }
-
-                ++blockIt;
-            }
+            bufferOffset = itor->allocator.allocate( sizeBytes, alignment );
+            if( bufferOffset != TlsfSubAllocator::NoSpace )
+                bestVboIdx = itor - mVbos[vboFlag].begin();
 
             ++itor;
         }
 
-        if( bestBlockIdx == (size_t)~0 )
+        if( bestVboIdx == (size_t)~0 )
         {
-            bestVboIdx      = mVbos[vboFlag].size();
-            bestBlockIdx    = 0;
-            foundMatchingStride = true;
+            bestVboIdx = mVbos[vboFlag].size();
 
             Vbo newVbo;
 
@@ -243,7 +220,7 @@ namespace Ogre
             }
 
             newVbo.sizeBytes = poolSize;
-            newVbo.freeBlocks.push_back( Block( 0, poolSize ) );
+            newVbo.allocator.initialize( poolSize );
             newVbo.dynamicBuffer = 0;
 
             if( vboFlag != CPU_INACCESSIBLE )
@@ -252,31 +229,13 @@ namespace Ogre
             }
 
             mVbos[vboFlag].push_back( newVbo );
-        }
-
-        Vbo &bestVbo        = mVbos[vboFlag][bestVboIdx];
-        Block &bestBlock    = bestVbo.freeBlocks[bestBlockIdx];
 
-        size_t newOffset = ( (bestBlock.offset + alignment - 1) / alignment ) * alignment;
-        size_t padding = newOffset - bestBlock.offset;
-        //Shrink our records about available data.
-        bestBlock.size   -= sizeBytes + padding;
-        bestBlock.offset = newOffset + sizeBytes;
-
-        if( !foundMatchingStride )
-        {
-            //This is a stride changer, record as such.
-            StrideChangerVec::iterator itStride = std::lower_bound( bestVbo.strideChangers.begin(),
-                                                                    bestVbo.strideChangers.end(),
-                                                                    newOffset, StrideChanger() );
-            bestVbo.strideChangers.insert( itStride, StrideChanger( newOffset, padding ) );
+            bufferOffset = mVbos[vboFlag].back().allocator.allocate( sizeBytes, alignment );
+            assert( bufferOffset != TlsfSubAllocator::NoSpace );
         }
 
-        if( bestBlock.size == 0 )
-            bestVbo.freeBlocks.erase( bestVbo.freeBlocks.begin() + bestBlockIdx );
-
         outVboIdx       = bestVboIdx;
-        outBufferOffset = newOffset;
+        outBufferOffset = bufferOffset;
     }
     //-----------------------------------------------------------------------------------
     void MetalVaoManager::deallocateVbo( size_t vboIdx, size_t bufferOffset, size_t sizeBytes,
@@ -288,21 +247,7 @@ namespace Ogre
             sizeBytes *= mDynamicBufferMultiplier;
 
         Vbo &vbo = mVbos[vboFlag][vboIdx];
-        StrideChangerVec::iterator itStride = std::lower_bound( vbo.strideChangers.begin(),
-                                                                vbo.strideChangers.end(),
-                                                                bufferOffset, StrideChanger() );
-
-        if( itStride != vbo.strideChangers.end() && itStride->offsetAfterPadding == bufferOffset )
-        {
-            bufferOffset    -= itStride->paddedBytes;
-            sizeBytes       += itStride->paddedBytes;
-
-            vbo.strideChangers.erase( itStride );
-        }
-
-        //See if we're contiguous to a free block and make that block grow.
-        vbo.freeBlocks.push_back( Block( bufferOffset, sizeBytes ) );
-        mergeContiguousBlocks( vbo.freeBlocks.end() - 1, vbo.freeBlocks );
+        vbo.allocator.deallocate( bufferOffset, sizeBytes );
     }
     //-----------------------------------------------------------------------------------
     void MetalVaoManager::mergeContiguousBlocks( BlockVec::iterator blockToMerge,
@@ -1037,5 +982,23 @@ namespace Ogre
         return static_cast<VboFlag>( std::max( 0, (bufferType - BT_DYNAMIC_DEFAULT) +
                                                     CPU_ACCESSIBLE_DEFAULT ) );
     }
+    //-----------------------------------------------------------------------------------
+    void MetalVaoManager::getMemoryStats( BufferType bufferType, MemoryStats &outStats ) const
+    {
+        outStats = MemoryStats();
+
+        const VboFlag vboFlag = bufferTypeToVboFlag( bufferType );
+
+        VboVec::const_iterator itor = mVbos[vboFlag].begin();
+        VboVec::const_iterator end  = mVbos[vboFlag].end();
+
+        while( itor != end )
+        {
+            MemoryStats poolStats;
+            itor->allocator.getStats( poolStats );
+            outStats.merge( poolStats );
+            ++itor;
+        }
+    }
 }
 
@@ -0,0 +1,159 @@
+/*
+  -----------------------------------------------------------------------------
+  This source file is part of OGRE
+  (Object-oriented Graphics Rendering Engine)
+  For the latest info, see http://www.ogre3d.org
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+  -----------------------------------------------------------------------------
+*/
+
+
+#ifndef _OgreNULLCommandRecorder_H_
+#define _OgreNULLCommandRecorder_H_
+
+#include "OgreNULLPrerequisites.h"
+
+#include <iosfwd>
+
+namespace Ogre
+{
+    /// Everything the NULL RenderSystem was asked to do during a frame (or several).
+    struct _OgreNULLExport NULLFrameStats
+    {
+        /// VaoManager frame count at the time the frame ended.
+        uint32  frameCount;
+        /// Number of frames accumulated into these stats. Always 1 except for
+        /// NULLCommandRecorder::getAccumulatedStats
+        uint32  numFrames;
+
+        size_t  numPsoBinds;
+        size_t  numComputePsoBinds;
+        size_t  numSamplerblockBinds;
+        /// Only counts binds of an actual texture. Unbinding a slot is not counted.
+        size_t  numTextureBinds;
+        size_t  numVaoBinds;
+        size_t  numRenderTargetBinds;
+        size_t  numClears;
+
+        /// One per emitted draw call. A multi-draw indirect command counts as many.
+        size_t  numDrawCalls;
+        size_t  numInstances;
+        /// Sum of primCount across all draws, i.e. number of indices or vertices.
+        size_t  numPrimitives;
+        size_t  numDispatches;
+
+        /// BufferPacked::map calls and the number of bytes they requested
+        size_t  numBufferMaps;
+        size_t  bytesMapped;
+        /// BufferPacked::unmap calls and the number of bytes they flushed
+        size_t  numBufferUnmaps;
+        size_t  bytesFlushed;
+
+        /// Number of (staging -> buffer) copies, and their bytes
+        size_t  numStagingUploads;
+        size_t  bytesStagingUploaded;
+        /// Number of (buffer -> staging) copies, and their bytes
+        size_t  numStagingDownloads;
+        size_t  bytesStagingDownloaded;
+
+        NULLFrameStats();
+
+        void reset(void);
+
+        /// Adds the counters from other. Ignores frameCount.
+        NULLFrameStats& operator += ( const NULLFrameStats &other );
+    };
+
+    /** Counts (and optionally serializes) every command that reaches the NULL RenderSystem
+        and its VaoManager, so that CPU-side batching efficiency can be measured and tested
+        without a GPU.
+    @remarks
+        Recording is disabled by default, in which case the overhead is a single branch.
+    @par
+        When an output stream is set, one line of text is written per command, plus a
+        summary line at the end of each frame. The output is deterministic: PSOs are
+        identified by the order in which they were first bound (not their address), VAOs
+        by their VaoName, textures by their name.
+    @par
+        A frame ends when the VaoManager gets updated, which happens once per
+        Root::renderOneFrame regardless of the number of workspaces.
+    */
+    class _OgreNULLExport NULLCommandRecorder
+    {
+        typedef map<const void*, uint32>::type PsoIdMap;
+
+        bool            mEnabled;
+        std::ostream    *mOutputStream;
+
+        NULLFrameStats  mCurrentFrame;
+        NULLFrameStats  mLastFrame;
+        NULLFrameStats  mAccumulated;
+
+        PsoIdMap        mPsoIds;
+
+        uint32 getPsoId( const void *pso );
+
+    public:
+        NULLCommandRecorder();
+
+        /// Enables or disables recording. Enabling it resets the stats of the current frame.
+        void setEnabled( bool bEnabled );
+        bool getEnabled(void) const                             { return mEnabled; }
+
+        /** Sets a stream where every recorded command gets written to as text.
+        @param outputStream
+            Can be null to disable serialization. The pointer must remain valid
+            until it's unset or the RenderSystem gets destroyed.
+        */
+        void setOutputStream( std::ostream *outputStream )      { mOutputStream = outputStream; }
+        std::ostream* getOutputStream(void) const               { return mOutputStream; }
+
+        /// Stats of the frame currently in progress.
+        const NULLFrameStats& getCurrentFrameStats(void) const  { return mCurrentFrame; }
+        /// Stats of the last completed frame.
+        const NULLFrameStats& getLastFrameStats(void) const     { return mLastFrame; }
+        /// Sum of all completed frames since recording was enabled or resetAccumulatedStats.
+        const NULLFrameStats& getAccumulatedStats(void) const   { return mAccumulated; }
+
+        /// Clears the accumulated stats and forgets the PSO ids.
+        void resetAccumulatedStats(void);
+
+        void _recordPso( const HlmsPso *pso );
+        void _recordComputePso( const HlmsComputePso *pso );
+        void _recordSamplerblock( uint8 texUnit, const HlmsSamplerblock *samplerblock );
+        void _recordTexture( size_t unit, const Texture *texture );
+        void _recordVao( uint32 vaoName );
+        void _recordRenderTarget( const RenderTarget *renderTarget );
+        void _recordClear( unsigned int buffers );
+        void _recordDraw( bool indexed, uint32 primCount, uint32 instanceCount );
+        void _recordDispatch(void);
+        void _recordBufferMap( size_t bytes );
+        void _recordBufferUnmap( size_t bytesFlushed );
+        void _recordStagingUpload( size_t bytes );
+        void _recordStagingDownload( size_t bytes );
+
+        /// Called by NULLVaoManager::_update
+        void _notifyFrameEnded( uint32 frameCount );
+    };
+}
+
+#endif
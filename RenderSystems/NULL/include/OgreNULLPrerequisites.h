@@ -35,6 +35,8 @@ THE SOFTWARE.
 namespace Ogre
 {
     // Forward declarations
+    class NULLCommandRecorder;
+    class NULLGpuProgramManager;
     class NULLStagingBuffer;
     class NULLRenderSystem;
     class NULLVaoManager;
@@ -30,6 +30,7 @@ Copyright (c) 2000-2014 Torus Knot Software Ltd
 #define __NULLRenderSystem_H__
 
 #include "OgreNULLPrerequisites.h"
+#include "OgreNULLCommandRecorder.h"
 
 #include "OgreRenderSystem.h"
 
@@ -53,6 +54,7 @@ namespace Ogre
     {
         bool mInitialized;
         v1::HardwareBufferManager *mHardwareBufferManager;
+        NULLGpuProgramManager   *mGpuProgramManager;
 
         ConfigOptionMap mOptions;
 
@@ -60,8 +62,22 @@ namespace Ogre
 
         NULLPixelFormatToShaderType mPixelFormatToShaderType;
 
+        NULLCommandRecorder mCommandRecorder;
+        /// Contents of the bound indirect buffer. When the VaoManager supports indirect
+        /// buffers it's the buffer's own memory, whose first byte is at offset
+        /// mIndirectBufferStart in the draw calls. Otherwise it's the software copy.
+        unsigned char       *mSwIndirectBufferPtr;
+        size_t              mIndirectBufferStart;
+
     public:
         NULLRenderSystem();
+        virtual ~NULLRenderSystem();
+
+        /** Returns the recorder used to count and serialize the commands that reach this
+            RenderSystem. Useful for deterministic CPU benchmarks and regression tests
+            on machines without a GPU. @see NULLCommandRecorder
+        */
+        NULLCommandRecorder* getCommandRecorder(void)           { return &mCommandRecorder; }
 
         virtual void shutdown(void);
 
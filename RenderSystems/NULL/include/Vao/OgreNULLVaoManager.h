@@ -46,47 +46,11 @@ namespace Ogre
             MAX_VBO_FLAG
         };
 
-    public:
-        struct Block
-        {
-            size_t offset;
-            size_t size;
-
-            Block( size_t _offset, size_t _size ) : offset( _offset ), size( _size ) {}
-        };
-        struct StrideChanger
-        {
-            size_t offsetAfterPadding;
-            size_t paddedBytes;
-
-            StrideChanger() : offsetAfterPadding( 0 ), paddedBytes( 0 ) {}
-            StrideChanger( size_t _offsetAfterPadding, size_t _paddedBytes ) :
-                offsetAfterPadding( _offsetAfterPadding ), paddedBytes( _paddedBytes ) {}
-
-            bool operator () ( const StrideChanger &left, size_t right ) const
-            {
-                return left.offsetAfterPadding < right;
-            }
-            bool operator () ( size_t left, const StrideChanger &right ) const
-            {
-                return left < right.offsetAfterPadding;
-            }
-            bool operator () ( const StrideChanger &left, const StrideChanger &right ) const
-            {
-                return left.offsetAfterPadding < right.offsetAfterPadding;
-            }
-        };
-
-        typedef vector<Block>::type BlockVec;
-        typedef vector<StrideChanger>::type StrideChangerVec;
-
-    protected:
         struct Vbo
         {
             size_t sizeBytes;
 
-            BlockVec            freeBlocks;
-            StrideChangerVec    strideChangers;
+            TlsfSubAllocator    allocator;
         };
 
         struct Vao
@@ -125,11 +89,35 @@ namespace Ogre
         typedef map<VertexElement2Vec, Vbo>::type VboMap;
 
         VboVec  mVbos[MAX_VBO_FLAG];
+        size_t  mDefaultPoolSize[MAX_VBO_FLAG];
 
         VaoVec  mVaos;
 
         VertexBufferPacked  *mDrawId;
 
+        NULLCommandRecorder *mCommandRecorder;
+
+        /** Asks for allocating buffer space in a pool. There is no API object behind the
+            pools, but we sub-allocate the same way the real RenderSystems do so that
+            memory usage and fragmentation can be measured without a GPU.
+        @param sizeBytes
+            The requested size, in bytes.
+        @param alignment
+            The returned offset will be a multiple of this value. Cannot be 0.
+        @param bufferType
+            The type of buffer
+        @param outVboIdx [out]
+            The index to the mVbos.
+        @param outBufferOffset [out]
+            The offset in bytes at which the buffer data should be placed.
+        */
+        void allocateVbo( size_t sizeBytes, size_t alignment, BufferType bufferType,
+                          size_t &outVboIdx, size_t &outBufferOffset );
+
+        /// Deallocates a buffer allocated with @allocateVbo. Parameters must match.
+        void deallocateVbo( size_t vboIdx, size_t bufferOffset, size_t sizeBytes,
+                            BufferType bufferType );
+
     protected:
         virtual VertexBufferPacked* createVertexBufferImpl( size_t numElements,
                                                             uint32 bytesPerElement,
@@ -179,11 +167,13 @@ namespace Ogre
         static VboFlag bufferTypeToVboFlag( BufferType bufferType );
 
     public:
-        NULLVaoManager();
+        NULLVaoManager( NULLCommandRecorder *commandRecorder );
         virtual ~NULLVaoManager();
 
         bool supportsArbBufferStorage(void) const       { return false; }
 
+        NULLCommandRecorder* getCommandRecorder(void)   { return mCommandRecorder; }
+
         /** Creates a new staging buffer and adds it to the pool. @see getStagingBuffer.
         @remarks
             The returned buffer starts with a reference count of 1. You should decrease
@@ -202,6 +192,8 @@ namespace Ogre
         uint8 waitForTailFrameToFinish(void);
         virtual void waitForSpecificFrameToFinish( uint32 frameCount );
         virtual bool isFrameFinished( uint32 frameCount );
+
+        virtual void getMemoryStats( BufferType bufferType, MemoryStats &outStats ) const;
     };
 }
 
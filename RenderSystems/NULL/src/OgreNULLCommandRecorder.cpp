@@ -0,0 +1,289 @@
+/*
+  -----------------------------------------------------------------------------
+  This source file is part of OGRE
+  (Object-oriented Graphics Rendering Engine)
+  For the latest info, see http://www.ogre3d.org
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+  -----------------------------------------------------------------------------
+*/
+
+
+#include "OgreNULLCommandRecorder.h"
+
+#include "OgreTexture.h"
+#include "OgreRenderTarget.h"
+
+#include <ostream>
+
+namespace Ogre
+{
+    NULLFrameStats::NULLFrameStats()
+    {
+        reset();
+    }
+    //-------------------------------------------------------------------------
+    void NULLFrameStats::reset(void)
+    {
+        frameCount              = 0;
+        numFrames               = 0;
+        numPsoBinds             = 0;
+        numComputePsoBinds      = 0;
+        numSamplerblockBinds    = 0;
+        numTextureBinds         = 0;
+        numVaoBinds             = 0;
+        numRenderTargetBinds    = 0;
+        numClears               = 0;
+        numDrawCalls            = 0;
+        numInstances            = 0;
+        numPrimitives           = 0;
+        numDispatches           = 0;
+        numBufferMaps           = 0;
+        bytesMapped             = 0;
+        numBufferUnmaps         = 0;
+        bytesFlushed            = 0;
+        numStagingUploads       = 0;
+        bytesStagingUploaded    = 0;
+        numStagingDownloads     = 0;
+        bytesStagingDownloaded  = 0;
+    }
+    //-------------------------------------------------------------------------
+    NULLFrameStats& NULLFrameStats::operator += ( const NULLFrameStats &other )
+    {
+        numFrames               += other.numFrames;
+        numPsoBinds             += other.numPsoBinds;
+        numComputePsoBinds      += other.numComputePsoBinds;
+        numSamplerblockBinds    += other.numSamplerblockBinds;
+        numTextureBinds         += other.numTextureBinds;
+        numVaoBinds             += other.numVaoBinds;
+        numRenderTargetBinds    += other.numRenderTargetBinds;
+        numClears               += other.numClears;
+        numDrawCalls            += other.numDrawCalls;
+        numInstances            += other.numInstances;
+        numPrimitives           += other.numPrimitives;
+        numDispatches           += other.numDispatches;
+        numBufferMaps           += other.numBufferMaps;
+        bytesMapped             += other.bytesMapped;
+        numBufferUnmaps         += other.numBufferUnmaps;
+        bytesFlushed            += other.bytesFlushed;
+        numStagingUploads       += other.numStagingUploads;
+        bytesStagingUploaded    += other.bytesStagingUploaded;
+        numStagingDownloads     += other.numStagingDownloads;
+        bytesStagingDownloaded  += other.bytesStagingDownloaded;
+        return *this;
+    }
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    NULLCommandRecorder::NULLCommandRecorder() :
+        mEnabled( false ),
+        mOutputStream( 0 )
+    {
+    }
+    //-------------------------------------------------------------------------
+    uint32 NULLCommandRecorder::getPsoId( const void *pso )
+    {
+        PsoIdMap::const_iterator itor = mPsoIds.find( pso );
+        if( itor == mPsoIds.end() )
+            itor = mPsoIds.insert( PsoIdMap::value_type( pso, (uint32)mPsoIds.size() ) ).first;
+
+        return itor->second;
+    }
+    //-------------------------------------------------------------------------
+    void NULLCommandRecorder::setEnabled( bool bEnabled )
+    {
+        if( bEnabled && !mEnabled )
+            mCurrentFrame.reset();
+
+        mEnabled = bEnabled;
+    }
+    //-------------------------------------------------------------------------
+    void NULLCommandRecorder::resetAccumulatedStats(void)
+    {
+        mAccumulated.reset();
+        mPsoIds.clear();
+    }
+    //-------------------------------------------------------------------------
+    void NULLCommandRecorder::_recordPso( const HlmsPso *pso )
+    {
+        if( !mEnabled )
+            return;
+
+        ++mCurrentFrame.numPsoBinds;
+        if( mOutputStream )
+            *mOutputStream << "pso " << (pso ? getPsoId( pso ) : -1u) << "\n";
+    }
+    //-------------------------------------------------------------------------
+    void NULLCommandRecorder::_recordComputePso( const HlmsComputePso *pso )
+    {
+        if( !mEnabled )
+            return;
+
+        ++mCurrentFrame.numComputePsoBinds;
+        if( mOutputStream )
+            *mOutputStream << "compute_pso " << (pso ? getPsoId( pso ) : -1u) << "\n";
+    }
+    //-------------------------------------------------------------------------
+    void NULLCommandRecorder::_recordSamplerblock( uint8 texUnit, const HlmsSamplerblock *samplerblock )
+    {
+        if( !mEnabled )
+            return;
+
+        ++mCurrentFrame.numSamplerblockBinds;
+        if( mOutputStream )
+            *mOutputStream << "sampler " << (uint32)texUnit << "\n";
+    }
+    //-------------------------------------------------------------------------
+    void NULLCommandRecorder::_recordTexture( size_t unit, const Texture *texture )
+    {
+        if( !mEnabled )
+            return;
+
+        ++mCurrentFrame.numTextureBinds;
+        if( mOutputStream )
+            *mOutputStream << "texture " << unit << " " << texture->getName() << "\n";
+    }
+    //-------------------------------------------------------------------------
+    void NULLCommandRecorder::_recordVao( uint32 vaoName )
+    {
+        if( !mEnabled )
+            return;
+
+        ++mCurrentFrame.numVaoBinds;
+        if( mOutputStream )
+            *mOutputStream << "vao " << vaoName << "\n";
+    }
+    //-------------------------------------------------------------------------
+    void NULLCommandRecorder::_recordRenderTarget( const RenderTarget *renderTarget )
+    {
+        if( !mEnabled )
+            return;
+
+        ++mCurrentFrame.numRenderTargetBinds;
+        if( mOutputStream )
+        {
+            *mOutputStream << "render_target " <<
+                              (renderTarget ? renderTarget->getName() : BLANKSTRING) << "\n";
+        }
+    }
+    //-------------------------------------------------------------------------
+    void NULLCommandRecorder::_recordClear( unsigned int buffers )
+    {
+        if( !mEnabled )
+            return;
+
+        ++mCurrentFrame.numClears;
+        if( mOutputStream )
+            *mOutputStream << "clear " << buffers << "\n";
+    }
+    //-------------------------------------------------------------------------
+    void NULLCommandRecorder::_recordDraw( bool indexed, uint32 primCount, uint32 instanceCount )
+    {
+        if( !mEnabled )
+            return;
+
+        ++mCurrentFrame.numDrawCalls;
+        mCurrentFrame.numInstances  += instanceCount;
+        mCurrentFrame.numPrimitives += primCount;
+        if( mOutputStream )
+        {
+            *mOutputStream << (indexed ? "draw_indexed " : "draw ") <<
+                              primCount << " " << instanceCount << "\n";
+        }
+    }
+    //-------------------------------------------------------------------------
+    void NULLCommandRecorder::_recordDispatch(void)
+    {
+        if( !mEnabled )
+            return;
+
+        ++mCurrentFrame.numDispatches;
+        if( mOutputStream )
+            *mOutputStream << "dispatch\n";
+    }
+    //-------------------------------------------------------------------------
+    void NULLCommandRecorder::_recordBufferMap( size_t bytes )
+    {
+        if( !mEnabled )
+            return;
+
+        ++mCurrentFrame.numBufferMaps;
+        mCurrentFrame.bytesMapped += bytes;
+        if( mOutputStream )
+            *mOutputStream << "map " << bytes << "\n";
+    }
+    //-------------------------------------------------------------------------
+    void NULLCommandRecorder::_recordBufferUnmap( size_t bytesFlushed )
+    {
+        if( !mEnabled )
+            return;
+
+        ++mCurrentFrame.numBufferUnmaps;
+        mCurrentFrame.bytesFlushed += bytesFlushed;
+        if( mOutputStream )
+            *mOutputStream << "unmap " << bytesFlushed << "\n";
+    }
+    //-------------------------------------------------------------------------
+    void NULLCommandRecorder::_recordStagingUpload( size_t bytes )
+    {
+        if( !mEnabled )
+            return;
+
+        ++mCurrentFrame.numStagingUploads;
+        mCurrentFrame.bytesStagingUploaded += bytes;
+        if( mOutputStream )
+            *mOutputStream << "staging_upload " << bytes << "\n";
+    }
+    //-------------------------------------------------------------------------
+    void NULLCommandRecorder::_recordStagingDownload( size_t bytes )
+    {
+        if( !mEnabled )
+            return;
+
+        ++mCurrentFrame.numStagingDownloads;
+        mCurrentFrame.bytesStagingDownloaded += bytes;
+        if( mOutputStream )
+            *mOutputStream << "staging_download " << bytes << "\n";
+    }
+    //-------------------------------------------------------------------------
+    void NULLCommandRecorder::_notifyFrameEnded( uint32 frameCount )
+    {
+        if( !mEnabled )
+            return;
+
+        mCurrentFrame.frameCount = frameCount;
+        mCurrentFrame.numFrames = 1u;
+
+        if( mOutputStream )
+        {
+            *mOutputStream << "end_frame " << frameCount <<
+                              " psos " << mCurrentFrame.numPsoBinds <<
+                              " textures " << mCurrentFrame.numTextureBinds <<
+                              " draws " << mCurrentFrame.numDrawCalls <<
+                              " mapped " << mCurrentFrame.bytesMapped <<
+                              " uploaded " << mCurrentFrame.bytesStagingUploaded << "\n";
+        }
+
+        mAccumulated += mCurrentFrame;
+        mAccumulated.frameCount = frameCount;
+        mLastFrame = mCurrentFrame;
+        mCurrentFrame.reset();
+    }
+}
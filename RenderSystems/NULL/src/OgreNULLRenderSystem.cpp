@@ -29,9 +29,14 @@ Copyright (c) 2000-2014 Torus Knot Software Ltd
 #include "OgreNULLRenderSystem.h"
 #include "OgreNULLRenderWindow.h"
 #include "OgreNULLTextureManager.h"
+#include "OgreNULLGpuProgramManager.h"
 #include "Vao/OgreNULLVaoManager.h"
+#include "Vao/OgreNULLBufferInterface.h"
 
 #include "OgreDefaultHardwareBufferManager.h"
+#include "CommandBuffer/OgreCbDrawCall.h"
+#include "Vao/OgreIndirectBufferPacked.h"
+#include "Vao/OgreVertexArrayObject.h"
 
 namespace Ogre
 {
@@ -39,10 +44,18 @@ namespace Ogre
     NULLRenderSystem::NULLRenderSystem() :
         RenderSystem(),
         mInitialized( false ),
-        mHardwareBufferManager( 0 )
+        mHardwareBufferManager( 0 ),
+        mGpuProgramManager( 0 ),
+        mSwIndirectBufferPtr( 0 ),
+        mIndirectBufferStart( 0 )
     {
     }
     //-------------------------------------------------------------------------
+    NULLRenderSystem::~NULLRenderSystem()
+    {
+        shutdown();
+    }
+    //-------------------------------------------------------------------------
     void NULLRenderSystem::shutdown(void)
     {
         OGRE_DELETE mHardwareBufferManager;
@@ -51,6 +64,9 @@ namespace Ogre
         OGRE_DELETE mTextureManager;
         mTextureManager = 0;
 
+        OGRE_DELETE mGpuProgramManager;
+        mGpuProgramManager = 0;
+
         {
             vector<RenderTarget*>::type::const_iterator itor = mRenderTargets.begin();
             vector<RenderTarget*>::type::const_iterator end  = mRenderTargets.end();
@@ -141,6 +157,7 @@ namespace Ogre
                                                          const NameValuePairList *miscParams )
     {
         RenderWindow *win = OGRE_NEW NULLRenderWindow();
+        win->create( name, width, height, fullScreen, miscParams );
 
         if( !mInitialized )
         {
@@ -149,7 +166,8 @@ namespace Ogre
 
             mHardwareBufferManager = new v1::DefaultHardwareBufferManager();
             mTextureManager = new NULLTextureManager();
-            mVaoManager = OGRE_NEW NULLVaoManager();
+            mGpuProgramManager = OGRE_NEW NULLGpuProgramManager();
+            mVaoManager = OGRE_NEW NULLVaoManager( &mCommandRecorder );
 
             mInitialized = true;
         }
@@ -225,18 +243,25 @@ namespace Ogre
                                               int32 mipmapLevel, int32 textureArrayIndex,
                                               PixelFormat pixelFormat )
     {
+        if( texture )
+            mCommandRecorder._recordTexture( slot, texture );
     }
     //-------------------------------------------------------------------------
     void NULLRenderSystem::_setTextureCS( uint32 slot, bool enabled, Texture *texPtr )
     {
+        if( enabled && texPtr )
+            mCommandRecorder._recordTexture( slot, texPtr );
     }
     //-------------------------------------------------------------------------
     void NULLRenderSystem::_setHlmsSamplerblockCS( uint8 texUnit, const HlmsSamplerblock *samplerblock )
     {
+        mCommandRecorder._recordSamplerblock( texUnit, samplerblock );
     }
     //-------------------------------------------------------------------------
     void NULLRenderSystem::_setTexture(size_t unit, bool enabled,  Texture *texPtr)
     {
+        if( enabled && texPtr )
+            mCommandRecorder._recordTexture( unit, texPtr );
     }
     //-------------------------------------------------------------------------
     void NULLRenderSystem::_setTextureCoordSet(size_t unit, size_t index)
@@ -258,6 +283,24 @@ namespace Ogre
     //-------------------------------------------------------------------------
     void NULLRenderSystem::_setIndirectBuffer( IndirectBufferPacked *indirectBuffer )
     {
+        mSwIndirectBufferPtr = 0;
+        mIndirectBufferStart = 0;
+
+        if( indirectBuffer )
+        {
+            if( mVaoManager->supportsIndirectBuffers() )
+            {
+                //Our "GPU" buffers live in system memory, so the draws can be read back.
+                NULLBufferInterface *bufferInterface =
+                        static_cast<NULLBufferInterface*>( indirectBuffer->getBufferInterface() );
+                mSwIndirectBufferPtr = bufferInterface->getNullDataPtr();
+                mIndirectBufferStart = indirectBuffer->_getInternalBufferStart();
+            }
+            else
+            {
+                mSwIndirectBufferPtr = indirectBuffer->getSwBufferPtr();
+            }
+        }
     }
     //-------------------------------------------------------------------------
     DepthBuffer* NULLRenderSystem::_createDepthBufferFor( RenderTarget *renderTarget,
@@ -276,18 +319,23 @@ namespace Ogre
     //-------------------------------------------------------------------------
     void NULLRenderSystem::_setViewport(Viewport *vp)
     {
+        //Listeners like the OverlaySystem look for it.
+        mActiveViewport = vp;
     }
     //-------------------------------------------------------------------------
     void NULLRenderSystem::_setHlmsSamplerblock( uint8 texUnit, const HlmsSamplerblock *Samplerblock )
     {
+        mCommandRecorder._recordSamplerblock( texUnit, Samplerblock );
     }
     //-------------------------------------------------------------------------
     void NULLRenderSystem::_setPipelineStateObject( const HlmsPso *pso )
     {
+        mCommandRecorder._recordPso( pso );
     }
     //-------------------------------------------------------------------------
     void NULLRenderSystem::_setComputePso( const HlmsComputePso *pso )
     {
+        mCommandRecorder._recordComputePso( pso );
     }
     //-------------------------------------------------------------------------
     VertexElementType NULLRenderSystem::getColourVertexElementType(void) const
@@ -297,38 +345,68 @@ namespace Ogre
     //-------------------------------------------------------------------------
     void NULLRenderSystem::_dispatch( const HlmsComputePso &pso )
     {
+        mCommandRecorder._recordDispatch();
     }
     //-------------------------------------------------------------------------
     void NULLRenderSystem::_setVertexArrayObject( const VertexArrayObject *vao )
     {
+        mCommandRecorder._recordVao( vao ? vao->getVaoName() : 0 );
     }
     //-------------------------------------------------------------------------
     void NULLRenderSystem::_render( const CbDrawCallIndexed *cmd )
     {
+        if( !mCommandRecorder.getEnabled() )
+            return;
+
+        const CbDrawIndexed *drawCmd = reinterpret_cast<const CbDrawIndexed*>(
+                    mSwIndirectBufferPtr + ((size_t)cmd->indirectBufferOffset - mIndirectBufferStart) );
+
+        for( uint32 i=cmd->numDraws; i--; )
+        {
+            mCommandRecorder._recordDraw( true, drawCmd->primCount, drawCmd->instanceCount );
+            ++drawCmd;
+        }
     }
     //-------------------------------------------------------------------------
     void NULLRenderSystem::_render( const CbDrawCallStrip *cmd )
     {
+        if( !mCommandRecorder.getEnabled() )
+            return;
+
+        const CbDrawStrip *drawCmd = reinterpret_cast<const CbDrawStrip*>(
+                    mSwIndirectBufferPtr + ((size_t)cmd->indirectBufferOffset - mIndirectBufferStart) );
+
+        for( uint32 i=cmd->numDraws; i--; )
+        {
+            mCommandRecorder._recordDraw( false, drawCmd->primCount, drawCmd->instanceCount );
+            ++drawCmd;
+        }
     }
     //-------------------------------------------------------------------------
     void NULLRenderSystem::_renderEmulated( const CbDrawCallIndexed *cmd )
     {
+        //_setIndirectBuffer already pointed us to the right memory
+        _render( cmd );
     }
     //-------------------------------------------------------------------------
     void NULLRenderSystem::_renderEmulated( const CbDrawCallStrip *cmd )
     {
+        _render( cmd );
     }
     //-------------------------------------------------------------------------
     void NULLRenderSystem::_setRenderOperation( const v1::CbRenderOp *cmd )
     {
+        mCommandRecorder._recordVao( 0 );
     }
     //-------------------------------------------------------------------------
     void NULLRenderSystem::_render( const v1::CbDrawCallIndexed *cmd )
     {
+        mCommandRecorder._recordDraw( true, cmd->primCount, cmd->instanceCount );
     }
     //-------------------------------------------------------------------------
     void NULLRenderSystem::_render( const v1::CbDrawCallStrip *cmd )
     {
+        mCommandRecorder._recordDraw( false, cmd->primCount, cmd->instanceCount );
     }
     //-------------------------------------------------------------------------
     void NULLRenderSystem::bindGpuProgramParameters(GpuProgramType gptype,
@@ -343,6 +421,7 @@ namespace Ogre
     void NULLRenderSystem::clearFrameBuffer( unsigned int buffers, const ColourValue& colour,
                                              Real depth, unsigned short stencil )
     {
+        mCommandRecorder._recordClear( buffers );
     }
     //-------------------------------------------------------------------------
     void NULLRenderSystem::discardFrameBuffer( unsigned int buffers )
@@ -371,6 +450,7 @@ namespace Ogre
     //-------------------------------------------------------------------------
     void NULLRenderSystem::_setRenderTarget(RenderTarget *target, uint8 viewportRenderTargetFlags)
     {
+        mCommandRecorder._recordRenderTarget( target );
     }
     //-------------------------------------------------------------------------
     void NULLRenderSystem::preExtraThreadsStarted()
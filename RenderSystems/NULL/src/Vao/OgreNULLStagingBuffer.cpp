@@ -29,6 +29,7 @@ THE SOFTWARE.
 #include "Vao/OgreNULLStagingBuffer.h"
 #include "Vao/OgreNULLVaoManager.h"
 #include "Vao/OgreNULLBufferInterface.h"
+#include "OgreNULLCommandRecorder.h"
 
 #include "OgreStringConverter.h"
 
@@ -65,17 +66,22 @@ namespace Ogre
     {
         mMappedPtr = 0;
 
+        NULLCommandRecorder *commandRecorder =
+                static_cast<NULLVaoManager*>( mVaoManager )->getCommandRecorder();
+
         for( size_t i=0; i<numDestinations; ++i )
         {
             const Destination &dst = destinations[i];
 
+            commandRecorder->_recordStagingUpload( dst.length );
+
             NULLBufferInterface *bufferInterface = static_cast<NULLBufferInterface*>(
                                                         dst.destination->getBufferInterface() );
 
             assert( dst.destination->getBufferType() == BT_DEFAULT );
 
-            size_t dstOffset = dst.dstOffset + dst.destination->_getInternalBufferStart() *
-                                                        dst.destination->getBytesPerElement();
+            //Each buffer owns its memory, which begins at its internal buffer start
+            size_t dstOffset = dst.dstOffset;
 
             uint8 *dstPtr = bufferInterface->getNullDataPtr();
 
@@ -118,8 +124,12 @@ namespace Ogre
 
         uint8 *srcPtr = bufferInterface->getNullDataPtr();
 
+        static_cast<NULLVaoManager*>( mVaoManager )->getCommandRecorder()->
+                _recordStagingDownload( srcLength );
+
         memcpy( mNullDataPtr + mInternalBufferStart + freeRegionOffset,
-                srcPtr + source->_getFinalBufferStart() * source->getBytesPerElement() + srcOffset,
+                srcPtr + (source->_getFinalBufferStart() - source->_getInternalBufferStart()) *
+                source->getBytesPerElement() + srcOffset,
                 srcLength );
 
         return freeRegionOffset;
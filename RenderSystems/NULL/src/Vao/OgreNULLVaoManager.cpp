@@ -35,6 +35,7 @@ THE SOFTWARE.
 #include "Vao/OgreNULLUavBufferPacked.h"
 #include "Vao/OgreNULLMultiSourceVertexBufferPool.h"
 #include "Vao/OgreNULLAsyncTicket.h"
+#include "OgreNULLCommandRecorder.h"
 
 #include "Vao/OgreIndirectBufferPacked.h"
 
@@ -42,12 +43,21 @@ THE SOFTWARE.
 
 #include "OgreTimer.h"
 #include "OgreStringConverter.h"
+#include "OgreMath.h"
 
 namespace Ogre
 {
-    NULLVaoManager::NULLVaoManager() :
-        mDrawId( 0 )
+    NULLVaoManager::NULLVaoManager( NULLCommandRecorder *commandRecorder ) :
+        mDrawId( 0 ),
+        mCommandRecorder( commandRecorder )
     {
+        //Keep pools of 128MB each for static meshes
+        mDefaultPoolSize[CPU_INACCESSIBLE]  = 128 * 1024 * 1024;
+
+        //Keep pools of 32MB each for dynamic vertex buffers
+        for( size_t i=CPU_ACCESSIBLE_DEFAULT; i<=CPU_ACCESSIBLE_PERSISTENT_COHERENT; ++i )
+            mDefaultPoolSize[i] = 32 * 1024 * 1024;
+
         mConstBufferAlignment   = 256;
         mTexBufferAlignment     = 256;
 
@@ -74,15 +84,75 @@ namespace Ogre
         deleteAllBuffers();
     }
     //-----------------------------------------------------------------------------------
+    void NULLVaoManager::allocateVbo( size_t sizeBytes, size_t alignment, BufferType bufferType,
+                                      size_t &outVboIdx, size_t &outBufferOffset )
+    {
+        assert( alignment > 0 );
+
+        VboFlag vboFlag = bufferTypeToVboFlag( bufferType );
+
+        if( bufferType >= BT_DYNAMIC_DEFAULT )
+            sizeBytes   *= mDynamicBufferMultiplier;
+
+        VboVec::iterator itor = mVbos[vboFlag].begin();
+        VboVec::iterator end  = mVbos[vboFlag].end();
+
+        size_t bestVboIdx   = ~0;
+        size_t bufferOffset = TlsfSubAllocator::NoSpace;
+
+        while( itor != end && bufferOffset == TlsfSubAllocator::NoSpace )
+        {
+            bufferOffset = itor->allocator.allocate( sizeBytes, alignment );
+            if( bufferOffset != TlsfSubAllocator::NoSpace )
+                bestVboIdx = itor - mVbos[vboFlag].begin();
+
+            ++itor;
+        }
+
+        if( bestVboIdx == (size_t)~0 )
+        {
+            //No luck, "allocate" a new pool.
+            bestVboIdx = mVbos[vboFlag].size();
+
+            Vbo newVbo;
+            newVbo.sizeBytes = std::max( mDefaultPoolSize[vboFlag], sizeBytes );
+            newVbo.allocator.initialize( newVbo.sizeBytes );
+            mVbos[vboFlag].push_back( newVbo );
+
+            bufferOffset = mVbos[vboFlag].back().allocator.allocate( sizeBytes, alignment );
+            assert( bufferOffset != TlsfSubAllocator::NoSpace );
+        }
+
+        outVboIdx       = bestVboIdx;
+        outBufferOffset = bufferOffset;
+    }
+    //-----------------------------------------------------------------------------------
+    void NULLVaoManager::deallocateVbo( size_t vboIdx, size_t bufferOffset, size_t sizeBytes,
+                                        BufferType bufferType )
+    {
+        VboFlag vboFlag = bufferTypeToVboFlag( bufferType );
+
+        if( bufferType >= BT_DYNAMIC_DEFAULT )
+            sizeBytes *= mDynamicBufferMultiplier;
+
+        Vbo &vbo = mVbos[vboFlag][vboIdx];
+        vbo.allocator.deallocate( bufferOffset, sizeBytes );
+    }
+    //-----------------------------------------------------------------------------------
     VertexBufferPacked* NULLVaoManager::createVertexBufferImpl( size_t numElements,
                                                                    uint32 bytesPerElement,
                                                                    BufferType bufferType,
                                                                    void *initialData, bool keepAsShadow,
                                                                    const VertexElement2Vec &vElements )
     {
-        NULLBufferInterface *bufferInterface = new NULLBufferInterface( 0 );
+        size_t vboIdx;
+        size_t bufferOffset;
+
+        allocateVbo( numElements * bytesPerElement, bytesPerElement, bufferType, vboIdx, bufferOffset );
+
+        NULLBufferInterface *bufferInterface = new NULLBufferInterface( vboIdx );
         VertexBufferPacked *retVal = OGRE_NEW VertexBufferPacked(
-                                                        0, numElements, bytesPerElement, 0,
+                                                        bufferOffset, numElements, bytesPerElement, 0,
                                                         bufferType, initialData, keepAsShadow,
                                                         this, bufferInterface, vElements, 0, 0, 0 );
 
@@ -94,6 +164,13 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void NULLVaoManager::destroyVertexBufferImpl( VertexBufferPacked *vertexBuffer )
     {
+        NULLBufferInterface *bufferInterface = static_cast<NULLBufferInterface*>(
+                                                        vertexBuffer->getBufferInterface() );
+
+        deallocateVbo( bufferInterface->getVboPoolIndex(),
+                       vertexBuffer->_getInternalBufferStart() * vertexBuffer->getBytesPerElement(),
+                       vertexBuffer->_getInternalTotalSizeBytes(),
+                       vertexBuffer->getBufferType() );
     }
     //-----------------------------------------------------------------------------------
     MultiSourceVertexBufferPool* NULLVaoManager::createMultiSourceVertexBufferPoolImpl(
@@ -101,9 +178,15 @@ namespace Ogre
                                                 size_t maxNumVertices, size_t totalBytesPerVertex,
                                                 BufferType bufferType )
     {
-        return OGRE_NEW NULLMultiSourceVertexBufferPool( 0, vertexElementsBySource,
+        size_t vboIdx;
+        size_t bufferOffset;
+
+        allocateVbo( maxNumVertices * totalBytesPerVertex, totalBytesPerVertex,
+                     bufferType, vboIdx, bufferOffset );
+
+        return OGRE_NEW NULLMultiSourceVertexBufferPool( vboIdx, vertexElementsBySource,
                                                             maxNumVertices, bufferType,
-                                                            0, this );
+                                                            bufferOffset, this );
     }
     //-----------------------------------------------------------------------------------
     IndexBufferPacked* NULLVaoManager::createIndexBufferImpl( size_t numElements,
@@ -111,9 +194,14 @@ namespace Ogre
                                                                  BufferType bufferType,
                                                                  void *initialData, bool keepAsShadow )
     {
-        NULLBufferInterface *bufferInterface = new NULLBufferInterface( 0 );
+        size_t vboIdx;
+        size_t bufferOffset;
+
+        allocateVbo( numElements * bytesPerElement, bytesPerElement, bufferType, vboIdx, bufferOffset );
+
+        NULLBufferInterface *bufferInterface = new NULLBufferInterface( vboIdx );
         IndexBufferPacked *retVal = OGRE_NEW IndexBufferPacked(
-                                                        0, numElements, bytesPerElement, 0,
+                                                        bufferOffset, numElements, bytesPerElement, 0,
                                                         bufferType, initialData, keepAsShadow,
                                                         this, bufferInterface );
 
@@ -125,11 +213,21 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void NULLVaoManager::destroyIndexBufferImpl( IndexBufferPacked *indexBuffer )
     {
+        NULLBufferInterface *bufferInterface = static_cast<NULLBufferInterface*>(
+                                                        indexBuffer->getBufferInterface() );
+
+        deallocateVbo( bufferInterface->getVboPoolIndex(),
+                       indexBuffer->_getInternalBufferStart() * indexBuffer->getBytesPerElement(),
+                       indexBuffer->_getInternalTotalSizeBytes(),
+                       indexBuffer->getBufferType() );
     }
     //-----------------------------------------------------------------------------------
     ConstBufferPacked* NULLVaoManager::createConstBufferImpl( size_t sizeBytes, BufferType bufferType,
                                                                  void *initialData, bool keepAsShadow )
     {
+        size_t vboIdx;
+        size_t bufferOffset;
+
         uint32 alignment = mConstBufferAlignment;
 
         size_t bindableSize = sizeBytes;
@@ -143,9 +241,11 @@ namespace Ogre
             sizeBytes = ( (sizeBytes + alignment - 1) / alignment ) * alignment;
         }
 
-        NULLBufferInterface *bufferInterface = new NULLBufferInterface( 0 );
+        allocateVbo( sizeBytes, alignment, bufferType, vboIdx, bufferOffset );
+
+        NULLBufferInterface *bufferInterface = new NULLBufferInterface( vboIdx );
         ConstBufferPacked *retVal = OGRE_NEW NULLConstBufferPacked(
-                                                        0, sizeBytes, 1, 0,
+                                                        bufferOffset, sizeBytes, 1, 0,
                                                         bufferType, initialData, keepAsShadow,
                                                         this, bufferInterface, bindableSize );
 
@@ -157,15 +257,23 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void NULLVaoManager::destroyConstBufferImpl( ConstBufferPacked *constBuffer )
     {
+        NULLBufferInterface *bufferInterface = static_cast<NULLBufferInterface*>(
+                                                        constBuffer->getBufferInterface() );
+
+        deallocateVbo( bufferInterface->getVboPoolIndex(),
+                       constBuffer->_getInternalBufferStart() * constBuffer->getBytesPerElement(),
+                       constBuffer->_getInternalTotalSizeBytes(),
+                       constBuffer->getBufferType() );
     }
     //-----------------------------------------------------------------------------------
     TexBufferPacked* NULLVaoManager::createTexBufferImpl( PixelFormat pixelFormat, size_t sizeBytes,
                                                              BufferType bufferType,
                                                              void *initialData, bool keepAsShadow )
     {
-        uint32 alignment = mTexBufferAlignment;
+        size_t vboIdx;
+        size_t bufferOffset;
 
-        VboFlag vboFlag = bufferTypeToVboFlag( bufferType );
+        uint32 alignment = mTexBufferAlignment;
 
         if( bufferType >= BT_DYNAMIC_DEFAULT )
         {
@@ -176,9 +284,11 @@ namespace Ogre
             sizeBytes = ( (sizeBytes + alignment - 1) / alignment ) * alignment;
         }
 
-        NULLBufferInterface *bufferInterface = new NULLBufferInterface( 0 );
+        allocateVbo( sizeBytes, alignment, bufferType, vboIdx, bufferOffset );
+
+        NULLBufferInterface *bufferInterface = new NULLBufferInterface( vboIdx );
         TexBufferPacked *retVal = OGRE_NEW NULLTexBufferPacked(
-                                                        0, sizeBytes, 1, 0,
+                                                        bufferOffset, sizeBytes, 1, 0,
                                                         bufferType, initialData, keepAsShadow,
                                                         this, bufferInterface, pixelFormat );
 
@@ -190,15 +300,33 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void NULLVaoManager::destroyTexBufferImpl( TexBufferPacked *texBuffer )
     {
+        NULLBufferInterface *bufferInterface = static_cast<NULLBufferInterface*>(
+                                                        texBuffer->getBufferInterface() );
+
+        deallocateVbo( bufferInterface->getVboPoolIndex(),
+                       texBuffer->_getInternalBufferStart() * texBuffer->getBytesPerElement(),
+                       texBuffer->_getInternalTotalSizeBytes(),
+                       texBuffer->getBufferType() );
     }
     //-----------------------------------------------------------------------------------
     UavBufferPacked* NULLVaoManager::createUavBufferImpl( size_t numElements, uint32 bytesPerElement,
                                                           uint32 bindFlags,
                                                           void *initialData, bool keepAsShadow )
     {
-        NULLBufferInterface *bufferInterface = new NULLBufferInterface( 0 );
+        size_t vboIdx;
+        size_t bufferOffset;
+
+        //The offset must also be a multiple of the element size.
+        const size_t alignment = Math::lcm( mUavBufferAlignment, bytesPerElement );
+
+        //UAV Buffers can't be dynamic.
+        const BufferType bufferType = BT_DEFAULT;
+
+        allocateVbo( numElements * bytesPerElement, alignment, bufferType, vboIdx, bufferOffset );
+
+        NULLBufferInterface *bufferInterface = new NULLBufferInterface( vboIdx );
         UavBufferPacked *retVal = OGRE_NEW NULLUavBufferPacked(
-                                                        0, numElements, bytesPerElement,
+                                                        bufferOffset, numElements, bytesPerElement,
                                                         bindFlags, initialData, keepAsShadow,
                                                         this, bufferInterface );
 
@@ -210,6 +338,13 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void NULLVaoManager::destroyUavBufferImpl( UavBufferPacked *uavBuffer )
     {
+        NULLBufferInterface *bufferInterface = static_cast<NULLBufferInterface*>(
+                                                        uavBuffer->getBufferInterface() );
+
+        deallocateVbo( bufferInterface->getVboPoolIndex(),
+                       uavBuffer->_getInternalBufferStart() * uavBuffer->getBytesPerElement(),
+                       uavBuffer->_getInternalTotalSizeBytes(),
+                       BT_DEFAULT );
     }
     //-----------------------------------------------------------------------------------
     IndirectBufferPacked* NULLVaoManager::createIndirectBufferImpl( size_t sizeBytes,
@@ -232,11 +367,13 @@ namespace Ogre
         NULLBufferInterface *bufferInterface = 0;
         if( mSupportsIndirectBuffers )
         {
-            bufferInterface = new NULLBufferInterface( 0 );
+            size_t vboIdx;
+            allocateVbo( sizeBytes, alignment, bufferType, vboIdx, bufferOffset );
+            bufferInterface = new NULLBufferInterface( vboIdx );
         }
 
         IndirectBufferPacked *retVal = OGRE_NEW IndirectBufferPacked(
-                                                        0, sizeBytes, 1, 0,
+                                                        bufferOffset, sizeBytes, 1, 0,
                                                         bufferType, initialData, keepAsShadow,
                                                         this, bufferInterface );
 
@@ -259,6 +396,14 @@ namespace Ogre
     {
         if( mSupportsIndirectBuffers )
         {
+            NULLBufferInterface *bufferInterface = static_cast<NULLBufferInterface*>(
+                        indirectBuffer->getBufferInterface() );
+
+            deallocateVbo( bufferInterface->getVboPoolIndex(),
+                           indirectBuffer->_getInternalBufferStart() *
+                                indirectBuffer->getBytesPerElement(),
+                           indirectBuffer->_getInternalTotalSizeBytes(),
+                           indirectBuffer->getBufferType() );
         }
     }
     //-----------------------------------------------------------------------------------
@@ -283,7 +428,8 @@ namespace Ogre
                 ( (idx & maskVaoGl) << shiftVaoGl ) |
                 (idx & maskVao);
 
-        NULLVertexArrayObject *retVal = OGRE_NEW NULLVertexArrayObject( idx,
+        //The RenderQueue takes VAO name 0 as "no VAO bound".
+        NULLVertexArrayObject *retVal = OGRE_NEW NULLVertexArrayObject( idx + 1u,
                                                                         renderQueueId,
                                                                         vertexBuffers,
                                                                         indexBuffer,
@@ -320,6 +466,8 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void NULLVaoManager::_update(void)
     {
+        mCommandRecorder->_notifyFrameEnded( mFrameCount );
+
         VaoManager::_update();
 
         unsigned long currentTimeMs = mTimer->getMilliseconds();
@@ -391,5 +539,23 @@ namespace Ogre
         return static_cast<VboFlag>( std::max( 0, (bufferType - BT_DYNAMIC_DEFAULT) +
                                                     CPU_ACCESSIBLE_DEFAULT ) );
     }
+    //-----------------------------------------------------------------------------------
+    void NULLVaoManager::getMemoryStats( BufferType bufferType, MemoryStats &outStats ) const
+    {
+        outStats = MemoryStats();
+
+        const VboFlag vboFlag = bufferTypeToVboFlag( bufferType );
+
+        VboVec::const_iterator itor = mVbos[vboFlag].begin();
+        VboVec::const_iterator end  = mVbos[vboFlag].end();
+
+        while( itor != end )
+        {
+            MemoryStats poolStats;
+            itor->allocator.getStats( poolStats );
+            outStats.merge( poolStats );
+            ++itor;
+        }
+    }
 }
 
@@ -29,6 +29,7 @@ THE SOFTWARE.
 #include "Vao/OgreNULLBufferInterface.h"
 #include "Vao/OgreNULLVaoManager.h"
 #include "Vao/OgreNULLStagingBuffer.h"
+#include "OgreNULLCommandRecorder.h"
 
 namespace Ogre
 {
@@ -73,6 +74,8 @@ namespace Ogre
 
         size_t dynamicCurrentFrame = advanceFrame( bAdvanceFrame );
 
+        vaoManager->getCommandRecorder()->_recordBufferMap( elementCount * bytesPerElement );
+
         if( prevMappingState == MS_UNMAPPED || !canPersistentMap )
         {
             //Non-persistent buffers just map the small region they'll need.
@@ -88,7 +91,8 @@ namespace Ogre
                 length = mBuffer->_getInternalNumElements() * vaoManager->getDynamicBufferMultiplier();
             }
 
-            mMappedPtr = mNullDataPtr + offset * bytesPerElement;
+            //mNullDataPtr only holds this buffer, not the whole pool
+            mMappedPtr = mNullDataPtr + (offset - mBuffer->mInternalBufferStart) * bytesPerElement;
         }
 
         //For regular maps, mLastMappingStart is 0. So that we can later flush correctly.
@@ -118,8 +122,12 @@ namespace Ogre
         assert( flushStartElem + flushSizeElem <= mBuffer->mLastMappingCount &&
                 "Flush region out of bounds!" );
 
-        bool canPersistentMap = static_cast<NULLVaoManager*>( mBuffer->mVaoManager )->
-                                                                supportsArbBufferStorage();
+        NULLVaoManager *vaoManager = static_cast<NULLVaoManager*>( mBuffer->mVaoManager );
+        bool canPersistentMap = vaoManager->supportsArbBufferStorage();
+
+        vaoManager->getCommandRecorder()->_recordBufferUnmap(
+                    (flushSizeElem ? flushSizeElem : mBuffer->mLastMappingCount - flushStartElem) *
+                    mBuffer->mBytesPerElement );
 
         if( mBuffer->mBufferType <= BT_DYNAMIC_PERSISTENT ||
             unmapOption == UO_UNMAP_ALL || !canPersistentMap )
@@ -0,0 +1,118 @@
+/*
+    Measures Log::setAsyncEnabled: how long the logging threads spend inside
+    logMessage when every line is formatted & flushed synchronously, versus
+    when it is only copied into the lock-free queue and written out by the
+    background thread.
+
+    The .log file is written to (and removed from) the working directory.
+    Arguments: [numThreads] [messagesPerThread]
+*/
+
+#include "BenchmarkHarness.h"
+
+#include "OgreLogManager.h"
+#include "OgreTimer.h"
+#include "OgreStringConverter.h"
+#include "OgreBitwise.h"
+#include "Threading/OgreThreads.h"
+
+#include <iostream>
+#include <cstdio>
+
+using namespace Ogre;
+
+namespace
+{
+    const char *c_logName = "AsyncLogBenchmark_Output.log";
+
+    struct ProducerParams
+    {
+        Log             *log;
+        size_t          threadIdx;
+        size_t          numMessages;
+        unsigned long   elapsedUs;
+    };
+
+    typedef vector<ProducerParams>::type ProducerParamsVec;
+    //-------------------------------------------------------------------------
+    unsigned long producerThread( ThreadHandle *threadHandle )
+    {
+        ProducerParams *params = reinterpret_cast<ProducerParams*>( threadHandle->getUserParam() );
+
+        //Roughly what a typical Ogre log line looks like.
+        const String prefix = "Thread " + StringConverter::toString( params->threadIdx ) +
+                " Texture: some/long/path/to/a/texture_albedo.png: Loading 1 faces(PF_A8R8G8B8,"
+                "2048x2048x1) with 12 hardware generated mipmaps. Message ";
+
+        Timer timer;
+        for( size_t i=0; i<params->numMessages; ++i )
+            params->log->logMessage( prefix + StringConverter::toString( i ) );
+        params->elapsedUs = timer.getMicroseconds();
+
+        return 0;
+    }
+    THREAD_DECLARE( producerThread );
+    //-------------------------------------------------------------------------
+    /// Returns the slowest thread's time spent in logMessage, in microseconds.
+    unsigned long runProducers( Log *log, size_t numThreads, size_t messagesPerThread )
+    {
+        ProducerParamsVec params( numThreads );
+        ThreadHandleVec threadHandles;
+        threadHandles.reserve( numThreads );
+
+        for( size_t i=0; i<numThreads; ++i )
+        {
+            params[i].log           = log;
+            params[i].threadIdx     = i;
+            params[i].numMessages   = messagesPerThread;
+            params[i].elapsedUs     = 0;
+            threadHandles.push_back( Threads::CreateThread( THREAD_GET( producerThread ),
+                                                            i, &params[i] ) );
+        }
+
+        Threads::WaitForThreads( threadHandles );
+
+        unsigned long maxUs = 0;
+        for( size_t i=0; i<numThreads; ++i )
+            maxUs = std::max( maxUs, params[i].elapsedUs );
+        return maxUs;
+    }
+    //-------------------------------------------------------------------------
+    Log* createOutputLog(void)
+    {
+        Log *log = LogManager::getSingleton().createLog( c_logName, false, false, false );
+        log->setLogDetail( LL_BOREME );
+        return log;
+    }
+}
+
+namespace Benchmarks
+{
+    void runAsyncLogBenchmark( const BenchmarkContext &context )
+    {
+        const size_t numThreads         = std::max<size_t>( context.getArg( 0, 4u ), 1u );
+        const size_t messagesPerThread  = std::max<size_t>( context.getArg( 1, 50000u ), 1u );
+        const size_t totalMessages      = numThreads * messagesPerThread;
+
+        Log *log = createOutputLog();
+        const unsigned long syncUs = runProducers( log, numThreads, messagesPerThread );
+        LogManager::getSingleton().destroyLog( log );
+
+        log = createOutputLog();
+        log->setAsyncEnabled( true, Bitwise::firstPO2From( static_cast<uint32>( totalMessages ) ) );
+        const unsigned long asyncUs = runProducers( log, numThreads, messagesPerThread );
+        Timer timer;
+        log->flush();
+        const unsigned long asyncFlushUs = timer.getMicroseconds();
+        LogManager::getSingleton().destroyLog( log );
+
+        std::cout << numThreads << " threads x " << messagesPerThread << " messages" << std::endl;
+        std::cout << "  synchronous:  " << syncUs << "us (" << (syncUs * 1000.0 / messagesPerThread)
+                  << "ns per message per thread)" << std::endl;
+        std::cout << "  asynchronous: " << asyncUs << "us (" << (asyncUs * 1000.0 / messagesPerThread)
+                  << "ns per message per thread), then " << asyncFlushUs << "us to flush"
+                  << std::endl;
+
+        std::remove( c_logName );
+    }
+}
@@ -0,0 +1,152 @@
+/*
+    Measures SceneManager::updateAllLods with a large crowd of items using a mesh
+    with several LODs, while the camera sways back and forth so that many items
+    sit right around a LOD threshold.
+
+    Every frame the LODs are evaluated once for the main pass and once per shadow
+    map (shadow passes use the main camera as LOD camera). Compares the plain
+    update against SceneManager::setLodCaching + setLodHysteresis: reports the
+    time spent and the number of LOD transitions per frame.
+
+    Arguments: [numItems] [numFrames] [numShadowMaps] [numThreads]
+*/
+
+#include "BenchmarkHarness.h"
+
+#include "OgreRoot.h"
+#include "OgreCamera.h"
+#include "OgreSceneManager.h"
+#include "OgreItem.h"
+#include "OgreMesh2.h"
+#include "OgreMeshManager2.h"
+#include "OgreSubMesh2.h"
+#include "OgreTimer.h"
+
+#include <iostream>
+
+using namespace Ogre;
+
+namespace
+{
+    const Real c_lodDistances[4] = { 0.0f, 40.0f, 80.0f, 160.0f };
+    const Real c_hysteresis = 0.1f;
+    //-------------------------------------------------------------------------
+    /// A cube with 4 LODs. All of them share the same Vao; only the index matters here.
+    MeshPtr createLodCubeMesh( VaoManager *vaoManager )
+    {
+        MeshPtr mesh = Benchmarks::createCubeMesh( vaoManager, "BatchedLodBenchmarkCube" );
+
+        SubMesh *subMesh = mesh->getSubMesh( 0 );
+        VertexArrayObject *vao = subMesh->mVao[VpNormal][0];
+        for( size_t i=1; i<4u; ++i )
+        {
+            subMesh->mVao[VpNormal].push_back( vao );
+            subMesh->mVao[VpShadow].push_back( vao );
+        }
+
+        Mesh::LodValueArray lodValues;
+        for( size_t i=0; i<4u; ++i )
+            lodValues.push_back( c_lodDistances[i] );
+        mesh->_setLodValues( lodValues );
+
+        return mesh;
+    }
+    //-------------------------------------------------------------------------
+    void report( const char *phase, size_t numFrames, unsigned long microseconds,
+                 size_t numTransitions )
+    {
+        numFrames = std::max<size_t>( numFrames, 1u );
+        std::cout << phase << ": " << microseconds / 1000.0 / numFrames << " ms per frame, "
+                  << numTransitions / numFrames << " LOD transitions per frame" << std::endl;
+    }
+    //-------------------------------------------------------------------------
+    /// Moves the camera back and forth along the crowd, a bit further every frame.
+    void placeCamera( Camera *camera, size_t frame )
+    {
+        const Real sway = Math::Sin( frame * 0.9f ) * 3.0f;
+        camera->setPosition( 0, 5.0f, -20.0f + sway + frame * 0.05f );
+        camera->lookAt( 0, 0, 100.0f );
+    }
+}
+
+namespace Benchmarks
+{
+    void runBatchedLodBenchmark( const BenchmarkContext &context )
+    {
+        const size_t numItems       = context.getArg( 0, 50000u );
+        const size_t numFrames      = std::max<size_t>( context.getArg( 1, 60u ), 2u );
+        const size_t numShadowMaps  = context.getArg( 2, 3u );
+        const size_t numThreads     = std::max<size_t>( context.getArg( 3, 1u ), 1u );
+
+        Root *root = context.root;
+        SceneManager *sceneManager = root->createSceneManager(
+                    ST_GENERIC, numThreads,
+                    numThreads > 1u ? INSTANCING_CULLING_THREADED : INSTANCING_CULLING_SINGLETHREAD );
+        MeshPtr mesh = createLodCubeMesh( context.getVaoManager() );
+
+        //A crowd in front of the camera, spread over all the LODs
+        SceneNode *rootNode = sceneManager->getRootSceneNode();
+        const size_t itemsPerRow = 250u;
+        for( size_t i=0; i<numItems; ++i )
+        {
+            Item *item = sceneManager->createItem( mesh );
+            SceneNode *sceneNode = rootNode->createChildSceneNode();
+            sceneNode->setPosition( ((i % itemsPerRow) - itemsPerRow * 0.5f) * 0.8f, 0,
+                                    (i / itemsPerRow) * 0.8f );
+            sceneNode->attachObject( item );
+        }
+
+        Camera *camera = sceneManager->createCamera( "LodCamera" );
+        camera->setNearClipDistance( 0.5f );
+        camera->setFarClipDistance( 1000.0f );
+
+        std::cout << numItems << " items, " << numShadowMaps << " shadow maps, " << numThreads
+                  << " thread(s)" << std::endl;
+
+        Timer timer;
+
+        for( size_t pass=0; pass<3u; ++pass )
+        {
+            sceneManager->setLodCaching( pass != 0u );
+            sceneManager->setLodHysteresis( pass == 2u ? c_hysteresis : 0.0f );
+
+            //Start every pass from the same LODs
+            placeCamera( camera, 0 );
+            sceneManager->updateSceneGraph();
+            sceneManager->updateAllLods( camera, 1.0f, 0, 255u );
+
+            unsigned long lodUs = 0;
+            size_t numTransitions = 0;
+            for( size_t frame=1; frame<numFrames; ++frame )
+            {
+                placeCamera( camera, frame );
+                sceneManager->updateSceneGraph();
+
+                timer.reset();
+                for( size_t i=0; i<numShadowMaps + 1u; ++i )
+                    sceneManager->updateAllLods( camera, 1.0f, 0, 255u );
+                lodUs += timer.getMicroseconds();
+
+                numTransitions += sceneManager->getLodStats().numMeshTransitions;
+            }
+
+            const char *labels[3] =
+            {
+                "updateAllLods",
+                "updateAllLods, cached",
+                "updateAllLods, cached + hysteresis"
+            };
+            report( labels[pass], numFrames - 1u, lodUs, numTransitions );
+        }
+
+        sceneManager->setLodCaching( false );
+
+        root->destroySceneManager( sceneManager );
+
+        //Every LOD points to the same Vao. Leave one so it only gets destroyed once.
+        SubMesh *subMesh = mesh->getSubMesh( 0 );
+        subMesh->mVao[VpNormal].resize( 1u );
+        subMesh->mVao[VpShadow].resize( 1u );
+        MeshManager::getSingleton().remove( mesh->getHandle() );
+    }
+}
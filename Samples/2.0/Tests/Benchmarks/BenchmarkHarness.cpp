@@ -0,0 +1,258 @@
+/*
+    Runs the benchmarks on the NULL render system.
+
+    Usage: Test_Benchmarks [benchmarkName [args...]]
+    Without a name, every benchmark runs with its default arguments.
+    "Test_Benchmarks list" prints the names and the arguments each one accepts.
+*/
+
+#include "BenchmarkHarness.h"
+
+#include "OgreRoot.h"
+#include "OgreRenderSystem.h"
+#include "OgreRenderWindow.h"
+#include "OgreMesh2.h"
+#include "OgreMeshManager2.h"
+#include "OgreSubMesh2.h"
+#include "OgreArchiveManager.h"
+#include "OgreHlmsManager.h"
+#include "OgreHlmsUnlit.h"
+#include "OgreStringConverter.h"
+#include "OgreLogManager.h"
+
+#include "Vao/OgreVaoManager.h"
+#include "Vao/OgreVertexArrayObject.h"
+
+#ifdef OGRE_STATIC_LIB
+    #include "OgreNULLPlugin.h"
+#endif
+
+#include <iostream>
+
+#ifndef OGRE_BENCHMARKS_MEDIA_DIR
+    #define OGRE_BENCHMARKS_MEDIA_DIR "./"
+#endif
+
+using namespace Ogre;
+
+namespace Benchmarks
+{
+    VaoManager* BenchmarkContext::getVaoManager(void) const
+    {
+        return root->getRenderSystem()->getVaoManager();
+    }
+    //-------------------------------------------------------------------------
+    size_t BenchmarkContext::getArg( size_t idx, size_t defaultValue ) const
+    {
+        if( idx >= args.size() )
+            return defaultValue;
+        return StringConverter::parseUnsignedLong( args[idx],
+                                                   static_cast<unsigned long>( defaultValue ) );
+    }
+    //-------------------------------------------------------------------------
+    MeshPtr createCubeMesh( VaoManager *vaoManager, const String &name, bool keepAsShadow )
+    {
+        const uint16 c_indices[36] =
+        {
+            0, 2, 1, 2, 0, 3,   4, 5, 6, 6, 7, 4,   0, 1, 5, 5, 4, 0,
+            3, 6, 2, 6, 3, 7,   1, 2, 6, 6, 5, 1,   0, 4, 7, 7, 3, 0
+        };
+
+        MeshPtr mesh = MeshManager::getSingleton().createManual(
+                    name, ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME );
+        SubMesh *subMesh = mesh->createSubMesh();
+
+        VertexElement2Vec vertexElements;
+        vertexElements.push_back( VertexElement2( VET_FLOAT3, VES_POSITION ) );
+
+        //With keepAsShadow the buffers take ownership of the pointers.
+        float *vertices = reinterpret_cast<float*>(
+                    OGRE_MALLOC_SIMD( sizeof(float) * 8u * 3u, MEMCATEGORY_GEOMETRY ) );
+        for( size_t i=0; i<8u; ++i )
+        {
+            vertices[i * 3u + 0u] = (i == 1 || i == 2 || i == 5 || i == 6) ? 1.0f : -1.0f;
+            vertices[i * 3u + 1u] = (i == 2 || i == 3 || i == 6 || i == 7) ? 1.0f : -1.0f;
+            vertices[i * 3u + 2u] = i >= 4u ? 1.0f : -1.0f;
+        }
+        uint16 *indices = reinterpret_cast<uint16*>(
+                    OGRE_MALLOC_SIMD( sizeof(c_indices), MEMCATEGORY_GEOMETRY ) );
+        memcpy( indices, c_indices, sizeof(c_indices) );
+
+        VertexBufferPackedVec vertexBuffers;
+        vertexBuffers.push_back( vaoManager->createVertexBuffer( vertexElements, 8u, BT_IMMUTABLE,
+                                                                 vertices, keepAsShadow ) );
+        IndexBufferPacked *indexBuffer = vaoManager->createIndexBuffer(
+                                             IndexBufferPacked::IT_16BIT, 36u, BT_IMMUTABLE,
+                                             indices, keepAsShadow );
+        VertexArrayObject *vao = vaoManager->createVertexArrayObject( vertexBuffers, indexBuffer,
+                                                                      OT_TRIANGLE_LIST );
+        subMesh->mVao[VpNormal].push_back( vao );
+        subMesh->mVao[VpShadow].push_back( vao );
+
+        if( !keepAsShadow )
+        {
+            OGRE_FREE_SIMD( vertices, MEMCATEGORY_GEOMETRY );
+            OGRE_FREE_SIMD( indices, MEMCATEGORY_GEOMETRY );
+        }
+
+        mesh->_setBounds( Aabb( Vector3::ZERO, Vector3::UNIT_SCALE ), false );
+        mesh->_setBoundingSphereRadius( 1.732f );
+
+        return mesh;
+    }
+    //-------------------------------------------------------------------------
+    void reportPerFrame( const char *phase, size_t numFrames, unsigned long microseconds )
+    {
+        std::cout << phase << ": "
+                  << microseconds / 1000.0 / std::max<size_t>( numFrames, 1u )
+                  << " ms per frame" << std::endl;
+    }
+}
+
+namespace
+{
+    using namespace Benchmarks;
+
+    struct BenchmarkEntry
+    {
+        const char      *name;
+        const char      *usage;
+        BenchmarkFunc   func;
+    };
+
+    const BenchmarkEntry c_benchmarks[] =
+    {
+        { "AsyncLog",           "[numThreads] [messagesPerThread]", runAsyncLogBenchmark },
+        { "BatchedLod",         "[numItems] [numFrames] [numShadowMaps] [numThreads]",
+          runBatchedLodBenchmark },
+        { "FrameArena",         "[numLights] [numItems] [numFrames] [numThreads]",
+          runFrameArenaBenchmark },
+        { "GpuBillboard",       "[numBillboards] [iterations]", runGpuBillboardBenchmark },
+        { "HlmsSpawn",          "[numItems] [numDatablocks]", runHlmsSpawnBenchmark },
+        { "LightBinning",       "[numLights] [numItems] [numFrames] [numThreads]",
+          runLightBinningBenchmark },
+        { "MeshCodec",          "[gridSize] [iterations]", runMeshCodecBenchmark },
+        { "MeshStreaming",      "[numMeshes] [numVertices]", runMeshStreamingBenchmark },
+        { "MultiFrustumCull",   "[numItems] [numFrames] [numThreads]",
+          runMultiFrustumCullBenchmark },
+        { "OcclusionCulling",   "[numProps] [numFrames] [numThreads]",
+          runOcclusionCullingBenchmark },
+        { "PipelinedUpdate",    "[numGroups] [itemsPerGroup] [numFrames] [numThreads] [renderCost]",
+          runPipelinedUpdateBenchmark },
+#ifdef OGRE_BUILD_COMPONENT_SCENE_FORMAT
+        { "SceneStreaming",     "[numItems] [budgetMicroseconds]", runSceneStreamingBenchmark },
+#endif
+        { "ShadowCasterCull",   "[numItems] [numFrames] [numThreads]",
+          runShadowCasterCullBenchmark },
+        { "StaticBvhCull",      "[numItems] [numFrames] [numThreads]", runStaticBvhCullBenchmark },
+        { "StaticGeometry",     "[numItems] [numThreads]", runStaticGeometryBenchmark },
+        { "VaoAllocator",       "[numOps] [poolSizeMB] [numBuffers]", runVaoAllocatorBenchmark },
+        { "VertexConversion",   "[numVertices] [numThreads]", runVertexConversionBenchmark },
+    };
+    const size_t c_numBenchmarks = sizeof(c_benchmarks) / sizeof(c_benchmarks[0]);
+
+    void registerHlmsUnlit( Root *root, const String &mediaFolder )
+    {
+        ArchiveManager &archiveManager = ArchiveManager::getSingleton();
+
+        String mainFolderPath;
+        StringVector libraryFoldersPaths;
+        HlmsUnlit::getDefaultPaths( mainFolderPath, libraryFoldersPaths );
+
+        Archive *archiveUnlit = archiveManager.load( mediaFolder + mainFolderPath,
+                                                     "FileSystem", true );
+        ArchiveVec archiveUnlitLibraryFolders;
+        StringVector::const_iterator itor = libraryFoldersPaths.begin();
+        StringVector::const_iterator end  = libraryFoldersPaths.end();
+        while( itor != end )
+        {
+            archiveUnlitLibraryFolders.push_back(
+                        archiveManager.load( mediaFolder + *itor, "FileSystem", true ) );
+            ++itor;
+        }
+
+        HlmsUnlit *hlmsUnlit = OGRE_NEW HlmsUnlit( archiveUnlit, &archiveUnlitLibraryFolders );
+        root->getHlmsManager()->registerHlms( hlmsUnlit );
+    }
+}
+
+int main( int argc, const char *argv[] )
+{
+    const String selected = argc > 1 ? String( argv[1] ) : String();
+
+    if( selected == "list" )
+    {
+        for( size_t i=0; i<c_numBenchmarks; ++i )
+            std::cout << c_benchmarks[i].name << " " << c_benchmarks[i].usage << std::endl;
+        return 0;
+    }
+
+    bool found = selected.empty();
+    for( size_t i=0; i<c_numBenchmarks && !found; ++i )
+        found = selected == c_benchmarks[i].name;
+
+    if( !found )
+    {
+        std::cerr << "Unknown benchmark '" << selected << "'. Run 'Test_Benchmarks list'"
+                  << std::endl;
+        return 1;
+    }
+
+    Root *root = OGRE_NEW Root( "", "", "Benchmarks.log" );
+    LogManager::getSingleton().getDefaultLog()->setDebugOutputEnabled( false );
+
+#ifdef OGRE_STATIC_LIB
+    NULLPlugin *nullPlugin = OGRE_NEW NULLPlugin();
+    root->installPlugin( nullPlugin );
+#else
+    root->loadPlugin( "RenderSystem_NULL" OGRE_BUILD_SUFFIX );
+#endif
+
+    RenderSystem *renderSystem = root->getRenderSystemByName( "NULL Rendering Subsystem" );
+    if( !renderSystem )
+    {
+        std::cerr << "NULL render system not found" << std::endl;
+        OGRE_DELETE root;
+        return 1;
+    }
+
+    int retVal = 0;
+
+    try
+    {
+        root->setRenderSystem( renderSystem );
+        root->initialise( false );
+
+        BenchmarkContext context;
+        context.root    = root;
+        context.window  = root->createRenderWindow( "Benchmarks", 1024, 1024, false );
+        for( int i=2; i<argc; ++i )
+            context.args.push_back( argv[i] );
+
+        registerHlmsUnlit( root, OGRE_BENCHMARKS_MEDIA_DIR );
+        //The benchmarks create their Items without setting a material.
+        root->getHlmsManager()->useDefaultDatablockFrom( HLMS_UNLIT );
+
+        for( size_t i=0; i<c_numBenchmarks; ++i )
+        {
+            if( selected.empty() || selected == c_benchmarks[i].name )
+            {
+                std::cout << "== " << c_benchmarks[i].name << std::endl;
+                c_benchmarks[i].func( context );
+                context.window->removeAllViewports();
+            }
+        }
+    }
+    catch( Exception &e )
+    {
+        std::cerr << e.getFullDescription() << std::endl;
+        retVal = 1;
+    }
+
+    OGRE_DELETE root;
+#ifdef OGRE_STATIC_LIB
+    OGRE_DELETE nullPlugin;
+#endif
+
+    return retVal;
+}
@@ -0,0 +1,65 @@
+/*
+    Shared setup of Test_Benchmarks. Every benchmark is a function that gets an initialised
+    Root running on the NULL render system (so no GPU or window is needed) with HlmsUnlit
+    registered, times something and prints the results.
+
+    The benchmarks only measure. Whether the code they time is correct is checked by the
+    CppUnit suites in Tests/OgreMain.
+*/
+
+#ifndef _BenchmarkHarness_H_
+#define _BenchmarkHarness_H_
+
+#include "OgrePrerequisites.h"
+#include "OgreStringVector.h"
+
+namespace Benchmarks
+{
+    struct BenchmarkContext
+    {
+        Ogre::Root          *root;
+        /// 1024x1024. Benchmarks may add viewports; they're removed after each benchmark.
+        Ogre::RenderWindow  *window;
+        /// Arguments given after the benchmark's name in the command line.
+        Ogre::StringVector  args;
+
+        Ogre::VaoManager* getVaoManager(void) const;
+
+        /// Returns args[idx] as an unsigned integer, or defaultValue if it wasn't given.
+        size_t getArg( size_t idx, size_t defaultValue ) const;
+    };
+
+    typedef void (*BenchmarkFunc)( const BenchmarkContext &context );
+
+    /** Creates a cube centred at the origin with vertices at +/-1, positions only.
+    @param keepAsShadow
+        Keeps a CPU copy of the buffers, i.e. the mesh can be exported or read back.
+    */
+    Ogre::MeshPtr createCubeMesh( Ogre::VaoManager *vaoManager, const Ogre::String &name,
+                                  bool keepAsShadow=false );
+
+    /// Prints "phase: x ms per frame".
+    void reportPerFrame( const char *phase, size_t numFrames, unsigned long microseconds );
+
+    void runAsyncLogBenchmark( const BenchmarkContext &context );
+    void runBatchedLodBenchmark( const BenchmarkContext &context );
+    void runFrameArenaBenchmark( const BenchmarkContext &context );
+    void runGpuBillboardBenchmark( const BenchmarkContext &context );
+    void runHlmsSpawnBenchmark( const BenchmarkContext &context );
+    void runLightBinningBenchmark( const BenchmarkContext &context );
+    void runMeshCodecBenchmark( const BenchmarkContext &context );
+    void runMeshStreamingBenchmark( const BenchmarkContext &context );
+    void runMultiFrustumCullBenchmark( const BenchmarkContext &context );
+    void runOcclusionCullingBenchmark( const BenchmarkContext &context );
+    void runPipelinedUpdateBenchmark( const BenchmarkContext &context );
+#ifdef OGRE_BUILD_COMPONENT_SCENE_FORMAT
+    void runSceneStreamingBenchmark( const BenchmarkContext &context );
+#endif
+    void runShadowCasterCullBenchmark( const BenchmarkContext &context );
+    void runStaticBvhCullBenchmark( const BenchmarkContext &context );
+    void runStaticGeometryBenchmark( const BenchmarkContext &context );
+    void runVaoAllocatorBenchmark( const BenchmarkContext &context );
+    void runVertexConversionBenchmark( const BenchmarkContext &context );
+}
+
+#endif
@@ -0,0 +1,256 @@
+/*
+    Measures the per-frame scratch memory taken from SceneManager's FrameArenas
+    instead of the general heap.
+
+    First sorts many small per-object light lists (what buildLightList does every
+    frame) with std::stable_sort, which allocates a merge buffer on every call, and
+    with stableSortWithArena, counting the calls to operator new made by each.
+
+    Then updates a scene with many items and point lights (some of them moving)
+    for a number of frames, calling SceneManager::_frameEnded like the compositor
+    does, and reports the time and operator new calls per frame once warmed up.
+
+    operator new is replaced in this executable to count the calls; on platforms
+    where that doesn't reach into other DLLs the count only covers this module.
+    Arguments: [numLights] [numItems] [numFrames] [numThreads]
+*/
+
+#include "BenchmarkHarness.h"
+
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgreItem.h"
+#include "OgreLight.h"
+#include "OgreMesh2.h"
+#include "OgreMeshManager2.h"
+#include "OgreTimer.h"
+#include "OgreFrameArena.h"
+
+#include <iostream>
+#include <cstdlib>
+#include <new>
+
+#if __cplusplus >= 201103L
+    #define FRAME_ARENA_BENCHMARK_THROW_BAD_ALLOC
+    #define FRAME_ARENA_BENCHMARK_NOTHROW noexcept
+#else
+    #define FRAME_ARENA_BENCHMARK_THROW_BAD_ALLOC throw( std::bad_alloc )
+    #define FRAME_ARENA_BENCHMARK_NOTHROW throw()
+#endif
+
+namespace
+{
+    /// Not atomic; only meant to be read while a single thread is running.
+    volatile size_t g_numOperatorNew = 0;
+}
+
+void* operator new( std::size_t size ) FRAME_ARENA_BENCHMARK_THROW_BAD_ALLOC
+{
+    ++g_numOperatorNew;
+    void *retVal = malloc( size ? size : 1u );
+    if( !retVal )
+        throw std::bad_alloc();
+    return retVal;
+}
+void* operator new[]( std::size_t size ) FRAME_ARENA_BENCHMARK_THROW_BAD_ALLOC
+{
+    return operator new( size );
+}
+void* operator new( std::size_t size, const std::nothrow_t& ) FRAME_ARENA_BENCHMARK_NOTHROW
+{
+    ++g_numOperatorNew;
+    return malloc( size ? size : 1u );
+}
+void* operator new[]( std::size_t size, const std::nothrow_t &nt ) FRAME_ARENA_BENCHMARK_NOTHROW
+{
+    return operator new( size, nt );
+}
+void operator delete( void *ptr ) FRAME_ARENA_BENCHMARK_NOTHROW
+{
+    free( ptr );
+}
+void operator delete[]( void *ptr ) FRAME_ARENA_BENCHMARK_NOTHROW
+{
+    free( ptr );
+}
+void operator delete( void *ptr, const std::nothrow_t& ) FRAME_ARENA_BENCHMARK_NOTHROW
+{
+    free( ptr );
+}
+void operator delete[]( void *ptr, const std::nothrow_t& ) FRAME_ARENA_BENCHMARK_NOTHROW
+{
+    free( ptr );
+}
+#ifdef __cpp_sized_deallocation
+void operator delete( void *ptr, std::size_t ) FRAME_ARENA_BENCHMARK_NOTHROW
+{
+    free( ptr );
+}
+void operator delete[]( void *ptr, std::size_t ) FRAME_ARENA_BENCHMARK_NOTHROW
+{
+    free( ptr );
+}
+#endif
+
+using namespace Ogre;
+
+namespace
+{
+    const Real c_worldSize = 1000.0f;
+    const Real c_lightRadius = 40.0f;
+    //-------------------------------------------------------------------------
+    Vector3 randomPosition(void)
+    {
+        return Vector3( Math::RangeRandom( -c_worldSize, c_worldSize ) * 0.5f,
+                        Math::RangeRandom( 0.0f, 10.0f ),
+                        Math::RangeRandom( -c_worldSize, c_worldSize ) * 0.5f );
+    }
+    //-------------------------------------------------------------------------
+    /// Sorts numLists lists of lightsPerList LightClosest, like buildLightList does.
+    void benchmarkSort( size_t numLists, size_t lightsPerList, size_t iterations )
+    {
+        typedef vector<LightClosest>::type LightClosestVec;
+        LightClosestVec unsorted( numLists * lightsPerList );
+        for( size_t i=0; i<unsorted.size(); ++i )
+        {
+            unsorted[i] = LightClosest( 0, i % lightsPerList,
+                                        static_cast<Real>( rand() % 8 ) );
+        }
+
+        LightClosestVec sorted( unsorted );
+        FrameArena frameArena;
+
+        Timer timer;
+        size_t numNewBefore = g_numOperatorNew;
+        unsigned long stdUs = 0;
+        for( size_t it=0; it<iterations; ++it )
+        {
+            sorted = unsorted;
+            timer.reset();
+            for( size_t i=0; i<numLists; ++i )
+            {
+                std::stable_sort( sorted.begin() + i * lightsPerList,
+                                  sorted.begin() + (i + 1u) * lightsPerList );
+            }
+            stdUs += timer.getMicroseconds();
+        }
+        const size_t stdNew = g_numOperatorNew - numNewBefore;
+
+        numNewBefore = g_numOperatorNew;
+        unsigned long arenaUs = 0;
+        for( size_t it=0; it<iterations; ++it )
+        {
+            sorted = unsorted;
+            timer.reset();
+            for( size_t i=0; i<numLists; ++i )
+            {
+                stableSortWithArena( sorted.begin() + i * lightsPerList,
+                                     sorted.begin() + (i + 1u) * lightsPerList, frameArena );
+            }
+            arenaUs += timer.getMicroseconds();
+            frameArena.reset();
+        }
+        const size_t arenaNew = g_numOperatorNew - numNewBefore;
+
+        std::cout << numLists << " lists of " << lightsPerList << " lights, per iteration:"
+                  << std::endl;
+        std::cout << "  std::stable_sort:    " << stdUs / (double)iterations << "us, "
+                  << stdNew / iterations << " operator new" << std::endl;
+        std::cout << "  stableSortWithArena: " << arenaUs / (double)iterations << "us, "
+                  << arenaNew / iterations << " operator new" << std::endl;
+    }
+}
+
+namespace Benchmarks
+{
+    void runFrameArenaBenchmark( const BenchmarkContext &context )
+    {
+        const size_t numLights      = context.getArg( 0, 500u );
+        const size_t numItems       = context.getArg( 1, 20000u );
+        const size_t numFrames      = std::max<size_t>( context.getArg( 2, 60u ), 1u );
+        const size_t numThreads     = std::max<size_t>( context.getArg( 3, 1u ), 1u );
+
+        benchmarkSort( 10000u, 4u, 20u );
+        benchmarkSort( 1000u, 40u, 20u );
+
+        Root *root = context.root;
+        SceneManager *sceneManager = root->createSceneManager(
+                    ST_GENERIC, numThreads,
+                    numThreads > 1u ? INSTANCING_CULLING_THREADED : INSTANCING_CULLING_SINGLETHREAD );
+        MeshPtr mesh = createCubeMesh( context.getVaoManager(), "FrameArenaBenchmarkCube" );
+
+        SceneNode *rootNode = sceneManager->getRootSceneNode();
+
+        for( size_t i=0; i<numItems; ++i )
+        {
+            Item *item = sceneManager->createItem( mesh );
+            SceneNode *sceneNode = rootNode->createChildSceneNode();
+            sceneNode->setPosition( randomPosition() );
+            sceneNode->attachObject( item );
+        }
+
+        vector<SceneNode*>::type lightNodes;
+        lightNodes.reserve( numLights );
+        for( size_t i=0; i<numLights; ++i )
+        {
+            Light *light = sceneManager->createLight();
+            light->setType( Light::LT_POINT );
+            light->setAttenuation( c_lightRadius, 1.0f, 0.0f, 0.0f );
+            SceneNode *sceneNode = rootNode->createChildSceneNode();
+            sceneNode->setPosition( randomPosition() );
+            sceneNode->attachObject( light );
+            lightNodes.push_back( sceneNode );
+        }
+
+        const size_t numMovingLights = std::max<size_t>( numLights / 10u, 1u );
+        std::cout << numLights << " lights (" << numMovingLights << " moving), " << numItems
+                  << " items, " << numThreads << " thread(s)" << std::endl;
+
+        //Warm up: let the arenas (and every other per-frame container) reach their size.
+        for( size_t frame=0; frame<5u; ++frame )
+        {
+            sceneManager->updateSceneGraph();
+            sceneManager->_frameEnded();
+        }
+
+        const size_t arenaHeapAllocsBefore = sceneManager->getFrameArenaHeapAllocations();
+        size_t numOperatorNew = 0;
+
+        Timer timer;
+        unsigned long updateUs = 0;
+        for( size_t frame=0; frame<numFrames && numLights; ++frame )
+        {
+            //Only moves lights around within the area they already cover, so the
+            //working set stays the same.
+            for( size_t i=0; i<numMovingLights; ++i )
+            {
+                SceneNode *lightNode = lightNodes[(frame * numMovingLights + i) % numLights];
+                lightNode->setPosition( lightNode->getPosition() * -1.0f );
+            }
+
+            const size_t numNewBefore = g_numOperatorNew;
+            timer.reset();
+            sceneManager->updateSceneGraph();
+            sceneManager->_frameEnded();
+            updateUs += timer.getMicroseconds();
+            numOperatorNew += g_numOperatorNew - numNewBefore;
+        }
+
+        reportPerFrame( "updateSceneGraph + _frameEnded", numFrames, updateUs );
+        std::cout << "Frame arena heap allocations after warm up: "
+                  << sceneManager->getFrameArenaHeapAllocations() - arenaHeapAllocsBefore
+                  << " (" << sceneManager->getFrameArenaHeapAllocations() << " in total)"
+                  << std::endl;
+        std::cout << "Frame arena 0: " << sceneManager->_getFrameArena( 0 ).getCapacity()
+                  << " bytes, high water mark "
+                  << sceneManager->_getFrameArena( 0 ).getHighWaterMark() << " bytes" << std::endl;
+        if( numThreads <= 1u )
+        {
+            std::cout << "operator new per frame after warm up: "
+                      << numOperatorNew / (double)numFrames << std::endl;
+        }
+
+        root->destroySceneManager( sceneManager );
+        MeshManager::getSingleton().remove( mesh->getHandle() );
+    }
+}
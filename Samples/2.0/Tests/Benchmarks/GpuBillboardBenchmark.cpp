@@ -0,0 +1,241 @@
+/*
+    Measures the CPU side of GpuBillboardSet against what v1::BillboardSet does.
+
+    v1 expands every billboard into 4 vertices (position, colour, uv) rotated
+    along the camera axes on the CPU; GpuBillboardSet only packs one 32-byte
+    record and leaves the expansion to the vertex shader. Both are timed, along
+    with the depth keys used for back to front sorting (plain scalar loop vs
+    GpuBillboardSet::computeDepthKeys, which uses SSE2 when available) and the
+    sort itself (std::sort vs GpuBillboardSet::sortBackToFront).
+
+    Only uses the static functions; the Root isn't touched.
+    Arguments: [numBillboards] [iterations]
+*/
+
+#include "BenchmarkHarness.h"
+
+#include "OgreGpuBillboardSet.h"
+#include "OgreTimer.h"
+#include "OgreMath.h"
+#include "OgreVector2.h"
+#include "OgreVector4.h"
+
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+
+using namespace Ogre;
+
+namespace
+{
+    struct SourceBillboard
+    {
+        Vector3     position;
+        Vector2     size;
+        ColourValue colour;
+        Radian      rotation;
+        uint32      uvRectIdx;
+    };
+    typedef vector<SourceBillboard>::type SourceBillboardVec;
+
+    /// Same layout v1::BillboardSet writes: float3 position, RGBA8 colour, float2 uv.
+    struct V1Vertex
+    {
+        float   position[3];
+        uint32  colour;
+        float   uv[2];
+    };
+    typedef vector<V1Vertex>::type V1VertexVec;
+    typedef vector<uint64>::type Uint64Vec;
+
+    const size_t c_numUvRects = 16u;
+    //-------------------------------------------------------------------------
+    void generateBillboards( size_t numBillboards, SourceBillboardVec &outBillboards )
+    {
+        outBillboards.resize( numBillboards );
+        for( size_t i=0; i<numBillboards; ++i )
+        {
+            SourceBillboard &billboard = outBillboards[i];
+            billboard.position = Vector3( Math::RangeRandom( -500.0f, 500.0f ),
+                                          Math::RangeRandom( -50.0f, 50.0f ),
+                                          Math::RangeRandom( -500.0f, 500.0f ) );
+            billboard.size      = Vector2( Math::RangeRandom( 0.5f, 4.0f ),
+                                           Math::RangeRandom( 0.5f, 4.0f ) );
+            billboard.colour    = ColourValue( Math::UnitRandom(), Math::UnitRandom(),
+                                               Math::UnitRandom(), Math::UnitRandom() );
+            billboard.rotation  = Radian( Math::RangeRandom( -Math::PI, Math::PI ) );
+            billboard.uvRectIdx = static_cast<uint32>( i % c_numUvRects );
+        }
+    }
+    //-------------------------------------------------------------------------
+    void generateUvRects( Vector4 *outUvRects )
+    {
+        //4x4 atlas, like setTextureStacksAndSlices( 4, 4 )
+        for( size_t i=0; i<c_numUvRects; ++i )
+        {
+            const float u = (i % 4u) * 0.25f;
+            const float v = (i / 4u) * 0.25f;
+            outUvRects[i] = Vector4( u, v, u + 0.25f, v + 0.25f );
+        }
+    }
+    //-------------------------------------------------------------------------
+    /// What v1::BillboardSet::genVertOffsets + genVertices do per billboard
+    /// (point billboards, BBR_VERTEX rotation, own dimensions).
+    void expandV1Style( const SourceBillboardVec &billboards, const Vector4 *uvRects,
+                        const Vector3 &camRight, const Vector3 &camUp, V1Vertex *outVertices )
+    {
+        //Top left, top right, bottom left, bottom right.
+        const float c_cornerX[4] = { -1.0f, 1.0f, -1.0f, 1.0f };
+        const float c_cornerY[4] = {  1.0f, 1.0f, -1.0f, -1.0f };
+
+        SourceBillboardVec::const_iterator itor = billboards.begin();
+        SourceBillboardVec::const_iterator end  = billboards.end();
+
+        while( itor != end )
+        {
+            const Real cosRot = Math::Cos( itor->rotation );
+            const Real sinRot = Math::Sin( itor->rotation );
+            const Vector3 axisX = ( camRight * cosRot + camUp * sinRot) * (itor->size.x * 0.5f);
+            const Vector3 axisY = (-camRight * sinRot + camUp * cosRot) * (itor->size.y * 0.5f);
+            const uint32 colour = itor->colour.getAsABGR();
+            const Vector4 &uvRect = uvRects[itor->uvRectIdx];
+
+            for( size_t i=0; i<4u; ++i )
+            {
+                const Vector3 pos = itor->position + axisX * c_cornerX[i] + axisY * c_cornerY[i];
+                outVertices->position[0] = static_cast<float>( pos.x );
+                outVertices->position[1] = static_cast<float>( pos.y );
+                outVertices->position[2] = static_cast<float>( pos.z );
+                outVertices->colour = colour;
+                outVertices->uv[0] = static_cast<float>( c_cornerX[i] < 0 ? uvRect.x : uvRect.z );
+                outVertices->uv[1] = static_cast<float>( c_cornerY[i] > 0 ? uvRect.y : uvRect.w );
+                ++outVertices;
+            }
+
+            ++itor;
+        }
+    }
+    //-------------------------------------------------------------------------
+    void packRecords( const SourceBillboardVec &billboards, GpuBillboardSet::Record *outRecords )
+    {
+        SourceBillboardVec::const_iterator itor = billboards.begin();
+        SourceBillboardVec::const_iterator end  = billboards.end();
+
+        while( itor != end )
+        {
+            GpuBillboardSet::packRecord( *outRecords++, itor->position, itor->size * 0.5f,
+                                         itor->colour, itor->rotation, itor->uvRectIdx );
+            ++itor;
+        }
+    }
+    //-------------------------------------------------------------------------
+    /// Plain loop version of GpuBillboardSet::computeDepthKeys.
+    void computeDepthKeysScalar( const GpuBillboardSet::Record *records, size_t numRecords,
+                                 const Vector3 &viewDir, uint64 *outKeys )
+    {
+        const float dirX = static_cast<float>( viewDir.x );
+        const float dirY = static_cast<float>( viewDir.y );
+        const float dirZ = static_cast<float>( viewDir.z );
+
+        for( size_t i=0; i<numRecords; ++i )
+        {
+            const float *pos = records[i].position;
+            const float depth = pos[0] * dirX + pos[1] * dirY + pos[2] * dirZ;
+
+            uint32 bits;
+            memcpy( &bits, &depth, sizeof( bits ) );
+            bits = (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+            outKeys[i] = (static_cast<uint64>( ~bits ) << 32u) | i;
+        }
+    }
+}
+
+namespace Benchmarks
+{
+    void runGpuBillboardBenchmark( const BenchmarkContext &context )
+    {
+        const size_t numBillboards  = std::max<size_t>( context.getArg( 0, 100000u ), 1u );
+        const size_t iterations     = std::max<size_t>( context.getArg( 1, 20u ), 1u );
+
+        SourceBillboardVec billboards;
+        generateBillboards( numBillboards, billboards );
+
+        Vector4 uvRects[c_numUvRects];
+        generateUvRects( uvRects );
+
+        Quaternion camOrientation( Degree( 30 ), Vector3( 0.3f, 1.0f, 0.2f ).normalisedCopy() );
+        const Vector3 camRight  = camOrientation * Vector3::UNIT_X;
+        const Vector3 camUp     = camOrientation * Vector3::UNIT_Y;
+        const Vector3 viewDir   = camOrientation * Vector3::NEGATIVE_UNIT_Z;
+
+        std::cout << numBillboards << " billboards, " << iterations << " iterations" << std::endl;
+
+        V1VertexVec v1Vertices( numBillboards * 4u );
+        GpuBillboardSet::RecordArray records;
+        records.resize( numBillboards );
+
+        Timer timer;
+
+        //CPU expansion (v1) vs record packing
+        timer.reset();
+        for( size_t i=0; i<iterations; ++i )
+            expandV1Style( billboards, uvRects, camRight, camUp, &v1Vertices[0] );
+        const unsigned long v1Us = timer.getMicroseconds();
+
+        timer.reset();
+        for( size_t i=0; i<iterations; ++i )
+            packRecords( billboards, records.begin() );
+        const unsigned long packUs = timer.getMicroseconds();
+
+        std::cout << "v1 4-vertex expansion: " << v1Us / iterations << " us/frame, "
+                  << sizeof(V1Vertex) * 4u << " bytes/billboard" << std::endl;
+        std::cout << "Record packing:        " << packUs / iterations << " us/frame, "
+                  << sizeof(GpuBillboardSet::Record) << " bytes/billboard" << std::endl;
+
+        //Depth keys
+        Uint64Vec keys( numBillboards );
+        Uint64Vec depthKeys( numBillboards );
+
+        timer.reset();
+        for( size_t i=0; i<iterations; ++i )
+            computeDepthKeysScalar( records.begin(), numBillboards, viewDir, &keys[0] );
+        const unsigned long scalarUs = timer.getMicroseconds();
+
+        timer.reset();
+        for( size_t i=0; i<iterations; ++i )
+        {
+            GpuBillboardSet::computeDepthKeys( records.begin(), numBillboards,
+                                               viewDir, &depthKeys[0] );
+        }
+        const unsigned long simdUs = timer.getMicroseconds();
+
+        std::cout << "Depth keys, scalar:           " << scalarUs / iterations << " us/frame"
+                  << std::endl;
+        std::cout << "Depth keys, computeDepthKeys: " << simdUs / iterations << " us/frame"
+                  << std::endl;
+
+        //Sorting
+        Uint64Vec scratch( numBillboards );
+
+        timer.reset();
+        for( size_t i=0; i<iterations; ++i )
+        {
+            keys = depthKeys;
+            std::sort( keys.begin(), keys.end() );
+        }
+        const unsigned long stdSortUs = timer.getMicroseconds();
+
+        timer.reset();
+        for( size_t i=0; i<iterations; ++i )
+        {
+            keys = depthKeys;
+            GpuBillboardSet::sortBackToFront( &keys[0], &scratch[0], numBillboards );
+        }
+        const unsigned long radixUs = timer.getMicroseconds();
+
+        std::cout << "Sort, std::sort:        " << stdSortUs / iterations << " us/frame"
+                  << std::endl;
+        std::cout << "Sort, sortBackToFront:  " << radixUs / iterations << " us/frame"
+                  << std::endl;
+    }
+}
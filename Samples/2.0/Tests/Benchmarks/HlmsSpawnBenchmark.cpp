@@ -0,0 +1,110 @@
+/*
+    Measures how many Items per second can be created, have their datablock changed, and be
+    destroyed. Item creation is dominated by Hlms::calculateHashFor (called by setDatablock)
+    and the HlmsManager block lookups, so this is mostly a benchmark of those.
+
+    Arguments: [numItems] [numDatablocks]
+*/
+
+#include "BenchmarkHarness.h"
+
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgreItem.h"
+#include "OgreMesh2.h"
+#include "OgreMeshManager2.h"
+#include "OgreHlms.h"
+#include "OgreHlmsManager.h"
+#include "OgreHlmsUnlitDatablock.h"
+#include "OgreTimer.h"
+#include "OgreStringConverter.h"
+
+#include <iostream>
+
+using namespace Ogre;
+
+namespace
+{
+    void report( const char *phase, size_t count, unsigned long microseconds )
+    {
+        const double seconds = std::max( microseconds, 1ul ) / 1000000.0;
+        std::cout << phase << ": " << count << " in " << seconds * 1000.0 << " ms ("
+                  << static_cast<size_t>( count / seconds ) << " per second)" << std::endl;
+    }
+}
+
+namespace Benchmarks
+{
+    void runHlmsSpawnBenchmark( const BenchmarkContext &context )
+    {
+        const size_t numItems       = context.getArg( 0, 100000u );
+        const size_t numDatablocks  = std::max<size_t>( context.getArg( 1, 16u ), 1u );
+
+        Root *root = context.root;
+        SceneManager *sceneManager = root->createSceneManager( ST_GENERIC, 1,
+                                                               INSTANCING_CULLING_SINGLETHREAD );
+        MeshPtr mesh = createCubeMesh( context.getVaoManager(), "HlmsSpawnBenchmarkCube" );
+
+        Hlms *hlmsUnlit = root->getHlmsManager()->getHlms( HLMS_UNLIT );
+
+        Timer timer;
+
+        //Datablocks with a few distinct macro/blendblock combinations,
+        //which stresses the HlmsManager block lookups.
+        vector<HlmsDatablock*>::type datablocks;
+        datablocks.reserve( numDatablocks );
+        timer.reset();
+        for( size_t i=0; i<numDatablocks; ++i )
+        {
+            HlmsMacroblock macroblock;
+            macroblock.mCullMode = static_cast<CullingMode>( CULL_NONE + (i % 3u) );
+            macroblock.mDepthBiasConstant = static_cast<float>( i % 5u );
+            HlmsBlendblock blendblock;
+            if( i & 0x01 )
+                blendblock.setBlendType( SBT_TRANSPARENT_ALPHA );
+
+            const String name = "HlmsSpawnBenchmark/" + StringConverter::toString( i );
+            HlmsDatablock *datablock = hlmsUnlit->createDatablock( name, name, macroblock,
+                                                                   blendblock, HlmsParamVec() );
+            static_cast<HlmsUnlitDatablock*>( datablock )->setUseColour( (i & 0x02) != 0 );
+            datablocks.push_back( datablock );
+        }
+        report( "Datablocks created", numDatablocks, timer.getMicroseconds() );
+
+        vector<Item*>::type items;
+        items.reserve( numItems );
+
+        timer.reset();
+        for( size_t i=0; i<numItems; ++i )
+        {
+            Item *item = sceneManager->createItem( mesh, SCENE_DYNAMIC );
+            item->setDatablock( datablocks[i % numDatablocks] );
+            items.push_back( item );
+        }
+        report( "Items spawned", numItems, timer.getMicroseconds() );
+
+        timer.reset();
+        for( size_t i=0; i<numItems; ++i )
+            items[i]->setDatablock( datablocks[(i + 1u) % numDatablocks] );
+        report( "Datablocks reassigned", numItems, timer.getMicroseconds() );
+
+        //Changing a setting that affects the shader of a datablock used by many Items
+        timer.reset();
+        static_cast<HlmsUnlitDatablock*>( datablocks[0] )->setUseColour(
+                    !static_cast<HlmsUnlitDatablock*>( datablocks[0] )->hasColour() );
+        report( "Linked renderables flushed",
+                datablocks[0]->getLinkedRenderables().size(), timer.getMicroseconds() );
+
+        timer.reset();
+        for( size_t i=0; i<numItems; ++i )
+            sceneManager->destroyItem( items[i] );
+        report( "Items destroyed", numItems, timer.getMicroseconds() );
+        items.clear();
+
+        for( size_t i=0; i<numDatablocks; ++i )
+            hlmsUnlit->destroyDatablock( datablocks[i]->getName() );
+
+        root->destroySceneManager( sceneManager );
+        MeshManager::getSingleton().remove( mesh->getHandle() );
+    }
+}
@@ -0,0 +1,184 @@
+/*
+    Measures SceneManager::setLightBinning with thousands of point lights spread
+    over a large scene, most of them standing still and a few moving every frame.
+
+    Compares building the per-object light lists by testing every light against
+    every object (MovableObject::buildLightList) against the binned version, reports
+    how many lists were reused vs rebuilt, and times SceneManager::cullLights with
+    and without binning.
+
+    Arguments: [numLights] [numItems] [numFrames] [numThreads]
+*/
+
+#include "BenchmarkHarness.h"
+
+#include "OgreRoot.h"
+#include "OgreRenderWindow.h"
+#include "OgreViewport.h"
+#include "OgreCamera.h"
+#include "OgreSceneManager.h"
+#include "OgreItem.h"
+#include "OgreLight.h"
+#include "OgreMesh2.h"
+#include "OgreMeshManager2.h"
+#include "OgreTimer.h"
+#include "OgreLightBinGrid.h"
+#include "OgreFrameArena.h"
+#include "Math/Array/OgreObjectMemoryManager.h"
+
+#include <iostream>
+
+using namespace Ogre;
+
+namespace
+{
+    const Real c_worldSize = 2000.0f;
+    const Real c_lightRadius = 20.0f;
+    //-------------------------------------------------------------------------
+    Vector3 randomPosition(void)
+    {
+        return Vector3( Math::RangeRandom( -c_worldSize, c_worldSize ) * 0.5f,
+                        Math::RangeRandom( 0.0f, 10.0f ),
+                        Math::RangeRandom( -c_worldSize, c_worldSize ) * 0.5f );
+    }
+}
+
+namespace Benchmarks
+{
+    void runLightBinningBenchmark( const BenchmarkContext &context )
+    {
+        const size_t numLights      = std::max<size_t>( context.getArg( 0, 2000u ), 1u );
+        const size_t numItems       = context.getArg( 1, 50000u );
+        const size_t numFrames      = context.getArg( 2, 60u );
+        const size_t numThreads     = std::max<size_t>( context.getArg( 3, 1u ), 1u );
+
+        Root *root = context.root;
+        SceneManager *sceneManager = root->createSceneManager(
+                    ST_GENERIC, numThreads,
+                    numThreads > 1u ? INSTANCING_CULLING_THREADED : INSTANCING_CULLING_SINGLETHREAD );
+        MeshPtr mesh = createCubeMesh( context.getVaoManager(), "LightBinningBenchmarkCube" );
+
+        SceneNode *rootNode = sceneManager->getRootSceneNode();
+
+        for( size_t i=0; i<numItems; ++i )
+        {
+            Item *item = sceneManager->createItem( mesh );
+            SceneNode *sceneNode = rootNode->createChildSceneNode();
+            sceneNode->setPosition( randomPosition() );
+            sceneNode->attachObject( item );
+        }
+
+        vector<SceneNode*>::type lightNodes;
+        lightNodes.reserve( numLights );
+        for( size_t i=0; i<numLights; ++i )
+        {
+            Light *light = sceneManager->createLight();
+            light->setType( Light::LT_POINT );
+            light->setAttenuation( c_lightRadius, 1.0f, 0.0f, 0.0f );
+            SceneNode *sceneNode = rootNode->createChildSceneNode();
+            sceneNode->setPosition( randomPosition() );
+            sceneNode->attachObject( light );
+            lightNodes.push_back( sceneNode );
+        }
+
+        //Looking down at a quarter of the scene
+        Camera *camera = sceneManager->createCamera( "TopCamera" );
+        camera->setPosition( c_worldSize * 0.25f, c_worldSize * 0.5f, c_worldSize * 0.25f );
+        camera->lookAt( c_worldSize * 0.25f, 0, c_worldSize * 0.25f + 1.0f );
+        camera->setNearClipDistance( 0.5f );
+        camera->setFarClipDistance( c_worldSize );
+        camera->setAutoAspectRatio( true );
+
+        Viewport *viewport = context.window->addViewport();
+        camera->_notifyViewport( viewport );
+
+        const size_t numMovingLights = std::max<size_t>( numLights / 100u, 1u );
+        std::cout << numLights << " lights (" << numMovingLights << " moving), " << numItems
+                  << " items, " << numThreads << " thread(s)" << std::endl;
+
+        Timer timer;
+        LightArray culledLights;
+
+        //No binning. Per object lists aren't built by the SceneManager,
+        //so do it by hand to know how much it would cost.
+        ObjectMemoryManager &dynamicMemoryManager =
+                sceneManager->_getEntityMemoryManager( SCENE_DYNAMIC );
+        unsigned long updateUs = 0;
+        unsigned long bruteForceUs = 0;
+        unsigned long cullLightsUs = 0;
+        size_t numCulledLightsFullSweep = 0;
+        for( size_t frame=0; frame<numFrames; ++frame )
+        {
+            for( size_t i=0; i<numMovingLights; ++i )
+                lightNodes[(frame * numMovingLights + i) % numLights]->setPosition( randomPosition() );
+
+            timer.reset();
+            sceneManager->updateSceneGraph();
+            updateUs += timer.getMicroseconds();
+
+            timer.reset();
+            const size_t numRenderQueues = dynamicMemoryManager.getNumRenderQueues();
+            for( size_t i=0; i<numRenderQueues; ++i )
+            {
+                ObjectData objData;
+                const size_t numObjs = dynamicMemoryManager.getFirstObjectData( objData, i );
+                MovableObject::buildLightList( numObjs, objData, sceneManager->getGlobalLightList(),
+                                               sceneManager->_getFrameArena( 0 ) );
+            }
+            bruteForceUs += timer.getMicroseconds();
+
+            timer.reset();
+            sceneManager->cullLights( camera, Light::LT_POINT, Light::NUM_LIGHT_TYPES, culledLights );
+            cullLightsUs += timer.getMicroseconds();
+            numCulledLightsFullSweep += culledLights.size();
+        }
+        reportPerFrame( "updateSceneGraph", numFrames, updateUs );
+        reportPerFrame( "Light lists, every light vs every object", numFrames, bruteForceUs );
+        reportPerFrame( "cullLights, all lights", numFrames, cullLightsUs );
+
+        //Binning
+        sceneManager->setLightBinning( true, c_lightRadius * 2.0f );
+        LightBinGrid *lightBinGrid = sceneManager->getLightBinGrid();
+        sceneManager->updateSceneGraph();
+
+        updateUs = 0;
+        cullLightsUs = 0;
+        size_t numReused = 0;
+        size_t numRebuilt = 0;
+        size_t numCulledLightsBinned = 0;
+        for( size_t frame=0; frame<numFrames; ++frame )
+        {
+            for( size_t i=0; i<numMovingLights; ++i )
+                lightNodes[(frame * numMovingLights + i) % numLights]->setPosition( randomPosition() );
+
+            timer.reset();
+            sceneManager->updateSceneGraph();
+            updateUs += timer.getMicroseconds();
+
+            numReused   += lightBinGrid->getStats().numReusedLists;
+            numRebuilt  += lightBinGrid->getStats().numRebuiltLists;
+
+            timer.reset();
+            sceneManager->cullLights( camera, Light::LT_POINT, Light::NUM_LIGHT_TYPES, culledLights );
+            cullLightsUs += timer.getMicroseconds();
+            numCulledLightsBinned += culledLights.size();
+        }
+        reportPerFrame( "updateSceneGraph incl. binned light lists", numFrames, updateUs );
+        reportPerFrame( "cullLights, binned", numFrames, cullLightsUs );
+
+        std::cout << "Light lists reused: " << numReused << ", rebuilt: " << numRebuilt
+                  << " (" << 100.0 * numReused / (double)std::max<size_t>( numReused + numRebuilt, 1u )
+                  << "% reused)" << std::endl;
+        std::cout << "Cells: " << lightBinGrid->getNumCells() << ", "
+                  << lightBinGrid->getStats().numUsedCells << " with lights" << std::endl;
+        std::cout << "Lights in camera per frame: "
+                  << numCulledLightsFullSweep / std::max<size_t>( numFrames, 1u ) << " (all lights), "
+                  << numCulledLightsBinned / std::max<size_t>( numFrames, 1u ) << " (binned)"
+                  << std::endl;
+
+        sceneManager->setLightBinning( false );
+
+        root->destroySceneManager( sceneManager );
+        MeshManager::getSingleton().remove( mesh->getHandle() );
+    }
+}
@@ -0,0 +1,324 @@
+/*
+    Measures MeshBufferCodec, used by the compressed v2 mesh format: the
+    compression ratio and decode throughput of a generated terrain-like grid
+    (position, normal & UV in 32-bit floats, and the same grid in the 16-bit
+    layout OgreMeshTool -O puq produces) and its 16 & 32-bit index buffers.
+    Decoding is compared against a plain memcpy of the decoded size.
+
+    Then exports the grid through MeshSerializer with and without
+    setCompressBuffers and compares the file sizes and MeshManager::load times.
+
+    The .mesh files are written to (and removed from) the working directory.
+    Arguments: [gridSize] [iterations]
+*/
+
+#include "BenchmarkHarness.h"
+
+#include "OgreTimer.h"
+#include "OgreBitwise.h"
+#include "OgreMeshBufferCodec.h"
+#include "OgreResourceGroupManager.h"
+
+#include "OgreMesh2.h"
+#include "OgreMeshManager2.h"
+#include "OgreSubMesh2.h"
+#include "OgreMesh2Serializer.h"
+
+#include "Vao/OgreVaoManager.h"
+#include "Vao/OgreVertexArrayObject.h"
+
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+
+using namespace Ogre;
+
+namespace
+{
+    const char *c_groupName = "MeshCodecBenchmark";
+    const char *c_rawMeshName           = "MeshCodecBenchmark_Raw.mesh";
+    const char *c_compressedMeshName    = "MeshCodecBenchmark_Compressed.mesh";
+
+    typedef vector<uint8>::type ByteVec;
+    //-------------------------------------------------------------------------
+    float getHeight( int x, int z )
+    {
+        return Math::Sin( x * 0.05f ) * Math::Cos( z * 0.07f ) * 4.0f;
+    }
+    //-------------------------------------------------------------------------
+    /// float3 position, float3 normal, float2 uv. 32 bytes per vertex.
+    void generateFloatVertices( size_t gridSize, ByteVec &outData )
+    {
+        outData.resize( gridSize * gridSize * sizeof(float) * 8u );
+        float *dst = reinterpret_cast<float*>( &outData[0] );
+
+        for( int z=0; z<static_cast<int>( gridSize ); ++z )
+        {
+            for( int x=0; x<static_cast<int>( gridSize ); ++x )
+            {
+                const float h = getHeight( x, z );
+                Vector3 normal( getHeight( x - 1, z ) - getHeight( x + 1, z ), 2.0f,
+                                getHeight( x, z - 1 ) - getHeight( x, z + 1 ) );
+                normal.normalise();
+
+                *dst++ = x * 0.5f;
+                *dst++ = h;
+                *dst++ = z * 0.5f;
+                *dst++ = static_cast<float>( normal.x );
+                *dst++ = static_cast<float>( normal.y );
+                *dst++ = static_cast<float>( normal.z );
+                *dst++ = x / float( gridSize - 1u );
+                *dst++ = z / float( gridSize - 1u );
+            }
+        }
+    }
+    //-------------------------------------------------------------------------
+    /// half4 position, short4 QTangent-like, half2 uv. 20 bytes per vertex.
+    void generateHalfVertices( const ByteVec &floatData, size_t numVertices, ByteVec &outData )
+    {
+        outData.resize( numVertices * 20u );
+        const float *src = reinterpret_cast<const float*>( &floatData[0] );
+        uint16 *dst = reinterpret_cast<uint16*>( &outData[0] );
+
+        for( size_t i=0; i<numVertices; ++i )
+        {
+            *dst++ = Bitwise::floatToHalf( src[0] );
+            *dst++ = Bitwise::floatToHalf( src[1] );
+            *dst++ = Bitwise::floatToHalf( src[2] );
+            *dst++ = Bitwise::floatToHalf( 1.0f );
+            for( size_t j=0; j<3u; ++j )
+                *dst++ = static_cast<uint16>( static_cast<int16>( src[3u + j] * 32767.0f ) );
+            *dst++ = 32767u;
+            *dst++ = Bitwise::floatToHalf( src[6] );
+            *dst++ = Bitwise::floatToHalf( src[7] );
+            src += 8u;
+        }
+    }
+    //-------------------------------------------------------------------------
+    size_t getNumGridIndices( size_t gridSize )
+    {
+        return (gridSize - 1u) * (gridSize - 1u) * 6u;
+    }
+    //-------------------------------------------------------------------------
+    template <typename T>
+    void generateIndices( size_t gridSize, ByteVec &outData )
+    {
+        outData.resize( getNumGridIndices( gridSize ) * sizeof(T) );
+        T *dst = reinterpret_cast<T*>( &outData[0] );
+
+        for( size_t z=0; z<gridSize - 1u; ++z )
+        {
+            for( size_t x=0; x<gridSize - 1u; ++x )
+            {
+                const T v = static_cast<T>( z * gridSize + x );
+                *dst++ = v;
+                *dst++ = static_cast<T>( v + gridSize );
+                *dst++ = static_cast<T>( v + 1u );
+                *dst++ = static_cast<T>( v + 1u );
+                *dst++ = static_cast<T>( v + gridSize );
+                *dst++ = static_cast<T>( v + gridSize + 1u );
+            }
+        }
+    }
+    //-------------------------------------------------------------------------
+    void printResult( const char *name, size_t rawBytes, size_t encodedBytes,
+                      unsigned long encodeUs, unsigned long decodeUs, unsigned long memcpyUs,
+                      size_t iterations )
+    {
+        const double totalBytes = double( rawBytes ) * iterations;
+        std::cout << name << ": " << rawBytes << " -> " << encodedBytes << " bytes ("
+                  << double( rawBytes ) / double( std::max<size_t>( encodedBytes, 1u ) ) << "x). "
+                  << "Encode " << totalBytes / (std::max( encodeUs, 1ul ) * 1000.0) << " GB/s, "
+                  << "decode " << totalBytes / (std::max( decodeUs, 1ul ) * 1000.0) << " GB/s, "
+                  << "memcpy " << totalBytes / (std::max( memcpyUs, 1ul ) * 1000.0) << " GB/s"
+                  << std::endl;
+    }
+    //-------------------------------------------------------------------------
+    void benchmarkVertices( const char *name, const ByteVec &rawData, size_t bytesPerVertex,
+                            size_t iterations )
+    {
+        const size_t numVertices = rawData.size() / bytesPerVertex;
+
+        ByteVec encoded( MeshBufferCodec::getVertexBufferBound( numVertices, bytesPerVertex ) );
+        ByteVec decoded( rawData.size() );
+
+        Timer timer;
+        size_t encodedBytes = 0;
+        for( size_t i=0; i<iterations; ++i )
+        {
+            encodedBytes = MeshBufferCodec::encodeVertexBuffer( &encoded[0], encoded.size(),
+                                                                &rawData[0], numVertices,
+                                                                bytesPerVertex );
+        }
+        const unsigned long encodeUs = timer.getMicroseconds();
+
+        timer.reset();
+        for( size_t i=0; i<iterations; ++i )
+        {
+            MeshBufferCodec::decodeVertexBuffer( &decoded[0], numVertices, bytesPerVertex,
+                                                 &encoded[0], encodedBytes );
+        }
+        const unsigned long decodeUs = timer.getMicroseconds();
+
+        ByteVec copy( rawData.size() );
+        timer.reset();
+        for( size_t i=0; i<iterations; ++i )
+        {
+            memcpy( &copy[0], &rawData[0], rawData.size() );
+            //Keep the compiler from folding the copies.
+            copy[i % copy.size()] ^= 1u;
+        }
+        const unsigned long memcpyUs = timer.getMicroseconds();
+
+        printResult( name, rawData.size(), encodedBytes, encodeUs, decodeUs, memcpyUs, iterations );
+    }
+    //-------------------------------------------------------------------------
+    void benchmarkIndices( const char *name, const ByteVec &rawData, bool index32Bit,
+                           size_t iterations )
+    {
+        const size_t numIndices = rawData.size() / (index32Bit ? 4u : 2u);
+
+        ByteVec encoded( MeshBufferCodec::getIndexBufferBound( numIndices ) );
+        ByteVec decoded( rawData.size() );
+
+        Timer timer;
+        size_t encodedBytes = 0;
+        for( size_t i=0; i<iterations; ++i )
+        {
+            encodedBytes = MeshBufferCodec::encodeIndexBuffer( &encoded[0], encoded.size(),
+                                                               &rawData[0], numIndices, index32Bit );
+        }
+        const unsigned long encodeUs = timer.getMicroseconds();
+
+        timer.reset();
+        for( size_t i=0; i<iterations; ++i )
+        {
+            MeshBufferCodec::decodeIndexBuffer( &decoded[0], numIndices, index32Bit,
+                                                &encoded[0], encodedBytes );
+        }
+        const unsigned long decodeUs = timer.getMicroseconds();
+
+        ByteVec copy( rawData.size() );
+        timer.reset();
+        for( size_t i=0; i<iterations; ++i )
+        {
+            memcpy( &copy[0], &rawData[0], rawData.size() );
+            copy[i % copy.size()] ^= 1u;
+        }
+        const unsigned long memcpyUs = timer.getMicroseconds();
+
+        printResult( name, rawData.size(), encodedBytes, encodeUs, decodeUs, memcpyUs, iterations );
+    }
+    //-------------------------------------------------------------------------
+    void exportMeshes( VaoManager *vaoManager, size_t gridSize, const ByteVec &vertexData,
+                       const ByteVec &indexData )
+    {
+        MeshPtr mesh = MeshManager::getSingleton().createManual(
+                    "MeshCodecBenchmarkSource", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME );
+        SubMesh *subMesh = mesh->createSubMesh();
+        subMesh->setMaterialName( "BaseWhite" );
+
+        VertexElement2Vec vertexElements;
+        vertexElements.push_back( VertexElement2( VET_FLOAT3, VES_POSITION ) );
+        vertexElements.push_back( VertexElement2( VET_FLOAT3, VES_NORMAL ) );
+        vertexElements.push_back( VertexElement2( VET_FLOAT2, VES_TEXTURE_COORDINATES ) );
+
+        const size_t numVertices = gridSize * gridSize;
+        void *vertices = OGRE_MALLOC_SIMD( vertexData.size(), MEMCATEGORY_GEOMETRY );
+        memcpy( vertices, &vertexData[0], vertexData.size() );
+        void *indices = OGRE_MALLOC_SIMD( indexData.size(), MEMCATEGORY_GEOMETRY );
+        memcpy( indices, &indexData[0], indexData.size() );
+
+        VertexBufferPackedVec vertexBuffers;
+        vertexBuffers.push_back( vaoManager->createVertexBuffer( vertexElements, numVertices,
+                                                                 BT_IMMUTABLE, vertices, true ) );
+        IndexBufferPacked *indexBuffer = vaoManager->createIndexBuffer(
+                                             IndexBufferPacked::IT_32BIT,
+                                             getNumGridIndices( gridSize ), BT_IMMUTABLE,
+                                             indices, true );
+        VertexArrayObject *vao = vaoManager->createVertexArrayObject( vertexBuffers, indexBuffer,
+                                                                      OT_TRIANGLE_LIST );
+        subMesh->mVao[VpNormal].push_back( vao );
+        subMesh->mVao[VpShadow].push_back( vao );
+
+        const Real halfSize = (gridSize - 1u) * 0.25f;
+        mesh->_setBounds( Aabb( Vector3( halfSize, 0, halfSize ), Vector3( halfSize, 4, halfSize ) ),
+                          false );
+        mesh->_setBoundingSphereRadius( halfSize * 1.5f );
+
+        MeshSerializer meshSerializer( vaoManager );
+        meshSerializer.exportMesh( mesh.get(), c_rawMeshName );
+        meshSerializer.setCompressBuffers( true );
+        meshSerializer.exportMesh( mesh.get(), c_compressedMeshName );
+
+        MeshManager::getSingleton().remove( mesh );
+    }
+    //-------------------------------------------------------------------------
+    size_t getFileSize( const char *filename )
+    {
+        std::ifstream file( filename, std::ios::binary | std::ios::ate );
+        return file.is_open() ? static_cast<size_t>( file.tellg() ) : 0u;
+    }
+    //-------------------------------------------------------------------------
+    unsigned long timeLoad( const char *filename )
+    {
+        Timer timer;
+        MeshPtr mesh = MeshManager::getSingleton().load( filename, c_groupName );
+        const unsigned long loadUs = timer.getMicroseconds();
+
+        mesh.setNull();
+        MeshManager::getSingleton().remove( filename );
+        return loadUs;
+    }
+}
+
+namespace Benchmarks
+{
+    void runMeshCodecBenchmark( const BenchmarkContext &context )
+    {
+        const size_t gridSize   = std::max<size_t>( context.getArg( 0, 512u ), 2u );
+        const size_t iterations = std::max<size_t>( context.getArg( 1, 20u ), 1u );
+
+        {
+            ByteVec floatVertices, halfVertices, indices32, indices16;
+            generateFloatVertices( gridSize, floatVertices );
+            generateHalfVertices( floatVertices, gridSize * gridSize, halfVertices );
+            generateIndices<uint32>( gridSize, indices32 );
+
+            std::cout << gridSize << "x" << gridSize << " grid, " << iterations << " iterations"
+                      << std::endl;
+            benchmarkVertices( "float3 pos, float3 normal, float2 uv", floatVertices, 32u,
+                               iterations );
+            benchmarkVertices( "half4 pos, short4 qtangent, half2 uv", halfVertices, 20u,
+                               iterations );
+            benchmarkIndices( "32-bit indices", indices32, true, iterations );
+
+            //16-bit meshes are limited to 65535 vertices.
+            const size_t gridSize16 = std::min<size_t>( gridSize, 255u );
+            generateIndices<uint16>( gridSize16, indices16 );
+            benchmarkIndices( "16-bit indices", indices16, false, iterations );
+        }
+
+        const size_t meshGridSize = std::min<size_t>( gridSize, 256u );
+        ByteVec vertexData, indexData;
+        generateFloatVertices( meshGridSize, vertexData );
+        generateIndices<uint32>( meshGridSize, indexData );
+        exportMeshes( context.getVaoManager(), meshGridSize, vertexData, indexData );
+
+        std::cout << "Exported .mesh: " << getFileSize( c_rawMeshName ) << " bytes raw, "
+                  << getFileSize( c_compressedMeshName ) << " bytes compressed" << std::endl;
+
+        ResourceGroupManager &resourceGroupManager = ResourceGroupManager::getSingleton();
+        resourceGroupManager.addResourceLocation( ".", "FileSystem", c_groupName );
+        resourceGroupManager.initialiseResourceGroup( c_groupName, true );
+
+        const unsigned long rawLoadUs = timeLoad( c_rawMeshName );
+        const unsigned long compressedLoadUs = timeLoad( c_compressedMeshName );
+        std::cout << "MeshManager::load: " << rawLoadUs << "us raw, " << compressedLoadUs
+                  << "us compressed" << std::endl;
+
+        resourceGroupManager.destroyResourceGroup( c_groupName );
+        std::remove( c_rawMeshName );
+        std::remove( c_compressedMeshName );
+    }
+}
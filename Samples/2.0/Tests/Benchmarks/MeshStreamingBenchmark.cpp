@@ -0,0 +1,214 @@
+/*
+    Streams a set of generated v2 meshes from disk and compares how much of the
+    load is spent on the main thread: MeshManager::load (everything on the main
+    thread), Mesh::prepare + Mesh::load (what runs in the background vs. the
+    GPU buffer creation that's left for the main thread), and
+    MeshManager::loadAsync processed through the WorkQueue.
+
+    Without OGRE_THREAD_SUPPORT loadAsync runs synchronously, so it measures the
+    same as prepare + load. The .mesh files are written to (and removed from)
+    the working directory.
+    Arguments: [numMeshes] [numVertices]
+*/
+
+#include "BenchmarkHarness.h"
+
+#include "OgreRoot.h"
+#include "OgreTimer.h"
+#include "OgreStringConverter.h"
+#include "OgreWorkQueue.h"
+#include "OgreResourceGroupManager.h"
+
+#include "OgreMesh2.h"
+#include "OgreMeshManager2.h"
+#include "OgreSubMesh2.h"
+#include "OgreMesh2Serializer.h"
+
+#include "Vao/OgreVaoManager.h"
+#include "Vao/OgreVertexArrayObject.h"
+
+#include <iostream>
+#include <cstdio>
+
+using namespace Ogre;
+
+namespace
+{
+    const char *c_groupName = "MeshStreamingBenchmark";
+    //-------------------------------------------------------------------------
+    String getMeshName( size_t meshIdx )
+    {
+        return "MeshStreamingBenchmark_" + StringConverter::toString( meshIdx ) + ".mesh";
+    }
+    //-------------------------------------------------------------------------
+    Vector3 getExpectedPosition( size_t meshIdx, size_t vertexIdx )
+    {
+        return Vector3( Real( meshIdx ), vertexIdx * 0.001f, vertexIdx * -0.002f );
+    }
+    //-------------------------------------------------------------------------
+    /// Position, normal, tangent & UVs in full 32-bit floats, like a mesh
+    /// that was never run through OgreMeshTool's optimizations.
+    void exportMesh( VaoManager *vaoManager, size_t meshIdx, size_t numVertices )
+    {
+        MeshPtr mesh = MeshManager::getSingleton().createManual(
+                    "MeshStreamingBenchmarkSource", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME );
+        SubMesh *subMesh = mesh->createSubMesh();
+        subMesh->setMaterialName( "BaseWhite" );
+
+        VertexElement2Vec vertexElements;
+        vertexElements.push_back( VertexElement2( VET_FLOAT3, VES_POSITION ) );
+        vertexElements.push_back( VertexElement2( VET_FLOAT3, VES_NORMAL ) );
+        vertexElements.push_back( VertexElement2( VET_FLOAT4, VES_TANGENT ) );
+        vertexElements.push_back( VertexElement2( VET_FLOAT2, VES_TEXTURE_COORDINATES ) );
+
+        //The buffers keep them as shadow copies
+        float *vertices = reinterpret_cast<float*>( OGRE_MALLOC_SIMD(
+                                                        sizeof(float) * 12u * numVertices,
+                                                        MEMCATEGORY_GEOMETRY ) );
+        for( size_t i=0; i<numVertices; ++i )
+        {
+            const Vector3 pos = getExpectedPosition( meshIdx, i );
+            const float vertex[12] = { static_cast<float>( pos.x ), static_cast<float>( pos.y ),
+                                       static_cast<float>( pos.z ),
+                                       0.0f, 1.0f, 0.0f,
+                                       1.0f, 0.0f, 0.0f, 1.0f,
+                                       (i & 1u) ? 1.0f : 0.0f, (i & 2u) ? 1.0f : 0.0f };
+            memcpy( vertices + i * 12u, vertex, sizeof( vertex ) );
+        }
+
+        VertexBufferPackedVec vertexBuffers;
+        vertexBuffers.push_back( vaoManager->createVertexBuffer( vertexElements, numVertices,
+                                                                 BT_IMMUTABLE, vertices, true ) );
+
+        const size_t numIndices = (numVertices - 2u) * 3u;
+        uint32 *indices = reinterpret_cast<uint32*>( OGRE_MALLOC_SIMD( sizeof(uint32) * numIndices,
+                                                                       MEMCATEGORY_GEOMETRY ) );
+        for( size_t i=0; i<numVertices - 2u; ++i )
+        {
+            indices[i * 3u + 0] = static_cast<uint32>( i );
+            indices[i * 3u + 1] = static_cast<uint32>( i + 1u );
+            indices[i * 3u + 2] = static_cast<uint32>( i + 2u );
+        }
+
+        IndexBufferPacked *indexBuffer = vaoManager->createIndexBuffer( IndexBufferPacked::IT_32BIT,
+                                                                        numIndices, BT_IMMUTABLE,
+                                                                        indices, true );
+        VertexArrayObject *vao = vaoManager->createVertexArrayObject( vertexBuffers, indexBuffer,
+                                                                      OT_TRIANGLE_LIST );
+        subMesh->mVao[VpNormal].push_back( vao );
+        subMesh->mVao[VpShadow].push_back( vao );
+
+        const Vector3 lastPos = getExpectedPosition( meshIdx, numVertices - 1u );
+        const Vector3 halfSize( 0, lastPos.y * 0.5f, -lastPos.z * 0.5f );
+        mesh->_setBounds( Aabb( Vector3( lastPos.x, halfSize.y, -halfSize.z ), halfSize ), false );
+        mesh->_setBoundingSphereRadius( lastPos.length() );
+
+        MeshSerializer meshSerializer( vaoManager );
+        meshSerializer.exportMesh( mesh.get(), getMeshName( meshIdx ) );
+
+        MeshManager::getSingleton().remove( mesh );
+    }
+    //-------------------------------------------------------------------------
+    void removeMeshes( size_t numMeshes )
+    {
+        for( size_t i=0; i<numMeshes; ++i )
+            MeshManager::getSingleton().remove( getMeshName( i ) );
+    }
+}
+
+namespace Benchmarks
+{
+    void runMeshStreamingBenchmark( const BenchmarkContext &context )
+    {
+        const size_t numMeshes      = std::max<size_t>( context.getArg( 0, 64u ), 1u );
+        const size_t numVertices    = std::max<size_t>( context.getArg( 1, 20000u ), 3u );
+
+        MeshManager &meshManager = MeshManager::getSingleton();
+        ResourceGroupManager &resourceGroupManager = ResourceGroupManager::getSingleton();
+
+        Timer timer;
+        for( size_t i=0; i<numMeshes; ++i )
+            exportMesh( context.getVaoManager(), i, numVertices );
+        std::cout << numMeshes << " meshes of " << numVertices << " vertices exported in "
+                  << timer.getMilliseconds() << "ms" << std::endl;
+
+        resourceGroupManager.addResourceLocation( ".", "FileSystem", c_groupName );
+        resourceGroupManager.initialiseResourceGroup( c_groupName, true );
+
+#if !OGRE_THREAD_SUPPORT
+        std::cout << "Built without thread support: loadAsync runs synchronously" << std::endl;
+#endif
+
+        //Everything on the main thread
+        {
+            timer.reset();
+            for( size_t i=0; i<numMeshes; ++i )
+                meshManager.load( getMeshName( i ), c_groupName );
+            const unsigned long loadUs = timer.getMicroseconds();
+            std::cout << "MeshManager::load:     " << loadUs << "us on the main thread ("
+                      << loadUs / numMeshes << "us per mesh)" << std::endl;
+            removeMeshes( numMeshes );
+        }
+
+        //The phases loadAsync splits the work into
+        {
+            vector<MeshPtr>::type meshes;
+            meshes.reserve( numMeshes );
+
+            timer.reset();
+            for( size_t i=0; i<numMeshes; ++i )
+                meshes.push_back( meshManager.prepare( getMeshName( i ), c_groupName ) );
+            const unsigned long prepareUs = timer.getMicroseconds();
+
+            timer.reset();
+            for( size_t i=0; i<numMeshes; ++i )
+                meshes[i]->load();
+            const unsigned long finaliseUs = timer.getMicroseconds();
+
+            std::cout << "Mesh::prepare:         " << prepareUs << "us (can run in the background)"
+                      << std::endl;
+            std::cout << "Mesh::load (finalise): " << finaliseUs << "us on the main thread ("
+                      << finaliseUs / numMeshes << "us per mesh)" << std::endl;
+
+            meshes.clear();
+            removeMeshes( numMeshes );
+        }
+
+        //Through the WorkQueue
+        {
+            WorkQueue *workQueue = context.root->getWorkQueue();
+
+            vector<MeshPtr>::type meshes;
+            meshes.reserve( numMeshes );
+
+            timer.reset();
+            for( size_t i=0; i<numMeshes; ++i )
+                meshes.push_back( meshManager.loadAsync( getMeshName( i ), c_groupName ) );
+            const unsigned long requestUs = timer.getMicroseconds();
+
+            unsigned long worstResponseUs = 0;
+            unsigned long totalResponseUs = 0;
+            Timer wallClock;
+            while( meshManager.getNumPendingAsyncLoads() && wallClock.getMilliseconds() < 60000u )
+            {
+                timer.reset();
+                workQueue->processResponses();
+                const unsigned long responseUs = timer.getMicroseconds();
+                worstResponseUs = std::max( worstResponseUs, responseUs );
+                totalResponseUs += responseUs;
+            }
+
+            std::cout << "MeshManager::loadAsync: " << requestUs << "us issuing, "
+                      << totalResponseUs << "us processing responses (worst "
+                      << worstResponseUs << "us), " << wallClock.getMilliseconds()
+                      << "ms until all loaded" << std::endl;
+
+            meshes.clear();
+            removeMeshes( numMeshes );
+        }
+
+        resourceGroupManager.destroyResourceGroup( c_groupName );
+        for( size_t i=0; i<numMeshes; ++i )
+            std::remove( getMeshName( i ).c_str() );
+    }
+}
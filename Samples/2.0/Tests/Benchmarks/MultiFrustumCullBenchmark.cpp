@@ -0,0 +1,186 @@
+/*
+    Compares culling the scene once per frustum against culling all the frusta in a
+    single sweep (SceneManager::_cullPhase01Multi), in a setup resembling a shadow node
+    with 4 PSSM cascades and 4 point lights (6 cubemap faces each).
+
+    Arguments: [numItems] [numFrames] [numThreads]
+*/
+
+#include "BenchmarkHarness.h"
+
+#include "OgreRoot.h"
+#include "OgreRenderWindow.h"
+#include "OgreViewport.h"
+#include "OgreCamera.h"
+#include "OgreSceneManager.h"
+#include "OgreItem.h"
+#include "OgreMesh2.h"
+#include "OgreMeshManager2.h"
+#include "OgreTimer.h"
+#include "OgreStringConverter.h"
+
+#include <iostream>
+
+using namespace Ogre;
+
+namespace
+{
+    const size_t c_numCascades      = 4u;
+    const size_t c_numPointLights   = 4u;
+    const Real c_sceneSize          = 1000.0f;
+
+    /// Mimics the cameras a shadow node would setup. Returns one entry per frustum to cull.
+    void createShadowCameras( SceneManager *sceneManager, vector<Camera*>::type &outCameras,
+                              vector<Quaternion>::type &outOrientations )
+    {
+        const Quaternion lightDir( Radian( -Math::HALF_PI * 0.6f ), Vector3::UNIT_X );
+
+        //Same as CompositorPass::CubemapRotations
+        const Quaternion cubemapRotations[6] =
+        {
+            Quaternion( Radian( -Math::HALF_PI ), Vector3::UNIT_Y ),   //+X
+            Quaternion( Radian(  Math::HALF_PI ), Vector3::UNIT_Y ),   //-X
+            Quaternion( Radian(  Math::HALF_PI ), Vector3::UNIT_X ),   //+Y
+            Quaternion( Radian( -Math::HALF_PI ), Vector3::UNIT_X ),   //-Y
+            Quaternion::IDENTITY,                                       //+Z
+            Quaternion( Radian(  Math::PI ), Vector3::UNIT_Y )         //-Z
+        };
+
+        for( size_t i=0; i<c_numCascades; ++i )
+        {
+            Camera *camera = sceneManager->createCamera( "Cascade" + StringConverter::toString( i ),
+                                                         false );
+            const Real extent = 25.0f * Math::Pow( 4.0f, (Real)i );
+            camera->setProjectionType( PT_ORTHOGRAPHIC );
+            camera->setOrthoWindow( extent, extent );
+            camera->setNearClipDistance( 1.0f );
+            camera->setFarClipDistance( 2000.0f );
+            camera->setPosition( 0, 800.0f, 0 );
+            outCameras.push_back( camera );
+            outOrientations.push_back( lightDir );
+        }
+
+        for( size_t i=0; i<c_numPointLights; ++i )
+        {
+            Camera *camera = sceneManager->createCamera( "PointLight" + StringConverter::toString( i ),
+                                                         false, true );
+            camera->setFOVy( Degree( 90 ) );
+            camera->setAspectRatio( 1.0f );
+            camera->setNearClipDistance( 0.1f );
+            camera->setFarClipDistance( 60.0f );
+            camera->setPosition( (Real)i * 40.0f - 60.0f, 5.0f, (Real)i * 25.0f - 40.0f );
+
+            for( size_t j=0; j<6u; ++j )
+            {
+                outCameras.push_back( camera );
+                outOrientations.push_back( cubemapRotations[j] );
+            }
+        }
+    }
+    //-------------------------------------------------------------------------
+    void report( const char *phase, size_t numFrames, size_t numFrusta, unsigned long microseconds )
+    {
+        const double msPerFrame = microseconds / 1000.0 / std::max<size_t>( numFrames, 1u );
+        std::cout << phase << ": " << msPerFrame << " ms per frame ("
+                  << msPerFrame * 1000.0 / numFrusta << " us per frustum)" << std::endl;
+    }
+}
+
+namespace Benchmarks
+{
+    void runMultiFrustumCullBenchmark( const BenchmarkContext &context )
+    {
+        const size_t numItems       = context.getArg( 0, 100000u );
+        const size_t numFrames      = context.getArg( 1, 20u );
+        const size_t numThreads     = std::max<size_t>( context.getArg( 2, 1u ), 1u );
+
+        Root *root = context.root;
+        SceneManager *sceneManager = root->createSceneManager(
+                    ST_GENERIC, numThreads,
+                    numThreads > 1u ? INSTANCING_CULLING_THREADED : INSTANCING_CULLING_SINGLETHREAD );
+        MeshPtr mesh = createCubeMesh( context.getVaoManager(), "MultiFrustumCullBenchmarkCube" );
+
+        //Scatter the objects on a grid
+        const size_t itemsPerRow = static_cast<size_t>( Math::Sqrt( (Real)numItems ) ) + 1u;
+        const Real spacing = c_sceneSize / (Real)itemsPerRow;
+        for( size_t i=0; i<numItems; ++i )
+        {
+            Item *item = sceneManager->createItem( mesh, SCENE_DYNAMIC );
+            SceneNode *sceneNode = sceneManager->getRootSceneNode( SCENE_DYNAMIC )->
+                    createChildSceneNode( SCENE_DYNAMIC );
+            sceneNode->setPosition( ((Real)(i % itemsPerRow) - itemsPerRow * 0.5f) * spacing,
+                                    Math::RangeRandom( 0.0f, 10.0f ),
+                                    ((Real)(i / itemsPerRow) - itemsPerRow * 0.5f) * spacing );
+            sceneNode->attachObject( item );
+        }
+
+        vector<Camera*>::type cameras;
+        vector<Quaternion>::type orientations;
+        createShadowCameras( sceneManager, cameras, orientations );
+        const size_t numFrusta = cameras.size();
+
+        Viewport *viewport = context.window->addViewport();
+        const uint32 visibilityMask = VisibilityFlags::RESERVED_VISIBILITY_FLAGS |
+                                      VisibilityFlags::LAYER_SHADOW_CASTER;
+        viewport->_setVisibilityMask( visibilityMask, visibilityMask );
+
+        const Camera *lodCamera = cameras[0];
+
+        sceneManager->updateSceneGraph();
+        sceneManager->_setCurrentRenderStage( SceneManager::IRS_RENDER_TO_TEXTURE );
+
+        std::cout << numItems << " items, " << numFrusta << " frusta, "
+                  << numThreads << " thread(s)" << std::endl;
+
+        Timer timer;
+
+        //One sweep per frustum
+        timer.reset();
+        for( size_t frame=0; frame<numFrames; ++frame )
+        {
+            for( size_t i=0; i<numFrusta; ++i )
+            {
+                cameras[i]->setOrientation( orientations[i] );
+                cameras[i]->_notifyViewport( viewport );
+                sceneManager->_cullPhase01( cameras[i], lodCamera, viewport, 0, 255 );
+            }
+        }
+        report( "One sweep per frustum", numFrames, numFrusta, timer.getMicroseconds() );
+
+        //All frusta at once
+        vector<MovableObject::MultiFrustum>::type multiFrusta( numFrusta );
+        vector<MovableObject::MultiFrustum*>::type multiFrustaPtrs( numFrusta );
+        for( size_t i=0; i<numFrusta; ++i )
+            multiFrustaPtrs[i] = &multiFrusta[i];
+
+        const uint32 combinedVisibilityFlags =
+                (visibilityMask & sceneManager->getVisibilityMask()) |
+                (visibilityMask & ~VisibilityFlags::RESERVED_VISIBILITY_FLAGS);
+
+        timer.reset();
+        for( size_t frame=0; frame<numFrames; ++frame )
+        {
+            for( size_t i=0; i<numFrusta; ++i )
+            {
+                cameras[i]->setOrientation( orientations[i] );
+                multiFrusta[i].set( cameras[i], lodCamera, combinedVisibilityFlags, 0, 255 );
+            }
+
+            sceneManager->_cullPhase01Multi( &multiFrustaPtrs[0], numFrusta );
+
+            for( size_t i=0; i<numFrusta; ++i )
+            {
+                cameras[i]->setOrientation( orientations[i] );
+                cameras[i]->_notifyViewport( viewport );
+                sceneManager->_setPreCulledFrustum( &multiFrusta[i] );
+                sceneManager->_cullPhase01( cameras[i], lodCamera, viewport, 0, 255 );
+            }
+        }
+        report( "Single multi-frustum sweep", numFrames, numFrusta, timer.getMicroseconds() );
+
+        sceneManager->_setCurrentRenderStage( SceneManager::IRS_NONE );
+
+        root->destroySceneManager( sceneManager );
+        MeshManager::getSingleton().remove( mesh->getHandle() );
+    }
+}
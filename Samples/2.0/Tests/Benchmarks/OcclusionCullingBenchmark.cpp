@@ -0,0 +1,163 @@
+/*
+    Measures SoftwareOcclusionCulling on a city-like scene: a grid of tall buildings
+    (registered as box occluders) with many small props scattered in the streets,
+    seen by a street-level camera that slowly turns around.
+
+    Reports frustum-only culling vs frustum + occlusion culling, the percentage of
+    frustum-visible objects that got occluded, and the cost of each stage.
+
+    Arguments: [numProps] [numFrames] [numThreads]
+*/
+
+#include "BenchmarkHarness.h"
+
+#include "OgreRoot.h"
+#include "OgreRenderWindow.h"
+#include "OgreViewport.h"
+#include "OgreCamera.h"
+#include "OgreSceneManager.h"
+#include "OgreItem.h"
+#include "OgreMesh2.h"
+#include "OgreMeshManager2.h"
+#include "OgreTimer.h"
+#include "OgreSoftwareOcclusionCulling.h"
+
+#include <iostream>
+
+using namespace Ogre;
+
+namespace
+{
+    const size_t c_numBlocks    = 16u;
+    const Real c_blockSize      = 40.0f;
+    const Real c_streetWidth    = 12.0f;
+    //-------------------------------------------------------------------------
+    void cullFrames( SceneManager *sceneManager, Camera *camera, Viewport *viewport,
+                     size_t numFrames, SoftwareOcclusionCulling::Stats *outAccumStats )
+    {
+        for( size_t frame=0; frame<numFrames; ++frame )
+        {
+            camera->setOrientation( Quaternion( Radian( Math::TWO_PI * (Real)frame /
+                                                        (Real)numFrames ), Vector3::UNIT_Y ) );
+            sceneManager->_cullPhase01( camera, camera, viewport, 0, 255 );
+
+            SoftwareOcclusionCulling *occlusionCulling = sceneManager->getSoftwareOcclusionCulling();
+            if( occlusionCulling && outAccumStats )
+            {
+                const SoftwareOcclusionCulling::Stats stats = occlusionCulling->getStats();
+                outAccumStats->numOccluders         = stats.numOccluders;
+                outAccumStats->numTriangles         += stats.numTriangles;
+                outAccumStats->numTested            += stats.numTested;
+                outAccumStats->numCulled            += stats.numCulled;
+                outAccumStats->setupMicroseconds    += stats.setupMicroseconds;
+                outAccumStats->rasterMicroseconds   += stats.rasterMicroseconds;
+                outAccumStats->testMicroseconds     += stats.testMicroseconds;
+            }
+        }
+    }
+}
+
+namespace Benchmarks
+{
+    void runOcclusionCullingBenchmark( const BenchmarkContext &context )
+    {
+        const size_t numProps       = context.getArg( 0, 50000u );
+        const size_t numFrames      = context.getArg( 1, 60u );
+        const size_t numThreads     = std::max<size_t>( context.getArg( 2, 1u ), 1u );
+
+        Root *root = context.root;
+        SceneManager *sceneManager = root->createSceneManager(
+                    ST_GENERIC, numThreads,
+                    numThreads > 1u ? INSTANCING_CULLING_THREADED : INSTANCING_CULLING_SINGLETHREAD );
+        MeshPtr mesh = createCubeMesh( context.getVaoManager(), "OcclusionCullingBenchmarkCube" );
+
+        SceneNode *rootNode = sceneManager->getRootSceneNode( SCENE_DYNAMIC );
+
+        //Buildings
+        vector<Item*>::type buildings;
+        const Real cityPitch = c_blockSize + c_streetWidth;
+        const Real cityHalfSize = c_numBlocks * cityPitch * 0.5f;
+        for( size_t z=0; z<c_numBlocks; ++z )
+        {
+            for( size_t x=0; x<c_numBlocks; ++x )
+            {
+                const Real height = Math::RangeRandom( 20.0f, 80.0f );
+                Item *item = sceneManager->createItem( mesh, SCENE_DYNAMIC );
+                SceneNode *sceneNode = rootNode->createChildSceneNode( SCENE_DYNAMIC );
+                sceneNode->setPosition( (Real)x * cityPitch - cityHalfSize + cityPitch * 0.5f,
+                                        height * 0.5f,
+                                        (Real)z * cityPitch - cityHalfSize + cityPitch * 0.5f );
+                sceneNode->setScale( c_blockSize * 0.5f, height * 0.5f, c_blockSize * 0.5f );
+                sceneNode->attachObject( item );
+                buildings.push_back( item );
+            }
+        }
+
+        //Props: scattered anywhere, including inside the blocks' back yards.
+        for( size_t i=0; i<numProps; ++i )
+        {
+            Item *item = sceneManager->createItem( mesh, SCENE_DYNAMIC );
+            SceneNode *sceneNode = rootNode->createChildSceneNode( SCENE_DYNAMIC );
+            sceneNode->setPosition( Math::RangeRandom( -cityHalfSize, cityHalfSize ),
+                                    Math::RangeRandom( 0.5f, 3.0f ),
+                                    Math::RangeRandom( -cityHalfSize, cityHalfSize ) );
+            sceneNode->setScale( 0.5f, 0.5f, 0.5f );
+            sceneNode->attachObject( item );
+        }
+
+        Camera *camera = sceneManager->createCamera( "StreetCamera" );
+        //Standing at the crossroads in the middle of the city
+        camera->setPosition( 0, 1.8f, 0 );
+        camera->setNearClipDistance( 0.2f );
+        camera->setFarClipDistance( cityHalfSize * 2.0f );
+        camera->setAutoAspectRatio( true );
+
+        Viewport *viewport = context.window->addViewport();
+        //Normally set by the compositor. Zero would cull everything.
+        viewport->_setVisibilityMask( 0xffffffff, 0xffffffff );
+        camera->_notifyViewport( viewport );
+
+        sceneManager->updateSceneGraph();
+
+        std::cout << numProps << " props, " << buildings.size() << " buildings, "
+                  << numThreads << " thread(s)" << std::endl;
+
+        Timer timer;
+
+        //Frustum only
+        timer.reset();
+        cullFrames( sceneManager, camera, viewport, numFrames, 0 );
+        reportPerFrame( "Frustum culling only", numFrames, timer.getMicroseconds() );
+
+        //Frustum + occlusion
+        sceneManager->setSoftwareOcclusionCulling( true );
+        SoftwareOcclusionCulling *occlusionCulling = sceneManager->getSoftwareOcclusionCulling();
+        vector<Item*>::type::const_iterator itor = buildings.begin();
+        vector<Item*>::type::const_iterator end  = buildings.end();
+        while( itor != end )
+            occlusionCulling->addBoxOccluder( *itor++ );
+
+        SoftwareOcclusionCulling::Stats stats;
+        timer.reset();
+        cullFrames( sceneManager, camera, viewport, numFrames, &stats );
+        reportPerFrame( "Frustum + occlusion culling", numFrames, timer.getMicroseconds() );
+
+        const double invFrames = 1.0 / std::max<size_t>( numFrames, 1u );
+        std::cout << "Depth buffer: " << occlusionCulling->getWidth() << "x"
+                  << occlusionCulling->getHeight() << ", "
+                  << stats.numOccluders << " occluders, "
+                  << stats.numTriangles * invFrames << " triangles per frame" << std::endl;
+        std::cout << "Occluded: " << stats.getCulledPercentage() << "% of "
+                  << stats.numTested * invFrames << " frustum-visible objects per frame"
+                  << std::endl;
+        std::cout << "  Setup:  " << stats.setupMicroseconds * invFrames << " us per frame\n"
+                  << "  Raster: " << stats.rasterMicroseconds * invFrames << " us per frame\n"
+                  << "  Test:   " << stats.testMicroseconds * invFrames
+                  << " us per frame (summed across threads)" << std::endl;
+
+        sceneManager->setSoftwareOcclusionCulling( false );
+
+        root->destroySceneManager( sceneManager );
+        MeshManager::getSingleton().remove( mesh->getHandle() );
+    }
+}
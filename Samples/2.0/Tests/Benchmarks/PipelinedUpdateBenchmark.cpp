@@ -0,0 +1,164 @@
+/*
+    Measures SceneManager::setPipelinedUpdate with a scene made of many animated
+    groups of items, where every frame moves all the groups.
+
+    The "render" is simulated by reading the transform and world aabb of every
+    item (plus some arithmetic per item). First runs updateSceneGraph followed by
+    the render, then updateSceneGraphAsync, the render and waitForSceneGraphUpdate
+    so a dedicated thread updates the next frame while the current one is being
+    rendered.
+
+    Arguments: [numGroups] [itemsPerGroup] [numFrames] [numThreads] [renderCost]
+*/
+
+#include "BenchmarkHarness.h"
+
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgreItem.h"
+#include "OgreMesh2.h"
+#include "OgreMeshManager2.h"
+#include "OgreTimer.h"
+
+#include <iostream>
+
+using namespace Ogre;
+
+namespace
+{
+    /// Moves every group. The result only depends on the frame number.
+    void animate( const vector<SceneNode*>::type &groupNodes, size_t frame )
+    {
+        const Real t = frame * 0.02f;
+        for( size_t i=0; i<groupNodes.size(); ++i )
+        {
+            const Real phase = t + i * 0.37f;
+            groupNodes[i]->setOrientation( Quaternion( Radian( phase ), Vector3::UNIT_Y ) );
+            groupNodes[i]->setPosition( (i % 64u) * 20.0f + Math::Sin( phase ) * 5.0f,
+                                        Math::Cos( phase * 0.5f ),
+                                        (i / 64u) * 20.0f );
+        }
+    }
+    //-------------------------------------------------------------------------
+    /// Stands in for the render: reads what the renderer reads for every item.
+    double simulateRender( const vector<Item*>::type &items, size_t renderCost )
+    {
+        double checksum = 0;
+
+        vector<Item*>::type::const_iterator itor = items.begin();
+        vector<Item*>::type::const_iterator end  = items.end();
+        while( itor != end )
+        {
+            const Item *item = *itor;
+            const Matrix4 &worldMat = item->getParentNode()->_getFullTransform();
+            const Aabb worldAabb = item->getWorldAabb();
+
+            Vector3 pos = worldMat.getTrans();
+            for( size_t i=0; i<renderCost; ++i )
+                pos = worldMat.transformAffine( pos ) * 0.5f;
+
+            checksum += worldMat[0][3] + worldAabb.mCenter.x + worldAabb.mHalfSize.x +
+                        item->getWorldRadius() + pos.x * 1e-30;
+            ++itor;
+        }
+
+        return checksum;
+    }
+}
+
+namespace Benchmarks
+{
+    void runPipelinedUpdateBenchmark( const BenchmarkContext &context )
+    {
+        const size_t numGroups      = context.getArg( 0, 2000u );
+        const size_t itemsPerGroup  = context.getArg( 1, 16u );
+        const size_t numFrames      = std::max<size_t>( context.getArg( 2, 60u ), 2u );
+        const size_t numThreads     = std::max<size_t>( context.getArg( 3, 2u ), 1u );
+        const size_t renderCost     = context.getArg( 4, 8u );
+
+        Root *root = context.root;
+        SceneManager *sceneManager = root->createSceneManager(
+                    ST_GENERIC, numThreads,
+                    numThreads > 1u ? INSTANCING_CULLING_THREADED : INSTANCING_CULLING_SINGLETHREAD );
+        MeshPtr mesh = createCubeMesh( context.getVaoManager(), "PipelinedUpdateBenchmarkCube" );
+
+        SceneNode *rootNode = sceneManager->getRootSceneNode();
+
+        vector<SceneNode*>::type groupNodes;
+        vector<Item*>::type items;
+        groupNodes.reserve( numGroups );
+        items.reserve( numGroups * itemsPerGroup );
+        for( size_t i=0; i<numGroups; ++i )
+        {
+            SceneNode *groupNode = rootNode->createChildSceneNode();
+            for( size_t j=0; j<itemsPerGroup; ++j )
+            {
+                Item *item = sceneManager->createItem( mesh );
+                SceneNode *sceneNode = groupNode->createChildSceneNode();
+                sceneNode->setPosition( (j % 4u) * 3.0f, (j / 4u) * 3.0f, 0 );
+                sceneNode->setScale( Vector3( 0.5f + (j % 3u) * 0.25f ) );
+                sceneNode->attachObject( item );
+                items.push_back( item );
+            }
+            groupNodes.push_back( groupNode );
+        }
+
+        std::cout << numGroups << " groups, " << items.size() << " items, " << numThreads
+                  << " thread(s), render cost " << renderCost << std::endl;
+
+        Timer timer;
+        double checksum = 0;
+
+        //Serial: update, then render what was just updated.
+        unsigned long updateUs = 0;
+        unsigned long totalUs = 0;
+        for( size_t frame=0; frame<numFrames; ++frame )
+        {
+            animate( groupNodes, frame );
+
+            timer.reset();
+            sceneManager->updateSceneGraph();
+            updateUs += timer.getMicroseconds();
+            checksum += simulateRender( items, renderCost );
+            totalUs += timer.getMicroseconds();
+        }
+        reportPerFrame( "updateSceneGraph", numFrames, updateUs );
+        reportPerFrame( "Serial update + render", numFrames, totalUs );
+
+        //Pipelined: frame N gets updated while frame N - 1 is rendered.
+        sceneManager->setPipelinedUpdate( true );
+        animate( groupNodes, 0 );
+        sceneManager->updateSceneGraph();
+
+        unsigned long asyncUs = 0;
+        unsigned long waitUs = 0;
+        totalUs = 0;
+        for( size_t frame=1; frame<numFrames; ++frame )
+        {
+            animate( groupNodes, frame );
+
+            timer.reset();
+            sceneManager->updateSceneGraphAsync();
+            asyncUs += timer.getMicroseconds();
+
+            checksum += simulateRender( items, renderCost );
+
+            const unsigned long beforeWait = timer.getMicroseconds();
+            sceneManager->waitForSceneGraphUpdate();
+            const unsigned long afterWait = timer.getMicroseconds();
+            waitUs  += afterWait - beforeWait;
+            totalUs += afterWait;
+        }
+        reportPerFrame( "updateSceneGraphAsync", numFrames - 1u, asyncUs );
+        reportPerFrame( "waitForSceneGraphUpdate", numFrames - 1u, waitUs );
+        reportPerFrame( "Pipelined update + render", numFrames - 1u, totalUs );
+
+        //Keeps the simulated render from being optimised away.
+        std::cout << "Checksum: " << checksum << std::endl;
+
+        sceneManager->setPipelinedUpdate( false );
+
+        root->destroySceneManager( sceneManager );
+        MeshManager::getSingleton().remove( mesh->getHandle() );
+    }
+}
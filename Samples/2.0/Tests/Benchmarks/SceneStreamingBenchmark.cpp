@@ -0,0 +1,198 @@
+/*
+    Measures importing a large level exported by SceneFormatExporter as a
+    single scene.json versus the sectioned scene.oscn container, both at once
+    and streamed in with a per-frame time budget.
+
+    Reports the import times and, when streaming, the number of frames it took
+    and the slowest frame. The scenes are written to (and removed from) the
+    working directory.
+
+    Arguments: [numItems] [budgetMicroseconds]
+*/
+
+#include "BenchmarkHarness.h"
+
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgreItem.h"
+#include "OgreMesh2.h"
+#include "OgreMeshManager2.h"
+#include "OgreFileSystemLayer.h"
+#include "OgreTimer.h"
+#include "OgreStringConverter.h"
+
+#include "OgreSceneFormatExporter.h"
+#include "OgreSceneFormatImporter.h"
+
+#include <iostream>
+
+using namespace Ogre;
+
+namespace
+{
+    const Real c_sectionSize = 100.0f;
+    const Real c_spacing = 4.0f;
+    const size_t c_itemsPerRow = 100u;
+    const size_t c_numDistricts = 4u;
+    const size_t c_lightEvery = 50u;
+    const char *c_meshName = "SceneStreamingBenchmarkCube.mesh";
+    const char *c_jsonFolder = "SceneStreamingBenchmark_json";
+    const char *c_sectionedFolder = "SceneStreamingBenchmark_oscn";
+    const uint32 c_exportFlags = SceneFlags::SceneNodes | SceneFlags::ForceAllSceneNodes |
+                                 SceneFlags::Items | SceneFlags::Lights | SceneFlags::Meshes |
+                                 SceneFlags::SceneSettings;
+
+    /// Props are spread among a few district nodes at the origin, so every
+    /// district has children in every section (and must end up in section 0).
+    /// Every c_lightEvery props, a child node above the prop holds a light.
+    void createLevel( SceneManager *sceneManager, size_t numItems )
+    {
+        SceneNode *rootNode = sceneManager->getRootSceneNode();
+
+        SceneNode *districts[c_numDistricts];
+        for( size_t i=0; i<c_numDistricts; ++i )
+        {
+            districts[i] = rootNode->createChildSceneNode();
+            districts[i]->setName( "District" + StringConverter::toString( i ) );
+        }
+
+        for( size_t i=0; i<numItems; ++i )
+        {
+            Item *item = sceneManager->createItem( c_meshName );
+            item->setName( "Prop" + StringConverter::toString( i ) );
+            //Keep the props away from the section borders
+            const Vector3 position( (i % c_itemsPerRow) * c_spacing + c_spacing * 0.5f, 0.0f,
+                                    (i / c_itemsPerRow) * c_spacing + c_spacing * 0.5f );
+            SceneNode *sceneNode = districts[i % c_numDistricts]->createChildSceneNode(
+                                       SCENE_DYNAMIC, position );
+            sceneNode->attachObject( item );
+
+            if( (i % c_lightEvery) == 0 )
+            {
+                Light *light = sceneManager->createLight();
+                light->setName( "Light" + StringConverter::toString( i ) );
+                light->setType( Light::LT_POINT );
+                sceneNode->createChildSceneNode( SCENE_DYNAMIC,
+                                                 Vector3( 0, 1.0f, 0 ) )->attachObject( light );
+            }
+        }
+    }
+    //-------------------------------------------------------------------------
+    SceneManager* createSceneManager( Root *root )
+    {
+        return root->createSceneManager( ST_GENERIC, 1u, INSTANCING_CULLING_SINGLETHREAD );
+    }
+    //-------------------------------------------------------------------------
+    void removeFolder( const String &folder )
+    {
+        FileSystemLayer::removeFile( folder + "/v2/" + c_meshName );
+        FileSystemLayer::removeDirectory( folder + "/v2" );
+        FileSystemLayer::removeFile( folder + "/scene.json" );
+        FileSystemLayer::removeFile( folder + "/scene.oscn" );
+        FileSystemLayer::removeDirectory( folder );
+    }
+}
+
+namespace Benchmarks
+{
+    void runSceneStreamingBenchmark( const BenchmarkContext &context )
+    {
+        const size_t numItems   = context.getArg( 0, 20000u );
+        const uint64 budgetUs   = context.getArg( 1, 2000u );
+
+        Root *root = context.root;
+
+        //Build the level and export it both ways.
+        {
+            //Keep shadow copies so the mesh can be exported.
+            MeshPtr mesh = createCubeMesh( context.getVaoManager(), c_meshName, true );
+            SceneManager *sceneManager = createSceneManager( root );
+            createLevel( sceneManager, numItems );
+
+            SceneFormatExporter exporter( root, sceneManager, 0 );
+
+            Timer timer;
+            exporter.exportSceneToFile( c_jsonFolder, c_exportFlags );
+            const unsigned long jsonUs = timer.getMicroseconds();
+
+            timer.reset();
+            exporter.exportSceneSectionedToFile( c_sectionedFolder, c_sectionSize, c_exportFlags );
+            const unsigned long sectionedUs = timer.getMicroseconds();
+
+            std::cout << numItems << " items" << std::endl;
+            std::cout << "exportSceneToFile: " << jsonUs / 1000.0 << " ms" << std::endl;
+            std::cout << "exportSceneSectionedToFile: " << sectionedUs / 1000.0 << " ms"
+                      << std::endl;
+
+            root->destroySceneManager( sceneManager );
+            mesh.setNull();
+            MeshManager::getSingleton().remove( c_meshName );
+        }
+
+        //Monolithic JSON
+        {
+            SceneManager *sceneManager = createSceneManager( root );
+            SceneFormatImporter importer( root, sceneManager, BLANKSTRING );
+
+            Timer timer;
+            importer.importSceneFromFile( c_jsonFolder );
+            std::cout << "importSceneFromFile: " << timer.getMicroseconds() / 1000.0 << " ms"
+                      << std::endl;
+
+            root->destroySceneManager( sceneManager );
+        }
+
+        //Sectioned, all at once
+        {
+            SceneManager *sceneManager = createSceneManager( root );
+            SceneFormatImporter importer( root, sceneManager, BLANKSTRING );
+
+            Timer timer;
+            importer.importSceneSectionedFromFile( c_sectionedFolder );
+            std::cout << "importSceneSectionedFromFile: " << timer.getMicroseconds() / 1000.0
+                      << " ms" << std::endl;
+
+            root->destroySceneManager( sceneManager );
+        }
+
+        //Sectioned, streamed in with a per-frame budget
+        {
+            SceneManager *sceneManager = createSceneManager( root );
+            SceneFormatImporter importer( root, sceneManager, BLANKSTRING );
+
+            Timer timer;
+            importer.openSectionedScene( c_sectionedFolder );
+            const unsigned long openUs = timer.getMicroseconds();
+
+            const size_t numSections = importer.getNumSections();
+            for( uint32 i=0; i<numSections; ++i )
+                importer.queueSection( i );
+
+            size_t numFrames = 0;
+            unsigned long slowestFrameUs = 0;
+            bool finished = false;
+            timer.reset();
+            while( !finished )
+            {
+                Timer frameTimer;
+                finished = importer.updateStreaming( budgetUs );
+                slowestFrameUs = std::max( slowestFrameUs, frameTimer.getMicroseconds() );
+                ++numFrames;
+            }
+            const unsigned long streamUs = timer.getMicroseconds();
+
+            importer.closeSectionedScene();
+
+            std::cout << "openSectionedScene: " << openUs / 1000.0 << " ms, "
+                      << numSections << " sections" << std::endl;
+            std::cout << "updateStreaming (" << budgetUs << " us budget): " << streamUs / 1000.0
+                      << " ms in " << numFrames << " frames, slowest frame "
+                      << slowestFrameUs / 1000.0 << " ms" << std::endl;
+
+            root->destroySceneManager( sceneManager );
+        }
+
+        removeFolder( c_jsonFolder );
+        removeFolder( c_sectionedFolder );
+    }
+}
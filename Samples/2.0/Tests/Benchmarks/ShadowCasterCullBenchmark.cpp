@@ -0,0 +1,225 @@
+/*
+    Compares culling the shadow casters of each PSSM split only against the shadow map
+    camera (the default) against also culling them against the split's receivers extruded
+    towards the light (SceneManager::setShadowCasterVolumeCulling), in an open-world like
+    scene with a low sun. Also times calculating the casters box.
+
+    Arguments: [numItems] [numFrames] [numThreads]
+*/
+
+#include "BenchmarkHarness.h"
+
+#include "OgreRoot.h"
+#include "OgreRenderWindow.h"
+#include "OgreViewport.h"
+#include "OgreCamera.h"
+#include "OgreLight.h"
+#include "OgreSceneManager.h"
+#include "OgreItem.h"
+#include "OgreMesh2.h"
+#include "OgreMeshManager2.h"
+#include "OgreTimer.h"
+#include "OgreStringConverter.h"
+#include "OgreShadowCasterVolume.h"
+#include "Math/Array/OgreObjectMemoryManager.h"
+
+#include <iostream>
+
+using namespace Ogre;
+
+namespace
+{
+    const Real c_worldSize = 4000.0f;
+    const size_t c_numSplits = 3u;
+    const Real c_splitPoints[c_numSplits + 1u] = { 0.5f, 40.0f, 150.0f, 500.0f };
+    /// How far behind the receivers the shadow camera is placed, to catch tall casters.
+    const Real c_casterDistance = 200.0f;
+
+    void report( const char *phase, size_t numFrames, unsigned long microseconds,
+                 size_t numCasters )
+    {
+        numFrames = std::max<size_t>( numFrames, 1u );
+        std::cout << phase << ": " << microseconds / 1000.0 / numFrames << " ms per frame, "
+                  << numCasters / numFrames << " casters per frame" << std::endl;
+    }
+    //-------------------------------------------------------------------------
+    void orientCamera( Camera *camera, size_t frame, size_t numFrames )
+    {
+        camera->setOrientation( Quaternion( Radian( Math::TWO_PI * (Real)frame /
+                                                    (Real)std::max<size_t>( numFrames, 1u ) ),
+                                            Vector3::UNIT_Y ) );
+    }
+    //-------------------------------------------------------------------------
+    /// Orthographic camera fitted to the receivers in light space, like the
+    /// focused shadow camera setups do.
+    void fitShadowCamera( Camera *shadowCamera, const Vector3 corners[8], const Vector3 &lightDir )
+    {
+        shadowCamera->setPosition( Vector3::ZERO );
+        shadowCamera->setDirection( lightDir );
+        const Quaternion lightSpaceToWorld = shadowCamera->getOrientation();
+        const Quaternion worldToLightSpace = lightSpaceToWorld.Inverse();
+
+        AxisAlignedBox lightSpaceBox;
+        for( size_t i=0; i<8; ++i )
+            lightSpaceBox.merge( worldToLightSpace * corners[i] );
+
+        const Vector3 centre = lightSpaceBox.getCenter();
+        const Vector3 size = lightSpaceBox.getSize();
+
+        shadowCamera->setPosition( lightSpaceToWorld * Vector3( centre.x, centre.y,
+                                                                lightSpaceBox.getMaximum().z +
+                                                                c_casterDistance ) );
+        shadowCamera->setOrthoWindow( size.x, size.y );
+        shadowCamera->setNearClipDistance( 1.0f );
+        shadowCamera->setFarClipDistance( c_casterDistance + size.z );
+    }
+}
+
+namespace Benchmarks
+{
+    void runShadowCasterCullBenchmark( const BenchmarkContext &context )
+    {
+        const size_t numItems       = context.getArg( 0, 100000u );
+        const size_t numFrames      = context.getArg( 1, 60u );
+        const size_t numThreads     = std::max<size_t>( context.getArg( 2, 1u ), 1u );
+
+        Root *root = context.root;
+        SceneManager *sceneManager = root->createSceneManager(
+                    ST_GENERIC, numThreads,
+                    numThreads > 1u ? INSTANCING_CULLING_THREADED : INSTANCING_CULLING_SINGLETHREAD );
+        MeshPtr mesh = createCubeMesh( context.getVaoManager(), "ShadowCasterCullBenchmarkCube" );
+
+        //Scatter objects randomly, some of them tall
+        SceneNode *rootNode = sceneManager->getRootSceneNode();
+        uint8 renderQueue = 0;
+        for( size_t i=0; i<numItems; ++i )
+        {
+            Item *item = sceneManager->createItem( mesh );
+            SceneNode *sceneNode = rootNode->createChildSceneNode();
+            const Real height = (i % 16u) == 0 ? 20.0f : 1.0f;
+            sceneNode->setPosition( Math::RangeRandom( -c_worldSize, c_worldSize ) * 0.5f,
+                                    height,
+                                    Math::RangeRandom( -c_worldSize, c_worldSize ) * 0.5f );
+            sceneNode->setScale( 1.0f, height, 1.0f );
+            sceneNode->attachObject( item );
+            renderQueue = item->getRenderQueueGroup();
+        }
+
+        Light *sun = sceneManager->createLight();
+        SceneNode *lightNode = rootNode->createChildSceneNode();
+        lightNode->attachObject( sun );
+        sun->setType( Light::LT_DIRECTIONAL );
+        sun->setDirection( Vector3( 0.6f, -0.35f, -0.5f ).normalisedCopy() );
+
+        Camera *camera = sceneManager->createCamera( "OpenWorldCamera" );
+        camera->setPosition( 0, 5.0f, 0 );
+        camera->setNearClipDistance( c_splitPoints[0] );
+        camera->setFarClipDistance( c_splitPoints[c_numSplits] );
+        camera->setAutoAspectRatio( true );
+
+        Viewport *viewport = context.window->addViewport();
+        //Normally set by the compositor. Zero would cull everything.
+        viewport->_setVisibilityMask( 0xffffffff, 0xffffffff );
+        camera->_notifyViewport( viewport );
+
+        Camera *shadowCameras[c_numSplits];
+        ShadowCasterVolume casterVolumes[c_numSplits];
+        for( size_t i=0; i<c_numSplits; ++i )
+        {
+            shadowCameras[i] = sceneManager->createCamera( "ShadowCamera" +
+                                                           StringConverter::toString( i ) );
+            shadowCameras[i]->setProjectionType( PT_ORTHOGRAPHIC );
+            shadowCameras[i]->_notifyViewport( viewport );
+        }
+
+        sceneManager->updateSceneGraph();
+
+        std::cout << numItems << " items, " << c_numSplits << " splits, "
+                  << numThreads << " thread(s)" << std::endl;
+
+        ObjectMemoryManager &memoryManager = sceneManager->_getEntityMemoryManager( SCENE_DYNAMIC );
+        const uint32 visibilityMask = ((viewport->getVisibilityMask() &
+                                        sceneManager->getVisibilityMask()) |
+                                       (viewport->getVisibilityMask() &
+                                        ~VisibilityFlags::RESERVED_VISIBILITY_FLAGS)) |
+                                      VisibilityFlags::LAYER_SHADOW_CASTER;
+        const Vector3 lightDir = sun->getDerivedDirection();
+
+        unsigned long timeCameraOnly = 0;
+        unsigned long timeWithVolume = 0;
+        unsigned long timeVolumeSetup = 0;
+        size_t numCastersCameraOnly = 0;
+        size_t numCastersWithVolume = 0;
+        Timer timer;
+
+        MovableObject::MovableObjectArray cameraOnlyResult;
+        MovableObject::MovableObjectArray withVolumeResult;
+
+        for( size_t frame=0; frame<numFrames; ++frame )
+        {
+            orientCamera( camera, frame, numFrames );
+
+            for( size_t i=0; i<c_numSplits; ++i )
+            {
+                Camera *shadowCamera = shadowCameras[i];
+
+                Vector3 corners[8];
+                ShadowCasterVolume::getReceiverCorners( camera, c_splitPoints[i],
+                                                        c_splitPoints[i + 1u], corners );
+                fitShadowCamera( shadowCamera, corners, lightDir );
+
+                ObjectData objData;
+                const size_t numObjs = memoryManager.getFirstObjectData( objData, renderQueue );
+
+                cameraOnlyResult.clear();
+                shadowCamera->_setShadowCasterVolume( 0 );
+                shadowCamera->getFrustumPlanes();
+                timer.reset();
+                MovableObject::cullFrustum( numObjs, objData, shadowCamera, visibilityMask,
+                                            cameraOnlyResult, camera );
+                timeCameraOnly += timer.getMicroseconds();
+
+                timer.reset();
+                casterVolumes[i].build( corners, sun );
+                timeVolumeSetup += timer.getMicroseconds();
+
+                withVolumeResult.clear();
+                shadowCamera->_setShadowCasterVolume( &casterVolumes[i] );
+                timer.reset();
+                MovableObject::cullFrustum( numObjs, objData, shadowCamera, visibilityMask,
+                                            withVolumeResult, camera );
+                timeWithVolume += timer.getMicroseconds();
+
+                numCastersCameraOnly += cameraOnlyResult.size();
+                numCastersWithVolume += withVolumeResult.size();
+            }
+        }
+
+        report( "Shadow camera only", numFrames, timeCameraOnly, numCastersCameraOnly );
+        report( "With caster volume", numFrames, timeWithVolume + timeVolumeSetup,
+                numCastersWithVolume );
+
+        //Casters box: a single sweep vs. the worker threads
+        {
+            const uint32 castersBoxMask = (viewport->getVisibilityMask() &
+                                           sceneManager->getVisibilityMask()) |
+                                          (viewport->getVisibilityMask() &
+                                           ~VisibilityFlags::RESERVED_VISIBILITY_FLAGS);
+            ObjectData objData;
+            const size_t numObjs = memoryManager.getFirstObjectData( objData, renderQueue );
+            AxisAlignedBox castersBox;
+            timer.reset();
+            MovableObject::calculateCastersBox( numObjs, objData, castersBoxMask, &castersBox );
+            std::cout << "Casters box, single sweep: " << timer.getMicroseconds() / 1000.0
+                      << " ms" << std::endl;
+        }
+        timer.reset();
+        sceneManager->_calculateCurrentCastersBox( viewport->getVisibilityMask(), renderQueue,
+                                                   static_cast<uint8>( renderQueue + 1u ) );
+        std::cout << "Casters box, worker threads: " << timer.getMicroseconds() / 1000.0
+                  << " ms" << std::endl;
+
+        root->destroySceneManager( sceneManager );
+        MeshManager::getSingleton().remove( mesh->getHandle() );
+    }
+}
@@ -0,0 +1,129 @@
+/*
+    Compares frustum culling of static objects by sweeping all of them (the default)
+    against walking a StaticObjectBvh (SceneManager::setStaticBvhCulling), in an
+    open-world like scene where only a small fraction of the objects is in view.
+    Also measures the cost of building the tree and of refitting it after moving
+    a few static objects.
+
+    Arguments: [numItems] [numFrames] [numThreads]
+*/
+
+#include "BenchmarkHarness.h"
+
+#include "OgreRoot.h"
+#include "OgreRenderWindow.h"
+#include "OgreViewport.h"
+#include "OgreCamera.h"
+#include "OgreSceneManager.h"
+#include "OgreItem.h"
+#include "OgreMesh2.h"
+#include "OgreMeshManager2.h"
+#include "OgreTimer.h"
+#include "OgreStaticObjectBvh.h"
+
+#include <iostream>
+
+using namespace Ogre;
+
+namespace
+{
+    const Real c_worldSize = 8000.0f;
+
+    void orientCamera( Camera *camera, size_t frame, size_t numFrames )
+    {
+        camera->setOrientation( Quaternion( Radian( Math::TWO_PI * (Real)frame /
+                                                    (Real)std::max<size_t>( numFrames, 1u ) ),
+                                            Vector3::UNIT_Y ) );
+    }
+}
+
+namespace Benchmarks
+{
+    void runStaticBvhCullBenchmark( const BenchmarkContext &context )
+    {
+        const size_t numItems       = context.getArg( 0, 250000u );
+        const size_t numFrames      = context.getArg( 1, 60u );
+        const size_t numThreads     = std::max<size_t>( context.getArg( 2, 1u ), 1u );
+
+        Root *root = context.root;
+        SceneManager *sceneManager = root->createSceneManager(
+                    ST_GENERIC, numThreads,
+                    numThreads > 1u ? INSTANCING_CULLING_THREADED : INSTANCING_CULLING_SINGLETHREAD );
+        MeshPtr mesh = createCubeMesh( context.getVaoManager(), "StaticBvhCullBenchmarkCube" );
+
+        //Scatter static objects randomly
+        SceneNode *rootNode = sceneManager->getRootSceneNode( SCENE_STATIC );
+        vector<SceneNode*>::type sceneNodes;
+        sceneNodes.reserve( numItems );
+        for( size_t i=0; i<numItems; ++i )
+        {
+            Item *item = sceneManager->createItem( mesh, SCENE_STATIC );
+            SceneNode *sceneNode = rootNode->createChildSceneNode( SCENE_STATIC );
+            sceneNode->setPosition( Math::RangeRandom( -c_worldSize, c_worldSize ) * 0.5f,
+                                    Math::RangeRandom( 0.0f, 10.0f ),
+                                    Math::RangeRandom( -c_worldSize, c_worldSize ) * 0.5f );
+            sceneNode->attachObject( item );
+            sceneNodes.push_back( sceneNode );
+        }
+
+        Camera *camera = sceneManager->createCamera( "OpenWorldCamera" );
+        camera->setPosition( 0, 5.0f, 0 );
+        camera->setNearClipDistance( 0.5f );
+        camera->setFarClipDistance( 600.0f );
+        camera->setAutoAspectRatio( true );
+
+        Viewport *viewport = context.window->addViewport();
+        //Normally set by the compositor. Zero would cull everything.
+        viewport->_setVisibilityMask( 0xffffffff, 0xffffffff );
+        camera->_notifyViewport( viewport );
+
+        sceneManager->updateSceneGraph();
+
+        std::cout << numItems << " static items, " << numThreads << " thread(s)" << std::endl;
+
+        Timer timer;
+
+        //Linear sweep
+        timer.reset();
+        for( size_t frame=0; frame<numFrames; ++frame )
+        {
+            orientCamera( camera, frame, numFrames );
+            sceneManager->_cullPhase01( camera, camera, viewport, 0, 255 );
+        }
+        reportPerFrame( "Linear sweep", numFrames, timer.getMicroseconds() );
+
+        //Build the BVH
+        sceneManager->setStaticBvhCulling( true );
+        StaticObjectBvh *bvh = sceneManager->getStaticObjectBvh();
+        timer.reset();
+        sceneManager->updateSceneGraph();
+        std::cout << "BVH build: " << timer.getMicroseconds() / 1000.0 << " ms, "
+                  << bvh->getNumNodes() << " nodes" << std::endl;
+
+        //BVH
+        timer.reset();
+        for( size_t frame=0; frame<numFrames; ++frame )
+        {
+            orientCamera( camera, frame, numFrames );
+            sceneManager->_cullPhase01( camera, camera, viewport, 0, 255 );
+        }
+        reportPerFrame( "BVH", numFrames, timer.getMicroseconds() );
+
+        //Move 1% of the objects; the tree gets refit instead of rebuilt.
+        const size_t numRebuildsBefore = bvh->getNumRebuilds();
+        for( size_t i=0; i<numItems; i += 100u )
+        {
+            sceneNodes[i]->translate( Math::RangeRandom( -50.0f, 50.0f ), 0,
+                                      Math::RangeRandom( -50.0f, 50.0f ) );
+            sceneManager->notifyStaticDirty( sceneNodes[i] );
+        }
+        timer.reset();
+        sceneManager->updateSceneGraph();
+        std::cout << "Scene update after moving 1% (incl. " <<
+                     (bvh->getNumRebuilds() == numRebuildsBefore ? "refit" : "rebuild") << "): "
+                  << timer.getMicroseconds() / 1000.0 << " ms" << std::endl;
+
+        root->destroySceneManager( sceneManager );
+        MeshManager::getSingleton().remove( mesh->getHandle() );
+    }
+}
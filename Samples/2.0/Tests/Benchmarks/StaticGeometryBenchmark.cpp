@@ -0,0 +1,108 @@
+/*
+    Measures StaticGeometry (v2) merging a large field of static props into
+    per-region batches, and how many draws it saves.
+
+    Reports the time spent queueing the Items and building the regions (the
+    merge runs on the SceneManager's worker threads), and saving and loading
+    the built regions.
+
+    Arguments: [numItems] [numThreads]
+*/
+
+#include "BenchmarkHarness.h"
+
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgreItem.h"
+#include "OgreMesh2.h"
+#include "OgreMeshManager2.h"
+#include "OgreStaticGeometry2.h"
+#include "OgreDataStream.h"
+#include "OgreTimer.h"
+
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+
+using namespace Ogre;
+
+namespace
+{
+    const Real c_regionSize = 100.0f;
+    const Real c_spacing = 4.0f;
+    const size_t c_itemsPerRow = 100u;
+}
+
+namespace Benchmarks
+{
+    void runStaticGeometryBenchmark( const BenchmarkContext &context )
+    {
+        const size_t numItems       = context.getArg( 0, 40000u );
+        const size_t numThreads     = std::max<size_t>( context.getArg( 1, 4u ), 1u );
+
+        Root *root = context.root;
+        SceneManager *sceneManager = root->createSceneManager(
+                    ST_GENERIC, numThreads,
+                    numThreads > 1u ? INSTANCING_CULLING_THREADED : INSTANCING_CULLING_SINGLETHREAD );
+        MeshPtr mesh = createCubeMesh( context.getVaoManager(), "StaticGeometryBenchmarkCube" );
+
+        //A field of props, the way a level would place them
+        SceneNode *propsNode = sceneManager->getRootSceneNode( SCENE_STATIC )->
+                createChildSceneNode( SCENE_STATIC );
+        for( size_t i=0; i<numItems; ++i )
+        {
+            Item *item = sceneManager->createItem( mesh, SCENE_STATIC );
+            SceneNode *sceneNode = propsNode->createChildSceneNode(
+                        SCENE_STATIC, Vector3( (i % c_itemsPerRow) * c_spacing, 0.0f,
+                                               (i / c_itemsPerRow) * c_spacing ) );
+            sceneNode->attachObject( item );
+        }
+
+        std::cout << numItems << " items, " << numThreads << " thread(s)" << std::endl;
+
+        Timer timer;
+
+        StaticGeometry staticGeometry( "Props", sceneManager );
+        staticGeometry.setRegionDimensions( Vector3( c_regionSize ) );
+        staticGeometry.addSceneNode( propsNode );
+        const unsigned long queueUs = timer.getMicroseconds();
+
+        timer.reset();
+        staticGeometry.build();
+        const unsigned long buildUs = timer.getMicroseconds();
+
+        std::cout << "addSceneNode: " << queueUs / 1000.0 << " ms" << std::endl;
+        std::cout << "build: " << buildUs / 1000.0 << " ms" << std::endl;
+        std::cout << "Draws: " << numItems << " items -> " << staticGeometry.getRegions().size()
+                  << " regions" << std::endl;
+
+        const String filename = "StaticGeometryBenchmark.regions";
+        timer.reset();
+        staticGeometry.saveRegions( filename );
+        const unsigned long saveUs = timer.getMicroseconds();
+        staticGeometry.reset();
+
+        //The originals aren't needed to load the regions
+        sceneManager->destroyAllItems();
+        propsNode->removeAndDestroyAllChildren();
+
+        StaticGeometry loadedGeometry( "Loaded", sceneManager );
+        {
+            std::ifstream *ifs = OGRE_NEW_T( std::ifstream, MEMCATEGORY_GENERAL )(
+                        filename.c_str(), std::ios::binary | std::ios::in );
+            DataStreamPtr stream( OGRE_NEW FileStreamDataStream( filename, ifs, true ) );
+            timer.reset();
+            loadedGeometry.loadRegions( stream );
+        }
+        const unsigned long loadUs = timer.getMicroseconds();
+        std::remove( filename.c_str() );
+
+        std::cout << "saveRegions: " << saveUs / 1000.0 << " ms" << std::endl;
+        std::cout << "loadRegions: " << loadUs / 1000.0 << " ms" << std::endl;
+
+        loadedGeometry.reset();
+
+        root->destroySceneManager( sceneManager );
+        MeshManager::getSingleton().remove( mesh->getHandle() );
+    }
+}
@@ -0,0 +1,430 @@
+/*
+    Replays a recorded-style allocation trace (vertex, index and const buffers of
+    mixed strides and lifetimes) against the VaoManager's TlsfSubAllocator and
+    against the first-fit free list + stride changers it replaced, on a pool of
+    the same size. Reports the time per operation, failed allocations (which
+    would force a new pool), peak usage and the fragmentation left behind.
+
+    Then creates and destroys buffers through the NULL VaoManager and prints its
+    per-BufferType VaoManager::getMemoryStats.
+    Arguments: [numOps] [poolSizeMB] [numBuffers]
+*/
+
+#include "BenchmarkHarness.h"
+
+#include "OgreTimer.h"
+
+#include "Vao/OgreVaoManager.h"
+#include "Vao/OgreConstBufferPacked.h"
+#include "Vao/OgreIndexBufferPacked.h"
+#include "Vao/OgreVertexBufferPacked.h"
+#include "Vao/OgreTlsfSubAllocator.h"
+
+#include <iostream>
+
+using namespace Ogre;
+
+namespace
+{
+    /// Deterministic across platforms, unlike rand()
+    struct Lcg
+    {
+        uint32 state;
+        Lcg( uint32 seed ) : state( seed ) {}
+        uint32 next(void)
+        {
+            state = state * 1664525u + 1013904223u;
+            return state >> 8u;
+        }
+        /// Roughly log-uniform in [minValue; maxValue]
+        size_t nextLog( size_t minValue, size_t maxValue )
+        {
+            const Real t = Real( next() & 0xFFFF ) / Real( 0xFFFF );
+            return static_cast<size_t>( minValue * Math::Pow( Real( maxValue ) / Real( minValue ), t ) );
+        }
+    };
+    //-------------------------------------------------------------------------
+    struct TraceOp
+    {
+        bool    allocate;
+        size_t  id;
+        size_t  sizeBytes;
+        size_t  alignment;
+    };
+    typedef vector<TraceOp>::type TraceOpVec;
+    //-------------------------------------------------------------------------
+    /// Mimics what a game streaming meshes in and out does: buffers with the size & alignment
+    /// of vertex buffers (stride), index buffers and const buffers (256 bytes) with random
+    /// lifetimes. Live data hovers around liveTarget bytes.
+    TraceOpVec generateTrace( size_t numOps, size_t liveTarget )
+    {
+        const size_t c_strides[7] = { 12, 16, 24, 32, 36, 44, 48 };
+
+        Lcg lcg( 12345u );
+        TraceOpVec trace;
+        trace.reserve( numOps );
+
+        vector<TraceOp>::type live;
+        size_t liveBytes = 0;
+        size_t nextId = 0;
+
+        for( size_t i=0; i<numOps; ++i )
+        {
+            const bool doFree = !live.empty() &&
+                                ( liveBytes > liveTarget || (lcg.next() % 100u) < 45u );
+            if( doFree )
+            {
+                const size_t idx = lcg.next() % live.size();
+                TraceOp op = live[idx];
+                op.allocate = false;
+                trace.push_back( op );
+                liveBytes -= op.sizeBytes;
+                live[idx] = live.back();
+                live.pop_back();
+            }
+            else
+            {
+                TraceOp op;
+                op.allocate = true;
+                op.id       = nextId++;
+
+                const uint32 kind = lcg.next() % 10u;
+                if( kind < 6u )
+                {
+                    op.alignment = c_strides[lcg.next() % 7u];
+                    op.sizeBytes = lcg.nextLog( 24u, 65536u ) * op.alignment;
+                }
+                else if( kind < 9u )
+                {
+                    op.alignment = (lcg.next() & 1u) ? 2u : 4u;
+                    op.sizeBytes = lcg.nextLog( 36u, 196608u ) * op.alignment;
+                }
+                else
+                {
+                    op.alignment = 256u;
+                    op.sizeBytes = lcg.nextLog( 256u, 65536u );
+                }
+
+                trace.push_back( op );
+                live.push_back( op );
+                liveBytes += op.sizeBytes;
+            }
+        }
+
+        return trace;
+    }
+    //-------------------------------------------------------------------------
+    /// The allocation strategy the VaoManagers used before TlsfSubAllocator: a linear scan
+    /// over an unsorted free list preferring blocks whose offset already matches the
+    /// alignment, padding remembered as "stride changers", and merging by scanning all
+    /// blocks. Kept here as the baseline.
+    class FirstFitAllocator
+    {
+        struct Block
+        {
+            size_t offset;
+            size_t size;
+            Block( size_t _offset, size_t _size ) : offset( _offset ), size( _size ) {}
+        };
+        typedef vector<Block>::type BlockVec;
+        typedef map<size_t, size_t>::type StrideChangerMap;
+
+        BlockVec            mFreeBlocks;
+        StrideChangerMap    mStrideChangers;
+
+        void mergeContiguousBlocks( size_t blockToMerge )
+        {
+            size_t i = 0;
+            while( i < mFreeBlocks.size() )
+            {
+                if( i != blockToMerge &&
+                    mFreeBlocks[i].offset + mFreeBlocks[i].size == mFreeBlocks[blockToMerge].offset )
+                {
+                    mFreeBlocks[i].size += mFreeBlocks[blockToMerge].size;
+                    mFreeBlocks[blockToMerge] = mFreeBlocks.back();
+                    mFreeBlocks.pop_back();
+                    blockToMerge = i == mFreeBlocks.size() ? blockToMerge : i;
+                    i = 0;
+                }
+                else if( i != blockToMerge && mFreeBlocks[blockToMerge].offset +
+                         mFreeBlocks[blockToMerge].size == mFreeBlocks[i].offset )
+                {
+                    mFreeBlocks[blockToMerge].size += mFreeBlocks[i].size;
+                    mFreeBlocks[i] = mFreeBlocks.back();
+                    mFreeBlocks.pop_back();
+                    if( blockToMerge == mFreeBlocks.size() )
+                        blockToMerge = i;
+                    i = 0;
+                }
+                else
+                {
+                    ++i;
+                }
+            }
+        }
+
+    public:
+        void initialize( size_t capacity )
+        {
+            mFreeBlocks.clear();
+            mStrideChangers.clear();
+            mFreeBlocks.push_back( Block( 0, capacity ) );
+        }
+
+        size_t allocate( size_t sizeBytes, size_t alignment )
+        {
+            size_t bestBlockIdx = ~0;
+            bool foundMatchingStride = false;
+
+            for( size_t i=0; i<mFreeBlocks.size() && !foundMatchingStride; ++i )
+            {
+                const Block &block = mFreeBlocks[i];
+                const size_t newOffset = ( (block.offset + alignment - 1) / alignment ) * alignment;
+                const size_t padding = newOffset - block.offset;
+
+                if( sizeBytes + padding <= block.size )
+                {
+                    bestBlockIdx = i;
+                    if( newOffset == block.offset )
+                        foundMatchingStride = true;
+                }
+            }
+
+            if( bestBlockIdx == (size_t)~0 )
+                return TlsfSubAllocator::NoSpace;
+
+            Block &bestBlock = mFreeBlocks[bestBlockIdx];
+            const size_t newOffset = ( (bestBlock.offset + alignment - 1) / alignment ) * alignment;
+            const size_t padding = newOffset - bestBlock.offset;
+            bestBlock.size  -= sizeBytes + padding;
+            bestBlock.offset = newOffset + sizeBytes;
+
+            if( padding )
+                mStrideChangers[newOffset] = padding;
+
+            if( bestBlock.size == 0 )
+            {
+                mFreeBlocks[bestBlockIdx] = mFreeBlocks.back();
+                mFreeBlocks.pop_back();
+            }
+
+            return newOffset;
+        }
+
+        void deallocate( size_t offset, size_t sizeBytes )
+        {
+            StrideChangerMap::iterator itStride = mStrideChangers.find( offset );
+            if( itStride != mStrideChangers.end() )
+            {
+                offset      -= itStride->second;
+                sizeBytes   += itStride->second;
+                mStrideChangers.erase( itStride );
+            }
+
+            mFreeBlocks.push_back( Block( offset, sizeBytes ) );
+            mergeContiguousBlocks( mFreeBlocks.size() - 1u );
+        }
+
+        void getStats( TlsfSubAllocator::Stats &outStats, size_t capacity ) const
+        {
+            outStats = TlsfSubAllocator::Stats();
+            outStats.capacity       = capacity;
+            outStats.numFreeBlocks  = mFreeBlocks.size();
+            for( size_t i=0; i<mFreeBlocks.size(); ++i )
+            {
+                outStats.freeBytes += mFreeBlocks[i].size;
+                outStats.largestFreeBlock = std::max( outStats.largestFreeBlock,
+                                                      mFreeBlocks[i].size );
+            }
+        }
+    };
+    //-------------------------------------------------------------------------
+    struct ReplayResult
+    {
+        unsigned long   microseconds;
+        size_t          numFailed;
+        size_t          peakUsed;
+        TlsfSubAllocator::Stats statsAtEnd;
+    };
+    //-------------------------------------------------------------------------
+    /// Replays the trace. Ops whose allocation failed are skipped when freed.
+    template <typename T>
+    ReplayResult replay( T &allocator, const TraceOpVec &trace, size_t capacity )
+    {
+        ReplayResult result;
+        result.numFailed = 0;
+        result.peakUsed = 0;
+
+        //id -> offset; NoSpace when the allocation failed
+        vector<size_t>::type offsets( trace.size(), TlsfSubAllocator::NoSpace );
+        size_t usedBytes = 0;
+
+        allocator.initialize( capacity );
+
+        Timer timer;
+
+        TraceOpVec::const_iterator itor = trace.begin();
+        TraceOpVec::const_iterator end  = trace.end();
+
+        while( itor != end )
+        {
+            const TraceOp &op = *itor;
+            if( op.allocate )
+            {
+                const size_t offset = allocator.allocate( op.sizeBytes, op.alignment );
+                offsets[op.id] = offset;
+                if( offset == TlsfSubAllocator::NoSpace )
+                {
+                    ++result.numFailed;
+                }
+                else
+                {
+                    usedBytes += op.sizeBytes;
+                    result.peakUsed = std::max( result.peakUsed, usedBytes );
+                }
+            }
+            else if( offsets[op.id] != TlsfSubAllocator::NoSpace )
+            {
+                allocator.deallocate( offsets[op.id], op.sizeBytes );
+                usedBytes -= op.sizeBytes;
+            }
+
+            ++itor;
+        }
+
+        result.microseconds = timer.getMicroseconds();
+
+        return result;
+    }
+    //-------------------------------------------------------------------------
+    void printResult( const char *name, const ReplayResult &result, size_t numOps )
+    {
+        std::cout << name << ": " << result.microseconds << "us ("
+                  << (result.microseconds * 1000.0 / numOps) << "ns/op), "
+                  << result.numFailed << " failed allocations, peak "
+                  << (result.peakUsed >> 20u) << "MB, "
+                  << result.statsAtEnd.numFreeBlocks << " free blocks, largest "
+                  << (result.statsAtEnd.largestFreeBlock >> 10u) << "KB, fragmentation "
+                  << result.statsAtEnd.getFragmentation() << std::endl;
+    }
+    //-------------------------------------------------------------------------
+    void printStats( const char *name, const VaoManager::MemoryStats &stats )
+    {
+        std::cout << "    " << name << ": " << stats.numPools << " pool(s), "
+                  << stats.numAllocations << " allocations, used " << stats.usedBytes
+                  << " / " << stats.capacity << " bytes, peak " << stats.peakUsedBytes
+                  << ", " << stats.numFreeBlocks << " free blocks, fragmentation "
+                  << stats.getFragmentation() << std::endl;
+    }
+    //-------------------------------------------------------------------------
+    void benchmarkVaoManager( VaoManager *vaoManager, size_t numBuffers )
+    {
+        Lcg lcg( 54321u );
+
+        vector<VertexBufferPacked*>::type vertexBuffers;
+        vector<IndexBufferPacked*>::type indexBuffers;
+        vector<ConstBufferPacked*>::type constBuffers;
+
+        VertexElement2Vec vertexElements[3];
+        vertexElements[0].push_back( VertexElement2( VET_FLOAT3, VES_POSITION ) );
+        vertexElements[1].push_back( VertexElement2( VET_FLOAT3, VES_POSITION ) );
+        vertexElements[1].push_back( VertexElement2( VET_FLOAT3, VES_NORMAL ) );
+        vertexElements[1].push_back( VertexElement2( VET_FLOAT2, VES_TEXTURE_COORDINATES ) );
+        vertexElements[2].push_back( VertexElement2( VET_FLOAT4, VES_POSITION ) );
+
+        Timer timer;
+
+        for( size_t i=0; i<numBuffers; ++i )
+        {
+            const uint32 kind = lcg.next() % 3u;
+            if( kind == 0u )
+            {
+                const VertexElement2Vec &elements = vertexElements[lcg.next() % 3u];
+                const size_t numVertices = lcg.nextLog( 24u, 16384u );
+                VertexBufferPacked *vertexBuffer = vaoManager->createVertexBuffer(
+                            elements, numVertices, BT_DEFAULT, 0, false );
+                vertexBuffers.push_back( vertexBuffer );
+            }
+            else if( kind == 1u )
+            {
+                const size_t numIndices = lcg.nextLog( 36u, 65536u );
+                IndexBufferPacked *indexBuffer = vaoManager->createIndexBuffer(
+                            (lcg.next() & 1u) ? IndexBufferPacked::IT_16BIT :
+                                                IndexBufferPacked::IT_32BIT,
+                            numIndices, BT_DEFAULT, 0, false );
+                indexBuffers.push_back( indexBuffer );
+            }
+            else
+            {
+                ConstBufferPacked *constBuffer = vaoManager->createConstBuffer(
+                            lcg.nextLog( 64u, 65536u ), BT_DEFAULT, 0, false );
+                constBuffers.push_back( constBuffer );
+            }
+        }
+
+        //Release every other vertex buffer to leave holes
+        for( size_t i=0; i<vertexBuffers.size(); i += 2u )
+        {
+            vaoManager->destroyVertexBuffer( vertexBuffers[i] );
+            vertexBuffers[i] = 0;
+        }
+
+        const unsigned long createUs = timer.getMicroseconds();
+
+        VaoManager::MemoryStats during;
+        vaoManager->getMemoryStats( BT_DEFAULT, during );
+        VaoManager::MemoryStats immutable;
+        vaoManager->getMemoryStats( BT_IMMUTABLE, immutable );
+        VaoManager::MemoryStats dynamic;
+        vaoManager->getMemoryStats( BT_DYNAMIC_DEFAULT, dynamic );
+
+        std::cout << "NULL VaoManager, " << numBuffers << " buffers created, "
+                  << (vertexBuffers.size() + 1u) / 2u << " destroyed in " << createUs << "us"
+                  << std::endl;
+        printStats( "BT_DEFAULT", during );
+        printStats( "BT_IMMUTABLE", immutable );
+        printStats( "BT_DYNAMIC_DEFAULT", dynamic );
+
+        for( size_t i=0; i<vertexBuffers.size(); ++i )
+        {
+            if( vertexBuffers[i] )
+                vaoManager->destroyVertexBuffer( vertexBuffers[i] );
+        }
+        for( size_t i=0; i<indexBuffers.size(); ++i )
+            vaoManager->destroyIndexBuffer( indexBuffers[i] );
+        for( size_t i=0; i<constBuffers.size(); ++i )
+            vaoManager->destroyConstBuffer( constBuffers[i] );
+
+    }
+}
+
+namespace Benchmarks
+{
+    void runVaoAllocatorBenchmark( const BenchmarkContext &context )
+    {
+        const size_t numOps     = std::max<size_t>( context.getArg( 0, 200000u ), 1u );
+        const size_t poolSizeMB = std::max<size_t>( context.getArg( 1, 128u ), 1u );
+        const size_t numBuffers = context.getArg( 2, 5000u );
+
+        const size_t capacity = poolSizeMB * 1024u * 1024u;
+
+        //Keep the pool ~85% full so that fragmentation matters
+        const TraceOpVec trace = generateTrace( numOps, capacity - capacity / 7u );
+        std::cout << numOps << " operations on a " << poolSizeMB << "MB pool" << std::endl;
+
+        {
+            FirstFitAllocator firstFit;
+            ReplayResult result = replay( firstFit, trace, capacity );
+            firstFit.getStats( result.statsAtEnd, capacity );
+            printResult( "First fit", result, numOps );
+        }
+        {
+            TlsfSubAllocator tlsf;
+            ReplayResult result = replay( tlsf, trace, capacity );
+            tlsf.getStats( result.statsAtEnd );
+            printResult( "TLSF     ", result, numOps );
+        }
+
+        benchmarkVaoManager( context.getVaoManager(), numBuffers );
+    }
+}
@@ -0,0 +1,365 @@
+/*
+    Measures the float -> half and TBN -> QTangent conversion SubMesh::_arrangeEfficient
+    performs when importing v1 meshes (Mesh::importV1) and in Mesh::arrangeEfficient;
+    against the per-vertex conversion it replaced (kept below as the reference).
+
+    Then times converting a multi-SubMesh mesh on the calling thread and through the
+    SceneManager's worker threads.
+    Arguments: [numVertices] [numThreads]
+*/
+
+#include "BenchmarkHarness.h"
+
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgreTimer.h"
+#include "OgreBitwise.h"
+#include "OgreMatrix3.h"
+#include "OgreQuaternion.h"
+
+#include "OgreMesh.h"
+#include "OgreSubMesh.h"
+#include "OgreMeshManager.h"
+#include "OgreHardwareBufferManager.h"
+#include "OgreMesh2.h"
+#include "OgreMeshManager2.h"
+#include "OgreSubMesh2.h"
+
+#include "Vao/OgreVaoManager.h"
+
+#include <iostream>
+
+using namespace Ogre;
+
+namespace
+{
+    /// position, normal, tangent (w = reflection), binormal. uv lives in its own buffer.
+    const size_t c_floatsPerVertex = 3u + 3u + 4u + 3u;
+
+    typedef vector<float>::type FloatVec;
+
+    float randomSigned( uint32 &seed )
+    {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<float>( seed >> 8u ) / 8388608.0f - 1.0f;
+    }
+    //-------------------------------------------------------------------------
+    /// Random positions & orthonormal frames, with axis-aligned normals and
+    /// reflected frames (both by tangent.w and by the binormal) mixed in.
+    void generateVertices( size_t numVertices, uint32 seed, FloatVec &outVertices,
+                           FloatVec &outUvs )
+    {
+        outVertices.resize( numVertices * c_floatsPerVertex );
+        outUvs.resize( numVertices * 2u );
+
+        for( size_t i=0; i<numVertices; ++i )
+        {
+            Vector3 normal( randomSigned( seed ), randomSigned( seed ), randomSigned( seed ) );
+            if( i % 13u == 0 )
+                normal = (i & 1u) ? Vector3::UNIT_Z : Vector3::NEGATIVE_UNIT_Z;
+            else if( i % 17u == 0 )
+                normal = Vector3::NEGATIVE_UNIT_X;
+            normal.normalise();
+
+            Vector3 tangent = Quaternion( Radian( randomSigned( seed ) * Math::PI ), normal ) *
+                              normal.perpendicular();
+            Vector3 binormal = normal.crossProduct( tangent );
+            if( i % 3u == 0 )
+                binormal = -binormal;
+
+            float *dst = &outVertices[i * c_floatsPerVertex];
+            dst[0] = randomSigned( seed ) * 100.0f;
+            dst[1] = randomSigned( seed ) * 100.0f;
+            dst[2] = randomSigned( seed ) * 100.0f;
+            dst[3] = static_cast<float>( normal.x );
+            dst[4] = static_cast<float>( normal.y );
+            dst[5] = static_cast<float>( normal.z );
+            dst[6] = static_cast<float>( tangent.x );
+            dst[7] = static_cast<float>( tangent.y );
+            dst[8] = static_cast<float>( tangent.z );
+            dst[9] = (i % 5u == 0) ? -1.0f : 1.0f;
+            dst[10] = static_cast<float>( binormal.x );
+            dst[11] = static_cast<float>( binormal.y );
+            dst[12] = static_cast<float>( binormal.z );
+
+            outUvs[i * 2u + 0] = randomSigned( seed ) * 4.0f;
+            outUvs[i * 2u + 1] = randomSigned( seed );
+        }
+    }
+    //-------------------------------------------------------------------------
+    /// The per-vertex conversion _arrangeEfficient used to perform, restricted to
+    /// the half4 position, QTangent & half2 uv layout this benchmark converts to.
+    void referenceConversion( const FloatVec &vertices, const FloatVec &uvs, bool hasBinormal,
+                              bool hasTangentW, uint16 *dst )
+    {
+        const size_t numVertices = uvs.size() / 2u;
+
+        for( size_t i=0; i<numVertices; ++i )
+        {
+            const float *src = &vertices[i * c_floatsPerVertex];
+
+            for( size_t j=0; j<3u; ++j )
+                dst[j] = Bitwise::floatToHalf( src[j] );
+            dst[3] = Bitwise::floatToHalf( 1.0f );
+
+            Vector3 vNormal( src[3], src[4], src[5] );
+            Vector3 vTangent( src[6], src[7], src[8] );
+            float reflection = hasTangentW ? src[9] : 1.0f;
+
+            if( hasBinormal )
+            {
+                Vector3 vBinormal( src[10], src[11], src[12] );
+                if( vTangent.crossProduct( vNormal ).dotProduct( vBinormal ) <= 0 )
+                    reflection = -1.0f;
+            }
+
+            Matrix3 tbn;
+            tbn.SetColumn( 0, vNormal );
+            tbn.SetColumn( 1, vTangent );
+            tbn.SetColumn( 2, vNormal.crossProduct( vTangent ) );
+
+            Quaternion qTangent( tbn );
+            qTangent.normalise();
+
+            const Real bias = 1.0f / 32767.0f;
+
+            if( qTangent.w < 0 )
+                qTangent = -qTangent;
+
+            if( qTangent.w < bias )
+            {
+                Real normFactor = Math::Sqrt( 1 - bias * bias );
+                qTangent.w = bias;
+                qTangent.x *= normFactor;
+                qTangent.y *= normFactor;
+                qTangent.z *= normFactor;
+            }
+
+            if( reflection < 0 )
+                qTangent = -qTangent;
+
+            dst[4] = static_cast<uint16>( Bitwise::floatToSnorm16( qTangent.x ) );
+            dst[5] = static_cast<uint16>( Bitwise::floatToSnorm16( qTangent.y ) );
+            dst[6] = static_cast<uint16>( Bitwise::floatToSnorm16( qTangent.z ) );
+            dst[7] = static_cast<uint16>( Bitwise::floatToSnorm16( qTangent.w ) );
+
+            dst[8] = Bitwise::floatToHalf( uvs[i * 2u + 0] );
+            dst[9] = Bitwise::floatToHalf( uvs[i * 2u + 1] );
+
+            dst += 10u;
+        }
+    }
+    //-------------------------------------------------------------------------
+    void benchmarkConversion( const FloatVec &vertices, const FloatVec &uvs, bool hasBinormal,
+                              bool hasTangentW, size_t iterations )
+    {
+        const size_t numVertices = uvs.size() / 2u;
+        const size_t stride = c_floatsPerVertex * sizeof(float);
+        const char *srcVertices = reinterpret_cast<const char*>( &vertices[0] );
+
+        SubMesh::SourceDataArray srcData;
+        srcData.push_back( SubMesh::SourceData( srcVertices, stride,
+                                                VertexElement2( VET_FLOAT3, VES_POSITION ) ) );
+        srcData.push_back( SubMesh::SourceData( srcVertices + sizeof(float) * 3u, stride,
+                                                VertexElement2( VET_FLOAT3, VES_NORMAL ) ) );
+        srcData.push_back( SubMesh::SourceData( reinterpret_cast<const char*>( &uvs[0] ),
+                                                sizeof(float) * 2u,
+                                                VertexElement2( VET_FLOAT2,
+                                                                VES_TEXTURE_COORDINATES ) ) );
+        srcData.push_back( SubMesh::SourceData( srcVertices + sizeof(float) * 6u, stride,
+                                                VertexElement2( hasTangentW ? VET_FLOAT4 :
+                                                                              VET_FLOAT3,
+                                                                VES_TANGENT ) ) );
+        if( hasBinormal )
+        {
+            srcData.push_back( SubMesh::SourceData( srcVertices + sizeof(float) * 10u, stride,
+                                                    VertexElement2( VET_FLOAT3,
+                                                                    VES_BINORMAL ) ) );
+        }
+
+        VertexElement2Vec vertexElements;
+        vertexElements.push_back( VertexElement2( VET_HALF4, VES_POSITION ) );
+        vertexElements.push_back( VertexElement2( VET_SHORT4_SNORM, VES_NORMAL ) );
+        vertexElements.push_back( VertexElement2( VET_HALF2, VES_TEXTURE_COORDINATES ) );
+
+        vector<uint16>::type reference( numVertices * 10u );
+        char *converted = 0;
+
+        Timer timer;
+        unsigned long referenceUs = ~0ul;
+        unsigned long convertedUs = ~0ul;
+
+        for( size_t i=0; i<iterations; ++i )
+        {
+            timer.reset();
+            referenceConversion( vertices, uvs, hasBinormal, hasTangentW, &reference[0] );
+            referenceUs = std::min( referenceUs, timer.getMicroseconds() );
+
+            OGRE_FREE_SIMD( converted, MEMCATEGORY_GEOMETRY );
+            timer.reset();
+            converted = SubMesh::_arrangeEfficient( srcData, vertexElements,
+                                                    static_cast<uint32>( numVertices ) );
+            convertedUs = std::min( convertedUs, timer.getMicroseconds() );
+        }
+
+        OGRE_FREE_SIMD( converted, MEMCATEGORY_GEOMETRY );
+
+        std::cout << (hasTangentW ? "float4" : "float3") << " tangent"
+                  << (hasBinormal ? " + binormal: " : ": ")
+                  << referenceUs << "us per-vertex, " << convertedUs << "us _arrangeEfficient ("
+                  << (referenceUs / std::max( double( convertedUs ), 1.0 )) << "x)" << std::endl;
+    }
+    //-------------------------------------------------------------------------
+    /// A v1 mesh with one SubMesh per element of subMeshSizes; of decreasing size
+    /// so that the worker threads get uneven jobs, and every other one with binormals.
+    v1::MeshPtr createV1Mesh( const vector<size_t>::type &subMeshSizes )
+    {
+        v1::MeshPtr mesh = v1::MeshManager::getSingleton().createManual(
+                    "VertexConversionBenchmarkSource", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME );
+
+        v1::HardwareBufferManager &hwBufferManager = v1::HardwareBufferManager::getSingleton();
+
+        for( size_t i=0; i<subMeshSizes.size(); ++i )
+        {
+            const size_t numVertices = subMeshSizes[i];
+            const bool hasBinormal = (i & 1u) != 0;
+
+            FloatVec vertices, uvs;
+            generateVertices( numVertices, static_cast<uint32>( i + 1u ), vertices, uvs );
+
+            v1::SubMesh *subMesh = mesh->createSubMesh();
+            subMesh->useSharedVertices = false;
+            subMesh->setMaterialName( "BaseWhite" );
+
+            v1::VertexData *vertexData = OGRE_NEW v1::VertexData();
+            vertexData->vertexCount = numVertices;
+            subMesh->vertexData[VpNormal] = vertexData;
+
+            v1::VertexDeclaration *decl = vertexData->vertexDeclaration;
+            size_t offset = 0;
+            offset += decl->addElement( 0, offset, VET_FLOAT3, VES_POSITION ).getSize();
+            offset += decl->addElement( 0, offset, VET_FLOAT3, VES_NORMAL ).getSize();
+            offset += decl->addElement( 0, offset, VET_FLOAT4, VES_TANGENT ).getSize();
+            if( hasBinormal )
+                offset += decl->addElement( 0, offset, VET_FLOAT3, VES_BINORMAL ).getSize();
+            decl->addElement( 1, 0, VET_FLOAT2, VES_TEXTURE_COORDINATES );
+
+            v1::HardwareVertexBufferSharedPtr vertexBuffer = hwBufferManager.createVertexBuffer(
+                        offset, numVertices, v1::HardwareBuffer::HBU_STATIC_WRITE_ONLY );
+            char *dst = static_cast<char*>( vertexBuffer->lock(
+                                                v1::HardwareBuffer::HBL_DISCARD ) );
+            for( size_t j=0; j<numVertices; ++j )
+                memcpy( dst + j * offset, &vertices[j * c_floatsPerVertex], offset );
+            vertexBuffer->unlock();
+
+            v1::HardwareVertexBufferSharedPtr uvBuffer = hwBufferManager.createVertexBuffer(
+                        sizeof(float) * 2u, numVertices, v1::HardwareBuffer::HBU_STATIC_WRITE_ONLY );
+            uvBuffer->writeData( 0, uvBuffer->getSizeInBytes(), &uvs[0], true );
+
+            vertexData->vertexBufferBinding->setBinding( 0, vertexBuffer );
+            vertexData->vertexBufferBinding->setBinding( 1, uvBuffer );
+
+            v1::IndexData *indexData = OGRE_NEW v1::IndexData();
+            indexData->indexCount = (numVertices / 3u) * 3u;
+            indexData->indexBuffer = hwBufferManager.createIndexBuffer(
+                        v1::HardwareIndexBuffer::IT_32BIT, indexData->indexCount,
+                        v1::HardwareBuffer::HBU_STATIC_WRITE_ONLY );
+            uint32 *indices = static_cast<uint32*>( indexData->indexBuffer->lock(
+                                                        v1::HardwareBuffer::HBL_DISCARD ) );
+            for( size_t j=0; j<indexData->indexCount; ++j )
+                indices[j] = static_cast<uint32>( j );
+            indexData->indexBuffer->unlock();
+            subMesh->indexData[VpNormal] = indexData;
+        }
+
+        mesh->_setBounds( AxisAlignedBox( -100, -100, -100, 100, 100, 100 ), false );
+        mesh->_setBoundingSphereRadius( 174 );
+        mesh->prepareForShadowMapping( false );
+
+        return mesh;
+    }
+    //-------------------------------------------------------------------------
+    MeshPtr importMesh( const v1::MeshPtr &v1Mesh, const String &name, bool efficient,
+                        SceneManager *sceneManager, unsigned long &outMicroseconds )
+    {
+        MeshPtr mesh = MeshManager::getSingleton().createManual(
+                    name, ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME );
+        mesh->setVertexBufferPolicy( BT_IMMUTABLE, true );
+        mesh->setIndexBufferPolicy( BT_IMMUTABLE, false );
+
+        Timer timer;
+        mesh->importV1( v1Mesh.get(), efficient, efficient, efficient, sceneManager );
+        outMicroseconds = timer.getMicroseconds();
+
+        return mesh;
+    }
+    //-------------------------------------------------------------------------
+    void benchmarkThreadedImport( SceneManager *sceneManager, size_t numVertices, size_t numThreads )
+    {
+        //One big SubMesh and many small ones.
+        vector<size_t>::type subMeshSizes;
+        subMeshSizes.push_back( numVertices );
+        for( size_t i=0; i<15u; ++i )
+            subMeshSizes.push_back( std::max<size_t>( numVertices / (i + 2u), 3u ) );
+
+        v1::MeshPtr v1Mesh = createV1Mesh( subMeshSizes );
+
+        unsigned long serialUs, threadedUs, dummyUs;
+        MeshPtr serial = importMesh( v1Mesh, "VertexConversionBenchmark_Serial", true, 0, serialUs );
+        MeshPtr threaded = importMesh( v1Mesh, "VertexConversionBenchmark_Threaded", true,
+                                       sceneManager, threadedUs );
+
+        std::cout << "Mesh::importV1 of " << subMeshSizes.size() << " SubMeshes: " << serialUs
+                  << "us serial, " << threadedUs << "us with " << numThreads << " threads"
+                  << std::endl;
+
+        //Same with arrangeEfficient on already imported, 32-bit float meshes.
+        MeshPtr serialArranged = importMesh( v1Mesh, "VertexConversionBenchmark_SerialArranged", false,
+                                             0, dummyUs );
+        MeshPtr threadedArranged = importMesh( v1Mesh, "VertexConversionBenchmark_ThreadedArranged",
+                                               false, 0, dummyUs );
+
+        Timer timer;
+        serialArranged->arrangeEfficient( true, true, true );
+        serialUs = timer.getMicroseconds();
+        timer.reset();
+        threadedArranged->arrangeEfficient( true, true, true, sceneManager );
+        threadedUs = timer.getMicroseconds();
+
+        std::cout << "Mesh::arrangeEfficient: " << serialUs << "us serial, " << threadedUs
+                  << "us threaded" << std::endl;
+
+        MeshManager::getSingleton().remove( serial->getHandle() );
+        MeshManager::getSingleton().remove( threaded->getHandle() );
+        MeshManager::getSingleton().remove( serialArranged->getHandle() );
+        MeshManager::getSingleton().remove( threadedArranged->getHandle() );
+        v1::MeshManager::getSingleton().remove( v1Mesh->getHandle() );
+    }
+}
+
+namespace Benchmarks
+{
+    void runVertexConversionBenchmark( const BenchmarkContext &context )
+    {
+        const size_t numVertices = std::max<size_t>( context.getArg( 0, 200000u ), 16u );
+        const size_t numThreads  = std::max<size_t>( context.getArg( 1, 4u ), 1u );
+
+        {
+            FloatVec vertices, uvs;
+            generateVertices( numVertices, 1u, vertices, uvs );
+
+            std::cout << numVertices << " vertices" << std::endl;
+            benchmarkConversion( vertices, uvs, false, true, 5u );
+            benchmarkConversion( vertices, uvs, false, false, 5u );
+            benchmarkConversion( vertices, uvs, true, true, 5u );
+        }
+
+        SceneManager *sceneManager = context.root->createSceneManager(
+                    ST_GENERIC, numThreads,
+                    numThreads > 1u ? INSTANCING_CULLING_THREADED : INSTANCING_CULLING_SINGLETHREAD );
+
+        benchmarkThreadedImport( sceneManager, numVertices, numThreads );
+
+        context.root->destroySceneManager( sceneManager );
+    }
+}
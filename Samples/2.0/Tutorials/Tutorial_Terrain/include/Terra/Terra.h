@@ -23,6 +23,9 @@ namespace Ogre
     };
 
     class ShadowMapper;
+    class TerraPageProvider;
+    class TerraPager;
+    struct TerraPage;
 
     class Terra : public MovableObject
     {
@@ -53,6 +56,14 @@ namespace Ogre
         Vector3             m_prevLightDir;
         ShadowMapper        *m_shadowMapper;
 
+        /// Null unless loaded via loadPaged.
+        TerraPager              *m_pager;
+        /// Lowest TerraPage::skirtHeight among the pages uploaded so far.
+        float                   m_pagedSkirtHeight;
+        std::vector<TerraPage*> m_pageUploads;
+        /// Regions of the heightmap that changed this frame, in texels.
+        std::vector<Box>        m_dirtyBoxes;
+
         //Ogre stuff
         CompositorManager2      *m_compositorManager;
         Camera                  *m_camera;
@@ -69,6 +80,19 @@ namespace Ogre
         void createNormalTexture(void);
         void destroyNormalTexture(void);
 
+        /// Creates empty (flat) textures to be filled by the pager.
+        void createPagedHeightmap( uint32 width, uint32 depth );
+
+        /// Blits the pages' heights and normals, and tracks the dirty regions & skirt size.
+        void uploadPages( const std::vector<TerraPage*> &pages );
+
+        /// Streams pages around the camera. Fills m_dirtyBoxes.
+        void updatePaging(void);
+
+        void createTerrainCells(void);
+
+        inline float getHeightRaw( const TerraPage *page, uint32 x, uint32 z ) const;
+
         ///	Automatically calculates the optimum skirt size (no gaps with
         /// lowest overdraw possible).
         ///	This is done by taking the heighest delta between two adjacent
@@ -113,13 +137,35 @@ namespace Ogre
         void load( const String &texName, const Vector3 center, const Vector3 &dimensions );
         void load( Image &image, const Vector3 center, const Vector3 &dimensions, const String &imageName = BLANKSTRING );
 
+        /** Loads a terrain whose heightmap gets streamed in pages around the camera, instead
+            of being loaded all at once. See TerraPager.
+        @remarks
+            The textures are created flat and filled as pages arrive, a few per frame. Only
+            the shadows of the lines of sight crossing the new pages are recalculated.
+            Until every page has been seen at least once, the skirts go all the way down to 0.
+        @param provider
+            Supplies the heights. Must outlive this Terra, or the next call to load/loadPaged.
+        @param width
+            Width of the whole heightmap, in texels. Up to 4096 (a limit of the ShadowMapper).
+        @param depth
+            Depth of the whole heightmap, in texels. Up to 4096.
+        @param pageResolution
+            Size of each page, in texels.
+        @param numWorkerThreads
+            Number of background threads loading pages.
+        */
+        void loadPaged( TerraPageProvider *provider, uint32 width, uint32 depth,
+                        uint32 pageResolution, const Vector3 center, const Vector3 &dimensions,
+                        uint32 numWorkerThreads=2u );
+
         /** Gets the interpolated height at the given location.
             If outside the bounds, it leaves the height untouched.
         @param vPos
             [in] XZ position, Y for default height.
             [out] Y height, or default Y (from input) if outside terrain bounds.
         @return
-            True if Y component was changed
+            True if Y component was changed.
+            When paged, false is also returned where the page isn't loaded in CPU memory.
         */
         bool getHeightAt( Vector3 &vPos ) const;
 
@@ -134,6 +180,9 @@ namespace Ogre
 
         const ShadowMapper* getShadowMapper(void) const { return m_shadowMapper; }
 
+        /// Null unless loaded via loadPaged. Use it to tweak the streaming radius & upload budget.
+        TerraPager* getPager(void) const                { return m_pager; }
+
         Ogre::TexturePtr getHeightMapTex(void) const    { return m_heightMapTex; }
         Ogre::TexturePtr getNormalMapTex(void) const    { return m_normalMapTex; }
         Ogre::TexturePtr _getShadowMapTex(void) const;
@@ -0,0 +1,219 @@
+
+#ifndef _OgreTerraPager_H_
+#define _OgreTerraPager_H_
+
+#include "OgrePrerequisites.h"
+#include "OgreVector3.h"
+
+#include "Threading/OgreLightweightMutex.h"
+#include "Threading/OgreSemaphore.h"
+#include "Threading/OgreThreads.h"
+
+#include <deque>
+
+namespace Ogre
+{
+    /** Supplies the heightmap of a paged Terra, one rectangle at a time.
+        See Terra::loadPaged.
+    @remarks
+        loadPage gets called from the pager's worker threads, possibly from several
+        of them at the same time. Implementations must be thread safe.
+    */
+    class TerraPageProvider
+    {
+    public:
+        virtual ~TerraPageProvider() {}
+
+        /** Fills the heights of a rectangle of the heightmap.
+            The rectangle is always fully inside the heightmap.
+        @param startX
+            First column, in texels.
+        @param startZ
+            First row, in texels.
+        @param outHeights
+            width * depth heights in range [0; 1], row by row.
+        */
+        virtual void loadPage( uint32 startX, uint32 startZ, uint32 width, uint32 depth,
+                               float *outHeights ) = 0;
+    };
+
+    /// Serves pages out of a grayscale Image that is already in memory.
+    /// Useful for testing paging with the same heightmaps Terra::load accepts.
+    class ImageTerraPageProvider : public TerraPageProvider
+    {
+        const Image *m_image;
+
+    public:
+        /// The image must outlive the provider.
+        ImageTerraPageProvider( const Image *image );
+
+        virtual void loadPage( uint32 startX, uint32 startZ, uint32 width, uint32 depth,
+                               float *outHeights );
+    };
+
+    struct TerraPage
+    {
+        uint32  pageX;
+        uint32  pageZ;
+
+        /// Region of the heightmap covered by this page, in texels.
+        uint32  startX;
+        uint32  startZ;
+        uint32  width;
+        uint32  depth;
+
+        /// Region held by 'heights'. It's one texel bigger than the page on each side (unless
+        /// clamped by the edges of the heightmap) so the normals and getHeightAt can read the
+        /// neighbours of the page's texels.
+        uint32  apronX;
+        uint32  apronZ;
+        uint32  apronWidth;
+        uint32  apronDepth;
+
+        /// Heights in world units (i.e. already multiplied by the terrain's height).
+        std::vector<float>  heights;
+
+        /// Data to blit to the heightmap (PF_L16) and normal map (PF_A2B10G10R10)
+        /// textures. Empty if the GPU already has this page.
+        std::vector<uint16> heightTexels;
+        std::vector<uint32> normalTexels;
+
+        /// Lowest height in range [0; 1] across the borders between LOD cells that go through
+        /// this page. std::numeric_limits<float>::max() if no border needs a skirt.
+        float   skirtHeight;
+
+        bool    needsGpuUpload;
+
+        inline float getHeight( uint32 x, uint32 z ) const
+        {
+            return heights[(z - apronZ) * apronWidth + (x - apronX)];
+        }
+    };
+
+    /** Streams the heightmap of a paged Terra in and out of CPU memory around the camera.
+    @remarks
+        Pages get loaded by background threads which also calculate their normals and skirt
+        size. The main thread picks up a limited number of finished pages per frame (see
+        setMaxUploadsPerFrame) which Terra then blits to its textures.
+    @par
+        Only the CPU copy (used by Terra::getHeightAt) gets evicted. Once uploaded, a page
+        stays in the GPU textures, thus coming back to an area only costs a CPU reload.
+    @par
+        Not done yet, left for a follow-up: moving Terra and the pager out of this sample
+        into a component, and paging the GPU textures too (i.e. a tile cache smaller than
+        the whole heightmap) so that terrains bigger than the GPU memory can be streamed.
+    */
+    class TerraPager
+    {
+        enum PageState
+        {
+            PageUnloaded,
+            PageLoading,
+            PageResident
+        };
+
+        TerraPageProvider   *m_provider;
+
+        uint32  m_width;
+        uint32  m_depth;
+        uint32  m_pageResolution;
+        uint32  m_numPagesX;
+        uint32  m_numPagesZ;
+        uint32  m_basePixelDimension;
+        uint32  m_vertPixelDimension;
+        float   m_height;
+        /// See Terra::createNormalTexture
+        Vector3 m_vScale;
+
+        uint32  m_loadRadius;
+        uint32  m_unloadRadius;
+        uint32  m_maxUploadsPerFrame;
+
+        /// Main thread only. Null unless the page is resident.
+        std::vector<TerraPage*> m_pages;
+        std::vector<uint8>      m_pageStates;
+        /// Main thread only. True if the page was uploaded to the GPU at some point.
+        std::vector<bool>       m_pageOnGpu;
+        size_t                  m_numPagesOnGpu;
+
+        /// Protects m_pendingPages, m_readyPages & m_stopWorkers.
+        LightweightMutex        m_mutex;
+        std::deque<TerraPage*>  m_pendingPages;
+        std::vector<TerraPage*> m_readyPages;
+        bool                    m_stopWorkers;
+        /// Signalled once per page added to m_pendingPages, and once per worker when stopping.
+        /// Can count more than m_pendingPages holds, as update drops stale requests.
+        Semaphore               m_workAvailable;
+        ThreadHandleVec         m_workerThreads;
+
+        /// Runs in the worker threads
+        void generatePage( TerraPage *page ) const;
+        void calculateSkirtHeight( TerraPage *page ) const;
+        void calculateNormals( TerraPage *page ) const;
+
+        void requestPage( uint32 pageX, uint32 pageZ, std::vector<TerraPage*> &outRequests );
+
+    public:
+        /**
+        @param width
+            Width of the whole heightmap, in texels.
+        @param depth
+            Depth of the whole heightmap, in texels.
+        @param vScale
+            Normalized ( xzRelativeSize.x, height, xzRelativeSize.y ). Used for the normals.
+        @param numWorkerThreads
+            Number of background threads. Must be at least 1.
+        */
+        TerraPager( TerraPageProvider *provider, uint32 width, uint32 depth,
+                    uint32 pageResolution, uint32 basePixelDimension, uint32 vertPixelDimension,
+                    float height, const Vector3 &vScale, uint32 numWorkerThreads );
+        ~TerraPager();
+
+        /** Pages within loadRadius pages of the camera's page get loaded. Resident pages
+            farther than unloadRadius get evicted from CPU memory.
+            unloadRadius is clamped to be at least loadRadius.
+        */
+        void setStreamingRadius( uint32 loadRadius, uint32 unloadRadius );
+        uint32 getLoadRadius(void) const                        { return m_loadRadius; }
+        uint32 getUnloadRadius(void) const                      { return m_unloadRadius; }
+
+        /// Maximum number of pages handed out per update for uploading to the GPU. Pages
+        /// the GPU already has are free and not counted. Must be at least 1.
+        void setMaxUploadsPerFrame( uint32 maxUploadsPerFrame );
+        uint32 getMaxUploadsPerFrame(void) const                { return m_maxUploadsPerFrame; }
+
+        /** Requests the pages around the camera, evicts the distant ones, and collects the
+            pages the workers have finished.
+        @param cameraPageX
+            Page the camera is in. May be outside the heightmap.
+        @param cameraPageZ
+            Page the camera is in. May be outside the heightmap.
+        @param outUploads
+            [out] Pages that just became resident whose texel data must be uploaded.
+            Call _notifyUploaded once they have been.
+        */
+        void update( int32 cameraPageX, int32 cameraPageZ, std::vector<TerraPage*> &outUploads );
+
+        /// Call once the pages returned by update have been uploaded, to free their texel data.
+        void _notifyUploaded( const std::vector<TerraPage*> &uploadedPages );
+
+        /// Returns the resident page containing the given texel. Null if it isn't resident.
+        const TerraPage* getResidentPage( uint32 x, uint32 z ) const;
+
+        uint32 getPageResolution(void) const                    { return m_pageResolution; }
+        uint32 getNumPagesX(void) const                         { return m_numPagesX; }
+        uint32 getNumPagesZ(void) const                         { return m_numPagesZ; }
+
+        /// Number of pages requested but not yet made resident by update.
+        size_t getNumLoadingPages(void) const;
+        size_t getNumResidentPages(void) const;
+
+        /// True once every page has been uploaded to the GPU at least once.
+        bool areAllPagesOnGpu(void) const           { return m_numPagesOnGpu == m_pageOnGpu.size(); }
+
+        /// Internal use.
+        void _workerThread(void);
+    };
+}
+
+#endif
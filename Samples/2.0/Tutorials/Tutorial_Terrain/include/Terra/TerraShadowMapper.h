@@ -64,6 +64,24 @@ namespace Ogre
         */
         static inline float getErrorAfterXsteps( uint32 xIterationsToSkip, float dx, float dy );
 
+        /** All Bresenham lines are parallel. Projects a texel onto the axis perpendicular to
+            them, so that lines can be told apart by a single value: thread 'j' of the "first"
+            thread groups walks the line at position 'j', while the "last" thread groups walk
+            lines at negative positions.
+        @param x
+            Position along the major axis (i.e. already swapped if the line is steep)
+        @param y
+            Position along the minor axis.
+        @param slope
+            dy / dx
+        */
+        static inline float getLinePosition( float x, float y, float x0, float y0,
+                                             const int32 xyStep[2], float slope );
+
+        /// Returns true if the lines in range [linePosMin; linePosMax] may cross any of the boxes.
+        static bool linesCrossBoxes( float linePosMin, float linePosMax,
+                                     const std::vector<Vector2> &boxesLinePosRange );
+
         static void setGaussianFilterParams( HlmsComputeJob *job, uint8 kernelRadius,
                                              float gaussianDeviationFactor=0.5f );
 
@@ -81,7 +99,15 @@ namespace Ogre
 
         void createShadowMap( IdType id, TexturePtr &heightMapTex );
         void destroyShadowMap(void);
-        void updateShadowMap( const Vector3 &lightDir, const Vector2 &xzDimensions, float heightScale );
+        /** Recalculates the shadow map.
+        @param dirtyBoxes
+            When not null, only the lines of sight that cross these regions of the heightmap
+            (in texels) are traced again; the rest of the shadow map keeps its previous contents.
+            Use it when parts of the heightmap changed but the light did not.
+            When null, the whole shadow map is recalculated.
+        */
+        void updateShadowMap( const Vector3 &lightDir, const Vector2 &xzDimensions, float heightScale,
+                              const std::vector<Box> *dirtyBoxes=0 );
 
         void fillUavDataForCompositorChannel( CompositorChannel &outChannel,
                                               ResourceLayoutMap &outInitialLayouts,
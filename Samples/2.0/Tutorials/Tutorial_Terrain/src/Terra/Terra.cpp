@@ -1,6 +1,7 @@
 
 #include "Terra/Terra.h"
 #include "Terra/TerraShadowMapper.h"
+#include "Terra/TerraPager.h"
 
 #include "OgreImage.h"
 #include "OgreTextureManager.h"
@@ -36,6 +37,8 @@ namespace Ogre
         m_currentCell( 0u ),
         m_prevLightDir( Vector3::ZERO ),
         m_shadowMapper( 0 ),
+        m_pager( 0 ),
+        m_pagedSkirtHeight( std::numeric_limits<float>::max() ),
         m_compositorManager( compositorManager ),
         m_camera( camera )
     {
@@ -43,6 +46,9 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     Terra::~Terra()
     {
+        delete m_pager;
+        m_pager = 0;
+
         if( m_shadowMapper )
         {
             m_shadowMapper->destroyShadowMap();
@@ -217,6 +223,110 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    void Terra::createPagedHeightmap( uint32 width, uint32 depth )
+    {
+        m_width = width;
+        m_depth = depth;
+        m_depthWidthRatio = m_depth / (float)(m_width);
+        m_invWidth = 1.0f / m_width;
+        m_invDepth = 1.0f / m_depth;
+
+        m_heightMap.clear();
+
+        destroyHeightmapTexture();
+        m_heightMapTex = TextureManager::getSingleton().createManual(
+                    "HeightMapTex" + StringConverter::toString( getId() ),
+                    Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
+                    TEX_TYPE_2D, m_width, m_depth, 0, PF_L16, TU_STATIC_WRITE_ONLY );
+
+        {
+            v1::HardwarePixelBufferSharedPtr pixelBufferBuf = m_heightMapTex->getBuffer(0, 0);
+            const PixelBox &currImage = pixelBufferBuf->lock( Box( 0, 0,
+                                                                   pixelBufferBuf->getWidth(),
+                                                                   pixelBufferBuf->getHeight() ),
+                                                              v1::HardwareBuffer::HBL_DISCARD );
+            uint8 *data = reinterpret_cast<uint8*>( currImage.data );
+            for( uint32 y=0; y<m_depth; ++y )
+                memset( data + y * currImage.rowPitch * sizeof(uint16), 0, m_width * sizeof(uint16) );
+            pixelBufferBuf->unlock();
+        }
+
+        m_xzRelativeSize = m_xzDimensions / Vector2( static_cast<Real>(m_width),
+                                                     static_cast<Real>(m_depth) );
+
+        //Flat normals, until the pages arrive
+        createNormalTexture();
+
+        delete m_shadowMapper;
+        m_shadowMapper = new ShadowMapper( mManager, m_compositorManager );
+        m_shadowMapper->createShadowMap( getId(), m_heightMapTex );
+
+        //Everything's at height 0 until the pages arrive.
+        m_skirtSize = 0.0f;
+        m_pagedSkirtHeight = std::numeric_limits<float>::max();
+    }
+    //-----------------------------------------------------------------------------------
+    void Terra::uploadPages( const std::vector<TerraPage*> &pages )
+    {
+        v1::HardwarePixelBufferSharedPtr heightMapBuf = m_heightMapTex->getBuffer( 0, 0 );
+        v1::HardwarePixelBufferSharedPtr normalMapBuf = m_normalMapTex->getBuffer( 0, 0 );
+
+        std::vector<TerraPage*>::const_iterator itor = pages.begin();
+        std::vector<TerraPage*>::const_iterator end  = pages.end();
+
+        while( itor != end )
+        {
+            TerraPage *page = *itor;
+
+            const Box dstBox( page->startX, page->startZ,
+                              page->startX + page->width, page->startZ + page->depth );
+
+            const PixelBox heightBox( page->width, page->depth, 1u, PF_L16,
+                                      &page->heightTexels[0] );
+            heightMapBuf->blitFromMemory( heightBox, dstBox );
+
+            const PixelBox normalBox( page->width, page->depth, 1u, PF_A2B10G10R10,
+                                      &page->normalTexels[0] );
+            normalMapBuf->blitFromMemory( normalBox, dstBox );
+
+            m_pagedSkirtHeight = Ogre::min( page->skirtHeight, m_pagedSkirtHeight );
+            m_dirtyBoxes.push_back( dstBox );
+
+            ++itor;
+        }
+
+        m_normalMapTex->_autogenerateMipmaps();
+
+        //Borders next to pages that are still flat on the GPU need skirts all the way down.
+        m_skirtSize = m_pager->areAllPagesOnGpu() ? m_pagedSkirtHeight : 0.0f;
+    }
+    //-----------------------------------------------------------------------------------
+    void Terra::updatePaging(void)
+    {
+        m_dirtyBoxes.clear();
+
+        const Vector3 camPos = m_camera->getDerivedPosition();
+        const float fPageResolution = static_cast<float>( m_pager->getPageResolution() );
+
+        const float fPageX = floorf( ((camPos.x - m_terrainOrigin.x) * m_xzInvDimensions.x) *
+                                     m_width / fPageResolution );
+        const float fPageZ = floorf( ((camPos.z - m_terrainOrigin.z) * m_xzInvDimensions.y) *
+                                     m_depth / fPageResolution );
+        //Clamp to avoid overflowing when the camera is very far away
+        const int32 cameraPageX = static_cast<int32>( Math::Clamp( fPageX, -65536.0f, 65536.0f ) );
+        const int32 cameraPageZ = static_cast<int32>( Math::Clamp( fPageZ, -65536.0f, 65536.0f ) );
+
+        m_pageUploads.clear();
+        m_pager->update( cameraPageX, cameraPageZ, m_pageUploads );
+
+        if( !m_pageUploads.empty() )
+        {
+            uploadPages( m_pageUploads );
+            m_pager->_notifyUploaded( m_pageUploads );
+            m_pageUploads.clear();
+        }
+    }
+    //-----------------------------------------------------------------------------------
     void Terra::calculateOptimumSkirtSize(void)
     {
         m_skirtSize = std::numeric_limits<float>::max();
@@ -376,6 +486,9 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void Terra::update( const Vector3 &lightDir, float lightEpsilon )
     {
+        if( m_pager )
+            updatePaging();
+
         const float lightCosAngleChange = Math::Clamp(
                     (float)m_prevLightDir.dotProduct( lightDir.normalisedCopy() ), -1.0f, 1.0f );
         if( lightCosAngleChange <= (1.0f - lightEpsilon) )
@@ -383,6 +496,12 @@ namespace Ogre
             m_shadowMapper->updateShadowMap( lightDir, m_xzDimensions, m_height );
             m_prevLightDir = lightDir.normalisedCopy();
         }
+        else if( !m_dirtyBoxes.empty() )
+        {
+            //The light didn't change, but some pages did.
+            m_shadowMapper->updateShadowMap( m_prevLightDir, m_xzDimensions, m_height,
+                                             &m_dirtyBoxes );
+        }
         //m_shadowMapper->updateShadowMap( Vector3::UNIT_X, m_xzDimensions, m_height );
         //m_shadowMapper->updateShadowMap( Vector3(2048,0,1024), m_xzDimensions, m_height );
         //m_shadowMapper->updateShadowMap( Vector3(1,0,0.1), m_xzDimensions, m_height );
@@ -510,6 +629,10 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void Terra::load( Image &image, const Vector3 center, const Vector3 &dimensions, const String &imageName )
     {
+        delete m_pager;
+        m_pager = 0;
+        m_dirtyBoxes.clear();
+
         m_terrainOrigin = center - dimensions * 0.5f;
         m_xzDimensions = Vector2( dimensions.x, dimensions.z );
         m_xzInvDimensions = 1.0f / m_xzDimensions;
@@ -517,6 +640,45 @@ namespace Ogre
         m_basePixelDimension = 64u;
         createHeightmap( image, imageName );
 
+        createTerrainCells();
+    }
+    //-----------------------------------------------------------------------------------
+    void Terra::loadPaged( TerraPageProvider *provider, uint32 width, uint32 depth,
+                           uint32 pageResolution, const Vector3 center, const Vector3 &dimensions,
+                           uint32 numWorkerThreads )
+    {
+        if( width > 4096u || depth > 4096u || !pageResolution || !numWorkerThreads )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Heightmap must be up to 4096x4096, and pageResolution & "
+                         "numWorkerThreads can't be 0",
+                         "Terra::loadPaged" );
+        }
+
+        delete m_pager;
+        m_pager = 0;
+        m_dirtyBoxes.clear();
+
+        m_terrainOrigin = center - dimensions * 0.5f;
+        m_xzDimensions = Vector2( dimensions.x, dimensions.z );
+        m_xzInvDimensions = 1.0f / m_xzDimensions;
+        m_height = dimensions.y;
+        m_basePixelDimension = 64u;
+        createPagedHeightmap( width, depth );
+
+        const uint32 vertPixelDimension = static_cast<uint32>( m_basePixelDimension *
+                                                               m_depthWidthRatio );
+        const Vector3 vScale = Vector3( m_xzRelativeSize.x, m_height,
+                                        m_xzRelativeSize.y ).normalisedCopy();
+        m_pager = new TerraPager( provider, m_width, m_depth, pageResolution,
+                                  m_basePixelDimension, vertPixelDimension,
+                                  m_height, vScale, numWorkerThreads );
+
+        createTerrainCells();
+    }
+    //-----------------------------------------------------------------------------------
+    void Terra::createTerrainCells(void)
+    {
         {
             //Find out how many TerrainCells we need. I think this might be
             //solved analitically with a power series. But my math is rusty.
@@ -557,12 +719,24 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    inline float Terra::getHeightRaw( const TerraPage *page, uint32 x, uint32 z ) const
+    {
+        return page ? page->getHeight( x, z ) : m_heightMap[z * m_width + x];
+    }
+    //-----------------------------------------------------------------------------------
     bool Terra::getHeightAt( Vector3 &vPos ) const
     {
         bool retVal = false;
         GridPoint pos2D = worldToGrid( vPos );
 
-        if( pos2D.x < m_width-1 && pos2D.z < m_depth-1 )
+        const bool insideTerrain = pos2D.x < m_width-1 && pos2D.z < m_depth-1;
+
+        //When paged, the page also holds the neighbours at x+1 & z+1 (see TerraPage::heights).
+        const TerraPage *page = 0;
+        if( m_pager && insideTerrain )
+            page = m_pager->getResidentPage( pos2D.x, pos2D.z );
+
+        if( insideTerrain && (!m_pager || page) )
         {
             const Vector2 vPos2D = gridToWorld( pos2D );
 
@@ -570,8 +744,8 @@ namespace Ogre
             const float dz = (vPos.z - vPos2D.y) * m_depth * m_xzInvDimensions.y;
 
             float a, b, c;
-            const float h00 = m_heightMap[ pos2D.z * m_width + pos2D.x ];
-            const float h11 = m_heightMap[ (pos2D.z+1) * m_width + pos2D.x + 1 ];
+            const float h00 = getHeightRaw( page, pos2D.x, pos2D.z );
+            const float h11 = getHeightRaw( page, pos2D.x + 1, pos2D.z + 1 );
 
             c = h00;
             if( dx < dz )
@@ -580,7 +754,7 @@ namespace Ogre
                 //x=0 z=0 -> c		= h00
                 //x=0 z=1 -> b + c	= h01 -> b = h01 - c
                 //x=1 z=1 -> a + b + c  = h11 -> a = h11 - b - c
-                const float h01 = m_heightMap[ (pos2D.z+1) * m_width + pos2D.x ];
+                const float h01 = getHeightRaw( page, pos2D.x, pos2D.z + 1 );
 
                 b = h01 - c;
                 a = h11 - b - c;
@@ -591,7 +765,7 @@ namespace Ogre
                 //x=0 z=0 -> c		= h00
                 //x=1 z=0 -> a + c	= h10 -> a = h10 - c
                 //x=1 z=1 -> a + b + c  = h11 -> b = h11 - a - c
-                const float h10 = m_heightMap[ pos2D.z * m_width + pos2D.x + 1 ];
+                const float h10 = getHeightRaw( page, pos2D.x + 1, pos2D.z );
 
                 a = h10 - c;
                 b = h11 - a - c;
@@ -0,0 +1,493 @@
+
+#include "Terra/TerraPager.h"
+
+#include "OgreImage.h"
+#include "OgrePixelFormat.h"
+
+namespace Ogre
+{
+    ImageTerraPageProvider::ImageTerraPageProvider( const Image *image ) :
+        m_image( image )
+    {
+        if( PixelUtil::getComponentCount( image->getFormat() ) != 1 ||
+            (image->getBPP() != 8 && image->getBPP() != 16 && image->getFormat() != PF_FLOAT32_R) )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Image must be grayscale and 8 bpp, 16 bpp, or 32-bit Float",
+                         "ImageTerraPageProvider::ImageTerraPageProvider" );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void ImageTerraPageProvider::loadPage( uint32 startX, uint32 startZ, uint32 width, uint32 depth,
+                                           float *outHeights )
+    {
+        const uint32 imageWidth = m_image->getWidth();
+
+        if( m_image->getBPP() == 8 )
+        {
+            const float invMaxValue = 1.0f / 255.0f;
+            const uint8 * RESTRICT_ALIAS data = reinterpret_cast<const uint8*RESTRICT_ALIAS>(
+                                                                                m_image->getData());
+            for( uint32 z=0; z<depth; ++z )
+            {
+                for( uint32 x=0; x<width; ++x )
+                    *outHeights++ = data[(startZ + z) * imageWidth + startX + x] * invMaxValue;
+            }
+        }
+        else if( m_image->getBPP() == 16 )
+        {
+            const float invMaxValue = 1.0f / 65535.0f;
+            const uint16 * RESTRICT_ALIAS data = reinterpret_cast<const uint16*RESTRICT_ALIAS>(
+                                                                                m_image->getData());
+            for( uint32 z=0; z<depth; ++z )
+            {
+                for( uint32 x=0; x<width; ++x )
+                    *outHeights++ = data[(startZ + z) * imageWidth + startX + x] * invMaxValue;
+            }
+        }
+        else
+        {
+            const float * RESTRICT_ALIAS data = reinterpret_cast<const float*RESTRICT_ALIAS>(
+                                                                                m_image->getData());
+            for( uint32 z=0; z<depth; ++z )
+            {
+                for( uint32 x=0; x<width; ++x )
+                    *outHeights++ = data[(startZ + z) * imageWidth + startX + x];
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------
+    unsigned long terraPagerWorkerThread( ThreadHandle *threadHandle )
+    {
+        TerraPager *pager = reinterpret_cast<TerraPager*>( threadHandle->getUserParam() );
+        pager->_workerThread();
+        return 0;
+    }
+    THREAD_DECLARE( terraPagerWorkerThread );
+    //-----------------------------------------------------------------------------------
+    TerraPager::TerraPager( TerraPageProvider *provider, uint32 width, uint32 depth,
+                            uint32 pageResolution, uint32 basePixelDimension,
+                            uint32 vertPixelDimension, float height, const Vector3 &vScale,
+                            uint32 numWorkerThreads ) :
+        m_provider( provider ),
+        m_width( width ),
+        m_depth( depth ),
+        m_pageResolution( pageResolution ),
+        m_numPagesX( alignToNextMultiple( width, pageResolution ) / pageResolution ),
+        m_numPagesZ( alignToNextMultiple( depth, pageResolution ) / pageResolution ),
+        m_basePixelDimension( basePixelDimension ),
+        m_vertPixelDimension( vertPixelDimension ),
+        m_height( height ),
+        m_vScale( vScale ),
+        m_loadRadius( 2u ),
+        m_unloadRadius( 3u ),
+        m_maxUploadsPerFrame( 2u ),
+        m_numPagesOnGpu( 0 ),
+        m_stopWorkers( false )
+    {
+        assert( numWorkerThreads > 0u );
+
+        const size_t numPages = m_numPagesX * m_numPagesZ;
+        m_pages.resize( numPages, 0 );
+        m_pageStates.resize( numPages, PageUnloaded );
+        m_pageOnGpu.resize( numPages, false );
+
+        m_workerThreads.reserve( numWorkerThreads );
+        for( uint32 i=0; i<numWorkerThreads; ++i )
+        {
+            m_workerThreads.push_back( Threads::CreateThread( THREAD_GET( terraPagerWorkerThread ),
+                                                              i, this ) );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    TerraPager::~TerraPager()
+    {
+        m_mutex.lock();
+        m_stopWorkers = true;
+        m_mutex.unlock();
+
+        m_workAvailable.signal( m_workerThreads.size() );
+        Threads::WaitForThreads( m_workerThreads );
+        m_workerThreads.clear();
+
+        std::deque<TerraPage*>::const_iterator itPending = m_pendingPages.begin();
+        std::deque<TerraPage*>::const_iterator enPending = m_pendingPages.end();
+        while( itPending != enPending )
+            delete *itPending++;
+        m_pendingPages.clear();
+
+        std::vector<TerraPage*>::const_iterator itor = m_readyPages.begin();
+        std::vector<TerraPage*>::const_iterator end  = m_readyPages.end();
+        while( itor != end )
+            delete *itor++;
+        m_readyPages.clear();
+
+        itor = m_pages.begin();
+        end  = m_pages.end();
+        while( itor != end )
+            delete *itor++;
+        m_pages.clear();
+    }
+    //-----------------------------------------------------------------------------------
+    void TerraPager::setStreamingRadius( uint32 loadRadius, uint32 unloadRadius )
+    {
+        m_loadRadius = loadRadius;
+        m_unloadRadius = std::max( loadRadius, unloadRadius );
+    }
+    //-----------------------------------------------------------------------------------
+    void TerraPager::setMaxUploadsPerFrame( uint32 maxUploadsPerFrame )
+    {
+        m_maxUploadsPerFrame = std::max( maxUploadsPerFrame, 1u );
+    }
+    //-----------------------------------------------------------------------------------
+    void TerraPager::requestPage( uint32 pageX, uint32 pageZ, std::vector<TerraPage*> &outRequests )
+    {
+        const size_t pageIdx = pageZ * m_numPagesX + pageX;
+
+        TerraPage *page = new TerraPage();
+        page->pageX = pageX;
+        page->pageZ = pageZ;
+        page->startX = pageX * m_pageResolution;
+        page->startZ = pageZ * m_pageResolution;
+        page->width = std::min( m_pageResolution, m_width - page->startX );
+        page->depth = std::min( m_pageResolution, m_depth - page->startZ );
+        page->apronX = page->startX > 0 ? page->startX - 1u : 0u;
+        page->apronZ = page->startZ > 0 ? page->startZ - 1u : 0u;
+        page->apronWidth = std::min( page->startX + page->width + 1u, m_width ) - page->apronX;
+        page->apronDepth = std::min( page->startZ + page->depth + 1u, m_depth ) - page->apronZ;
+        page->skirtHeight = std::numeric_limits<float>::max();
+        page->needsGpuUpload = !m_pageOnGpu[pageIdx];
+
+        m_pageStates[pageIdx] = PageLoading;
+        outRequests.push_back( page );
+    }
+    //-----------------------------------------------------------------------------------
+    void TerraPager::update( int32 cameraPageX, int32 cameraPageZ, std::vector<TerraPage*> &outUploads )
+    {
+        //Pick up the pages the workers finished. Only those the GPU
+        //already has can go over the upload budget.
+        std::vector<TerraPage*> finishedPages;
+        {
+            m_mutex.lock();
+
+            uint32 numUploads = 0;
+            std::vector<TerraPage*>::iterator itor = m_readyPages.begin();
+            std::vector<TerraPage*>::iterator end  = m_readyPages.end();
+
+            while( itor != end )
+            {
+                if( !(*itor)->needsGpuUpload || numUploads < m_maxUploadsPerFrame )
+                {
+                    if( (*itor)->needsGpuUpload )
+                        ++numUploads;
+                    finishedPages.push_back( *itor );
+                    itor = m_readyPages.erase( itor );
+                    end  = m_readyPages.end();
+                }
+                else
+                {
+                    ++itor;
+                }
+            }
+
+            m_mutex.unlock();
+        }
+
+        {
+            std::vector<TerraPage*>::const_iterator itor = finishedPages.begin();
+            std::vector<TerraPage*>::const_iterator end  = finishedPages.end();
+
+            while( itor != end )
+            {
+                TerraPage *page = *itor;
+                const size_t pageIdx = page->pageZ * m_numPagesX + page->pageX;
+                m_pages[pageIdx] = page;
+                m_pageStates[pageIdx] = PageResident;
+
+                if( page->needsGpuUpload )
+                {
+                    m_pageOnGpu[pageIdx] = true;
+                    ++m_numPagesOnGpu;
+                    outUploads.push_back( page );
+                }
+                ++itor;
+            }
+        }
+
+        //Evict the CPU copy of distant pages. Pages waiting to be uploaded are kept until
+        //the next update, as the caller still needs their texel data.
+        for( uint32 pageZ=0; pageZ<m_numPagesZ; ++pageZ )
+        {
+            for( uint32 pageX=0; pageX<m_numPagesX; ++pageX )
+            {
+                const size_t pageIdx = pageZ * m_numPagesX + pageX;
+                const uint32 distance = static_cast<uint32>(
+                            std::max( abs( static_cast<int32>( pageX ) - cameraPageX ),
+                                      abs( static_cast<int32>( pageZ ) - cameraPageZ ) ) );
+
+                if( m_pageStates[pageIdx] == PageResident && distance > m_unloadRadius &&
+                    !m_pages[pageIdx]->needsGpuUpload )
+                {
+                    delete m_pages[pageIdx];
+                    m_pages[pageIdx] = 0;
+                    m_pageStates[pageIdx] = PageUnloaded;
+                }
+            }
+        }
+
+        //Request the pages around the camera, closest ones first.
+        std::vector<TerraPage*> requests;
+        for( int32 radius=0; radius<=static_cast<int32>( m_loadRadius ); ++radius )
+        {
+            const int32 minZ = std::max( cameraPageZ - radius, 0 );
+            const int32 maxZ = std::min( cameraPageZ + radius, static_cast<int32>( m_numPagesZ ) - 1 );
+            const int32 minX = std::max( cameraPageX - radius, 0 );
+            const int32 maxX = std::min( cameraPageX + radius, static_cast<int32>( m_numPagesX ) - 1 );
+
+            for( int32 pageZ=minZ; pageZ<=maxZ; ++pageZ )
+            {
+                for( int32 pageX=minX; pageX<=maxX; ++pageX )
+                {
+                    //Only the ring at this radius; the inside was done in previous iterations.
+                    if( std::max( abs( pageX - cameraPageX ), abs( pageZ - cameraPageZ ) ) != radius )
+                        continue;
+
+                    if( m_pageStates[pageZ * m_numPagesX + pageX] == PageUnloaded )
+                        requestPage( static_cast<uint32>( pageX ), static_cast<uint32>( pageZ ),
+                                     requests );
+                }
+            }
+        }
+
+        m_mutex.lock();
+
+        //Drop the requests no worker got to before the camera moved away.
+        std::deque<TerraPage*>::iterator itor = m_pendingPages.begin();
+        std::deque<TerraPage*>::iterator end  = m_pendingPages.end();
+        while( itor != end )
+        {
+            TerraPage *page = *itor;
+            const uint32 distance = static_cast<uint32>(
+                        std::max( abs( static_cast<int32>( page->pageX ) - cameraPageX ),
+                                  abs( static_cast<int32>( page->pageZ ) - cameraPageZ ) ) );
+
+            if( distance > m_unloadRadius )
+            {
+                m_pageStates[page->pageZ * m_numPagesX + page->pageX] = PageUnloaded;
+                delete page;
+                itor = m_pendingPages.erase( itor );
+                end  = m_pendingPages.end();
+            }
+            else
+            {
+                ++itor;
+            }
+        }
+
+        m_pendingPages.insert( m_pendingPages.end(), requests.begin(), requests.end() );
+
+        m_mutex.unlock();
+
+        m_workAvailable.signal( requests.size() );
+    }
+    //-----------------------------------------------------------------------------------
+    void TerraPager::_notifyUploaded( const std::vector<TerraPage*> &uploadedPages )
+    {
+        std::vector<TerraPage*>::const_iterator itor = uploadedPages.begin();
+        std::vector<TerraPage*>::const_iterator end  = uploadedPages.end();
+
+        while( itor != end )
+        {
+            TerraPage *page = *itor;
+            std::vector<uint16>().swap( page->heightTexels );
+            std::vector<uint32>().swap( page->normalTexels );
+            page->needsGpuUpload = false;
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    const TerraPage* TerraPager::getResidentPage( uint32 x, uint32 z ) const
+    {
+        const uint32 pageX = x / m_pageResolution;
+        const uint32 pageZ = z / m_pageResolution;
+
+        if( pageX >= m_numPagesX || pageZ >= m_numPagesZ )
+            return 0;
+
+        return m_pages[pageZ * m_numPagesX + pageX];
+    }
+    //-----------------------------------------------------------------------------------
+    size_t TerraPager::getNumLoadingPages(void) const
+    {
+        return static_cast<size_t>( std::count( m_pageStates.begin(), m_pageStates.end(),
+                                                static_cast<uint8>( PageLoading ) ) );
+    }
+    //-----------------------------------------------------------------------------------
+    size_t TerraPager::getNumResidentPages(void) const
+    {
+        return static_cast<size_t>( std::count( m_pageStates.begin(), m_pageStates.end(),
+                                                static_cast<uint8>( PageResident ) ) );
+    }
+    //-----------------------------------------------------------------------------------
+    void TerraPager::calculateSkirtHeight( TerraPage *page ) const
+    {
+        //Same as Terra::calculateOptimumSkirtSize, restricted to the borders
+        //between LOD cells that go through this page.
+        const uint32 endX = page->startX + page->width;
+        const uint32 endZ = page->startZ + page->depth;
+
+        float skirtHeight = std::numeric_limits<float>::max();
+
+        const uint32 firstY = alignToNextMultiple( page->startZ + 1u, m_vertPixelDimension ) - 1u;
+        for( uint32 y=firstY; y<endZ && y<m_depth-1u; y += m_vertPixelDimension )
+        {
+            const uint32 ny = y + 1u;
+
+            bool allEqualInLine = true;
+            float minHeight = page->getHeight( page->startX, y );
+            for( uint32 x=page->startX; x<endX; ++x )
+            {
+                const float minValue = Ogre::min( page->getHeight( x, y ), page->getHeight( x, ny ) );
+                minHeight = Ogre::min( minValue, minHeight );
+                allEqualInLine &= page->getHeight( x, y ) == page->getHeight( x, ny );
+            }
+
+            if( !allEqualInLine )
+                skirtHeight = Ogre::min( minHeight, skirtHeight );
+        }
+
+        const uint32 firstX = alignToNextMultiple( page->startX + 1u, m_basePixelDimension ) - 1u;
+        for( uint32 x=firstX; x<endX && x<m_width-1u; x += m_basePixelDimension )
+        {
+            const uint32 nx = x + 1u;
+
+            bool allEqualInLine = true;
+            float minHeight = page->getHeight( x, page->startZ );
+            for( uint32 y=page->startZ; y<endZ; ++y )
+            {
+                const float minValue = Ogre::min( page->getHeight( x, y ), page->getHeight( nx, y ) );
+                minHeight = Ogre::min( minValue, minHeight );
+                allEqualInLine &= page->getHeight( x, y ) == page->getHeight( nx, y );
+            }
+
+            if( !allEqualInLine )
+                skirtHeight = Ogre::min( minHeight, skirtHeight );
+        }
+
+        page->skirtHeight = skirtHeight;
+    }
+    //-----------------------------------------------------------------------------------
+    void TerraPager::calculateNormals( TerraPage *page ) const
+    {
+        //CPU version of GpuNormalMapper_ps. See its comments.
+        const Vector3 vScale = m_vScale;
+
+        const uint32 endX = page->startX + page->width;
+        const uint32 endZ = page->startZ + page->depth;
+        const uint32 lastX = page->apronX + page->apronWidth - 1u;
+        const uint32 lastZ = page->apronZ + page->apronDepth - 1u;
+
+        page->normalTexels.resize( page->width * page->depth );
+        uint32 *normalTexels = &page->normalTexels[0];
+
+        for( uint32 y=page->startZ; y<endZ; ++y )
+        {
+            const uint32 yN = y > 0 ? y - 1u : 0u;
+            const uint32 y1 = std::min( y + 1u, lastZ );
+
+            for( uint32 x=page->startX; x<endX; ++x )
+            {
+                const uint32 xN = x > 0 ? x - 1u : 0u;
+                const uint32 x1 = std::min( x + 1u, lastX );
+
+                const Vector3 vNN( -vScale.x, page->getHeight( xN, yN ) * vScale.y, -vScale.z );
+                const Vector3 vN0( -vScale.x, page->getHeight( x, yN ) * vScale.y, 0 );
+                const Vector3 v0N( 0, page->getHeight( xN, y ) * vScale.y, -vScale.z );
+                const Vector3 v00( 0, page->getHeight( x, y ) * vScale.y, 0 );
+                const Vector3 v01( 0, page->getHeight( x1, y ) * vScale.y, vScale.z );
+                const Vector3 v10( vScale.x, page->getHeight( x, y1 ) * vScale.y, 0 );
+                const Vector3 v11( vScale.x, page->getHeight( x1, y1 ) * vScale.y, vScale.z );
+
+                Vector3 vNormal( Vector3::ZERO );
+                vNormal += (v01 - v00).crossProduct( v11 - v00 );
+                vNormal += (v11 - v00).crossProduct( v10 - v00 );
+                vNormal += (v10 - v00).crossProduct( v0N - v00 );
+                vNormal += (v0N - v00).crossProduct( vNN - v00 );
+                vNormal += (vNN - v00).crossProduct( vN0 - v00 );
+                vNormal += (vN0 - v00).crossProduct( v01 - v00 );
+                vNormal.normalise();
+
+                PixelUtil::packColour( vNormal.z * 0.5f + 0.5f, vNormal.y * 0.5f + 0.5f,
+                                       vNormal.x * 0.5f + 0.5f, 1.0f,
+                                       PF_A2B10G10R10, normalTexels++ );
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void TerraPager::generatePage( TerraPage *page ) const
+    {
+        page->heights.resize( page->apronWidth * page->apronDepth );
+        m_provider->loadPage( page->apronX, page->apronZ, page->apronWidth, page->apronDepth,
+                              &page->heights[0] );
+
+        //Both of these need the heights still in range [0; 1]
+        calculateSkirtHeight( page );
+
+        if( page->needsGpuUpload )
+        {
+            calculateNormals( page );
+
+            page->heightTexels.resize( page->width * page->depth );
+            uint16 *heightTexels = &page->heightTexels[0];
+
+            for( uint32 y=page->startZ; y<page->startZ + page->depth; ++y )
+            {
+                for( uint32 x=page->startX; x<page->startX + page->width; ++x )
+                {
+                    *heightTexels++ = static_cast<uint16>(
+                                Math::saturate( page->getHeight( x, y ) ) * 65535.0f + 0.5f );
+                }
+            }
+        }
+
+        const float height = m_height;
+        std::vector<float>::iterator itor = page->heights.begin();
+        std::vector<float>::iterator end  = page->heights.end();
+        while( itor != end )
+            *itor++ *= height;
+    }
+    //-----------------------------------------------------------------------------------
+    void TerraPager::_workerThread(void)
+    {
+        while( true )
+        {
+            m_workAvailable.wait();
+
+            TerraPage *page = 0;
+
+            m_mutex.lock();
+            const bool stopWorkers = m_stopWorkers;
+            if( !stopWorkers && !m_pendingPages.empty() )
+            {
+                page = m_pendingPages.front();
+                m_pendingPages.pop_front();
+            }
+            m_mutex.unlock();
+
+            if( stopWorkers )
+                break;
+
+            //Null if update dropped the request this signal was for.
+            if( page )
+            {
+                generatePage( page );
+
+                m_mutex.lock();
+                m_readyPages.push_back( page );
+                m_mutex.unlock();
+            }
+        }
+    }
+}
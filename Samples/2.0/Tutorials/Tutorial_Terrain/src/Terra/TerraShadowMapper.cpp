@@ -144,9 +144,34 @@ namespace Ogre
         return static_cast<float>( newErrorAtX );
     }
     //-----------------------------------------------------------------------------------
+    inline float ShadowMapper::getLinePosition( float x, float y, float x0, float y0,
+                                                const int32 xyStep[2], float slope )
+    {
+        return (y - y0) * xyStep[1] - (x - x0) * xyStep[0] * slope;
+    }
+    //-----------------------------------------------------------------------------------
+    bool ShadowMapper::linesCrossBoxes( float linePosMin, float linePosMax,
+                                        const std::vector<Vector2> &boxesLinePosRange )
+    {
+        std::vector<Vector2>::const_iterator itor = boxesLinePosRange.begin();
+        std::vector<Vector2>::const_iterator end  = boxesLinePosRange.end();
+
+        while( itor != end )
+        {
+            if( linePosMin <= itor->y && linePosMax >= itor->x )
+                return true;
+            ++itor;
+        }
+
+        return false;
+    }
+    //-----------------------------------------------------------------------------------
     void ShadowMapper::updateShadowMap( const Vector3 &lightDir, const Vector2 &xzDimensions,
-                                        float heightScale )
+                                        float heightScale, const std::vector<Box> *dirtyBoxes )
     {
+        if( dirtyBoxes && dirtyBoxes->empty() )
+            return;
+
         struct PerGroupData
         {
             int32 iterations;
@@ -266,15 +291,66 @@ namespace Ogre
                                                               threadsPerGroup ) / threadsPerGroup;
         const uint32 lastThreadGroups = alignToNextMultiple( numExtraIterations,
                                                              threadsPerGroup ) / threadsPerGroup;
-        const uint32 totalThreadGroups = firstThreadGroups + lastThreadGroups;
 
         const int32 idy = static_cast<int32>( floorf( dy ) );
 
+        //When only some regions are dirty, find out which lines cross them so we can skip
+        //the thread groups that would only trace lines that didn't change.
+        const float slope = dy / dx;
+        std::vector<Vector2> boxesLinePosRange;
+        if( dirtyBoxes )
+        {
+            boxesLinePosRange.reserve( dirtyBoxes->size() );
+
+            std::vector<Box>::const_iterator itor = dirtyBoxes->begin();
+            std::vector<Box>::const_iterator end  = dirtyBoxes->end();
+
+            while( itor != end )
+            {
+                const float cornersX[2] = { static_cast<float>( itor->left ),
+                                            static_cast<float>( itor->right - 1u ) };
+                const float cornersY[2] = { static_cast<float>( itor->top ),
+                                            static_cast<float>( itor->bottom - 1u ) };
+
+                Vector2 linePosRange( std::numeric_limits<float>::max(),
+                                      -std::numeric_limits<float>::max() );
+                for( size_t i=0; i<4u; ++i )
+                {
+                    float cornerX = cornersX[i & 0x01];
+                    float cornerY = cornersY[i >> 1u];
+                    if( steep )
+                        std::swap( cornerX, cornerY );
+
+                    const float linePos = getLinePosition( cornerX, cornerY, x0, y0,
+                                                           xyStep, slope );
+                    linePosRange.x = Ogre::min( linePos, linePosRange.x );
+                    linePosRange.y = Ogre::max( linePos, linePosRange.y );
+                }
+
+                //Bresenham strays up to one texel away from the ideal line. Be conservative.
+                linePosRange.x -= 2.0f;
+                linePosRange.y += 2.0f;
+                boxesLinePosRange.push_back( linePosRange );
+
+                ++itor;
+            }
+        }
+
+        uint32 numThreadGroups = 0;
+
         //"First" series of threadgroups
         for( uint32 h=0; h<firstThreadGroups; ++h )
         {
             const uint32 startY = h * threadsPerGroup;
 
+            if( dirtyBoxes &&
+                !linesCrossBoxes( static_cast<float>( startY ),
+                                  static_cast<float>( startY + threadsPerGroup - 1u ),
+                                  boxesLinePosRange ) )
+            {
+                continue;
+            }
+
             for( uint32 i=0; i<threadsPerGroup; ++i )
             {
                 *starts++ = static_cast<int32>( x0 );
@@ -291,6 +367,7 @@ namespace Ogre
             perGroupData->padding0 = 0;
             perGroupData->padding1 = 0;
             ++perGroupData;
+            ++numThreadGroups;
         }
 
         //"Last" series of threadgroups
@@ -298,6 +375,13 @@ namespace Ogre
         {
             const int32 xN = getXStepsNeededToReachY( threadsPerGroup * h + 1u, fStep );
 
+            if( dirtyBoxes &&
+                !linesCrossBoxes( -static_cast<float>( threadsPerGroup - 1u ) - xN * slope,
+                                  -xN * slope, boxesLinePosRange ) )
+            {
+                continue;
+            }
+
             for( uint32 i=0; i<threadsPerGroup; ++i )
             {
                 *starts++ = static_cast<int32>( x0 ) + xN * xyStep[0];
@@ -312,17 +396,21 @@ namespace Ogre
             perGroupData->iterations = widthOrHeight - xN;
             perGroupData->deltaErrorStart = getErrorAfterXsteps( xN, dx, dy ) - dx * 0.5f;
             ++perGroupData;
+            ++numThreadGroups;
         }
 
         m_shadowPerGroupData->unmap( UO_KEEP_PERSISTENT );
         m_shadowStarts->unmap( UO_KEEP_PERSISTENT );
 
+        if( !numThreadGroups )
+            return;
+
         //Re-Set them every frame (they may have changed if we have multiple Terra instances)
         m_shadowJob->setConstBuffer( 0, m_shadowStarts );
         m_shadowJob->setConstBuffer( 1, m_shadowPerGroupData );
         m_shadowJob->setTexture( 0, m_heightMapTex );
 
-        m_shadowJob->setNumThreadGroups( totalThreadGroups, 1u, 1u );
+        m_shadowJob->setNumThreadGroups( numThreadGroups, 1u, 1u );
 
         ShaderParams &shaderParams = m_shadowJob->getShaderParams( "default" );
         shaderParams.setDirty();
@@ -13,11 +13,13 @@ layout(std140) uniform;
 
 @insertpiece( Common_Matrix_DeclUnpackMatrix4x4 )
 
+@property( !unlit_vertex_pulling )
 in vec4 vertex;
 @property( hlms_colour )in vec4 colour;@end
 
 @foreach( hlms_uv_count, n )
 in vec@value( hlms_uv_count@n ) uv@n;@end
+@end
 
 @property( GL_ARB_base_instance )
 	in uint drawId;
@@ -37,6 +39,7 @@ out block
 @insertpiece( InstanceDecl )
 /*layout(binding = 0) */uniform samplerBuffer worldMatBuf;
 @property( texture_matrix )/*layout(binding = 1) */uniform samplerBuffer animationMatrixBuf;@end
+@property( unlit_vertex_pulling )/*layout(binding = 1) */uniform samplerBuffer billboardBuf;@end
 @insertpiece( custom_vs_uniformDeclaration )
 @property( !GL_ARB_base_instance )uniform uint baseInstance;@end
 // END UNIFORM DECLARATION
@@ -56,7 +59,38 @@ void main()
 @property( !GL_ARB_base_instance )
     uint drawId = baseInstance + uint( gl_InstanceID );
 @end
-    
+
+@property( unlit_vertex_pulling )
+	//GpuBillboardSet: 6 vertices per billboard, corners (-1,-1) (1,-1) (-1,1) (-1,1) (1,-1) (1,1).
+	//The bits of 0x32 and 0x2C say which of them have positive x and y respectively.
+	uint billboardIdx	= uint( gl_VertexID ) / 6u;
+	uint cornerIdx		= uint( gl_VertexID ) % 6u;
+	vec2 corner = vec2( float( (0x32u >> cornerIdx) & 1u ),
+						float( (0x2Cu >> cornerIdx) & 1u ) ) * 2.0 - 1.0;
+
+	vec4 billboardRight	= texelFetch( billboardBuf, 0 );
+	vec4 billboardUp	= texelFetch( billboardBuf, 1 );
+	int recordIdx = int( floatBitsToUint( billboardRight.w ) + (billboardIdx << 1u) );
+	//xyz = position, w = rotation
+	vec4 record0 = texelFetch( billboardBuf, recordIdx );
+	//xy = half size, z = RGBA8 colour, w = uv rect index
+	vec4 record1 = texelFetch( billboardBuf, recordIdx + 1 );
+
+	vec2 cornerOffset = corner * record1.xy;
+	float sinRot = sin( record0.w );
+	float cosRot = cos( record0.w );
+	cornerOffset = vec2( cornerOffset.x * cosRot - cornerOffset.y * sinRot,
+						 cornerOffset.x * sinRot + cornerOffset.y * cosRot );
+
+	vec4 vertex = vec4( record0.xyz + billboardRight.xyz * cornerOffset.x +
+						billboardUp.xyz * cornerOffset.y, 1.0 );
+	uint packedColour = floatBitsToUint( record1.z );
+	vec4 colour = vec4( uvec4( packedColour, packedColour >> 8u,
+							   packedColour >> 16u, packedColour >> 24u ) & 0xFFu ) / 255.0;
+	vec4 uvRect = texelFetch( billboardBuf, 2 + int( floatBitsToUint( record1.w ) ) );
+	vec2 uv0 = vec2( corner.x < 0.0 ? uvRect.x : uvRect.z, corner.y > 0.0 ? uvRect.y : uvRect.w );
+@end
+
 	@insertpiece( custom_vs_preExecution )
 	@property( !hlms_identity_world )
 		mat4 worldViewProj;
@@ -7,19 +7,35 @@
 @insertpiece( InstanceDecl )
 Buffer<float4> worldMatBuf : register(t0);
 @property( texture_matrix )Buffer<float4> animationMatrixBuf : register(t1);@end
+@property( unlit_vertex_pulling )Buffer<float4> billboardBuf : register(t1);@end
 @insertpiece( custom_vs_uniformDeclaration )
 // END UNIFORM DECLARATION
 
 struct VS_INPUT
 {
+@property( !unlit_vertex_pulling )
 	float4 vertex : POSITION;
 @property( hlms_colour )	float4 colour : COLOR0;@end
 @foreach( hlms_uv_count, n )
 	float@value( hlms_uv_count@n ) uv@n : TEXCOORD@n;@end
+@end @property( unlit_vertex_pulling )
+	uint vertexId : SV_VertexID;
+@end
 	uint drawId : DRAWID;
 	@insertpiece( custom_vs_attributes )
 };
 
+@property( unlit_vertex_pulling )
+//What VS_INPUT would have had, built from the GpuBillboardSet records.
+struct VS_PULLED_INPUT
+{
+	float4 vertex;
+	float4 colour;
+	float2 uv0;
+	uint drawId;
+};
+@end
+
 struct PS_INPUT
 {
 @insertpiece( VStoPS_block )
@@ -45,9 +61,46 @@ struct PS_INPUT
 	@end
 @end
 
+@property( !unlit_vertex_pulling )
 PS_INPUT main( VS_INPUT input )
+@end @property( unlit_vertex_pulling )
+PS_INPUT main( VS_INPUT vsInput )
+@end
 {
 	PS_INPUT outVs;
+
+@property( unlit_vertex_pulling )
+	//GpuBillboardSet: 6 vertices per billboard, corners (-1,-1) (1,-1) (-1,1) (-1,1) (1,-1) (1,1).
+	//The bits of 0x32 and 0x2C say which of them have positive x and y respectively.
+	VS_PULLED_INPUT input;
+	input.drawId = vsInput.drawId;
+
+	uint billboardIdx	= vsInput.vertexId / 6u;
+	uint cornerIdx		= vsInput.vertexId % 6u;
+	float2 corner = float2( (0x32u >> cornerIdx) & 1u, (0x2Cu >> cornerIdx) & 1u ) * 2.0 - 1.0;
+
+	float4 billboardRight	= billboardBuf.Load( 0 );
+	float4 billboardUp		= billboardBuf.Load( 1 );
+	uint recordIdx = asuint( billboardRight.w ) + (billboardIdx << 1u);
+	//xyz = position, w = rotation
+	float4 record0 = billboardBuf.Load( recordIdx );
+	//xy = half size, z = RGBA8 colour, w = uv rect index
+	float4 record1 = billboardBuf.Load( recordIdx + 1u );
+
+	float2 cornerOffset = corner * record1.xy;
+	float sinRot, cosRot;
+	sincos( record0.w, sinRot, cosRot );
+	cornerOffset = float2( cornerOffset.x * cosRot - cornerOffset.y * sinRot,
+						   cornerOffset.x * sinRot + cornerOffset.y * cosRot );
+
+	input.vertex = float4( record0.xyz + billboardRight.xyz * cornerOffset.x +
+						   billboardUp.xyz * cornerOffset.y, 1.0 );
+	uint packedColour = asuint( record1.z );
+	input.colour = float4( uint4( packedColour, packedColour >> 8u,
+								  packedColour >> 16u, packedColour >> 24u ) & 0xFFu ) / 255.0;
+	float4 uvRect = billboardBuf.Load( 2u + asuint( record1.w ) );
+	input.uv0 = float2( corner.x < 0.0 ? uvRect.x : uvRect.z, corner.y > 0.0 ? uvRect.y : uvRect.w );
+@end
 	@insertpiece( custom_vs_preExecution )
 
 	@property( !hlms_identity_world )
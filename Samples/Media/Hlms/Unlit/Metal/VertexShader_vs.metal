@@ -7,16 +7,28 @@
 
 struct VS_INPUT
 {
+@property( !unlit_vertex_pulling )
 	float4 position [[attribute(VES_POSITION)]];
 @property( hlms_colour )	float4 colour [[attribute(VES_DIFFUSE)]];@end
 @foreach( hlms_uv_count, n )
 	float@value( hlms_uv_count@n ) uv@n [[attribute(VES_TEXTURE_COORDINATES@n)]];@end
+@end
 @property( !iOS )
 	ushort drawId [[attribute(15)]];
 @end
 	@insertpiece( custom_vs_attributes )
 };
 
+@property( unlit_vertex_pulling )
+//What VS_INPUT would have had, built from the GpuBillboardSet records.
+struct VS_PULLED_INPUT
+{
+	float4 position;
+	float4 colour;
+	float2 uv0;
+};
+@end
+
 struct PS_INPUT
 {
 @insertpiece( VStoPS_block )
@@ -38,7 +50,12 @@ struct PS_INPUT
 
 vertex PS_INPUT main_metal
 (
-	VS_INPUT input [[stage_in]]
+	@property( !unlit_vertex_pulling )
+		VS_INPUT input [[stage_in]]
+	@end @property( unlit_vertex_pulling )
+		uint vertexId [[vertex_id]]
+		@property( !iOS ), VS_INPUT vsInput [[stage_in]]@end
+	@end
 	@property( iOS )
 		, ushort instanceId [[instance_id]]
 		, constant ushort &baseInstance [[buffer(15)]]
@@ -48,6 +65,7 @@ vertex PS_INPUT main_metal
 	@insertpiece( InstanceDecl )
 	, device const float4x4 *worldMatBuf [[buffer(TEX_SLOT_START+0)]]
 	@property( texture_matrix ), device const float4x4 *animationMatrixBuf [[buffer(TEX_SLOT_START+1)]]@end
+	@property( unlit_vertex_pulling ), device const float4 *billboardBuf [[buffer(TEX_SLOT_START+1)]]@end
 	@insertpiece( custom_vs_uniformDeclaration )
 	// END UNIFORM DECLARATION
 )
@@ -55,9 +73,42 @@ vertex PS_INPUT main_metal
 	@property( iOS )
 		ushort drawId = baseInstance + instanceId;
 	@end @property( !iOS )
-		ushort drawId = input.drawId;
+		@property( !unlit_vertex_pulling )ushort drawId = input.drawId;@end
+		@property( unlit_vertex_pulling )ushort drawId = vsInput.drawId;@end
 	@end
 
+@property( unlit_vertex_pulling )
+	//GpuBillboardSet: 6 vertices per billboard, corners (-1,-1) (1,-1) (-1,1) (-1,1) (1,-1) (1,1).
+	//The bits of 0x32 and 0x2C say which of them have positive x and y respectively.
+	VS_PULLED_INPUT input;
+
+	uint billboardIdx	= vertexId / 6u;
+	uint cornerIdx		= vertexId % 6u;
+	float2 corner = float2( (0x32u >> cornerIdx) & 1u, (0x2Cu >> cornerIdx) & 1u ) * 2.0 - 1.0;
+
+	float4 billboardRight	= billboardBuf[0];
+	float4 billboardUp		= billboardBuf[1];
+	uint recordIdx = as_type<uint>( billboardRight.w ) + (billboardIdx << 1u);
+	//xyz = position, w = rotation
+	float4 record0 = billboardBuf[recordIdx];
+	//xy = half size, z = RGBA8 colour, w = uv rect index
+	float4 record1 = billboardBuf[recordIdx + 1u];
+
+	float2 cornerOffset = corner * record1.xy;
+	float sinRot = sin( record0.w );
+	float cosRot = cos( record0.w );
+	cornerOffset = float2( cornerOffset.x * cosRot - cornerOffset.y * sinRot,
+						   cornerOffset.x * sinRot + cornerOffset.y * cosRot );
+
+	input.position = float4( record0.xyz + billboardRight.xyz * cornerOffset.x +
+							 billboardUp.xyz * cornerOffset.y, 1.0 );
+	uint packedColour = as_type<uint>( record1.z );
+	input.colour = float4( uint4( packedColour, packedColour >> 8u,
+								  packedColour >> 16u, packedColour >> 24u ) & 0xFFu ) / 255.0;
+	float4 uvRect = billboardBuf[2u + as_type<uint>( record1.w )];
+	input.uv0 = float2( corner.x < 0.0 ? uvRect.x : uvRect.z, corner.y > 0.0 ? uvRect.y : uvRect.w );
+@end
+
 	PS_INPUT outVs;
 	@insertpiece( custom_vs_preExecution )
 
@@ -0,0 +1,75 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __HlmsUnlitDatablockTests_H__
+#define __HlmsUnlitDatablockTests_H__
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "OgrePrerequisites.h"
+#include "OgreSharedPtr.h"
+
+class NullRenderSystemHelper;
+
+namespace Ogre
+{
+    class HlmsUnlitDatablock;
+}
+
+/// Checks how HlmsUnlitDatablock combines the min LOD set by the user with the one
+/// HlmsTextureManager requests through _replaceTexture while a texture streams in.
+class HlmsUnlitDatablockTests : public CppUnit::TestFixture
+{
+    // CppUnit macros for setting up the test suite
+    CPPUNIT_TEST_SUITE(HlmsUnlitDatablockTests);
+    CPPUNIT_TEST(testStreamingRaisesMinLod);
+    CPPUNIT_TEST(testUserMinLodKept);
+    CPPUNIT_TEST(testReplacedTextureForgetsMinLod);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    NullRenderSystemHelper      *mHelper;
+    Ogre::HlmsUnlitDatablock    *mDatablock;
+    Ogre::TexturePtr            mTexture;
+    Ogre::TexturePtr            mOtherTexture;
+
+    /// Min LOD of the samplerblock of texture unit 0.
+    float getMinLod(void) const;
+
+public:
+    void setUp();
+    void tearDown();
+
+    /// The highest of the user's and the streaming min LOD is used.
+    void testStreamingRaisesMinLod();
+    /// Samplerblocks set while streaming keep the user's min LOD, not the raised one.
+    void testUserMinLodKept();
+    void testReplacedTextureForgetsMinLod();
+};
+
+#endif
@@ -0,0 +1,157 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "HlmsUnlitDatablockTests.h"
+#include "NullRenderSystemHelper.h"
+
+#include "OgreHlmsUnlitDatablock.h"
+#include "OgreHlmsUnlit.h"
+#include "OgreHlmsManager.h"
+#include "OgreHlmsSamplerblock.h"
+#include "OgreRoot.h"
+#include "OgreTextureManager.h"
+
+#include "UnitTestSuite.h"
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(HlmsUnlitDatablockTests);
+
+namespace
+{
+    TexturePtr createTexture( const String &name )
+    {
+        return TextureManager::getSingleton().createManual(
+                    name, ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
+                    TEX_TYPE_2D_ARRAY, 64u, 64u, 4u, 6, PF_A8R8G8B8 );
+    }
+}
+
+//--------------------------------------------------------------------------
+void HlmsUnlitDatablockTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mHelper = new NullRenderSystemHelper();
+
+    Hlms *hlmsUnlit = mHelper->getRoot()->getHlmsManager()->getHlms( HLMS_UNLIT );
+    mDatablock = static_cast<HlmsUnlitDatablock*>(
+                hlmsUnlit->createDatablock( "HlmsUnlitDatablockTests", "HlmsUnlitDatablockTests",
+                                            HlmsMacroblock(), HlmsBlendblock(),
+                                            HlmsParamVec() ) );
+
+    mTexture = createTexture( "HlmsUnlitDatablockTests/Streamed" );
+    mOtherTexture = createTexture( "HlmsUnlitDatablockTests/Other" );
+
+    HlmsSamplerblock samplerblock;
+    samplerblock.mMinLod = 1.0f;
+    mDatablock->setTexture( 0, 2u, mTexture, &samplerblock );
+}
+//--------------------------------------------------------------------------
+void HlmsUnlitDatablockTests::tearDown()
+{
+    mDatablock = 0;
+    mTexture.setNull();
+    mOtherTexture.setNull();
+
+    delete mHelper;
+    mHelper = 0;
+}
+//--------------------------------------------------------------------------
+float HlmsUnlitDatablockTests::getMinLod(void) const
+{
+    return mDatablock->getSamplerblock( 0 )->mMinLod;
+}
+//--------------------------------------------------------------------------
+void HlmsUnlitDatablockTests::testStreamingRaisesMinLod()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    CPPUNIT_ASSERT_EQUAL( 1.0f, getMinLod() );
+
+    //Only the lowest mips are resident
+    mDatablock->_replaceTexture( mTexture, 2u, mTexture, 3u, 4.0f );
+    CPPUNIT_ASSERT_EQUAL( 4.0f, getMinLod() );
+    CPPUNIT_ASSERT_EQUAL( (uint16)3u, mDatablock->_getTextureIdx( 0 ) );
+    CPPUNIT_ASSERT( mDatablock->getTexture( 0 ) == mTexture );
+
+    //Below what the user asked for; the user's value wins
+    mDatablock->_replaceTexture( mTexture, 3u, mTexture, 3u, 0.5f );
+    CPPUNIT_ASSERT_EQUAL( 1.0f, getMinLod() );
+
+    mDatablock->_replaceTexture( mTexture, 3u, mTexture, 3u, 0.0f );
+    CPPUNIT_ASSERT_EQUAL( 1.0f, getMinLod() );
+
+    //Textures in other slices aren't affected
+    mDatablock->_replaceTexture( mTexture, 0u, mTexture, 0u, 5.0f );
+    CPPUNIT_ASSERT_EQUAL( 1.0f, getMinLod() );
+}
+//--------------------------------------------------------------------------
+void HlmsUnlitDatablockTests::testUserMinLodKept()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    mDatablock->_replaceTexture( mTexture, 2u, mTexture, 2u, 4.0f );
+
+    //Changing something else passes the raised min LOD back
+    HlmsSamplerblock samplerblock( *mDatablock->getSamplerblock( 0 ) );
+    samplerblock.mU = TAM_CLAMP;
+    mDatablock->setSamplerblock( 0, samplerblock );
+    CPPUNIT_ASSERT_EQUAL( 4.0f, getMinLod() );
+
+    mDatablock->_replaceTexture( mTexture, 2u, mTexture, 2u, 0.0f );
+    CPPUNIT_ASSERT_EQUAL( 1.0f, getMinLod() );
+    CPPUNIT_ASSERT_EQUAL( TAM_CLAMP, mDatablock->getSamplerblock( 0 )->mU );
+
+    //A new user value is honoured, and raised while streaming
+    mDatablock->_replaceTexture( mTexture, 2u, mTexture, 2u, 4.0f );
+    samplerblock.mMinLod = 2.0f;
+    mDatablock->setSamplerblock( 0, samplerblock );
+    CPPUNIT_ASSERT_EQUAL( 4.0f, getMinLod() );
+    samplerblock.mMinLod = 6.0f;
+    mDatablock->setSamplerblock( 0, samplerblock );
+    CPPUNIT_ASSERT_EQUAL( 6.0f, getMinLod() );
+
+    mDatablock->_replaceTexture( mTexture, 2u, mTexture, 2u, 0.0f );
+    CPPUNIT_ASSERT_EQUAL( 6.0f, getMinLod() );
+}
+//--------------------------------------------------------------------------
+void HlmsUnlitDatablockTests::testReplacedTextureForgetsMinLod()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    mDatablock->_replaceTexture( mTexture, 2u, mTexture, 2u, 4.0f );
+    CPPUNIT_ASSERT_EQUAL( 4.0f, getMinLod() );
+
+    //The texture that replaces it isn't streamed
+    mDatablock->setTexture( 0, 0u, mOtherTexture );
+    CPPUNIT_ASSERT_EQUAL( 1.0f, getMinLod() );
+
+    mDatablock->setTexture( 0, 2u, mTexture );
+    CPPUNIT_ASSERT_EQUAL( 1.0f, getMinLod() );
+}
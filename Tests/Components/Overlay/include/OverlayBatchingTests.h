@@ -0,0 +1,94 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __OverlayBatchingTests_H__
+#define __OverlayBatchingTests_H__
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "OgreOverlayPrerequisites.h"
+
+class NullRenderSystemHelper;
+
+namespace Ogre
+{
+    class NULLCommandRecorder;
+    namespace v1
+    {
+        class PanelOverlayElement;
+    }
+}
+
+/// Renders overlays on the NULL render system with and without OverlayBatchRenderer,
+/// and checks the draws that reach the RenderSystem and the RenderQueue modes.
+class OverlayBatchingTests : public CppUnit::TestFixture
+{
+    // CppUnit macros for setting up the test suite
+    CPPUNIT_TEST_SUITE(OverlayBatchingTests);
+    CPPUNIT_TEST(testUnbatched);
+    CPPUNIT_TEST(testBatchedDrawOrder);
+    CPPUNIT_TEST(testUnbatchableElementFallsBack);
+    CPPUNIT_TEST(testRenderQueueModeRestored);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    typedef Ogre::vector<Ogre::uint32>::type Uint32Vec;
+
+    NullRenderSystemHelper      *mHelper;
+    Ogre::SceneManager          *mSceneManager;
+    Ogre::NULLCommandRecorder   *mRecorder;
+    Ogre::v1::OverlaySystem     *mOverlaySystem;
+    Ogre::v1::Overlay           *mOverlayA;
+    Ogre::v1::Overlay           *mOverlayB;
+    /// Not owned by the OverlayManager
+    Ogre::v1::PanelOverlayElement   *mUnbatchablePanel;
+
+    /** Overlay A (z-order 200) is a panel with three child panels using
+        materials 1, 1, 2, 1 in hierarchy order. Overlay B (z-order 100) is
+        a panel with two children, all using material 2.
+    */
+    void createScene(void);
+    Ogre::v1::PanelOverlayElement* createPanel( const Ogre::String &name,
+                                                const Ogre::String &materialName );
+    /// Renders a frame and returns the primitive count of every draw, in order.
+    Uint32Vec renderFrame(void);
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testUnbatched();
+    /// Consecutive elements sharing a material get merged; overlays keep their z-order.
+    void testBatchedDrawOrder();
+    /// Groups with an element that can't be batched render every element on its own.
+    void testUnbatchableElementFallsBack();
+    /// Disabling batching gives the RenderQueue group its mode and sort mode back.
+    void testRenderQueueModeRestored();
+};
+
+#endif
@@ -0,0 +1,309 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OverlayBatchingTests.h"
+#include "NullRenderSystemHelper.h"
+
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgreCamera.h"
+#include "OgreRenderQueue.h"
+#include "OgreHlmsManager.h"
+#include "OgreHlms.h"
+#include "OgreNULLRenderSystem.h"
+#include "OgreNULLCommandRecorder.h"
+
+#include "OgreOverlaySystem.h"
+#include "OgreOverlayManager.h"
+#include "OgreOverlay.h"
+#include "OgrePanelOverlayElement.h"
+
+#include "UnitTestSuite.h"
+
+#include <sstream>
+
+using namespace Ogre;
+using namespace Ogre::v1;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(OverlayBatchingTests);
+
+namespace
+{
+    /// Stands for element types that don't fill mBatchVertices.
+    class UnbatchablePanelOverlayElement : public PanelOverlayElement
+    {
+    public:
+        UnbatchablePanelOverlayElement( const String &name ) : PanelOverlayElement( name ) {}
+
+        virtual bool _supportsBatching(void) const  { return false; }
+    };
+
+    const uint8 c_defaultRqId = 254u;
+    /// Rendered before c_defaultRqId
+    const uint8 c_otherRqId = 253u;
+}
+
+//--------------------------------------------------------------------------
+void OverlayBatchingTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mHelper = new NullRenderSystemHelper();
+    mSceneManager = 0;
+    mOverlaySystem = 0;
+    mOverlayA = 0;
+    mOverlayB = 0;
+    mUnbatchablePanel = 0;
+
+    NULLRenderSystem *renderSystem =
+            static_cast<NULLRenderSystem*>( mHelper->getRoot()->getRenderSystem() );
+    mRecorder = renderSystem->getCommandRecorder();
+}
+//--------------------------------------------------------------------------
+void OverlayBatchingTests::tearDown()
+{
+    if( mUnbatchablePanel )
+    {
+        mUnbatchablePanel->getParent()->removeChild( mUnbatchablePanel->getName() );
+        OGRE_DELETE mUnbatchablePanel;
+        mUnbatchablePanel = 0;
+    }
+
+    if( mOverlaySystem )
+    {
+        mSceneManager->removeRenderQueueListener( mOverlaySystem );
+        OGRE_DELETE mOverlaySystem;
+        mOverlaySystem = 0;
+    }
+
+    delete mHelper;
+    mHelper = 0;
+    mSceneManager = 0;
+    mRecorder = 0;
+    mOverlayA = 0;
+    mOverlayB = 0;
+}
+//--------------------------------------------------------------------------
+PanelOverlayElement* OverlayBatchingTests::createPanel( const String &name,
+                                                        const String &materialName )
+{
+    PanelOverlayElement *panel = static_cast<PanelOverlayElement*>(
+                OverlayManager::getSingleton().createOverlayElement( "Panel", name ) );
+    panel->setPosition( 0.1f, 0.1f );
+    panel->setDimensions( 0.2f, 0.2f );
+    panel->setMaterialName( materialName );
+    return panel;
+}
+//--------------------------------------------------------------------------
+void OverlayBatchingTests::createScene(void)
+{
+    mSceneManager = mHelper->createSceneManager();
+    mHelper->addBasicWorkspace( mSceneManager->createCamera( "OverlayBatchingTestsCamera" ) );
+
+    mOverlaySystem = OGRE_NEW OverlaySystem();
+    mSceneManager->addRenderQueueListener( mOverlaySystem );
+
+    Hlms *hlmsUnlit = mHelper->getRoot()->getHlmsManager()->getHlms( HLMS_UNLIT );
+    hlmsUnlit->createDatablock( "OverlayBatchingTests/1", "OverlayBatchingTests/1",
+                                HlmsMacroblock(), HlmsBlendblock(), HlmsParamVec() );
+    hlmsUnlit->createDatablock( "OverlayBatchingTests/2", "OverlayBatchingTests/2",
+                                HlmsMacroblock(), HlmsBlendblock(), HlmsParamVec() );
+
+    OverlayManager &overlayManager = OverlayManager::getSingleton();
+
+    //Children are kept sorted by name
+    mOverlayA = overlayManager.create( "OverlayBatchingTests/A" );
+    mOverlayA->setZOrder( 200u );
+    PanelOverlayElement *panelA = createPanel( "A", "OverlayBatchingTests/1" );
+    panelA->addChild( createPanel( "A/1", "OverlayBatchingTests/1" ) );
+    panelA->addChild( createPanel( "A/2", "OverlayBatchingTests/2" ) );
+    panelA->addChild( createPanel( "A/3", "OverlayBatchingTests/1" ) );
+    mOverlayA->add2D( panelA );
+    mOverlayA->show();
+
+    mOverlayB = overlayManager.create( "OverlayBatchingTests/B" );
+    mOverlayB->setZOrder( 100u );
+    PanelOverlayElement *panelB = createPanel( "B", "OverlayBatchingTests/2" );
+    panelB->addChild( createPanel( "B/1", "OverlayBatchingTests/2" ) );
+    panelB->addChild( createPanel( "B/2", "OverlayBatchingTests/2" ) );
+    mOverlayB->add2D( panelB );
+    mOverlayB->show();
+}
+//--------------------------------------------------------------------------
+OverlayBatchingTests::Uint32Vec OverlayBatchingTests::renderFrame(void)
+{
+    std::stringstream output;
+    mRecorder->setOutputStream( &output );
+    mRecorder->setEnabled( true );
+    mHelper->getRoot()->renderOneFrame();
+    mRecorder->setEnabled( false );
+    mRecorder->setOutputStream( 0 );
+
+    //Lines look like "draw <primCount> <instanceCount>"
+    Uint32Vec retVal;
+    String command;
+    String line;
+    while( std::getline( output, line ) )
+    {
+        std::istringstream lineStream( line );
+        lineStream >> command;
+        if( command == "draw" || command == "draw_indexed" )
+        {
+            uint32 primCount = 0;
+            lineStream >> primCount;
+            retVal.push_back( primCount );
+        }
+    }
+
+    return retVal;
+}
+//--------------------------------------------------------------------------
+void OverlayBatchingTests::testUnbatched()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createScene();
+
+    const Uint32Vec draws = renderFrame();
+
+    //One v1 draw per panel, 4 vertices each (triangle strip)
+    CPPUNIT_ASSERT_EQUAL( (size_t)7u, draws.size() );
+    for( size_t i=0; i<draws.size(); ++i )
+        CPPUNIT_ASSERT_EQUAL( 4u, draws[i] );
+
+    CPPUNIT_ASSERT( !mOverlayA->_isBatched() && !mOverlayB->_isBatched() );
+    RenderQueue *renderQueue = mSceneManager->getRenderQueue();
+    CPPUNIT_ASSERT_EQUAL( RenderQueue::V1_FAST, renderQueue->getRenderQueueMode( c_defaultRqId ) );
+}
+//--------------------------------------------------------------------------
+void OverlayBatchingTests::testBatchedDrawOrder()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createScene();
+    OverlayManager::getSingleton().setBatchingEnabled( true );
+
+    const Uint32Vec draws = renderFrame();
+
+    //B goes first (lower z-order) as a single batch of 3 quads. A is split in
+    //three runs: A & A/1 share a material, A/2 doesn't, A/3 can't join A's run.
+    CPPUNIT_ASSERT_EQUAL( (size_t)4u, draws.size() );
+    CPPUNIT_ASSERT_EQUAL( 18u, draws[0] );
+    CPPUNIT_ASSERT_EQUAL( 12u, draws[1] );
+    CPPUNIT_ASSERT_EQUAL( 6u, draws[2] );
+    CPPUNIT_ASSERT_EQUAL( 6u, draws[3] );
+
+    CPPUNIT_ASSERT( mOverlayA->_isBatched() && mOverlayB->_isBatched() );
+    RenderQueue *renderQueue = mSceneManager->getRenderQueue();
+    CPPUNIT_ASSERT_EQUAL( RenderQueue::FAST, renderQueue->getRenderQueueMode( c_defaultRqId ) );
+    CPPUNIT_ASSERT_EQUAL( RenderQueue::DisableSort,
+                          renderQueue->getSortRenderQueue( c_defaultRqId ) );
+
+    //Same result when nothing changed
+    CPPUNIT_ASSERT( draws == renderFrame() );
+}
+//--------------------------------------------------------------------------
+void OverlayBatchingTests::testUnbatchableElementFallsBack()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createScene();
+    OverlayManager::getSingleton().setBatchingEnabled( true );
+
+    mUnbatchablePanel = OGRE_NEW UnbatchablePanelOverlayElement( "A/4" );
+    mUnbatchablePanel->setPosition( 0.1f, 0.1f );
+    mUnbatchablePanel->setDimensions( 0.2f, 0.2f );
+    mUnbatchablePanel->setMaterialName( "OverlayBatchingTests/1" );
+    mUnbatchablePanel->initialise();
+    static_cast<OverlayContainer*>( mOverlayA->getChild( "A" ) )->addChild( mUnbatchablePanel );
+
+    RenderQueue *renderQueue = mSceneManager->getRenderQueue();
+
+    //Both overlays share the group; nothing gets batched, nothing is lost.
+    Uint32Vec draws = renderFrame();
+    CPPUNIT_ASSERT_EQUAL( (size_t)8u, draws.size() );
+    for( size_t i=0; i<draws.size(); ++i )
+        CPPUNIT_ASSERT_EQUAL( 4u, draws[i] );
+    CPPUNIT_ASSERT( !mOverlayA->_isBatched() && !mOverlayB->_isBatched() );
+    CPPUNIT_ASSERT_EQUAL( RenderQueue::V1_FAST, renderQueue->getRenderQueueMode( c_defaultRqId ) );
+
+    //In its own group B can be batched again
+    mOverlayB->setRenderQueueGroup( c_otherRqId );
+    draws = renderFrame();
+    CPPUNIT_ASSERT_EQUAL( (size_t)6u, draws.size() );
+    CPPUNIT_ASSERT_EQUAL( 18u, draws[0] );
+    for( size_t i=1; i<draws.size(); ++i )
+        CPPUNIT_ASSERT_EQUAL( 4u, draws[i] );
+    CPPUNIT_ASSERT( !mOverlayA->_isBatched() && mOverlayB->_isBatched() );
+    CPPUNIT_ASSERT_EQUAL( RenderQueue::FAST, renderQueue->getRenderQueueMode( c_otherRqId ) );
+    CPPUNIT_ASSERT_EQUAL( RenderQueue::V1_FAST, renderQueue->getRenderQueueMode( c_defaultRqId ) );
+
+    //Hidden elements don't count
+    mUnbatchablePanel->hide();
+    draws = renderFrame();
+    CPPUNIT_ASSERT_EQUAL( (size_t)4u, draws.size() );
+    CPPUNIT_ASSERT_EQUAL( 18u, draws[0] );
+    CPPUNIT_ASSERT_EQUAL( 12u, draws[1] );
+    CPPUNIT_ASSERT_EQUAL( 6u, draws[2] );
+    CPPUNIT_ASSERT_EQUAL( 6u, draws[3] );
+    CPPUNIT_ASSERT( mOverlayA->_isBatched() && mOverlayB->_isBatched() );
+}
+//--------------------------------------------------------------------------
+void OverlayBatchingTests::testRenderQueueModeRestored()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createScene();
+
+    RenderQueue *renderQueue = mSceneManager->getRenderQueue();
+    renderQueue->setSortRenderQueue( c_defaultRqId, RenderQueue::StableSort );
+
+    OverlayManager::getSingleton().setBatchingEnabled( true );
+    renderFrame();
+    CPPUNIT_ASSERT_EQUAL( RenderQueue::FAST, renderQueue->getRenderQueueMode( c_defaultRqId ) );
+    CPPUNIT_ASSERT_EQUAL( RenderQueue::DisableSort,
+                          renderQueue->getSortRenderQueue( c_defaultRqId ) );
+
+    OverlayManager::getSingleton().setBatchingEnabled( false );
+    const Uint32Vec draws = renderFrame();
+    CPPUNIT_ASSERT_EQUAL( RenderQueue::V1_FAST, renderQueue->getRenderQueueMode( c_defaultRqId ) );
+    CPPUNIT_ASSERT_EQUAL( RenderQueue::StableSort,
+                          renderQueue->getSortRenderQueue( c_defaultRqId ) );
+    CPPUNIT_ASSERT_EQUAL( (size_t)7u, draws.size() );
+
+    //Hiding the overlays also gives the group back
+    OverlayManager::getSingleton().setBatchingEnabled( true );
+    renderFrame();
+    CPPUNIT_ASSERT_EQUAL( RenderQueue::FAST, renderQueue->getRenderQueueMode( c_defaultRqId ) );
+    mOverlayA->hide();
+    mOverlayB->hide();
+    renderFrame();
+    CPPUNIT_ASSERT_EQUAL( RenderQueue::V1_FAST, renderQueue->getRenderQueueMode( c_defaultRqId ) );
+    CPPUNIT_ASSERT_EQUAL( RenderQueue::StableSort,
+                          renderQueue->getSortRenderQueue( c_defaultRqId ) );
+}
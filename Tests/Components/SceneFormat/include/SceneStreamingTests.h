@@ -0,0 +1,69 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef __SceneStreamingTests_H__
+#define __SceneStreamingTests_H__
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "OgrePrerequisites.h"
+
+class NullRenderSystemHelper;
+
+/// Checks the sectioned scenes of SceneFormatExporter / SceneFormatImporter.
+class SceneStreamingTests : public CppUnit::TestFixture
+{
+    // CppUnit macros for setting up the test suite
+    CPPUNIT_TEST_SUITE(SceneStreamingTests);
+    CPPUNIT_TEST(testImportScene);
+    CPPUNIT_TEST(testImportSceneSectioned);
+    CPPUNIT_TEST(testStreamSections);
+    CPPUNIT_TEST(testCorruptContainersAreRejected);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    NullRenderSystemHelper  *mHelper;
+
+    /// Builds the level and exports it both as scene.json and as scene.oscn.
+    void exportLevel(void);
+    Ogre::SceneManager* createSceneManager(void);
+    /// Checks every prop & light is under the right parent at the right position.
+    void checkLevel( Ogre::SceneManager *sceneManager );
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testImportScene();
+    void testImportSceneSectioned();
+    void testStreamSections();
+    void testCorruptContainersAreRejected();
+};
+
+#endif
@@ -0,0 +1,356 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "SceneStreamingTests.h"
+#include "NullRenderSystemHelper.h"
+
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgreItem.h"
+#include "OgreMesh2.h"
+#include "OgreMeshManager2.h"
+#include "OgreFileSystemLayer.h"
+#include "OgreStringConverter.h"
+
+#include "OgreSceneFormatExporter.h"
+#include "OgreSceneFormatImporter.h"
+
+#include "UnitTestSuite.h"
+
+#include <fstream>
+#include <iterator>
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(SceneStreamingTests);
+
+namespace
+{
+    const size_t c_numItems = 3000u;
+    const Real c_sectionSize = 100.0f;
+    const Real c_spacing = 4.0f;
+    const size_t c_itemsPerRow = 100u;
+    const size_t c_numDistricts = 4u;
+    const size_t c_lightEvery = 50u;
+    const char *c_meshName = "SceneStreamingTestsCube.mesh";
+    const char *c_jsonFolder = "SceneStreamingTests_json";
+    const char *c_sectionedFolder = "SceneStreamingTests_oscn";
+    const char *c_badFolder = "SceneStreamingTests_bad";
+    const uint32 c_exportFlags = SceneFlags::SceneNodes | SceneFlags::ForceAllSceneNodes |
+                                 SceneFlags::Items | SceneFlags::Lights | SceneFlags::Meshes |
+                                 SceneFlags::SceneSettings;
+    const ColourValue c_ambient( 0.25f, 0.5f, 0.75f, 1.0f );
+
+    Vector3 getItemPosition( size_t idx )
+    {
+        //Keep the props away from the section borders
+        return Vector3( (idx % c_itemsPerRow) * c_spacing + c_spacing * 0.5f, 0.0f,
+                        (idx / c_itemsPerRow) * c_spacing + c_spacing * 0.5f );
+    }
+
+    size_t getExpectedNumSections(void)
+    {
+        set<std::pair<int, int> >::type cells;
+        for( size_t i=0; i<c_numItems; ++i )
+        {
+            const Vector3 pos = getItemPosition( i );
+            cells.insert( std::make_pair( static_cast<int>( pos.x / c_sectionSize ),
+                                          static_cast<int>( pos.z / c_sectionSize ) ) );
+        }
+        //Section 0 holds the root nodes and the districts, which span all cells.
+        return cells.size() + 1u;
+    }
+
+    size_t countItems( SceneManager *sceneManager )
+    {
+        size_t retVal = 0;
+        SceneManager::MovableObjectIterator items =
+                sceneManager->getMovableObjectIterator( ItemFactory::FACTORY_TYPE_NAME );
+        while( items.hasMoreElements() )
+        {
+            items.getNext();
+            ++retVal;
+        }
+        return retVal;
+    }
+
+    void removeFolder( const String &folder )
+    {
+        FileSystemLayer::removeFile( folder + "/v2/" + c_meshName );
+        FileSystemLayer::removeDirectory( folder + "/v2" );
+        FileSystemLayer::removeFile( folder + "/scene.json" );
+        FileSystemLayer::removeFile( folder + "/scene.oscn" );
+        FileSystemLayer::removeDirectory( folder );
+    }
+
+    void writeFile( const String &filename, const char *data, size_t sizeBytes )
+    {
+        std::ofstream file( filename.c_str(), std::ios::binary | std::ios::out );
+        file.write( data, sizeBytes );
+    }
+}
+//--------------------------------------------------------------------------
+void SceneStreamingTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mHelper = 0;
+}
+//--------------------------------------------------------------------------
+void SceneStreamingTests::tearDown()
+{
+    removeFolder( c_jsonFolder );
+    removeFolder( c_sectionedFolder );
+    FileSystemLayer::removeFile( String( c_badFolder ) + "/scene.oscn" );
+    FileSystemLayer::removeDirectory( c_badFolder );
+
+    delete mHelper;
+    mHelper = 0;
+}
+//--------------------------------------------------------------------------
+SceneManager* SceneStreamingTests::createSceneManager(void)
+{
+    return mHelper->getRoot()->createSceneManager( ST_GENERIC, 1u,
+                                                   INSTANCING_CULLING_SINGLETHREAD );
+}
+//--------------------------------------------------------------------------
+void SceneStreamingTests::exportLevel(void)
+{
+    mHelper = new NullRenderSystemHelper();
+
+    //Keep shadow copies so the mesh can be exported.
+    MeshPtr mesh = mHelper->createCubeMesh( c_meshName, true );
+    SceneManager *sceneManager = createSceneManager();
+
+    //Props are spread among a few district nodes at the origin, so every
+    //district has children in every section (and must end up in section 0).
+    //Every c_lightEvery props, a child node above the prop holds a light.
+    SceneNode *rootNode = sceneManager->getRootSceneNode();
+    SceneNode *districts[c_numDistricts];
+    for( size_t i=0; i<c_numDistricts; ++i )
+    {
+        districts[i] = rootNode->createChildSceneNode();
+        districts[i]->setName( "District" + StringConverter::toString( i ) );
+    }
+
+    for( size_t i=0; i<c_numItems; ++i )
+    {
+        Item *item = sceneManager->createItem( c_meshName );
+        item->setName( "Prop" + StringConverter::toString( i ) );
+        SceneNode *sceneNode = districts[i % c_numDistricts]->createChildSceneNode(
+                                   SCENE_DYNAMIC, getItemPosition( i ) );
+        sceneNode->attachObject( item );
+
+        if( (i % c_lightEvery) == 0 )
+        {
+            Light *light = sceneManager->createLight();
+            light->setName( "Light" + StringConverter::toString( i ) );
+            light->setType( Light::LT_POINT );
+            sceneNode->createChildSceneNode( SCENE_DYNAMIC,
+                                             Vector3( 0, 1.0f, 0 ) )->attachObject( light );
+        }
+    }
+
+    sceneManager->setAmbientLight( c_ambient, ColourValue::Black, Vector3::UNIT_Y );
+
+    SceneFormatExporter exporter( mHelper->getRoot(), sceneManager, 0 );
+    exporter.exportSceneToFile( c_jsonFolder, c_exportFlags );
+    exporter.exportSceneSectionedToFile( c_sectionedFolder, c_sectionSize, c_exportFlags );
+
+    mHelper->getRoot()->destroySceneManager( sceneManager );
+    mesh.setNull();
+    MeshManager::getSingleton().remove( c_meshName );
+}
+//--------------------------------------------------------------------------
+void SceneStreamingTests::checkLevel( SceneManager *sceneManager )
+{
+    size_t numItemsFound = 0;
+    SceneManager::MovableObjectIterator items =
+            sceneManager->getMovableObjectIterator( ItemFactory::FACTORY_TYPE_NAME );
+    while( items.hasMoreElements() )
+    {
+        MovableObject *mo = items.getNext();
+        const String &name = mo->getName();
+        CPPUNIT_ASSERT( name.compare( 0, 4u, "Prop" ) == 0 );
+
+        const size_t idx = StringConverter::parseUnsignedInt( name.substr( 4u ) );
+        SceneNode *sceneNode = mo->getParentSceneNode();
+        CPPUNIT_ASSERT( sceneNode && sceneNode->getParent() );
+        CPPUNIT_ASSERT_EQUAL( "District" + StringConverter::toString( idx % c_numDistricts ),
+                              sceneNode->getParent()->getName() );
+        CPPUNIT_ASSERT( sceneNode->_getDerivedPositionUpdated().positionEquals(
+                            getItemPosition( idx ), 1e-3f ) );
+        ++numItemsFound;
+    }
+
+    size_t numLightsFound = 0;
+    SceneManager::MovableObjectIterator lights =
+            sceneManager->getMovableObjectIterator( LightFactory::FACTORY_TYPE_NAME );
+    while( lights.hasMoreElements() )
+    {
+        MovableObject *mo = lights.getNext();
+        const size_t idx = StringConverter::parseUnsignedInt( mo->getName().substr( 5u ) );
+        SceneNode *sceneNode = mo->getParentSceneNode();
+        CPPUNIT_ASSERT( sceneNode );
+        CPPUNIT_ASSERT( sceneNode->_getDerivedPositionUpdated().positionEquals(
+                            getItemPosition( idx ) + Vector3( 0, 1.0f, 0 ), 1e-3f ) );
+        ++numLightsFound;
+    }
+
+    CPPUNIT_ASSERT_EQUAL( c_numItems, numItemsFound );
+    CPPUNIT_ASSERT_EQUAL( (c_numItems + c_lightEvery - 1u) / c_lightEvery, numLightsFound );
+    CPPUNIT_ASSERT( sceneManager->getAmbientLightUpperHemisphere() == c_ambient );
+}
+//--------------------------------------------------------------------------
+void SceneStreamingTests::testImportScene()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    exportLevel();
+
+    SceneManager *sceneManager = createSceneManager();
+    SceneFormatImporter importer( mHelper->getRoot(), sceneManager, BLANKSTRING );
+    importer.importSceneFromFile( c_jsonFolder );
+
+    checkLevel( sceneManager );
+    mHelper->getRoot()->destroySceneManager( sceneManager );
+}
+//--------------------------------------------------------------------------
+void SceneStreamingTests::testImportSceneSectioned()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    exportLevel();
+
+    SceneManager *sceneManager = createSceneManager();
+    SceneFormatImporter importer( mHelper->getRoot(), sceneManager, BLANKSTRING );
+    importer.importSceneSectionedFromFile( c_sectionedFolder );
+
+    checkLevel( sceneManager );
+    mHelper->getRoot()->destroySceneManager( sceneManager );
+}
+//--------------------------------------------------------------------------
+void SceneStreamingTests::testStreamSections()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    exportLevel();
+
+    SceneManager *sceneManager = createSceneManager();
+    SceneFormatImporter importer( mHelper->getRoot(), sceneManager, BLANKSTRING );
+    importer.openSectionedScene( c_sectionedFolder );
+
+    //One section per grid cell, plus section 0 with the root nodes, the districts
+    //and the scene settings, which gets imported when opening.
+    const size_t numSections = importer.getNumSections();
+    CPPUNIT_ASSERT_EQUAL( getExpectedNumSections(), numSections );
+    CPPUNIT_ASSERT_EQUAL( SceneFormatImporter::SectionLoaded, importer.getSectionState( 0 ) );
+    CPPUNIT_ASSERT_EQUAL( 2u + c_numDistricts, (size_t)importer.getSection( 0 ).numSceneNodes );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0u, countItems( sceneManager ) );
+    CPPUNIT_ASSERT( sceneManager->getAmbientLightUpperHemisphere() == c_ambient );
+
+    //Only the touched section gets queued
+    importer.queueSectionsInArea( Aabb( getItemPosition( 0 ), Vector3( 0.5f ) ) );
+    size_t numQueued = 0;
+    for( size_t i=0; i<numSections; ++i )
+        numQueued += importer.getSectionState( i ) == SceneFormatImporter::SectionQueued;
+    CPPUNIT_ASSERT_EQUAL( (size_t)1u, numQueued );
+
+    for( uint32 i=0; i<numSections; ++i )
+        importer.queueSection( i );
+
+    //A tiny budget still creates at least one node or object per update.
+    size_t numUpdates = 0;
+    while( !importer.updateStreaming( 1u ) )
+    {
+        ++numUpdates;
+        CPPUNIT_ASSERT( numUpdates <= c_numItems * 4u );
+    }
+    CPPUNIT_ASSERT( numUpdates > 1u );
+
+    for( size_t i=0; i<numSections; ++i )
+        CPPUNIT_ASSERT_EQUAL( SceneFormatImporter::SectionLoaded, importer.getSectionState( i ) );
+
+    importer.closeSectionedScene();
+
+    checkLevel( sceneManager );
+    mHelper->getRoot()->destroySceneManager( sceneManager );
+}
+//--------------------------------------------------------------------------
+void SceneStreamingTests::testCorruptContainersAreRejected()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    exportLevel();
+
+    //Keep the header & table of contents of a valid file, but drop the payloads.
+    std::vector<char> fileData;
+    {
+        const String path = String( c_sectionedFolder ) + "/scene.oscn";
+        std::ifstream file( path.c_str(), std::ios::binary | std::ios::in );
+        fileData.assign( std::istreambuf_iterator<char>( file ),
+                         std::istreambuf_iterator<char>() );
+    }
+    CPPUNIT_ASSERT( fileData.size() >= 16u );
+
+    FileSystemLayer::createDirectory( c_badFolder );
+    const String badPath = String( c_badFolder ) + "/scene.oscn";
+
+    SceneManager *sceneManager = createSceneManager();
+    SceneFormatImporter importer( mHelper->getRoot(), sceneManager, BLANKSTRING );
+
+    uint32 numSections = 0;
+    memcpy( &numSections, &fileData[8], sizeof(numSections) );
+    //Garbage, a truncated table of contents (56 bytes per section after the
+    //16 bytes header), and sections out of bounds.
+    const size_t sizes[3] = { 16u, 16u + 28u, 16u + 56u * numSections };
+
+    for( size_t i=0; i<3u; ++i )
+    {
+        if( i == 0 )
+            writeFile( badPath, "This is not a scene at all", sizes[i] );
+        else
+            writeFile( badPath, &fileData[0], std::min( sizes[i], fileData.size() ) );
+
+        bool rejected = false;
+        try
+        {
+            importer.openSectionedScene( c_badFolder );
+        }
+        catch( Exception & )
+        {
+            rejected = true;
+        }
+        CPPUNIT_ASSERT( rejected );
+        importer.closeSectionedScene();
+    }
+
+    mHelper->getRoot()->destroySceneManager( sceneManager );
+}
+//--------------------------------------------------------------------------
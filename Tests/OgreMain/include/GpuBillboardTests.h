@@ -0,0 +1,73 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef __GpuBillboardTests_H__
+#define __GpuBillboardTests_H__
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "OgrePrerequisites.h"
+
+class NullRenderSystemHelper;
+
+/// Checks the static parts of GpuBillboardSet (record packing, depth keys, sorting),
+/// that the records expand to the same quads v1::BillboardSet builds, and that
+/// HlmsUnlit gives the set its own shader.
+class GpuBillboardTests : public CppUnit::TestFixture
+{
+    // CppUnit macros for setting up the test suite
+    CPPUNIT_TEST_SUITE(GpuBillboardTests);
+    CPPUNIT_TEST(testRecordSize);
+    CPPUNIT_TEST(testDepthKeysMatchScalar);
+    CPPUNIT_TEST(testSortIsBackToFrontAndStable);
+    CPPUNIT_TEST(testSortSmallInputs);
+    CPPUNIT_TEST(testShaderExpansionMatchesV1);
+#ifdef OGRE_BUILD_COMPONENT_HLMS_UNLIT
+    CPPUNIT_TEST(testHlmsHashNotSharedWithBufferless);
+#endif
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    NullRenderSystemHelper  *mHelper;
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testRecordSize();
+    void testDepthKeysMatchScalar();
+    void testSortIsBackToFrontAndStable();
+    void testSortSmallInputs();
+    void testShaderExpansionMatchesV1();
+    /// A GpuBillboardSet and a plain renderable without vertex buffers, using the
+    /// same datablock, must not share the memoised Hlms hash.
+    void testHlmsHashNotSharedWithBufferless();
+};
+
+#endif
@@ -0,0 +1,70 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __HlmsHashMemoTests_H__
+#define __HlmsHashMemoTests_H__
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "OgrePrerequisites.h"
+
+class NullRenderSystemHelper;
+
+/// Checks that HlmsManager shares blocks with the same contents, and that the
+/// memoised Hlms::calculateHashFor results match a full calculation.
+class HlmsHashMemoTests : public CppUnit::TestFixture
+{
+    // CppUnit macros for setting up the test suite
+    CPPUNIT_TEST_SUITE(HlmsHashMemoTests);
+    CPPUNIT_TEST(testBlocksInternedByContent);
+    CPPUNIT_TEST(testDestroyedBlocksForgotten);
+#ifdef OGRE_BUILD_COMPONENT_HLMS_UNLIT
+    CPPUNIT_TEST(testMemoHitMatchesFullHash);
+    CPPUNIT_TEST(testDatablockChangeInvalidatesMemo);
+#endif
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    NullRenderSystemHelper  *mHelper;
+    Ogre::HlmsManager       *mHlmsManager;
+
+public:
+    void setUp();
+    void tearDown();
+
+    /// Equal blocks are returned as the same block, different ones never are.
+    void testBlocksInternedByContent();
+    /// Blocks that reach a reference count of 0 can't be returned anymore.
+    void testDestroyedBlocksForgotten();
+    /// A memo hit returns what a full calculateHashFor would.
+    void testMemoHitMatchesFullHash();
+    /// Changing the datablock doesn't return the hash memoised before the change.
+    void testDatablockChangeInvalidatesMemo();
+};
+
+#endif
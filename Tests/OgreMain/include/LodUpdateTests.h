@@ -0,0 +1,77 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef __LodUpdateTests_H__
+#define __LodUpdateTests_H__
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "OgrePrerequisites.h"
+
+class NullRenderSystemHelper;
+
+/// Checks LodStrategy::getLodIndex and SceneManager::updateAllLods with LOD caching & hysteresis.
+class LodUpdateTests : public CppUnit::TestFixture
+{
+    // CppUnit macros for setting up the test suite
+    CPPUNIT_TEST_SUITE(LodUpdateTests);
+    CPPUNIT_TEST(testGetLodIndexWithoutHysteresis);
+    CPPUNIT_TEST(testGetLodIndexHysteresisBand);
+    CPPUNIT_TEST(testLodsMatchBruteForce);
+    CPPUNIT_TEST(testHysteresisStaysInBand);
+    CPPUNIT_TEST(testCachingSkipsRepeatedUpdates);
+    CPPUNIT_TEST(testMovingCameraInvalidatesCache);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    NullRenderSystemHelper      *mHelper;
+    Ogre::SceneManager          *mSceneManager;
+    Ogre::Camera                *mCamera;
+    Ogre::vector<Ogre::Item*>::type mItems;
+
+    /// Lines up cubes with 4 LODs in front of the camera.
+    void createCrowd(void);
+    /// Number of items whose LOD isn't the brute force one (or within the hysteresis band).
+    size_t countWrongLods( Ogre::Real hysteresis ) const;
+    /// Returns the number of cached render queues over all the frames.
+    size_t runFrames( bool caching, Ogre::Real hysteresis, size_t &outNumWrongLods );
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testGetLodIndexWithoutHysteresis();
+    void testGetLodIndexHysteresisBand();
+    void testLodsMatchBruteForce();
+    void testHysteresisStaysInBand();
+    void testCachingSkipsRepeatedUpdates();
+    void testMovingCameraInvalidatesCache();
+};
+
+#endif
@@ -0,0 +1,77 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef __MultiFrustumCullTests_H__
+#define __MultiFrustumCullTests_H__
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "OgreMovableObject.h"
+
+class NullRenderSystemHelper;
+
+/// Checks SceneManager::_cullPhase01Multi against culling each frustum on its own.
+class MultiFrustumCullTests : public CppUnit::TestFixture
+{
+    // CppUnit macros for setting up the test suite
+    CPPUNIT_TEST_SUITE(MultiFrustumCullTests);
+    CPPUNIT_TEST(testResultsMatchSingleFrustum);
+    CPPUNIT_TEST(testPreCulledResultsAreConsumed);
+    CPPUNIT_TEST(testChangedCameraFallsBack);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    NullRenderSystemHelper      *mHelper;
+    Ogre::SceneManager          *mSceneManager;
+    Ogre::Viewport              *mViewport;
+    Ogre::uint32                mVisibilityFlags;
+    /// One entry per frustum. Cubemap faces share their camera.
+    Ogre::vector<Ogre::Camera*>::type       mCameras;
+    Ogre::vector<Ogre::Quaternion>::type    mOrientations;
+    Ogre::vector<Ogre::MovableObject::MultiFrustum>::type   mMultiFrusta;
+    Ogre::vector<Ogre::MovableObject::MultiFrustum*>::type  mMultiFrustaPtrs;
+
+    /// Scatters cubes and sets up the cascade and point light frusta.
+    void createScene(void);
+    /// Sets up every frustum and culls them all in a single sweep.
+    void cullAllFrusta(void);
+    /// Culls the objects against the given frustum alone, sorted by address.
+    void cullSingleFrustum( size_t frustumIdx,
+                            Ogre::MovableObject::MovableObjectArray &outObjects ) const;
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testResultsMatchSingleFrustum();
+    void testPreCulledResultsAreConsumed();
+    void testChangedCameraFallsBack();
+};
+
+#endif
@@ -0,0 +1,77 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __NullCommandRecorderTests_H__
+#define __NullCommandRecorderTests_H__
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "OgrePrerequisites.h"
+
+namespace Ogre
+{
+    class NULLCommandRecorder;
+}
+
+class NullRenderSystemHelper;
+
+/// Renders a known scene on the NULL render system and checks the
+/// binds, draws, buffer maps and staging transfers NULLCommandRecorder counts.
+class NullCommandRecorderTests : public CppUnit::TestFixture
+{
+    // CppUnit macros for setting up the test suite
+    CPPUNIT_TEST_SUITE(NullCommandRecorderTests);
+    CPPUNIT_TEST(testDrawCounters);
+    CPPUNIT_TEST(testAccumulatedStats);
+    CPPUNIT_TEST(testOutputStream);
+    CPPUNIT_TEST(testBufferMapCounters);
+    CPPUNIT_TEST(testStagingCounters);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    NullRenderSystemHelper      *mHelper;
+    Ogre::SceneManager          *mSceneManager;
+    Ogre::NULLCommandRecorder   *mRecorder;
+
+    /** Three cubes sharing a mesh and a material, plus a fourth cube with its own
+        mesh, in front of a camera rendered by a clear + render_scene workspace.
+    */
+    void createScene(void);
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testDrawCounters();
+    void testAccumulatedStats();
+    void testOutputStream();
+    void testBufferMapCounters();
+    void testStagingCounters();
+};
+
+#endif
@@ -0,0 +1,98 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef __NullRenderSystemHelper_H__
+#define __NullRenderSystemHelper_H__
+
+#include "OgrePrerequisites.h"
+
+namespace Ogre
+{
+    class NULLPlugin;
+}
+
+/** Creates a Root running on the NULL render system, for the suites that need a
+    SceneManager, a VaoManager or a compositor workspace but no GPU.
+@remarks
+    When OgreHlmsUnlit is built, HlmsUnlit gets registered too, with the shaders
+    from Samples/Media.
+@par
+    The constructor fails the running test if the NULL render system can't be
+    started. Everything created through the helper is destroyed with it.
+*/
+class NullRenderSystemHelper
+{
+    Ogre::Root          *mRoot;
+    Ogre::RenderWindow  *mWindow;
+    Ogre::SceneManager  *mSceneManager;
+    Ogre::CompositorWorkspace   *mWorkspace;
+#ifdef OGRE_STATIC_LIB
+    Ogre::NULLPlugin    *mNullPlugin;
+#endif
+
+public:
+    NullRenderSystemHelper();
+    ~NullRenderSystemHelper();
+
+    Ogre::Root* getRoot(void) const                 { return mRoot; }
+    /// 1024x1024
+    Ogre::RenderWindow* getWindow(void) const       { return mWindow; }
+    Ogre::VaoManager* getVaoManager(void) const;
+
+    /** Creates the SceneManager the test works with. Threaded instancing culling is
+        used when numThreads > 1. Can only be called once per helper.
+    */
+    Ogre::SceneManager* createSceneManager( size_t numThreads=1u );
+    Ogre::SceneManager* getSceneManager(void) const { return mSceneManager; }
+
+    /** Adds a viewport covering the window. Its visibility mask is normally set
+        by the compositor; a mask of zero would cull everything.
+    */
+    Ogre::Viewport* addViewport( Ogre::uint32 visibilityMask=0xffffffff );
+
+    /** Creates a camera in the helper's SceneManager looking down -Z from the
+        origin, attached to a new viewport (see addViewport).
+    */
+    Ogre::Camera* createCamera( const Ogre::String &name, Ogre::uint32 visibilityMask=0xffffffff );
+
+    /** Renders camera to the window with a clear + render_scene workspace, every
+        Root::renderOneFrame. The workspace is removed by the helper.
+    */
+    Ogre::CompositorWorkspace* addBasicWorkspace( Ogre::Camera *camera );
+
+    /** Creates a cube centred at the origin with vertices at +/-1, positions only.
+    @param keepAsShadow
+        Keeps a CPU copy of the buffers, i.e. the mesh can be exported or read back.
+    */
+    static Ogre::MeshPtr createCubeMesh( Ogre::VaoManager *vaoManager, const Ogre::String &name,
+                                         bool keepAsShadow=false );
+    /// Same as above, using the helper's VaoManager.
+    Ogre::MeshPtr createCubeMesh( const Ogre::String &name, bool keepAsShadow=false );
+};
+
+#endif
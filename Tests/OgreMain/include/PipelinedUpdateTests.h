@@ -0,0 +1,73 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef __PipelinedUpdateTests_H__
+#define __PipelinedUpdateTests_H__
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "OgrePrerequisites.h"
+
+class NullRenderSystemHelper;
+
+/// Checks SceneManager::setPipelinedUpdate renders the same frames as the serial update.
+class PipelinedUpdateTests : public CppUnit::TestFixture
+{
+    // CppUnit macros for setting up the test suite
+    CPPUNIT_TEST_SUITE(PipelinedUpdateTests);
+    CPPUNIT_TEST(testRenderSeesPreviousFrame);
+    CPPUNIT_TEST(testEndsWithSameScene);
+    CPPUNIT_TEST(testRenderOneFrameWaitsForUpdate);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    NullRenderSystemHelper              *mHelper;
+    Ogre::SceneManager                  *mSceneManager;
+    Ogre::vector<Ogre::SceneNode*>::type mGroupNodes;
+    Ogre::vector<Ogre::Item*>::type     mItems;
+
+    /// Creates groups of cubes under their own nodes, updated by two worker threads.
+    void createScene(void);
+    /// Moves every group. The result only depends on the frame number.
+    void animate( size_t frame );
+    /// Folds what the renderer reads from every item into a single value.
+    double calculateChecksum(void) const;
+    /// Updates and checksums each frame serially.
+    void runSerial( size_t numFrames, Ogre::vector<double>::type &outChecksums );
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testRenderSeesPreviousFrame();
+    void testEndsWithSameScene();
+    void testRenderOneFrameWaitsForUpdate();
+};
+
+#endif
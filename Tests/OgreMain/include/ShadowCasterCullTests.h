@@ -0,0 +1,76 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef __ShadowCasterCullTests_H__
+#define __ShadowCasterCullTests_H__
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "OgreMovableObject.h"
+
+class NullRenderSystemHelper;
+
+/// Checks culling the shadow casters against a ShadowCasterVolume and the threaded casters box.
+class ShadowCasterCullTests : public CppUnit::TestFixture
+{
+    // CppUnit macros for setting up the test suite
+    CPPUNIT_TEST_SUITE(ShadowCasterCullTests);
+    CPPUNIT_TEST(testVolumeOnlyRemovesCasters);
+    CPPUNIT_TEST(testVolumeMatchesScalarTest);
+    CPPUNIT_TEST(testThreadedCastersBox);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    NullRenderSystemHelper  *mHelper;
+    Ogre::SceneManager      *mSceneManager;
+    Ogre::Camera            *mCamera;
+    Ogre::Camera            *mShadowCamera;
+    Ogre::Viewport          *mViewport;
+    Ogre::Light             *mSun;
+    Ogre::uint8             mRenderQueue;
+
+    /// Scatters cubes, some of them tall, under a low sun.
+    void createScene( size_t numThreads );
+    /** Culls the casters of the given split against the shadow camera alone, then
+        also against the volume. Both results are sorted by address.
+    */
+    void cullSplit( size_t frame, size_t split, Ogre::ShadowCasterVolume &outVolume,
+                    Ogre::MovableObject::MovableObjectArray &outCameraOnly,
+                    Ogre::MovableObject::MovableObjectArray &outWithVolume );
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testVolumeOnlyRemovesCasters();
+    void testVolumeMatchesScalarTest();
+    void testThreadedCastersBox();
+};
+
+#endif
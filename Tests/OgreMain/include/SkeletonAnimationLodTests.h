@@ -0,0 +1,81 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __SkeletonAnimationLodTests_H__
+#define __SkeletonAnimationLodTests_H__
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "OgrePrerequisites.h"
+#include "OgreSharedPtr.h"
+
+class NullRenderSystemHelper;
+
+/// Checks which animation LOD level each SkeletonInstance picks and when it updates.
+class SkeletonAnimationLodTests : public CppUnit::TestFixture
+{
+    // CppUnit macros for setting up the test suite
+    CPPUNIT_TEST_SUITE(SkeletonAnimationLodTests);
+    CPPUNIT_TEST(testLevelSelection);
+    CPPUNIT_TEST(testPhaseStaggering);
+    CPPUNIT_TEST(testLaterLodUpdatesIgnored);
+    CPPUNIT_TEST(testAnimationLodCamera);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    typedef Ogre::vector<Ogre::SkeletonInstance*>::type SkeletonInstanceVec;
+
+    NullRenderSystemHelper  *mHelper;
+    Ogre::SceneManager      *mSceneManager;
+    Ogre::Camera            *mCamera;
+    Ogre::v1::SkeletonPtr   mSkeleton;
+    Ogre::SkeletonDefPtr    mSkeletonDef;
+    SkeletonInstanceVec     mInstances;
+
+    /** Animated instances at full quality up to 20 units, every 2nd frame up to 50
+        units, and every 4th frame (root bone only) beyond that.
+    */
+    void createScene(void);
+    /// Adds an instance whose LOD source is a cube at the given distance in front of the camera.
+    Ogre::SkeletonInstance* addInstance( Ogre::Real distance );
+    /// Number of frames in [0; 8) in which the instance gets evaluated.
+    static size_t countUpdates( Ogre::SkeletonInstance *instance );
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testLevelSelection();
+    /// Instances with the same update interval are evaluated in different frames.
+    void testPhaseStaggering();
+    /// LOD updates after the first one of the frame don't change the animation LOD.
+    void testLaterLodUpdatesIgnored();
+    void testAnimationLodCamera();
+};
+
+#endif
@@ -0,0 +1,73 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef __StaticBvhCullTests_H__
+#define __StaticBvhCullTests_H__
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "OgrePrerequisites.h"
+
+class NullRenderSystemHelper;
+
+/// Checks culling static objects with a StaticObjectBvh against sweeping all of them.
+class StaticBvhCullTests : public CppUnit::TestFixture
+{
+    // CppUnit macros for setting up the test suite
+    CPPUNIT_TEST_SUITE(StaticBvhCullTests);
+    CPPUNIT_TEST(testBvhMatchesLinearSweep);
+    CPPUNIT_TEST(testBvhMatchesLinearSweepThreaded);
+    CPPUNIT_TEST(testMovedObjectsAreRefit);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    NullRenderSystemHelper  *mHelper;
+    Ogre::SceneManager      *mSceneManager;
+    Ogre::Camera            *mCamera;
+    Ogre::Viewport          *mViewport;
+    size_t                  mNumThreads;
+    Ogre::uint8             mRenderQueue;
+    Ogre::vector<Ogre::SceneNode*>::type mSceneNodes;
+
+    /// Scatters static cubes around an open world camera and builds the BVH.
+    void createScene( size_t numThreads );
+    /// Culls the static objects with the BVH and with a linear sweep, for a few
+    /// camera orientations, and checks both return the same objects.
+    void checkBvhMatchesLinearSweep(void);
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testBvhMatchesLinearSweep();
+    void testBvhMatchesLinearSweepThreaded();
+    void testMovedObjectsAreRefit();
+};
+
+#endif
@@ -0,0 +1,72 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef __StaticGeometryTests_H__
+#define __StaticGeometryTests_H__
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "OgreStaticGeometry2.h"
+
+class NullRenderSystemHelper;
+
+/// Checks StaticGeometry (v2) merges Items into per-region batches correctly.
+class StaticGeometryTests : public CppUnit::TestFixture
+{
+    // CppUnit macros for setting up the test suite
+    CPPUNIT_TEST_SUITE(StaticGeometryTests);
+    CPPUNIT_TEST(testBuildMergesRegions);
+    CPPUNIT_TEST(testMirroredProp);
+    CPPUNIT_TEST(testSaveAndLoadRegions);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    NullRenderSystemHelper  *mHelper;
+    Ogre::SceneManager      *mSceneManager;
+    Ogre::MeshPtr           mMesh;
+    Ogre::SceneNode         *mPropsNode;
+
+    /// Places a field of static props sharing a two LOD cube.
+    void createScene(void);
+    /// A cube with positions & normals and 2 LODs sharing the vertex buffer.
+    /// LOD 1 only keeps the first two faces.
+    void createLodCubeMesh(void);
+    /// Checks every region against the props expected to fall into it.
+    void checkRegions( const Ogre::StaticGeometry &staticGeometry );
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testBuildMergesRegions();
+    void testMirroredProp();
+    void testSaveAndLoadRegions();
+};
+
+#endif
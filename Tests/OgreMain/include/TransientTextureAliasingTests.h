@@ -0,0 +1,78 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef __TransientTextureAliasingTests_H__
+#define __TransientTextureAliasingTests_H__
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "OgrePrerequisites.h"
+
+class NullRenderSystemHelper;
+
+/** Checks CompositorWorkspace::setTransientTextureAliasing on a chain of nodes where
+    each node reads the output of the previous one and renders to its own local texture
+    (like a chain of blur or downsample passes), plus a texture whose contents must
+    survive across frames. Only every other texture in the chain needs memory.
+*/
+class TransientTextureAliasingTests : public CppUnit::TestFixture
+{
+    // CppUnit macros for setting up the test suite
+    CPPUNIT_TEST_SUITE(TransientTextureAliasingTests);
+    CPPUNIT_TEST(testAssignAllocations);
+    CPPUNIT_TEST(testOffByDefault);
+    CPPUNIT_TEST(testChainIsAliased);
+    CPPUNIT_TEST(testResize);
+    CPPUNIT_TEST(testReconnect);
+    CPPUNIT_TEST(testDisable);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    NullRenderSystemHelper      *mHelper;
+    Ogre::SceneManager          *mSceneManager;
+    Ogre::CompositorWorkspace   *mWorkspace;
+
+    /// Instantiates the chain workspace rendering to the window.
+    void createWorkspace(void);
+    void createChainWorkspaceDef(void);
+    void checkChain(void);
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testAssignAllocations();
+    void testOffByDefault();
+    void testChainIsAliased();
+    void testResize();
+    void testReconnect();
+    void testDisable();
+};
+
+#endif
@@ -0,0 +1,74 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef __VertexConversionTests_H__
+#define __VertexConversionTests_H__
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "OgrePrerequisites.h"
+
+class NullRenderSystemHelper;
+
+/// Checks the float -> half and TBN -> QTangent conversions of SubMesh::_arrangeEfficient
+/// against Bitwise::floatToHalfI and the per-vertex Matrix3 -> Quaternion path, and that
+/// converting through the SceneManager's worker threads gives the same buffers.
+class VertexConversionTests : public CppUnit::TestFixture
+{
+    // CppUnit macros for setting up the test suite
+    CPPUNIT_TEST_SUITE(VertexConversionTests);
+    CPPUNIT_TEST(testHalfSpecialValues);
+    CPPUNIT_TEST(testQTangentFloat4Tangent);
+    CPPUNIT_TEST(testQTangentFloat3Tangent);
+    CPPUNIT_TEST(testQTangentWithBinormal);
+    CPPUNIT_TEST(testThreadedImportMatchesSerial);
+    CPPUNIT_TEST(testThreadedArrangeEfficientMatchesSerial);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    NullRenderSystemHelper  *mHelper;
+    Ogre::SceneManager      *mSceneManager;
+
+    /// Creates a SceneManager whose worker threads run the threaded conversion.
+    void createScene(void);
+    void testConversion( bool hasBinormal, bool hasTangentW );
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testHalfSpecialValues();
+    void testQTangentFloat4Tangent();
+    void testQTangentFloat3Tangent();
+    void testQTangentWithBinormal();
+    void testThreadedImportMatchesSerial();
+    void testThreadedArrangeEfficientMatchesSerial();
+};
+
+#endif
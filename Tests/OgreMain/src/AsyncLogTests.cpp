@@ -0,0 +1,229 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "AsyncLogTests.h"
+#include "OgreLogManager.h"
+#include "OgreStringConverter.h"
+#include "Threading/OgreThreads.h"
+
+#include "UnitTestSuite.h"
+
+#include <fstream>
+#include <cstdio>
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(AsyncLogTests);
+
+namespace
+{
+    const char *c_logName = "AsyncLogTests_Output.log";
+    const size_t c_numThreads = 4u;
+
+    struct ProducerParams
+    {
+        Log     *log;
+        size_t  threadIdx;
+        size_t  numMessages;
+    };
+
+    struct LogContents
+    {
+        size_t  numMessages;
+        size_t  numDropReports;
+        bool    inOrder;
+    };
+
+    /// Counts every message it sees, skipping none.
+    class CountingListener : public LogListener
+    {
+    public:
+        size_t mNumMessages;
+
+        CountingListener() : mNumMessages( 0 ) {}
+
+        virtual void messageLogged( const String &message, LogMessageLevel lml, bool maskDebug,
+                                    const String &logName, bool &skipThisMessage )
+        {
+            ++mNumMessages;
+        }
+    };
+
+    unsigned long producerThread( ThreadHandle *threadHandle )
+    {
+        ProducerParams *params = reinterpret_cast<ProducerParams*>( threadHandle->getUserParam() );
+
+        const String prefix = "Thread " + StringConverter::toString( params->threadIdx ) +
+                              " Message ";
+        for( size_t i=0; i<params->numMessages; ++i )
+            params->log->logMessage( prefix + StringConverter::toString( i ) );
+
+        return 0;
+    }
+    THREAD_DECLARE( producerThread );
+
+    void runProducers( Log *log, size_t numThreads, size_t messagesPerThread )
+    {
+        vector<ProducerParams>::type params( numThreads );
+        ThreadHandleVec threadHandles;
+        threadHandles.reserve( numThreads );
+
+        for( size_t i=0; i<numThreads; ++i )
+        {
+            params[i].log           = log;
+            params[i].threadIdx     = i;
+            params[i].numMessages   = messagesPerThread;
+            threadHandles.push_back( Threads::CreateThread( THREAD_GET( producerThread ),
+                                                            i, &params[i] ) );
+        }
+
+        Threads::WaitForThreads( threadHandles );
+    }
+
+    /// Counts the producers' lines in the output log, checking each thread's are in order.
+    LogContents parseLog(void)
+    {
+        LogContents retVal;
+        retVal.numMessages      = 0;
+        retVal.numDropReports   = 0;
+        retVal.inOrder          = true;
+
+        vector<long>::type lastIdx( c_numThreads, -1 );
+
+        std::ifstream file( c_logName );
+        std::string line;
+        while( std::getline( file, line ) )
+        {
+            unsigned int threadIdx;
+            long messageIdx;
+            const size_t threadPos = line.find( "Thread " );
+            const size_t messagePos = line.rfind( "Message " );
+
+            if( threadPos != std::string::npos && messagePos != std::string::npos &&
+                sscanf( line.c_str() + threadPos, "Thread %u", &threadIdx ) == 1 &&
+                sscanf( line.c_str() + messagePos, "Message %ld", &messageIdx ) == 1 &&
+                threadIdx < c_numThreads )
+            {
+                ++retVal.numMessages;
+                retVal.inOrder &= messageIdx > lastIdx[threadIdx];
+                lastIdx[threadIdx] = messageIdx;
+            }
+            else if( line.find( "dropped because the async queue was full" ) != std::string::npos )
+            {
+                ++retVal.numDropReports;
+            }
+        }
+
+        return retVal;
+    }
+}
+//--------------------------------------------------------------------------
+void AsyncLogTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mLog = LogManager::getSingleton().createLog( c_logName, false, false, false );
+    mLog->setLogDetail( LL_BOREME );
+}
+//--------------------------------------------------------------------------
+void AsyncLogTests::tearDown()
+{
+    LogManager::getSingleton().destroyLog( mLog );
+    mLog = 0;
+    std::remove( c_logName );
+}
+//--------------------------------------------------------------------------
+void AsyncLogTests::testSynchronousKeepsEveryMessage()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    //Without OGRE_THREAD_SUPPORT the synchronous path doesn't lock,
+    //so lines from several threads can get mangled.
+    const size_t numThreads = OGRE_THREAD_SUPPORT ? c_numThreads : 1u;
+    runProducers( mLog, numThreads, 1000u );
+
+    const LogContents contents = parseLog();
+    CPPUNIT_ASSERT_EQUAL( numThreads * 1000u, contents.numMessages );
+    CPPUNIT_ASSERT( contents.inOrder );
+}
+//--------------------------------------------------------------------------
+void AsyncLogTests::testFlushWritesEverything()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const size_t messagesPerThread = 2000u;
+    mLog->setAsyncEnabled( true, 8192u );
+    CPPUNIT_ASSERT( mLog->isAsyncEnabled() );
+
+    runProducers( mLog, c_numThreads, messagesPerThread );
+    //flush() must have written everything before returning, while the Log is still alive.
+    mLog->flush();
+    CPPUNIT_ASSERT_EQUAL( (uint32)0, mLog->getNumDroppedMessages() );
+
+    const LogContents contents = parseLog();
+    CPPUNIT_ASSERT_EQUAL( c_numThreads * messagesPerThread, contents.numMessages );
+    CPPUNIT_ASSERT( contents.inOrder );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0, contents.numDropReports );
+}
+//--------------------------------------------------------------------------
+void AsyncLogTests::testFullQueueDropsAreCounted()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const size_t messagesPerThread = 2000u;
+    mLog->setAsyncEnabled( true, 16u );
+    runProducers( mLog, c_numThreads, messagesPerThread );
+    mLog->setAsyncEnabled( false );
+    CPPUNIT_ASSERT( !mLog->isAsyncEnabled() );
+
+    //Every message is either written or counted as dropped, and drops are reported.
+    const size_t numDropped = mLog->getNumDroppedMessages();
+    const LogContents contents = parseLog();
+    CPPUNIT_ASSERT_EQUAL( c_numThreads * messagesPerThread, contents.numMessages + numDropped );
+    CPPUNIT_ASSERT( contents.inOrder );
+    CPPUNIT_ASSERT( numDropped == 0 || contents.numDropReports != 0 );
+
+    //Back in synchronous mode, it must keep working.
+    mLog->logMessage( "Thread 0 Message 999999999" );
+    CPPUNIT_ASSERT_EQUAL( contents.numMessages + 1u, parseLog().numMessages );
+}
+//--------------------------------------------------------------------------
+void AsyncLogTests::testListenersSeeAsyncMessages()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    CountingListener listener;
+
+    mLog->setAsyncEnabled( true, 1024u );
+    mLog->addListener( &listener );
+    runProducers( mLog, 1u, 1000u );
+    mLog->flush();
+    mLog->removeListener( &listener );
+
+    CPPUNIT_ASSERT_EQUAL( (size_t)1000u, listener.mNumMessages );
+}
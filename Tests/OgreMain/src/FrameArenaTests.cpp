@@ -0,0 +1,238 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "FrameArenaTests.h"
+#include "NullRenderSystemHelper.h"
+
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgreItem.h"
+#include "OgreLight.h"
+#include "OgreMesh2.h"
+#include "OgreFrameArena.h"
+
+#include "UnitTestSuite.h"
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(FrameArenaTests);
+
+namespace
+{
+    const Real c_worldSize = 200.0f;
+
+    Vector3 randomPosition(void)
+    {
+        return Vector3( Math::RangeRandom( -c_worldSize, c_worldSize ) * 0.5f,
+                        Math::RangeRandom( 0.0f, 10.0f ),
+                        Math::RangeRandom( -c_worldSize, c_worldSize ) * 0.5f );
+    }
+}
+//--------------------------------------------------------------------------
+void FrameArenaTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mHelper = 0;
+}
+//--------------------------------------------------------------------------
+void FrameArenaTests::tearDown()
+{
+    delete mHelper;
+    mHelper = 0;
+}
+//--------------------------------------------------------------------------
+void FrameArenaTests::testAllocationsAreAligned()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    FrameArena frameArena( 256u );
+
+    //Odd sizes, enough of them to spill into the overflow blocks
+    for( size_t i=0; i<64u; ++i )
+    {
+        const void *ptr = frameArena.allocate( i * 3u + 1u );
+        CPPUNIT_ASSERT( ptr != 0 );
+        CPPUNIT_ASSERT_EQUAL( (size_t)0, reinterpret_cast<size_t>( ptr ) % OGRE_SIMD_ALIGNMENT );
+    }
+
+    CPPUNIT_ASSERT( frameArena.allocate( 0 ) != 0 );
+}
+//--------------------------------------------------------------------------
+void FrameArenaTests::testRewind()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    FrameArena frameArena( 1024u );
+
+    frameArena.allocate( 100u );
+    const size_t usedBytes = frameArena.getUsedBytes();
+    const FrameArena::Marker marker = frameArena.getMarker();
+    const void *first = frameArena.allocate( 200u );
+    frameArena.allocate( 300u );
+    frameArena.rewind( marker );
+
+    CPPUNIT_ASSERT_EQUAL( usedBytes, frameArena.getUsedBytes() );
+    CPPUNIT_ASSERT( frameArena.allocate( 200u ) == first );
+    //Rewinding doesn't forget the peak
+    CPPUNIT_ASSERT( frameArena.getHighWaterMark() >= usedBytes + 500u );
+}
+//--------------------------------------------------------------------------
+void FrameArenaTests::testOverflowGrowsMainBlock()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    FrameArena frameArena( 1024u );
+    const size_t initialHeapAllocations = frameArena.getNumHeapAllocations();
+
+    for( size_t frame=0; frame<4u; ++frame )
+    {
+        for( size_t i=0; i<16u; ++i )
+            frameArena.allocate( 1000u );
+        frameArena.reset();
+
+        if( frame == 0u )
+        {
+            //Overflowed, then the main block got reallocated to fit the whole frame
+            CPPUNIT_ASSERT( frameArena.getNumHeapAllocations() > initialHeapAllocations );
+            CPPUNIT_ASSERT( frameArena.getCapacity() >= frameArena.getHighWaterMark() );
+        }
+    }
+
+    //Same working set every frame: only the first one touched the heap
+    const size_t heapAllocations = frameArena.getNumHeapAllocations();
+    for( size_t i=0; i<16u; ++i )
+        frameArena.allocate( 1000u );
+    frameArena.reset();
+    CPPUNIT_ASSERT_EQUAL( heapAllocations, frameArena.getNumHeapAllocations() );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0, frameArena.getUsedBytes() );
+}
+//--------------------------------------------------------------------------
+void FrameArenaTests::testStableSortMatchesStd()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    FrameArena frameArena;
+
+    //Sizes around the insertion sort runs and the merge passes
+    const size_t c_sizes[] = { 0u, 1u, 2u, 15u, 16u, 17u, 40u, 100u, 1000u };
+
+    for( size_t i=0; i<sizeof(c_sizes) / sizeof(c_sizes[0]); ++i )
+    {
+        //Few distinct distances, so that stability matters.
+        vector<LightClosest>::type sortedStd;
+        for( size_t j=0; j<c_sizes[i]; ++j )
+            sortedStd.push_back( LightClosest( 0, j, static_cast<Real>( rand() % 8 ) ) );
+        vector<LightClosest>::type sortedArena( sortedStd );
+
+        std::stable_sort( sortedStd.begin(), sortedStd.end() );
+        stableSortWithArena( sortedArena.begin(), sortedArena.end(), frameArena );
+
+        for( size_t j=0; j<c_sizes[i]; ++j )
+        {
+            CPPUNIT_ASSERT_EQUAL( sortedStd[j].distance, sortedArena[j].distance );
+            CPPUNIT_ASSERT_EQUAL( sortedStd[j].globalIndex, sortedArena[j].globalIndex );
+        }
+
+        //The merge buffer was given back
+        CPPUNIT_ASSERT_EQUAL( (size_t)0, frameArena.getUsedBytes() );
+    }
+}
+//--------------------------------------------------------------------------
+void FrameArenaTests::testSceneSteadyStateUsesNoHeap()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    mHelper = new NullRenderSystemHelper();
+
+    const size_t numItems = 1000u;
+    const size_t numLights = 100u;
+    const size_t numMovingLights = 10u;
+
+    SceneManager *sceneManager = mHelper->createSceneManager();
+    MeshPtr mesh = mHelper->createCubeMesh( "FrameArenaTestsCube" );
+    SceneNode *rootNode = sceneManager->getRootSceneNode();
+
+    vector<Item*>::type items;
+    for( size_t i=0; i<numItems; ++i )
+    {
+        Item *item = sceneManager->createItem( mesh );
+        SceneNode *sceneNode = rootNode->createChildSceneNode();
+        sceneNode->setPosition( randomPosition() );
+        sceneNode->attachObject( item );
+        items.push_back( item );
+    }
+
+    vector<SceneNode*>::type lightNodes;
+    for( size_t i=0; i<numLights; ++i )
+    {
+        Light *light = sceneManager->createLight();
+        light->setType( Light::LT_POINT );
+        light->setAttenuation( 40.0f, 1.0f, 0.0f, 0.0f );
+        SceneNode *sceneNode = rootNode->createChildSceneNode();
+        sceneNode->setPosition( randomPosition() );
+        sceneNode->attachObject( light );
+        lightNodes.push_back( sceneNode );
+    }
+
+    //Warm up: let the arenas reach their size.
+    for( size_t frame=0; frame<5u; ++frame )
+    {
+        sceneManager->updateSceneGraph();
+        sceneManager->_frameEnded();
+    }
+
+    const size_t heapAllocations = sceneManager->getFrameArenaHeapAllocations();
+
+    for( size_t frame=0; frame<10u; ++frame )
+    {
+        //Only moves lights around within the area they already cover, so the
+        //working set stays the same.
+        for( size_t i=0; i<numMovingLights; ++i )
+        {
+            SceneNode *lightNode = lightNodes[(frame * numMovingLights + i) % numLights];
+            lightNode->setPosition( lightNode->getPosition() * -1.0f );
+        }
+
+        sceneManager->updateSceneGraph();
+
+        vector<Item*>::type::const_iterator itor = items.begin();
+        vector<Item*>::type::const_iterator end  = items.end();
+        while( itor != end )
+        {
+            const LightList &lightList = (*itor)->queryLights();
+            for( size_t i=1; i<lightList.size(); ++i )
+                CPPUNIT_ASSERT( lightList[i - 1u].distance <= lightList[i].distance );
+            ++itor;
+        }
+
+        sceneManager->_frameEnded();
+    }
+
+    CPPUNIT_ASSERT_EQUAL( heapAllocations, sceneManager->getFrameArenaHeapAllocations() );
+}
@@ -0,0 +1,454 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "GpuBillboardTests.h"
+#include "NullRenderSystemHelper.h"
+
+#include "OgreGpuBillboardSet.h"
+#include "OgreMath.h"
+#include "OgreVector2.h"
+#include "OgreVector4.h"
+#include "OgreQuaternion.h"
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgreHlmsManager.h"
+#include "OgreHlms.h"
+#include "Vao/OgreVaoManager.h"
+#include "Vao/OgreVertexArrayObject.h"
+
+#include "UnitTestSuite.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(GpuBillboardTests);
+
+namespace
+{
+    struct SourceBillboard
+    {
+        Vector3     position;
+        Vector2     size;
+        ColourValue colour;
+        Radian      rotation;
+        uint32      uvRectIdx;
+    };
+    typedef vector<SourceBillboard>::type SourceBillboardVec;
+
+    /// Same layout v1::BillboardSet writes: float3 position, RGBA8 colour, float2 uv.
+    struct V1Vertex
+    {
+        float   position[3];
+        uint32  colour;
+        float   uv[2];
+    };
+    typedef vector<V1Vertex>::type V1VertexVec;
+    typedef vector<uint64>::type Uint64Vec;
+
+    const size_t c_numBillboards = 2000u;
+    const size_t c_numUvRects = 16u;
+
+    void generateBillboards( SourceBillboardVec &outBillboards )
+    {
+        outBillboards.resize( c_numBillboards );
+        for( size_t i=0; i<c_numBillboards; ++i )
+        {
+            SourceBillboard &billboard = outBillboards[i];
+            billboard.position = Vector3( Math::RangeRandom( -500.0f, 500.0f ),
+                                          Math::RangeRandom( -50.0f, 50.0f ),
+                                          Math::RangeRandom( -500.0f, 500.0f ) );
+            billboard.size      = Vector2( Math::RangeRandom( 0.5f, 4.0f ),
+                                           Math::RangeRandom( 0.5f, 4.0f ) );
+            billboard.colour    = ColourValue( Math::UnitRandom(), Math::UnitRandom(),
+                                               Math::UnitRandom(), Math::UnitRandom() );
+            billboard.rotation  = Radian( Math::RangeRandom( -Math::PI, Math::PI ) );
+            billboard.uvRectIdx = static_cast<uint32>( i % c_numUvRects );
+        }
+
+        //Some billboards at exactly the same depth, to check the sort is stable.
+        for( size_t i=1; i<c_numBillboards; i += 97u )
+            outBillboards[i].position = outBillboards[i - 1u].position;
+    }
+
+    void generateUvRects( Vector4 *outUvRects )
+    {
+        //4x4 atlas, like setTextureStacksAndSlices( 4, 4 )
+        for( size_t i=0; i<c_numUvRects; ++i )
+        {
+            const float u = (i % 4u) * 0.25f;
+            const float v = (i / 4u) * 0.25f;
+            outUvRects[i] = Vector4( u, v, u + 0.25f, v + 0.25f );
+        }
+    }
+
+    void packRecords( const SourceBillboardVec &billboards, GpuBillboardSet::RecordArray &outRecords )
+    {
+        outRecords.resize( billboards.size() );
+        for( size_t i=0; i<billboards.size(); ++i )
+        {
+            const SourceBillboard &billboard = billboards[i];
+            GpuBillboardSet::packRecord( outRecords[i], billboard.position, billboard.size * 0.5f,
+                                         billboard.colour, billboard.rotation,
+                                         billboard.uvRectIdx );
+        }
+    }
+
+    const Quaternion& getCameraOrientation(void)
+    {
+        static const Quaternion camOrientation( Degree( 30 ),
+                                                Vector3( 0.3f, 1.0f, 0.2f ).normalisedCopy() );
+        return camOrientation;
+    }
+
+    /// Plain loop version of GpuBillboardSet::computeDepthKeys.
+    void computeDepthKeysScalar( const GpuBillboardSet::Record *records, size_t numRecords,
+                                 const Vector3 &viewDir, uint64 *outKeys )
+    {
+        const float dirX = static_cast<float>( viewDir.x );
+        const float dirY = static_cast<float>( viewDir.y );
+        const float dirZ = static_cast<float>( viewDir.z );
+
+        for( size_t i=0; i<numRecords; ++i )
+        {
+            const float *pos = records[i].position;
+            const float depth = pos[0] * dirX + pos[1] * dirY + pos[2] * dirZ;
+
+            uint32 bits;
+            memcpy( &bits, &depth, sizeof( bits ) );
+            bits = (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+            outKeys[i] = (static_cast<uint64>( ~bits ) << 32u) | i;
+        }
+    }
+
+    /// What v1::BillboardSet::genVertOffsets + genVertices do per billboard
+    /// (point billboards, BBR_VERTEX rotation, own dimensions).
+    void expandV1Style( const SourceBillboard &billboard, const Vector4 *uvRects,
+                        const Vector3 &camRight, const Vector3 &camUp, V1Vertex *outVertices )
+    {
+        //Top left, top right, bottom left, bottom right.
+        const float c_cornerX[4] = { -1.0f, 1.0f, -1.0f, 1.0f };
+        const float c_cornerY[4] = {  1.0f, 1.0f, -1.0f, -1.0f };
+
+        const Real cosRot = Math::Cos( billboard.rotation );
+        const Real sinRot = Math::Sin( billboard.rotation );
+        const Vector3 axisX = ( camRight * cosRot + camUp * sinRot) * (billboard.size.x * 0.5f);
+        const Vector3 axisY = (-camRight * sinRot + camUp * cosRot) * (billboard.size.y * 0.5f);
+        const Vector4 &uvRect = uvRects[billboard.uvRectIdx];
+
+        for( size_t i=0; i<4u; ++i )
+        {
+            const Vector3 pos = billboard.position + axisX * c_cornerX[i] + axisY * c_cornerY[i];
+            outVertices[i].position[0] = static_cast<float>( pos.x );
+            outVertices[i].position[1] = static_cast<float>( pos.y );
+            outVertices[i].position[2] = static_cast<float>( pos.z );
+            outVertices[i].colour = billboard.colour.getAsABGR();
+            outVertices[i].uv[0] = static_cast<float>( c_cornerX[i] < 0 ? uvRect.x : uvRect.z );
+            outVertices[i].uv[1] = static_cast<float>( c_cornerY[i] > 0 ? uvRect.y : uvRect.w );
+        }
+    }
+
+    /// CPU version of the vertex shader's unlit_vertex_pulling path.
+    V1Vertex expandLikeShader( const float *texBuffer, uint32 vertexId )
+    {
+        const uint32 billboardIdx   = vertexId / 6u;
+        const uint32 cornerIdx      = vertexId % 6u;
+        const float cornerX = static_cast<float>( (0x32u >> cornerIdx) & 1u ) * 2.0f - 1.0f;
+        const float cornerY = static_cast<float>( (0x2Cu >> cornerIdx) & 1u ) * 2.0f - 1.0f;
+
+        const float *billboardRight = texBuffer;
+        const float *billboardUp    = texBuffer + 4u;
+        uint32 recordStart;
+        memcpy( &recordStart, &billboardRight[3], sizeof( recordStart ) );
+        const float *record0 = texBuffer + (recordStart + (billboardIdx << 1u)) * 4u;
+        const float *record1 = record0 + 4u;
+
+        const float offsetX = cornerX * record1[0];
+        const float offsetY = cornerY * record1[1];
+        const float sinRot = sinf( record0[3] );
+        const float cosRot = cosf( record0[3] );
+        const float rotatedX = offsetX * cosRot - offsetY * sinRot;
+        const float rotatedY = offsetX * sinRot + offsetY * cosRot;
+
+        V1Vertex retVal;
+        for( size_t i=0; i<3u; ++i )
+        {
+            retVal.position[i] = record0[i] + billboardRight[i] * rotatedX +
+                                 billboardUp[i] * rotatedY;
+        }
+        memcpy( &retVal.colour, &record1[2], sizeof( uint32 ) );
+
+        uint32 uvRectIdx;
+        memcpy( &uvRectIdx, &record1[3], sizeof( uvRectIdx ) );
+        const float *uvRect = texBuffer + (2u + uvRectIdx) * 4u;
+        retVal.uv[0] = cornerX < 0.0f ? uvRect[0] : uvRect[2];
+        retVal.uv[1] = cornerY > 0.0f ? uvRect[1] : uvRect[3];
+        return retVal;
+    }
+
+    float getDepth( const GpuBillboardSet::Record &record, const Vector3 &viewDir )
+    {
+        return record.position[0] * viewDir.x + record.position[1] * viewDir.y +
+               record.position[2] * viewDir.z;
+    }
+
+    /// Draws a fullscreen triangle from gl_VertexID. Like GpuBillboardSet its Vao has
+    /// no vertex buffers, but it doesn't set GpuBillboardSet::CustomParameterIdx.
+    class BufferlessRenderable : public Renderable
+    {
+        VaoManager  *mVaoManager;
+
+    public:
+        BufferlessRenderable( VaoManager *vaoManager ) :
+            mVaoManager( vaoManager )
+        {
+            VertexBufferPackedVec vertexBuffers;
+            VertexArrayObject *vao = vaoManager->createVertexArrayObject( vertexBuffers, 0,
+                                                                          OT_TRIANGLE_LIST );
+            vao->setPrimitiveRange( 0, 3u );
+            mVaoPerLod[VpNormal].push_back( vao );
+            mVaoPerLod[VpShadow].push_back( vao );
+        }
+
+        virtual ~BufferlessRenderable()
+        {
+            mVaoManager->destroyVertexArrayObject( mVaoPerLod[VpNormal][0] );
+            mVaoPerLod[VpNormal].clear();
+            mVaoPerLod[VpShadow].clear();
+        }
+
+        virtual const LightList& getLights(void) const
+        {
+            static const LightList c_noLights;
+            return c_noLights;
+        }
+        virtual void getRenderOperation( v1::RenderOperation& op, bool casterPass )
+        {
+            OGRE_EXCEPT( Exception::ERR_NOT_IMPLEMENTED, "", "BufferlessRenderable" );
+        }
+        virtual void getWorldTransforms( Matrix4* xform ) const
+        {
+            *xform = Matrix4::IDENTITY;
+        }
+    };
+}
+//--------------------------------------------------------------------------
+void GpuBillboardTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mHelper = 0;
+}
+//--------------------------------------------------------------------------
+void GpuBillboardTests::tearDown()
+{
+    delete mHelper;
+    mHelper = 0;
+}
+//--------------------------------------------------------------------------
+void GpuBillboardTests::testRecordSize()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    //Two float4 texels, as read by the vertex shader
+    CPPUNIT_ASSERT_EQUAL( (size_t)32u, sizeof(GpuBillboardSet::Record) );
+}
+//--------------------------------------------------------------------------
+void GpuBillboardTests::testDepthKeysMatchScalar()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    SourceBillboardVec billboards;
+    generateBillboards( billboards );
+    GpuBillboardSet::RecordArray records;
+    packRecords( billboards, records );
+
+    const Vector3 viewDir = getCameraOrientation() * Vector3::NEGATIVE_UNIT_Z;
+
+    //Odd count so the SIMD path also has a remainder
+    const size_t numRecords = c_numBillboards - 3u;
+    Uint64Vec scalarKeys( numRecords );
+    Uint64Vec keys( numRecords );
+    computeDepthKeysScalar( records.begin(), numRecords, viewDir, &scalarKeys[0] );
+    GpuBillboardSet::computeDepthKeys( records.begin(), numRecords, viewDir, &keys[0] );
+
+    CPPUNIT_ASSERT( keys == scalarKeys );
+}
+//--------------------------------------------------------------------------
+void GpuBillboardTests::testSortIsBackToFrontAndStable()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    SourceBillboardVec billboards;
+    generateBillboards( billboards );
+    GpuBillboardSet::RecordArray records;
+    packRecords( billboards, records );
+
+    const Vector3 viewDir = getCameraOrientation() * Vector3::NEGATIVE_UNIT_Z;
+
+    Uint64Vec keys( c_numBillboards );
+    Uint64Vec scratch( c_numBillboards );
+    GpuBillboardSet::computeDepthKeys( records.begin(), c_numBillboards, viewDir, &keys[0] );
+
+    //Indices are unique, so std::sort on the whole uint64 gives the stable order.
+    Uint64Vec reference( keys );
+    std::sort( reference.begin(), reference.end() );
+    GpuBillboardSet::sortBackToFront( &keys[0], &scratch[0], c_numBillboards );
+    CPPUNIT_ASSERT( keys == reference );
+
+    for( size_t i=1; i<c_numBillboards; ++i )
+    {
+        const uint64 prev = keys[i - 1u];
+        const uint64 curr = keys[i];
+        CPPUNIT_ASSERT( getDepth( records[static_cast<uint32>( prev )], viewDir ) >=
+                        getDepth( records[static_cast<uint32>( curr )], viewDir ) );
+        //Equal keys must keep the original order.
+        if( (prev >> 32u) == (curr >> 32u) )
+            CPPUNIT_ASSERT( static_cast<uint32>( prev ) < static_cast<uint32>( curr ) );
+    }
+}
+//--------------------------------------------------------------------------
+void GpuBillboardTests::testSortSmallInputs()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    SourceBillboardVec billboards;
+    generateBillboards( billboards );
+    GpuBillboardSet::RecordArray records;
+    packRecords( billboards, records );
+
+    const Vector3 viewDir = getCameraOrientation() * Vector3::NEGATIVE_UNIT_Z;
+
+    //Fewer billboards than a SIMD block
+    Uint64Vec keys( 5u );
+    Uint64Vec scratch( 5u );
+    GpuBillboardSet::computeDepthKeys( records.begin(), 5u, viewDir, &keys[0] );
+    Uint64Vec reference( keys );
+    std::sort( reference.begin(), reference.end() );
+    GpuBillboardSet::sortBackToFront( &keys[0], &scratch[0], 5u );
+    CPPUNIT_ASSERT( keys == reference );
+
+    const uint64 singleKey = keys[0];
+    GpuBillboardSet::sortBackToFront( &keys[0], &scratch[0], 1u );
+    CPPUNIT_ASSERT_EQUAL( singleKey, keys[0] );
+    GpuBillboardSet::sortBackToFront( 0, 0, 0 );
+}
+//--------------------------------------------------------------------------
+void GpuBillboardTests::testShaderExpansionMatchesV1()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    SourceBillboardVec billboards;
+    generateBillboards( billboards );
+    GpuBillboardSet::RecordArray records;
+    packRecords( billboards, records );
+
+    Vector4 uvRects[c_numUvRects];
+    generateUvRects( uvRects );
+
+    const Vector3 camRight  = getCameraOrientation() * Vector3::UNIT_X;
+    const Vector3 camUp     = getCameraOrientation() * Vector3::UNIT_Y;
+
+    //Same layout GpuBillboardSet::updateGpuData uploads (unsorted, identity transform).
+    const uint32 recordStart = static_cast<uint32>( 2u + c_numUvRects );
+    vector<float>::type texBuffer( (recordStart + c_numBillboards * 2u) * 4u );
+    texBuffer[0] = camRight.x;
+    texBuffer[1] = camRight.y;
+    texBuffer[2] = camRight.z;
+    memcpy( &texBuffer[3], &recordStart, sizeof( uint32 ) );
+    texBuffer[4] = camUp.x;
+    texBuffer[5] = camUp.y;
+    texBuffer[6] = camUp.z;
+    texBuffer[7] = 0;
+    for( size_t i=0; i<c_numUvRects; ++i )
+    {
+        for( size_t j=0; j<4u; ++j )
+            texBuffer[(2u + i) * 4u + j] = uvRects[i][j];
+    }
+    memcpy( &texBuffer[recordStart * 4u], records.begin(),
+            c_numBillboards * sizeof( GpuBillboardSet::Record ) );
+
+    //Shader corners (-1,-1) (1,-1) (-1,1) (-1,1) (1,-1) (1,1) in v1's order
+    //(top left, top right, bottom left, bottom right).
+    const size_t c_shaderToV1[6] = { 2u, 3u, 0u, 0u, 3u, 1u };
+
+    for( size_t i=0; i<c_numBillboards; ++i )
+    {
+        V1Vertex v1Vertices[4];
+        expandV1Style( billboards[i], uvRects, camRight, camUp, v1Vertices );
+
+        for( uint32 j=0; j<6u; ++j )
+        {
+            const V1Vertex shaderVertex = expandLikeShader( &texBuffer[0],
+                                                            static_cast<uint32>( i * 6u + j ) );
+            const V1Vertex &v1Vertex = v1Vertices[c_shaderToV1[j]];
+
+            for( size_t k=0; k<3u; ++k )
+                CPPUNIT_ASSERT_DOUBLES_EQUAL( v1Vertex.position[k], shaderVertex.position[k], 1e-3f );
+            CPPUNIT_ASSERT_EQUAL( v1Vertex.colour, shaderVertex.colour );
+            CPPUNIT_ASSERT_EQUAL( v1Vertex.uv[0], shaderVertex.uv[0] );
+            CPPUNIT_ASSERT_EQUAL( v1Vertex.uv[1], shaderVertex.uv[1] );
+        }
+    }
+}
+//--------------------------------------------------------------------------
+void GpuBillboardTests::testHlmsHashNotSharedWithBufferless()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    mHelper = new NullRenderSystemHelper();
+    SceneManager *sceneManager = mHelper->createSceneManager();
+    HlmsDatablock *datablock = mHelper->getRoot()->getHlmsManager()->
+            getHlms( HLMS_UNLIT )->getDefaultDatablock();
+
+    //The plain one goes first, so the set would get its memoised hash.
+    BufferlessRenderable fullscreenTriangle( mHelper->getVaoManager() );
+    fullscreenTriangle.setDatablock( datablock );
+
+    GpuBillboardSet *billboardSet = static_cast<GpuBillboardSet*>(
+                sceneManager->createMovableObject( GpuBillboardSetFactory::FACTORY_TYPE_NAME,
+                                                   &sceneManager->_getEntityMemoryManager(
+                                                       SCENE_DYNAMIC ) ) );
+    CPPUNIT_ASSERT( billboardSet->getDatablock() == datablock );
+    CPPUNIT_ASSERT( billboardSet->getHlmsHash() != fullscreenTriangle.getHlmsHash() );
+
+    //Each kind still shares its own hash.
+    BufferlessRenderable fullscreenTriangle2( mHelper->getVaoManager() );
+    fullscreenTriangle2.setDatablock( datablock );
+    CPPUNIT_ASSERT_EQUAL( fullscreenTriangle.getHlmsHash(), fullscreenTriangle2.getHlmsHash() );
+
+    GpuBillboardSet *billboardSet2 = static_cast<GpuBillboardSet*>(
+                sceneManager->createMovableObject( GpuBillboardSetFactory::FACTORY_TYPE_NAME,
+                                                   &sceneManager->_getEntityMemoryManager(
+                                                       SCENE_DYNAMIC ) ) );
+    CPPUNIT_ASSERT_EQUAL( billboardSet->getHlmsHash(), billboardSet2->getHlmsHash() );
+
+    sceneManager->destroyMovableObject( billboardSet );
+    sceneManager->destroyMovableObject( billboardSet2 );
+}
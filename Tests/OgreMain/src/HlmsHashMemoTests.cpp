@@ -0,0 +1,240 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "HlmsHashMemoTests.h"
+#include "NullRenderSystemHelper.h"
+
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgreHlmsManager.h"
+#include "OgreHlms.h"
+#include "OgreHlmsDatablock.h"
+#include "OgreHlmsSamplerblock.h"
+#include "OgreBlendMode.h"
+#include "OgreItem.h"
+#include "OgreSubItem.h"
+#include "OgreMesh2.h"
+
+#include "UnitTestSuite.h"
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(HlmsHashMemoTests);
+
+namespace
+{
+    /// Enough to get several blocks in the same hash map, but less than
+    /// OGRE_HLMS_NUM_MACROBLOCKS & co. minus the ones created at startup.
+    const size_t c_numBlocks = 16u;
+    const int c_numBlendFactors = SBF_ONE_MINUS_SOURCE_ALPHA + 1;
+
+    /// Block i of each type. Different from the ones created at startup.
+    HlmsMacroblock makeMacroblock( size_t i )
+    {
+        HlmsMacroblock retVal;
+        retVal.mDepthBiasConstant = 100.0f + (float)i;
+        return retVal;
+    }
+    HlmsBlendblock makeBlendblock( size_t i )
+    {
+        HlmsBlendblock retVal;
+        retVal.mSeparateBlend = true;
+        retVal.mSourceBlendFactor = static_cast<SceneBlendFactor>( i % c_numBlendFactors );
+        retVal.mDestBlendFactor = static_cast<SceneBlendFactor>( i / c_numBlendFactors );
+        return retVal;
+    }
+    HlmsSamplerblock makeSamplerblock( size_t i )
+    {
+        HlmsSamplerblock retVal;
+        retVal.mMinLod = 100.0f + (float)i;
+        return retVal;
+    }
+}
+
+//--------------------------------------------------------------------------
+void HlmsHashMemoTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mHelper = new NullRenderSystemHelper();
+    mHlmsManager = mHelper->getRoot()->getHlmsManager();
+}
+//--------------------------------------------------------------------------
+void HlmsHashMemoTests::tearDown()
+{
+    delete mHelper;
+    mHelper = 0;
+    mHlmsManager = 0;
+}
+//--------------------------------------------------------------------------
+void HlmsHashMemoTests::testBlocksInternedByContent()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    vector<const HlmsMacroblock*>::type macroblocks;
+    vector<const HlmsBlendblock*>::type blendblocks;
+    vector<const HlmsSamplerblock*>::type samplerblocks;
+
+    for( size_t i=0; i<c_numBlocks; ++i )
+    {
+        macroblocks.push_back( mHlmsManager->getMacroblock( makeMacroblock( i ) ) );
+        blendblocks.push_back( mHlmsManager->getBlendblock( makeBlendblock( i ) ) );
+        samplerblocks.push_back( mHlmsManager->getSamplerblock( makeSamplerblock( i ) ) );
+    }
+
+    for( size_t i=0; i<c_numBlocks; ++i )
+    {
+        for( size_t j=i+1; j<c_numBlocks; ++j )
+        {
+            CPPUNIT_ASSERT( macroblocks[i] != macroblocks[j] );
+            CPPUNIT_ASSERT( blendblocks[i] != blendblocks[j] );
+            CPPUNIT_ASSERT( samplerblocks[i] != samplerblocks[j] );
+        }
+    }
+
+    for( size_t i=0; i<c_numBlocks; ++i )
+    {
+        CPPUNIT_ASSERT_EQUAL( (uint16)1u, macroblocks[i]->mRefCount );
+        CPPUNIT_ASSERT( mHlmsManager->getMacroblock( makeMacroblock( i ) ) == macroblocks[i] );
+        CPPUNIT_ASSERT_EQUAL( (uint16)2u, macroblocks[i]->mRefCount );
+
+        CPPUNIT_ASSERT( mHlmsManager->getBlendblock( makeBlendblock( i ) ) == blendblocks[i] );
+        CPPUNIT_ASSERT( mHlmsManager->getSamplerblock( makeSamplerblock( i ) ) ==
+                        samplerblocks[i] );
+    }
+
+    for( size_t i=0; i<c_numBlocks; ++i )
+    {
+        mHlmsManager->destroyMacroblock( macroblocks[i] );
+        mHlmsManager->destroyMacroblock( macroblocks[i] );
+        mHlmsManager->destroyBlendblock( blendblocks[i] );
+        mHlmsManager->destroyBlendblock( blendblocks[i] );
+        mHlmsManager->destroySamplerblock( samplerblocks[i] );
+        mHlmsManager->destroySamplerblock( samplerblocks[i] );
+    }
+}
+//--------------------------------------------------------------------------
+void HlmsHashMemoTests::testDestroyedBlocksForgotten()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const HlmsMacroblock macroblockA = makeMacroblock( 0 );
+    const HlmsMacroblock macroblockB = makeMacroblock( 1 );
+
+    const HlmsMacroblock *blockA = mHlmsManager->getMacroblock( macroblockA );
+    const HlmsMacroblock *blockB = mHlmsManager->getMacroblock( macroblockB );
+    const uint16 idA = blockA->mId;
+
+    mHlmsManager->destroyMacroblock( blockA );
+
+    //B is still found after A was removed from the hash map
+    CPPUNIT_ASSERT( mHlmsManager->getMacroblock( macroblockB ) == blockB );
+    CPPUNIT_ASSERT_EQUAL( (uint16)2u, blockB->mRefCount );
+
+    //Reusing A's slot for other contents must not return it for A's contents
+    const HlmsMacroblock *blockC = mHlmsManager->getMacroblock( makeMacroblock( 2 ) );
+    CPPUNIT_ASSERT_EQUAL( idA, blockC->mId );
+    CPPUNIT_ASSERT( blockC->mDepthBiasConstant == 102.0f );
+
+    blockA = mHlmsManager->getMacroblock( macroblockA );
+    CPPUNIT_ASSERT( blockA != blockC );
+    CPPUNIT_ASSERT( blockA->mDepthBiasConstant == 100.0f );
+    CPPUNIT_ASSERT_EQUAL( (uint16)1u, blockA->mRefCount );
+
+    mHlmsManager->destroyMacroblock( blockA );
+    mHlmsManager->destroyMacroblock( blockB );
+    mHlmsManager->destroyMacroblock( blockB );
+    mHlmsManager->destroyMacroblock( blockC );
+}
+//--------------------------------------------------------------------------
+void HlmsHashMemoTests::testMemoHitMatchesFullHash()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    SceneManager *sceneManager = mHelper->createSceneManager();
+    MeshPtr mesh = mHelper->createCubeMesh( "HlmsHashMemoTests/Cube" );
+    Hlms *hlms = mHlmsManager->getHlms( HLMS_UNLIT );
+
+    Item *item = sceneManager->createItem( mesh );
+    //Gets its hash from the memo filled by the first one
+    Item *item2 = sceneManager->createItem( mesh );
+
+    SubItem *subItem = item->getSubItem( 0 );
+    SubItem *subItem2 = item2->getSubItem( 0 );
+    CPPUNIT_ASSERT_EQUAL( subItem->getHlmsHash(), subItem2->getHlmsHash() );
+
+    uint32 memoHash, memoCasterHash;
+    hlms->calculateHashFor( subItem2, memoHash, memoCasterHash );
+
+    hlms->clearRenderableHashMemo();
+    uint32 fullHash, fullCasterHash;
+    hlms->calculateHashFor( subItem2, fullHash, fullCasterHash );
+
+    CPPUNIT_ASSERT_EQUAL( fullHash, memoHash );
+    CPPUNIT_ASSERT_EQUAL( fullCasterHash, memoCasterHash );
+    CPPUNIT_ASSERT_EQUAL( fullHash, subItem->getHlmsHash() );
+
+    sceneManager->destroyItem( item );
+    sceneManager->destroyItem( item2 );
+}
+//--------------------------------------------------------------------------
+void HlmsHashMemoTests::testDatablockChangeInvalidatesMemo()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    SceneManager *sceneManager = mHelper->createSceneManager();
+    MeshPtr mesh = mHelper->createCubeMesh( "HlmsHashMemoTests/Cube" );
+    Hlms *hlms = mHlmsManager->getHlms( HLMS_UNLIT );
+
+    HlmsDatablock *datablock = hlms->createDatablock( "HlmsHashMemoTests", "HlmsHashMemoTests",
+                                                      HlmsMacroblock(), HlmsBlendblock(),
+                                                      HlmsParamVec() );
+
+    Item *item = sceneManager->createItem( mesh );
+    item->setDatablock( datablock );
+    const uint32 oldHash = item->getSubItem( 0 )->getHlmsHash();
+
+    //Relinks the item, which recalculates its hash
+    datablock->setAlphaTest( CMPF_GREATER );
+    const uint32 newHash = item->getSubItem( 0 )->getHlmsHash();
+    CPPUNIT_ASSERT( newHash != oldHash );
+
+    hlms->clearRenderableHashMemo();
+    uint32 fullHash, fullCasterHash;
+    hlms->calculateHashFor( item->getSubItem( 0 ), fullHash, fullCasterHash );
+    CPPUNIT_ASSERT_EQUAL( fullHash, newHash );
+
+    //A new item with the changed datablock gets the new hash too
+    Item *item2 = sceneManager->createItem( mesh );
+    item2->setDatablock( datablock );
+    CPPUNIT_ASSERT_EQUAL( newHash, item2->getSubItem( 0 )->getHlmsHash() );
+
+    sceneManager->destroyItem( item );
+    sceneManager->destroyItem( item2 );
+    hlms->destroyDatablock( "HlmsHashMemoTests" );
+}
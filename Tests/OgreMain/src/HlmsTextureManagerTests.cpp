@@ -0,0 +1,237 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "HlmsTextureManagerTests.h"
+#include "OgreHlmsTextureManager.h"
+#include "OgreImage.h"
+#include "OgreBitwise.h"
+
+#include "UnitTestSuite.h"
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(HlmsTextureManagerTests);
+
+//--------------------------------------------------------------------------
+class StreamingTestTextureManager : public HlmsTextureManager
+{
+public:
+    /// Adds a square PF_A8R8G8B8 texture with all of its mips, as if it had been decoded
+    /// and the mips from uploadedMip onwards were in its array.
+    void addDecodedTexture( const String &aliasName, uint32 resolution, uint8 uploadedMip )
+    {
+        const uint8 numMipmaps = static_cast<uint8>( Bitwise::mostSignificantBitSet( resolution ) );
+        const size_t bytes = Image::calculateSize( numMipmaps, 1, resolution, resolution, 1,
+                                                   PF_A8R8G8B8 );
+
+        Image *image = OGRE_NEW Image();
+        image->loadDynamicImage( OGRE_ALLOC_T( uchar, bytes, MEMCATEGORY_GENERAL ),
+                                 resolution, resolution, 1, PF_A8R8G8B8, true, 1, numMipmaps );
+
+        StreamedTexture &streamed = mStreamedTextures[aliasName];
+        streamed.aliasName      = aliasName;
+        streamed.resourceName   = aliasName;
+        streamed.mapType        = TEXTURE_TYPE_DIFFUSE;
+        streamed.image          = image;
+        streamed.pixelFormat    = PF_A8R8G8B8;
+        streamed.baseMip        = 0;
+        streamed.lowestMip      = 0;
+        while( streamed.lowestMip < numMipmaps &&
+               (resolution >> streamed.lowestMip) > mMinResidentResolution )
+        {
+            ++streamed.lowestMip;
+        }
+        streamed.residentMip    = uploadedMip;
+        streamed.uploadedMip    = uploadedMip;
+        streamed.targetMip      = uploadedMip;
+    }
+
+    uint8 getResidentMip( IdString aliasName ) const
+    {
+        return mStreamedTextures.find( aliasName )->second.residentMip;
+    }
+
+    static size_t getMipChainSize( uint32 resolution, uint8 firstMip )
+    {
+        size_t retVal = 0;
+        for( uint32 res = resolution >> firstMip; res; res >>= 1u )
+            retVal += PixelUtil::getMemorySize( res, res, 1, PF_A8R8G8B8 );
+        return retVal;
+    }
+};
+//--------------------------------------------------------------------------
+class StreamingTestListener : public HlmsTextureManager::Listener
+{
+public:
+    size_t  numLocationChanges;
+    IdString lastAliasName;
+    uint8   lastResidentMip;
+
+    StreamingTestListener() : numLocationChanges( 0 ), lastResidentMip( 0 ) {}
+
+    virtual void textureLocationChanged( IdString aliasName,
+                                         const HlmsTextureManager::TextureLocation &location,
+                                         uint8 residentMip, uint8 numMipmaps )
+    {
+        ++numLocationChanges;
+        lastAliasName   = aliasName;
+        lastResidentMip = residentMip;
+    }
+};
+//--------------------------------------------------------------------------
+void HlmsTextureManagerTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mManager = new StreamingTestTextureManager();
+    mManager->setStreamingMinResidentResolution( 64u );
+    //Nothing can be uploaded without a RenderSystem.
+    mManager->setStreamingUploadBytesPerFrame( 0 );
+}
+//--------------------------------------------------------------------------
+void HlmsTextureManagerTests::tearDown()
+{
+    delete mManager;
+    mManager = 0;
+}
+//--------------------------------------------------------------------------
+void HlmsTextureManagerTests::testDefaultStats()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    CPPUNIT_ASSERT( !mManager->getStreamingEnabled() );
+    CPPUNIT_ASSERT( !mManager->getStreamingListener() );
+
+    mManager->_update();
+
+    HlmsTextureManager::StreamingStats stats = mManager->getStreamingStats();
+    CPPUNIT_ASSERT_EQUAL( (size_t)0, stats.numStreamedTextures );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0, stats.numPendingDecodes );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0, stats.numPendingUploads );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0, stats.numFullyResident );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0, stats.residentBytes );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0, stats.bytesUploadedLastFrame );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0, stats.numEvictions );
+}
+//--------------------------------------------------------------------------
+void HlmsTextureManagerTests::testEvictAndRestore()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    StreamingTestListener listener;
+    mManager->setStreamingListener( &listener );
+    mManager->addDecodedTexture( "Wood", 256u, 0 );
+
+    HlmsTextureManager::StreamingStats stats = mManager->getStreamingStats();
+    CPPUNIT_ASSERT_EQUAL( (size_t)1, stats.numStreamedTextures );
+    CPPUNIT_ASSERT_EQUAL( (size_t)1, stats.numFullyResident );
+    CPPUNIT_ASSERT_EQUAL( StreamingTestTextureManager::getMipChainSize( 256u, 0 ),
+                          stats.residentBytes );
+
+    //Not visible. Only the mips up to 64x64 (i.e. from mip 2) are kept.
+    mManager->setStreamingDemand( "Wood", 0 );
+    mManager->_update();
+
+    CPPUNIT_ASSERT_EQUAL( (size_t)1, listener.numLocationChanges );
+    CPPUNIT_ASSERT( listener.lastAliasName == IdString( "Wood" ) );
+    CPPUNIT_ASSERT_EQUAL( (uint8)2, listener.lastResidentMip );
+    CPPUNIT_ASSERT_EQUAL( (uint8)2, mManager->getResidentMip( "Wood" ) );
+
+    stats = mManager->getStreamingStats();
+    CPPUNIT_ASSERT_EQUAL( (size_t)1, stats.numEvictions );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0, stats.numFullyResident );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0, stats.numPendingUploads );
+    CPPUNIT_ASSERT_EQUAL( StreamingTestTextureManager::getMipChainSize( 256u, 2 ),
+                          stats.residentBytes );
+
+    //Nothing changes, nobody gets notified.
+    mManager->_update();
+    CPPUNIT_ASSERT_EQUAL( (size_t)1, listener.numLocationChanges );
+
+    //The evicted mips are still in the array; they come back without uploading them.
+    mManager->setStreamingDemand( "Wood", 1000 );
+    mManager->_update();
+
+    CPPUNIT_ASSERT_EQUAL( (size_t)2, listener.numLocationChanges );
+    CPPUNIT_ASSERT_EQUAL( (uint8)0, listener.lastResidentMip );
+
+    stats = mManager->getStreamingStats();
+    CPPUNIT_ASSERT_EQUAL( (size_t)1, stats.numEvictions );
+    CPPUNIT_ASSERT_EQUAL( (size_t)1, stats.numFullyResident );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0, stats.bytesUploadedLastFrame );
+}
+//--------------------------------------------------------------------------
+void HlmsTextureManagerTests::testBudgetServesHighestDemand()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    //Enough budget for one of them at full resolution, on top of their lowest mips.
+    mManager->setStreamingBudget( StreamingTestTextureManager::getMipChainSize( 256u, 0 ) -
+                                  StreamingTestTextureManager::getMipChainSize( 256u, 2 ) );
+    mManager->addDecodedTexture( "Near", 256u, 0 );
+    mManager->addDecodedTexture( "Far", 256u, 0 );
+    mManager->setStreamingDemand( "Near", 1000 );
+    mManager->setStreamingDemand( "Far", 100 );
+    mManager->_update();
+
+    CPPUNIT_ASSERT_EQUAL( (uint8)0, mManager->getResidentMip( "Near" ) );
+    CPPUNIT_ASSERT_EQUAL( (uint8)2, mManager->getResidentMip( "Far" ) );
+
+    //Swap them.
+    mManager->setStreamingDemand( "Near", 100 );
+    mManager->setStreamingDemand( "Far", 1000 );
+    mManager->_update();
+
+    CPPUNIT_ASSERT_EQUAL( (uint8)2, mManager->getResidentMip( "Near" ) );
+    CPPUNIT_ASSERT_EQUAL( (uint8)0, mManager->getResidentMip( "Far" ) );
+
+    HlmsTextureManager::StreamingStats stats = mManager->getStreamingStats();
+    CPPUNIT_ASSERT_EQUAL( (size_t)2, stats.numEvictions );
+    CPPUNIT_ASSERT_EQUAL( (size_t)1, stats.numFullyResident );
+}
+//--------------------------------------------------------------------------
+void HlmsTextureManagerTests::testUploadsWaitForUploadBudget()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    StreamingTestListener listener;
+    mManager->setStreamingListener( &listener );
+
+    //Only the lowest mips are in the array, as right after decoding.
+    mManager->addDecodedTexture( "Rock", 256u, 2 );
+    mManager->_update();
+
+    CPPUNIT_ASSERT_EQUAL( (size_t)0, listener.numLocationChanges );
+    CPPUNIT_ASSERT_EQUAL( (uint8)2, mManager->getResidentMip( "Rock" ) );
+
+    HlmsTextureManager::StreamingStats stats = mManager->getStreamingStats();
+    CPPUNIT_ASSERT_EQUAL( (size_t)1, stats.numPendingUploads );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0, stats.numFullyResident );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0, stats.numEvictions );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0, stats.bytesUploadedLastFrame );
+}
@@ -0,0 +1,246 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "LightBinningTests.h"
+#include "NullRenderSystemHelper.h"
+
+#include "OgreRoot.h"
+#include "OgreViewport.h"
+#include "OgreCamera.h"
+#include "OgreSceneManager.h"
+#include "OgreItem.h"
+#include "OgreLight.h"
+#include "OgreMesh2.h"
+#include "OgreLightBinGrid.h"
+
+#include "UnitTestSuite.h"
+
+#include <algorithm>
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(LightBinningTests);
+
+namespace
+{
+    const Real c_worldSize = 400.0f;
+    const Real c_lightRadius = 20.0f;
+    const size_t c_numItems = 2000u;
+    const size_t c_numLights = 200u;
+    const size_t c_numMovingLights = 4u;
+    const size_t c_numFrames = 10u;
+
+    Vector3 randomPosition(void)
+    {
+        return Vector3( Math::RangeRandom( -c_worldSize, c_worldSize ) * 0.5f,
+                        Math::RangeRandom( 0.0f, 10.0f ),
+                        Math::RangeRandom( -c_worldSize, c_worldSize ) * 0.5f );
+    }
+
+    bool orderByPtr( const Light *l, const Light *r )
+    {
+        return l < r;
+    }
+}
+//--------------------------------------------------------------------------
+void LightBinningTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mHelper = 0;
+    mSceneManager = 0;
+    mCamera = 0;
+}
+//--------------------------------------------------------------------------
+void LightBinningTests::tearDown()
+{
+    if( mSceneManager )
+        mSceneManager->setLightBinning( false );
+
+    mItems.clear();
+    mLightNodes.clear();
+    delete mHelper;
+    mHelper = 0;
+    mSceneManager = 0;
+}
+//--------------------------------------------------------------------------
+void LightBinningTests::createScene(void)
+{
+    mHelper = new NullRenderSystemHelper();
+    mSceneManager = mHelper->createSceneManager();
+    MeshPtr mesh = mHelper->createCubeMesh( "LightBinningTestsCube" );
+    SceneNode *rootNode = mSceneManager->getRootSceneNode();
+
+    for( size_t i=0; i<c_numItems; ++i )
+    {
+        Item *item = mSceneManager->createItem( mesh );
+        SceneNode *sceneNode = rootNode->createChildSceneNode();
+        sceneNode->setPosition( randomPosition() );
+        sceneNode->attachObject( item );
+        mItems.push_back( item );
+    }
+
+    for( size_t i=0; i<c_numLights; ++i )
+    {
+        Light *light = mSceneManager->createLight();
+        light->setType( Light::LT_POINT );
+        light->setAttenuation( c_lightRadius, 1.0f, 0.0f, 0.0f );
+        SceneNode *sceneNode = rootNode->createChildSceneNode();
+        sceneNode->setPosition( randomPosition() );
+        sceneNode->attachObject( light );
+        mLightNodes.push_back( sceneNode );
+    }
+
+    //Looking down at a quarter of the scene
+    mCamera = mHelper->createCamera( "TopCamera" );
+    mCamera->setPosition( c_worldSize * 0.25f, c_worldSize * 0.5f, c_worldSize * 0.25f );
+    mCamera->lookAt( c_worldSize * 0.25f, 0, c_worldSize * 0.25f + 1.0f );
+    mCamera->setNearClipDistance( 0.5f );
+    mCamera->setFarClipDistance( c_worldSize );
+    mCamera->setAutoAspectRatio( true );
+
+    mSceneManager->setLightBinning( true, c_lightRadius * 2.0f );
+    mSceneManager->updateSceneGraph();
+}
+//--------------------------------------------------------------------------
+void LightBinningTests::updateFrame( size_t frame )
+{
+    for( size_t i=0; i<c_numMovingLights; ++i )
+        mLightNodes[(frame * c_numMovingLights + i) % c_numLights]->setPosition( randomPosition() );
+
+    mSceneManager->updateSceneGraph();
+}
+//--------------------------------------------------------------------------
+size_t LightBinningTests::countWrongLightLists(void) const
+{
+    const LightListInfo &globalLightList = mSceneManager->getGlobalLightList();
+
+    size_t numWrong = 0;
+    vector<Light*>::type expected;
+    vector<Light*>::type actual;
+
+    vector<Item*>::type::const_iterator itor = mItems.begin();
+    vector<Item*>::type::const_iterator end  = mItems.end();
+    while( itor != end )
+    {
+        const Item *item = *itor;
+        const Sphere itemSphere( item->getWorldAabb().mCenter, item->getWorldRadius() );
+
+        expected.clear();
+        for( size_t i=0; i<globalLightList.lights.size(); ++i )
+        {
+            if( (item->getLightMask() & globalLightList.visibilityMask[i]) &&
+                globalLightList.boundingSphere[i].intersects( itemSphere ) )
+            {
+                expected.push_back( globalLightList.lights[i] );
+            }
+        }
+
+        actual.clear();
+        const LightList &lightList = item->queryLights();
+        for( size_t i=0; i<lightList.size(); ++i )
+            actual.push_back( lightList[i].light );
+
+        std::sort( expected.begin(), expected.end(), orderByPtr );
+        std::sort( actual.begin(), actual.end(), orderByPtr );
+        if( expected != actual )
+            ++numWrong;
+
+        ++itor;
+    }
+
+    return numWrong;
+}
+//--------------------------------------------------------------------------
+void LightBinningTests::testLightListsMatchBruteForce()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createScene();
+
+    CPPUNIT_ASSERT_EQUAL( (size_t)0, countWrongLightLists() );
+
+    for( size_t frame=0; frame<c_numFrames; ++frame )
+    {
+        updateFrame( frame );
+        CPPUNIT_ASSERT_EQUAL( (size_t)0, countWrongLightLists() );
+    }
+}
+//--------------------------------------------------------------------------
+void LightBinningTests::testCullLightsKeepsVisibleLights()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createScene();
+
+    LightArray culledLights;
+
+    for( size_t frame=0; frame<c_numFrames; ++frame )
+    {
+        updateFrame( frame );
+
+        mSceneManager->cullLights( mCamera, Light::LT_POINT, Light::NUM_LIGHT_TYPES,
+                                   culledLights );
+
+        //Every light whose center is in the camera must be there. Lights that only
+        //graze the frustum may be left out; the cells are tighter than the full sweep.
+        vector<Light*>::type binned( culledLights.begin(), culledLights.end() );
+        std::sort( binned.begin(), binned.end(), orderByPtr );
+        for( size_t i=0; i<c_numLights; ++i )
+        {
+            Light *light = static_cast<Light*>( mLightNodes[i]->getAttachedObject( 0 ) );
+            if( mCamera->isVisible( light->getWorldAabb().mCenter ) )
+            {
+                CPPUNIT_ASSERT( std::binary_search( binned.begin(), binned.end(),
+                                                    light, orderByPtr ) );
+            }
+        }
+    }
+}
+//--------------------------------------------------------------------------
+void LightBinningTests::testStillLightsReuseLists()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createScene();
+
+    LightBinGrid *lightBinGrid = mSceneManager->getLightBinGrid();
+    CPPUNIT_ASSERT( lightBinGrid != 0 );
+
+    size_t numReused = 0;
+    size_t numRebuilt = 0;
+    for( size_t frame=0; frame<c_numFrames; ++frame )
+    {
+        updateFrame( frame );
+        numReused   += lightBinGrid->getStats().numReusedLists;
+        numRebuilt  += lightBinGrid->getStats().numRebuiltLists;
+    }
+
+    //Only a few lights move, so most lists must be kept
+    CPPUNIT_ASSERT( numReused > numRebuilt );
+}
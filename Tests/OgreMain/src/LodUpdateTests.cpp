@@ -0,0 +1,288 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "LodUpdateTests.h"
+#include "NullRenderSystemHelper.h"
+
+#include "OgreRoot.h"
+#include "OgreCamera.h"
+#include "OgreSceneManager.h"
+#include "OgreItem.h"
+#include "OgreMesh2.h"
+#include "OgreMeshManager2.h"
+#include "OgreSubMesh2.h"
+#include "OgreLodStrategy.h"
+
+#include "UnitTestSuite.h"
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(LodUpdateTests);
+
+namespace
+{
+    const Real c_lodDistances[4] = { 0.0f, 40.0f, 80.0f, 160.0f };
+    const Real c_hysteresis = 0.1f;
+    const size_t c_numItems = 2000u;
+    const size_t c_numFrames = 40u;
+    /// Main pass plus 3 shadow maps, all using the same LOD camera.
+    const size_t c_updatesPerFrame = 4u;
+
+    Mesh::LodValueArray getLodValues(void)
+    {
+        Mesh::LodValueArray lodValues;
+        for( size_t i=0; i<4u; ++i )
+            lodValues.push_back( c_lodDistances[i] );
+        return lodValues;
+    }
+
+    uint8 bruteForceLod( const Mesh::LodValueArray &lodValues, Real value )
+    {
+        Mesh::LodValueArray::const_iterator it = std::lower_bound( lodValues.begin(),
+                                                                   lodValues.end(), value );
+        return static_cast<uint8>( std::max<int>( it - lodValues.begin() - 1, 0 ) );
+    }
+
+    /// Moves the camera back and forth along the crowd, a bit further every frame.
+    void placeCamera( Camera *camera, size_t frame )
+    {
+        const Real sway = Math::Sin( frame * 0.9f ) * 3.0f;
+        camera->setPosition( 0, 5.0f, -20.0f + sway + frame * 0.05f );
+        camera->lookAt( 0, 0, 100.0f );
+    }
+}
+//--------------------------------------------------------------------------
+void LodUpdateTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mHelper = 0;
+    mSceneManager = 0;
+    mCamera = 0;
+}
+//--------------------------------------------------------------------------
+void LodUpdateTests::tearDown()
+{
+    mItems.clear();
+    if( mSceneManager )
+    {
+        mSceneManager->destroyAllItems();
+
+        //Every LOD points to the same Vao. Leave one so it only gets destroyed once.
+        MeshPtr mesh = MeshManager::getSingleton().getByName( "LodUpdateTestsCube" );
+        SubMesh *subMesh = mesh->getSubMesh( 0 );
+        subMesh->mVao[VpNormal].resize( 1u );
+        subMesh->mVao[VpShadow].resize( 1u );
+    }
+    delete mHelper;
+    mHelper = 0;
+    mSceneManager = 0;
+}
+//--------------------------------------------------------------------------
+void LodUpdateTests::createCrowd(void)
+{
+    mHelper = new NullRenderSystemHelper();
+    mSceneManager = mHelper->createSceneManager();
+
+    //A cube with 4 LODs. All of them share the same Vao; only the index matters here.
+    MeshPtr mesh = mHelper->createCubeMesh( "LodUpdateTestsCube" );
+    SubMesh *subMesh = mesh->getSubMesh( 0 );
+    VertexArrayObject *vao = subMesh->mVao[VpNormal][0];
+    for( size_t i=1; i<4u; ++i )
+    {
+        subMesh->mVao[VpNormal].push_back( vao );
+        subMesh->mVao[VpShadow].push_back( vao );
+    }
+    mesh->_setLodValues( getLodValues() );
+
+    //A crowd in front of the camera, spread over all the LODs
+    const size_t itemsPerRow = 50u;
+    SceneNode *rootNode = mSceneManager->getRootSceneNode();
+    for( size_t i=0; i<c_numItems; ++i )
+    {
+        Item *item = mSceneManager->createItem( mesh );
+        SceneNode *sceneNode = rootNode->createChildSceneNode();
+        sceneNode->setPosition( ((i % itemsPerRow) - itemsPerRow * 0.5f) * 0.8f, 0,
+                                (i / itemsPerRow) * 4.0f );
+        sceneNode->attachObject( item );
+        mItems.push_back( item );
+    }
+
+    mCamera = mSceneManager->createCamera( "LodCamera" );
+    mCamera->setNearClipDistance( 0.5f );
+    mCamera->setFarClipDistance( 1000.0f );
+}
+//--------------------------------------------------------------------------
+size_t LodUpdateTests::countWrongLods( Real hysteresis ) const
+{
+    const Mesh::LodValueArray lodValues = getLodValues();
+    const Vector3 cameraPos = mCamera->_getCachedDerivedPosition();
+
+    size_t numWrong = 0;
+
+    vector<Item*>::type::const_iterator itor = mItems.begin();
+    vector<Item*>::type::const_iterator end  = mItems.end();
+    while( itor != end )
+    {
+        const Item *item = *itor;
+        const Real value = item->getWorldAabb().mCenter.distance( cameraPos ) -
+                           item->getWorldRadius();
+        const int expected = bruteForceLod( lodValues, value );
+        const int actual = item->getCurrentMeshLod();
+
+        if( actual != expected )
+        {
+            //Allow the band, plus a small tolerance for the SIMD distances
+            const size_t threshold = static_cast<size_t>( std::max( actual, expected ) );
+            const Real band = lodValues[threshold] * hysteresis + 1e-3f;
+            if( std::abs( actual - expected ) > 1 ||
+                Math::Abs( value - lodValues[threshold] ) > band )
+            {
+                ++numWrong;
+            }
+        }
+
+        ++itor;
+    }
+
+    return numWrong;
+}
+//--------------------------------------------------------------------------
+size_t LodUpdateTests::runFrames( bool caching, Real hysteresis, size_t &outNumWrongLods )
+{
+    mSceneManager->setLodCaching( caching );
+    mSceneManager->setLodHysteresis( hysteresis );
+
+    placeCamera( mCamera, 0 );
+    mSceneManager->updateSceneGraph();
+    mSceneManager->updateAllLods( mCamera, 1.0f, 0, 255u );
+
+    size_t numCachedRqs = 0;
+    outNumWrongLods = 0;
+
+    for( size_t frame=1; frame<c_numFrames; ++frame )
+    {
+        placeCamera( mCamera, frame );
+        mSceneManager->updateSceneGraph();
+
+        for( size_t i=0; i<c_updatesPerFrame; ++i )
+            mSceneManager->updateAllLods( mCamera, 1.0f, 0, 255u );
+
+        numCachedRqs += mSceneManager->getLodStats().numCachedRqs;
+        outNumWrongLods += countWrongLods( hysteresis );
+    }
+
+    return numCachedRqs;
+}
+//--------------------------------------------------------------------------
+void LodUpdateTests::testGetLodIndexWithoutHysteresis()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const Mesh::LodValueArray lodValues = getLodValues();
+
+    //Without hysteresis it must match a plain search, whatever the starting LOD.
+    for( size_t i=0; i<1000u; ++i )
+    {
+        const Real value = -10.0f + i * 0.21f;
+        const uint8 current = static_cast<uint8>( i % 5u );
+        CPPUNIT_ASSERT_EQUAL( bruteForceLod( lodValues, value ),
+                              LodStrategy::getLodIndex( lodValues, value, current, 0 ) );
+    }
+}
+//--------------------------------------------------------------------------
+void LodUpdateTests::testGetLodIndexHysteresisBand()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const Mesh::LodValueArray lodValues = getLodValues();
+
+    //Threshold at 80, band of 8
+    CPPUNIT_ASSERT_EQUAL( (uint8)1, LodStrategy::getLodIndex( lodValues, 85.0f, 1, c_hysteresis ) );
+    CPPUNIT_ASSERT_EQUAL( (uint8)2, LodStrategy::getLodIndex( lodValues, 89.0f, 1, c_hysteresis ) );
+    CPPUNIT_ASSERT_EQUAL( (uint8)2, LodStrategy::getLodIndex( lodValues, 75.0f, 2, c_hysteresis ) );
+    CPPUNIT_ASSERT_EQUAL( (uint8)1, LodStrategy::getLodIndex( lodValues, 71.0f, 2, c_hysteresis ) );
+    //Jumps as far as the band allows, possibly many LODs at once
+    CPPUNIT_ASSERT_EQUAL( (uint8)2, LodStrategy::getLodIndex( lodValues, 170.0f, 1, c_hysteresis ) );
+    CPPUNIT_ASSERT_EQUAL( (uint8)3, LodStrategy::getLodIndex( lodValues, 200.0f, 0, c_hysteresis ) );
+    CPPUNIT_ASSERT_EQUAL( (uint8)0, LodStrategy::getLodIndex( lodValues, 5.0f, 3, c_hysteresis ) );
+}
+//--------------------------------------------------------------------------
+void LodUpdateTests::testLodsMatchBruteForce()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createCrowd();
+
+    size_t numWrongLods;
+    runFrames( false, 0, numWrongLods );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0, numWrongLods );
+
+    runFrames( true, 0, numWrongLods );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0, numWrongLods );
+}
+//--------------------------------------------------------------------------
+void LodUpdateTests::testHysteresisStaysInBand()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createCrowd();
+
+    size_t numWrongLods;
+    runFrames( true, c_hysteresis, numWrongLods );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0, numWrongLods );
+}
+//--------------------------------------------------------------------------
+void LodUpdateTests::testCachingSkipsRepeatedUpdates()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createCrowd();
+
+    size_t numWrongLods;
+    CPPUNIT_ASSERT_EQUAL( (size_t)0, runFrames( false, 0, numWrongLods ) );
+    CPPUNIT_ASSERT( runFrames( true, 0, numWrongLods ) > 0u );
+}
+//--------------------------------------------------------------------------
+void LodUpdateTests::testMovingCameraInvalidatesCache()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createCrowd();
+
+    mSceneManager->setLodCaching( true );
+    placeCamera( mCamera, 0 );
+    mSceneManager->updateSceneGraph();
+    mSceneManager->updateAllLods( mCamera, 1.0f, 0, 255u );
+
+    //Moving the camera within the frame must not use the cached LODs
+    mCamera->setPosition( 0, 5.0f, 500.0f );
+    mSceneManager->updateAllLods( mCamera, 1.0f, 0, 255u );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0, mSceneManager->getLodStats().numCachedRqs );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0, countWrongLods( 0 ) );
+}
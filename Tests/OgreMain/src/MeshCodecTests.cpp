@@ -0,0 +1,441 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "MeshCodecTests.h"
+#include "NullRenderSystemHelper.h"
+
+#include "OgreMeshBufferCodec.h"
+#include "OgreBitwise.h"
+#include "OgreMesh2.h"
+#include "OgreMeshManager2.h"
+#include "OgreSubMesh2.h"
+#include "OgreMesh2Serializer.h"
+#include "OgreResourceGroupManager.h"
+
+#include "Vao/OgreVaoManager.h"
+#include "Vao/OgreVertexArrayObject.h"
+
+#include "UnitTestSuite.h"
+
+#include <fstream>
+#include <cstdio>
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(MeshCodecTests);
+
+namespace
+{
+    const size_t c_gridSize = 64u;
+
+    const char *c_groupName = "MeshCodecTests";
+    const char *c_rawMeshName           = "MeshCodecTests_Raw.mesh";
+    const char *c_compressedMeshName    = "MeshCodecTests_Compressed.mesh";
+    const char *c_bigEndianMeshName     = "MeshCodecTests_BigEndian.mesh";
+    const char *c_v2_1MeshName          = "MeshCodecTests_v2_1.mesh";
+
+    typedef vector<uint8>::type ByteVec;
+
+    float getHeight( int x, int z )
+    {
+        return Math::Sin( x * 0.05f ) * Math::Cos( z * 0.07f ) * 4.0f;
+    }
+
+    /// float3 position, float3 normal, float2 uv. 32 bytes per vertex.
+    void generateFloatVertices( size_t gridSize, ByteVec &outData )
+    {
+        outData.resize( gridSize * gridSize * sizeof(float) * 8u );
+        float *dst = reinterpret_cast<float*>( &outData[0] );
+
+        for( int z=0; z<static_cast<int>( gridSize ); ++z )
+        {
+            for( int x=0; x<static_cast<int>( gridSize ); ++x )
+            {
+                Vector3 normal( getHeight( x - 1, z ) - getHeight( x + 1, z ), 2.0f,
+                                getHeight( x, z - 1 ) - getHeight( x, z + 1 ) );
+                normal.normalise();
+
+                *dst++ = x * 0.5f;
+                *dst++ = getHeight( x, z );
+                *dst++ = z * 0.5f;
+                *dst++ = static_cast<float>( normal.x );
+                *dst++ = static_cast<float>( normal.y );
+                *dst++ = static_cast<float>( normal.z );
+                *dst++ = x / float( gridSize - 1u );
+                *dst++ = z / float( gridSize - 1u );
+            }
+        }
+    }
+
+    /// half4 position, short4 QTangent-like, half2 uv. 20 bytes per vertex.
+    void generateHalfVertices( const ByteVec &floatData, ByteVec &outData )
+    {
+        const size_t numVertices = floatData.size() / (sizeof(float) * 8u);
+        outData.resize( numVertices * 20u );
+        const float *src = reinterpret_cast<const float*>( &floatData[0] );
+        uint16 *dst = reinterpret_cast<uint16*>( &outData[0] );
+
+        for( size_t i=0; i<numVertices; ++i )
+        {
+            *dst++ = Bitwise::floatToHalf( src[0] );
+            *dst++ = Bitwise::floatToHalf( src[1] );
+            *dst++ = Bitwise::floatToHalf( src[2] );
+            *dst++ = Bitwise::floatToHalf( 1.0f );
+            for( size_t j=0; j<3u; ++j )
+                *dst++ = static_cast<uint16>( static_cast<int16>( src[3u + j] * 32767.0f ) );
+            *dst++ = 32767u;
+            *dst++ = Bitwise::floatToHalf( src[6] );
+            *dst++ = Bitwise::floatToHalf( src[7] );
+            src += 8u;
+        }
+    }
+
+    size_t getNumGridIndices( size_t gridSize )
+    {
+        return (gridSize - 1u) * (gridSize - 1u) * 6u;
+    }
+
+    template <typename T>
+    void generateIndices( size_t gridSize, ByteVec &outData )
+    {
+        outData.resize( getNumGridIndices( gridSize ) * sizeof(T) );
+        T *dst = reinterpret_cast<T*>( &outData[0] );
+
+        for( size_t z=0; z<gridSize - 1u; ++z )
+        {
+            for( size_t x=0; x<gridSize - 1u; ++x )
+            {
+                const T v = static_cast<T>( z * gridSize + x );
+                *dst++ = v;
+                *dst++ = static_cast<T>( v + gridSize );
+                *dst++ = static_cast<T>( v + 1u );
+                *dst++ = static_cast<T>( v + 1u );
+                *dst++ = static_cast<T>( v + gridSize );
+                *dst++ = static_cast<T>( v + gridSize + 1u );
+            }
+        }
+    }
+
+    size_t encodeVertices( const ByteVec &rawData, size_t bytesPerVertex, ByteVec &outEncoded )
+    {
+        const size_t numVertices = rawData.size() / bytesPerVertex;
+        outEncoded.resize( MeshBufferCodec::getVertexBufferBound( numVertices, bytesPerVertex ) );
+        return MeshBufferCodec::encodeVertexBuffer( &outEncoded[0], outEncoded.size(),
+                                                    &rawData[0], numVertices, bytesPerVertex );
+    }
+
+    size_t encodeIndices( const ByteVec &rawData, bool index32Bit, ByteVec &outEncoded )
+    {
+        const size_t numIndices = rawData.size() / (index32Bit ? 4u : 2u);
+        outEncoded.resize( MeshBufferCodec::getIndexBufferBound( numIndices ) );
+        return MeshBufferCodec::encodeIndexBuffer( &outEncoded[0], outEncoded.size(),
+                                                   &rawData[0], numIndices, index32Bit );
+    }
+
+    size_t getFileSize( const char *filename )
+    {
+        std::ifstream file( filename, std::ios::binary | std::ios::ate );
+        return file.is_open() ? static_cast<size_t>( file.tellg() ) : 0u;
+    }
+
+    bool loadAndCompare( const char *filename, const ByteVec &vertexData, const ByteVec &indexData )
+    {
+        MeshPtr mesh = MeshManager::getSingleton().load( filename, c_groupName );
+
+        bool isEqual = false;
+        if( mesh->getNumSubMeshes() == 1u )
+        {
+            const VertexArrayObject *vao = mesh->getSubMesh( 0 )->mVao[VpNormal][0];
+            const VertexBufferPacked *vertexBuffer = vao->getVertexBuffers()[0];
+            const IndexBufferPacked *indexBuffer = vao->getIndexBuffer();
+
+            isEqual = vertexBuffer->getTotalSizeBytes() == vertexData.size() &&
+                      indexBuffer->getTotalSizeBytes() == indexData.size() &&
+                      vertexBuffer->getShadowCopy() && indexBuffer->getShadowCopy() &&
+                      !memcmp( vertexBuffer->getShadowCopy(), &vertexData[0], vertexData.size() ) &&
+                      !memcmp( indexBuffer->getShadowCopy(), &indexData[0], indexData.size() );
+        }
+
+        mesh.setNull();
+        MeshManager::getSingleton().remove( filename );
+        return isEqual;
+    }
+}
+//--------------------------------------------------------------------------
+void MeshCodecTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mHelper = 0;
+}
+//--------------------------------------------------------------------------
+void MeshCodecTests::tearDown()
+{
+    delete mHelper;
+    mHelper = 0;
+
+    std::remove( c_rawMeshName );
+    std::remove( c_compressedMeshName );
+    std::remove( c_bigEndianMeshName );
+    std::remove( c_v2_1MeshName );
+}
+//--------------------------------------------------------------------------
+void MeshCodecTests::testVertexRoundTrip()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    ByteVec floatVertices, halfVertices;
+    generateFloatVertices( c_gridSize, floatVertices );
+    generateHalfVertices( floatVertices, halfVertices );
+
+    const ByteVec *rawData[2] = { &floatVertices, &halfVertices };
+    const size_t bytesPerVertex[2] = { 32u, 20u };
+
+    for( size_t i=0; i<2u; ++i )
+    {
+        ByteVec encoded;
+        const size_t encodedBytes = encodeVertices( *rawData[i], bytesPerVertex[i], encoded );
+        CPPUNIT_ASSERT( encodedBytes != 0 );
+        CPPUNIT_ASSERT( encodedBytes < rawData[i]->size() );
+
+        ByteVec decoded( rawData[i]->size() );
+        CPPUNIT_ASSERT( MeshBufferCodec::decodeVertexBuffer( &decoded[0],
+                                                             decoded.size() / bytesPerVertex[i],
+                                                             bytesPerVertex[i], &encoded[0],
+                                                             encodedBytes ) );
+        CPPUNIT_ASSERT( decoded == *rawData[i] );
+    }
+}
+//--------------------------------------------------------------------------
+void MeshCodecTests::testCorruptVerticesRejected()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    ByteVec rawData;
+    generateFloatVertices( c_gridSize, rawData );
+    const size_t numVertices = rawData.size() / 32u;
+
+    ByteVec encoded;
+    const size_t encodedBytes = encodeVertices( rawData, 32u, encoded );
+    ByteVec decoded( rawData.size() );
+
+    //Every truncation must be rejected. Sample a few to keep it fast.
+    for( size_t cut=0; cut<encodedBytes; cut += std::max<size_t>( encodedBytes / 64u, 1u ) )
+    {
+        CPPUNIT_ASSERT( !MeshBufferCodec::decodeVertexBuffer( &decoded[0], numVertices, 32u,
+                                                              &encoded[0], cut ) );
+    }
+
+    //Unknown version
+    encoded[0] ^= 0xFFu;
+    CPPUNIT_ASSERT( !MeshBufferCodec::decodeVertexBuffer( &decoded[0], numVertices, 32u,
+                                                          &encoded[0], encodedBytes ) );
+}
+//--------------------------------------------------------------------------
+void MeshCodecTests::testIndexRoundTrip()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    for( size_t i=0; i<2u; ++i )
+    {
+        const bool index32Bit = i == 0u;
+        ByteVec rawData;
+        if( index32Bit )
+            generateIndices<uint32>( c_gridSize, rawData );
+        else
+            generateIndices<uint16>( c_gridSize, rawData );
+
+        ByteVec encoded;
+        const size_t encodedBytes = encodeIndices( rawData, index32Bit, encoded );
+        CPPUNIT_ASSERT( encodedBytes != 0 );
+        CPPUNIT_ASSERT( encodedBytes < rawData.size() );
+
+        ByteVec decoded( rawData.size() );
+        CPPUNIT_ASSERT( MeshBufferCodec::decodeIndexBuffer( &decoded[0],
+                                                            getNumGridIndices( c_gridSize ),
+                                                            index32Bit, &encoded[0],
+                                                            encodedBytes ) );
+        CPPUNIT_ASSERT( decoded == rawData );
+    }
+}
+//--------------------------------------------------------------------------
+void MeshCodecTests::testCorruptIndicesRejected()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    ByteVec rawData;
+    generateIndices<uint32>( c_gridSize, rawData );
+    const size_t numIndices = getNumGridIndices( c_gridSize );
+
+    ByteVec encoded;
+    const size_t encodedBytes = encodeIndices( rawData, true, encoded );
+    ByteVec decoded( rawData.size() );
+
+    CPPUNIT_ASSERT( !MeshBufferCodec::decodeIndexBuffer( &decoded[0], numIndices, true,
+                                                         &encoded[0], encodedBytes - 1u ) );
+    //Trailing bytes
+    CPPUNIT_ASSERT( !MeshBufferCodec::decodeIndexBuffer( &decoded[0], numIndices - 1u, true,
+                                                         &encoded[0], encodedBytes ) );
+}
+//--------------------------------------------------------------------------
+void MeshCodecTests::testNoiseRoundTrips()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    //Vertex counts around the 16-vertex groups & 256-vertex blocks, and odd strides.
+    const size_t numVertices[] = { 0, 1, 15, 16, 17, 255, 256, 257, 1000 };
+    const size_t strides[] = { 1, 3, 12, 36, 256 };
+
+    for( size_t i=0; i<sizeof(numVertices) / sizeof(numVertices[0]); ++i )
+    {
+        for( size_t j=0; j<sizeof(strides) / sizeof(strides[0]); ++j )
+        {
+            ByteVec rawData( numVertices[i] * strides[j] );
+            for( size_t k=0; k<rawData.size(); ++k )
+                rawData[k] = static_cast<uint8>( (k * 2654435761u) >> 13u );
+
+            ByteVec encoded( MeshBufferCodec::getVertexBufferBound( numVertices[i], strides[j] ) );
+            const size_t encodedBytes = MeshBufferCodec::encodeVertexBuffer(
+                                            &encoded[0], encoded.size(),
+                                            rawData.empty() ? 0 : &rawData[0],
+                                            numVertices[i], strides[j] );
+            CPPUNIT_ASSERT( encodedBytes != 0 );
+
+            //One extra byte to catch writes past the end
+            ByteVec decoded( rawData.size() + 1u, 0xCDu );
+            CPPUNIT_ASSERT( MeshBufferCodec::decodeVertexBuffer( &decoded[0], numVertices[i],
+                                                                 strides[j], &encoded[0],
+                                                                 encodedBytes ) );
+            CPPUNIT_ASSERT( std::equal( rawData.begin(), rawData.end(), decoded.begin() ) );
+            CPPUNIT_ASSERT_EQUAL( (uint8)0xCDu, decoded.back() );
+        }
+    }
+}
+//--------------------------------------------------------------------------
+void MeshCodecTests::testTooSmallBuffers()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    uint8 tooSmall[4];
+    const uint8 vertex[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    CPPUNIT_ASSERT_EQUAL( (size_t)0, MeshBufferCodec::encodeVertexBuffer( tooSmall, sizeof(tooSmall),
+                                                                          vertex, 1u, 8u ) );
+    //Vertices bigger than 256 bytes are refused
+    CPPUNIT_ASSERT_EQUAL( (size_t)0, MeshBufferCodec::encodeVertexBuffer( tooSmall, sizeof(tooSmall),
+                                                                          vertex, 1u, 257u ) );
+}
+//--------------------------------------------------------------------------
+void MeshCodecTests::testExtremeIndices()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    //Large jumps take the multi-byte varints.
+    const uint32 indices[6] = { 0, 0xFFFFFFFFu, 5, 0x7FFFFFFFu, 0x80000000u, 1 };
+    ByteVec encoded( MeshBufferCodec::getIndexBufferBound( 6u ) );
+    uint32 decoded[6];
+    const size_t encodedBytes = MeshBufferCodec::encodeIndexBuffer( &encoded[0], encoded.size(),
+                                                                    indices, 6u, true );
+    CPPUNIT_ASSERT( encodedBytes != 0 );
+    CPPUNIT_ASSERT( MeshBufferCodec::decodeIndexBuffer( decoded, 6u, true,
+                                                        &encoded[0], encodedBytes ) );
+    CPPUNIT_ASSERT( std::equal( indices, indices + 6u, decoded ) );
+}
+//--------------------------------------------------------------------------
+void MeshCodecTests::testCompressedMeshLoadsBack()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    mHelper = new NullRenderSystemHelper();
+
+    VaoManager *vaoManager = mHelper->getVaoManager();
+
+    ByteVec vertexData, indexData;
+    generateFloatVertices( c_gridSize, vertexData );
+    generateIndices<uint32>( c_gridSize, indexData );
+
+    {
+        MeshPtr mesh = MeshManager::getSingleton().createManual(
+                    "MeshCodecTestsSource", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME );
+        SubMesh *subMesh = mesh->createSubMesh();
+        subMesh->setMaterialName( "BaseWhite" );
+
+        VertexElement2Vec vertexElements;
+        vertexElements.push_back( VertexElement2( VET_FLOAT3, VES_POSITION ) );
+        vertexElements.push_back( VertexElement2( VET_FLOAT3, VES_NORMAL ) );
+        vertexElements.push_back( VertexElement2( VET_FLOAT2, VES_TEXTURE_COORDINATES ) );
+
+        //The buffers keep them as shadow copies
+        void *vertices = OGRE_MALLOC_SIMD( vertexData.size(), MEMCATEGORY_GEOMETRY );
+        memcpy( vertices, &vertexData[0], vertexData.size() );
+        void *indices = OGRE_MALLOC_SIMD( indexData.size(), MEMCATEGORY_GEOMETRY );
+        memcpy( indices, &indexData[0], indexData.size() );
+
+        VertexBufferPackedVec vertexBuffers;
+        vertexBuffers.push_back( vaoManager->createVertexBuffer( vertexElements,
+                                                                 c_gridSize * c_gridSize,
+                                                                 BT_IMMUTABLE, vertices, true ) );
+        IndexBufferPacked *indexBuffer = vaoManager->createIndexBuffer(
+                                             IndexBufferPacked::IT_32BIT,
+                                             getNumGridIndices( c_gridSize ), BT_IMMUTABLE,
+                                             indices, true );
+        VertexArrayObject *vao = vaoManager->createVertexArrayObject( vertexBuffers, indexBuffer,
+                                                                      OT_TRIANGLE_LIST );
+        subMesh->mVao[VpNormal].push_back( vao );
+        subMesh->mVao[VpShadow].push_back( vao );
+
+        const Real halfSize = (c_gridSize - 1u) * 0.25f;
+        mesh->_setBounds( Aabb( Vector3( halfSize, 0, halfSize ),
+                                Vector3( halfSize, 4, halfSize ) ), false );
+        mesh->_setBoundingSphereRadius( halfSize * 1.5f );
+
+        MeshSerializer meshSerializer( vaoManager );
+        meshSerializer.exportMesh( mesh.get(), c_rawMeshName );
+        meshSerializer.setCompressBuffers( true );
+        meshSerializer.exportMesh( mesh.get(), c_compressedMeshName );
+        meshSerializer.exportMesh( mesh.get(), c_bigEndianMeshName, MESH_VERSION_LATEST,
+                                   Serializer::ENDIAN_BIG );
+        meshSerializer.exportMesh( mesh.get(), c_v2_1MeshName, MESH_VERSION_2_1 );
+
+        MeshManager::getSingleton().remove( mesh );
+    }
+
+    const size_t rawSize = getFileSize( c_rawMeshName );
+    const size_t compressedSize = getFileSize( c_compressedMeshName );
+    CPPUNIT_ASSERT( compressedSize != 0 );
+    CPPUNIT_ASSERT( compressedSize < rawSize );
+    //MESH_VERSION_2_1 ignores setCompressBuffers
+    CPPUNIT_ASSERT_EQUAL( rawSize, getFileSize( c_v2_1MeshName ) );
+
+    ResourceGroupManager::getSingleton().addResourceLocation( ".", "FileSystem", c_groupName );
+    ResourceGroupManager::getSingleton().initialiseResourceGroup( c_groupName, true );
+
+    CPPUNIT_ASSERT( loadAndCompare( c_rawMeshName, vertexData, indexData ) );
+    CPPUNIT_ASSERT( loadAndCompare( c_compressedMeshName, vertexData, indexData ) );
+    CPPUNIT_ASSERT( loadAndCompare( c_bigEndianMeshName, vertexData, indexData ) );
+    CPPUNIT_ASSERT( loadAndCompare( c_v2_1MeshName, vertexData, indexData ) );
+}
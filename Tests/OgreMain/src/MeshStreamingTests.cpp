@@ -0,0 +1,369 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "MeshStreamingTests.h"
+#include "NullRenderSystemHelper.h"
+
+#include "OgreRoot.h"
+#include "OgreWorkQueue.h"
+#include "OgreTimer.h"
+#include "OgreStringConverter.h"
+#include "OgreResourceGroupManager.h"
+#include "OgreMesh2.h"
+#include "OgreMeshManager2.h"
+#include "OgreSubMesh2.h"
+#include "OgreMesh2Serializer.h"
+
+#include "Vao/OgreVaoManager.h"
+#include "Vao/OgreVertexArrayObject.h"
+
+#include "UnitTestSuite.h"
+
+#include <cstdio>
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(MeshStreamingTests);
+
+namespace
+{
+    const char *c_groupName = "MeshStreamingTests";
+    const char *c_missingMeshName = "MeshStreamingTests_DoesNotExist.mesh";
+    const size_t c_numMeshes = 4u;
+    const size_t c_numVertices = 300u;
+
+    String getMeshName( size_t meshIdx )
+    {
+        return "MeshStreamingTests_" + StringConverter::toString( meshIdx ) + ".mesh";
+    }
+
+    Vector3 getExpectedPosition( size_t meshIdx, size_t vertexIdx )
+    {
+        return Vector3( Real( meshIdx ), vertexIdx * 0.001f, vertexIdx * -0.002f );
+    }
+
+    /// Position, normal, tangent & UVs in full 32-bit floats, like a mesh
+    /// that was never run through OgreMeshTool's optimizations.
+    void exportMesh( VaoManager *vaoManager, size_t meshIdx )
+    {
+        MeshPtr mesh = MeshManager::getSingleton().createManual(
+                    "MeshStreamingTestsSource", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME );
+        SubMesh *subMesh = mesh->createSubMesh();
+        subMesh->setMaterialName( "BaseWhite" );
+
+        VertexElement2Vec vertexElements;
+        vertexElements.push_back( VertexElement2( VET_FLOAT3, VES_POSITION ) );
+        vertexElements.push_back( VertexElement2( VET_FLOAT3, VES_NORMAL ) );
+        vertexElements.push_back( VertexElement2( VET_FLOAT4, VES_TANGENT ) );
+        vertexElements.push_back( VertexElement2( VET_FLOAT2, VES_TEXTURE_COORDINATES ) );
+
+        //The buffers keep them as shadow copies
+        float *vertices = reinterpret_cast<float*>( OGRE_MALLOC_SIMD(
+                                                        sizeof(float) * 12u * c_numVertices,
+                                                        MEMCATEGORY_GEOMETRY ) );
+        for( size_t i=0; i<c_numVertices; ++i )
+        {
+            const Vector3 pos = getExpectedPosition( meshIdx, i );
+            const float vertex[12] = { static_cast<float>( pos.x ), static_cast<float>( pos.y ),
+                                       static_cast<float>( pos.z ),
+                                       0.0f, 1.0f, 0.0f,
+                                       1.0f, 0.0f, 0.0f, 1.0f,
+                                       (i & 1u) ? 1.0f : 0.0f, (i & 2u) ? 1.0f : 0.0f };
+            memcpy( vertices + i * 12u, vertex, sizeof( vertex ) );
+        }
+
+        VertexBufferPackedVec vertexBuffers;
+        vertexBuffers.push_back( vaoManager->createVertexBuffer( vertexElements, c_numVertices,
+                                                                 BT_IMMUTABLE, vertices, true ) );
+
+        const size_t numIndices = (c_numVertices - 2u) * 3u;
+        uint32 *indices = reinterpret_cast<uint32*>( OGRE_MALLOC_SIMD( sizeof(uint32) * numIndices,
+                                                                       MEMCATEGORY_GEOMETRY ) );
+        for( size_t i=0; i<c_numVertices - 2u; ++i )
+        {
+            indices[i * 3u + 0] = static_cast<uint32>( i );
+            indices[i * 3u + 1] = static_cast<uint32>( i + 1u );
+            indices[i * 3u + 2] = static_cast<uint32>( i + 2u );
+        }
+
+        IndexBufferPacked *indexBuffer = vaoManager->createIndexBuffer( IndexBufferPacked::IT_32BIT,
+                                                                        numIndices, BT_IMMUTABLE,
+                                                                        indices, true );
+        VertexArrayObject *vao = vaoManager->createVertexArrayObject( vertexBuffers, indexBuffer,
+                                                                      OT_TRIANGLE_LIST );
+        subMesh->mVao[VpNormal].push_back( vao );
+        subMesh->mVao[VpShadow].push_back( vao );
+
+        const Vector3 lastPos = getExpectedPosition( meshIdx, c_numVertices - 1u );
+        const Vector3 halfSize( 0, lastPos.y * 0.5f, -lastPos.z * 0.5f );
+        mesh->_setBounds( Aabb( Vector3( lastPos.x, halfSize.y, -halfSize.z ), halfSize ), false );
+        mesh->_setBoundingSphereRadius( lastPos.length() );
+
+        MeshSerializer meshSerializer( vaoManager );
+        meshSerializer.exportMesh( mesh.get(), getMeshName( meshIdx ) );
+
+        MeshManager::getSingleton().remove( mesh );
+    }
+
+    /// Checks the mesh as it was exported, i.e. without setArrangeEfficientOnPrepare.
+    bool isExportedMesh( const MeshPtr &mesh, size_t meshIdx )
+    {
+        if( !mesh->isLoaded() || mesh->getNumSubMeshes() != 1u )
+            return false;
+
+        const SubMesh *subMesh = mesh->getSubMesh( 0 );
+        if( subMesh->mVao[VpNormal].size() != 1u || subMesh->mVao[VpShadow].size() != 1u ||
+            subMesh->getMaterialName() != "BaseWhite" )
+        {
+            return false;
+        }
+
+        const VertexArrayObject *vao = subMesh->mVao[VpNormal][0];
+        const VertexBufferPackedVec &vertexBuffers = vao->getVertexBuffers();
+        if( vertexBuffers.size() != 1u || vertexBuffers[0]->getNumElements() != c_numVertices ||
+            vao->getIndexBuffer()->getNumElements() != (c_numVertices - 2u) * 3u )
+        {
+            return false;
+        }
+
+        const float *vertices = reinterpret_cast<const float*>( vertexBuffers[0]->getShadowCopy() );
+        const uint32 *indices = reinterpret_cast<const uint32*>(
+                    vao->getIndexBuffer()->getShadowCopy() );
+        if( !vertices || !indices )
+            return false;
+
+        const size_t idx[3] = { 0, c_numVertices / 2u, c_numVertices - 1u };
+        for( size_t i=0; i<3u; ++i )
+        {
+            const Vector3 pos( vertices[idx[i] * 12u + 0],
+                               vertices[idx[i] * 12u + 1],
+                               vertices[idx[i] * 12u + 2] );
+            if( !pos.positionEquals( getExpectedPosition( meshIdx, idx[i] ), 1e-4f ) )
+                return false;
+        }
+
+        return indices[(c_numVertices - 3u) * 3u + 2] == c_numVertices - 1u;
+    }
+
+    class CountingListener : public MeshManager::AsyncLoadListener
+    {
+    public:
+        size_t  numLoaded;
+        size_t  numFailed;
+        String  lastError;
+
+        CountingListener() : numLoaded( 0 ), numFailed( 0 ) {}
+
+        virtual void meshLoaded( const MeshPtr &mesh, const String &errorDescription )
+        {
+            if( errorDescription.empty() )
+            {
+                ++numLoaded;
+            }
+            else
+            {
+                ++numFailed;
+                lastError = errorDescription;
+            }
+        }
+    };
+}
+//--------------------------------------------------------------------------
+void MeshStreamingTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mHelper = 0;
+}
+//--------------------------------------------------------------------------
+void MeshStreamingTests::tearDown()
+{
+    delete mHelper;
+    mHelper = 0;
+
+    for( size_t i=0; i<c_numMeshes; ++i )
+        std::remove( getMeshName( i ).c_str() );
+}
+//--------------------------------------------------------------------------
+void MeshStreamingTests::exportMeshes(void)
+{
+    mHelper = new NullRenderSystemHelper();
+
+    for( size_t i=0; i<c_numMeshes; ++i )
+        exportMesh( mHelper->getVaoManager(), i );
+
+    ResourceGroupManager::getSingleton().addResourceLocation( ".", "FileSystem", c_groupName );
+    ResourceGroupManager::getSingleton().initialiseResourceGroup( c_groupName, true );
+}
+//--------------------------------------------------------------------------
+void MeshStreamingTests::removeMeshes(void)
+{
+    for( size_t i=0; i<c_numMeshes; ++i )
+        MeshManager::getSingleton().remove( getMeshName( i ) );
+}
+//--------------------------------------------------------------------------
+void MeshStreamingTests::waitForAsyncLoads(void)
+{
+    MeshManager &meshManager = MeshManager::getSingleton();
+    WorkQueue *workQueue = mHelper->getRoot()->getWorkQueue();
+
+    Timer timer;
+    while( meshManager.getNumPendingAsyncLoads() && timer.getMilliseconds() < 60000u )
+        workQueue->processResponses();
+}
+//--------------------------------------------------------------------------
+void MeshStreamingTests::testLoadMatchesExport()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    exportMeshes();
+
+    for( size_t i=0; i<c_numMeshes; ++i )
+    {
+        MeshPtr mesh = MeshManager::getSingleton().load( getMeshName( i ), c_groupName );
+        CPPUNIT_ASSERT( isExportedMesh( mesh, i ) );
+    }
+
+    removeMeshes();
+}
+//--------------------------------------------------------------------------
+void MeshStreamingTests::testPrepareThenLoad()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    exportMeshes();
+
+    vector<MeshPtr>::type meshes;
+    for( size_t i=0; i<c_numMeshes; ++i )
+        meshes.push_back( MeshManager::getSingleton().prepare( getMeshName( i ), c_groupName ) );
+
+    //prepare parses the submeshes without loading
+    for( size_t i=0; i<c_numMeshes; ++i )
+    {
+        CPPUNIT_ASSERT( meshes[i]->isPrepared() );
+        CPPUNIT_ASSERT_EQUAL( (unsigned short)1u, meshes[i]->getNumSubMeshes() );
+    }
+
+    for( size_t i=0; i<c_numMeshes; ++i )
+    {
+        meshes[i]->load();
+        CPPUNIT_ASSERT( isExportedMesh( meshes[i], i ) );
+    }
+
+    meshes.clear();
+    removeMeshes();
+}
+//--------------------------------------------------------------------------
+void MeshStreamingTests::testLoadAsync()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    exportMeshes();
+
+    CountingListener listener;
+    vector<MeshPtr>::type meshes;
+    for( size_t i=0; i<c_numMeshes; ++i )
+    {
+        meshes.push_back( MeshManager::getSingleton().loadAsync( getMeshName( i ), c_groupName,
+                                                                 &listener ) );
+    }
+    waitForAsyncLoads();
+
+    CPPUNIT_ASSERT_EQUAL( (size_t)0, MeshManager::getSingleton().getNumPendingAsyncLoads() );
+    //The listener is called once per mesh
+    CPPUNIT_ASSERT_EQUAL( c_numMeshes, listener.numLoaded );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0, listener.numFailed );
+    for( size_t i=0; i<c_numMeshes; ++i )
+        CPPUNIT_ASSERT( isExportedMesh( meshes[i], i ) );
+
+    meshes.clear();
+    removeMeshes();
+}
+//--------------------------------------------------------------------------
+void MeshStreamingTests::testArrangeEfficientOnPrepare()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    exportMeshes();
+
+    MeshManager &meshManager = MeshManager::getSingleton();
+    meshManager.setArrangeEfficientOnPrepare( true, true, true, true );
+
+    CountingListener listener;
+    MeshPtr mesh = meshManager.loadAsync( getMeshName( 0 ), c_groupName, &listener );
+    waitForAsyncLoads();
+
+    meshManager.setArrangeEfficientOnPrepare( false );
+
+    CPPUNIT_ASSERT_EQUAL( (size_t)1u, listener.numLoaded );
+    CPPUNIT_ASSERT( mesh->isLoaded() );
+
+    const VertexArrayObject *vao = mesh->getSubMesh( 0 )->mVao[VpNormal][0];
+    const VertexBufferPackedVec &vertexBuffers = vao->getVertexBuffers();
+    CPPUNIT_ASSERT_EQUAL( (size_t)1u, vertexBuffers.size() );
+    CPPUNIT_ASSERT_EQUAL( (uint32)c_numVertices, vertexBuffers[0]->getNumElements() );
+    CPPUNIT_ASSERT_EQUAL( (uint32)((c_numVertices - 2u) * 3u),
+                          vao->getIndexBuffer()->getNumElements() );
+
+    size_t source, offset;
+    const VertexElement2 *position = vao->findBySemantic( VES_POSITION, source, offset );
+    const VertexElement2 *normal = vao->findBySemantic( VES_NORMAL, source, offset );
+    const VertexElement2 *tangent = vao->findBySemantic( VES_TANGENT, source, offset );
+    const VertexElement2 *uv = vao->findBySemantic( VES_TEXTURE_COORDINATES, source, offset );
+    CPPUNIT_ASSERT( position && position->mType == VET_HALF4 );
+    //Normals hold QTangents; the tangents were folded into them
+    CPPUNIT_ASSERT( normal && normal->mType == VET_SHORT4_SNORM );
+    CPPUNIT_ASSERT( !tangent );
+    CPPUNIT_ASSERT( uv && uv->mType == VET_HALF2 );
+
+    mesh.setNull();
+    meshManager.remove( getMeshName( 0 ) );
+}
+//--------------------------------------------------------------------------
+void MeshStreamingTests::testMissingFileReportsError()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    exportMeshes();
+
+    MeshManager &meshManager = MeshManager::getSingleton();
+
+    CountingListener listener;
+    MeshPtr mesh = meshManager.loadAsync( c_missingMeshName, c_groupName, &listener );
+    waitForAsyncLoads();
+
+    CPPUNIT_ASSERT_EQUAL( (size_t)1u, listener.numFailed );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0, listener.numLoaded );
+    CPPUNIT_ASSERT( !listener.lastError.empty() );
+    //A failed mesh is left unloaded
+    CPPUNIT_ASSERT( !mesh->isLoaded() );
+    CPPUNIT_ASSERT_EQUAL( (unsigned short)0, mesh->getNumSubMeshes() );
+
+    mesh.setNull();
+    meshManager.remove( c_missingMeshName );
+}
@@ -0,0 +1,282 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "MultiFrustumCullTests.h"
+#include "NullRenderSystemHelper.h"
+
+#include "OgreViewport.h"
+#include "OgreCamera.h"
+#include "OgreSceneManager.h"
+#include "OgreItem.h"
+#include "OgreMesh2.h"
+#include "OgreStringConverter.h"
+#include "Math/Array/OgreObjectMemoryManager.h"
+
+#include "UnitTestSuite.h"
+
+#include <algorithm>
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(MultiFrustumCullTests);
+
+namespace
+{
+    const Real c_sceneSize = 300.0f;
+    const size_t c_numItems = 3000u;
+    const size_t c_numCascades = 4u;
+    /// 4 cascades + 6 faces each gives more frusta than MultiFrustum::MaxFrusta,
+    /// so the sweep has to be split in batches.
+    const size_t c_numPointLights = 6u;
+
+    bool orderByPtr( const MovableObject *l, const MovableObject *r )
+    {
+        return l < r;
+    }
+}
+//--------------------------------------------------------------------------
+void MultiFrustumCullTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mHelper = 0;
+    mSceneManager = 0;
+    mViewport = 0;
+    mVisibilityFlags = 0;
+}
+//--------------------------------------------------------------------------
+void MultiFrustumCullTests::tearDown()
+{
+    if( mSceneManager )
+        mSceneManager->_setCurrentRenderStage( SceneManager::IRS_NONE );
+
+    mCameras.clear();
+    mOrientations.clear();
+    mMultiFrusta.clear();
+    mMultiFrustaPtrs.clear();
+    delete mHelper;
+    mHelper = 0;
+    mSceneManager = 0;
+}
+//--------------------------------------------------------------------------
+void MultiFrustumCullTests::createScene(void)
+{
+    mHelper = new NullRenderSystemHelper();
+    mSceneManager = mHelper->createSceneManager();
+    MeshPtr mesh = mHelper->createCubeMesh( "MultiFrustumCullTestsCube" );
+
+    SceneNode *rootNode = mSceneManager->getRootSceneNode( SCENE_DYNAMIC );
+    for( size_t i=0; i<c_numItems; ++i )
+    {
+        Item *item = mSceneManager->createItem( mesh, SCENE_DYNAMIC );
+        SceneNode *sceneNode = rootNode->createChildSceneNode( SCENE_DYNAMIC );
+        sceneNode->setPosition( Math::RangeRandom( -c_sceneSize, c_sceneSize ) * 0.5f,
+                                Math::RangeRandom( 0.0f, 10.0f ),
+                                Math::RangeRandom( -c_sceneSize, c_sceneSize ) * 0.5f );
+        sceneNode->attachObject( item );
+    }
+
+    //Same cameras a shadow node with PSSM cascades and point lights would use
+    const Quaternion lightDir( Radian( -Math::HALF_PI * 0.6f ), Vector3::UNIT_X );
+    const Quaternion cubemapRotations[6] =
+    {
+        Quaternion( Radian( -Math::HALF_PI ), Vector3::UNIT_Y ),
+        Quaternion( Radian(  Math::HALF_PI ), Vector3::UNIT_Y ),
+        Quaternion( Radian(  Math::HALF_PI ), Vector3::UNIT_X ),
+        Quaternion( Radian( -Math::HALF_PI ), Vector3::UNIT_X ),
+        Quaternion::IDENTITY,
+        Quaternion( Radian(  Math::PI ), Vector3::UNIT_Y )
+    };
+
+    for( size_t i=0; i<c_numCascades; ++i )
+    {
+        Camera *camera = mSceneManager->createCamera( "Cascade" + StringConverter::toString( i ),
+                                                      false );
+        const Real extent = 10.0f * Math::Pow( 3.0f, (Real)i );
+        camera->setProjectionType( PT_ORTHOGRAPHIC );
+        camera->setOrthoWindow( extent, extent );
+        camera->setNearClipDistance( 1.0f );
+        camera->setFarClipDistance( 1000.0f );
+        camera->setPosition( 0, 400.0f, 0 );
+        mCameras.push_back( camera );
+        mOrientations.push_back( lightDir );
+    }
+
+    for( size_t i=0; i<c_numPointLights; ++i )
+    {
+        Camera *camera = mSceneManager->createCamera( "PointLight" + StringConverter::toString( i ),
+                                                      false, true );
+        camera->setFOVy( Degree( 90 ) );
+        camera->setAspectRatio( 1.0f );
+        camera->setNearClipDistance( 0.1f );
+        camera->setFarClipDistance( 40.0f );
+        camera->setPosition( (Real)i * 20.0f - 60.0f, 5.0f, (Real)i * 15.0f - 40.0f );
+
+        for( size_t j=0; j<6u; ++j )
+        {
+            mCameras.push_back( camera );
+            mOrientations.push_back( cubemapRotations[j] );
+        }
+    }
+
+    const uint32 visibilityMask = VisibilityFlags::RESERVED_VISIBILITY_FLAGS |
+                                  VisibilityFlags::LAYER_SHADOW_CASTER;
+    mViewport = mHelper->addViewport( visibilityMask );
+    mVisibilityFlags = (visibilityMask & mSceneManager->getVisibilityMask()) |
+                       (visibilityMask & ~VisibilityFlags::RESERVED_VISIBILITY_FLAGS);
+
+    mMultiFrusta.resize( mCameras.size() );
+    mMultiFrustaPtrs.resize( mCameras.size() );
+    for( size_t i=0; i<mMultiFrusta.size(); ++i )
+        mMultiFrustaPtrs[i] = &mMultiFrusta[i];
+
+    mSceneManager->updateSceneGraph();
+    mSceneManager->_setCurrentRenderStage( SceneManager::IRS_RENDER_TO_TEXTURE );
+}
+//--------------------------------------------------------------------------
+void MultiFrustumCullTests::cullAllFrusta(void)
+{
+    for( size_t i=0; i<mCameras.size(); ++i )
+    {
+        mCameras[i]->setOrientation( mOrientations[i] );
+        mMultiFrusta[i].set( mCameras[i], mCameras[0], mVisibilityFlags, 0, 255 );
+    }
+
+    mSceneManager->_cullPhase01Multi( &mMultiFrustaPtrs[0], mMultiFrustaPtrs.size() );
+}
+//--------------------------------------------------------------------------
+void MultiFrustumCullTests::cullSingleFrustum( size_t frustumIdx,
+                                               MovableObject::MovableObjectArray &outObjects ) const
+{
+    Camera *camera = mCameras[frustumIdx];
+    camera->setOrientation( mOrientations[frustumIdx] );
+    //cullFrustum reads the cached planes; this updates them.
+    camera->getFrustumPlanes();
+
+    ObjectMemoryManager &memoryManager = mSceneManager->_getEntityMemoryManager( SCENE_DYNAMIC );
+    for( size_t i=0; i<memoryManager.getNumRenderQueues(); ++i )
+    {
+        ObjectData objData;
+        const size_t numObjs = memoryManager.getFirstObjectData( objData, i );
+        MovableObject::cullFrustum( numObjs, objData, camera, mVisibilityFlags,
+                                    outObjects, mCameras[0] );
+    }
+
+    std::sort( outObjects.begin(), outObjects.end(), orderByPtr );
+}
+//--------------------------------------------------------------------------
+void MultiFrustumCullTests::testResultsMatchSingleFrustum()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createScene();
+
+    CPPUNIT_ASSERT( mMultiFrusta.size() > MovableObject::MultiFrustum::MaxFrusta );
+
+    cullAllFrusta();
+
+    size_t numEmptyFrusta = 0;
+    for( size_t i=0; i<mMultiFrusta.size(); ++i )
+    {
+        CPPUNIT_ASSERT( mMultiFrusta[i].valid );
+
+        MovableObject::MovableObjectArray multiResults;
+        for( size_t j=0; j<mMultiFrusta[i].culledObjects.size(); ++j )
+        {
+            const MovableObject::MovableObjectArray &culledObjects =
+                    mMultiFrusta[i].culledObjects[j];
+            for( size_t k=0; k<culledObjects.size(); ++k )
+                multiResults.push_back( culledObjects[k] );
+        }
+        std::sort( multiResults.begin(), multiResults.end(), orderByPtr );
+
+        MovableObject::MovableObjectArray singleResults;
+        cullSingleFrustum( i, singleResults );
+
+        CPPUNIT_ASSERT_EQUAL( singleResults.size(), multiResults.size() );
+        CPPUNIT_ASSERT( std::equal( singleResults.begin(), singleResults.end(),
+                                    multiResults.begin() ) );
+        CPPUNIT_ASSERT( singleResults.size() < c_numItems );
+        if( singleResults.empty() )
+            ++numEmptyFrusta;
+    }
+
+    //Otherwise the comparison above proves little
+    CPPUNIT_ASSERT( numEmptyFrusta < mMultiFrusta.size() / 2u );
+}
+//--------------------------------------------------------------------------
+void MultiFrustumCullTests::testPreCulledResultsAreConsumed()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createScene();
+
+    for( size_t frame=0; frame<3u; ++frame )
+    {
+        cullAllFrusta();
+
+        for( size_t i=0; i<mCameras.size(); ++i )
+        {
+            mCameras[i]->setOrientation( mOrientations[i] );
+            mCameras[i]->_notifyViewport( mViewport );
+
+            //Nothing changed since the sweep, so no frustum may fall back to regular culling
+            CPPUNIT_ASSERT( mMultiFrusta[i].matches( mCameras[i], mCameras[0], mVisibilityFlags ) );
+            mSceneManager->_setPreCulledFrustum( &mMultiFrusta[i] );
+            mSceneManager->_cullPhase01( mCameras[i], mCameras[0], mViewport, 0, 255 );
+            CPPUNIT_ASSERT( !mMultiFrusta[i].valid );
+        }
+    }
+}
+//--------------------------------------------------------------------------
+void MultiFrustumCullTests::testChangedCameraFallsBack()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createScene();
+
+    cullAllFrusta();
+
+    //A listener moving the camera after the sweep
+    Camera *cascade = mCameras[1];
+    CPPUNIT_ASSERT( mMultiFrusta[1].matches( cascade, mCameras[0], mVisibilityFlags ) );
+    cascade->setPosition( cascade->getPosition() + Vector3( 5.0f, 0, 0 ) );
+    CPPUNIT_ASSERT( !mMultiFrusta[1].matches( cascade, mCameras[0], mVisibilityFlags ) );
+
+    //Or changing the visibility mask
+    const size_t faceIdx = c_numCascades + 6u;
+    mCameras[faceIdx]->setOrientation( mOrientations[faceIdx] );
+    CPPUNIT_ASSERT( mMultiFrusta[faceIdx].matches( mCameras[faceIdx], mCameras[0],
+                                                   mVisibilityFlags ) );
+    CPPUNIT_ASSERT( !mMultiFrusta[faceIdx].matches( mCameras[faceIdx], mCameras[0],
+                                                    mVisibilityFlags & ~1u ) );
+
+    //The other faces of the same cubemap see a different frustum
+    CPPUNIT_ASSERT( !mMultiFrusta[faceIdx + 1u].matches( mCameras[faceIdx], mCameras[0],
+                                                         mVisibilityFlags ) );
+}
@@ -0,0 +1,256 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "NullCommandRecorderTests.h"
+#include "NullRenderSystemHelper.h"
+
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgreCamera.h"
+#include "OgreItem.h"
+#include "OgreNULLRenderSystem.h"
+#include "OgreNULLCommandRecorder.h"
+#include "Vao/OgreVaoManager.h"
+#include "Vao/OgreVertexBufferPacked.h"
+#include "Vao/OgreAsyncTicket.h"
+
+#include "UnitTestSuite.h"
+
+#include <sstream>
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(NullCommandRecorderTests);
+
+namespace
+{
+    /// Vertices of the buffers used by the map & staging tests. float3 each.
+    const size_t c_numVertices = 16u;
+    const size_t c_bytesPerVertex = sizeof(float) * 3u;
+}
+
+//--------------------------------------------------------------------------
+void NullCommandRecorderTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mHelper = new NullRenderSystemHelper();
+    mSceneManager = 0;
+
+    NULLRenderSystem *renderSystem =
+            static_cast<NULLRenderSystem*>( mHelper->getRoot()->getRenderSystem() );
+    mRecorder = renderSystem->getCommandRecorder();
+}
+//--------------------------------------------------------------------------
+void NullCommandRecorderTests::tearDown()
+{
+    delete mHelper;
+    mHelper = 0;
+    mSceneManager = 0;
+    mRecorder = 0;
+}
+//--------------------------------------------------------------------------
+void NullCommandRecorderTests::createScene(void)
+{
+    mSceneManager = mHelper->createSceneManager();
+
+    mHelper->createCubeMesh( "NullCommandRecorderTestsCubeA" );
+    mHelper->createCubeMesh( "NullCommandRecorderTestsCubeB" );
+
+    for( size_t i=0; i<4u; ++i )
+    {
+        Item *item = mSceneManager->createItem( i < 3u ? "NullCommandRecorderTestsCubeA" :
+                                                         "NullCommandRecorderTestsCubeB" );
+        SceneNode *sceneNode = mSceneManager->getRootSceneNode()->createChildSceneNode();
+        sceneNode->setPosition( (Real)i * 3.0f - 4.5f, 0.0f, -20.0f );
+        sceneNode->attachObject( item );
+    }
+
+    Camera *camera = mSceneManager->createCamera( "NullCommandRecorderTestsCamera" );
+    camera->setPosition( Vector3::ZERO );
+    camera->lookAt( Vector3( 0, 0, -1 ) );
+    camera->setNearClipDistance( 0.5f );
+    camera->setFarClipDistance( 100.0f );
+    camera->setAutoAspectRatio( true );
+
+    mHelper->addBasicWorkspace( camera );
+
+    //The first frame compiles the shaders and uploads what the Hlms needs.
+    mHelper->getRoot()->renderOneFrame();
+}
+//--------------------------------------------------------------------------
+void NullCommandRecorderTests::testDrawCounters()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createScene();
+
+    mRecorder->setEnabled( true );
+    mHelper->getRoot()->renderOneFrame();
+    mRecorder->setEnabled( false );
+
+    const NULLFrameStats &stats = mRecorder->getLastFrameStats();
+
+    CPPUNIT_ASSERT_EQUAL( 1u, stats.numFrames );
+    CPPUNIT_ASSERT_EQUAL( (size_t)1u, stats.numClears );
+    //Both meshes share the PSO. Unlike GL, the NULL render system gives each
+    //mesh its own Vao. The three instances of A get merged into one draw.
+    CPPUNIT_ASSERT_EQUAL( (size_t)1u, stats.numPsoBinds );
+    CPPUNIT_ASSERT_EQUAL( (size_t)2u, stats.numVaoBinds );
+    CPPUNIT_ASSERT_EQUAL( (size_t)2u, stats.numDrawCalls );
+    CPPUNIT_ASSERT_EQUAL( (size_t)4u, stats.numInstances );
+    CPPUNIT_ASSERT_EQUAL( (size_t)(2u * 36u), stats.numPrimitives );
+    //The Hlms fills its const & tex buffers every frame
+    CPPUNIT_ASSERT( stats.numBufferMaps > 0u );
+    CPPUNIT_ASSERT_EQUAL( stats.numBufferMaps, stats.numBufferUnmaps );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0u, stats.numDispatches );
+}
+//--------------------------------------------------------------------------
+void NullCommandRecorderTests::testAccumulatedStats()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createScene();
+
+    mRecorder->setEnabled( true );
+    mRecorder->resetAccumulatedStats();
+    for( size_t i=0; i<3u; ++i )
+        mHelper->getRoot()->renderOneFrame();
+    mRecorder->setEnabled( false );
+
+    const NULLFrameStats &lastFrame = mRecorder->getLastFrameStats();
+    const NULLFrameStats &accumulated = mRecorder->getAccumulatedStats();
+
+    CPPUNIT_ASSERT_EQUAL( 3u, accumulated.numFrames );
+    CPPUNIT_ASSERT_EQUAL( lastFrame.frameCount, accumulated.frameCount );
+    CPPUNIT_ASSERT_EQUAL( 3u * lastFrame.numDrawCalls, accumulated.numDrawCalls );
+    CPPUNIT_ASSERT_EQUAL( 3u * lastFrame.numPrimitives, accumulated.numPrimitives );
+    CPPUNIT_ASSERT_EQUAL( 3u * lastFrame.numClears, accumulated.numClears );
+}
+//--------------------------------------------------------------------------
+void NullCommandRecorderTests::testOutputStream()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createScene();
+
+    std::ostringstream output;
+    mRecorder->setOutputStream( &output );
+    mRecorder->setEnabled( true );
+    mHelper->getRoot()->renderOneFrame();
+    mRecorder->setEnabled( false );
+    mRecorder->setOutputStream( 0 );
+
+    const String text = output.str();
+    CPPUNIT_ASSERT( text.find( "draw_indexed 36 3\n" ) != String::npos );
+    CPPUNIT_ASSERT( text.find( "draw_indexed 36 1\n" ) != String::npos );
+    CPPUNIT_ASSERT( text.find( "end_frame " ) != String::npos );
+
+    //Recording the same scene again must give the same text, frame number aside.
+    std::ostringstream output2;
+    mRecorder->setOutputStream( &output2 );
+    mRecorder->setEnabled( true );
+    mHelper->getRoot()->renderOneFrame();
+    mRecorder->setEnabled( false );
+    mRecorder->setOutputStream( 0 );
+
+    const String text2 = output2.str();
+    CPPUNIT_ASSERT_EQUAL( text.substr( 0, text.find( "end_frame " ) ),
+                          text2.substr( 0, text2.find( "end_frame " ) ) );
+}
+//--------------------------------------------------------------------------
+void NullCommandRecorderTests::testBufferMapCounters()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    VaoManager *vaoManager = mHelper->getVaoManager();
+
+    VertexElement2Vec vertexElements;
+    vertexElements.push_back( VertexElement2( VET_FLOAT3, VES_POSITION ) );
+    VertexBufferPacked *vertexBuffer = vaoManager->createVertexBuffer( vertexElements,
+                                                                       c_numVertices,
+                                                                       BT_DYNAMIC_DEFAULT,
+                                                                       0, false );
+
+    mRecorder->setEnabled( true );
+
+    vertexBuffer->map( 0, c_numVertices );
+    vertexBuffer->unmap( UO_UNMAP_ALL, 0, c_numVertices / 2u );
+
+    const NULLFrameStats &stats = mRecorder->getCurrentFrameStats();
+    CPPUNIT_ASSERT_EQUAL( (size_t)1u, stats.numBufferMaps );
+    CPPUNIT_ASSERT_EQUAL( c_numVertices * c_bytesPerVertex, stats.bytesMapped );
+    CPPUNIT_ASSERT_EQUAL( (size_t)1u, stats.numBufferUnmaps );
+    CPPUNIT_ASSERT_EQUAL( c_numVertices / 2u * c_bytesPerVertex, stats.bytesFlushed );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0u, stats.numStagingUploads );
+
+    mRecorder->setEnabled( false );
+
+    vaoManager->destroyVertexBuffer( vertexBuffer );
+}
+//--------------------------------------------------------------------------
+void NullCommandRecorderTests::testStagingCounters()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    VaoManager *vaoManager = mHelper->getVaoManager();
+
+    VertexElement2Vec vertexElements;
+    vertexElements.push_back( VertexElement2( VET_FLOAT3, VES_POSITION ) );
+    VertexBufferPacked *vertexBuffer = vaoManager->createVertexBuffer( vertexElements,
+                                                                       c_numVertices,
+                                                                       BT_DEFAULT, 0, false );
+
+    float data[c_numVertices * 3u];
+    for( size_t i=0; i<c_numVertices * 3u; ++i )
+        data[i] = (float)i;
+
+    mRecorder->setEnabled( true );
+
+    vertexBuffer->upload( data, 0, c_numVertices );
+
+    const NULLFrameStats &stats = mRecorder->getCurrentFrameStats();
+    CPPUNIT_ASSERT_EQUAL( (size_t)1u, stats.numStagingUploads );
+    CPPUNIT_ASSERT_EQUAL( c_numVertices * c_bytesPerVertex, stats.bytesStagingUploaded );
+
+    //Read back the vertices 4 to 11
+    AsyncTicketPtr ticket = vertexBuffer->readRequest( 4u, 8u );
+    CPPUNIT_ASSERT_EQUAL( (size_t)1u, stats.numStagingDownloads );
+    CPPUNIT_ASSERT_EQUAL( 8u * c_bytesPerVertex, stats.bytesStagingDownloaded );
+    //Staging transfers aren't buffer maps
+    CPPUNIT_ASSERT_EQUAL( (size_t)0u, stats.numBufferMaps );
+
+    mRecorder->setEnabled( false );
+
+    const float *readBack = reinterpret_cast<const float*>( ticket->map() );
+    CPPUNIT_ASSERT( memcmp( readBack, data + 4u * 3u, 8u * c_bytesPerVertex ) == 0 );
+    ticket->unmap();
+    ticket.setNull();
+
+    vaoManager->destroyVertexBuffer( vertexBuffer );
+}
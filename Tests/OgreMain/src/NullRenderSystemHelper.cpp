@@ -0,0 +1,239 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "NullRenderSystemHelper.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "OgreRoot.h"
+#include "OgreRenderSystem.h"
+#include "OgreRenderWindow.h"
+#include "OgreMesh2.h"
+#include "OgreMeshManager2.h"
+#include "OgreSubMesh2.h"
+#include "OgreArchiveManager.h"
+#include "OgreHlmsManager.h"
+#include "OgreCamera.h"
+#include "OgreViewport.h"
+#include "Compositor/OgreCompositorManager2.h"
+
+#include "Vao/OgreVaoManager.h"
+#include "Vao/OgreVertexArrayObject.h"
+
+#ifdef OGRE_STATIC_LIB
+    #include "OgreNULLPlugin.h"
+#endif
+
+#ifdef OGRE_BUILD_COMPONENT_HLMS_UNLIT
+    #include "OgreHlmsUnlit.h"
+#endif
+
+#ifndef OGRE_TESTS_SAMPLES_MEDIA_DIR
+    #define OGRE_TESTS_SAMPLES_MEDIA_DIR "./"
+#endif
+
+using namespace Ogre;
+
+//--------------------------------------------------------------------------
+NullRenderSystemHelper::NullRenderSystemHelper() :
+    mRoot( 0 ),
+    mWindow( 0 ),
+    mSceneManager( 0 ),
+    mWorkspace( 0 )
+{
+    mRoot = OGRE_NEW Root( BLANKSTRING, BLANKSTRING, BLANKSTRING );
+
+    try
+    {
+#ifdef OGRE_STATIC_LIB
+        mNullPlugin = OGRE_NEW NULLPlugin();
+        mRoot->installPlugin( mNullPlugin );
+#else
+        mRoot->loadPlugin( "RenderSystem_NULL" OGRE_BUILD_SUFFIX );
+#endif
+
+        RenderSystem *renderSystem = mRoot->getRenderSystemByName( "NULL Rendering Subsystem" );
+        if( !renderSystem )
+        {
+            OGRE_EXCEPT( Exception::ERR_ITEM_NOT_FOUND, "NULL Rendering Subsystem not found",
+                         "NullRenderSystemHelper::NullRenderSystemHelper" );
+        }
+
+        mRoot->setRenderSystem( renderSystem );
+        mRoot->initialise( false );
+        mWindow = mRoot->createRenderWindow( "NullRenderSystemHelper", 1024, 1024, false );
+    }
+    catch( Exception &e )
+    {
+        OGRE_DELETE mRoot;
+        mRoot = 0;
+#ifdef OGRE_STATIC_LIB
+        OGRE_DELETE mNullPlugin;
+#endif
+        CPPUNIT_FAIL( "Could not start the NULL render system: " + e.getFullDescription() );
+    }
+
+#ifdef OGRE_BUILD_COMPONENT_HLMS_UNLIT
+    ArchiveManager &archiveManager = ArchiveManager::getSingleton();
+
+    String mainFolderPath;
+    StringVector libraryFoldersPaths;
+    HlmsUnlit::getDefaultPaths( mainFolderPath, libraryFoldersPaths );
+
+    Archive *archiveUnlit = archiveManager.load( OGRE_TESTS_SAMPLES_MEDIA_DIR + mainFolderPath,
+                                                 "FileSystem", true );
+    ArchiveVec archiveUnlitLibraryFolders;
+    StringVector::const_iterator itor = libraryFoldersPaths.begin();
+    StringVector::const_iterator end  = libraryFoldersPaths.end();
+    while( itor != end )
+    {
+        archiveUnlitLibraryFolders.push_back(
+                    archiveManager.load( OGRE_TESTS_SAMPLES_MEDIA_DIR + *itor, "FileSystem", true ) );
+        ++itor;
+    }
+
+    HlmsUnlit *hlmsUnlit = OGRE_NEW HlmsUnlit( archiveUnlit, &archiveUnlitLibraryFolders );
+    mRoot->getHlmsManager()->registerHlms( hlmsUnlit );
+    //Pbs isn't registered, Items created without a material need a default from somewhere.
+    mRoot->getHlmsManager()->useDefaultDatablockFrom( HLMS_UNLIT );
+#endif
+}
+//--------------------------------------------------------------------------
+NullRenderSystemHelper::~NullRenderSystemHelper()
+{
+    if( mWorkspace )
+        mRoot->getCompositorManager2()->removeWorkspace( mWorkspace );
+    if( mSceneManager )
+        mRoot->destroySceneManager( mSceneManager );
+
+    //Root unloads the resources after shutting down the RenderSystem,
+    //meshes still alive by then would destroy their buffers too late.
+    MeshManager::getSingleton().removeAll();
+    OGRE_DELETE mRoot;
+#ifdef OGRE_STATIC_LIB
+    OGRE_DELETE mNullPlugin;
+#endif
+}
+//--------------------------------------------------------------------------
+VaoManager* NullRenderSystemHelper::getVaoManager(void) const
+{
+    return mRoot->getRenderSystem()->getVaoManager();
+}
+//--------------------------------------------------------------------------
+SceneManager* NullRenderSystemHelper::createSceneManager( size_t numThreads )
+{
+    CPPUNIT_ASSERT( !mSceneManager );
+    mSceneManager = mRoot->createSceneManager( ST_GENERIC, numThreads,
+                                               numThreads > 1u ? INSTANCING_CULLING_THREADED :
+                                                                 INSTANCING_CULLING_SINGLETHREAD );
+    return mSceneManager;
+}
+//--------------------------------------------------------------------------
+Viewport* NullRenderSystemHelper::addViewport( uint32 visibilityMask )
+{
+    Viewport *viewport = mWindow->addViewport();
+    viewport->_setVisibilityMask( visibilityMask, visibilityMask );
+    return viewport;
+}
+//--------------------------------------------------------------------------
+Camera* NullRenderSystemHelper::createCamera( const String &name, uint32 visibilityMask )
+{
+    Camera *camera = mSceneManager->createCamera( name );
+    camera->_notifyViewport( addViewport( visibilityMask ) );
+    return camera;
+}
+//--------------------------------------------------------------------------
+CompositorWorkspace* NullRenderSystemHelper::addBasicWorkspace( Camera *camera )
+{
+    CPPUNIT_ASSERT( mSceneManager && !mWorkspace );
+
+    const String workspaceName( "NullRenderSystemHelperWorkspace" );
+    CompositorManager2 *compositorManager = mRoot->getCompositorManager2();
+    if( !compositorManager->hasWorkspaceDefinition( workspaceName ) )
+        compositorManager->createBasicWorkspaceDef( workspaceName, ColourValue::Black );
+
+    mWorkspace = compositorManager->addWorkspace( mSceneManager, mWindow, camera,
+                                                  workspaceName, true );
+    return mWorkspace;
+}
+//--------------------------------------------------------------------------
+MeshPtr NullRenderSystemHelper::createCubeMesh( VaoManager *vaoManager, const String &name,
+                                                bool keepAsShadow )
+{
+    const uint16 c_indices[36] =
+    {
+        0, 2, 1, 2, 0, 3,   4, 5, 6, 6, 7, 4,   0, 1, 5, 5, 4, 0,
+        3, 6, 2, 6, 3, 7,   1, 2, 6, 6, 5, 1,   0, 4, 7, 7, 3, 0
+    };
+
+    MeshPtr mesh = MeshManager::getSingleton().createManual(
+                name, ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME );
+    SubMesh *subMesh = mesh->createSubMesh();
+
+    VertexElement2Vec vertexElements;
+    vertexElements.push_back( VertexElement2( VET_FLOAT3, VES_POSITION ) );
+
+    //With keepAsShadow the buffers take ownership of the pointers.
+    float *vertices = reinterpret_cast<float*>(
+                OGRE_MALLOC_SIMD( sizeof(float) * 8u * 3u, MEMCATEGORY_GEOMETRY ) );
+    for( size_t i=0; i<8u; ++i )
+    {
+        vertices[i * 3u + 0u] = (i == 1 || i == 2 || i == 5 || i == 6) ? 1.0f : -1.0f;
+        vertices[i * 3u + 1u] = (i == 2 || i == 3 || i == 6 || i == 7) ? 1.0f : -1.0f;
+        vertices[i * 3u + 2u] = i >= 4u ? 1.0f : -1.0f;
+    }
+    uint16 *indices = reinterpret_cast<uint16*>(
+                OGRE_MALLOC_SIMD( sizeof(c_indices), MEMCATEGORY_GEOMETRY ) );
+    memcpy( indices, c_indices, sizeof(c_indices) );
+
+    VertexBufferPackedVec vertexBuffers;
+    vertexBuffers.push_back( vaoManager->createVertexBuffer( vertexElements, 8u, BT_IMMUTABLE,
+                                                             vertices, keepAsShadow ) );
+    IndexBufferPacked *indexBuffer = vaoManager->createIndexBuffer(
+                                         IndexBufferPacked::IT_16BIT, 36u, BT_IMMUTABLE,
+                                         indices, keepAsShadow );
+    VertexArrayObject *vao = vaoManager->createVertexArrayObject( vertexBuffers, indexBuffer,
+                                                                  OT_TRIANGLE_LIST );
+    subMesh->mVao[VpNormal].push_back( vao );
+    subMesh->mVao[VpShadow].push_back( vao );
+
+    if( !keepAsShadow )
+    {
+        OGRE_FREE_SIMD( vertices, MEMCATEGORY_GEOMETRY );
+        OGRE_FREE_SIMD( indices, MEMCATEGORY_GEOMETRY );
+    }
+
+    mesh->_setBounds( Aabb( Vector3::ZERO, Vector3::UNIT_SCALE ), false );
+    mesh->_setBoundingSphereRadius( 1.732f );
+
+    return mesh;
+}
+//--------------------------------------------------------------------------
+MeshPtr NullRenderSystemHelper::createCubeMesh( const String &name, bool keepAsShadow )
+{
+    return createCubeMesh( getVaoManager(), name, keepAsShadow );
+}
@@ -0,0 +1,189 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OcclusionCullingTests.h"
+#include "NullRenderSystemHelper.h"
+
+#include "OgreRoot.h"
+#include "OgreViewport.h"
+#include "OgreCamera.h"
+#include "OgreSceneManager.h"
+#include "OgreItem.h"
+#include "OgreMesh2.h"
+#include "OgreSoftwareOcclusionCulling.h"
+
+#include "UnitTestSuite.h"
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(OcclusionCullingTests);
+
+namespace
+{
+    /// A 10x10 wall 20 units in front of the camera covers about 14 degrees to each side.
+    const Vector3 c_wallPosition( 0, 0, -20.0f );
+    const Vector3 c_wallHalfSize( 5.0f, 5.0f, 1.0f );
+    const size_t c_numPropsPerGroup = 50u;
+}
+//--------------------------------------------------------------------------
+void OcclusionCullingTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mHelper = 0;
+    mSceneManager = 0;
+    mCamera = 0;
+    mViewport = 0;
+}
+//--------------------------------------------------------------------------
+void OcclusionCullingTests::tearDown()
+{
+    if( mSceneManager )
+        mSceneManager->setSoftwareOcclusionCulling( false );
+
+    delete mHelper;
+    mHelper = 0;
+    mSceneManager = 0;
+}
+//--------------------------------------------------------------------------
+void OcclusionCullingTests::createScene(void)
+{
+    mHelper = new NullRenderSystemHelper();
+    mSceneManager = mHelper->createSceneManager();
+    mHelper->createCubeMesh( "OcclusionCullingTestsCube" );
+
+    mCamera = mHelper->createCamera( "Camera" );
+    mCamera->setPosition( Vector3::ZERO );
+    mCamera->setNearClipDistance( 0.2f );
+    mCamera->setFarClipDistance( 1000.0f );
+    mCamera->setAspectRatio( 1.0f );
+    mViewport = mCamera->getLastViewport();
+
+    mSceneManager->setSoftwareOcclusionCulling( true, 128u, 128u );
+}
+//--------------------------------------------------------------------------
+Item* OcclusionCullingTests::addBox( const Vector3 &position, const Vector3 &halfSize )
+{
+    Item *item = mSceneManager->createItem( "OcclusionCullingTestsCube",
+                                            ResourceGroupManager::AUTODETECT_RESOURCE_GROUP_NAME,
+                                            SCENE_DYNAMIC );
+    SceneNode *sceneNode = mSceneManager->getRootSceneNode( SCENE_DYNAMIC )->
+            createChildSceneNode( SCENE_DYNAMIC );
+    sceneNode->setPosition( position );
+    sceneNode->setScale( halfSize );
+    sceneNode->attachObject( item );
+    return item;
+}
+//--------------------------------------------------------------------------
+void OcclusionCullingTests::testNoOccludersHidesNothing()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createScene();
+
+    //The wall is there, but it's not registered as an occluder
+    addBox( c_wallPosition, c_wallHalfSize );
+    mSceneManager->updateSceneGraph();
+
+    SoftwareOcclusionCulling *occlusionCulling = mSceneManager->getSoftwareOcclusionCulling();
+    occlusionCulling->_update( mCamera, mSceneManager );
+
+    CPPUNIT_ASSERT( occlusionCulling->isVisible( Aabb( Vector3( 0, 0, -40.0f ), Vector3::UNIT_SCALE ) ) );
+    CPPUNIT_ASSERT( occlusionCulling->isVisible( Aabb( Vector3( 0, 0, -900.0f ), Vector3::UNIT_SCALE ) ) );
+    CPPUNIT_ASSERT( occlusionCulling->isVisible( Aabb( Vector3( 3.0f, -2.0f, -5.0f ),
+                                                       Vector3::UNIT_SCALE * 0.1f ) ) );
+}
+//--------------------------------------------------------------------------
+void OcclusionCullingTests::testBoxBehindOccluderIsHidden()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createScene();
+
+    SoftwareOcclusionCulling *occlusionCulling = mSceneManager->getSoftwareOcclusionCulling();
+    occlusionCulling->addBoxOccluder( addBox( c_wallPosition, c_wallHalfSize ) );
+    mSceneManager->updateSceneGraph();
+    occlusionCulling->_update( mCamera, mSceneManager );
+
+    const Vector3 halfSize( Vector3::UNIT_SCALE );
+
+    //Fully behind the wall
+    CPPUNIT_ASSERT( !occlusionCulling->isVisible( Aabb( Vector3( 0, 0, -40.0f ), halfSize ) ) );
+    CPPUNIT_ASSERT( !occlusionCulling->isVisible( Aabb( Vector3( 2.0f, 2.0f, -300.0f ), halfSize ) ) );
+    //In front of it
+    CPPUNIT_ASSERT( occlusionCulling->isVisible( Aabb( Vector3( 0, 0, -10.0f ), halfSize ) ) );
+    //Behind it, but only partially covered
+    CPPUNIT_ASSERT( occlusionCulling->isVisible( Aabb( Vector3( 10.0f, 0, -40.0f ), halfSize ) ) );
+    //Behind it, to the side
+    CPPUNIT_ASSERT( occlusionCulling->isVisible( Aabb( Vector3( 0, -13.0f, -40.0f ), halfSize ) ) );
+    //Intersecting the wall
+    CPPUNIT_ASSERT( occlusionCulling->isVisible( Aabb( Vector3( 0, 0, -19.0f ), halfSize ) ) );
+
+    //Hidden occluders don't occlude
+    mSceneManager->getRootSceneNode( SCENE_DYNAMIC )->setVisible( false );
+    mCamera->setPosition( 0, 0, 0.1f );
+    occlusionCulling->_update( mCamera, mSceneManager );
+    CPPUNIT_ASSERT( occlusionCulling->isVisible( Aabb( Vector3( 0, 0, -40.0f ), halfSize ) ) );
+}
+//--------------------------------------------------------------------------
+void OcclusionCullingTests::testCullPhaseRemovesOccludedObjects()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createScene();
+
+    SoftwareOcclusionCulling *occlusionCulling = mSceneManager->getSoftwareOcclusionCulling();
+    occlusionCulling->addBoxOccluder( addBox( c_wallPosition, c_wallHalfSize ) );
+
+    const Vector3 propHalfSize( Vector3::UNIT_SCALE * 0.5f );
+    for( size_t i=0; i<c_numPropsPerGroup; ++i )
+    {
+        //Hidden: at most ~4 degrees off the view direction, well behind the wall
+        addBox( Vector3( Math::RangeRandom( -2.0f, 2.0f ), Math::RangeRandom( -2.0f, 2.0f ),
+                         Math::RangeRandom( -60.0f, -40.0f ) ), propHalfSize );
+        //Visible: between the camera and the wall
+        addBox( Vector3( Math::RangeRandom( -3.0f, 3.0f ), Math::RangeRandom( -3.0f, 3.0f ),
+                         Math::RangeRandom( -15.0f, -5.0f ) ), propHalfSize );
+    }
+
+    mSceneManager->updateSceneGraph();
+    mSceneManager->_cullPhase01( mCamera, mCamera, mViewport, 0, 255 );
+
+    const SoftwareOcclusionCulling::Stats stats = occlusionCulling->getStats();
+    CPPUNIT_ASSERT_EQUAL( (size_t)1u, stats.numOccluders );
+    //Every prop passes frustum culling, and so does the wall
+    CPPUNIT_ASSERT( stats.numTested >= c_numPropsPerGroup * 2u );
+    CPPUNIT_ASSERT_EQUAL( c_numPropsPerGroup, stats.numCulled );
+
+    //Shadow passes ignore occlusion culling
+    mSceneManager->_setCurrentRenderStage( SceneManager::IRS_RENDER_TO_TEXTURE );
+    mCamera->setPosition( 0, 0, 0.1f );
+    mSceneManager->_cullPhase01( mCamera, mCamera, mViewport, 0, 255 );
+    mSceneManager->_setCurrentRenderStage( SceneManager::IRS_NONE );
+    CPPUNIT_ASSERT_EQUAL( stats.numTested, occlusionCulling->getStats().numTested );
+}
@@ -0,0 +1,203 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "PipelinedUpdateTests.h"
+#include "NullRenderSystemHelper.h"
+
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgreItem.h"
+#include "OgreMesh2.h"
+
+#include "UnitTestSuite.h"
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(PipelinedUpdateTests);
+
+namespace
+{
+    const size_t c_numGroups = 200u;
+    const size_t c_itemsPerGroup = 8u;
+    const size_t c_numFrames = 12u;
+}
+//--------------------------------------------------------------------------
+void PipelinedUpdateTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mHelper = 0;
+    mSceneManager = 0;
+}
+//--------------------------------------------------------------------------
+void PipelinedUpdateTests::tearDown()
+{
+    if( mSceneManager )
+        mSceneManager->setPipelinedUpdate( false );
+
+    mGroupNodes.clear();
+    mItems.clear();
+    delete mHelper;
+    mHelper = 0;
+    mSceneManager = 0;
+}
+//--------------------------------------------------------------------------
+void PipelinedUpdateTests::createScene(void)
+{
+    mHelper = new NullRenderSystemHelper();
+    mSceneManager = mHelper->createSceneManager( 2u );
+    MeshPtr mesh = mHelper->createCubeMesh( "PipelinedUpdateTestsCube" );
+
+    SceneNode *rootNode = mSceneManager->getRootSceneNode();
+    for( size_t i=0; i<c_numGroups; ++i )
+    {
+        SceneNode *groupNode = rootNode->createChildSceneNode();
+        for( size_t j=0; j<c_itemsPerGroup; ++j )
+        {
+            Item *item = mSceneManager->createItem( mesh );
+            SceneNode *sceneNode = groupNode->createChildSceneNode();
+            sceneNode->setPosition( (j % 4u) * 3.0f, (j / 4u) * 3.0f, 0 );
+            sceneNode->setScale( Vector3( 0.5f + (j % 3u) * 0.25f ) );
+            sceneNode->attachObject( item );
+            mItems.push_back( item );
+        }
+        mGroupNodes.push_back( groupNode );
+    }
+}
+//--------------------------------------------------------------------------
+void PipelinedUpdateTests::animate( size_t frame )
+{
+    const Real t = frame * 0.02f;
+    for( size_t i=0; i<mGroupNodes.size(); ++i )
+    {
+        const Real phase = t + i * 0.37f;
+        mGroupNodes[i]->setOrientation( Quaternion( Radian( phase ), Vector3::UNIT_Y ) );
+        mGroupNodes[i]->setPosition( (i % 64u) * 20.0f + Math::Sin( phase ) * 5.0f,
+                                     Math::Cos( phase * 0.5f ),
+                                     (i / 64u) * 20.0f );
+    }
+}
+//--------------------------------------------------------------------------
+double PipelinedUpdateTests::calculateChecksum(void) const
+{
+    double checksum = 0;
+
+    vector<Item*>::type::const_iterator itor = mItems.begin();
+    vector<Item*>::type::const_iterator end  = mItems.end();
+    while( itor != end )
+    {
+        const Item *item = *itor;
+        const Matrix4 &worldMat = item->getParentNode()->_getFullTransform();
+        const Aabb worldAabb = item->getWorldAabb();
+
+        checksum += worldMat[0][3] + worldMat[1][3] + worldMat[2][3] + worldMat[0][0] +
+                    worldAabb.mCenter.x + worldAabb.mCenter.y + worldAabb.mCenter.z +
+                    worldAabb.mHalfSize.x + item->getWorldRadius();
+        ++itor;
+    }
+
+    return checksum;
+}
+//--------------------------------------------------------------------------
+void PipelinedUpdateTests::runSerial( size_t numFrames, vector<double>::type &outChecksums )
+{
+    outChecksums.clear();
+    for( size_t frame=0; frame<numFrames; ++frame )
+    {
+        animate( frame );
+        mSceneManager->updateSceneGraph();
+        outChecksums.push_back( calculateChecksum() );
+    }
+}
+//--------------------------------------------------------------------------
+void PipelinedUpdateTests::testRenderSeesPreviousFrame()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createScene();
+
+    vector<double>::type serialChecksums;
+    runSerial( c_numFrames, serialChecksums );
+
+    //Frame N gets updated while frame N - 1 is rendered.
+    mSceneManager->setPipelinedUpdate( true );
+    animate( 0 );
+    mSceneManager->updateSceneGraph();
+
+    for( size_t frame=1; frame<c_numFrames; ++frame )
+    {
+        animate( frame );
+        mSceneManager->updateSceneGraphAsync();
+        CPPUNIT_ASSERT( mSceneManager->isSceneGraphUpdatePending() );
+        CPPUNIT_ASSERT_EQUAL( serialChecksums[frame - 1u], calculateChecksum() );
+        mSceneManager->waitForSceneGraphUpdate();
+        CPPUNIT_ASSERT( !mSceneManager->isSceneGraphUpdatePending() );
+    }
+}
+//--------------------------------------------------------------------------
+void PipelinedUpdateTests::testEndsWithSameScene()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createScene();
+
+    vector<double>::type serialChecksums;
+    runSerial( c_numFrames, serialChecksums );
+
+    mSceneManager->setPipelinedUpdate( true );
+    for( size_t frame=0; frame<c_numFrames; ++frame )
+    {
+        animate( frame );
+        mSceneManager->updateSceneGraphAsync();
+        mSceneManager->waitForSceneGraphUpdate();
+    }
+
+    CPPUNIT_ASSERT_EQUAL( serialChecksums.back(), calculateChecksum() );
+}
+//--------------------------------------------------------------------------
+void PipelinedUpdateTests::testRenderOneFrameWaitsForUpdate()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createScene();
+
+    vector<double>::type serialChecksums;
+    runSerial( c_numFrames, serialChecksums );
+
+    mSceneManager->setPipelinedUpdate( true );
+    for( size_t frame=0; frame<4u; ++frame )
+    {
+        animate( frame );
+        mHelper->getRoot()->renderOneFrame();
+        CPPUNIT_ASSERT( !mSceneManager->isSceneGraphUpdatePending() );
+    }
+
+    CPPUNIT_ASSERT_EQUAL( serialChecksums[3], calculateChecksum() );
+}
+//--------------------------------------------------------------------------
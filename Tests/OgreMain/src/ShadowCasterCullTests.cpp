@@ -0,0 +1,271 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "ShadowCasterCullTests.h"
+#include "NullRenderSystemHelper.h"
+
+#include "OgreRoot.h"
+#include "OgreViewport.h"
+#include "OgreCamera.h"
+#include "OgreLight.h"
+#include "OgreSceneManager.h"
+#include "OgreItem.h"
+#include "OgreMesh2.h"
+#include "OgreShadowCasterVolume.h"
+#include "Math/Array/OgreObjectMemoryManager.h"
+
+#include "UnitTestSuite.h"
+
+#include <algorithm>
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(ShadowCasterCullTests);
+
+namespace
+{
+    const size_t c_numItems = 20000u;
+    const Real c_worldSize = 1000.0f;
+    const size_t c_numFrames = 8u;
+    const size_t c_numSplits = 3u;
+    const Real c_splitPoints[c_numSplits + 1u] = { 0.5f, 40.0f, 150.0f, 500.0f };
+    /// How far behind the receivers the shadow camera is placed, to catch tall casters.
+    const Real c_casterDistance = 200.0f;
+    const uint32 c_visibilityMask = VisibilityFlags::RESERVED_VISIBILITY_FLAGS |
+                                    VisibilityFlags::LAYER_SHADOW_CASTER;
+
+    /// Orthographic camera fitted to the receivers in light space, like the
+    /// focused shadow camera setups do.
+    void fitShadowCamera( Camera *shadowCamera, const Vector3 corners[8], const Vector3 &lightDir )
+    {
+        shadowCamera->setPosition( Vector3::ZERO );
+        shadowCamera->setDirection( lightDir );
+        const Quaternion lightSpaceToWorld = shadowCamera->getOrientation();
+        const Quaternion worldToLightSpace = lightSpaceToWorld.Inverse();
+
+        AxisAlignedBox lightSpaceBox;
+        for( size_t i=0; i<8; ++i )
+            lightSpaceBox.merge( worldToLightSpace * corners[i] );
+
+        const Vector3 centre = lightSpaceBox.getCenter();
+        const Vector3 size = lightSpaceBox.getSize();
+
+        shadowCamera->setPosition( lightSpaceToWorld * Vector3( centre.x, centre.y,
+                                                                lightSpaceBox.getMaximum().z +
+                                                                c_casterDistance ) );
+        shadowCamera->setOrthoWindow( size.x, size.y );
+        shadowCamera->setNearClipDistance( 1.0f );
+        shadowCamera->setFarClipDistance( c_casterDistance + size.z );
+    }
+
+    bool orderByPtr( const MovableObject *l, const MovableObject *r )
+    {
+        return l < r;
+    }
+}
+//--------------------------------------------------------------------------
+void ShadowCasterCullTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mHelper = 0;
+    mSceneManager = 0;
+    mCamera = 0;
+    mShadowCamera = 0;
+    mViewport = 0;
+    mSun = 0;
+    mRenderQueue = 0;
+}
+//--------------------------------------------------------------------------
+void ShadowCasterCullTests::tearDown()
+{
+    delete mHelper;
+    mHelper = 0;
+    mSceneManager = 0;
+}
+//--------------------------------------------------------------------------
+void ShadowCasterCullTests::createScene( size_t numThreads )
+{
+    mHelper = new NullRenderSystemHelper();
+    mSceneManager = mHelper->createSceneManager( numThreads );
+    MeshPtr mesh = mHelper->createCubeMesh( "ShadowCasterCullTestsCube" );
+
+    //Scatter objects randomly, some of them tall
+    SceneNode *rootNode = mSceneManager->getRootSceneNode();
+    for( size_t i=0; i<c_numItems; ++i )
+    {
+        Item *item = mSceneManager->createItem( mesh );
+        SceneNode *sceneNode = rootNode->createChildSceneNode();
+        const Real height = (i % 16u) == 0 ? 20.0f : 1.0f;
+        sceneNode->setPosition( Math::RangeRandom( -c_worldSize, c_worldSize ) * 0.5f,
+                                height,
+                                Math::RangeRandom( -c_worldSize, c_worldSize ) * 0.5f );
+        sceneNode->setScale( 1.0f, height, 1.0f );
+        sceneNode->attachObject( item );
+        mRenderQueue = item->getRenderQueueGroup();
+    }
+
+    //A low sun
+    mSun = mSceneManager->createLight();
+    rootNode->createChildSceneNode()->attachObject( mSun );
+    mSun->setType( Light::LT_DIRECTIONAL );
+    mSun->setDirection( Vector3( 0.6f, -0.35f, -0.5f ).normalisedCopy() );
+
+    mCamera = mHelper->createCamera( "OpenWorldCamera", c_visibilityMask );
+    mCamera->setPosition( 0, 5.0f, 0 );
+    mCamera->setNearClipDistance( c_splitPoints[0] );
+    mCamera->setFarClipDistance( c_splitPoints[c_numSplits] );
+    mCamera->setAutoAspectRatio( true );
+    mViewport = mCamera->getLastViewport();
+
+    mShadowCamera = mSceneManager->createCamera( "ShadowCamera" );
+    mShadowCamera->setProjectionType( PT_ORTHOGRAPHIC );
+    mShadowCamera->_notifyViewport( mViewport );
+
+    mSceneManager->updateSceneGraph();
+}
+//--------------------------------------------------------------------------
+void ShadowCasterCullTests::cullSplit( size_t frame, size_t split, ShadowCasterVolume &outVolume,
+                                       MovableObject::MovableObjectArray &outCameraOnly,
+                                       MovableObject::MovableObjectArray &outWithVolume )
+{
+    mCamera->setOrientation( Quaternion( Radian( Math::TWO_PI * (Real)frame / c_numFrames ),
+                                         Vector3::UNIT_Y ) );
+
+    Vector3 corners[8];
+    ShadowCasterVolume::getReceiverCorners( mCamera, c_splitPoints[split],
+                                            c_splitPoints[split + 1u], corners );
+    fitShadowCamera( mShadowCamera, corners, mSun->getDerivedDirection() );
+    outVolume.build( corners, mSun );
+
+    ObjectMemoryManager &memoryManager = mSceneManager->_getEntityMemoryManager( SCENE_DYNAMIC );
+    ObjectData objData;
+    const size_t numObjs = memoryManager.getFirstObjectData( objData, mRenderQueue );
+
+    outCameraOnly.clear();
+    mShadowCamera->_setShadowCasterVolume( 0 );
+    mShadowCamera->getFrustumPlanes();
+    MovableObject::cullFrustum( numObjs, objData, mShadowCamera, c_visibilityMask,
+                                outCameraOnly, mCamera );
+
+    outWithVolume.clear();
+    mShadowCamera->_setShadowCasterVolume( &outVolume );
+    MovableObject::cullFrustum( numObjs, objData, mShadowCamera, c_visibilityMask,
+                                outWithVolume, mCamera );
+    mShadowCamera->_setShadowCasterVolume( 0 );
+
+    std::sort( outCameraOnly.begin(), outCameraOnly.end(), orderByPtr );
+    std::sort( outWithVolume.begin(), outWithVolume.end(), orderByPtr );
+}
+//--------------------------------------------------------------------------
+void ShadowCasterCullTests::testVolumeOnlyRemovesCasters()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createScene( 1u );
+
+    size_t numCastersCameraOnly = 0;
+    size_t numCastersWithVolume = 0;
+
+    ShadowCasterVolume volume;
+    MovableObject::MovableObjectArray cameraOnly;
+    MovableObject::MovableObjectArray withVolume;
+
+    for( size_t frame=0; frame<c_numFrames; ++frame )
+    {
+        for( size_t i=0; i<c_numSplits; ++i )
+        {
+            cullSplit( frame, i, volume, cameraOnly, withVolume );
+            CPPUNIT_ASSERT( std::includes( cameraOnly.begin(), cameraOnly.end(),
+                                           withVolume.begin(), withVolume.end(), orderByPtr ) );
+            numCastersCameraOnly += cameraOnly.size();
+            numCastersWithVolume += withVolume.size();
+        }
+    }
+
+    //With a low sun the shadow cameras see a lot more than what casts onto the receivers
+    CPPUNIT_ASSERT( numCastersWithVolume > 0u );
+    CPPUNIT_ASSERT( numCastersWithVolume < numCastersCameraOnly );
+}
+//--------------------------------------------------------------------------
+void ShadowCasterCullTests::testVolumeMatchesScalarTest()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createScene( 1u );
+
+    ShadowCasterVolume volume;
+    MovableObject::MovableObjectArray cameraOnly;
+    MovableObject::MovableObjectArray withVolume;
+
+    for( size_t frame=0; frame<c_numFrames; ++frame )
+    {
+        for( size_t i=0; i<c_numSplits; ++i )
+        {
+            cullSplit( frame, i, volume, cameraOnly, withVolume );
+
+            size_t numScalarVisible = 0;
+            MovableObject::MovableObjectArray::const_iterator itor = cameraOnly.begin();
+            MovableObject::MovableObjectArray::const_iterator end  = cameraOnly.end();
+            while( itor != end )
+            {
+                if( volume.isVisible( (*itor)->getWorldAabb() ) )
+                    ++numScalarVisible;
+                ++itor;
+            }
+            CPPUNIT_ASSERT_EQUAL( withVolume.size(), numScalarVisible );
+        }
+    }
+}
+//--------------------------------------------------------------------------
+void ShadowCasterCullTests::testThreadedCastersBox()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createScene( 4u );
+
+    const uint32 castersBoxMask = (mViewport->getVisibilityMask() &
+                                   mSceneManager->getVisibilityMask()) |
+                                  (mViewport->getVisibilityMask() &
+                                   ~VisibilityFlags::RESERVED_VISIBILITY_FLAGS);
+
+    ObjectMemoryManager &memoryManager = mSceneManager->_getEntityMemoryManager( SCENE_DYNAMIC );
+    ObjectData objData;
+    const size_t numObjs = memoryManager.getFirstObjectData( objData, mRenderQueue );
+    AxisAlignedBox expectedBox;
+    MovableObject::calculateCastersBox( numObjs, objData, castersBoxMask, &expectedBox );
+
+    const AxisAlignedBox castersBox = mSceneManager->_calculateCurrentCastersBox(
+                mViewport->getVisibilityMask(), mRenderQueue,
+                static_cast<uint8>( mRenderQueue + 1u ) );
+
+    CPPUNIT_ASSERT( !expectedBox.isNull() );
+    CPPUNIT_ASSERT( castersBox == expectedBox );
+}
+//--------------------------------------------------------------------------
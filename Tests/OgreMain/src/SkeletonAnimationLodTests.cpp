@@ -0,0 +1,256 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "SkeletonAnimationLodTests.h"
+#include "NullRenderSystemHelper.h"
+
+#include "Animation/OgreSkeletonDef.h"
+#include "Animation/OgreSkeletonInstance.h"
+#include "OgreOldSkeletonManager.h"
+#include "OgreSkeleton.h"
+#include "OgreOldBone.h"
+#include "OgreAnimation.h"
+#include "OgreAnimationTrack.h"
+#include "OgreKeyFrame.h"
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgreCamera.h"
+#include "OgreItem.h"
+#include "OgreMesh2.h"
+
+#include "UnitTestSuite.h"
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(SkeletonAnimationLodTests);
+
+//--------------------------------------------------------------------------
+void SkeletonAnimationLodTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mHelper = new NullRenderSystemHelper();
+    mSceneManager = 0;
+    mCamera = 0;
+}
+//--------------------------------------------------------------------------
+void SkeletonAnimationLodTests::tearDown()
+{
+    for( size_t i=0; i<mInstances.size(); ++i )
+        mSceneManager->destroySkeletonInstance( mInstances[i] );
+    mInstances.clear();
+    mSkeletonDef.setNull();
+
+    if( !mSkeleton.isNull() )
+    {
+        v1::OldSkeletonManager::getSingleton().remove( mSkeleton->getHandle() );
+        mSkeleton.setNull();
+    }
+
+    delete mHelper;
+    mHelper = 0;
+    mSceneManager = 0;
+    mCamera = 0;
+}
+//--------------------------------------------------------------------------
+void SkeletonAnimationLodTests::createScene(void)
+{
+    mSceneManager = mHelper->createSceneManager();
+
+    mCamera = mSceneManager->createCamera( "SkeletonAnimationLodTests" );
+    mCamera->setPosition( Vector3::ZERO );
+    mCamera->lookAt( Vector3( 0, 0, -1 ) );
+    mCamera->setNearClipDistance( 0.1f );
+    mCamera->setFarClipDistance( 1000.0f );
+    mHelper->addBasicWorkspace( mCamera );
+
+    mHelper->createCubeMesh( "SkeletonAnimationLodTests/Cube" );
+
+    mSkeleton = v1::OldSkeletonManager::getSingleton().create(
+                "SkeletonAnimationLodTests", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME );
+    v1::OldBone *root = mSkeleton->createBone( "Root", 0 );
+    v1::OldBone *child = mSkeleton->createBone( "Child", 1 );
+    root->addChild( child );
+    child->setPosition( 0, 1, 0 );
+    mSkeleton->setBindingPose();
+
+    v1::Animation *animation = mSkeleton->createAnimation( "Animation", 1.0f );
+    v1::OldNodeAnimationTrack *track = animation->createOldNodeTrack( 1, child );
+    track->createNodeKeyFrame( 0.0f );
+    track->createNodeKeyFrame( 1.0f )->setTranslate( Vector3( 1, 0, 0 ) );
+
+    mSkeletonDef = SkeletonDefPtr( new SkeletonDef( mSkeleton.get(), 1.0f ) );
+
+    //The default LodStrategy is distance based: lodValue = distance - radius
+    SkeletonDef::AnimationLodVec lodLevels;
+    lodLevels.push_back( SkeletonDef::AnimationLod( 50.0f, 4u, 1u ) );
+    lodLevels.push_back( SkeletonDef::AnimationLod( 20.0f, 2u, 100u ) );
+    mSkeletonDef->setAnimationLodLevels( lodLevels );
+}
+//--------------------------------------------------------------------------
+SkeletonInstance* SkeletonAnimationLodTests::addInstance( Real distance )
+{
+    Item *item = mSceneManager->createItem( "SkeletonAnimationLodTests/Cube" );
+    SceneNode *sceneNode = mSceneManager->getRootSceneNode()->createChildSceneNode();
+    sceneNode->setPosition( 0, 0, -distance );
+    sceneNode->attachObject( item );
+
+    SkeletonInstance *instance = mSceneManager->createSkeletonInstance( mSkeletonDef.get() );
+    instance->setParentNode( sceneNode );
+    instance->_setLodSource( item );
+    mInstances.push_back( instance );
+
+    return instance;
+}
+//--------------------------------------------------------------------------
+size_t SkeletonAnimationLodTests::countUpdates( SkeletonInstance *instance )
+{
+    size_t retVal = 0;
+    for( uint32 i=0; i<8u; ++i )
+        retVal += instance->_updateWithLod( i ) ? 1u : 0u;
+    return retVal;
+}
+//--------------------------------------------------------------------------
+void SkeletonAnimationLodTests::testLevelSelection()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createScene();
+
+    const SkeletonDef::AnimationLodVec &lodLevels = mSkeletonDef->getAnimationLodLevels();
+    CPPUNIT_ASSERT_EQUAL( (size_t)2u, lodLevels.size() );
+    CPPUNIT_ASSERT( mSkeletonDef->getAnimationLod( 10.0f ) == 0 );
+    CPPUNIT_ASSERT( mSkeletonDef->getAnimationLod( 20.0f ) == &lodLevels[0] );
+    CPPUNIT_ASSERT( mSkeletonDef->getAnimationLod( 49.0f ) == &lodLevels[0] );
+    CPPUNIT_ASSERT( mSkeletonDef->getAnimationLod( 50.0f ) == &lodLevels[1] );
+    CPPUNIT_ASSERT_EQUAL( (uint16)2u, lodLevels[0].updateInterval );
+    CPPUNIT_ASSERT_EQUAL( (uint16)4u, lodLevels[1].updateInterval );
+
+    SkeletonInstance *nearInstance  = addInstance( 10.0f );
+    SkeletonInstance *midInstance   = addInstance( 35.0f );
+    SkeletonInstance *farInstance   = addInstance( 100.0f );
+    SkeletonInstance *noSource      = addInstance( 100.0f );
+    noSource->_setLodSource( 0 );
+
+    //No LOD value yet: everything at full quality
+    CPPUNIT_ASSERT_EQUAL( (size_t)8u, countUpdates( farInstance ) );
+
+    mHelper->getRoot()->renderOneFrame();
+
+    CPPUNIT_ASSERT( farInstance->_getLodValue() > 90.0f );
+    CPPUNIT_ASSERT_EQUAL( (size_t)8u, countUpdates( nearInstance ) );
+    CPPUNIT_ASSERT_EQUAL( (size_t)4u, countUpdates( midInstance ) );
+    CPPUNIT_ASSERT_EQUAL( (size_t)2u, countUpdates( farInstance ) );
+    CPPUNIT_ASSERT_EQUAL( (size_t)8u, countUpdates( noSource ) );
+
+    //Only the root gets animated by farInstance; the child keeps its last pose
+    Bone *child = farInstance->getBone( "Child" );
+    const Vector3 childPos = child->getPosition();
+    SkeletonAnimation *animation = farInstance->getAnimation( "Animation" );
+    animation->setEnabled( true );
+    animation->setTime( 0.5f );
+    for( uint32 i=0; i<4u; ++i )
+        farInstance->_updateWithLod( i );
+    CPPUNIT_ASSERT( child->getPosition() == childPos );
+
+    midInstance->getAnimation( "Animation" )->setEnabled( true );
+    midInstance->getAnimation( "Animation" )->setTime( 0.5f );
+    for( uint32 i=0; i<2u; ++i )
+        midInstance->_updateWithLod( i );
+    CPPUNIT_ASSERT( midInstance->getBone( "Child" )->getPosition() != childPos );
+}
+//--------------------------------------------------------------------------
+void SkeletonAnimationLodTests::testPhaseStaggering()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createScene();
+
+    for( size_t i=0; i<4u; ++i )
+        addInstance( 100.0f + i );
+
+    mHelper->getRoot()->renderOneFrame();
+
+    for( uint32 frame=0; frame<8u; ++frame )
+    {
+        size_t numUpdated = 0;
+        for( size_t i=0; i<mInstances.size(); ++i )
+            numUpdated += mInstances[i]->_updateWithLod( frame ) ? 1u : 0u;
+        CPPUNIT_ASSERT_EQUAL( (size_t)1u, numUpdated );
+    }
+}
+//--------------------------------------------------------------------------
+void SkeletonAnimationLodTests::testLaterLodUpdatesIgnored()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createScene();
+    SkeletonInstance *nearInstance = addInstance( 10.0f );
+
+    mHelper->getRoot()->renderOneFrame();
+    const Real lodValue = nearInstance->_getLodValue();
+    CPPUNIT_ASSERT( lodValue < 20.0f );
+
+    //i.e. a reflection or a shadow pass with its own LOD camera, far away
+    Camera *otherCamera = mSceneManager->createCamera( "SkeletonAnimationLodTests/Other" );
+    otherCamera->setPosition( 0, 0, 200.0f );
+    otherCamera->lookAt( Vector3( 0, 0, -1 ) );
+    mSceneManager->updateAllLods( otherCamera, 1.0f, 0u, 255u );
+
+    CPPUNIT_ASSERT( nearInstance->_getLodSource()->getCurrentLodValue() > 50.0f );
+    CPPUNIT_ASSERT_EQUAL( lodValue, nearInstance->_getLodValue() );
+    CPPUNIT_ASSERT_EQUAL( (size_t)8u, countUpdates( nearInstance ) );
+
+    //Same in the next frame
+    mHelper->getRoot()->renderOneFrame();
+    mSceneManager->updateAllLods( otherCamera, 1.0f, 0u, 255u );
+    CPPUNIT_ASSERT_EQUAL( lodValue, nearInstance->_getLodValue() );
+}
+//--------------------------------------------------------------------------
+void SkeletonAnimationLodTests::testAnimationLodCamera()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createScene();
+    SkeletonInstance *nearInstance = addInstance( 10.0f );
+
+    Camera *otherCamera = mSceneManager->createCamera( "SkeletonAnimationLodTests/Other" );
+    otherCamera->setPosition( 0, 0, 200.0f );
+    otherCamera->lookAt( Vector3( 0, 0, -1 ) );
+    mSceneManager->setAnimationLodCamera( otherCamera );
+
+    //The main camera's pass doesn't count anymore
+    mHelper->getRoot()->renderOneFrame();
+    CPPUNIT_ASSERT( nearInstance->_getLodValue() < 0.0f );
+
+    mSceneManager->updateAllLods( otherCamera, 1.0f, 0u, 255u );
+    CPPUNIT_ASSERT( nearInstance->_getLodValue() > 50.0f );
+    CPPUNIT_ASSERT_EQUAL( (size_t)2u, countUpdates( nearInstance ) );
+
+    mSceneManager->setAnimationLodCamera( 0 );
+}
@@ -0,0 +1,253 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "SkeletonCompressionTests.h"
+#include "NullRenderSystemHelper.h"
+
+#include "Animation/OgreSkeletonDef.h"
+#include "Animation/OgreSkeletonAnimationDef.h"
+#include "Animation/OgreSkeletonTrack.h"
+#include "OgreOldSkeletonManager.h"
+#include "OgreSkeleton.h"
+#include "OgreOldBone.h"
+#include "OgreAnimation.h"
+#include "OgreAnimationTrack.h"
+#include "OgreKeyFrame.h"
+#include "OgreMath.h"
+
+#include "UnitTestSuite.h"
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(SkeletonCompressionTests);
+
+namespace
+{
+    /// Of the v1 keyframes.
+    const Real c_frameRate = 30.0f;
+    /// SkeletonManager always imports v1 skeletons with 1. Other values
+    /// sample the v1 tracks at the wrong time.
+    const Real c_defFrameRate = 1.0f;
+    const size_t c_numKeyFrames = 121u;
+
+    struct SampledTransform
+    {
+        Vector3     position;
+        Quaternion  orientation;
+        Vector3     scale;
+    };
+    typedef vector<SampledTransform>::type SampledTransformVec;
+
+    /// Samples every slot of every track at the given frames.
+    void sampleTracks( const SkeletonAnimationDef &animationDef, const vector<Real>::type &frames,
+                       SampledTransformVec &outTransforms )
+    {
+        outTransforms.clear();
+
+        const SkeletonTrackVec &tracks = animationDef.getTracks();
+        for( size_t i=0; i<tracks.size(); ++i )
+        {
+            for( size_t j=0; j<frames.size(); ++j )
+            {
+                KfTransform transform;
+                tracks[i]._getInterpolatedTransform( frames[j], transform );
+
+                for( size_t k=0; k<tracks[i].getUsedSlots(); ++k )
+                {
+                    SampledTransform sampled;
+                    transform.mPosition.getAsVector3( sampled.position, k );
+                    transform.mOrientation.getAsQuaternion( sampled.orientation, k );
+                    transform.mScale.getAsVector3( sampled.scale, k );
+                    sampled.orientation.normalise();
+                    outTransforms.push_back( sampled );
+                }
+            }
+        }
+    }
+
+    Real maxComponentDiff( const Vector3 &a, const Vector3 &b )
+    {
+        const Vector3 diff = a - b;
+        return std::max( std::max( Math::Abs( diff.x ), Math::Abs( diff.y ) ), Math::Abs( diff.z ) );
+    }
+
+    Real maxComponentDiff( const Quaternion &a, Quaternion b )
+    {
+        if( a.Dot( b ) < 0 )
+            b = -b;
+        const Quaternion diff = a - b;
+        return std::max( std::max( Math::Abs( diff.w ), Math::Abs( diff.x ) ),
+                         std::max( Math::Abs( diff.y ), Math::Abs( diff.z ) ) );
+    }
+}
+
+//--------------------------------------------------------------------------
+void SkeletonCompressionTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mHelper = new NullRenderSystemHelper();
+    createSkeleton();
+}
+//--------------------------------------------------------------------------
+void SkeletonCompressionTests::tearDown()
+{
+    v1::OldSkeletonManager::getSingleton().remove( mSkeleton->getHandle() );
+    mSkeleton.setNull();
+
+    delete mHelper;
+    mHelper = 0;
+}
+//--------------------------------------------------------------------------
+void SkeletonCompressionTests::createSkeleton(void)
+{
+    mSkeleton = v1::OldSkeletonManager::getSingleton().create(
+                "SkeletonCompressionTests", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME );
+
+    v1::OldBone *root = mSkeleton->createBone( "Root", 0 );
+    v1::OldBone *child = mSkeleton->createBone( "Child", 1 );
+    root->addChild( child );
+    child->setPosition( 0, 1, 0 );
+    mSkeleton->setBindingPose();
+
+    const Real length = (c_numKeyFrames - 1u) / c_frameRate;
+    v1::Animation *animation = mSkeleton->createAnimation( "Animation", length );
+
+    v1::OldNodeAnimationTrack *rootTrack = animation->createOldNodeTrack( 0, root );
+    v1::OldNodeAnimationTrack *childTrack = animation->createOldNodeTrack( 1, child );
+
+    for( size_t i=0; i<c_numKeyFrames; ++i )
+    {
+        const Real time = i / c_frameRate;
+
+        v1::TransformKeyFrame *keyFrame = rootTrack->createNodeKeyFrame( time );
+        keyFrame->setTranslate( Vector3( 2.0f * time, 0.5f, -time ) );
+        keyFrame->setRotation( Quaternion( Degree( 30 ), Vector3::UNIT_X ) );
+
+        keyFrame = childTrack->createNodeKeyFrame( time );
+        keyFrame->setTranslate( Vector3( 0.0f, Math::Sin( Radian( 0.5f * time ) ), 0.0f ) );
+        keyFrame->setRotation( Quaternion( Radian( 0.5f * time ), Vector3::UNIT_Y ) );
+    }
+}
+//--------------------------------------------------------------------------
+void SkeletonCompressionTests::testRoundTrip()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    SkeletonDef skeletonDef( mSkeleton.get(), c_defFrameRate );
+    CPPUNIT_ASSERT_EQUAL( (size_t)1u, skeletonDef.getAnimationDefs().size() );
+    const SkeletonAnimationDef &animationDef = skeletonDef.getAnimationDefs()[0];
+
+    //Both bones are in different blocks (different depth), thus one track each
+    vector<Real>::type frames;
+    const SkeletonTrackVec &tracks = animationDef.getTracks();
+    for( size_t i=0; i<tracks[0].getKeyFrames().size(); ++i )
+        frames.push_back( tracks[0].getKeyFrames()[i].mFrame );
+
+    SampledTransformVec original;
+    sampleTracks( animationDef, frames, original );
+
+    KfCompressionSettings settings;
+    settings.positionTolerance      = 1e-3f;
+    settings.orientationTolerance   = 1e-3f;
+    settings.scaleTolerance         = 1e-3f;
+    settings.measure = true;
+    const KfCompressionReport report = skeletonDef.compressAnimations( settings );
+
+    CPPUNIT_ASSERT( animationDef.isCompressed() );
+
+    //The root's keyframes are all on a line; the child's are not.
+    CPPUNIT_ASSERT_EQUAL( c_numKeyFrames * tracks.size(), report.numKeyFramesBefore );
+    CPPUNIT_ASSERT_EQUAL( (size_t)2u, tracks[0].getKeyFrames().size() );
+    CPPUNIT_ASSERT( tracks[1].getKeyFrames().size() > 2u );
+    CPPUNIT_ASSERT( tracks[1].getKeyFrames().size() < c_numKeyFrames / 2u );
+    CPPUNIT_ASSERT_EQUAL( tracks[0].getKeyFrames().size() + tracks[1].getKeyFrames().size(),
+                          report.numKeyFramesAfter );
+    CPPUNIT_ASSERT( report.compressedBytes < report.uncompressedBytes );
+
+    //Root orientation & scale and the child's scale never change
+    CPPUNIT_ASSERT_EQUAL( 3u * tracks.size(), report.numChannels );
+    CPPUNIT_ASSERT( report.numConstantChannels >= 3u );
+
+    SampledTransformVec decoded;
+    sampleTracks( animationDef, frames, decoded );
+    CPPUNIT_ASSERT_EQUAL( original.size(), decoded.size() );
+
+    //Quantization adds a little on top of the keyframe removal tolerance
+    const Real slack = 1e-4f;
+    Real maxPositionError = 0, maxOrientationError = 0, maxScaleError = 0;
+    for( size_t i=0; i<original.size(); ++i )
+    {
+        maxPositionError = std::max( maxPositionError,
+                                     maxComponentDiff( original[i].position,
+                                                       decoded[i].position ) );
+        maxOrientationError = std::max( maxOrientationError,
+                                        maxComponentDiff( original[i].orientation,
+                                                          decoded[i].orientation ) );
+        maxScaleError = std::max( maxScaleError,
+                                  maxComponentDiff( original[i].scale, decoded[i].scale ) );
+    }
+
+    CPPUNIT_ASSERT( maxPositionError <= settings.positionTolerance + slack );
+    CPPUNIT_ASSERT( maxOrientationError <= settings.orientationTolerance + slack );
+    CPPUNIT_ASSERT( maxScaleError <= settings.scaleTolerance + slack );
+
+    //The report measures the same thing
+    CPPUNIT_ASSERT_DOUBLES_EQUAL( maxPositionError, report.maxPositionError, 1e-5f );
+    CPPUNIT_ASSERT_DOUBLES_EQUAL( maxOrientationError, report.maxOrientationError, 1e-5f );
+    CPPUNIT_ASSERT_DOUBLES_EQUAL( maxScaleError, report.maxScaleError, 1e-5f );
+}
+//--------------------------------------------------------------------------
+void SkeletonCompressionTests::testReportOptIn()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    SkeletonDef measuredDef( mSkeleton.get(), c_defFrameRate );
+    SkeletonDef unmeasuredDef( mSkeleton.get(), c_defFrameRate );
+
+    KfCompressionSettings settings;
+    settings.positionTolerance = 1e-3f;
+    CPPUNIT_ASSERT( !settings.measure );
+
+    const KfCompressionReport report = unmeasuredDef.compressAnimations( settings );
+    settings.measure = true;
+    const KfCompressionReport measuredReport = measuredDef.compressAnimations( settings );
+
+    CPPUNIT_ASSERT_EQUAL( (Real)0, report.maxPositionError );
+    CPPUNIT_ASSERT_EQUAL( (Real)0, report.maxOrientationError );
+    CPPUNIT_ASSERT_EQUAL( (Real)0, report.maxScaleError );
+    CPPUNIT_ASSERT_EQUAL( (uint64)0u, report.uncompressedSampleTimeUs );
+    CPPUNIT_ASSERT_EQUAL( (uint64)0u, report.compressedSampleTimeUs );
+    CPPUNIT_ASSERT( measuredReport.maxPositionError > 0 );
+
+    CPPUNIT_ASSERT_EQUAL( measuredReport.numKeyFramesBefore, report.numKeyFramesBefore );
+    CPPUNIT_ASSERT_EQUAL( measuredReport.numKeyFramesAfter, report.numKeyFramesAfter );
+    CPPUNIT_ASSERT_EQUAL( measuredReport.uncompressedBytes, report.uncompressedBytes );
+    CPPUNIT_ASSERT_EQUAL( measuredReport.compressedBytes, report.compressedBytes );
+    CPPUNIT_ASSERT_EQUAL( measuredReport.numConstantChannels, report.numConstantChannels );
+}
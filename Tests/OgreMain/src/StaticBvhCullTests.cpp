@@ -0,0 +1,195 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "StaticBvhCullTests.h"
+#include "NullRenderSystemHelper.h"
+
+#include "OgreRoot.h"
+#include "OgreViewport.h"
+#include "OgreCamera.h"
+#include "OgreSceneManager.h"
+#include "OgreItem.h"
+#include "OgreMesh2.h"
+#include "OgreStaticObjectBvh.h"
+#include "Math/Array/OgreObjectMemoryManager.h"
+
+#include "UnitTestSuite.h"
+
+#include <algorithm>
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(StaticBvhCullTests);
+
+namespace
+{
+    const size_t c_numItems = 20000u;
+    const Real c_worldSize = 2000.0f;
+    const size_t c_numOrientations = 8u;
+    const uint32 c_visibilityMask = VisibilityFlags::RESERVED_VISIBILITY_FLAGS |
+                                    VisibilityFlags::LAYER_VISIBILITY;
+
+    bool orderByPtr( const MovableObject *l, const MovableObject *r )
+    {
+        return l < r;
+    }
+}
+//--------------------------------------------------------------------------
+void StaticBvhCullTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mHelper = 0;
+    mSceneManager = 0;
+    mCamera = 0;
+    mViewport = 0;
+    mNumThreads = 1u;
+    mRenderQueue = 0;
+}
+//--------------------------------------------------------------------------
+void StaticBvhCullTests::tearDown()
+{
+    mSceneNodes.clear();
+    delete mHelper;
+    mHelper = 0;
+    mSceneManager = 0;
+}
+//--------------------------------------------------------------------------
+void StaticBvhCullTests::createScene( size_t numThreads )
+{
+    mHelper = new NullRenderSystemHelper();
+    mNumThreads = numThreads;
+    mSceneManager = mHelper->createSceneManager( numThreads );
+    MeshPtr mesh = mHelper->createCubeMesh( "StaticBvhCullTestsCube" );
+
+    //Scatter static objects randomly
+    SceneNode *rootNode = mSceneManager->getRootSceneNode( SCENE_STATIC );
+    for( size_t i=0; i<c_numItems; ++i )
+    {
+        Item *item = mSceneManager->createItem( mesh, SCENE_STATIC );
+        SceneNode *sceneNode = rootNode->createChildSceneNode( SCENE_STATIC );
+        sceneNode->setPosition( Math::RangeRandom( -c_worldSize, c_worldSize ) * 0.5f,
+                                Math::RangeRandom( 0.0f, 10.0f ),
+                                Math::RangeRandom( -c_worldSize, c_worldSize ) * 0.5f );
+        sceneNode->attachObject( item );
+        mSceneNodes.push_back( sceneNode );
+        mRenderQueue = item->getRenderQueueGroup();
+    }
+
+    mCamera = mHelper->createCamera( "OpenWorldCamera", c_visibilityMask );
+    mCamera->setPosition( 0, 5.0f, 0 );
+    mCamera->setNearClipDistance( 0.5f );
+    mCamera->setFarClipDistance( 600.0f );
+    mCamera->setAutoAspectRatio( true );
+    mViewport = mCamera->getLastViewport();
+
+    mSceneManager->setStaticBvhCulling( true );
+    mSceneManager->updateSceneGraph();
+}
+//--------------------------------------------------------------------------
+void StaticBvhCullTests::checkBvhMatchesLinearSweep(void)
+{
+    StaticObjectBvh *bvh = mSceneManager->getStaticObjectBvh();
+    CPPUNIT_ASSERT( bvh );
+    CPPUNIT_ASSERT( bvh->getNumNodes() > 1u );
+
+    ObjectMemoryManager &staticMemoryManager =
+            mSceneManager->_getEntityMemoryManager( SCENE_STATIC );
+
+    size_t numVisible = 0;
+    for( size_t i=0; i<c_numOrientations; ++i )
+    {
+        mCamera->setOrientation( Quaternion( Radian( Math::TWO_PI * (Real)i / c_numOrientations ),
+                                             Vector3::UNIT_Y ) );
+        mCamera->getFrustumPlanes();
+
+        MovableObject::MovableObjectArray linearResult;
+        ObjectData objData;
+        const size_t numObjs = staticMemoryManager.getFirstObjectData( objData, mRenderQueue );
+        MovableObject::cullFrustum( numObjs, objData, mCamera, c_visibilityMask,
+                                    linearResult, mCamera );
+
+        //Every thread walks its own part of the tree
+        MovableObject::MovableObjectArray bvhResult;
+        for( size_t j=0; j<mNumThreads; ++j )
+            bvh->cullFrustum( mRenderQueue, mCamera, c_visibilityMask, bvhResult, mCamera, j );
+
+        std::sort( linearResult.begin(), linearResult.end(), orderByPtr );
+        std::sort( bvhResult.begin(), bvhResult.end(), orderByPtr );
+        CPPUNIT_ASSERT_EQUAL( linearResult.size(), bvhResult.size() );
+        CPPUNIT_ASSERT( std::equal( linearResult.begin(), linearResult.end(),
+                                    bvhResult.begin() ) );
+        numVisible += linearResult.size();
+    }
+
+    //Only a fraction of the objects is in view
+    CPPUNIT_ASSERT( numVisible > 0u );
+    CPPUNIT_ASSERT( numVisible < c_numItems * c_numOrientations / 2u );
+}
+//--------------------------------------------------------------------------
+void StaticBvhCullTests::testBvhMatchesLinearSweep()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createScene( 1u );
+
+    checkBvhMatchesLinearSweep();
+}
+//--------------------------------------------------------------------------
+void StaticBvhCullTests::testBvhMatchesLinearSweepThreaded()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createScene( 4u );
+
+    checkBvhMatchesLinearSweep();
+}
+//--------------------------------------------------------------------------
+void StaticBvhCullTests::testMovedObjectsAreRefit()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createScene( 1u );
+
+    StaticObjectBvh *bvh = mSceneManager->getStaticObjectBvh();
+    const size_t numRebuildsBefore = bvh->getNumRebuilds();
+
+    //Move 1% of the objects; the tree gets refit instead of rebuilt.
+    for( size_t i=0; i<c_numItems; i += 100u )
+    {
+        mSceneNodes[i]->translate( Math::RangeRandom( -50.0f, 50.0f ), 0,
+                                   Math::RangeRandom( -50.0f, 50.0f ) );
+        mSceneManager->notifyStaticDirty( mSceneNodes[i] );
+    }
+    mSceneManager->updateSceneGraph();
+
+    CPPUNIT_ASSERT_EQUAL( numRebuildsBefore, bvh->getNumRebuilds() );
+    checkBvhMatchesLinearSweep();
+}
+//--------------------------------------------------------------------------
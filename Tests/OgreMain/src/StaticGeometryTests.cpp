@@ -0,0 +1,299 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "StaticGeometryTests.h"
+#include "NullRenderSystemHelper.h"
+
+#include "OgreSceneManager.h"
+#include "OgreItem.h"
+#include "OgreMeshManager2.h"
+#include "OgreSubMesh2.h"
+#include "OgreDataStream.h"
+#include "Vao/OgreVaoManager.h"
+#include "Vao/OgreVertexArrayObject.h"
+#include "Vao/OgreAsyncTicket.h"
+
+#include "UnitTestSuite.h"
+
+#include <fstream>
+#include <cstdio>
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(StaticGeometryTests);
+
+namespace
+{
+    const size_t c_numItems = 2000u;
+    const Real c_regionSize = 100.0f;
+    const Real c_spacing = 4.0f;
+    const size_t c_itemsPerRow = 100u;
+    const uint16 c_indices[36] =
+    {
+        0, 2, 1, 2, 0, 3,   4, 5, 6, 6, 7, 4,   0, 1, 5, 5, 4, 0,
+        3, 6, 2, 6, 3, 7,   1, 2, 6, 6, 5, 1,   0, 4, 7, 7, 3, 0
+    };
+
+    Vector3 getItemPosition( size_t idx )
+    {
+        //Keep the props away from the region borders
+        return Vector3( (idx % c_itemsPerRow) * c_spacing + c_spacing * 0.5f, 0.0f,
+                        (idx / c_itemsPerRow) * c_spacing + c_spacing * 0.5f );
+    }
+
+    std::vector<char> download( BufferPacked *buffer )
+    {
+        std::vector<char> retVal( buffer->getNumElements() * buffer->getBytesPerElement() );
+        AsyncTicketPtr ticket = buffer->readRequest( 0, buffer->getNumElements() );
+        memcpy( &retVal[0], ticket->map(), retVal.size() );
+        ticket->unmap();
+        return retVal;
+    }
+}
+//--------------------------------------------------------------------------
+void StaticGeometryTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mHelper = 0;
+    mSceneManager = 0;
+    mPropsNode = 0;
+}
+//--------------------------------------------------------------------------
+void StaticGeometryTests::tearDown()
+{
+    mMesh.setNull();
+    mPropsNode = 0;
+    delete mHelper;
+    mHelper = 0;
+    mSceneManager = 0;
+}
+//--------------------------------------------------------------------------
+void StaticGeometryTests::createLodCubeMesh(void)
+{
+    VaoManager *vaoManager = mHelper->getVaoManager();
+
+    mMesh = MeshManager::getSingleton().createManual(
+                "StaticGeometryTestsCube", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME );
+    SubMesh *subMesh = mMesh->createSubMesh();
+
+    VertexElement2Vec vertexElements;
+    vertexElements.push_back( VertexElement2( VET_FLOAT3, VES_POSITION ) );
+    vertexElements.push_back( VertexElement2( VET_FLOAT3, VES_NORMAL ) );
+
+    float vertices[8 * 6];
+    for( size_t i=0; i<8u; ++i )
+    {
+        const Vector3 pos( (i == 1 || i == 2 || i == 5 || i == 6) ? 1.0f : -1.0f,
+                           (i == 2 || i == 3 || i == 6 || i == 7) ? 1.0f : -1.0f,
+                           i >= 4u ? 1.0f : -1.0f );
+        const Vector3 normal = pos.normalisedCopy();
+        vertices[i * 6u + 0u] = pos.x;
+        vertices[i * 6u + 1u] = pos.y;
+        vertices[i * 6u + 2u] = pos.z;
+        vertices[i * 6u + 3u] = normal.x;
+        vertices[i * 6u + 4u] = normal.y;
+        vertices[i * 6u + 5u] = normal.z;
+    }
+
+    VertexBufferPacked *vertexBuffer = vaoManager->createVertexBuffer(
+                vertexElements, 8, BT_IMMUTABLE, vertices, false );
+    VertexBufferPackedVec vertexBuffers;
+    vertexBuffers.push_back( vertexBuffer );
+
+    const uint32 numIndices[2] = { 36u, 12u };
+    for( size_t i=0; i<2u; ++i )
+    {
+        IndexBufferPacked *indexBuffer = vaoManager->createIndexBuffer(
+                    IndexBufferPacked::IT_16BIT, numIndices[i], BT_IMMUTABLE,
+                    const_cast<uint16*>( c_indices ), false );
+        VertexArrayObject *vao = vaoManager->createVertexArrayObject( vertexBuffers,
+                                                                      indexBuffer,
+                                                                      OT_TRIANGLE_LIST );
+        subMesh->mVao[VpNormal].push_back( vao );
+        subMesh->mVao[VpShadow].push_back( vao );
+    }
+
+    Mesh::LodValueArray lodValues;
+    lodValues.push_back( 0.0f );
+    lodValues.push_back( 50.0f );
+
+    mMesh->_setBounds( Aabb( Vector3::ZERO, Vector3::UNIT_SCALE ), false );
+    mMesh->_setBoundingSphereRadius( 1.732f );
+    mMesh->_setLodValues( lodValues );
+}
+//--------------------------------------------------------------------------
+void StaticGeometryTests::createScene(void)
+{
+    mHelper = new NullRenderSystemHelper();
+
+    //The merge runs on the worker threads
+    mSceneManager = mHelper->createSceneManager( 2u );
+    createLodCubeMesh();
+
+    //A field of props, the way a level would place them
+    mPropsNode = mSceneManager->getRootSceneNode( SCENE_STATIC )->
+            createChildSceneNode( SCENE_STATIC );
+    for( size_t i=0; i<c_numItems; ++i )
+    {
+        Item *item = mSceneManager->createItem( mMesh, SCENE_STATIC );
+        SceneNode *sceneNode = mPropsNode->createChildSceneNode( SCENE_STATIC,
+                                                                 getItemPosition( i ) );
+        sceneNode->attachObject( item );
+    }
+}
+//--------------------------------------------------------------------------
+void StaticGeometryTests::checkRegions( const StaticGeometry &staticGeometry )
+{
+    map<std::pair<int, int>, size_t>::type expectedItems;
+    for( size_t i=0; i<c_numItems; ++i )
+    {
+        const Vector3 pos = getItemPosition( i );
+        ++expectedItems[std::make_pair( static_cast<int>( pos.x / c_regionSize ),
+                                        static_cast<int>( pos.z / c_regionSize ) )];
+    }
+
+    const StaticGeometry::RegionVec &regions = staticGeometry.getRegions();
+    CPPUNIT_ASSERT_EQUAL( expectedItems.size(), regions.size() );
+
+    StaticGeometry::RegionVec::const_iterator itor = regions.begin();
+    StaticGeometry::RegionVec::const_iterator end  = regions.end();
+    while( itor != end )
+    {
+        const StaticGeometry::Region *region = *itor;
+        const size_t expected = expectedItems[std::make_pair( region->x, region->z )];
+
+        //One mesh per region, with both LODs
+        const MeshPtr &mesh = region->mesh;
+        CPPUNIT_ASSERT( !mesh.isNull() );
+        CPPUNIT_ASSERT( region->item );
+        CPPUNIT_ASSERT_EQUAL( (unsigned short)1u, mesh->getNumSubMeshes() );
+        CPPUNIT_ASSERT_EQUAL( (size_t)2u, mesh->_getLodValueArray()->size() );
+        CPPUNIT_ASSERT_EQUAL( 50.0f, (*mesh->_getLodValueArray())[1] );
+
+        const VertexArrayObjectArray &vaos = mesh->getSubMesh( 0 )->mVao[VpNormal];
+        CPPUNIT_ASSERT_EQUAL( (size_t)2u, vaos.size() );
+        CPPUNIT_ASSERT_EQUAL( expected * 8u,
+                              (size_t)vaos[0]->getVertexBuffers()[0]->getNumElements() );
+        CPPUNIT_ASSERT_EQUAL( expected * 36u, (size_t)vaos[0]->getPrimitiveCount() );
+        CPPUNIT_ASSERT_EQUAL( expected * 12u, (size_t)vaos[1]->getPrimitiveCount() );
+        //The LODs keep sharing the vertex buffer
+        CPPUNIT_ASSERT( vaos[1]->getVertexBuffers() == vaos[0]->getVertexBuffers() );
+
+        CPPUNIT_ASSERT_DOUBLES_EQUAL( 2.0f, region->aabb.getSize().y, 1e-4f );
+        CPPUNIT_ASSERT( region->aabb.getSize().x <= c_regionSize );
+
+        ++itor;
+    }
+}
+//--------------------------------------------------------------------------
+void StaticGeometryTests::testBuildMergesRegions()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createScene();
+
+    StaticGeometry staticGeometry( "Props", mSceneManager );
+    staticGeometry.setRegionDimensions( Vector3( c_regionSize ) );
+    staticGeometry.addSceneNode( mPropsNode );
+    staticGeometry.build();
+
+    CPPUNIT_ASSERT_EQUAL( c_numItems, staticGeometry.getNumQueuedSubMeshes() );
+    checkRegions( staticGeometry );
+    staticGeometry.reset();
+}
+//--------------------------------------------------------------------------
+void StaticGeometryTests::testMirroredProp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createScene();
+
+    StaticGeometry staticGeometry( "Mirrored", mSceneManager );
+    staticGeometry.addMesh( mMesh, Vector3::ZERO, Quaternion::IDENTITY,
+                            Vector3( -1.0f, 1.0f, 1.0f ) );
+    staticGeometry.build();
+
+    CPPUNIT_ASSERT_EQUAL( (size_t)1u, staticGeometry.getRegions().size() );
+
+    const StaticGeometry::Region *region = staticGeometry.getRegions()[0];
+    const VertexArrayObject *vao = region->mesh->getSubMesh( 0 )->mVao[VpNormal][0];
+
+    const std::vector<char> vertexData = download( vao->getVertexBuffers()[0] );
+    const std::vector<char> indexData = download( vao->getIndexBuffer() );
+    const float *vertices = reinterpret_cast<const float*>( &vertexData[0] );
+    const uint16 *indices = reinterpret_cast<const uint16*>( &indexData[0] );
+
+    //Vertex 1 is (1, -1, -1); relative to the region's centre.
+    const Vector3 pos( vertices[6], vertices[7], vertices[8] );
+    const Vector3 normal( vertices[9], vertices[10], vertices[11] );
+    CPPUNIT_ASSERT( pos.positionEquals( Vector3( -1.0f, -1.0f, -1.0f ) - region->centre, 1e-4f ) );
+    CPPUNIT_ASSERT( normal.positionEquals( Vector3( -1.0f, -1.0f, -1.0f ).normalisedCopy(),
+                                           1e-4f ) );
+
+    //Mirroring flips the winding
+    CPPUNIT_ASSERT_EQUAL( c_indices[0], indices[0] );
+    CPPUNIT_ASSERT_EQUAL( c_indices[2], indices[1] );
+    CPPUNIT_ASSERT_EQUAL( c_indices[1], indices[2] );
+
+    staticGeometry.reset();
+}
+//--------------------------------------------------------------------------
+void StaticGeometryTests::testSaveAndLoadRegions()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createScene();
+
+    const String filename = "StaticGeometryTests.regions";
+
+    StaticGeometry staticGeometry( "Props", mSceneManager );
+    staticGeometry.setRegionDimensions( Vector3( c_regionSize ) );
+    staticGeometry.addSceneNode( mPropsNode );
+    staticGeometry.build();
+    staticGeometry.saveRegions( filename );
+    staticGeometry.reset();
+
+    //The originals aren't needed to load the regions
+    mSceneManager->destroyAllItems();
+    mPropsNode->removeAndDestroyAllChildren();
+
+    StaticGeometry loadedGeometry( "Loaded", mSceneManager );
+    {
+        std::ifstream *ifs = OGRE_NEW_T( std::ifstream, MEMCATEGORY_GENERAL )(
+                    filename.c_str(), std::ios::binary | std::ios::in );
+        DataStreamPtr stream( OGRE_NEW FileStreamDataStream( filename, ifs, true ) );
+        loadedGeometry.loadRegions( stream );
+    }
+    std::remove( filename.c_str() );
+
+    checkRegions( loadedGeometry );
+    loadedGeometry.reset();
+}
+//--------------------------------------------------------------------------
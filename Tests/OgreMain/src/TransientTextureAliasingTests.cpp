@@ -0,0 +1,295 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "TransientTextureAliasingTests.h"
+#include "NullRenderSystemHelper.h"
+
+#include "OgreRoot.h"
+#include "OgreRenderWindow.h"
+#include "OgreSceneManager.h"
+#include "OgreCamera.h"
+#include "OgreStringConverter.h"
+#include "Compositor/OgreCompositorManager2.h"
+#include "Compositor/OgreCompositorNode.h"
+#include "Compositor/OgreCompositorNodeDef.h"
+#include "Compositor/OgreCompositorWorkspace.h"
+#include "Compositor/OgreCompositorWorkspaceDef.h"
+#include "Compositor/OgreCompositorTextureAliasing.h"
+#include "Compositor/Pass/PassClear/OgreCompositorPassClearDef.h"
+
+#include "UnitTestSuite.h"
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(TransientTextureAliasingTests);
+
+namespace
+{
+    const size_t c_chainLength = 8u;
+
+    CompositorTextureAliasing::Lifetime makeLifetime( uint32 firstUse, uint32 lastUse,
+                                                      uint32 compatibilityClass, bool canAlias )
+    {
+        CompositorTextureAliasing::Lifetime retVal;
+        retVal.firstUse             = firstUse;
+        retVal.lastUse              = lastUse;
+        retVal.compatibilityClass   = compatibilityClass;
+        retVal.sizeBytes            = 1024u;
+        retVal.canAlias             = canAlias;
+        return retVal;
+    }
+}
+//--------------------------------------------------------------------------
+void TransientTextureAliasingTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mHelper = 0;
+    mSceneManager = 0;
+    mWorkspace = 0;
+}
+//--------------------------------------------------------------------------
+void TransientTextureAliasingTests::tearDown()
+{
+    if( mWorkspace )
+    {
+        mHelper->getRoot()->getCompositorManager2()->removeWorkspace( mWorkspace );
+        mWorkspace = 0;
+    }
+    delete mHelper;
+    mHelper = 0;
+    mSceneManager = 0;
+}
+//--------------------------------------------------------------------------
+void TransientTextureAliasingTests::createChainWorkspaceDef(void)
+{
+    CompositorManager2 *compositorManager = mHelper->getRoot()->getCompositorManager2();
+
+    for( size_t i=0; i<c_chainLength; ++i )
+    {
+        CompositorNodeDef *nodeDef = compositorManager->addNodeDefinition(
+                    "AliasChain/Node" + StringConverter::toString( i ) );
+        if( i != 0 )
+            nodeDef->addTextureSourceName( "in", 0, TextureDefinitionBase::TEXTURE_INPUT );
+
+        TextureDefinitionBase::TextureDefinition *texDef = nodeDef->addTextureDefinition( "rt" );
+        texDef->widthFactor     = 0.5f;
+        texDef->heightFactor    = 0.5f;
+        texDef->formatList.push_back( PF_A8R8G8B8 );
+
+        nodeDef->setNumTargetPass( i == 0 ? 2u : 1u );
+        if( i == 0 )
+        {
+            //Only the depth buffer gets cleared; the colour is kept from the last frame.
+            texDef = nodeDef->addTextureDefinition( "history" );
+            texDef->widthFactor     = 0.5f;
+            texDef->heightFactor    = 0.5f;
+            texDef->formatList.push_back( PF_A8R8G8B8 );
+
+            CompositorTargetDef *targetDef = nodeDef->addTargetPass( "history" );
+            targetDef->setNumPasses( 1u );
+            CompositorPassClearDef *passClear = static_cast<CompositorPassClearDef*>(
+                                                    targetDef->addPass( PASS_CLEAR ) );
+            passClear->mClearBufferFlags = FBT_DEPTH;
+        }
+
+        CompositorTargetDef *targetDef = nodeDef->addTargetPass( "rt" );
+        targetDef->setNumPasses( 1u );
+        CompositorPassDef *passDef = targetDef->addPass( PASS_CLEAR );
+        if( i != 0 )
+            passDef->mExposedTextures.push_back( "in" );
+
+        nodeDef->mapOutputChannel( 0, "rt" );
+    }
+
+    CompositorNodeDef *finalDef = compositorManager->addNodeDefinition( "AliasChain/Final" );
+    finalDef->addTextureSourceName( "in", 0, TextureDefinitionBase::TEXTURE_INPUT );
+    finalDef->addTextureSourceName( "window", 1, TextureDefinitionBase::TEXTURE_INPUT );
+    finalDef->setNumTargetPass( 1u );
+    CompositorTargetDef *targetDef = finalDef->addTargetPass( "window" );
+    targetDef->setNumPasses( 1u );
+    targetDef->addPass( PASS_CLEAR )->mExposedTextures.push_back( "in" );
+
+    CompositorWorkspaceDef *workspaceDef =
+            compositorManager->addWorkspaceDefinition( "AliasChainWorkspace" );
+    for( size_t i=0; i<c_chainLength; ++i )
+    {
+        const IdString nextNode = i + 1u < c_chainLength ?
+                    IdString( "AliasChain/Node" + StringConverter::toString( i + 1u ) ) :
+                    IdString( "AliasChain/Final" );
+        workspaceDef->connect( "AliasChain/Node" + StringConverter::toString( i ), 0,
+                               nextNode, 0 );
+    }
+    workspaceDef->connectExternal( 0, "AliasChain/Final", 1 );
+}
+//--------------------------------------------------------------------------
+void TransientTextureAliasingTests::createWorkspace(void)
+{
+    mHelper = new NullRenderSystemHelper();
+    mSceneManager = mHelper->createSceneManager();
+    Camera *camera = mSceneManager->createCamera( "Main Camera" );
+
+    createChainWorkspaceDef();
+    mWorkspace = mHelper->getRoot()->getCompositorManager2()->addWorkspace(
+                     mSceneManager, mHelper->getWindow(), camera, "AliasChainWorkspace", true );
+}
+//--------------------------------------------------------------------------
+void TransientTextureAliasingTests::checkChain(void)
+{
+    const CompositorTextureAliasing::Stats &stats = mWorkspace->getTransientTextureStats();
+    const CompositorNodeVec &nodes = mWorkspace->getNodeSequence();
+
+    CPPUNIT_ASSERT( mWorkspace->isValid() );
+    CPPUNIT_ASSERT_EQUAL( c_chainLength + 1u, nodes.size() );
+
+    //The chain ping-pongs between node 0's and node 1's textures.
+    //Only those two and the history texture are allocated.
+    CPPUNIT_ASSERT_EQUAL( c_chainLength - 2u, stats.numAliased );
+    CPPUNIT_ASSERT_EQUAL( stats.naiveBytes * 3u, stats.allocatedBytes * (c_chainLength + 1u) );
+    for( size_t i=2; i<c_chainLength; ++i )
+    {
+        CPPUNIT_ASSERT( nodes[i]->getLocalTextures()[0] == nodes[i % 2u]->getLocalTextures()[0] );
+        CPPUNIT_ASSERT( nodes[i]->isLocalTextureAliased( 0 ) );
+    }
+    CPPUNIT_ASSERT( !nodes[0]->isLocalTextureAliased( 1 ) );
+
+    //Each node must read what the previous node wrote
+    for( size_t i=1; i<=c_chainLength; ++i )
+    {
+        CPPUNIT_ASSERT( nodes[i]->getInputChannel()[0] ==
+                        nodes[i - 1u]->getLocalTextures()[0] );
+    }
+}
+//--------------------------------------------------------------------------
+void TransientTextureAliasingTests::testAssignAllocations()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    CompositorTextureAliasing::LifetimeVec lifetimes;
+    lifetimes.push_back( makeLifetime( 0, 1, 0, true ) );  //0
+    lifetimes.push_back( makeLifetime( 1, 2, 0, true ) );  //1 overlaps 0 at pass 1
+    lifetimes.push_back( makeLifetime( 2, 3, 0, true ) );  //2 can take 0
+    lifetimes.push_back( makeLifetime( 3, 4, 1, true ) );  //3 different format
+    lifetimes.push_back( makeLifetime( 5, 6, 0, false ) ); //4 persistent
+    lifetimes.push_back( makeLifetime( 5, 6, 0, true ) );  //5 can take 0 or 1
+
+    vector<size_t>::type allocations;
+    CompositorTextureAliasing::Stats stats;
+    CompositorTextureAliasing::assignAllocations( lifetimes, allocations, stats );
+
+    CPPUNIT_ASSERT_EQUAL( (size_t)0u, allocations[0] );
+    CPPUNIT_ASSERT_EQUAL( (size_t)1u, allocations[1] );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0u, allocations[2] );
+    CPPUNIT_ASSERT_EQUAL( (size_t)3u, allocations[3] );
+    CPPUNIT_ASSERT_EQUAL( (size_t)4u, allocations[4] );
+    CPPUNIT_ASSERT( allocations[5] != 5u && allocations[5] != 4u );
+
+    CPPUNIT_ASSERT_EQUAL( (size_t)2u, stats.numAliased );
+    CPPUNIT_ASSERT_EQUAL( (size_t)(6u * 1024u), stats.naiveBytes );
+    CPPUNIT_ASSERT_EQUAL( (size_t)(4u * 1024u), stats.allocatedBytes );
+    //Pass 1 & 3 have two transient textures alive, plus the persistent one.
+    CPPUNIT_ASSERT_EQUAL( (size_t)(3u * 1024u), stats.peakLiveBytes );
+}
+//--------------------------------------------------------------------------
+void TransientTextureAliasingTests::testOffByDefault()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createWorkspace();
+
+    CPPUNIT_ASSERT_EQUAL( (size_t)0u, mWorkspace->getTransientTextureStats().numAliased );
+}
+//--------------------------------------------------------------------------
+void TransientTextureAliasingTests::testChainIsAliased()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createWorkspace();
+
+    mWorkspace->setTransientTextureAliasing( true );
+    checkChain();
+
+    for( size_t i=0; i<4u; ++i )
+        mHelper->getRoot()->renderOneFrame();
+    checkChain();
+}
+//--------------------------------------------------------------------------
+void TransientTextureAliasingTests::testResize()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createWorkspace();
+
+    mWorkspace->setTransientTextureAliasing( true );
+    mHelper->getRoot()->renderOneFrame();
+
+    //Resizing recreates the nodes
+    mHelper->getWindow()->resize( 1920, 1080 );
+    mHelper->getRoot()->renderOneFrame();
+    checkChain();
+}
+//--------------------------------------------------------------------------
+void TransientTextureAliasingTests::testReconnect()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createWorkspace();
+
+    mWorkspace->setTransientTextureAliasing( true );
+
+    //Reconnecting restores the textures, then shares them again
+    mWorkspace->reconnectAllNodes();
+    checkChain();
+}
+//--------------------------------------------------------------------------
+void TransientTextureAliasingTests::testDisable()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createWorkspace();
+
+    mWorkspace->setTransientTextureAliasing( true );
+    mWorkspace->setTransientTextureAliasing( false );
+
+    //Every node has its own texture again
+    CPPUNIT_ASSERT_EQUAL( (size_t)0u, mWorkspace->getTransientTextureStats().numAliased );
+    const CompositorNodeVec &nodes = mWorkspace->getNodeSequence();
+    for( size_t i=2; i<c_chainLength; ++i )
+    {
+        CPPUNIT_ASSERT( !(nodes[i]->getLocalTextures()[0] ==
+                          nodes[i % 2u]->getLocalTextures()[0]) );
+        CPPUNIT_ASSERT( !nodes[i]->isLocalTextureAliased( 0 ) );
+    }
+
+    //And can share them again
+    mWorkspace->setTransientTextureAliasing( true );
+    mHelper->getRoot()->renderOneFrame();
+    checkChain();
+}
+//--------------------------------------------------------------------------
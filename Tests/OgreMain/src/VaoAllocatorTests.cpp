@@ -0,0 +1,368 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "VaoAllocatorTests.h"
+#include "NullRenderSystemHelper.h"
+
+#include "Vao/OgreVaoManager.h"
+#include "Vao/OgreConstBufferPacked.h"
+#include "Vao/OgreIndexBufferPacked.h"
+#include "Vao/OgreVertexBufferPacked.h"
+#include "Vao/OgreTlsfSubAllocator.h"
+
+#include "UnitTestSuite.h"
+
+#include <algorithm>
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(VaoAllocatorTests);
+
+namespace
+{
+    const size_t c_numOps       = 20000u;
+    const size_t c_capacity     = 32u * 1024u * 1024u;
+    const size_t c_numBuffers   = 1000u;
+
+    /// Deterministic across platforms, unlike rand()
+    struct Lcg
+    {
+        uint32 state;
+        Lcg( uint32 seed ) : state( seed ) {}
+        uint32 next(void)
+        {
+            state = state * 1664525u + 1013904223u;
+            return state >> 8u;
+        }
+        /// Roughly log-uniform in [minValue; maxValue]
+        size_t nextLog( size_t minValue, size_t maxValue )
+        {
+            const Real t = Real( next() & 0xFFFF ) / Real( 0xFFFF );
+            return static_cast<size_t>( minValue * Math::Pow( Real( maxValue ) / Real( minValue ), t ) );
+        }
+    };
+
+    struct TraceOp
+    {
+        bool    allocate;
+        size_t  id;
+        size_t  sizeBytes;
+        size_t  alignment;
+    };
+    typedef vector<TraceOp>::type TraceOpVec;
+
+    /// Buffers with the size & alignment of vertex buffers (stride), index buffers and
+    /// const buffers (256 bytes) with random lifetimes. Live data hovers around liveTarget bytes.
+    TraceOpVec generateTrace( size_t numOps, size_t liveTarget )
+    {
+        const size_t c_strides[7] = { 12, 16, 24, 32, 36, 44, 48 };
+
+        Lcg lcg( 12345u );
+        TraceOpVec trace;
+        trace.reserve( numOps );
+
+        TraceOpVec live;
+        size_t liveBytes = 0;
+        size_t nextId = 0;
+
+        for( size_t i=0; i<numOps; ++i )
+        {
+            const bool doFree = !live.empty() &&
+                                ( liveBytes > liveTarget || (lcg.next() % 100u) < 45u );
+            if( doFree )
+            {
+                const size_t idx = lcg.next() % live.size();
+                TraceOp op = live[idx];
+                op.allocate = false;
+                trace.push_back( op );
+                liveBytes -= op.sizeBytes;
+                live[idx] = live.back();
+                live.pop_back();
+            }
+            else
+            {
+                TraceOp op;
+                op.allocate = true;
+                op.id       = nextId++;
+
+                const uint32 kind = lcg.next() % 10u;
+                if( kind < 6u )
+                {
+                    op.alignment = c_strides[lcg.next() % 7u];
+                    op.sizeBytes = lcg.nextLog( 24u, 16384u ) * op.alignment;
+                }
+                else if( kind < 9u )
+                {
+                    op.alignment = (lcg.next() & 1u) ? 2u : 4u;
+                    op.sizeBytes = lcg.nextLog( 36u, 65536u ) * op.alignment;
+                }
+                else
+                {
+                    op.alignment = 256u;
+                    op.sizeBytes = lcg.nextLog( 256u, 65536u );
+                }
+
+                trace.push_back( op );
+                live.push_back( op );
+                liveBytes += op.sizeBytes;
+            }
+        }
+
+        return trace;
+    }
+}
+
+//--------------------------------------------------------------------------
+void VaoAllocatorTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mHelper = 0;
+}
+//--------------------------------------------------------------------------
+void VaoAllocatorTests::tearDown()
+{
+    delete mHelper;
+    mHelper = 0;
+}
+//--------------------------------------------------------------------------
+void VaoAllocatorTests::testAlignmentPadding()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    TlsfSubAllocator allocator;
+    allocator.initialize( 4096u );
+
+    const size_t a = allocator.allocate( 100u, 1u );
+    const size_t b = allocator.allocate( 36u, 12u );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0u, a );
+    CPPUNIT_ASSERT_EQUAL( (size_t)108u, b );
+
+    //Padding isn't counted as used and goes back to the free lists, where it can be reused.
+    CPPUNIT_ASSERT_EQUAL( (size_t)136u, (size_t)allocator.getUsedBytes() );
+    CPPUNIT_ASSERT_EQUAL( (size_t)2u, (size_t)allocator.getNumFreeBlocks() );
+    CPPUNIT_ASSERT_EQUAL( (size_t)100u, allocator.allocate( 8u, 1u ) );
+
+    CPPUNIT_ASSERT_EQUAL( (size_t)TlsfSubAllocator::NoSpace, allocator.allocate( 8192u, 1u ) );
+}
+//--------------------------------------------------------------------------
+void VaoAllocatorTests::testFreedRangesMerge()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    TlsfSubAllocator allocator;
+    allocator.initialize( 4096u );
+
+    const size_t a = allocator.allocate( 100u, 1u );
+    const size_t b = allocator.allocate( 36u, 12u );
+    const size_t c = allocator.allocate( 8u, 1u );
+
+    allocator.deallocate( a, 100u );
+    allocator.deallocate( b, 36u );
+    allocator.deallocate( c, 8u );
+
+    CPPUNIT_ASSERT( allocator.isEmpty() );
+    CPPUNIT_ASSERT_EQUAL( (size_t)1u, (size_t)allocator.getNumFreeBlocks() );
+    CPPUNIT_ASSERT_EQUAL( (size_t)4096u, (size_t)allocator.getLargestFreeBlock() );
+    CPPUNIT_ASSERT_EQUAL( (size_t)144u, (size_t)allocator.getPeakUsedBytes() );
+}
+//--------------------------------------------------------------------------
+void VaoAllocatorTests::testAllocateAt()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    TlsfSubAllocator allocator;
+    allocator.initialize( 4096u );
+
+    //Same layout as allocate( 100, 1 ) followed by allocate( 36, 12 )
+    CPPUNIT_ASSERT( allocator.allocateAt( 0u, 100u ) );
+    CPPUNIT_ASSERT( allocator.allocateAt( 108u, 36u ) );
+    CPPUNIT_ASSERT( !allocator.allocateAt( 120u, 4u ) );
+
+    allocator.deallocate( 108u, 36u );
+    allocator.deallocate( 0u, 100u );
+    CPPUNIT_ASSERT_EQUAL( (size_t)4096u, (size_t)allocator.getLargestFreeBlock() );
+}
+//--------------------------------------------------------------------------
+void VaoAllocatorTests::testTraceRangesDoNotOverlap()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    //Keep the pool ~85% full so that fragmentation matters
+    const TraceOpVec trace = generateTrace( c_numOps, c_capacity - c_capacity / 7u );
+
+    TlsfSubAllocator allocator;
+    allocator.initialize( c_capacity );
+
+    //id -> offset; NoSpace when the allocation failed
+    vector<size_t>::type offsets( trace.size(), TlsfSubAllocator::NoSpace );
+    //offset -> size of the live ranges
+    map<size_t, size_t>::type liveRanges;
+    size_t usedBytes = 0;
+    size_t peakUsed = 0;
+
+    TraceOpVec::const_iterator itor = trace.begin();
+    TraceOpVec::const_iterator end  = trace.end();
+
+    while( itor != end )
+    {
+        const TraceOp &op = *itor;
+        if( op.allocate )
+        {
+            const size_t offset = allocator.allocate( op.sizeBytes, op.alignment );
+            offsets[op.id] = offset;
+            if( offset != TlsfSubAllocator::NoSpace )
+            {
+                CPPUNIT_ASSERT_EQUAL( (size_t)0u, offset % op.alignment );
+                CPPUNIT_ASSERT( offset + op.sizeBytes <= c_capacity );
+
+                map<size_t, size_t>::type::iterator itNext = liveRanges.lower_bound( offset );
+                CPPUNIT_ASSERT( itNext == liveRanges.end() ||
+                                itNext->first >= offset + op.sizeBytes );
+                if( itNext != liveRanges.begin() )
+                {
+                    map<size_t, size_t>::type::iterator itPrev = itNext;
+                    --itPrev;
+                    CPPUNIT_ASSERT( itPrev->first + itPrev->second <= offset );
+                }
+                liveRanges[offset] = op.sizeBytes;
+
+                usedBytes += op.sizeBytes;
+                peakUsed = std::max( peakUsed, usedBytes );
+            }
+        }
+        else if( offsets[op.id] != TlsfSubAllocator::NoSpace )
+        {
+            allocator.deallocate( offsets[op.id], op.sizeBytes );
+            liveRanges.erase( offsets[op.id] );
+            usedBytes -= op.sizeBytes;
+        }
+
+        CPPUNIT_ASSERT_EQUAL( usedBytes, (size_t)allocator.getUsedBytes() );
+
+        ++itor;
+    }
+
+    CPPUNIT_ASSERT_EQUAL( peakUsed, (size_t)allocator.getPeakUsedBytes() );
+}
+//--------------------------------------------------------------------------
+void VaoAllocatorTests::testVaoManagerStats()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    mHelper = new NullRenderSystemHelper();
+
+    VaoManager *vaoManager = mHelper->getVaoManager();
+
+    VaoManager::MemoryStats before;
+    vaoManager->getMemoryStats( BT_DEFAULT, before );
+
+    Lcg lcg( 54321u );
+
+    vector<VertexBufferPacked*>::type vertexBuffers;
+    vector<IndexBufferPacked*>::type indexBuffers;
+    vector<ConstBufferPacked*>::type constBuffers;
+    size_t expectedBytes = 0;
+
+    VertexElement2Vec vertexElements[3];
+    vertexElements[0].push_back( VertexElement2( VET_FLOAT3, VES_POSITION ) );
+    vertexElements[1].push_back( VertexElement2( VET_FLOAT3, VES_POSITION ) );
+    vertexElements[1].push_back( VertexElement2( VET_FLOAT3, VES_NORMAL ) );
+    vertexElements[1].push_back( VertexElement2( VET_FLOAT2, VES_TEXTURE_COORDINATES ) );
+    vertexElements[2].push_back( VertexElement2( VET_FLOAT4, VES_POSITION ) );
+
+    for( size_t i=0; i<c_numBuffers; ++i )
+    {
+        const uint32 kind = lcg.next() % 3u;
+        if( kind == 0u )
+        {
+            const VertexElement2Vec &elements = vertexElements[lcg.next() % 3u];
+            VertexBufferPacked *vertexBuffer = vaoManager->createVertexBuffer(
+                        elements, lcg.nextLog( 24u, 16384u ), BT_DEFAULT, 0, false );
+            vertexBuffers.push_back( vertexBuffer );
+            expectedBytes += vertexBuffer->getTotalSizeBytes();
+        }
+        else if( kind == 1u )
+        {
+            IndexBufferPacked *indexBuffer = vaoManager->createIndexBuffer(
+                        (lcg.next() & 1u) ? IndexBufferPacked::IT_16BIT :
+                                            IndexBufferPacked::IT_32BIT,
+                        lcg.nextLog( 36u, 65536u ), BT_DEFAULT, 0, false );
+            indexBuffers.push_back( indexBuffer );
+            expectedBytes += indexBuffer->getTotalSizeBytes();
+        }
+        else
+        {
+            ConstBufferPacked *constBuffer = vaoManager->createConstBuffer(
+                        lcg.nextLog( 64u, 65536u ), BT_DEFAULT, 0, false );
+            constBuffers.push_back( constBuffer );
+            expectedBytes += constBuffer->getTotalSizeBytes();
+        }
+    }
+
+    //Release every other vertex buffer to leave holes
+    size_t numDestroyed = 0;
+    for( size_t i=0; i<vertexBuffers.size(); i += 2u )
+    {
+        expectedBytes -= vertexBuffers[i]->getTotalSizeBytes();
+        vaoManager->destroyVertexBuffer( vertexBuffers[i] );
+        vertexBuffers[i] = 0;
+        ++numDestroyed;
+    }
+
+    VaoManager::MemoryStats during;
+    vaoManager->getMemoryStats( BT_DEFAULT, during );
+    VaoManager::MemoryStats immutable;
+    vaoManager->getMemoryStats( BT_IMMUTABLE, immutable );
+
+    CPPUNIT_ASSERT_EQUAL( (size_t)(before.numAllocations + c_numBuffers - numDestroyed),
+                          (size_t)during.numAllocations );
+    CPPUNIT_ASSERT_EQUAL( (size_t)(before.usedBytes + expectedBytes), (size_t)during.usedBytes );
+    CPPUNIT_ASSERT_EQUAL( (size_t)(during.capacity - during.usedBytes), (size_t)during.freeBytes );
+    CPPUNIT_ASSERT( during.peakUsedBytes >= during.usedBytes );
+    //BT_IMMUTABLE and BT_DEFAULT share the pools
+    CPPUNIT_ASSERT_EQUAL( (size_t)during.usedBytes, (size_t)immutable.usedBytes );
+
+    for( size_t i=0; i<vertexBuffers.size(); ++i )
+    {
+        if( vertexBuffers[i] )
+            vaoManager->destroyVertexBuffer( vertexBuffers[i] );
+    }
+    for( size_t i=0; i<indexBuffers.size(); ++i )
+        vaoManager->destroyIndexBuffer( indexBuffers[i] );
+    for( size_t i=0; i<constBuffers.size(); ++i )
+        vaoManager->destroyConstBuffer( constBuffers[i] );
+
+    VaoManager::MemoryStats after;
+    vaoManager->getMemoryStats( BT_DEFAULT, after );
+    CPPUNIT_ASSERT_EQUAL( (size_t)before.numAllocations, (size_t)after.numAllocations );
+    CPPUNIT_ASSERT_EQUAL( (size_t)before.usedBytes, (size_t)after.usedBytes );
+    //Freed ranges merge back
+    CPPUNIT_ASSERT( after.numFreeBlocks <= before.numFreeBlocks + after.numPools - before.numPools );
+}
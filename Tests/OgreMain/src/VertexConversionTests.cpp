@@ -0,0 +1,488 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "VertexConversionTests.h"
+#include "NullRenderSystemHelper.h"
+
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgreMesh.h"
+#include "OgreSubMesh.h"
+#include "OgreMeshManager.h"
+#include "OgreHardwareBufferManager.h"
+#include "OgreMesh2.h"
+#include "OgreMeshManager2.h"
+#include "OgreSubMesh2.h"
+#include "OgreBitwise.h"
+#include "OgreMatrix3.h"
+#include "OgreQuaternion.h"
+
+#include "Vao/OgreVaoManager.h"
+#include "Vao/OgreVertexArrayObject.h"
+
+#include "UnitTestSuite.h"
+
+#include <algorithm>
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(VertexConversionTests);
+
+namespace
+{
+    /// position, normal, tangent (w = reflection), binormal. uv lives in its own buffer.
+    const size_t c_floatsPerVertex = 3u + 3u + 4u + 3u;
+    /// Enough for a few SIMD blocks plus a remainder.
+    const size_t c_numVertices = 1027u;
+    const size_t c_numThreads = 4u;
+
+    const char *c_v1MeshName = "VertexConversionTests_v1";
+    const char *c_serialMeshName = "VertexConversionTests_Serial";
+    const char *c_threadedMeshName = "VertexConversionTests_Threaded";
+
+    typedef vector<float>::type FloatVec;
+
+    float randomSigned( uint32 &seed )
+    {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<float>( seed >> 8u ) / 8388608.0f - 1.0f;
+    }
+
+    /// Random positions & orthonormal frames, with axis-aligned normals and
+    /// reflected frames (both by tangent.w and by the binormal) mixed in.
+    void generateVertices( size_t numVertices, uint32 seed, FloatVec &outVertices,
+                           FloatVec &outUvs )
+    {
+        outVertices.resize( numVertices * c_floatsPerVertex );
+        outUvs.resize( numVertices * 2u );
+
+        for( size_t i=0; i<numVertices; ++i )
+        {
+            Vector3 normal( randomSigned( seed ), randomSigned( seed ), randomSigned( seed ) );
+            if( i % 13u == 0 )
+                normal = (i & 1u) ? Vector3::UNIT_Z : Vector3::NEGATIVE_UNIT_Z;
+            else if( i % 17u == 0 )
+                normal = Vector3::NEGATIVE_UNIT_X;
+            normal.normalise();
+
+            Vector3 tangent = Quaternion( Radian( randomSigned( seed ) * Math::PI ), normal ) *
+                              normal.perpendicular();
+            Vector3 binormal = normal.crossProduct( tangent );
+            if( i % 3u == 0 )
+                binormal = -binormal;
+
+            float *dst = &outVertices[i * c_floatsPerVertex];
+            dst[0] = randomSigned( seed ) * 100.0f;
+            dst[1] = randomSigned( seed ) * 100.0f;
+            dst[2] = randomSigned( seed ) * 100.0f;
+            dst[3] = static_cast<float>( normal.x );
+            dst[4] = static_cast<float>( normal.y );
+            dst[5] = static_cast<float>( normal.z );
+            dst[6] = static_cast<float>( tangent.x );
+            dst[7] = static_cast<float>( tangent.y );
+            dst[8] = static_cast<float>( tangent.z );
+            dst[9] = (i % 5u == 0) ? -1.0f : 1.0f;
+            dst[10] = static_cast<float>( binormal.x );
+            dst[11] = static_cast<float>( binormal.y );
+            dst[12] = static_cast<float>( binormal.z );
+
+            outUvs[i * 2u + 0] = randomSigned( seed ) * 4.0f;
+            outUvs[i * 2u + 1] = randomSigned( seed );
+        }
+    }
+
+    /// The per-vertex conversion _arrangeEfficient used to perform, restricted to
+    /// the half4 position, QTangent & half2 uv layout these tests convert to.
+    void referenceConversion( const FloatVec &vertices, const FloatVec &uvs, bool hasBinormal,
+                              bool hasTangentW, uint16 *dst )
+    {
+        const size_t numVertices = uvs.size() / 2u;
+
+        for( size_t i=0; i<numVertices; ++i )
+        {
+            const float *src = &vertices[i * c_floatsPerVertex];
+
+            for( size_t j=0; j<3u; ++j )
+                dst[j] = Bitwise::floatToHalf( src[j] );
+            dst[3] = Bitwise::floatToHalf( 1.0f );
+
+            Vector3 vNormal( src[3], src[4], src[5] );
+            Vector3 vTangent( src[6], src[7], src[8] );
+            float reflection = hasTangentW ? src[9] : 1.0f;
+
+            if( hasBinormal )
+            {
+                Vector3 vBinormal( src[10], src[11], src[12] );
+                if( vTangent.crossProduct( vNormal ).dotProduct( vBinormal ) <= 0 )
+                    reflection = -1.0f;
+            }
+
+            Matrix3 tbn;
+            tbn.SetColumn( 0, vNormal );
+            tbn.SetColumn( 1, vTangent );
+            tbn.SetColumn( 2, vNormal.crossProduct( vTangent ) );
+
+            Quaternion qTangent( tbn );
+            qTangent.normalise();
+
+            const Real bias = 1.0f / 32767.0f;
+
+            if( qTangent.w < 0 )
+                qTangent = -qTangent;
+
+            if( qTangent.w < bias )
+            {
+                Real normFactor = Math::Sqrt( 1 - bias * bias );
+                qTangent.w = bias;
+                qTangent.x *= normFactor;
+                qTangent.y *= normFactor;
+                qTangent.z *= normFactor;
+            }
+
+            if( reflection < 0 )
+                qTangent = -qTangent;
+
+            dst[4] = static_cast<uint16>( Bitwise::floatToSnorm16( qTangent.x ) );
+            dst[5] = static_cast<uint16>( Bitwise::floatToSnorm16( qTangent.y ) );
+            dst[6] = static_cast<uint16>( Bitwise::floatToSnorm16( qTangent.z ) );
+            dst[7] = static_cast<uint16>( Bitwise::floatToSnorm16( qTangent.w ) );
+
+            dst[8] = Bitwise::floatToHalf( uvs[i * 2u + 0] );
+            dst[9] = Bitwise::floatToHalf( uvs[i * 2u + 1] );
+
+            dst += 10u;
+        }
+    }
+
+    /// A v1 mesh with one SubMesh per element of subMeshSizes; of decreasing size
+    /// so that the worker threads get uneven jobs, and every other one with binormals.
+    v1::MeshPtr createV1Mesh( const vector<size_t>::type &subMeshSizes )
+    {
+        v1::MeshPtr mesh = v1::MeshManager::getSingleton().createManual(
+                    c_v1MeshName, ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME );
+
+        v1::HardwareBufferManager &hwBufferManager = v1::HardwareBufferManager::getSingleton();
+
+        for( size_t i=0; i<subMeshSizes.size(); ++i )
+        {
+            const size_t numVertices = subMeshSizes[i];
+            const bool hasBinormal = (i & 1u) != 0;
+
+            FloatVec vertices, uvs;
+            generateVertices( numVertices, static_cast<uint32>( i + 1u ), vertices, uvs );
+
+            v1::SubMesh *subMesh = mesh->createSubMesh();
+            subMesh->useSharedVertices = false;
+            subMesh->setMaterialName( "BaseWhite" );
+
+            v1::VertexData *vertexData = OGRE_NEW v1::VertexData();
+            vertexData->vertexCount = numVertices;
+            subMesh->vertexData[VpNormal] = vertexData;
+
+            v1::VertexDeclaration *decl = vertexData->vertexDeclaration;
+            size_t offset = 0;
+            offset += decl->addElement( 0, offset, VET_FLOAT3, VES_POSITION ).getSize();
+            offset += decl->addElement( 0, offset, VET_FLOAT3, VES_NORMAL ).getSize();
+            offset += decl->addElement( 0, offset, VET_FLOAT4, VES_TANGENT ).getSize();
+            if( hasBinormal )
+                offset += decl->addElement( 0, offset, VET_FLOAT3, VES_BINORMAL ).getSize();
+            decl->addElement( 1, 0, VET_FLOAT2, VES_TEXTURE_COORDINATES );
+
+            v1::HardwareVertexBufferSharedPtr vertexBuffer = hwBufferManager.createVertexBuffer(
+                        offset, numVertices, v1::HardwareBuffer::HBU_STATIC_WRITE_ONLY );
+            char *dst = static_cast<char*>( vertexBuffer->lock(
+                                                v1::HardwareBuffer::HBL_DISCARD ) );
+            for( size_t j=0; j<numVertices; ++j )
+                memcpy( dst + j * offset, &vertices[j * c_floatsPerVertex], offset );
+            vertexBuffer->unlock();
+
+            v1::HardwareVertexBufferSharedPtr uvBuffer = hwBufferManager.createVertexBuffer(
+                        sizeof(float) * 2u, numVertices, v1::HardwareBuffer::HBU_STATIC_WRITE_ONLY );
+            uvBuffer->writeData( 0, uvBuffer->getSizeInBytes(), &uvs[0], true );
+
+            vertexData->vertexBufferBinding->setBinding( 0, vertexBuffer );
+            vertexData->vertexBufferBinding->setBinding( 1, uvBuffer );
+
+            v1::IndexData *indexData = OGRE_NEW v1::IndexData();
+            indexData->indexCount = (numVertices / 3u) * 3u;
+            indexData->indexBuffer = hwBufferManager.createIndexBuffer(
+                        v1::HardwareIndexBuffer::IT_32BIT, indexData->indexCount,
+                        v1::HardwareBuffer::HBU_STATIC_WRITE_ONLY );
+            uint32 *indices = static_cast<uint32*>( indexData->indexBuffer->lock(
+                                                        v1::HardwareBuffer::HBL_DISCARD ) );
+            for( size_t j=0; j<indexData->indexCount; ++j )
+                indices[j] = static_cast<uint32>( j );
+            indexData->indexBuffer->unlock();
+            subMesh->indexData[VpNormal] = indexData;
+        }
+
+        mesh->_setBounds( AxisAlignedBox( -100, -100, -100, 100, 100, 100 ), false );
+        mesh->_setBoundingSphereRadius( 174 );
+        mesh->prepareForShadowMapping( false );
+
+        return mesh;
+    }
+    bool areVertexBuffersEqual( const MeshPtr &a, const MeshPtr &b )
+    {
+        if( a->getNumSubMeshes() != b->getNumSubMeshes() )
+            return false;
+
+        for( size_t i=0; i<a->getNumSubMeshes(); ++i )
+        {
+            for( size_t vaoPassIdx=0; vaoPassIdx<NumVertexPass; ++vaoPassIdx )
+            {
+                const VertexArrayObjectArray &vaosA = a->getSubMesh( i )->mVao[vaoPassIdx];
+                const VertexArrayObjectArray &vaosB = b->getSubMesh( i )->mVao[vaoPassIdx];
+
+                if( vaosA.size() != vaosB.size() )
+                    return false;
+
+                for( size_t j=0; j<vaosA.size(); ++j )
+                {
+                    const VertexBufferPackedVec &buffersA = vaosA[j]->getVertexBuffers();
+                    const VertexBufferPackedVec &buffersB = vaosB[j]->getVertexBuffers();
+
+                    if( buffersA.size() != buffersB.size() )
+                        return false;
+
+                    for( size_t k=0; k<buffersA.size(); ++k )
+                    {
+                        if( buffersA[k]->getTotalSizeBytes() != buffersB[k]->getTotalSizeBytes() ||
+                            !buffersA[k]->getShadowCopy() || !buffersB[k]->getShadowCopy() ||
+                            memcmp( buffersA[k]->getShadowCopy(), buffersB[k]->getShadowCopy(),
+                                    buffersA[k]->getTotalSizeBytes() ) )
+                        {
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+
+        return true;
+    }
+    MeshPtr importMesh( const v1::MeshPtr &v1Mesh, const String &name, bool efficient,
+                        SceneManager *sceneManager )
+    {
+        MeshPtr mesh = MeshManager::getSingleton().createManual(
+                    name, ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME );
+        mesh->setVertexBufferPolicy( BT_IMMUTABLE, true );
+        mesh->setIndexBufferPolicy( BT_IMMUTABLE, false );
+        mesh->importV1( v1Mesh.get(), efficient, efficient, efficient, sceneManager );
+        return mesh;
+    }
+
+    /// One big SubMesh and many small ones.
+    vector<size_t>::type getSubMeshSizes(void)
+    {
+        vector<size_t>::type subMeshSizes;
+        subMeshSizes.push_back( c_numVertices * 4u );
+        for( size_t i=0; i<15u; ++i )
+            subMeshSizes.push_back( std::max<size_t>( c_numVertices * 4u / (i + 2u), 3u ) );
+        return subMeshSizes;
+    }
+}
+//--------------------------------------------------------------------------
+void VertexConversionTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mHelper = 0;
+    mSceneManager = 0;
+}
+//--------------------------------------------------------------------------
+void VertexConversionTests::tearDown()
+{
+    if( mHelper )
+        v1::MeshManager::getSingleton().remove( c_v1MeshName );
+
+    delete mHelper;
+    mHelper = 0;
+    mSceneManager = 0;
+}
+//--------------------------------------------------------------------------
+void VertexConversionTests::createScene(void)
+{
+    mHelper = new NullRenderSystemHelper();
+
+    mSceneManager = mHelper->createSceneManager( c_numThreads );
+}
+//--------------------------------------------------------------------------
+void VertexConversionTests::testConversion( bool hasBinormal, bool hasTangentW )
+{
+    FloatVec vertices, uvs;
+    generateVertices( c_numVertices, 1u, vertices, uvs );
+
+    const size_t stride = c_floatsPerVertex * sizeof(float);
+    const char *srcVertices = reinterpret_cast<const char*>( &vertices[0] );
+
+    SubMesh::SourceDataArray srcData;
+    srcData.push_back( SubMesh::SourceData( srcVertices, stride,
+                                            VertexElement2( VET_FLOAT3, VES_POSITION ) ) );
+    srcData.push_back( SubMesh::SourceData( srcVertices + sizeof(float) * 3u, stride,
+                                            VertexElement2( VET_FLOAT3, VES_NORMAL ) ) );
+    srcData.push_back( SubMesh::SourceData( reinterpret_cast<const char*>( &uvs[0] ),
+                                            sizeof(float) * 2u,
+                                            VertexElement2( VET_FLOAT2,
+                                                            VES_TEXTURE_COORDINATES ) ) );
+    srcData.push_back( SubMesh::SourceData( srcVertices + sizeof(float) * 6u, stride,
+                                            VertexElement2( hasTangentW ? VET_FLOAT4 : VET_FLOAT3,
+                                                            VES_TANGENT ) ) );
+    if( hasBinormal )
+    {
+        srcData.push_back( SubMesh::SourceData( srcVertices + sizeof(float) * 10u, stride,
+                                                VertexElement2( VET_FLOAT3, VES_BINORMAL ) ) );
+    }
+
+    VertexElement2Vec vertexElements;
+    vertexElements.push_back( VertexElement2( VET_HALF4, VES_POSITION ) );
+    vertexElements.push_back( VertexElement2( VET_SHORT4_SNORM, VES_NORMAL ) );
+    vertexElements.push_back( VertexElement2( VET_HALF2, VES_TEXTURE_COORDINATES ) );
+
+    vector<uint16>::type reference( c_numVertices * 10u );
+    referenceConversion( vertices, uvs, hasBinormal, hasTangentW, &reference[0] );
+
+    char *converted = SubMesh::_arrangeEfficient( srcData, vertexElements,
+                                                  static_cast<uint32>( c_numVertices ) );
+    const uint16 *result = reinterpret_cast<const uint16*>( converted );
+
+    size_t halfMismatches = 0;
+    size_t qTangentMismatches = 0;
+
+    for( size_t i=0; i<c_numVertices * 10u; ++i )
+    {
+        const size_t component = i % 10u;
+        if( component >= 4u && component < 8u )
+        {
+            //QTangents may be off by one LSB.
+            const int diff = abs( static_cast<int16>( reference[i] ) -
+                                  static_cast<int16>( result[i] ) );
+            qTangentMismatches += diff > 1;
+        }
+        else
+        {
+            halfMismatches += reference[i] != result[i];
+        }
+    }
+
+    OGRE_FREE_SIMD( converted, MEMCATEGORY_GEOMETRY );
+
+    CPPUNIT_ASSERT_EQUAL( (size_t)0, halfMismatches );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0, qTangentMismatches );
+}
+//--------------------------------------------------------------------------
+void VertexConversionTests::testHalfSpecialValues()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const uint32 specialBits[] =
+    {
+        0x00000000u, 0x80000000u,               //+-0
+        0x00000001u, 0x807fffffu,               //Float denormals
+        0x33000000u, 0x33000001u, 0xb3800000u,  //Around the smallest half denormal
+        0x387fc000u, 0x38800000u, 0xb8800000u,  //Largest half denormal, smallest normal
+        0x3f800000u, 0xbfc00000u,               //+1, -1.5
+        0x477fe000u, 0x477ff000u, 0x477fffffu,  //65504 and just above it
+        0x47800000u, 0xc7800000u, 0x7f7fffffu,  //Overflow
+        0x7f800000u, 0xff800000u,               //+-Inf
+        0x7fc00000u, 0xffc00001u, 0x7f800001u   //NaNs
+    };
+    const size_t numValues = sizeof(specialBits) / sizeof(specialBits[0]);
+
+    //Four components per vertex, padded with ones.
+    const size_t numVertices = (numValues + 3u) / 4u;
+    vector<uint32>::type bits( numVertices * 4u, 0x3f800000u );
+    std::copy( specialBits, specialBits + numValues, bits.begin() );
+
+    SubMesh::SourceDataArray srcData;
+    srcData.push_back( SubMesh::SourceData( reinterpret_cast<const char*>( &bits[0] ),
+                                            sizeof(float) * 4u,
+                                            VertexElement2( VET_FLOAT4, VES_POSITION ) ) );
+    VertexElement2Vec vertexElements;
+    vertexElements.push_back( VertexElement2( VET_HALF4, VES_POSITION ) );
+
+    char *converted = SubMesh::_arrangeEfficient( srcData, vertexElements,
+                                                  static_cast<uint32>( numVertices ) );
+    const uint16 *halfs = reinterpret_cast<const uint16*>( converted );
+
+    vector<uint16>::type results( halfs, halfs + bits.size() );
+    OGRE_FREE_SIMD( converted, MEMCATEGORY_GEOMETRY );
+
+    for( size_t i=0; i<bits.size(); ++i )
+        CPPUNIT_ASSERT_EQUAL( Bitwise::floatToHalfI( bits[i] ), results[i] );
+}
+//--------------------------------------------------------------------------
+void VertexConversionTests::testQTangentFloat4Tangent()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+    testConversion( false, true );
+}
+//--------------------------------------------------------------------------
+void VertexConversionTests::testQTangentFloat3Tangent()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+    testConversion( false, false );
+}
+//--------------------------------------------------------------------------
+void VertexConversionTests::testQTangentWithBinormal()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+    testConversion( true, true );
+}
+//--------------------------------------------------------------------------
+void VertexConversionTests::testThreadedImportMatchesSerial()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createScene();
+
+    v1::MeshPtr v1Mesh = createV1Mesh( getSubMeshSizes() );
+
+    MeshPtr serial = importMesh( v1Mesh, c_serialMeshName, true, 0 );
+    MeshPtr threaded = importMesh( v1Mesh, c_threadedMeshName, true, mSceneManager );
+
+    CPPUNIT_ASSERT( areVertexBuffersEqual( serial, threaded ) );
+}
+//--------------------------------------------------------------------------
+void VertexConversionTests::testThreadedArrangeEfficientMatchesSerial()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createScene();
+
+    v1::MeshPtr v1Mesh = createV1Mesh( getSubMeshSizes() );
+
+    //Import as 32-bit floats, then convert.
+    MeshPtr serial = importMesh( v1Mesh, c_serialMeshName, false, 0 );
+    MeshPtr threaded = importMesh( v1Mesh, c_threadedMeshName, false, 0 );
+
+    serial->arrangeEfficient( true, true, true );
+    threaded->arrangeEfficient( true, true, true, mSceneManager );
+
+    CPPUNIT_ASSERT( areVertexBuffersEqual( serial, threaded ) );
+}
@@ -0,0 +1,82 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef __TerraPagerTests_H__
+#define __TerraPagerTests_H__
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "OgrePrerequisites.h"
+
+namespace Ogre
+{
+    class TerraPager;
+}
+class FakeTerraPageProvider;
+
+/// Checks the page requests, eviction and upload budget of the Terrain tutorial's TerraPager.
+/// Headless: the pages come from a generated heightmap and nothing is uploaded to a GPU.
+class TerraPagerTests : public CppUnit::TestFixture
+{
+    // CppUnit macros for setting up the test suite
+    CPPUNIT_TEST_SUITE(TerraPagerTests);
+    CPPUNIT_TEST(testRequestsPagesAroundCamera);
+    CPPUNIT_TEST(testUploadBudget);
+    CPPUNIT_TEST(testEvictAndReload);
+    CPPUNIT_TEST(testDestroyWhileLoading);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    FakeTerraPageProvider   *mProvider;
+    Ogre::TerraPager        *mPager;
+
+    void createPager( Ogre::uint32 loadRadius, Ogre::uint32 unloadRadius );
+
+    /** Calls update (and _notifyUploaded) until numResidentPages are resident.
+    @param outNumUploads
+        [out] Number of pages handed out for uploading.
+    @param outMaxUploadsPerUpdate
+        [out] Most pages handed out by a single update.
+    @return
+        False if the workers didn't finish in time.
+    */
+    bool waitForPages( Ogre::int32 cameraPageX, Ogre::int32 cameraPageZ, size_t numResidentPages,
+                       size_t &outNumUploads, size_t &outMaxUploadsPerUpdate );
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testRequestsPagesAroundCamera();
+    void testUploadBudget();
+    void testEvictAndReload();
+    void testDestroyWhileLoading();
+};
+
+#endif
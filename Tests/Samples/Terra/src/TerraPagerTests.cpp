@@ -0,0 +1,265 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "TerraPagerTests.h"
+
+#include "Terra/TerraPager.h"
+
+#include "UnitTestSuite.h"
+
+#include <algorithm>
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(TerraPagerTests);
+
+namespace
+{
+    /// 4x4 pages
+    const uint32 c_size = 256u;
+    const uint32 c_pageResolution = 64u;
+    const uint32 c_numPages = (c_size / c_pageResolution) * (c_size / c_pageResolution);
+    const float c_height = 100.0f;
+    const uint32 c_numWorkerThreads = 2u;
+    /// Times waitForPages calls update (sleeping 1ms in between) before giving up.
+    const size_t c_maxUpdates = 10000u;
+
+    float getExpectedHeight( uint32 x, uint32 z )
+    {
+        return ( (x * 7u + z * 13u) % 256u ) / 255.0f;
+    }
+}
+
+/// Generates the heights and counts the pages loaded. loadPage can be slowed down
+/// to keep the workers busy.
+class FakeTerraPageProvider : public TerraPageProvider
+{
+    LightweightMutex    mMutex;
+    size_t              mNumLoads;
+    uint32              mLoadMilliseconds;
+
+public:
+    FakeTerraPageProvider( uint32 loadMilliseconds=0 ) :
+        mNumLoads( 0 ),
+        mLoadMilliseconds( loadMilliseconds )
+    {
+    }
+
+    size_t getNumLoads(void)
+    {
+        mMutex.lock();
+        const size_t retVal = mNumLoads;
+        mMutex.unlock();
+        return retVal;
+    }
+
+    virtual void loadPage( uint32 startX, uint32 startZ, uint32 width, uint32 depth,
+                           float *outHeights )
+    {
+        if( mLoadMilliseconds )
+            Threads::Sleep( mLoadMilliseconds );
+
+        for( uint32 z=0; z<depth; ++z )
+        {
+            for( uint32 x=0; x<width; ++x )
+                *outHeights++ = getExpectedHeight( startX + x, startZ + z );
+        }
+
+        mMutex.lock();
+        ++mNumLoads;
+        mMutex.unlock();
+    }
+};
+
+//--------------------------------------------------------------------------
+void TerraPagerTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mProvider = 0;
+    mPager = 0;
+}
+//--------------------------------------------------------------------------
+void TerraPagerTests::tearDown()
+{
+    //The pager must go first; its workers use the provider.
+    delete mPager;
+    mPager = 0;
+    delete mProvider;
+    mProvider = 0;
+}
+//--------------------------------------------------------------------------
+void TerraPagerTests::createPager( uint32 loadRadius, uint32 unloadRadius )
+{
+    if( !mProvider )
+        mProvider = new FakeTerraPageProvider();
+    mPager = new TerraPager( mProvider, c_size, c_size, c_pageResolution, 32u, 32u, c_height,
+                             Vector3( 1.0f, c_height, 1.0f ).normalisedCopy(),
+                             c_numWorkerThreads );
+    mPager->setStreamingRadius( loadRadius, unloadRadius );
+}
+//--------------------------------------------------------------------------
+bool TerraPagerTests::waitForPages( int32 cameraPageX, int32 cameraPageZ, size_t numResidentPages,
+                                    size_t &outNumUploads, size_t &outMaxUploadsPerUpdate )
+{
+    outNumUploads = 0;
+    outMaxUploadsPerUpdate = 0;
+
+    std::vector<TerraPage*> uploads;
+    for( size_t i=0; i<c_maxUpdates; ++i )
+    {
+        uploads.clear();
+        mPager->update( cameraPageX, cameraPageZ, uploads );
+        mPager->_notifyUploaded( uploads );
+
+        outNumUploads += uploads.size();
+        outMaxUploadsPerUpdate = std::max( outMaxUploadsPerUpdate, uploads.size() );
+
+        if( mPager->getNumResidentPages() == numResidentPages &&
+            mPager->getNumLoadingPages() == 0u )
+        {
+            return true;
+        }
+
+        Threads::Sleep( 1u );
+    }
+
+    return false;
+}
+//--------------------------------------------------------------------------
+void TerraPagerTests::testRequestsPagesAroundCamera()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createPager( 1u, 1u );
+
+    //Camera in the corner page: it and its 3 neighbours
+    std::vector<TerraPage*> uploads;
+    mPager->update( 0, 0, uploads );
+    CPPUNIT_ASSERT( uploads.empty() );
+    CPPUNIT_ASSERT_EQUAL( (size_t)4u, mPager->getNumLoadingPages() );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0u, mPager->getNumResidentPages() );
+
+    size_t numUploads, maxUploadsPerUpdate;
+    CPPUNIT_ASSERT( waitForPages( 0, 0, 4u, numUploads, maxUploadsPerUpdate ) );
+    CPPUNIT_ASSERT_EQUAL( (size_t)4u, numUploads );
+    CPPUNIT_ASSERT_EQUAL( (size_t)4u, mProvider->getNumLoads() );
+    CPPUNIT_ASSERT( !mPager->areAllPagesOnGpu() );
+
+    //The heights come back scaled, and pages outside the radius aren't resident
+    for( uint32 z=0; z<c_size; z += 17u )
+    {
+        for( uint32 x=0; x<c_size; x += 17u )
+        {
+            const TerraPage *page = mPager->getResidentPage( x, z );
+            if( x < c_pageResolution * 2u && z < c_pageResolution * 2u )
+            {
+                CPPUNIT_ASSERT( page != 0 );
+                CPPUNIT_ASSERT( !page->needsGpuUpload );
+                CPPUNIT_ASSERT( page->heightTexels.empty() );
+                CPPUNIT_ASSERT_DOUBLES_EQUAL( getExpectedHeight( x, z ) * c_height,
+                                              page->getHeight( x, z ), 1e-4f );
+            }
+            else
+            {
+                CPPUNIT_ASSERT( page == 0 );
+            }
+        }
+    }
+
+    //Nothing new while the camera stays
+    mPager->update( 0, 0, uploads );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0u, mPager->getNumLoadingPages() );
+    CPPUNIT_ASSERT_EQUAL( (size_t)4u, mProvider->getNumLoads() );
+}
+//--------------------------------------------------------------------------
+void TerraPagerTests::testUploadBudget()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createPager( 3u, 3u );
+    mPager->setMaxUploadsPerFrame( 1u );
+
+    size_t numUploads, maxUploadsPerUpdate;
+    CPPUNIT_ASSERT( waitForPages( 0, 0, c_numPages, numUploads, maxUploadsPerUpdate ) );
+    CPPUNIT_ASSERT_EQUAL( (size_t)c_numPages, numUploads );
+    CPPUNIT_ASSERT_EQUAL( (size_t)1u, maxUploadsPerUpdate );
+    CPPUNIT_ASSERT( mPager->areAllPagesOnGpu() );
+
+    //Zero gets clamped to one
+    mPager->setMaxUploadsPerFrame( 0u );
+    CPPUNIT_ASSERT_EQUAL( (uint32)1u, mPager->getMaxUploadsPerFrame() );
+}
+//--------------------------------------------------------------------------
+void TerraPagerTests::testEvictAndReload()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    createPager( 0u, 0u );
+
+    size_t numUploads, maxUploadsPerUpdate;
+    CPPUNIT_ASSERT( waitForPages( 0, 0, 1u, numUploads, maxUploadsPerUpdate ) );
+    CPPUNIT_ASSERT_EQUAL( (size_t)1u, numUploads );
+
+    //Moving to the opposite corner evicts the first page
+    CPPUNIT_ASSERT( waitForPages( 3, 3, 1u, numUploads, maxUploadsPerUpdate ) );
+    CPPUNIT_ASSERT_EQUAL( (size_t)1u, numUploads );
+    CPPUNIT_ASSERT( mPager->getResidentPage( 0u, 0u ) == 0 );
+    CPPUNIT_ASSERT( mPager->getResidentPage( c_size - 1u, c_size - 1u ) != 0 );
+
+    //Coming back reloads it on the CPU, but the GPU already has it
+    CPPUNIT_ASSERT( waitForPages( 0, 0, 1u, numUploads, maxUploadsPerUpdate ) );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0u, numUploads );
+    CPPUNIT_ASSERT_EQUAL( (size_t)3u, mProvider->getNumLoads() );
+
+    const TerraPage *page = mPager->getResidentPage( 0u, 0u );
+    CPPUNIT_ASSERT( page != 0 );
+    CPPUNIT_ASSERT( page->heightTexels.empty() && page->normalTexels.empty() );
+    CPPUNIT_ASSERT_DOUBLES_EQUAL( getExpectedHeight( 5u, 9u ) * c_height,
+                                  page->getHeight( 5u, 9u ), 1e-4f );
+}
+//--------------------------------------------------------------------------
+void TerraPagerTests::testDestroyWhileLoading()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    //Slow enough that most requests are still pending when the pager gets destroyed.
+    //The workers must wake up and leave instead of hanging.
+    mProvider = new FakeTerraPageProvider( 20u );
+    createPager( 3u, 3u );
+
+    std::vector<TerraPage*> uploads;
+    mPager->update( 0, 0, uploads );
+    CPPUNIT_ASSERT_EQUAL( (size_t)c_numPages, mPager->getNumLoadingPages() );
+
+    delete mPager;
+    mPager = 0;
+
+    CPPUNIT_ASSERT( mProvider->getNumLoads() < c_numPages );
+}
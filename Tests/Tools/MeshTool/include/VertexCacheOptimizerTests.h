@@ -0,0 +1,74 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __VertexCacheOptimizerTests_H__
+#define __VertexCacheOptimizerTests_H__
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "OgrePrerequisites.h"
+#include "OgreVector3.h"
+
+/// Checks the index-level algorithms behind OgreMeshTool's '-cache' option on a
+/// torus whose triangles come in random order.
+class VertexCacheOptimizerTests : public CppUnit::TestFixture
+{
+    // CppUnit macros for setting up the test suite
+    CPPUNIT_TEST_SUITE(VertexCacheOptimizerTests);
+    CPPUNIT_TEST(testTipsifyImprovesAcmr);
+    CPPUNIT_TEST(testSplitClusters);
+    CPPUNIT_TEST(testOverdrawOrderKeepsClusters);
+    CPPUNIT_TEST(testOutwardClustersFirst);
+    CPPUNIT_TEST(testFirstUseRemap);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    typedef Ogre::vector<Ogre::uint32>::type IndexVec;
+    typedef Ogre::vector<size_t>::type ClusterStartVec;
+
+    Ogre::vector<Ogre::Vector3>::type   mPositions;
+    IndexVec                            mIndices;
+
+    /// Whether both lists hold the same triangles, each with the same winding.
+    static bool sameTriangles( const IndexVec &a, const IndexVec &b );
+
+public:
+    void setUp();
+    void tearDown();
+
+    /// Tipsify must lower the ACMR without adding, dropping or flipping triangles.
+    void testTipsifyImprovesAcmr();
+    void testSplitClusters();
+    /// Clusters are moved as a whole; triangles inside a cluster keep their order.
+    void testOverdrawOrderKeepsClusters();
+    void testOutwardClustersFirst();
+    /// Vertices are renumbered in order of first use and the data follows them.
+    void testFirstUseRemap();
+};
+
+#endif
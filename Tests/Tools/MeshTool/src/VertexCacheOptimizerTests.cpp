@@ -0,0 +1,366 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "VertexCacheOptimizerTests.h"
+
+#include "VertexCacheOptimizer.h"
+#include "OgreMath.h"
+
+#include "UnitTestSuite.h"
+
+#include <algorithm>
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(VertexCacheOptimizerTests);
+
+namespace
+{
+    const uint32 c_cacheSize = 16u;
+    const uint32 c_numRings = 32u;
+    const uint32 c_numSides = 16u;
+
+    struct Triangle
+    {
+        uint32 v[3];
+
+        bool operator < ( const Triangle &_r ) const
+        {
+            return std::lexicographical_compare( v, v + 3, _r.v, _r.v + 3 );
+        }
+        bool operator == ( const Triangle &_r ) const
+        {
+            return v[0] == _r.v[0] && v[1] == _r.v[1] && v[2] == _r.v[2];
+        }
+    };
+
+    /// Rotates the triangle so it starts with its lowest index; keeps the winding.
+    vector<Triangle>::type toSortedTriangles( const vector<uint32>::type &indices )
+    {
+        vector<Triangle>::type retVal;
+        retVal.reserve( indices.size() / 3u );
+        for( size_t i=0; i<indices.size(); i += 3u )
+        {
+            size_t first = 0;
+            for( size_t j=1; j<3u; ++j )
+            {
+                if( indices[i + j] < indices[i + first] )
+                    first = j;
+            }
+
+            Triangle triangle;
+            for( size_t j=0; j<3u; ++j )
+                triangle.v[j] = indices[i + (first + j) % 3u];
+            retVal.push_back( triangle );
+        }
+
+        std::sort( retVal.begin(), retVal.end() );
+        return retVal;
+    }
+
+    /// Deterministic, so a failure can be reproduced.
+    uint32 nextRandom( uint32 &inOutSeed )
+    {
+        inOutSeed = inOutSeed * 1664525u + 1013904223u;
+        return inOutSeed >> 8u;
+    }
+}
+
+//--------------------------------------------------------------------------
+void VertexCacheOptimizerTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mPositions.clear();
+    mIndices.clear();
+
+    for( uint32 ring=0; ring<c_numRings; ++ring )
+    {
+        const Radian ringAngle( Math::TWO_PI * Real( ring ) / Real( c_numRings ) );
+        for( uint32 side=0; side<c_numSides; ++side )
+        {
+            const Radian sideAngle( Math::TWO_PI * Real( side ) / Real( c_numSides ) );
+            const Real radius = 2.0f + Math::Cos( sideAngle );
+            mPositions.push_back( Vector3( radius * Math::Cos( ringAngle ),
+                                           Math::Sin( sideAngle ),
+                                           radius * Math::Sin( ringAngle ) ) );
+        }
+    }
+
+    for( uint32 ring=0; ring<c_numRings; ++ring )
+    {
+        const uint32 nextRing = (ring + 1u) % c_numRings;
+        for( uint32 side=0; side<c_numSides; ++side )
+        {
+            const uint32 nextSide = (side + 1u) % c_numSides;
+            const uint32 v0 = ring * c_numSides + side;
+            const uint32 v1 = nextRing * c_numSides + side;
+            const uint32 v2 = nextRing * c_numSides + nextSide;
+            const uint32 v3 = ring * c_numSides + nextSide;
+            const uint32 quad[6] = { v0, v1, v2, v0, v2, v3 };
+            mIndices.insert( mIndices.end(), quad, quad + 6 );
+        }
+    }
+
+    //Shuffle the triangles
+    uint32 seed = 12345u;
+    const size_t numTriangles = mIndices.size() / 3u;
+    for( size_t i=numTriangles - 1u; i>0; --i )
+    {
+        const size_t j = nextRandom( seed ) % (i + 1u);
+        for( size_t k=0; k<3u; ++k )
+            std::swap( mIndices[i * 3u + k], mIndices[j * 3u + k] );
+    }
+}
+//--------------------------------------------------------------------------
+void VertexCacheOptimizerTests::tearDown()
+{
+    mPositions.clear();
+    mIndices.clear();
+}
+//--------------------------------------------------------------------------
+bool VertexCacheOptimizerTests::sameTriangles( const IndexVec &a, const IndexVec &b )
+{
+    return a.size() == b.size() && toSortedTriangles( a ) == toSortedTriangles( b );
+}
+//--------------------------------------------------------------------------
+void VertexCacheOptimizerTests::testTipsifyImprovesAcmr()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const uint32 numVertices = static_cast<uint32>( mPositions.size() );
+
+    IndexVec optimised( mIndices.size() );
+    ClusterStartVec clusterStarts;
+    VertexCacheOptimizer::tipsify( &mIndices[0], mIndices.size(), numVertices, c_cacheSize,
+                                   &optimised[0], &clusterStarts );
+
+    CPPUNIT_ASSERT( sameTriangles( mIndices, optimised ) );
+
+    const VertexCacheOptimizer::CacheStats before =
+            VertexCacheOptimizer::simulateFifoCache( &mIndices[0], mIndices.size(),
+                                                     numVertices, c_cacheSize );
+    const VertexCacheOptimizer::CacheStats after =
+            VertexCacheOptimizer::simulateFifoCache( &optimised[0], optimised.size(),
+                                                     numVertices, c_cacheSize );
+
+    CPPUNIT_ASSERT_EQUAL( mIndices.size() / 3u, after.numTriangles );
+    CPPUNIT_ASSERT_EQUAL( mPositions.size(), after.numUniqueVertices );
+    CPPUNIT_ASSERT( before.getAcmr() > 1.5f );
+    CPPUNIT_ASSERT( after.getAcmr() < 1.0f );
+    CPPUNIT_ASSERT( after.getAcmr() < before.getAcmr() * 0.5f );
+    CPPUNIT_ASSERT( after.getAtvr() < before.getAtvr() );
+
+    CPPUNIT_ASSERT( !clusterStarts.empty() );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0u, clusterStarts[0] );
+    for( size_t i=1; i<clusterStarts.size(); ++i )
+    {
+        CPPUNIT_ASSERT( clusterStarts[i] > clusterStarts[i - 1u] );
+        CPPUNIT_ASSERT( clusterStarts[i] < optimised.size() );
+        CPPUNIT_ASSERT_EQUAL( (size_t)0u, clusterStarts[i] % 3u );
+    }
+}
+//--------------------------------------------------------------------------
+void VertexCacheOptimizerTests::testSplitClusters()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const uint32 numVertices = static_cast<uint32>( mPositions.size() );
+
+    IndexVec optimised( mIndices.size() );
+    ClusterStartVec clusterStarts;
+    VertexCacheOptimizer::tipsify( &mIndices[0], mIndices.size(), numVertices, c_cacheSize,
+                                   &optimised[0], &clusterStarts );
+
+    ClusterStartVec splitStarts( clusterStarts );
+    VertexCacheOptimizer::splitClusters( &optimised[0], optimised.size(), numVertices,
+                                         c_cacheSize, 0.75f, splitStarts );
+
+    //Only adds boundaries, never removes them
+    CPPUNIT_ASSERT( splitStarts.size() > clusterStarts.size() );
+    CPPUNIT_ASSERT( std::includes( splitStarts.begin(), splitStarts.end(),
+                                   clusterStarts.begin(), clusterStarts.end() ) );
+    for( size_t i=1; i<splitStarts.size(); ++i )
+    {
+        //New boundaries are placed once the cache had time to warm up
+        const bool isNew = !std::binary_search( clusterStarts.begin(), clusterStarts.end(),
+                                                splitStarts[i] );
+        if( isNew )
+            CPPUNIT_ASSERT( splitStarts[i] - splitStarts[i - 1u] >= c_cacheSize * 3u );
+        CPPUNIT_ASSERT( splitStarts[i] > splitStarts[i - 1u] );
+        CPPUNIT_ASSERT_EQUAL( (size_t)0u, splitStarts[i] % 3u );
+    }
+    CPPUNIT_ASSERT( splitStarts.back() < optimised.size() );
+}
+//--------------------------------------------------------------------------
+void VertexCacheOptimizerTests::testOverdrawOrderKeepsClusters()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const uint32 numVertices = static_cast<uint32>( mPositions.size() );
+
+    IndexVec optimised( mIndices.size() );
+    ClusterStartVec clusterStarts;
+    VertexCacheOptimizer::tipsify( &mIndices[0], mIndices.size(), numVertices, c_cacheSize,
+                                   &optimised[0], &clusterStarts );
+    VertexCacheOptimizer::splitClusters( &optimised[0], optimised.size(), numVertices,
+                                         c_cacheSize, 0.75f, clusterStarts );
+
+    IndexVec reordered( optimised );
+    VertexCacheOptimizer::reorderClustersForOverdraw( &reordered[0], reordered.size(),
+                                                      &mPositions[0], clusterStarts );
+
+    CPPUNIT_ASSERT( sameTriangles( mIndices, reordered ) );
+
+    //Every cluster must appear as a whole
+    vector<bool>::type clusterUsed( clusterStarts.size(), false );
+    size_t outIdx = 0;
+    while( outIdx < reordered.size() )
+    {
+        bool found = false;
+        for( size_t i=0; i<clusterStarts.size() && !found; ++i )
+        {
+            const size_t start = clusterStarts[i];
+            const size_t end = (i + 1u) < clusterStarts.size() ? clusterStarts[i + 1u] :
+                                                                 optimised.size();
+            if( !clusterUsed[i] && outIdx + (end - start) <= reordered.size() &&
+                std::equal( optimised.begin() + start, optimised.begin() + end,
+                            reordered.begin() + outIdx ) )
+            {
+                clusterUsed[i] = true;
+                outIdx += end - start;
+                found = true;
+            }
+        }
+        CPPUNIT_ASSERT( found );
+    }
+
+    //Moving whole clusters keeps most of the cache locality: at worst each
+    //cluster starts with a cold cache.
+    const VertexCacheOptimizer::CacheStats before =
+            VertexCacheOptimizer::simulateFifoCache( &mIndices[0], mIndices.size(),
+                                                     numVertices, c_cacheSize );
+    const VertexCacheOptimizer::CacheStats clustered =
+            VertexCacheOptimizer::simulateFifoCache( &optimised[0], optimised.size(),
+                                                     numVertices, c_cacheSize );
+    const VertexCacheOptimizer::CacheStats after =
+            VertexCacheOptimizer::simulateFifoCache( &reordered[0], reordered.size(),
+                                                     numVertices, c_cacheSize );
+    CPPUNIT_ASSERT( after.numCacheMisses <=
+                    clustered.numCacheMisses + clusterStarts.size() * c_cacheSize );
+    CPPUNIT_ASSERT( after.getAcmr() < before.getAcmr() * 0.5f );
+}
+//--------------------------------------------------------------------------
+void VertexCacheOptimizerTests::testOutwardClustersFirst()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    //Two quads facing +Z. The one at z = -1 faces the centroid and could hide
+    //behind the one at z = +1, so it must be drawn last.
+    const Vector3 positions[8] =
+    {
+        Vector3( -1, -1, -1 ), Vector3( 1, -1, -1 ), Vector3( 1, 1, -1 ), Vector3( -1, 1, -1 ),
+        Vector3( -1, -1,  1 ), Vector3( 1, -1,  1 ), Vector3( 1, 1,  1 ), Vector3( -1, 1,  1 )
+    };
+    const uint32 indices[12] = { 0, 1, 2, 0, 2, 3, 4, 5, 6, 4, 6, 7 };
+
+    IndexVec reordered( indices, indices + 12 );
+    ClusterStartVec clusterStarts;
+    clusterStarts.push_back( 0 );
+    clusterStarts.push_back( 6 );
+    VertexCacheOptimizer::reorderClustersForOverdraw( &reordered[0], reordered.size(),
+                                                      positions, clusterStarts );
+
+    CPPUNIT_ASSERT( std::equal( indices + 6, indices + 12, reordered.begin() ) );
+    CPPUNIT_ASSERT( std::equal( indices, indices + 6, reordered.begin() + 6 ) );
+
+    //A single cluster is left alone
+    clusterStarts.pop_back();
+    IndexVec untouched( indices, indices + 12 );
+    VertexCacheOptimizer::reorderClustersForOverdraw( &untouched[0], untouched.size(),
+                                                      positions, clusterStarts );
+    CPPUNIT_ASSERT( std::equal( indices, indices + 12, untouched.begin() ) );
+}
+//--------------------------------------------------------------------------
+void VertexCacheOptimizerTests::testFirstUseRemap()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    //One vertex that no index refers to at the front, and one only the lower LOD uses
+    //at the back. numVertices doesn't count the latter.
+    const uint32 numVertices = static_cast<uint32>( mPositions.size() ) + 1u;
+    vector<Vector3>::type positions;
+    positions.reserve( numVertices );
+    positions.push_back( Vector3( 100, 100, 100 ) );
+    positions.insert( positions.end(), mPositions.begin(), mPositions.end() );
+
+    IndexVec lod0( mIndices );
+    for( size_t i=0; i<lod0.size(); ++i )
+        ++lod0[i];
+    //A lower LOD, using the first half of the triangles and one vertex LOD 0 doesn't use
+    IndexVec lod1( lod0.begin(), lod0.begin() + (lod0.size() / 6u) * 3u );
+    const uint32 lod1Only = static_cast<uint32>( positions.size() );
+    positions.push_back( Vector3( 200, 200, 200 ) );
+    lod1[0] = lod1Only;
+
+    vector<uint32>::type remap( positions.size(), ~0u );
+    uint32 nextVertex = 0;
+    VertexCacheOptimizer::buildFirstUseRemap( &lod0[0], lod0.size(), remap, nextVertex );
+    CPPUNIT_ASSERT_EQUAL( numVertices - 1u, nextVertex );
+    VertexCacheOptimizer::buildFirstUseRemap( &lod1[0], lod1.size(), remap, nextVertex );
+    CPPUNIT_ASSERT_EQUAL( numVertices, nextVertex );
+    CPPUNIT_ASSERT_EQUAL( numVertices - 1u, remap[lod1Only] );
+    VertexCacheOptimizer::finishVertexRemap( remap, nextVertex );
+    CPPUNIT_ASSERT_EQUAL( numVertices + 1u, nextVertex );
+    CPPUNIT_ASSERT_EQUAL( numVertices, remap[0] );
+
+    //It's a permutation
+    vector<uint32>::type sortedRemap( remap );
+    std::sort( sortedRemap.begin(), sortedRemap.end() );
+    for( uint32 i=0; i<sortedRemap.size(); ++i )
+        CPPUNIT_ASSERT_EQUAL( i, sortedRemap[i] );
+
+    //LOD 0 now uses its vertices in ascending order
+    uint32 nextExpected = 0;
+    for( size_t i=0; i<lod0.size(); ++i )
+    {
+        const uint32 v = remap[lod0[i]];
+        CPPUNIT_ASSERT( v <= nextExpected );
+        if( v == nextExpected )
+            ++nextExpected;
+    }
+
+    vector<Vector3>::type remapped( positions.size() );
+    VertexCacheOptimizer::remapVertices( reinterpret_cast<uint8*>( &remapped[0] ),
+                                         reinterpret_cast<const uint8*>( &positions[0] ),
+                                         sizeof(Vector3), remap );
+    for( size_t i=0; i<lod0.size(); ++i )
+        CPPUNIT_ASSERT( remapped[remap[lod0[i]]] == positions[lod0[i]] );
+    CPPUNIT_ASSERT( remapped[numVertices] == positions[0] );
+    CPPUNIT_ASSERT( remapped[numVertices - 1u] == positions[lod1Only] );
+}
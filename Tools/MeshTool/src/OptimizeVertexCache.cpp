@@ -0,0 +1,725 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreMesh.h"
+#include "OgreSubMesh.h"
+#include "OgreBitwise.h"
+#include "OgreStringConverter.h"
+#include "OgreVertexIndexData.h"
+#include "OgreHardwareVertexBuffer.h"
+#include "OgreHardwareIndexBuffer.h"
+
+#include "Vao/OgreAsyncTicket.h"
+#include "Vao/OgreVaoManager.h"
+#include "Vao/OgreVertexArrayObject.h"
+#include "OgreMesh2.h"
+#include "OgreSubMesh2.h"
+
+#include <iostream>
+#include <iomanip>
+
+#include "UpgradeOptions.h"
+#include "VertexCacheOptimizer.h"
+
+using namespace Ogre;
+
+/// Below this local ACMR a Tipsify cluster is split further for the overdraw pass.
+static const Real c_overdrawAcmrThreshold = 0.75f;
+
+struct CacheReport
+{
+    VertexCacheOptimizer::CacheStats before;
+    VertexCacheOptimizer::CacheStats after;
+};
+
+static CacheReport g_totalReport;
+
+static void printCacheReport( const String &name, const CacheReport &report )
+{
+    std::cout << "  " << name << ": " << report.before.numTriangles << " tris, "
+         << std::fixed << std::setprecision( 3 )
+         << "ACMR " << report.before.getAcmr() << " -> " << report.after.getAcmr() << ", "
+         << "ATVR " << report.before.getAtvr() << " -> " << report.after.getAtvr() << std::endl;
+    std::cout.unsetf( std::ios_base::floatfield );
+    std::cout << std::setprecision( 6 );
+}
+
+static void accumulateReport( CacheReport &dst, const CacheReport &src )
+{
+    dst.before.numTriangles         += src.before.numTriangles;
+    dst.before.numUniqueVertices    += src.before.numUniqueVertices;
+    dst.before.numCacheMisses       += src.before.numCacheMisses;
+    dst.after.numTriangles          += src.after.numTriangles;
+    dst.after.numUniqueVertices     += src.after.numUniqueVertices;
+    dst.after.numCacheMisses        += src.after.numCacheMisses;
+}
+
+/** Runs the triangle reordering (and optionally the overdraw pass) on a single index list.
+@param positions
+    May be null, in which case the overdraw pass is skipped.
+*/
+static void optimizeTriangleOrder( vector<uint32>::type &indices, uint32 numVertices,
+                                   const vector<Vector3>::type *positions )
+{
+    vector<uint32>::type reordered( indices.size() );
+    vector<size_t>::type clusterStarts;
+
+    VertexCacheOptimizer::tipsify( &indices[0], indices.size(), numVertices, opts.vertexCacheSize,
+                                   &reordered[0], opts.optimizeOverdraw ? &clusterStarts : 0 );
+
+    if( opts.optimizeOverdraw && positions && !positions->empty() )
+    {
+        VertexCacheOptimizer::splitClusters( &reordered[0], reordered.size(), numVertices,
+                                             opts.vertexCacheSize, c_overdrawAcmrThreshold,
+                                             clusterStarts );
+        VertexCacheOptimizer::reorderClustersForOverdraw( &reordered[0], reordered.size(),
+                                                          &(*positions)[0], clusterStarts );
+    }
+
+    indices.swap( reordered );
+}
+
+static VertexCacheOptimizer::CacheStats measure( const vector<uint32>::type &indices,
+                                                 uint32 numVertices )
+{
+    if( indices.empty() )
+        return VertexCacheOptimizer::CacheStats();
+
+    return VertexCacheOptimizer::simulateFifoCache( &indices[0], indices.size(),
+                                                    numVertices, opts.vertexCacheSize );
+}
+
+static void readPosition( const uint8 *src, VertexElementType type, Vector3 &outPos )
+{
+    if( v1::VertexElement::getBaseType( type ) == VET_HALF2 )
+    {
+        const uint16 *halfData = reinterpret_cast<const uint16*>( src );
+        outPos.x = Bitwise::halfToFloat( halfData[0] );
+        outPos.y = Bitwise::halfToFloat( halfData[1] );
+        outPos.z = Bitwise::halfToFloat( halfData[2] );
+    }
+    else
+    {
+        const float *fpData = reinterpret_cast<const float*>( src );
+        outPos.x = fpData[0];
+        outPos.y = fpData[1];
+        outPos.z = fpData[2];
+    }
+}
+
+static bool isReadablePosition( VertexElementType type )
+{
+    const VertexElementType baseType = v1::VertexElement::getBaseType( type );
+    return (baseType == VET_FLOAT1 || baseType == VET_HALF2) &&
+            v1::VertexElement::getTypeCount( type ) >= 3;
+}
+
+//-----------------------------------------------------------------------------
+//  v1
+//-----------------------------------------------------------------------------
+static void readIndices( v1::IndexData *indexData, vector<uint32>::type &outIndices )
+{
+    outIndices.resize( indexData->indexCount );
+    if( !indexData->indexCount )
+        return;
+
+    v1::HardwareIndexBuffer *indexBuffer = indexData->indexBuffer.get();
+    const void *data = indexBuffer->lock( indexData->indexStart * indexBuffer->getIndexSize(),
+                                          indexData->indexCount * indexBuffer->getIndexSize(),
+                                          v1::HardwareBuffer::HBL_READ_ONLY );
+
+    if( indexBuffer->getType() == v1::HardwareIndexBuffer::IT_16BIT )
+    {
+        const uint16 *src = reinterpret_cast<const uint16*>( data );
+        for( size_t i=0; i<indexData->indexCount; ++i )
+            outIndices[i] = src[i];
+    }
+    else
+    {
+        const uint32 *src = reinterpret_cast<const uint32*>( data );
+        memcpy( &outIndices[0], src, indexData->indexCount * sizeof(uint32) );
+    }
+
+    indexBuffer->unlock();
+}
+
+static void writeIndices( v1::IndexData *indexData, const vector<uint32>::type &indices )
+{
+    if( !indexData->indexCount )
+        return;
+
+    v1::HardwareIndexBuffer *indexBuffer = indexData->indexBuffer.get();
+    void *data = indexBuffer->lock( indexData->indexStart * indexBuffer->getIndexSize(),
+                                    indexData->indexCount * indexBuffer->getIndexSize(),
+                                    v1::HardwareBuffer::HBL_NORMAL );
+
+    if( indexBuffer->getType() == v1::HardwareIndexBuffer::IT_16BIT )
+    {
+        uint16 *dst = reinterpret_cast<uint16*>( data );
+        for( size_t i=0; i<indexData->indexCount; ++i )
+            dst[i] = static_cast<uint16>( indices[i] );
+    }
+    else
+    {
+        memcpy( data, &indices[0], indexData->indexCount * sizeof(uint32) );
+    }
+
+    indexBuffer->unlock();
+}
+
+static void readPositions( const v1::VertexData *vertexData, vector<Vector3>::type &outPositions )
+{
+    outPositions.clear();
+
+    const v1::VertexElement *posElem =
+            vertexData->vertexDeclaration->findElementBySemantic( VES_POSITION );
+    if( !posElem || !isReadablePosition( posElem->getType() ) )
+        return;
+
+    v1::HardwareVertexBufferSharedPtr buffer =
+            vertexData->vertexBufferBinding->getBuffer( posElem->getSource() );
+    const size_t vertexSize = buffer->getVertexSize();
+    const uint8 *data = reinterpret_cast<const uint8*>(
+                buffer->lock( vertexData->vertexStart * vertexSize, vertexData->vertexCount * vertexSize,
+                              v1::HardwareBuffer::HBL_READ_ONLY ) );
+
+    outPositions.resize( vertexData->vertexCount );
+    for( size_t i=0; i<vertexData->vertexCount; ++i )
+        readPosition( data + i * vertexSize + posElem->getOffset(), posElem->getType(), outPositions[i] );
+
+    buffer->unlock();
+}
+
+static void remapVertexData( v1::VertexData *vertexData, const vector<uint32>::type &remap )
+{
+    const v1::VertexBufferBinding::VertexBufferBindingMap &bindings =
+            vertexData->vertexBufferBinding->getBindings();
+
+    v1::VertexBufferBinding::VertexBufferBindingMap::const_iterator itor = bindings.begin();
+    v1::VertexBufferBinding::VertexBufferBindingMap::const_iterator end  = bindings.end();
+
+    while( itor != end )
+    {
+        v1::HardwareVertexBuffer *buffer = itor->second.get();
+        const size_t vertexSize = buffer->getVertexSize();
+
+        vector<uint8>::type srcCopy( vertexData->vertexCount * vertexSize );
+        uint8 *data = reinterpret_cast<uint8*>(
+                    buffer->lock( vertexData->vertexStart * vertexSize,
+                                  vertexData->vertexCount * vertexSize,
+                                  v1::HardwareBuffer::HBL_NORMAL ) );
+        memcpy( &srcCopy[0], data, srcCopy.size() );
+        VertexCacheOptimizer::remapVertices( data, &srcCopy[0], vertexSize, remap );
+        buffer->unlock();
+
+        ++itor;
+    }
+}
+
+static void remapIndexBuffer( v1::HardwareIndexBuffer *indexBuffer,
+                              const vector<bool>::type &usedRanges,
+                              const vector<uint32>::type &remap )
+{
+    void *data = indexBuffer->lock( v1::HardwareBuffer::HBL_NORMAL );
+
+    if( indexBuffer->getType() == v1::HardwareIndexBuffer::IT_16BIT )
+    {
+        uint16 *indices = reinterpret_cast<uint16*>( data );
+        for( size_t i=0; i<indexBuffer->getNumIndexes(); ++i )
+        {
+            if( usedRanges[i] )
+                indices[i] = static_cast<uint16>( remap[indices[i]] );
+        }
+    }
+    else
+    {
+        uint32 *indices = reinterpret_cast<uint32*>( data );
+        for( size_t i=0; i<indexBuffer->getNumIndexes(); ++i )
+        {
+            if( usedRanges[i] )
+                indices[i] = remap[indices[i]];
+        }
+    }
+
+    indexBuffer->unlock();
+}
+
+static void optimizeVertexCache( v1::Mesh *mesh, v1::SubMesh *subMesh, VertexPass vertexPass,
+                                 const String &subMeshName )
+{
+    v1::VertexData *vertexData = subMesh->useSharedVertices ? mesh->sharedVertexData[vertexPass] :
+                                                              subMesh->vertexData[vertexPass];
+
+    if( subMesh->operationType != OT_TRIANGLE_LIST || !vertexData || !vertexData->vertexCount )
+    {
+        std::cout << "  " << subMeshName << ": not an indexed triangle list. Skipping." << std::endl;
+        return;
+    }
+
+    //LOD 0 followed by the rest of the LODs
+    typedef vector<v1::IndexData*>::type IndexDataVec;
+    IndexDataVec lods;
+    lods.push_back( subMesh->indexData[vertexPass] );
+    lods.insert( lods.end(), subMesh->mLodFaceList[vertexPass].begin(),
+                 subMesh->mLodFaceList[vertexPass].end() );
+
+    //Compressed LODs share the same index buffer with overlapping
+    //ranges. We can't reorder those triangles without breaking the others.
+    typedef map<v1::HardwareIndexBuffer*, size_t>::type IndexBufferRefMap;
+    IndexBufferRefMap indexBufferRefs;
+    for( size_t i=0; i<lods.size(); ++i )
+    {
+        if( !lods[i] || lods[i]->indexBuffer.isNull() )
+        {
+            std::cout << "  " << subMeshName << ": missing index data. Skipping." << std::endl;
+            return;
+        }
+        ++indexBufferRefs[lods[i]->indexBuffer.get()];
+    }
+
+    const uint32 numVertices = static_cast<uint32>( vertexData->vertexCount );
+
+    vector<Vector3>::type positions;
+    if( opts.optimizeOverdraw )
+        readPositions( vertexData, positions );
+
+    vector< vector<uint32>::type >::type lodIndices( lods.size() );
+
+    for( size_t i=0; i<lods.size(); ++i )
+    {
+        readIndices( lods[i], lodIndices[i] );
+
+        CacheReport report;
+        report.before = measure( lodIndices[i], numVertices );
+
+        if( indexBufferRefs[lods[i]->indexBuffer.get()] == 1u && !lodIndices[i].empty() &&
+            (lodIndices[i].size() % 3u) == 0 )
+        {
+            optimizeTriangleOrder( lodIndices[i], numVertices, &positions );
+            writeIndices( lods[i], lodIndices[i] );
+        }
+        else if( !lodIndices[i].empty() )
+        {
+            std::cout << "  " << subMeshName << " LOD " << i << ": index buffer is shared with other "
+                    "LODs. Triangle order left untouched." << std::endl;
+        }
+
+        report.after = measure( lodIndices[i], numVertices );
+        printCacheReport( subMeshName + " LOD " + StringConverter::toString( i ), report );
+        accumulateReport( g_totalReport, report );
+    }
+
+    //Vertex fetch locality. Shared vertices and vertex animation refer to
+    //vertex indices from places we can't patch; leave the vertex order alone.
+    if( subMesh->useSharedVertices || mesh->getPoseCount() > 0 || mesh->hasVertexAnimation() )
+        return;
+    if( vertexPass == VpShadow && vertexData == subMesh->vertexData[VpNormal] )
+        return;
+
+    vector<uint32>::type remap( numVertices, ~0u );
+    uint32 nextVertex = 0;
+    for( size_t i=0; i<lodIndices.size(); ++i )
+    {
+        if( !lodIndices[i].empty() )
+        {
+            VertexCacheOptimizer::buildFirstUseRemap( &lodIndices[i][0], lodIndices[i].size(),
+                                                      remap, nextVertex );
+        }
+    }
+    VertexCacheOptimizer::finishVertexRemap( remap, nextVertex );
+
+    remapVertexData( vertexData, remap );
+
+    //Patch each index buffer once, even if several LODs share it
+    typedef map< v1::HardwareIndexBuffer*, vector<bool>::type >::type UsedRangesMap;
+    UsedRangesMap usedRanges;
+    for( size_t i=0; i<lods.size(); ++i )
+    {
+        v1::HardwareIndexBuffer *indexBuffer = lods[i]->indexBuffer.get();
+        vector<bool>::type &used = usedRanges[indexBuffer];
+        used.resize( indexBuffer->getNumIndexes(), false );
+        std::fill( used.begin() + lods[i]->indexStart,
+                   used.begin() + lods[i]->indexStart + lods[i]->indexCount, true );
+    }
+
+    UsedRangesMap::const_iterator itor = usedRanges.begin();
+    UsedRangesMap::const_iterator end  = usedRanges.end();
+    while( itor != end )
+    {
+        remapIndexBuffer( itor->first, itor->second, remap );
+        ++itor;
+    }
+
+    if( vertexPass == VpNormal && !subMesh->getBoneAssignments().empty() )
+    {
+        v1::SubMesh::VertexBoneAssignmentList oldAssignments = subMesh->getBoneAssignments();
+        subMesh->clearBoneAssignments();
+
+        v1::SubMesh::VertexBoneAssignmentList::const_iterator itAssign = oldAssignments.begin();
+        v1::SubMesh::VertexBoneAssignmentList::const_iterator enAssign = oldAssignments.end();
+        while( itAssign != enAssign )
+        {
+            v1::VertexBoneAssignment assignment = itAssign->second;
+            assignment.vertexIndex = remap[assignment.vertexIndex];
+            subMesh->addBoneAssignment( assignment );
+            ++itAssign;
+        }
+    }
+}
+
+static void optimizeVertexCache( v1::Mesh *mesh )
+{
+    for( unsigned short i=0; i<mesh->getNumSubMeshes(); ++i )
+    {
+        v1::SubMesh *subMesh = mesh->getSubMesh( i );
+        const String subMeshName = "SubMesh " + StringConverter::toString( i );
+
+        optimizeVertexCache( mesh, subMesh, VpNormal, subMeshName );
+
+        const bool independentShadowPass = subMesh->indexData[VpShadow] &&
+                subMesh->indexData[VpShadow] != subMesh->indexData[VpNormal];
+        if( independentShadowPass )
+            optimizeVertexCache( mesh, subMesh, VpShadow, subMeshName + " (shadow caster)" );
+    }
+
+    //Edge lists index triangles and vertices; they're stale now.
+    if( mesh->isEdgeListBuilt() )
+    {
+        mesh->freeEdgeList();
+        mesh->buildEdgeList();
+    }
+}
+
+//-----------------------------------------------------------------------------
+//  v2
+//-----------------------------------------------------------------------------
+static void readIndices( const IndexBufferPacked *indexBuffer, vector<uint32>::type &outIndices )
+{
+    outIndices.resize( indexBuffer->getNumElements() );
+    if( outIndices.empty() )
+        return;
+
+    IndexBufferPacked *nonConstBuffer = const_cast<IndexBufferPacked*>( indexBuffer );
+    AsyncTicketPtr asyncTicket = nonConstBuffer->readRequest( 0, indexBuffer->getNumElements() );
+    const void *data = asyncTicket->map();
+
+    if( indexBuffer->getIndexType() == IndexBufferPacked::IT_16BIT )
+    {
+        const uint16 *src = reinterpret_cast<const uint16*>( data );
+        for( size_t i=0; i<outIndices.size(); ++i )
+            outIndices[i] = src[i];
+    }
+    else
+    {
+        memcpy( &outIndices[0], data, outIndices.size() * sizeof(uint32) );
+    }
+
+    asyncTicket->unmap();
+}
+
+static IndexBufferPacked* createIndexBuffer( const IndexBufferPacked *origIndexBuffer,
+                                             const vector<uint32>::type &indices,
+                                             VaoManager *vaoManager )
+{
+    void *data = OGRE_MALLOC_SIMD( origIndexBuffer->getTotalSizeBytes(), MEMCATEGORY_GEOMETRY );
+    FreeOnDestructor dataPtrContainer( data );
+
+    if( origIndexBuffer->getIndexType() == IndexBufferPacked::IT_16BIT )
+    {
+        uint16 *dst = reinterpret_cast<uint16*>( data );
+        for( size_t i=0; i<indices.size(); ++i )
+            dst[i] = static_cast<uint16>( indices[i] );
+    }
+    else if( !indices.empty() )
+    {
+        memcpy( data, &indices[0], indices.size() * sizeof(uint32) );
+    }
+
+    const bool keepAsShadow = origIndexBuffer->getShadowCopy() != 0;
+    IndexBufferPacked *retVal = vaoManager->createIndexBuffer( origIndexBuffer->getIndexType(),
+                                                               origIndexBuffer->getNumElements(),
+                                                               origIndexBuffer->getBufferType(),
+                                                               data, keepAsShadow );
+    if( keepAsShadow ) //Don't free the pointer ourselves
+        dataPtrContainer.ptr = 0;
+
+    return retVal;
+}
+
+static VertexBufferPacked* createRemappedVertexBuffer( VertexBufferPacked *origVertexBuffer,
+                                                       const vector<uint32>::type &remap,
+                                                       VaoManager *vaoManager )
+{
+    const size_t bytesPerVertex = origVertexBuffer->getBytesPerElement();
+    void *data = OGRE_MALLOC_SIMD( origVertexBuffer->getTotalSizeBytes(), MEMCATEGORY_GEOMETRY );
+    FreeOnDestructor dataPtrContainer( data );
+
+    AsyncTicketPtr asyncTicket = origVertexBuffer->readRequest( 0, origVertexBuffer->getNumElements() );
+    VertexCacheOptimizer::remapVertices( reinterpret_cast<uint8*>( data ),
+                                         reinterpret_cast<const uint8*>( asyncTicket->map() ),
+                                         bytesPerVertex, remap );
+    asyncTicket->unmap();
+
+    const bool keepAsShadow = origVertexBuffer->getShadowCopy() != 0;
+    VertexBufferPacked *retVal = vaoManager->createVertexBuffer( origVertexBuffer->getVertexElements(),
+                                                                 origVertexBuffer->getNumElements(),
+                                                                 origVertexBuffer->getBufferType(),
+                                                                 data, keepAsShadow );
+    if( keepAsShadow ) //Don't free the pointer ourselves
+        dataPtrContainer.ptr = 0;
+
+    return retVal;
+}
+
+static void readPositions( const VertexArrayObject *vao, vector<Vector3>::type &outPositions )
+{
+    outPositions.clear();
+
+    size_t bufferIdx, elemOffset;
+    const VertexElement2 *vertexElement = vao->findBySemantic( VES_POSITION, bufferIdx, elemOffset );
+
+    if( !vertexElement || !isReadablePosition( vertexElement->mType ) )
+        return;
+
+    VertexBufferPacked *vertexBuffer = vao->getVertexBuffers()[bufferIdx];
+    AsyncTicketPtr asyncTicket = vertexBuffer->readRequest( 0, vertexBuffer->getNumElements() );
+    const uint8 *data = reinterpret_cast<const uint8*>( asyncTicket->map() );
+
+    const size_t bytesPerVertex = vertexBuffer->getBytesPerElement();
+    outPositions.resize( vertexBuffer->getNumElements() );
+    for( size_t i=0; i<outPositions.size(); ++i )
+        readPosition( data + i * bytesPerVertex + elemOffset, vertexElement->mType, outPositions[i] );
+
+    asyncTicket->unmap();
+}
+
+typedef map<VertexBufferPacked*, size_t>::type VertexBufferRefMap;
+
+static void optimizeVertexCache( SubMesh *subMesh, VertexPass vertexPass,
+                                 const VertexBufferRefMap &vertexBufferRefs,
+                                 VaoManager *vaoManager, const String &subMeshName )
+{
+    VertexArrayObjectArray &vaos = subMesh->mVao[vertexPass];
+    if( vaos.empty() )
+        return;
+
+    //All LODs must render indexed triangle lists out of the same vertex buffers,
+    //using their whole index buffer (which is what importV1 & the serializer produce).
+    const VertexBufferPackedVec &vertexBuffers = vaos[0]->getVertexBuffers();
+    for( size_t i=0; i<vaos.size(); ++i )
+    {
+        const VertexArrayObject *vao = vaos[i];
+        if( vao->getOperationType() != OT_TRIANGLE_LIST || !vao->getIndexBuffer() ||
+            vao->getVertexBuffers() != vertexBuffers ||
+            vao->getPrimitiveStart() != 0 ||
+            vao->getPrimitiveCount() != vao->getIndexBuffer()->getNumElements() ||
+            (vao->getPrimitiveCount() % 3u) != 0 )
+        {
+            std::cout << "  " << subMeshName << ": LOD " << i << " is not a plain indexed triangle list "
+                    "sharing the LOD 0 vertex buffers. Skipping." << std::endl;
+            return;
+        }
+    }
+
+    const uint32 numVertices = vertexBuffers[0]->getNumElements();
+
+    vector<Vector3>::type positions;
+    if( opts.optimizeOverdraw )
+        readPositions( vaos[0], positions );
+
+    vector< vector<uint32>::type >::type lodIndices( vaos.size() );
+
+    for( size_t i=0; i<vaos.size(); ++i )
+    {
+        readIndices( vaos[i]->getIndexBuffer(), lodIndices[i] );
+
+        CacheReport report;
+        report.before = measure( lodIndices[i], numVertices );
+        if( !lodIndices[i].empty() )
+            optimizeTriangleOrder( lodIndices[i], numVertices, &positions );
+        report.after = measure( lodIndices[i], numVertices );
+
+        printCacheReport( subMeshName + " LOD " + StringConverter::toString( i ), report );
+        accumulateReport( g_totalReport, report );
+    }
+
+    //Vertex buffers referenced by other submeshes or passes can't be reordered.
+    bool canRemapVertices = true;
+    for( size_t i=0; i<vertexBuffers.size(); ++i )
+    {
+        VertexBufferRefMap::const_iterator itRef = vertexBufferRefs.find( vertexBuffers[i] );
+        if( itRef != vertexBufferRefs.end() && itRef->second > 1u )
+            canRemapVertices = false;
+    }
+
+    VertexBufferPackedVec newVertexBuffers( vertexBuffers );
+
+    if( canRemapVertices )
+    {
+        vector<uint32>::type remap( numVertices, ~0u );
+        uint32 nextVertex = 0;
+        for( size_t i=0; i<lodIndices.size(); ++i )
+        {
+            if( !lodIndices[i].empty() )
+            {
+                VertexCacheOptimizer::buildFirstUseRemap( &lodIndices[i][0], lodIndices[i].size(),
+                                                          remap, nextVertex );
+            }
+        }
+        VertexCacheOptimizer::finishVertexRemap( remap, nextVertex );
+
+        for( size_t i=0; i<lodIndices.size(); ++i )
+        {
+            vector<uint32>::type::iterator itor = lodIndices[i].begin();
+            vector<uint32>::type::iterator end  = lodIndices[i].end();
+            while( itor != end )
+            {
+                *itor = remap[*itor];
+                ++itor;
+            }
+        }
+
+        for( size_t i=0; i<vertexBuffers.size(); ++i )
+            newVertexBuffers[i] = createRemappedVertexBuffer( vertexBuffers[i], remap, vaoManager );
+
+        const SubMesh::VertexBoneAssignmentVec oldAssignments = subMesh->getBoneAssignments();
+        if( vertexPass == VpNormal && !oldAssignments.empty() )
+        {
+            subMesh->clearBoneAssignments();
+            SubMesh::VertexBoneAssignmentVec::const_iterator itor = oldAssignments.begin();
+            SubMesh::VertexBoneAssignmentVec::const_iterator end  = oldAssignments.end();
+            while( itor != end )
+            {
+                VertexBoneAssignment assignment = *itor;
+                assignment.vertexIndex = remap[assignment.vertexIndex];
+                subMesh->addBoneAssignment( assignment );
+                ++itor;
+            }
+        }
+    }
+
+    VertexArrayObjectArray newVaos;
+    newVaos.reserve( vaos.size() );
+    for( size_t i=0; i<vaos.size(); ++i )
+    {
+        IndexBufferPacked *indexBuffer = createIndexBuffer( vaos[i]->getIndexBuffer(),
+                                                            lodIndices[i], vaoManager );
+        newVaos.push_back( vaoManager->createVertexArrayObject( newVertexBuffers, indexBuffer,
+                                                                vaos[i]->getOperationType() ) );
+    }
+
+    //Destroy the old Vaos. The vertex buffers are only ours to destroy if we replaced them.
+    for( size_t i=0; i<vaos.size(); ++i )
+    {
+        vaoManager->destroyIndexBuffer( vaos[i]->getIndexBuffer() );
+        vaoManager->destroyVertexArrayObject( vaos[i] );
+    }
+    if( canRemapVertices )
+    {
+        for( size_t i=0; i<vertexBuffers.size(); ++i )
+            vaoManager->destroyVertexBuffer( vertexBuffers[i] );
+    }
+
+    vaos.swap( newVaos );
+}
+
+static void optimizeVertexCache( Mesh *mesh )
+{
+    VaoManager *vaoManager = mesh->_getVaoManager();
+
+    //Count how many (submesh, pass) pairs use each vertex buffer
+    VertexBufferRefMap vertexBufferRefs;
+    for( uint32 i=0; i<mesh->getNumSubMeshes(); ++i )
+    {
+        SubMesh *subMesh = mesh->getSubMesh( i );
+        for( size_t pass=0; pass<NumVertexPass; ++pass )
+        {
+            if( pass == VpShadow && !subMesh->mVao[VpShadow].empty() &&
+                !subMesh->mVao[VpNormal].empty() &&
+                subMesh->mVao[VpShadow][0] == subMesh->mVao[VpNormal][0] )
+            {
+                continue;
+            }
+
+            set<VertexBufferPacked*>::type buffersInPass;
+            VertexArrayObjectArray::const_iterator itor = subMesh->mVao[pass].begin();
+            VertexArrayObjectArray::const_iterator end  = subMesh->mVao[pass].end();
+            while( itor != end )
+            {
+                const VertexBufferPackedVec &vertexBuffers = (*itor)->getVertexBuffers();
+                buffersInPass.insert( vertexBuffers.begin(), vertexBuffers.end() );
+                ++itor;
+            }
+
+            set<VertexBufferPacked*>::type::const_iterator itBuf = buffersInPass.begin();
+            set<VertexBufferPacked*>::type::const_iterator enBuf = buffersInPass.end();
+            while( itBuf != enBuf )
+                ++vertexBufferRefs[*itBuf++];
+        }
+    }
+
+    for( uint32 i=0; i<mesh->getNumSubMeshes(); ++i )
+    {
+        SubMesh *subMesh = mesh->getSubMesh( i );
+        const String subMeshName = "SubMesh " + StringConverter::toString( i );
+
+        const bool sharedShadowVaos = subMesh->mVao[VpShadow].empty() ||
+                                      subMesh->mVao[VpNormal].empty() ||
+                                      subMesh->mVao[VpShadow][0] == subMesh->mVao[VpNormal][0];
+
+        optimizeVertexCache( subMesh, VpNormal, vertexBufferRefs, vaoManager, subMeshName );
+
+        if( sharedShadowVaos )
+        {
+            if( !subMesh->mVao[VpShadow].empty() )
+                subMesh->mVao[VpShadow] = subMesh->mVao[VpNormal];
+        }
+        else
+        {
+            optimizeVertexCache( subMesh, VpShadow, vertexBufferRefs,
+                                 vaoManager, subMeshName + " (shadow caster)" );
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+void optimizeVertexCache( v1::MeshPtr &v1Mesh, MeshPtr &v2Mesh )
+{
+    g_totalReport = CacheReport();
+
+    std::cout << "\nOptimizing for a post-transform cache of " << opts.vertexCacheSize << " vertices";
+    if( opts.optimizeOverdraw )
+        std::cout << " and overdraw";
+    std::cout << "..." << std::endl;
+
+    if( !v1Mesh.isNull() )
+        optimizeVertexCache( v1Mesh.get() );
+    if( !v2Mesh.isNull() )
+        optimizeVertexCache( v2Mesh.get() );
+
+    printCacheReport( "Total", g_totalReport );
+}
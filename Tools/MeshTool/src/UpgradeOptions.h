@@ -43,6 +43,10 @@ struct UpgradeOptions
     bool qTangents;
     bool optimizeForShadowMapping;
     bool stripShadowMapping;
+    bool optimizeVertexCache;
+    bool optimizeOverdraw;
+    Ogre::uint32 vertexCacheSize;
+    bool compressBuffers;
 };
 
 extern UpgradeOptions opts;
@@ -0,0 +1,367 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "VertexCacheOptimizer.h"
+
+#include <algorithm>
+#include <limits>
+#include <string.h>
+
+using namespace Ogre;
+
+namespace VertexCacheOptimizer
+{
+    Real CacheStats::getAcmr(void) const
+    {
+        return numTriangles ? Real( numCacheMisses ) / Real( numTriangles ) : Real( 0 );
+    }
+    //-------------------------------------------------------------------------
+    Real CacheStats::getAtvr(void) const
+    {
+        return numUniqueVertices ? Real( numCacheMisses ) / Real( numUniqueVertices ) : Real( 0 );
+    }
+    //-------------------------------------------------------------------------
+    CacheStats simulateFifoCache( const uint32 *indices, size_t numIndices,
+                                  uint32 numVertices, uint32 cacheSize )
+    {
+        CacheStats retVal;
+        retVal.numTriangles = numIndices / 3u;
+
+        //A vertex is in the cache if it was pushed less than cacheSize pushes ago.
+        vector<uint32>::type cacheTimeStamp( numVertices, 0 );
+        vector<bool>::type used( numVertices, false );
+        uint32 timeStamp = cacheSize + 1u;
+
+        for( size_t i=0; i<numIndices; ++i )
+        {
+            const uint32 v = indices[i];
+            if( timeStamp - cacheTimeStamp[v] > cacheSize )
+            {
+                cacheTimeStamp[v] = timeStamp++;
+                ++retVal.numCacheMisses;
+            }
+
+            if( !used[v] )
+            {
+                used[v] = true;
+                ++retVal.numUniqueVertices;
+            }
+        }
+
+        return retVal;
+    }
+    //-------------------------------------------------------------------------
+    static uint32 skipDeadEnd( vector<uint32>::type &deadEndStack,
+                               const vector<uint32>::type &liveTriCount,
+                               uint32 &inOutCursor )
+    {
+        //Try the recently used vertices first
+        while( !deadEndStack.empty() )
+        {
+            const uint32 v = deadEndStack.back();
+            deadEndStack.pop_back();
+            if( liveTriCount[v] > 0 )
+                return v;
+        }
+
+        //Then fall back to the next vertex in input order with triangles left
+        const uint32 numVertices = static_cast<uint32>( liveTriCount.size() );
+        while( inOutCursor < numVertices )
+        {
+            if( liveTriCount[inOutCursor] > 0 )
+                return inOutCursor;
+            ++inOutCursor;
+        }
+
+        return ~0u;
+    }
+    //-------------------------------------------------------------------------
+    void tipsify( const uint32 *indices, size_t numIndices, uint32 numVertices,
+                  uint32 cacheSize, uint32 *outIndices, vector<size_t>::type *outClusterStarts )
+    {
+        const size_t numTriangles = numIndices / 3u;
+
+        //Build vertex -> triangle adjacency
+        vector<uint32>::type liveTriCount( numVertices, 0 );
+        for( size_t i=0; i<numTriangles * 3u; ++i )
+            ++liveTriCount[indices[i]];
+
+        vector<uint32>::type adjOffsets( numVertices + 1u, 0 );
+        for( uint32 v=0; v<numVertices; ++v )
+            adjOffsets[v + 1u] = adjOffsets[v] + liveTriCount[v];
+
+        vector<uint32>::type adjTriangles( numTriangles * 3u );
+        {
+            vector<uint32>::type adjCursor( adjOffsets.begin(), adjOffsets.end() - 1 );
+            for( size_t i=0; i<numTriangles * 3u; ++i )
+                adjTriangles[adjCursor[indices[i]]++] = static_cast<uint32>( i / 3u );
+        }
+
+        vector<uint32>::type cacheTimeStamp( numVertices, 0 );
+        vector<bool>::type emitted( numTriangles, false );
+        vector<uint32>::type deadEndStack;
+        vector<uint32>::type candidates;
+        deadEndStack.reserve( numTriangles * 3u );
+        candidates.reserve( 64u );
+
+        uint32 timeStamp = cacheSize + 1u;
+        uint32 cursor = 0;
+        size_t outIdx = 0;
+
+        if( outClusterStarts )
+        {
+            outClusterStarts->clear();
+            outClusterStarts->push_back( 0 );
+        }
+
+        uint32 fanningVertex = numVertices > 0 ? skipDeadEnd( deadEndStack, liveTriCount, cursor ) : ~0u;
+
+        while( fanningVertex != ~0u )
+        {
+            candidates.clear();
+
+            //Emit all the remaining triangles around the fanning vertex
+            for( uint32 i=adjOffsets[fanningVertex]; i<adjOffsets[fanningVertex + 1u]; ++i )
+            {
+                const uint32 triIdx = adjTriangles[i];
+                if( !emitted[triIdx] )
+                {
+                    for( size_t j=0; j<3u; ++j )
+                    {
+                        const uint32 v = indices[triIdx * 3u + j];
+                        outIndices[outIdx++] = v;
+                        deadEndStack.push_back( v );
+                        candidates.push_back( v );
+                        --liveTriCount[v];
+
+                        if( timeStamp - cacheTimeStamp[v] > cacheSize )
+                            cacheTimeStamp[v] = timeStamp++;
+                    }
+
+                    emitted[triIdx] = true;
+                }
+            }
+
+            //Pick the candidate that will still be in the cache once all of
+            //its remaining triangles get emitted, and has been there the longest.
+            uint32 nextVertex = ~0u;
+            int32 bestPriority = -1;
+            vector<uint32>::type::const_iterator itor = candidates.begin();
+            vector<uint32>::type::const_iterator end  = candidates.end();
+            while( itor != end )
+            {
+                const uint32 v = *itor;
+                if( liveTriCount[v] > 0 )
+                {
+                    int32 priority = 0;
+                    if( timeStamp - cacheTimeStamp[v] + 2u * liveTriCount[v] <= cacheSize )
+                        priority = static_cast<int32>( timeStamp - cacheTimeStamp[v] );
+
+                    if( priority > bestPriority )
+                    {
+                        bestPriority = priority;
+                        nextVertex = v;
+                    }
+                }
+                ++itor;
+            }
+
+            if( nextVertex == ~0u )
+            {
+                nextVertex = skipDeadEnd( deadEndStack, liveTriCount, cursor );
+
+                if( outClusterStarts && nextVertex != ~0u && outClusterStarts->back() != outIdx )
+                    outClusterStarts->push_back( outIdx );
+            }
+
+            fanningVertex = nextVertex;
+        }
+
+        assert( outIdx == numTriangles * 3u );
+    }
+    //-------------------------------------------------------------------------
+    void splitClusters( const uint32 *indices, size_t numIndices, uint32 numVertices,
+                        uint32 cacheSize, Real acmrThreshold,
+                        vector<size_t>::type &inOutClusterStarts )
+    {
+        vector<size_t>::type newClusterStarts;
+        newClusterStarts.reserve( inOutClusterStarts.size() * 2u );
+
+        vector<uint32>::type cacheTimeStamp( numVertices, 0 );
+        uint32 timeStamp = cacheSize + 1u;
+
+        for( size_t i=0; i<inOutClusterStarts.size(); ++i )
+        {
+            const size_t clusterEnd = (i + 1u) < inOutClusterStarts.size() ?
+                                          inOutClusterStarts[i + 1u] : numIndices;
+
+            size_t clusterMisses = 0;
+            size_t clusterTriangles = 0;
+            newClusterStarts.push_back( inOutClusterStarts[i] );
+
+            for( size_t j=inOutClusterStarts[i]; j<clusterEnd; j += 3u )
+            {
+                for( size_t k=0; k<3u; ++k )
+                {
+                    const uint32 v = indices[j + k];
+                    if( timeStamp - cacheTimeStamp[v] > cacheSize )
+                    {
+                        cacheTimeStamp[v] = timeStamp++;
+                        ++clusterMisses;
+                    }
+                }
+                ++clusterTriangles;
+
+                //Don't split on tiny clusters; the cache needs to warm up first.
+                if( j + 3u < clusterEnd && clusterTriangles >= cacheSize &&
+                    Real( clusterMisses ) <= acmrThreshold * Real( clusterTriangles ) )
+                {
+                    newClusterStarts.push_back( j + 3u );
+                    clusterMisses = 0;
+                    clusterTriangles = 0;
+                }
+            }
+        }
+
+        inOutClusterStarts.swap( newClusterStarts );
+    }
+    //-------------------------------------------------------------------------
+    struct ClusterSortEntry
+    {
+        size_t start;
+        size_t end;
+        Real sortKey;
+    };
+    static bool OrderClusterByKeyDescending( const ClusterSortEntry &l, const ClusterSortEntry &r )
+    {
+        return l.sortKey > r.sortKey;
+    }
+    //-------------------------------------------------------------------------
+    void reorderClustersForOverdraw( uint32 *indices, size_t numIndices, const Vector3 *positions,
+                                     const vector<size_t>::type &clusterStarts )
+    {
+        if( clusterStarts.size() < 2u )
+            return;
+
+        //Area-weighted mesh centroid
+        Vector3 meshCentroid( Vector3::ZERO );
+        Real meshArea = 0;
+        for( size_t i=0; i<numIndices; i += 3u )
+        {
+            const Vector3 &p0 = positions[indices[i+0]];
+            const Vector3 &p1 = positions[indices[i+1]];
+            const Vector3 &p2 = positions[indices[i+2]];
+            const Real area = (p1 - p0).crossProduct( p2 - p0 ).length();
+            meshCentroid += (p0 + p1 + p2) * area;
+            meshArea += area;
+        }
+        if( meshArea <= Real( 0 ) )
+            return;
+        meshCentroid /= meshArea * Real( 3 );
+
+        vector<ClusterSortEntry>::type clusters;
+        clusters.reserve( clusterStarts.size() );
+
+        for( size_t i=0; i<clusterStarts.size(); ++i )
+        {
+            ClusterSortEntry entry;
+            entry.start = clusterStarts[i];
+            entry.end   = (i + 1u) < clusterStarts.size() ? clusterStarts[i + 1u] : numIndices;
+
+            Vector3 clusterCentroid( Vector3::ZERO );
+            Vector3 clusterNormal( Vector3::ZERO );
+            Real clusterArea = 0;
+            for( size_t j=entry.start; j<entry.end; j += 3u )
+            {
+                const Vector3 &p0 = positions[indices[j+0]];
+                const Vector3 &p1 = positions[indices[j+1]];
+                const Vector3 &p2 = positions[indices[j+2]];
+                //Unnormalized cross product is already weighted by area
+                const Vector3 normal = (p1 - p0).crossProduct( p2 - p0 );
+                const Real area = normal.length();
+                clusterNormal   += normal;
+                clusterCentroid += (p0 + p1 + p2) * area;
+                clusterArea     += area;
+            }
+
+            entry.sortKey = -std::numeric_limits<Real>::max();
+            if( clusterArea > Real( 0 ) )
+            {
+                clusterCentroid /= clusterArea * Real( 3 );
+                clusterNormal.normalise();
+                entry.sortKey = (clusterCentroid - meshCentroid).dotProduct( clusterNormal );
+            }
+
+            clusters.push_back( entry );
+        }
+
+        //Draw outward-facing clusters first. Keep Tipsify's order among ties.
+        std::stable_sort( clusters.begin(), clusters.end(), OrderClusterByKeyDescending );
+
+        vector<uint32>::type reordered;
+        reordered.reserve( numIndices );
+        vector<ClusterSortEntry>::type::const_iterator itor = clusters.begin();
+        vector<ClusterSortEntry>::type::const_iterator end  = clusters.end();
+        while( itor != end )
+        {
+            reordered.insert( reordered.end(), indices + itor->start, indices + itor->end );
+            ++itor;
+        }
+
+        std::copy( reordered.begin(), reordered.end(), indices );
+    }
+    //-------------------------------------------------------------------------
+    void buildFirstUseRemap( const uint32 *indices, size_t numIndices,
+                             vector<uint32>::type &inOutRemap, uint32 &inOutNextVertex )
+    {
+        for( size_t i=0; i<numIndices; ++i )
+        {
+            const uint32 v = indices[i];
+            if( inOutRemap[v] == ~0u )
+                inOutRemap[v] = inOutNextVertex++;
+        }
+    }
+    //-------------------------------------------------------------------------
+    void finishVertexRemap( vector<uint32>::type &inOutRemap, uint32 &inOutNextVertex )
+    {
+        vector<uint32>::type::iterator itor = inOutRemap.begin();
+        vector<uint32>::type::iterator end  = inOutRemap.end();
+        while( itor != end )
+        {
+            if( *itor == ~0u )
+                *itor = inOutNextVertex++;
+            ++itor;
+        }
+    }
+    //-------------------------------------------------------------------------
+    void remapVertices( uint8 *dst, const uint8 *src, size_t bytesPerVertex,
+                        const vector<uint32>::type &remap )
+    {
+        for( size_t i=0; i<remap.size(); ++i )
+            memcpy( dst + remap[i] * bytesPerVertex, src + i * bytesPerVertex, bytesPerVertex );
+    }
+}
@@ -0,0 +1,118 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef _OgreToolVertexCacheOptimizer_H_
+#define _OgreToolVertexCacheOptimizer_H_
+
+#include "OgrePrerequisites.h"
+#include "OgreVector3.h"
+
+/** Index-level algorithms used by the '-cache' option. They operate on plain
+    32-bit index lists, so they can be shared by the v1 and v2 code paths.
+@remarks
+    The triangle reordering is Tipsify, from "Fast Triangle Reordering for Vertex
+    Locality and Reduced Overdraw" (Sander, Nehab & Barczak, 2007). It assumes a
+    FIFO post-transform cache, which is also what simulateFifoCache models.
+*/
+namespace VertexCacheOptimizer
+{
+    struct CacheStats
+    {
+        size_t numTriangles;
+        size_t numUniqueVertices;
+        size_t numCacheMisses;
+
+        CacheStats() : numTriangles( 0 ), numUniqueVertices( 0 ), numCacheMisses( 0 ) {}
+
+        /// Average Cache Miss Ratio: transformed vertices per triangle. 0.5 is the ideal.
+        Ogre::Real getAcmr(void) const;
+        /// Average Transform to Vertex Ratio: transformed vertices per used vertex. 1.0 is the ideal.
+        Ogre::Real getAtvr(void) const;
+    };
+
+    /// Simulates a FIFO post-transform cache of the given size.
+    CacheStats simulateFifoCache( const Ogre::uint32 *indices, size_t numIndices,
+                                  Ogre::uint32 numVertices, Ogre::uint32 cacheSize );
+
+    /** Reorders the triangles for post-transform cache locality.
+    @param indices
+        Triangle list. numIndices must be a multiple of 3.
+    @param numVertices
+        Must be greater than the largest index.
+    @param outIndices [out]
+        Reordered triangle list. Must hold numIndices entries. Can't alias indices.
+    @param outClusterStarts [out]
+        Optional. Receives the index offset of each cluster (the points where the
+        algorithm hit a dead end and had to jump), beginning with 0.
+    */
+    void tipsify( const Ogre::uint32 *indices, size_t numIndices, Ogre::uint32 numVertices,
+                  Ogre::uint32 cacheSize, Ogre::uint32 *outIndices,
+                  Ogre::vector<size_t>::type *outClusterStarts );
+
+    /** Splits the clusters returned by tipsify further wherever the cluster has already
+        achieved an ACMR below the given threshold (the "soft boundaries" from the paper).
+        More clusters give the overdraw pass more freedom, at a small cost in ACMR.
+    */
+    void splitClusters( const Ogre::uint32 *indices, size_t numIndices, Ogre::uint32 numVertices,
+                        Ogre::uint32 cacheSize, Ogre::Real acmrThreshold,
+                        Ogre::vector<size_t>::type &inOutClusterStarts );
+
+    /** Sorts the clusters so that those facing outwards from the mesh centroid
+        are drawn first, which tends to reduce overdraw regardless of the view direction.
+    @param indices [in/out]
+        Triangle list, reordered in place.
+    @param positions
+        One position per vertex.
+    */
+    void reorderClustersForOverdraw( Ogre::uint32 *indices, size_t numIndices,
+                                     const Ogre::Vector3 *positions,
+                                     const Ogre::vector<size_t>::type &clusterStarts );
+
+    /** Assigns new vertex indices in order of first use. Call it once per LOD (from the
+        highest detail to the lowest) then call finishVertexRemap.
+    @param inOutRemap [in/out]
+        Must be sized to numVertices and initialized to ~0u before the first call.
+    @param inOutNextVertex [in/out]
+        Must be 0 before the first call.
+    */
+    void buildFirstUseRemap( const Ogre::uint32 *indices, size_t numIndices,
+                             Ogre::vector<Ogre::uint32>::type &inOutRemap,
+                             Ogre::uint32 &inOutNextVertex );
+
+    /// Places vertices that weren't referenced by any index at the end (in original order).
+    void finishVertexRemap( Ogre::vector<Ogre::uint32>::type &inOutRemap,
+                            Ogre::uint32 &inOutNextVertex );
+
+    /** Moves every vertex to its new slot. i.e. dst[remap[i]] = src[i]
+    @param dst
+        Can't alias src.
+    */
+    void remapVertices( Ogre::uint8 *dst, const Ogre::uint8 *src, size_t bytesPerVertex,
+                        const Ogre::vector<Ogre::uint32>::type &remap );
+}
+
+#endif
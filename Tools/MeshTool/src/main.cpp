@@ -101,6 +101,12 @@ void help(void)
     cout << "             u converts UVs to 16-bit floats." << endl;
     cout << "             s make shadow mapping passes have their own optimized buffers. Overrides existing ones if any." << endl;
     cout << "             S strips the buffers for shadow mapping (consumes less space and memory)." << endl;
+    cout << "-cache     = Reorders triangles (all LODs & shadow caster buffers) for the post-transform" << endl;
+    cout << "             vertex cache and vertices in order of first use. Prints ACMR/ATVR before & after." << endl;
+    cout << "-co        = Like -cache, but also reorders triangle clusters to reduce overdraw." << endl;
+    cout << "-cs size   = Vertex cache size to optimize for (default 16)." << endl;
+    cout << "-z         = Compress the vertex & index buffers of v2 meshes. Lossless; loading them" << endl;
+    cout << "             requires an Ogre build that reads v2.1 R3 meshes. Ignored with -V 2.1" << endl;
     cout << "-U         = Performs the opposite of -O puq: Converts 16-bit half to to float and " << endl;
     cout << "             converts QTangents to Normal + Tangent + Reflection. Needed by many" << endl;
     cout << "             other options that have to read from position, normals or UVs." << endl;
@@ -160,6 +166,10 @@ void parseOpts(UnaryOptionList& unOpts, BinaryOptionList& binOpts)
     opts.qTangents      = false;
     opts.optimizeForShadowMapping = false;
     opts.stripShadowMapping = false;
+    opts.optimizeVertexCache = false;
+    opts.optimizeOverdraw = false;
+    opts.vertexCacheSize = 16;
+    opts.compressBuffers = false;
 
 
     UnaryOptionList::iterator ui = unOpts.find("-e");
@@ -226,6 +236,22 @@ void parseOpts(UnaryOptionList& unOpts, BinaryOptionList& binOpts)
     {
         opts.unoptimizeBuffer = true;
     }
+    ui = unOpts.find("-cache");
+    if (ui->second)
+    {
+        opts.optimizeVertexCache = true;
+    }
+    ui = unOpts.find("-co");
+    if (ui->second)
+    {
+        opts.optimizeVertexCache = true;
+        opts.optimizeOverdraw = true;
+    }
+    ui = unOpts.find("-z");
+    if (ui->second)
+    {
+        opts.compressBuffers = true;
+    }
 
 
     BinaryOptionList::iterator bi = binOpts.find("-l");
@@ -255,6 +281,12 @@ void parseOpts(UnaryOptionList& unOpts, BinaryOptionList& binOpts)
         opts.usePercent = false;
     }
 
+    bi = binOpts.find("-cs");
+    if (!bi->second.empty())
+    {
+        opts.vertexCacheSize = std::max( StringConverter::parseUnsignedInt(bi->second), 3u );
+    }
+
     bi = binOpts.find("-E");
     if (!bi->second.empty())
     {
@@ -335,6 +367,12 @@ void parseOpts(UnaryOptionList& unOpts, BinaryOptionList& binOpts)
                                                                     bi->second <<
                                                                     "' or version can't be used with -v2 argument";
         }
+
+        if( opts.compressBuffers && opts.targetVersionV2 == MESH_VERSION_2_1 )
+        {
+            LogManager::getSingleton().getDefaultLog()->stream() << "-z needs the latest v2 format. "
+                                                                    "Buffers won't be compressed.";
+        }
     }
 
     ui = unOpts.find("-O");
@@ -367,6 +405,7 @@ void vertexBufferReorg(v1::Mesh& mesh);
 void buildEdgeLists( v1::MeshPtr &mesh );
 void generateTangents( v1::MeshPtr &mesh );
 void recalcBounds( v1::MeshPtr &v1Mesh, MeshPtr &v2Mesh );
+void optimizeVertexCache( v1::MeshPtr &v1Mesh, MeshPtr &v2Mesh );
 
 void printLodConfig(const LodConfig& lodConfig)
 {
@@ -1063,6 +1102,7 @@ void saveMesh( const String &destination, v1::MeshPtr &v1Mesh, MeshPtr &v2Mesh,
                 v2Mesh->importV1( v1Mesh.get(), false, false, false );
 
             cout << "Saving as a v2 mesh..." << endl;
+            meshSerializer2.setCompressBuffers( opts.compressBuffers );
             meshSerializer2.exportMesh( v2Mesh.get(), destination, opts.targetVersionV2, opts.endian );
         }
 
@@ -1212,6 +1252,9 @@ int main(int numargs, char** args)
         unOptList["-U"] = false;
         unOptList["-v1"]= false;
         unOptList["-v2"]= false;
+        unOptList["-cache"] = false;
+        unOptList["-co"] = false;
+        unOptList["-z"] = false;
         binOptList["-l"] = "";
         binOptList["-d"] = "";
         binOptList["-p"] = "";
@@ -1221,6 +1264,7 @@ int main(int numargs, char** args)
         binOptList["-ts"] = "";
         binOptList["-V"] = "";
         binOptList["-O"] = "";
+        binOptList["-cs"] = "";
 
         int startIdx = findCommandLineOpts(numargs, args, unOptList, binOptList);
         parseOpts(unOptList, binOptList);
@@ -1335,6 +1379,9 @@ int main(int numargs, char** args)
             }
         }
 
+        if( opts.optimizeVertexCache )
+            optimizeVertexCache( v1Mesh, v2Mesh );
+
         if( !opts.dontOptimiseAnimations && !v1Skeleton.isNull() )
         {
             v1Skeleton->optimiseAllAnimations();